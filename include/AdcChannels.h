@@ -0,0 +1,86 @@
+#ifndef ADC_CHANNELS_H
+#define ADC_CHANNELS_H
+
+#include "config.h"
+
+/**
+ * @brief Set of ADC inputs sampled by BalanceReader
+ *
+ * Channel k is the balance-lead tap carrying cells 1..k+1 (taps in
+ * ascending order). Each channel has its own divider, so the conversion to
+ * volts is per channel.
+ */
+class AdcChannels {
+public:
+    virtual ~AdcChannels() {}
+    
+    /**
+     * @brief Configure the inputs
+     */
+    virtual void begin() = 0;
+    
+    /**
+     * @brief Get the number of channels
+     * @return Channel count (0 to BALANCE_MAX_CELLS)
+     */
+    virtual int channelCount() const = 0;
+    
+    /**
+     * @brief Take one raw sample
+     * @param channel Channel index (0 to channelCount() - 1)
+     * @return Raw ADC value (0-ADC_MAX_VALUE)
+     */
+    virtual int read(int channel) = 0;
+    
+    /**
+     * @brief Get the tap voltage of one ADC count
+     * @param channel Channel index
+     * @return Volts per count, including the channel's divider
+     */
+    virtual float voltsPerCount(int channel) const = 0;
+};
+
+#ifndef UNIT_TEST
+
+#ifndef BALANCE_MUX_ADC_PIN
+
+/**
+ * @brief Taps wired to their own ADC pins (BALANCE_TAP_PINS)
+ */
+class PinAdcChannels : public AdcChannels {
+public:
+    void begin();
+    int channelCount() const;
+    int read(int channel);
+    float voltsPerCount(int channel) const;
+};
+
+typedef PinAdcChannels PlatformAdcChannels;
+
+#else
+
+/**
+ * @brief Taps switched onto BALANCE_MUX_ADC_PIN by an analog mux
+ *
+ * The mux is only switched when the channel changes; each switch costs
+ * BALANCE_MUX_SETTLE_US.
+ */
+class MuxAdcChannels : public AdcChannels {
+public:
+    MuxAdcChannels();
+    void begin();
+    int channelCount() const;
+    int read(int channel);
+    float voltsPerCount(int channel) const;
+
+private:
+    int selected;    // Channel currently switched through (-1 = none)
+};
+
+typedef MuxAdcChannels PlatformAdcChannels;
+
+#endif // BALANCE_MUX_ADC_PIN
+
+#endif // UNIT_TEST
+
+#endif // ADC_CHANNELS_H
@@ -0,0 +1,117 @@
+#ifndef ADS1115_H
+#define ADS1115_H
+
+#include <stdint.h>
+#include "config.h"
+#include "I2cBus.h"
+
+/**
+ * @brief ADS1115 16-bit I2C ADC in continuous-conversion mode
+ *
+ * begin() writes the config register once (single-ended ADS1115_CHANNEL,
+ * ADS1115_FULL_SCALE_V range, ADS1115_DATA_RATE, continuous mode) and leaves
+ * the pointer register on the conversion register. After that every sample
+ * is a single 2-byte read transaction: no pointer write, no start command
+ * and no ready polling as in single-shot mode.
+ *
+ * poll() is non-blocking and reads only when the chip has produced a new
+ * conversion (one conversion period after the previous read), so a batch of
+ * N samples holds N distinct conversions and leaves the bus free in between.
+ */
+class Ads1115 {
+public:
+    /**
+     * @brief Create a driver on a bus
+     * @param bus I2C bus (shared with other devices)
+     * @param address 7-bit address (ADDR pin)
+     */
+    explicit Ads1115(I2cBus& bus, uint8_t address = ADS1115_ADDRESS);
+    
+    /**
+     * @brief Configure continuous conversions
+     * @return true if the chip acknowledged
+     */
+    bool begin();
+    
+    /**
+     * @brief Read the latest conversion (one 2-byte transaction)
+     * @param value Receives the signed conversion result
+     * @return true on success
+     */
+    bool readConversion(int16_t* value);
+    
+    /**
+     * @brief Clear the sample batch
+     */
+    void startBatch();
+    
+    /**
+     * @brief Add the next conversion to the batch once it is available
+     * @param nowUs Current time in microseconds
+     * @return true if a sample was read
+     */
+    bool poll(unsigned long nowUs);
+    
+    /**
+     * @brief Get the number of samples in the batch
+     * @return Samples read since startBatch()
+     */
+    int getBatchCount() const;
+    
+    /**
+     * @brief Get the batch average (negative readings count as 0)
+     * @return Average raw value (0-32767), 0 if the batch is empty
+     */
+    int getBatchAverage() const;
+    
+    /**
+     * @brief Get the conversion poll() read last
+     * @return Raw value (0-32767, negative readings as 0), 0 before the first read
+     */
+    int getLatest() const;
+    
+    /**
+     * @brief Get the time between conversions
+     * @return Conversion period in microseconds
+     */
+    unsigned long getConversionMicros() const;
+    
+    /**
+     * @brief Get the number of failed transactions
+     * @return Failed reads since begin()
+     */
+    unsigned long getErrorCount() const;
+    
+    /**
+     * @brief Build the config register value
+     * @param channel Single-ended input (0-3)
+     * @param fullScaleVolts PGA range (6.144, 4.096, 2.048, 1.024, 0.512 or 0.256)
+     * @param dataRate Conversions per second (8-860, rounded down to a supported rate)
+     * @return 16-bit config register value (continuous mode, comparator off)
+     */
+    static uint16_t configValue(int channel, float fullScaleVolts, int dataRate);
+    
+    /**
+     * @brief Get the supported data rate used for a requested rate
+     * @param dataRate Requested conversions per second
+     * @return Supported rate (8, 16, 32, 64, 128, 250, 475 or 860)
+     */
+    static int supportedDataRate(int dataRate);
+    
+    static const int MAX_VALUE = 32767;
+
+private:
+    I2cBus& bus;
+    uint8_t address;
+    unsigned long conversionMicros;
+    unsigned long errors;
+    
+    // Batch in progress
+    long batchSum;
+    int batchCount;
+    int latest;
+    unsigned long lastReadUs;
+    bool hasRead;            // lastReadUs is valid
+};
+
+#endif // ADS1115_H
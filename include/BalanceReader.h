@@ -0,0 +1,122 @@
+#ifndef BALANCE_READER_H
+#define BALANCE_READER_H
+
+#include "config.h"
+#include "AdcChannels.h"
+#include "BatteryAnalyzer.h"
+
+/**
+ * @brief Interleaved sampling of the balance-lead taps
+ *
+ * A round takes a fixed budget of BALANCE_SAMPLES_PER_ROUND samples shared by
+ * all taps, visiting them in serpentine order (0,1,2,2,1,0,...). Adding taps
+ * lowers the samples per tap (down to BALANCE_MIN_SAMPLES) instead of
+ * lengthening the round, so every tap is refreshed within the same time.
+ * The serpentine order gives every tap the same mean sample time over each
+ * pair of passes, so a linear drift (a pack under changing load) cancels in
+ * the tap differences instead of showing up as cell imbalance.
+ *
+ * Cell k is tap k minus tap k-1; the top cell comes from the pack voltage
+ * when it has no tap of its own.
+ */
+class BalanceReader {
+public:
+    /**
+     * @brief Create a reader on a set of ADC channels
+     * @param adc Tap channels in ascending order
+     * @param samplesPerRound Sample budget of one round
+     */
+    explicit BalanceReader(AdcChannels& adc, int samplesPerRound = BALANCE_SAMPLES_PER_ROUND);
+    
+    /**
+     * @brief Configure the channels and start the first round
+     */
+    void begin();
+    
+    /**
+     * @brief Discard the round in progress and the last reading
+     */
+    void reset();
+    
+    /**
+     * @brief Take one sample on the next tap (non-blocking)
+     * @return true if this sample completed a round
+     */
+    bool step();
+    
+    /**
+     * @brief Sample until the round in progress is complete
+     */
+    void readRound();
+    
+    /**
+     * @brief Check if a complete round is available
+     * @return true once a round has completed since the last reset
+     */
+    bool hasReading() const;
+    
+    /**
+     * @brief Get the number of taps
+     * @return Channel count
+     */
+    int getChannelCount() const;
+    
+    /**
+     * @brief Get the samples averaged per tap (even, at least BALANCE_MIN_SAMPLES)
+     * @return Samples per tap per round
+     */
+    int getSamplesPerChannel() const;
+    
+    /**
+     * @brief Get the length of a round in samples
+     * @return Samples per round (all taps)
+     */
+    int getSamplesPerRound() const;
+    
+    /**
+     * @brief Get the number of rounds completed since the last reset
+     * @return Completed rounds
+     */
+    unsigned long getRounds() const;
+    
+    /**
+     * @brief Get a tap voltage from the last complete round
+     * @param channel Tap index
+     * @return Voltage of cells 1..channel+1
+     */
+    float getTapVoltage(int channel) const;
+    
+    /**
+     * @brief Derive per-cell voltages from the last complete round
+     * @param cellCount Cells in the pack
+     * @param totalVoltage Pack voltage (top of the last cell if it has no tap)
+     * @param cells Receives cellCount voltages (BALANCE_MAX_CELLS capacity)
+     * @return Number of cells filled, 0 if the taps do not cover the pack
+     */
+    int getCellVoltages(int cellCount, float totalVoltage, float* cells) const;
+    
+    /**
+     * @brief Store per-cell voltages, imbalance and weakest cell in a BatteryInfo
+     * @param info Analysis result to extend
+     * @param cells Cell voltages (cell 1 first)
+     * @param count Number of cells (0 clears the balance fields)
+     */
+    static void applyCellVoltages(BatteryInfo* info, const float* cells, int count);
+
+private:
+    AdcChannels& adc;
+    int channels;
+    int samplesPerRound;
+    int samplesPerChannel;
+    
+    // Round in progress
+    int position;            // Index within the current pass
+    int pass;
+    long sums[BALANCE_MAX_CELLS];
+    
+    // Last complete round
+    float voltages[BALANCE_MAX_CELLS];
+    unsigned long rounds;
+};
+
+#endif // BALANCE_READER_H
@@ -5,6 +5,7 @@
 #include <Arduino.h>
 #endif
 #include "config.h"
+#include "Chemistry.h"
 
 /**
  * @brief Structure to hold battery analysis results
@@ -15,17 +16,27 @@ struct BatteryInfo {
     float averageCellVoltage; // Average voltage per cell
     int chargePercentage;    // Battery charge percentage (0-100)
     bool isValid;            // Whether the reading is valid
+    int cellConfidence;      // Confidence in cellCount (0-100, 100 = certain/single-shot)
+    int balanceCells;        // Cells measured through balance leads (0 = none, see BalanceReader)
+    float cellVoltages[BALANCE_MAX_CELLS]; // Per-cell voltages, cell 1 first (balanceCells valid)
+    float imbalance;         // Highest minus lowest cell voltage
+    int weakestCell;         // Lowest cell, 1-based (0 = unknown)
 };
 
 /**
  * @brief Class for analyzing battery characteristics
+ *
+ * Templated on a chemistry policy (see Chemistry.h). Member definitions live in
+ * BatteryAnalyzer.cpp, which explicitly instantiates every supported chemistry.
+ * @tparam Chemistry Policy providing cell limits and the SOC curve
  */
-class BatteryAnalyzer {
+template <class Chemistry>
+class ChemistryAnalyzer {
 public:
     /**
      * @brief Detect the number of cells based on voltage
      * @param voltage Total battery voltage
-     * @return Number of cells detected (1-6), or 0 if invalid
+     * @return Number of cells detected (1-maxCells), or 0 if invalid
      */
     static int detectCellCount(float voltage);
     
@@ -51,6 +62,14 @@ public:
      */
     static BatteryInfo analyzeBattery(float voltage);
     
+    /**
+     * @brief Analyze battery with an externally determined cell count
+     * @param voltage Total battery voltage
+     * @param cellCount Number of cells (e.g. from CellCountTracker), 0 if unknown
+     * @return BatteryInfo structure (invalid if cellCount is out of range)
+     */
+    static BatteryInfo analyzeWithCellCount(float voltage, int cellCount);
+    
     /**
      * @brief Check if voltage is within valid range for given cell count
      * @param voltage Total battery voltage
@@ -60,4 +79,9 @@ public:
     static bool isVoltageValid(float voltage, int cellCount);
 };
 
+/**
+ * @brief Default LiPo analyzer (the original single-chemistry API)
+ */
+typedef ChemistryAnalyzer<LiPoChemistry> BatteryAnalyzer;
+
 #endif // BATTERY_ANALYZER_H
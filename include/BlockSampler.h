@@ -0,0 +1,65 @@
+#ifndef BLOCK_SAMPLER_H
+#define BLOCK_SAMPLER_H
+
+#include <stdint.h>
+#include "config.h"
+#include "SampleSource.h"
+#include "ConnectionWatcher.h"
+#include "SampleQueue.h"
+
+/**
+ * @brief Sampling task body: connection detection and averaged blocks from one ADC backend
+ *
+ * Each run() polls the backend once. The newest single conversion goes to
+ * the ConnectionWatcher; while a pack is connected, everything the backend
+ * delivered over samplesPerBlock runs (one analogRead() per run, or every
+ * oversampled interrupt block that finished in that time) is averaged into
+ * one SampleRecord. Without a pack the batch is cleared every run, so the
+ * first block of a new pack holds only its own samples.
+ */
+class BlockSampler {
+public:
+    /**
+     * @brief Create a sampler
+     * @param source ADC backend (batch started and polled only by this sampler)
+     * @param watcher Connection detector fed with the latest conversion
+     * @param queue Queue the records are pushed to (producer side)
+     */
+    BlockSampler(SampleSource& source, ConnectionWatcher& watcher, SampleQueue& queue);
+    
+    /**
+     * @brief Set the runs averaged into one record and restart the block
+     * @param runs Runs per record (at least 1)
+     */
+    void setSamplesPerBlock(int runs);
+    
+    /**
+     * @brief Get the runs averaged into one record
+     * @return Runs per record
+     */
+    int getSamplesPerBlock() const;
+    
+    /**
+     * @brief Poll the backend once and queue a record when the block is complete
+     * @param nowMs Current time in milliseconds (record time)
+     * @return Connection event confirmed by this run, or CONNECTION_NONE
+     */
+    ConnectionEvent run(unsigned long nowMs);
+    
+    /**
+     * @brief Check whether the last run() completed a block
+     * @return true if a record was pushed (or dropped by a full queue)
+     */
+    bool blockCompleted() const;
+
+private:
+    SampleSource& source;
+    ConnectionWatcher& watcher;
+    SampleQueue& queue;
+    int samplesPerBlock;
+    int runs;                // Runs since the batch started
+    uint16_t sequence;       // Next record's sequence number
+    bool completed;
+};
+
+#endif // BLOCK_SAMPLER_H
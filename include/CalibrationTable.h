@@ -0,0 +1,164 @@
+#ifndef CALIBRATION_TABLE_H
+#define CALIBRATION_TABLE_H
+
+#include <stdint.h>
+#include "config.h"
+
+/**
+ * @brief One reference measurement: averaged ADC reading at a known voltage
+ */
+struct CalibrationPoint {
+    float raw;               // Averaged raw ADC value (fractional counts)
+    float voltage;           // Battery voltage measured with a reference meter
+};
+
+/**
+ * @brief log2 of a power of two (compile time)
+ */
+constexpr int calibrationLog2(long value) {
+    return value <= 1 ? 0 : 1 + calibrationLog2(value / 2);
+}
+
+/**
+ * @brief Piecewise-linear raw-to-voltage correction with O(1) lookup
+ *
+ * The raw ADC range is split into CALIBRATION_SEGMENTS equal segments of
+ * 2^SEGMENT_SHIFT codes. The table holds the battery voltage (mV) at every
+ * segment edge, so a reading is corrected by indexing with raw >> SEGMENT_SHIFT
+ * and interpolating between two neighbouring entries: one shift, one
+ * multiply, no search and no floating point.
+ *
+ * fit() draws a piecewise-linear curve through 2 to CALIBRATION_MAX_POINTS
+ * reference points (extending the outer segments linearly) and samples it at
+ * the segment edges. Two points give a plain gain and offset correction; more
+ * points follow the ADC's nonlinearity (the ESP32-C3 bends by tens of mV
+ * across the range).
+ *
+ * The table is stored as a checksummed blob (see serialize()), so booting
+ * only validates and copies it.
+ */
+class CalibrationTable {
+public:
+    /**
+     * @brief Codes per segment as a shift: (VOLTAGE_ADC_MAX_VALUE + 1) / CALIBRATION_SEGMENTS = 2^SEGMENT_SHIFT
+     */
+    static constexpr int SEGMENT_SHIFT = calibrationLog2((VOLTAGE_ADC_MAX_VALUE + 1L) / CALIBRATION_SEGMENTS);
+    
+    /**
+     * @brief Size of a serialized table
+     */
+    static const int BLOB_SIZE = 8 + 2 * (CALIBRATION_SEGMENTS + 1);
+    
+    /**
+     * @brief Create an empty (invalid) table
+     */
+    CalibrationTable();
+    
+    /**
+     * @brief Build the table from reference points
+     * @param points Reference points in any order (sorted in place)
+     * @param count Number of points
+     * @return false if there are fewer than 2 points, two points share a raw
+     *         value, or the voltage does not rise with the raw value (table unchanged)
+     */
+    bool fit(CalibrationPoint* points, int count);
+    
+    /**
+     * @brief Drop the table (readings fall back to the divider ratio)
+     */
+    void clear();
+    
+    /**
+     * @brief Check whether the table holds a calibration
+     * @return true after a successful fit() or deserialize()
+     */
+    bool isValid() const;
+    
+    /**
+     * @brief Corrected battery voltage for a raw reading (O(1))
+     * @param rawValue Raw ADC value (clamped to 0-VOLTAGE_ADC_MAX_VALUE)
+     * @return Battery voltage in millivolts
+     */
+    uint16_t toMillivolts(int rawValue) const {
+        if (rawValue < 0) rawValue = 0;
+        if (rawValue > VOLTAGE_ADC_MAX_VALUE) rawValue = VOLTAGE_ADC_MAX_VALUE;
+        
+        int index = rawValue >> SEGMENT_SHIFT;
+        int32_t offset = rawValue & ((1 << SEGMENT_SHIFT) - 1);
+        int32_t step = (int32_t)knots[index + 1] - knots[index];
+        return (uint16_t)(knots[index] + ((step * offset) >> SEGMENT_SHIFT));
+    }
+    
+    /**
+     * @brief Lowest raw value that reads at least a voltage (inverse lookup)
+     * @param millivolts Battery voltage in millivolts
+     * @return Raw ADC value (0-VOLTAGE_ADC_MAX_VALUE)
+     */
+    int toRaw(uint16_t millivolts) const;
+    
+    /**
+     * @brief Get one table entry
+     * @param index Segment edge (0 to CALIBRATION_SEGMENTS)
+     * @return Battery voltage at raw value index << SEGMENT_SHIFT (mV)
+     */
+    uint16_t getKnot(int index) const;
+    
+    /**
+     * @brief Write the table as a storable blob
+     *
+     * Layout (little endian): magic "CT", version, segment shift, segment
+     * count (uint16), knots (uint16 each), CRC-16/CCITT of everything before it.
+     * @param blob Receives BLOB_SIZE bytes
+     */
+    void serialize(uint8_t* blob) const;
+    
+    /**
+     * @brief Load a blob written by serialize()
+     * @param blob BLOB_SIZE bytes
+     * @return false (table unchanged) if the blob is corrupt or was made for
+     *         another ADC range or table size
+     */
+    bool deserialize(const uint8_t* blob);
+
+private:
+    uint16_t knots[CALIBRATION_SEGMENTS + 1];
+    bool valid;
+    
+    static_assert((1L << SEGMENT_SHIFT) * CALIBRATION_SEGMENTS == VOLTAGE_ADC_MAX_VALUE + 1L,
+                  "CALIBRATION_SEGMENTS must be a power of two dividing the ADC range");
+};
+
+#ifndef UNIT_TEST
+
+/**
+ * @brief Calibration table in non-volatile memory
+ *
+ * ESP32-C3: a blob in NVS (Preferences namespace "calib"), apart from the
+ * measurement log partition. Pro Mini: the last CALIBRATION_EEPROM_BYTES of
+ * the EEPROM, which the measurement log leaves out.
+ */
+class CalibrationStore {
+public:
+    /**
+     * @brief Load the stored table
+     * @param table Receives the table
+     * @return false if nothing valid is stored
+     */
+    static bool load(CalibrationTable* table);
+    
+    /**
+     * @brief Store a table
+     * @param table Table to store
+     * @return true on success
+     */
+    static bool save(const CalibrationTable& table);
+    
+    /**
+     * @brief Remove the stored table
+     */
+    static void erase();
+};
+
+#endif // UNIT_TEST
+
+#endif // CALIBRATION_TABLE_H
@@ -0,0 +1,126 @@
+#ifndef CELL_COUNT_TRACKER_H
+#define CELL_COUNT_TRACKER_H
+
+#include "config.h"
+#include "Chemistry.h"
+
+/**
+ * @brief Filter and lock settings of a CellCountTracker
+ *
+ * The defaults are the config.h values; the simulator's parameter tuner
+ * tries other candidates on the same tracker code.
+ */
+struct TrackerTuning {
+    float noiseSigma;        // Std. deviation of one reading (V)
+    int maxAveraged;         // Readings in the running mean at most
+    float lockConfidence;    // Posterior required to count towards a lock
+    int lockReadings;        // Consecutive confident readings before locking
+    float unlockConfidence;  // Locked count is dropped below this posterior
+    
+    /**
+     * @brief TRACKER_NOISE_SIGMA, TRACKER_MAX_AVERAGED, TRACKER_LOCK_* and TRACKER_UNLOCK_CONFIDENCE
+     */
+    TrackerTuning();
+};
+
+/**
+ * @brief Stateful cell-count detection over successive readings
+ *
+ * Keeps a posterior over 1S..maxCells instead of deciding from one reading.
+ * The readings of a connected pack share one unknown cell voltage, so their
+ * running mean is a sufficient statistic: each update recomputes
+ *
+ *   P(n | readings) ~ P(n) * integral prior(u) * N(mean; n*u, sigma/sqrt(k)) du
+ *
+ * where prior(u) is a piecewise-constant density over the cell voltage
+ * (mostly in-use and charged, little mass near the cut-off). Averaging removes
+ * noise at band edges; genuinely ambiguous voltages (11.6V = 3S@3.87V or
+ * 4S@2.9V) settle on the prior-weighted answer with an honest confidence.
+ *
+ * A reading outside the tracked count's pack voltage range (cells times the
+ * chemistry's cell limits, plus 3 sigma of noise) is left out of the mean;
+ * TRACKER_RESET_READINGS of them in a row mean a different pack and restart
+ * the tracker. A sag under load (2V on a 6S pack is 0.33V per cell) stays
+ * inside the range or ends before that, so it does not restart the count.
+ *
+ * Cost per update is constant (fixed number of hypotheses and segments).
+ */
+class CellCountTracker {
+public:
+    /**
+     * @brief Create a tracker configured for LiPo
+     */
+    CellCountTracker();
+    
+    /**
+     * @brief Set the chemistry limits and reset the tracker
+     * @param limits Cell limits of the active chemistry
+     */
+    void configure(const ChemistryLimits& limits);
+    
+    /**
+     * @brief Replace the filter and lock settings and reset the tracker
+     * @param tuning New settings (the constructor uses the config.h ones)
+     */
+    void tune(const TrackerTuning& tuning);
+    
+    /**
+     * @brief Forget the current pack (call on disconnect or chemistry change)
+     */
+    void reset();
+    
+    /**
+     * @brief Add one battery voltage reading
+     * @param voltage Total battery voltage
+     * @return Tracked cell count, or 0 if disconnected/invalid
+     */
+    int update(float voltage);
+    
+    /**
+     * @brief Get the tracked cell count (locked value once locked)
+     * @return Number of cells, or 0 if unknown
+     */
+    int getCellCount() const;
+    
+    /**
+     * @brief Get the posterior probability of the reported cell count
+     * @return Confidence in percent (0-100)
+     */
+    int getConfidence() const;
+    
+    /**
+     * @brief Check whether the cell count is locked
+     * @return true once confident for lockReadings consecutive readings
+     */
+    bool isLocked() const;
+    
+    /**
+     * @brief Get the posterior probability of one hypothesis
+     * @param cells Cell count (1-maxCells)
+     * @return Probability (0.0-1.0)
+     */
+    float getProbability(int cells) const;
+    
+    /**
+     * @brief Get the number of readings in the running mean
+     * @return Reading count (capped at maxAveraged)
+     */
+    int getReadingCount() const;
+
+private:
+    float likelihood(int cells, float voltage, float sigma) const;
+    bool explains(int cells, float voltage) const;
+    void computePosterior();
+    
+    ChemistryLimits limits;
+    TrackerTuning tuning;
+    float meanVoltage;       // Running mean of the current pack's readings
+    int readingCount;        // Readings in the mean (capped)
+    float posterior[MAX_CELLS + 1];
+    int bestCells;           // Maximum a posteriori cell count
+    int confidentReadings;   // Consecutive readings above the lock threshold
+    int lockedCells;         // Locked cell count, 0 if not locked
+    int outOfRangeReadings;  // Consecutive readings the tracked count does not explain
+};
+
+#endif // CELL_COUNT_TRACKER_H
@@ -0,0 +1,180 @@
+#ifndef CHEMISTRY_H
+#define CHEMISTRY_H
+
+#include "config.h"
+
+/**
+ * @brief One point of a state-of-charge curve (resting cell voltage -> charge %)
+ */
+struct SocPoint {
+    float cellVoltage;       // Resting voltage per cell
+    int percentage;          // Charge percentage at that voltage (0-100)
+};
+
+/**
+ * @brief Piecewise-linear lookup on a SOC curve
+ * @param cellVoltage Average voltage per cell
+ * @param curve Curve points sorted by ascending voltage
+ * @param points Number of points in the curve (at least 2)
+ * @return Charge percentage (0-100), rounded to nearest
+ */
+inline int interpolateSoc(float cellVoltage, const SocPoint* curve, int points) {
+    // Clamp to the ends of the curve (>= to handle a full cell exactly)
+    if (cellVoltage < curve[0].cellVoltage) {
+        return curve[0].percentage;
+    }
+    if (cellVoltage >= curve[points - 1].cellVoltage) {
+        return curve[points - 1].percentage;
+    }
+    
+    int i = 1;
+    while (cellVoltage >= curve[i].cellVoltage) {
+        i++;
+    }
+    
+    const SocPoint& lo = curve[i - 1];
+    const SocPoint& hi = curve[i];
+    float fraction = (cellVoltage - lo.cellVoltage) / (hi.cellVoltage - lo.cellVoltage);
+    
+    // Round instead of truncate for better accuracy
+    int percentage = lo.percentage + (int)(fraction * (hi.percentage - lo.percentage) + 0.5f);
+    
+    if (percentage < 0) percentage = 0;
+    if (percentage > 100) percentage = 100;
+    
+    return percentage;
+}
+
+/**
+ * @brief Cell limits of a chemistry as runtime values (for stateful consumers)
+ */
+struct ChemistryLimits {
+    float minCellVoltage;    // Lowest accepted voltage per cell
+    float maxCellVoltage;    // Fully charged voltage per cell
+    float emptyCellVoltage;  // Voltage per cell at 0% charge (discharge floor)
+    int maxCells;            // Largest supported series cell count
+};
+
+/* Chemistry Policies
+ *
+ * Each policy describes one cell chemistry for ChemistryAnalyzer<>:
+ * - minCellVoltage(): lowest voltage per cell accepted during cell detection
+ * - maxCellVoltage(): highest voltage per cell (fully charged)
+ * - emptyCellVoltage(): voltage per cell at 0% charge (discharge floor)
+ * - maxCells():       largest supported series cell count
+ * - chargePercentage(): SOC curve for an average cell voltage
+ * - name():           short label for display and debug output
+ *
+ * Limits are constexpr so every analyzer instantiation folds them into
+ * immediate constants; there is no runtime lookup per reading.
+ */
+
+/**
+ * @brief Standard LiPo (4.2V full), driven by the CELL_VOLTAGE_* settings in config.h
+ */
+struct LiPoChemistry {
+    static constexpr float minCellVoltage() { return (float)CELL_VOLTAGE_MIN; }
+    static constexpr float maxCellVoltage() { return (float)CELL_VOLTAGE_MAX; }
+    static constexpr float emptyCellVoltage() { return (float)CELL_VOLTAGE_EMPTY; }
+    static constexpr int maxCells() { return MAX_CELLS; }
+    static const char* name() { return "LiPo"; }
+    
+    static int chargePercentage(float cellVoltage) {
+        // Linear between the configured empty and full voltages
+        static const SocPoint curve[] = {
+            { emptyCellVoltage(), 0 },
+            { (float)CELL_VOLTAGE_FULL, 100 }
+        };
+        return interpolateSoc(cellVoltage, curve, 2);
+    }
+};
+
+/**
+ * @brief High-voltage LiPo (4.35V full)
+ */
+struct LiHVChemistry {
+    static constexpr float minCellVoltage() { return 2.9f; }
+    static constexpr float maxCellVoltage() { return 4.35f; }
+    static constexpr float emptyCellVoltage() { return 3.30f; }
+    static constexpr int maxCells() { return 6; }
+    static const char* name() { return "LiHV"; }
+    
+    static int chargePercentage(float cellVoltage) {
+        static const SocPoint curve[] = {
+            { emptyCellVoltage(), 0 },
+            { 3.70f, 30 },
+            { 3.85f, 50 },
+            { 4.05f, 75 },
+            { 4.35f, 100 }
+        };
+        return interpolateSoc(cellVoltage, curve, 5);
+    }
+};
+
+/**
+ * @brief Li-ion cylindrical cells (18650/21700, 4.2V full, 2.5V cut-off)
+ */
+struct LiIonChemistry {
+    static constexpr float minCellVoltage() { return 2.5f; }
+    static constexpr float maxCellVoltage() { return 4.2f; }
+    static constexpr float emptyCellVoltage() { return 3.00f; }
+    static constexpr int maxCells() { return 6; }
+    static const char* name() { return "LiIon"; }
+    
+    static int chargePercentage(float cellVoltage) {
+        static const SocPoint curve[] = {
+            { emptyCellVoltage(), 0 },
+            { 3.45f, 10 },
+            { 3.60f, 30 },
+            { 3.70f, 50 },
+            { 3.80f, 65 },
+            { 3.90f, 78 },
+            { 4.00f, 88 },
+            { 4.10f, 95 },
+            { 4.20f, 100 }
+        };
+        return interpolateSoc(cellVoltage, curve, 9);
+    }
+};
+
+/**
+ * @brief LiFePO4 (3.65V full, very flat discharge plateau around 3.3V)
+ */
+struct LiFePO4Chemistry {
+    static constexpr float minCellVoltage() { return 2.5f; }
+    static constexpr float maxCellVoltage() { return 3.65f; }
+    static constexpr float emptyCellVoltage() { return 2.80f; }
+    static constexpr int maxCells() { return 6; }
+    static const char* name() { return "LiFePO4"; }
+    
+    static int chargePercentage(float cellVoltage) {
+        static const SocPoint curve[] = {
+            { emptyCellVoltage(), 0 },
+            { 3.20f, 10 },
+            { 3.25f, 20 },
+            { 3.28f, 30 },
+            { 3.30f, 40 },
+            { 3.32f, 60 },
+            { 3.33f, 70 },
+            { 3.35f, 90 },
+            { 3.45f, 100 }
+        };
+        return interpolateSoc(cellVoltage, curve, 9);
+    }
+};
+
+/**
+ * @brief Runtime limits of a chemistry policy
+ * @tparam Chemistry Policy type
+ */
+template <class Chemistry>
+inline ChemistryLimits chemistryLimits() {
+    ChemistryLimits limits;
+    limits.minCellVoltage = Chemistry::minCellVoltage();
+    limits.maxCellVoltage = Chemistry::maxCellVoltage();
+    limits.emptyCellVoltage = Chemistry::emptyCellVoltage();
+    limits.maxCells = Chemistry::maxCells();
+    return limits;
+}
+
+#endif // CHEMISTRY_H
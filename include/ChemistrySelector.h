@@ -0,0 +1,94 @@
+#ifndef CHEMISTRY_SELECTOR_H
+#define CHEMISTRY_SELECTOR_H
+
+#include "config.h"
+#include "BatteryAnalyzer.h"
+
+/**
+ * @brief Supported battery chemistries (runtime identifiers)
+ */
+enum ChemistryType {
+    CHEMISTRY_LIPO = 0,
+    CHEMISTRY_LIHV = 1,
+    CHEMISTRY_LIION = 2,
+    CHEMISTRY_LIFEPO4 = 3,
+    CHEMISTRY_COUNT = 4
+};
+
+/**
+ * @brief Runtime dispatcher over the compile-time chemistry analyzers
+ *
+ * Keeps the active chemistry and forwards analysis to the matching
+ * ChemistryAnalyzer<> instantiation through a constant function table,
+ * so selection costs one indexed call per reading.
+ */
+class ChemistrySelector {
+public:
+    /**
+     * @brief Select the active chemistry
+     * @param type Chemistry to use (ignored if out of range)
+     */
+    static void select(ChemistryType type);
+    
+    /**
+     * @brief Get the active chemistry
+     * @return Currently selected chemistry
+     */
+    static ChemistryType current();
+    
+    /**
+     * @brief Advance to the next chemistry (wraps around), e.g. on a button press
+     * @return Newly selected chemistry
+     */
+    static ChemistryType next();
+    
+    /**
+     * @brief Map a serial command character to a chemistry
+     * @param command 'L' LiPo, 'H' LiHV, 'I' Li-ion, 'F' LiFePO4 (case-insensitive)
+     * @param type Receives the chemistry if the command is recognised
+     * @return true if the character selects a chemistry
+     */
+    static bool fromCommand(char command, ChemistryType* type);
+    
+    /**
+     * @brief Get a short display name for a chemistry
+     * @param type Chemistry identifier
+     * @return Name string (e.g. "LiPo"), or "?" if out of range
+     */
+    static const char* name(ChemistryType type);
+    
+    /**
+     * @brief Analyze battery using the active chemistry
+     * @param voltage Total battery voltage
+     * @return BatteryInfo structure with all calculated values
+     */
+    static BatteryInfo analyzeBattery(float voltage);
+    
+    /**
+     * @brief Analyze battery using an explicit chemistry
+     * @param type Chemistry identifier
+     * @param voltage Total battery voltage
+     * @return BatteryInfo structure (invalid if type is out of range)
+     */
+    static BatteryInfo analyzeBattery(ChemistryType type, float voltage);
+    
+    /**
+     * @brief Analyze battery using the active chemistry and a known cell count
+     * @param voltage Total battery voltage
+     * @param cellCount Number of cells (e.g. from CellCountTracker), 0 if unknown
+     * @return BatteryInfo structure with all calculated values
+     */
+    static BatteryInfo analyzeWithCellCount(float voltage, int cellCount);
+    
+    /**
+     * @brief Get the cell limits of a chemistry
+     * @param type Chemistry identifier (out of range returns LiPo limits)
+     * @return Limits for configuring stateful analysis (e.g. CellCountTracker)
+     */
+    static ChemistryLimits limits(ChemistryType type);
+
+private:
+    static ChemistryType active;
+};
+
+#endif // CHEMISTRY_SELECTOR_H
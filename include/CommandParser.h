@@ -0,0 +1,135 @@
+#ifndef COMMAND_PARSER_H
+#define COMMAND_PARSER_H
+
+#include <stdint.h>
+#include "config.h"
+
+/**
+ * @brief Kinds of serial input recognized by CommandParser
+ */
+enum CommandType {
+    COMMAND_NONE = 0,        // Nothing complete yet
+    COMMAND_KEY = 1,         // Single-key command outside a line (L, H, I, F, S, B, T, D)
+    COMMAND_GET = 2,         // "$name": print one setting
+    COMMAND_SET = 3,         // "$name=value" or "$name value": change one setting
+    COMMAND_LIST = 4,        // "$": print every setting
+    COMMAND_STATS = 5,       // "$stats": print task, bus and sampling statistics
+    COMMAND_HELP = 6,        // "$help": print the command summary
+    COMMAND_ERROR = 7        // Rejected line (see CommandError)
+};
+
+/**
+ * @brief Runtime settings addressed by name
+ */
+enum CommandSetting {
+    SETTING_NONE = -1,
+    SETTING_SAMPLES = 0,     // Single samples averaged per block
+    SETTING_PERIOD = 1,      // Analysis period (ms)
+    SETTING_VERBOSITY = 2,   // Debug level (0-3)
+    SETTING_FORMAT = 3,      // Measurement output: text, csv or binary
+    SETTING_RATIO = 4,       // Voltage divider ratio (calibration)
+    SETTING_CALIBRATION = 5, // Calibration table: reference volts, "save" or "clear"
+    SETTING_COUNT = 6
+};
+
+/**
+ * @brief Reasons a command line was rejected
+ */
+enum CommandError {
+    COMMAND_ERROR_NONE = 0,
+    COMMAND_ERROR_TOO_LONG = 1,  // Longer than COMMAND_LINE_SIZE - 1 characters
+    COMMAND_ERROR_UNKNOWN = 2,   // Not a setting or command name
+    COMMAND_ERROR_SYNTAX = 3     // Control characters, missing value or extra text
+};
+
+/**
+ * @brief One parsed command
+ *
+ * value points into the parser's line buffer and stays valid until the
+ * next call to feed().
+ */
+struct Command {
+    CommandType type;
+    char key;                // COMMAND_KEY: the character
+    CommandSetting setting;  // COMMAND_GET / COMMAND_SET
+    const char* value;       // COMMAND_SET: value text (trimmed, non-empty)
+    CommandError error;      // COMMAND_ERROR
+};
+
+/**
+ * @brief Zero-allocation, non-blocking serial command parser
+ *
+ * Fed one character at a time (whatever Serial.available() has), so the
+ * caller never waits for a complete line. Characters outside a line are
+ * single-key commands and take effect at once, as before; a '$' starts a
+ * line, which ends at '\r' or '\n':
+ *
+ *   $                   list all settings
+ *   $samples            get a setting
+ *   $samples=20         set a setting (also "$samples 20")
+ *   $stats / $help
+ *
+ * Names are case-insensitive. Backspace edits the line; a line longer than
+ * the buffer is discarded up to its end and reported as too long. The line
+ * is split in place, so no strings are copied.
+ */
+class CommandParser {
+public:
+    /**
+     * @brief Create a parser outside any line
+     */
+    CommandParser();
+    
+    /**
+     * @brief Process one received character
+     * @param c Character from the serial port
+     * @param command Receives the command when one completes
+     * @return true if command was filled in
+     */
+    bool feed(char c, Command* command);
+    
+    /**
+     * @brief Get the name of a setting
+     * @param setting Setting
+     * @return Name used in commands, or "" for SETTING_NONE
+     */
+    static const char* settingName(CommandSetting setting);
+    
+    /**
+     * @brief Compare a word case-insensitively
+     * @param text Text from a command
+     * @param name Lowercase name
+     * @return true if text equals name ignoring case
+     */
+    static bool matchesName(const char* text, const char* name);
+    
+    /**
+     * @brief Parse a decimal number ("20", "-3", "7.85", ".5")
+     * @param text Number text (no surrounding spaces)
+     * @param value Receives the value
+     * @return false if text is not a plain decimal number
+     */
+    static bool parseNumber(const char* text, float* value);
+    
+    /**
+     * @brief Check a parsed number against an integer setting's range
+     *
+     * The range is checked before the fraction, so numbers far beyond any
+     * integer type are rejected without converting them.
+     * @param value Parsed number (any magnitude)
+     * @param min Smallest accepted value
+     * @param max Largest accepted value
+     * @return true if value is a whole number from min to max
+     */
+    static bool isWholeInRange(float value, long min, long max);
+
+private:
+    bool finishLine(Command* command);
+    
+    char line[COMMAND_LINE_SIZE];
+    uint8_t length;
+    bool inLine;
+    bool overflow;
+};
+
+#endif // COMMAND_PARSER_H
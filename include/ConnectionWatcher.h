@@ -0,0 +1,70 @@
+#ifndef CONNECTION_WATCHER_H
+#define CONNECTION_WATCHER_H
+
+#include "config.h"
+
+/**
+ * @brief Connection state changes reported by ConnectionWatcher
+ */
+enum ConnectionEvent {
+    CONNECTION_NONE = 0,         // No change
+    CONNECTION_CONNECTED = 1,    // Pack plugged in
+    CONNECTION_DISCONNECTED = 2  // Pack removed
+};
+
+/**
+ * @brief Lightweight pack connect/disconnect detector
+ *
+ * Fed with single raw ADC samples at a high rate while the main loop is idle.
+ * Uses two thresholds (hysteresis) and requires CONNECT_DEBOUNCE_SAMPLES (or
+ * the configured count) consecutive samples past a threshold, so contact
+ * bounce and noise spikes do not produce events. Integer compares only; no
+ * averaging or floats.
+ */
+class ConnectionWatcher {
+public:
+    /**
+     * @brief Create a watcher in the disconnected state
+     */
+    ConnectionWatcher();
+    
+    /**
+     * @brief Set thresholds in raw ADC counts
+     * @param connectRaw Samples at or above this count mean a pack is present
+     * @param disconnectRaw Samples at or below this count mean no pack
+     * @param debounceSamples Consecutive samples that confirm a change
+     */
+    void configure(int connectRaw, int disconnectRaw, int debounceSamples = CONNECT_DEBOUNCE_SAMPLES);
+    
+    /**
+     * @brief Process one raw ADC sample
+     * @param raw Single (unaveraged) ADC reading
+     * @param nowMs Sample time in milliseconds
+     * @return Event confirmed by this sample, or CONNECTION_NONE
+     */
+    ConnectionEvent sample(int raw, unsigned long nowMs);
+    
+    /**
+     * @brief Check the debounced connection state
+     * @return true if a pack is connected
+     */
+    bool isConnected() const;
+    
+    /**
+     * @brief Get the time the last change started
+     * @return Time (ms) of the first sample of the last confirmed change,
+     *         i.e. the moment the pack was actually plugged in or removed
+     */
+    unsigned long getChangeTime() const;
+
+private:
+    int connectThreshold;
+    int disconnectThreshold;
+    int debounceSamples;
+    bool connected;
+    int pendingSamples;          // Consecutive samples pointing to the other state
+    unsigned long pendingSince;  // Time of the first of those samples
+    unsigned long changeTime;
+};
+
+#endif // CONNECTION_WATCHER_H
@@ -4,6 +4,12 @@
 #include <Arduino.h>
 #include "config.h"
 #include "BatteryAnalyzer.h"
+#include "TrendEstimator.h"
+#include "SessionHistory.h"
+#include "I2cScheduler.h"
+#include "TaskScheduler.h"
+#include "MemoryMonitor.h"
+#include "MeasurementFrame.h"
 
 /**
  * @brief Class for managing debug output with verbosity levels
@@ -29,33 +35,133 @@ public:
     static int getLevel();
     
     /**
-     * @brief Log raw ADC reading (Level 3)
-     * @param rawValue Raw ADC value
-     * @param adcVoltage Voltage at ADC pin
+     * @brief Set the measurement output format
+     *
+     * CSV and binary replace the per-measurement text blocks with one
+     * printMeasurement() line or frame (a CSV header is printed on the switch);
+     * other messages stay text.
+     * @param format OUTPUT_FORMAT_TEXT, OUTPUT_FORMAT_CSV or OUTPUT_FORMAT_BINARY
      */
-    static void logRawADC(int rawValue, float adcVoltage);
+    static void setFormat(int format);
     
     /**
-     * @brief Log calculated values (Level 2)
-     * @param batteryVoltage Total battery voltage
-     * @param info Battery analysis information
+     * @brief Get the measurement output format
+     * @return OUTPUT_FORMAT_TEXT, OUTPUT_FORMAT_CSV or OUTPUT_FORMAT_BINARY
      */
-    static void logCalculatedValues(float batteryVoltage, const BatteryInfo& info);
+    static int getFormat();
     
     /**
-     * @brief Log display information (Level 1)
-     * @param info Battery analysis information
+     * @brief Log a chemistry change (Level 1)
+     * @param name Name of the newly selected chemistry
      */
-    static void logDisplayInfo(const BatteryInfo& info);
+    static void logChemistry(const char* name);
+    
+    /**
+     * @brief Log session statistics (Level 1, on request)
+     * @param history Session history of the connected pack
+     */
+    static void logSessionStats(const SessionHistory& history);
+    
+    /**
+     * @brief Log I2C bus use and per-device latency (Level 1, on request)
+     * @param bus Shared I2C scheduler
+     */
+    static void logBusStats(const I2cScheduler& bus);
+    
+    /**
+     * @brief Log runs, overruns, lateness and jitter per task (Level 1, on request)
+     * @param scheduler Main loop task scheduler
+     */
+    static void logTaskStats(const TaskScheduler& scheduler);
+
+#if MEMORY_MONITOR
+    /**
+     * @brief Log stack and heap headroom of setup() and each task (Level 1, on request)
+     * @param scheduler Main loop task scheduler (task names)
+     */
+    static void logMemoryStats(const TaskScheduler& scheduler);
+#endif
+
+    /**
+     * @brief Write the CSV column header line
+     * @param out Destination (Serial on the device; MeasurementTasks writes
+     *        the measurement formats below when its level is enabled)
+     */
+    static void printCsvHeader(Print& out);
+    
+    /**
+     * @brief Write one measurement as a CSV line or binary frame
+     * @param out Destination
+     * @param format OUTPUT_FORMAT_CSV or OUTPUT_FORMAT_BINARY (text writes nothing)
+     * @param timeMs Measurement time
+     * @param rawValue Averaged raw ADC value
+     * @param batteryVoltage Battery voltage
+     * @param info Analysis result
+     * @param trend Discharge trend
+     */
+    static void printMeasurement(Print& out, int format, unsigned long timeMs, int rawValue,
+                                 float batteryVoltage, const BatteryInfo& info, const TrendInfo& trend);
+    
+    /**
+     * @brief Write the "--- Raw ADC Reading ---" block
+     */
+    static void printRawADC(Print& out, int rawValue, float adcVoltage);
+    
+    /**
+     * @brief Write the sample blocks behind a measurement
+     * @param out Destination
+     * @param blocks Blocks averaged
+     * @param lost Blocks dropped because the sample queue was full
+     */
+    static void printSampleBlocks(Print& out, int blocks, int lost);
+    
+    /**
+     * @brief Write the "--- Calculated Values ---" block
+     */
+    static void printCalculatedValues(Print& out, float batteryVoltage, const BatteryInfo& info);
+    
+    /**
+     * @brief Write per-cell voltages, imbalance and weakest cell (nothing without balance-lead readings)
+     */
+    static void printCellVoltages(Print& out, const BatteryInfo& info);
+    
+    /**
+     * @brief Write the discharge rate and time to empty lines
+     */
+    static void printTrend(Print& out, const TrendInfo& trend);
+    
+    /**
+     * @brief Write the "--- Display Output ---" block
+     */
+    static void printDisplayInfo(Print& out, const BatteryInfo& info);
+    
+    /**
+     * @brief Write the pack connected/disconnected message
+     */
+    static void printConnection(Print& out, bool connected);
+    
+    /**
+     * @brief Write the connect-to-display latency
+     * @param out Destination
+     * @param latencyMs Time from plug-in to the first displayed measurement
+     */
+    static void printConnectLatency(Print& out, unsigned long latencyMs);
     
     /**
      * @brief Log general message
      * @param message Message to log
      */
     static void log(const char* message);
+    
+    /**
+     * @brief Log general message kept in flash (F("..."))
+     * @param message Message to log
+     */
+    static void log(const __FlashStringHelper* message);
 
 private:
     static int debugLevel;
+    static int outputFormat;
 };
 
 #endif // DEBUG_LOGGER_H
@@ -6,7 +6,10 @@
 #include <Adafruit_GFX.h>
 #include <Adafruit_SSD1306.h>
 #include "config.h"
+#include "I2cScheduler.h"
 #include "BatteryAnalyzer.h"
+#include "TrendEstimator.h"
+#include "SessionHistory.h"
 
 /**
  * @brief Class for managing OLED display output
@@ -30,6 +33,13 @@ public:
      */
     static void displayBatteryInfo(const BatteryInfo& info);
     
+    /**
+     * @brief Display battery information with the discharge trend
+     * @param info BatteryInfo structure with battery data
+     * @param trend Discharge trend (charge line unchanged if not valid)
+     */
+    static void displayBatteryInfo(const BatteryInfo& info, const TrendInfo& trend);
+    
     /**
      * @brief Display error message
      * @param message Error message to display
@@ -40,9 +50,37 @@ public:
      * @brief Display initialization message
      */
     static void displayInitMessage();
+    
+    /**
+     * @brief Display the newly selected battery chemistry
+     * @param name Chemistry name (e.g. "LiHV")
+     */
+    static void displayChemistry(const char* name);
+    
+    /**
+     * @brief Display the idle screen shown while no pack is connected
+     */
+    static void displayNoBattery();
+    
+    /**
+     * @brief Display session range, sag count and a sparkline of the history
+     * @param history Session history of the connected pack
+     */
+    static void displayHistory(const SessionHistory& history);
 
 private:
+    /**
+     * @brief Queue the framebuffer on the shared I2C scheduler
+     *
+     * Replaces Adafruit_SSD1306::display(), which holds the bus for the whole
+     * frame. The chunks are sent by I2cScheduler::poll() from the main loop.
+     */
+    static void flush();
+    
     static Adafruit_SSD1306* display;
+    static uint8_t windowCommands[7];
+    static I2cTransaction frameWindow;
+    static I2cTransaction frameData;
 };
 
 #endif // DISPLAY_MANAGER_H
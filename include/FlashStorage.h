@@ -0,0 +1,117 @@
+#ifndef FLASH_STORAGE_H
+#define FLASH_STORAGE_H
+
+#include <stdint.h>
+#include "config.h"
+
+/**
+ * @brief Page-erasable non-volatile storage used by MeasurementLog
+ *
+ * Models NOR flash: erasePage() sets a page to 0xFF, and write() may only
+ * program erased bytes. Backends that can rewrite bytes freely (EEPROM)
+ * still follow these rules, so the log code is the same on every platform.
+ */
+class FlashStorage {
+public:
+    virtual ~FlashStorage() {}
+    
+    /**
+     * @brief Prepare the storage for use
+     * @return true if the storage is available
+     */
+    virtual bool begin() = 0;
+    
+    /**
+     * @brief Get the erase unit size
+     * @return Bytes per page (multiple of 4)
+     */
+    virtual uint32_t pageSize() const = 0;
+    
+    /**
+     * @brief Get the number of pages
+     * @return Page count
+     */
+    virtual uint32_t pageCount() const = 0;
+    
+    /**
+     * @brief Read bytes
+     * @param address Byte address from the start of the storage
+     * @param data Receives the bytes
+     * @param length Number of bytes
+     * @return true on success
+     */
+    virtual bool read(uint32_t address, uint8_t* data, uint32_t length) = 0;
+    
+    /**
+     * @brief Program bytes that were erased since their last write
+     * @param address Byte address from the start of the storage
+     * @param data Bytes to program
+     * @param length Number of bytes (must not cross a page boundary)
+     * @return true on success
+     */
+    virtual bool write(uint32_t address, const uint8_t* data, uint32_t length) = 0;
+    
+    /**
+     * @brief Erase one page to 0xFF
+     * @param page Page index (0 to pageCount() - 1)
+     * @return true on success
+     */
+    virtual bool erasePage(uint32_t page) = 0;
+};
+
+#ifndef UNIT_TEST
+
+#ifdef ARDUINO_PRO_MINI
+
+/**
+ * @brief Internal EEPROM split into LOG_EEPROM_PAGE_SIZE pages
+ *
+ * The last CALIBRATION_EEPROM_BYTES hold the calibration table and are
+ * not part of any page.
+ *
+ * EEPROM has no erase unit; erasePage() writes 0xFF and only touches bytes
+ * that are not erased yet, so each byte is written at most twice per cycle.
+ */
+class EepromFlash : public FlashStorage {
+public:
+    bool begin();
+    uint32_t pageSize() const;
+    uint32_t pageCount() const;
+    bool read(uint32_t address, uint8_t* data, uint32_t length);
+    bool write(uint32_t address, const uint8_t* data, uint32_t length);
+    bool erasePage(uint32_t page);
+};
+
+typedef EepromFlash PlatformFlash;
+
+#else
+
+#include <esp_partition.h>
+
+/**
+ * @brief Raw data partition (the "spiffs" partition of the default table)
+ *
+ * Pages are 4KB flash sectors; writes go straight to the partition without
+ * a file system, so every erase and program is under MeasurementLog's control.
+ */
+class PartitionFlash : public FlashStorage {
+public:
+    PartitionFlash();
+    bool begin();
+    uint32_t pageSize() const;
+    uint32_t pageCount() const;
+    bool read(uint32_t address, uint8_t* data, uint32_t length);
+    bool write(uint32_t address, const uint8_t* data, uint32_t length);
+    bool erasePage(uint32_t page);
+
+private:
+    const esp_partition_t* partition;
+};
+
+typedef PartitionFlash PlatformFlash;
+
+#endif // ARDUINO_PRO_MINI
+
+#endif // UNIT_TEST
+
+#endif // FLASH_STORAGE_H
@@ -0,0 +1,228 @@
+#ifndef FREE_RUNNING_ADC_H
+#define FREE_RUNNING_ADC_H
+
+#include <stdint.h>
+#include "config.h"
+#include "SampleSource.h"
+
+/**
+ * @brief The ATmega328P ADC registers the free-running backend uses
+ *
+ * The AVR implementation touches the real registers; tests and benchmarks
+ * use a simulated ADC instead. Names avoid the <avr/io.h> macros (ADMUX,
+ * ADCSRA, ADEN, ...), which would replace them.
+ */
+class AdcRegisters {
+public:
+    enum Register {
+        MULTIPLEXER,             // ADMUX
+        CONTROL_A,               // ADCSRA
+        CONTROL_B,               // ADCSRB
+        DIGITAL_DISABLE          // DIDR0
+    };
+    
+    virtual ~AdcRegisters() {}
+    
+    /**
+     * @brief Write an ADC control register
+     * @param reg Register
+     * @param value New value
+     */
+    virtual void write(Register reg, uint8_t value) = 0;
+    
+    /**
+     * @brief Read an ADC control register
+     * @param reg Register
+     * @return Current value
+     */
+    virtual uint8_t read(Register reg) = 0;
+    
+    /**
+     * @brief Read the conversion result (ADCL, then ADCH)
+     * @return 10-bit result
+     */
+    virtual uint16_t readResult() = 0;
+    
+    /**
+     * @brief Sleep in ADC noise-reduction mode until an interrupt wakes the CPU
+     *
+     * Entering the sleep mode starts a conversion when none is running; the
+     * ADC-complete interrupt (or any other) ends it.
+     */
+    virtual void sleepUntilInterrupt() = 0;
+};
+
+#ifdef __AVR__
+
+/**
+ * @brief The ATmega328P's own ADC registers
+ */
+class AvrAdcRegisters : public AdcRegisters {
+public:
+    void write(Register reg, uint8_t value);
+    uint8_t read(Register reg);
+    uint16_t readResult();
+    void sleepUntilInterrupt();
+};
+
+#endif // __AVR__
+
+/**
+ * @brief Internal ADC sampling one channel from its conversion-complete interrupt
+ *
+ * Replaces a blocking analogRead() per sample (13 ADC clocks, ~104 us at
+ * 8 MHz / 64) and the delay between samples. In free-running mode the ADC
+ * starts each conversion as the previous one ends; with noise-reduction
+ * sleep, each conversion runs while the CPU sleeps instead (one per
+ * idle() call), which keeps digital noise off the measurement.
+ *
+ * The interrupt sums `oversample` conversions into one of two blocks and
+ * then switches to the other, so the main loop reads a finished block
+ * while the next one fills. A block's sum, count and the completed-block
+ * counter are written only by the interrupt; the reader takes the newest
+ * finished block and copies it again if a block completed meanwhile
+ * (completed is a single byte, atomic on AVR). A block the reader did not
+ * take in time is overwritten and counted as dropped.
+ *
+ * As a SampleSource, each poll() adds at most one block (oversample
+ * conversions) to the batch.
+ *
+ * Call handleInterrupt() from ISR(ADC_vect); the AVR build in
+ * FreeRunningAdc.cpp does that for the instance begin() was called on.
+ */
+class FreeRunningAdc : public SampleSource {
+public:
+    // CONTROL_A (ADCSRA) bits
+    static const uint8_t CONTROL_A_ENABLE = 0x80;
+    static const uint8_t CONTROL_A_START = 0x40;
+    static const uint8_t CONTROL_A_AUTO_TRIGGER = 0x20;
+    static const uint8_t CONTROL_A_INTERRUPT_FLAG = 0x10;
+    static const uint8_t CONTROL_A_INTERRUPT_ENABLE = 0x08;
+    static const uint8_t CONTROL_A_PRESCALER_MASK = 0x07;
+    // MULTIPLEXER (ADMUX) reference selection: AVcc with a capacitor on AREF
+    static const uint8_t MULTIPLEXER_AVCC = 0x40;
+    
+    static const int MAX_OVERSAMPLE = 64;    // 64 x 1023 still fits the 16-bit block sum
+    
+    /**
+     * @brief Create a backend for one channel
+     * @param registers ADC registers
+     * @param channel ADC channel (0-7, A0 = 0)
+     * @param prescaler CPU clock / ADC clock (2, 4, 8, 16, 32, 64 or 128; rounded up)
+     * @param oversample Conversions per block (1-MAX_OVERSAMPLE)
+     * @param noiseSleep true to run each conversion in ADC noise-reduction sleep
+     */
+    FreeRunningAdc(AdcRegisters& registers, uint8_t channel, int prescaler, int oversample, bool noiseSleep);
+    
+    /**
+     * @brief Configure the ADC and start converting (free-running mode)
+     */
+    void begin();
+    
+    /**
+     * @brief Stop the interrupt and leave the ADC as analogRead() expects it
+     */
+    void end();
+    
+    /**
+     * @brief Conversion-complete interrupt body: read the result and accumulate it
+     */
+    static void handleInterrupt();
+    
+    /**
+     * @brief Add one conversion to the block being filled (interrupt context)
+     * @param sample 10-bit conversion result
+     */
+    void onConversion(uint16_t sample);
+    
+    /**
+     * @brief Let the ADC make progress while waiting for a block
+     *
+     * With noise-reduction sleep this sleeps through one conversion; in
+     * free-running mode it returns at once.
+     */
+    void idle();
+    
+    /**
+     * @brief Clear the sample batch
+     */
+    void startBatch();
+    
+    /**
+     * @brief Add the newest finished block to the batch if it was not taken yet
+     * @return true if a block was added
+     */
+    bool poll();
+    
+    /**
+     * @brief Get the number of conversions in the batch
+     * @return Conversions in the blocks taken since startBatch()
+     */
+    int getBatchCount() const;
+    
+    /**
+     * @brief Get the batch average
+     * @return Rounded average raw value (0-1023), 0 if the batch is empty
+     */
+    int getBatchAverage() const;
+    
+    /**
+     * @brief Get the latest single conversion
+     * @return Raw value (0-1023), 0 before the first conversion
+     */
+    int getLatest() const;
+    
+    /**
+     * @brief Get the number of blocks overwritten before the reader took them
+     * @return Dropped blocks since begin()
+     */
+    unsigned long getDroppedBlocks() const;
+    
+    /**
+     * @brief Get the time one conversion takes
+     * @param cpuHz CPU clock
+     * @return Microseconds per conversion (13 ADC clocks)
+     */
+    unsigned long getConversionMicros(unsigned long cpuHz) const;
+    
+    /**
+     * @brief Get the ADPS bits for a prescaler
+     * @param prescaler CPU clock / ADC clock
+     * @return ADPS2:0 value of the smallest supported division >= prescaler
+     */
+    static uint8_t prescalerBits(int prescaler);
+    
+    /**
+     * @brief Get the division an ADPS value selects
+     * @param bits ADPS2:0 value
+     * @return CPU clock / ADC clock (2-128)
+     */
+    static int prescalerDivision(uint8_t bits);
+
+private:
+    struct Block {
+        uint16_t sum;
+        uint8_t count;
+    };
+    
+    AdcRegisters& registers;
+    uint8_t channel;
+    uint8_t prescaler;       // ADPS bits
+    uint8_t oversample;
+    bool noiseSleep;
+    
+    // Written by the interrupt
+    volatile Block blocks[2]; // Block completed % 2 is being filled
+    volatile uint8_t completed;
+    volatile uint16_t latest;
+    
+    // Reader side
+    uint8_t taken;           // Value of completed when the last block was taken
+    unsigned long dropped;
+    unsigned long batchSum;
+    int batchCount;
+    
+    static FreeRunningAdc* active;
+};
+
+#endif // FREE_RUNNING_ADC_H
@@ -0,0 +1,58 @@
+#ifndef I2C_BUS_H
+#define I2C_BUS_H
+
+#include <stdint.h>
+#include "config.h"
+
+/**
+ * @brief Byte-level access to an I2C bus
+ *
+ * One call is one bus transaction (start, address, data, stop), so callers
+ * can count round-trips. Drivers take an I2cBus so they can be tested
+ * against simulated devices on the host.
+ */
+class I2cBus {
+public:
+    virtual ~I2cBus() {}
+    
+    /**
+     * @brief Write bytes to a device in one transaction
+     * @param address 7-bit device address
+     * @param data Bytes to send
+     * @param length Number of bytes
+     * @return true if the device acknowledged every byte
+     */
+    virtual bool write(uint8_t address, const uint8_t* data, uint8_t length) = 0;
+    
+    /**
+     * @brief Read bytes from a device in one transaction
+     * @param address 7-bit device address
+     * @param data Receives the bytes
+     * @param length Number of bytes
+     * @return true if all bytes were received
+     */
+    virtual bool read(uint8_t address, uint8_t* data, uint8_t length) = 0;
+};
+
+#ifndef UNIT_TEST
+
+/**
+ * @brief The Arduino Wire bus, shared by the display and external sensors
+ */
+class WireBus : public I2cBus {
+public:
+    /**
+     * @brief Start Wire on the board's I2C pins at I2C_CLOCK_HZ (once)
+     */
+    static void begin();
+    
+    bool write(uint8_t address, const uint8_t* data, uint8_t length);
+    bool read(uint8_t address, uint8_t* data, uint8_t length);
+
+private:
+    static bool started;
+};
+
+#endif // UNIT_TEST
+
+#endif // I2C_BUS_H
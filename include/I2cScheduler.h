@@ -0,0 +1,180 @@
+#ifndef I2C_SCHEDULER_H
+#define I2C_SCHEDULER_H
+
+#include <stdint.h>
+#include "config.h"
+#include "I2cBus.h"
+
+/**
+ * @brief Priority of a queued transaction (lower runs first)
+ */
+enum I2cPriority {
+    I2C_PRIORITY_SENSOR = 0,     // Sensor reads: short, latency sensitive
+    I2C_PRIORITY_DISPLAY = 1,    // Display updates: long, chunked
+    I2C_PRIORITY_COUNT = 2
+};
+
+/**
+ * @brief State of a queued transaction
+ */
+enum I2cStatus {
+    I2C_STATUS_IDLE = 0,         // Never submitted or cancelled
+    I2C_STATUS_PENDING = 1,      // Queued or partly sent
+    I2C_STATUS_DONE = 2,         // Completed
+    I2C_STATUS_FAILED = 3        // Device did not acknowledge
+};
+
+/**
+ * @brief One queued read or write, owned by the caller
+ *
+ * Writes longer than I2C_CHUNK_BYTES are sent in chunks, each its own bus
+ * transaction starting with the prefix byte (e.g. the SSD1306 data control
+ * byte), so higher-priority work can run between chunks.
+ */
+struct I2cTransaction {
+    uint8_t address;             // 7-bit device address
+    uint8_t priority;            // I2cPriority
+    bool isRead;                 // Read into data (at most I2C_CHUNK_BYTES) or write from it
+    bool hasPrefix;              // Send prefix before every write chunk
+    uint8_t prefix;
+    uint8_t* data;
+    uint16_t length;
+    
+    // Scheduler state
+    volatile uint8_t status;     // I2cStatus
+    uint16_t offset;             // Bytes already transferred
+    unsigned long queuedUs;      // Submission time
+};
+
+/**
+ * @brief Per-device bus accounting
+ */
+struct I2cDeviceStats {
+    uint8_t address;
+    unsigned long transactions;  // Completed transactions (a chunked write counts once)
+    unsigned long bytes;         // Data bytes transferred (including prefixes)
+    unsigned long errors;        // Failed transactions
+    unsigned long maxLatencyUs;  // Longest submission-to-completion time
+    unsigned long totalLatencyUs;
+};
+
+/**
+ * @brief Transaction queue and scheduler for a shared I2C bus
+ *
+ * poll() runs at most one bus transaction (one chunk of a long write), taking
+ * queued sensor work before display work, so a display update never holds
+ * the bus longer than one chunk. Call it from the main loop, or from a timer
+ * interrupt/task if the queued transactions are all the work on the bus.
+ *
+ * The scheduler is also an I2cBus: read()/write() run immediately between
+ * chunks at sensor priority, so drivers such as Ads1115 can use it directly.
+ * Latency is measured from submission to the end of the last chunk, with
+ * transfer times derived from the bus clock.
+ */
+class I2cScheduler : public I2cBus {
+public:
+    /**
+     * @brief Create a scheduler on a bus
+     * @param bus Underlying bus
+     * @param clockHz Bus clock used for transfer times
+     */
+    explicit I2cScheduler(I2cBus& bus, unsigned long clockHz = I2C_CLOCK_HZ);
+    
+    /**
+     * @brief Queue a transaction (restarts it from the beginning if already queued)
+     * @param transaction Transaction to run (must stay valid until done)
+     * @param nowUs Current time in microseconds
+     * @return false if the queue is full or the transaction is invalid
+     */
+    bool submit(I2cTransaction* transaction, unsigned long nowUs);
+    
+    /**
+     * @brief Remove a transaction from the queue
+     * @param transaction Transaction to drop (status becomes I2C_STATUS_IDLE)
+     */
+    void cancel(I2cTransaction* transaction);
+    
+    /**
+     * @brief Run the next transaction or chunk
+     * @param nowUs Current time in microseconds
+     * @return true if the bus was used
+     */
+    bool poll(unsigned long nowUs);
+    
+    /**
+     * @brief Run queued work until the queue is empty (blocking)
+     * @param nowUs Current time in microseconds
+     */
+    void drain(unsigned long nowUs);
+    
+    /**
+     * @brief Check if no work is queued
+     * @return true if all queues are empty
+     */
+    bool isIdle() const;
+    
+    /**
+     * @brief Get the accounting of one device
+     * @param address 7-bit device address
+     * @param stats Receives the statistics
+     * @return false if the device has not been used
+     */
+    bool getDeviceStats(uint8_t address, I2cDeviceStats* stats) const;
+    
+    /**
+     * @brief Get the total time the bus was in use
+     * @return Busy time in microseconds (from the bus clock)
+     */
+    unsigned long getBusyMicros() const;
+    
+    /**
+     * @brief Immediate write at sensor priority (not while poll() is running)
+     */
+    bool write(uint8_t address, const uint8_t* data, uint8_t length);
+    
+    /**
+     * @brief Immediate read at sensor priority (not while poll() is running)
+     */
+    bool read(uint8_t address, uint8_t* data, uint8_t length);
+    
+    /**
+     * @brief Time one transaction occupies the bus
+     * @param bytes Data bytes after the address byte
+     * @param clockHz Bus clock
+     * @return Microseconds (start, address, data with acks, stop)
+     */
+    static unsigned long transferMicros(int bytes, unsigned long clockHz);
+
+#ifndef UNIT_TEST
+    /**
+     * @brief Scheduler on the Wire bus shared by the display and sensors
+     * @return The shared scheduler (Wire is started on first use)
+     */
+    static I2cScheduler& shared();
+#endif
+
+private:
+    static const int QUEUE_DEPTH = I2C_QUEUE_DEPTH;
+    
+    I2cDeviceStats* statsFor(uint8_t address);
+    void record(uint8_t address, int bytes, bool ok, unsigned long latencyUs);
+    void complete(I2cTransaction* transaction, bool ok, unsigned long endUs);
+    int find(const I2cTransaction* transaction, int* index) const;
+    void removeHead(int priority);
+    
+    I2cBus& bus;
+    unsigned long clockHz;
+    volatile bool busy;          // A transaction is on the bus
+    unsigned long busyMicros;
+    
+    // FIFO per priority
+    I2cTransaction* queues[I2C_PRIORITY_COUNT][I2C_QUEUE_DEPTH];
+    uint8_t heads[I2C_PRIORITY_COUNT];
+    uint8_t counts[I2C_PRIORITY_COUNT];
+    
+    uint8_t chunk[I2C_CHUNK_BYTES + 1];
+    I2cDeviceStats stats[I2C_MAX_DEVICES];
+    uint8_t deviceCount;
+};
+
+#endif // I2C_SCHEDULER_H
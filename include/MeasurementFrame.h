@@ -0,0 +1,73 @@
+#ifndef MEASUREMENT_FRAME_H
+#define MEASUREMENT_FRAME_H
+
+#include <stdint.h>
+#include "config.h"
+
+/**
+ * @brief One measurement in the binary serial format ("$format=binary")
+ *
+ * Fixed-point fields, so a frame is 22 bytes instead of a ~60 byte CSV line.
+ */
+struct MeasurementFrame {
+    uint32_t timeMs;             // Device millis() at the measurement
+    uint16_t raw;                // Averaged raw ADC value
+    uint16_t millivolts;         // Battery voltage
+    uint8_t cellCount;           // 0 = invalid reading
+    uint8_t confidence;          // Cell count confidence (%)
+    uint16_t cellMillivolts;     // Average cell voltage
+    uint8_t charge;              // Charge (%)
+    uint8_t flags;               // MEASUREMENT_FRAME_TREND
+    int16_t trendDeciMvPerMin;   // Discharge rate (0.1 mV/min, negative = discharging)
+    int16_t minutesToEmpty;      // -1 = not discharging or no trend
+};
+
+// MeasurementFrame::flags
+#define MEASUREMENT_FRAME_TREND 0x01     // trendDeciMvPerMin and minutesToEmpty are valid
+
+/**
+ * @brief Encoder and decoder of binary measurement frames
+ *
+ * Layout (little endian):
+ *
+ *   0xA5 0x5A | type (1) | 18-byte payload | CRC-8 of type and payload
+ *
+ * The two sync bytes cannot both appear in the text output, so a reader can
+ * find frames in a stream that mixes them with ordinary text lines and
+ * resynchronize after a corrupt frame. The firmware only encodes; the host
+ * ingest daemon decodes with the same code.
+ */
+class MeasurementFrameCodec {
+public:
+    static const uint8_t SYNC_0 = 0xA5;
+    static const uint8_t SYNC_1 = 0x5A;
+    static const uint8_t TYPE_MEASUREMENT = 1;
+    static const int PAYLOAD_SIZE = 18;
+    static const int FRAME_SIZE = 2 + 1 + PAYLOAD_SIZE + 1;
+    
+    /**
+     * @brief Encode a frame
+     * @param frame Measurement
+     * @param out Receives FRAME_SIZE bytes
+     * @return FRAME_SIZE
+     */
+    static int encode(const MeasurementFrame& frame, uint8_t* out);
+    
+    /**
+     * @brief Decode a complete frame
+     * @param data FRAME_SIZE bytes starting with the sync bytes
+     * @param frame Receives the measurement
+     * @return false if the sync, type or CRC does not match
+     */
+    static bool decode(const uint8_t* data, MeasurementFrame* frame);
+    
+    /**
+     * @brief CRC-8 (polynomial 0x07) used by the frames
+     * @param data Bytes
+     * @param length Number of bytes
+     * @return CRC
+     */
+    static uint8_t crc8(const uint8_t* data, int length);
+};
+
+#endif // MEASUREMENT_FRAME_H
@@ -0,0 +1,218 @@
+#ifndef MEASUREMENT_LOG_H
+#define MEASUREMENT_LOG_H
+
+#include <stdint.h>
+#include "config.h"
+#include "FlashStorage.h"
+
+/* Log Format (version 1)
+ *
+ * The storage is a ring of pages written in order; each page starts with
+ *
+ *   0  'M' 'L'          magic
+ *   2  version          1
+ *   3  reserved         0
+ *   4  sequence         uint32, +1 per page opened (newest page = highest)
+ *   8  firstSession     uint16, session of the first record in the page
+ *   10 reserved         0xFFFF
+ *
+ * followed by 4-byte records until the first erased (0xFF) record:
+ *
+ *   session  0x80|chem  id lo  id hi  cellCount
+ *   reading  dt (0-127) mV/10 lo  mV/10 hi  charge %
+ *
+ * where dt is the seconds since the previous reading of the session.
+ * All multi-byte fields are little endian.
+ */
+
+/**
+ * @brief Decoded page header
+ */
+struct LogPageHeader {
+    uint32_t sequence;       // Page write order
+    uint16_t firstSession;   // Session of the first record in the page
+};
+
+/**
+ * @brief Record kinds in a log page
+ */
+enum LogRecordType {
+    LOG_RECORD_ERASED = 0,   // End of the written part of the page
+    LOG_RECORD_SESSION = 1,  // Start of a session
+    LOG_RECORD_READING = 2,  // One measurement
+    LOG_RECORD_INVALID = 3   // Torn by a power loss during the write
+};
+
+/**
+ * @brief Decoded log record
+ */
+struct LogRecord {
+    LogRecordType type;
+    uint16_t session;        // Session id (session records)
+    uint8_t chemistry;       // ChemistryType (session records)
+    uint8_t cellCount;       // Cell count (session records)
+    uint8_t deltaSeconds;    // Seconds since the previous reading (reading records)
+    float voltage;           // Total battery voltage (reading records)
+    uint8_t chargePercentage; // Charge percentage (reading records)
+};
+
+/**
+ * @brief Location and metadata of a logged session
+ */
+struct LogSession {
+    uint16_t id;
+    uint8_t chemistry;
+    uint8_t cellCount;
+    uint32_t pageSequence;   // Page holding the session record
+    uint32_t offset;         // Byte offset of the session record in that page
+};
+
+/**
+ * @brief Position of a streaming dump
+ */
+struct LogDumpCursor {
+    uint32_t page;           // Pages emitted so far (oldest first)
+    uint32_t offset;         // Next byte in the current page
+    bool started;            // Header line emitted
+    bool done;               // End line emitted
+};
+
+/**
+ * @brief Persistent append-only log of sessions and readings
+ *
+ * Records are collected in a LOG_BATCH_BYTES RAM batch and programmed in one
+ * write when the batch is full or flush() is called, so flash sees one write
+ * per batch instead of one per reading. Pages are used as a ring: when the
+ * current page is full the next one (holding the oldest data) is erased and
+ * opened, so every page is erased once per pass and wear is spread evenly.
+ *
+ * The page headers are the index: begin() reads only the headers plus the
+ * newest page, and findSessions() skips pages whose header shows they
+ * belong to a single session. Data still in the batch is lost on power-off;
+ * flush when a pack is removed.
+ */
+class MeasurementLog {
+public:
+    /**
+     * @brief Create a log on a storage backend
+     * @param storage Storage holding the log (begin() is called by the log)
+     */
+    explicit MeasurementLog(FlashStorage& storage);
+
+    /**
+     * @brief Mount the log: find the newest page and the end of its records
+     * @return true if the storage is usable
+     */
+    bool begin();
+
+    /**
+     * @brief Start a new session
+     * @param chemistry Selected chemistry (ChemistryType)
+     * @param cellCount Detected cell count
+     * @return Session id (1-65535)
+     */
+    uint16_t startSession(uint8_t chemistry, uint8_t cellCount);
+
+    /**
+     * @brief Append a reading to the current session
+     * @param timeMs Reading time (millis())
+     * @param voltage Total battery voltage
+     * @param chargePercentage Charge percentage (0-100)
+     */
+    void logReading(unsigned long timeMs, float voltage, int chargePercentage);
+
+    /**
+     * @brief Program the pending batch to storage
+     */
+    void flush();
+
+    /**
+     * @brief Find the newest sessions
+     * @param sessions Receives the sessions, newest first
+     * @param maxSessions Capacity of sessions
+     * @return Number of sessions found (flushed records only)
+     */
+    int findSessions(LogSession* sessions, int maxSessions);
+
+    /**
+     * @brief Start a streaming dump of every page, oldest first
+     * @param cursor Cursor to initialize
+     */
+    void startDump(LogDumpCursor* cursor) const;
+
+    /**
+     * @brief Produce the next dump line (decode with the simulator's log_decoder)
+     *
+     * Lines are "#LOG 1 <pageSize> <pages>", then "<sequence> <offset> <hex>"
+     * per 32 written bytes, then "#END".
+     * @param cursor Dump position
+     * @param line Receives the line (LOG_DUMP_LINE_SIZE bytes)
+     * @return false when the dump is complete
+     */
+    bool nextDumpLine(LogDumpCursor* cursor, char* line);
+
+    /**
+     * @brief Get the id of the newest session
+     * @return Session id, 0 if none was ever logged
+     */
+    uint16_t getCurrentSession() const;
+
+    /**
+     * @brief Get the number of pages holding log data
+     * @return Valid pages (at most the storage page count)
+     */
+    uint32_t getUsedPages() const;
+
+    /**
+     * @brief Decode a page header
+     * @param bytes LOG_HEADER_SIZE bytes from the start of a page
+     * @param header Receives the header
+     * @return true if the page holds a valid header
+     */
+    static bool decodePageHeader(const uint8_t* bytes, LogPageHeader* header);
+
+    /**
+     * @brief Decode one 4-byte record
+     * @param bytes Record bytes
+     * @param record Receives the record
+     * @return Record type
+     */
+    static LogRecordType decodeRecord(const uint8_t* bytes, LogRecord* record);
+
+    static const uint32_t LOG_HEADER_SIZE = 12;
+    static const uint32_t LOG_RECORD_SIZE = 4;
+    static const int LOG_DUMP_LINE_SIZE = 96;
+
+private:
+    void appendRecord(const uint8_t* record);
+    bool openNextPage(uint16_t firstSession);
+    bool readHeader(uint32_t page, LogPageHeader* header);
+    const uint8_t* readRecord(uint32_t page, uint32_t offset);
+    uint32_t pageForAge(uint32_t age) const;
+
+    FlashStorage& storage;
+    bool mounted;
+    uint32_t pageSize;
+    uint32_t pageCount;
+
+    // Newest page and write position
+    bool pageOpen;
+    uint32_t currentPage;
+    uint32_t currentSequence;
+    uint32_t writeOffset;
+
+    // Sessions and the RAM batch
+    uint16_t currentSession;
+    uint16_t batchSession;   // Session in effect before the first batched record
+    uint8_t batch[LOG_BATCH_BYTES];
+    int batchUsed;
+    bool hasReading;
+    unsigned long lastReadingMs;
+
+    // One-chunk read cache for record scans
+    uint8_t cache[LOG_BATCH_BYTES];
+    uint32_t cacheAddress;
+    bool cacheValid;
+};
+
+#endif // MEASUREMENT_LOG_H
@@ -0,0 +1,153 @@
+#ifndef MEASUREMENT_TASKS_H
+#define MEASUREMENT_TASKS_H
+
+#include <Arduino.h>
+#include <stdint.h>
+#include "config.h"
+#include "BatteryAnalyzer.h"
+#include "BlockSampler.h"
+#include "CellCountTracker.h"
+#include "ConnectionWatcher.h"
+#include "SampleQueue.h"
+#include "SampleSource.h"
+#include "SessionHistory.h"
+#include "TrendEstimator.h"
+#if BALANCE_TAP_COUNT > 0
+#include "BalanceReader.h"
+#endif
+
+/**
+ * @brief Sampling, analysis and display task bodies on instance state
+ *
+ * The firmware's measurement path from one ADC backend to the shown
+ * reading: BlockSampler blocks through the SampleQueue, CellCountTracker,
+ * ChemistrySelector's analysis, TrendEstimator and SessionHistory, and the
+ * serial output of each step at the set verbosity and format. main.cpp runs
+ * one instance from its scheduled tasks with millis() and Serial; the
+ * simulator's virtual testers and parameter search run one per tester or
+ * session with their own ADC, clock and output, so they measure exactly
+ * what the firmware does.
+ *
+ * The caller owns the schedule and the hardware: it triggers the analysis
+ * when isAnalysisDue(), draws getInfo() when display() returns true, and
+ * clears the screen and closes the log session on a disconnect.
+ */
+class MeasurementTasks {
+public:
+    /**
+     * @brief Create the tasks' state
+     * @param source ADC backend (read only by the sampling task)
+     * @param out Serial output of the measurements
+     */
+    MeasurementTasks(SampleSource& source, Print& out);
+    virtual ~MeasurementTasks() {}
+    
+    /**
+     * @brief Set what the tasks write to the output
+     * @param level DEBUG_LEVEL_* (as DebugLogger::setLevel())
+     * @param format OUTPUT_FORMAT_* (as DebugLogger::setFormat())
+     */
+    void setOutput(int level, int format);
+
+#if BALANCE_TAP_COUNT > 0
+    /**
+     * @brief Read the balance leads on every valid analysis
+     * @param reader Balance-lead reader (nullptr for total voltage only)
+     */
+    void setBalanceReader(BalanceReader* reader);
+#endif
+
+    /**
+     * @brief Sampling task body: poll the ADC backend once
+     *
+     * A removal resets the tracker, trend, session history and the latest
+     * analysis, so nothing stale is shown or logged.
+     * @param nowMs Current time in milliseconds
+     * @return Connection event confirmed by this run, or CONNECTION_NONE
+     */
+    ConnectionEvent sample(unsigned long nowMs);
+    
+    /**
+     * @brief Check whether the last sample() completed the first block of a new pack
+     * @return true if the analysis should run now instead of at its next period
+     */
+    bool isAnalysisDue() const;
+    
+    /**
+     * @brief Analysis task body: drain the sample queue and analyze the connected pack
+     *
+     * Blocks from before the last plug-in belong to another pack and are discarded.
+     * @param nowMs Current time in milliseconds
+     * @return true if a new analysis is ready for the display (see getInfo())
+     */
+    bool analyze(unsigned long nowMs);
+    
+    /**
+     * @brief Display task body: report the latest analysis as shown, once
+     *
+     * The first frame after a plug-in also reports the connect-to-display latency.
+     * @param nowMs Current time in milliseconds
+     * @return true if the caller should draw getInfo() and getTrend()
+     */
+    bool display(unsigned long nowMs);
+    
+    const BatteryInfo& getInfo() const { return latestInfo; }
+    const TrendInfo& getTrend() const { return latestTrend; }
+    float getVoltage() const { return latestVoltage; }
+    
+    /**
+     * @brief Get the unconverted average of the latest analysis (calibration)
+     * @return Average raw value, 0 without a pack
+     */
+    float getRawAverage() const { return latestRawAverage; }
+    
+    /**
+     * @brief Get the blocks the sample queue dropped since boot
+     * @return Lost blocks (sequence gaps)
+     */
+    unsigned long getLostBlocks() const { return lostBlocks; }
+    
+    ConnectionWatcher& getWatcher() { return watcher; }
+    CellCountTracker& getTracker() { return tracker; }
+    BlockSampler& getSampler() { return sampler; }
+    const SessionHistory& getHistory() const { return history; }
+
+protected:
+    /**
+     * @brief Convert an averaged raw value to the battery voltage
+     *
+     * VoltageReader's conversion; the simulator overrides it for boards
+     * whose ADC differs from the host build's.
+     */
+    virtual float toBatteryVoltage(int rawValue) const;
+
+private:
+    bool textEnabled(int level) const;
+    
+    Print& out;
+    int debugLevel;
+    int outputFormat;
+    
+    ConnectionWatcher watcher;
+    CellCountTracker tracker;
+    TrendEstimator trend;
+    SessionHistory history;
+    SampleQueue queue;
+    BlockSampler sampler;
+#if BALANCE_TAP_COUNT > 0
+    BalanceReader* balanceReader;
+#endif
+
+    uint16_t expectedSequence;
+    unsigned long lostBlocks;
+    bool latencyPending;     // Set on plug-in until the first measurement of the new pack is displayed
+    
+    // Latest analysis, drawn by the display task and logged by the log task
+    BatteryInfo latestInfo;
+    TrendInfo latestTrend;
+    float latestVoltage;
+    float latestRawAverage;
+    bool displayPending;
+};
+
+#endif // MEASUREMENT_TASKS_H
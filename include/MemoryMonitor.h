@@ -0,0 +1,102 @@
+#ifndef MEMORY_MONITOR_H
+#define MEMORY_MONITOR_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "config.h"
+
+#if MEMORY_MONITOR
+
+/**
+ * @brief Stack and heap headroom of one loop stage since power-on
+ *
+ * Stack figures are relative to the stack pointer when MemoryMonitor::begin()
+ * ran (the top of setup(), the depth loop() also runs at): used is how far
+ * below it the stage reached at its deepest, free how many untouched bytes
+ * were left below that. Heap figures are taken when a run ends.
+ */
+struct MemoryStats {
+    unsigned long runs;
+    size_t stackUsed;        // Deepest stack below the reference point
+    size_t stackFree;        // Painted bytes left below the deepest point
+    size_t heapUsed;         // Largest heap in use after a run
+    size_t heapFree;         // Smallest free heap after a run
+};
+
+/**
+ * @brief Stack-painting high-water marks and free-heap tracking per loop stage
+ *
+ * begin() fills the unused stack below the caller with a known byte
+ * pattern. After each run of a stage (a scheduler task, or setup()),
+ * leaveStage() scans up from the bottom of the painted area for the first
+ * overwritten byte, keeps the lowest one per stage, and paints the touched
+ * part again so the next stage is measured on its own. The cost is a pass
+ * over the painted area per run, so the monitor is only compiled in with
+ * MEMORY_MONITOR; the 'M' serial key reports it (DebugLogger::logMemoryStats).
+ *
+ * Interrupts and whatever runs between two stages count towards the next
+ * stage, so a stage's figure is the real requirement at that point.
+ *
+ * Platforms:
+ * - AVR: heap and stack share the SRAM above .bss; the painted area starts
+ *   at the heap top, and free stack is measured down to the current heap
+ *   top (malloc() grows into it). Free heap is the gap between the heap top
+ *   and the stack pointer.
+ * - ESP32: the loop task's stack from its start (pxTaskGetStackStart()),
+ *   free heap from the ESP-IDF heap.
+ * - Host: MEMORY_HOST_STACK_BYTES below setup() are reserved and painted,
+ *   heap figures come from mallinfo2() where glibc has it (0 elsewhere).
+ *   Host frames are larger than the targets', so compare host figures with
+ *   each other, not with the boards.
+ */
+class MemoryMonitor {
+public:
+    static const int SETUP_STAGE = TASK_MAX_TASKS;  // Task ids are the other stages
+    static const int STAGE_COUNT = TASK_MAX_TASKS + 1;
+    
+    /**
+     * @brief Paint the free stack and start measuring (first thing in setup())
+     */
+    static void begin();
+    
+    /**
+     * @brief Record the stack and heap a stage used and repaint what it touched
+     * @param stage Task id (see TaskScheduler::addTask) or SETUP_STAGE
+     */
+    static void leaveStage(int stage);
+    
+    /**
+     * @brief Get a stage's headroom
+     * @param stage Task id or SETUP_STAGE
+     * @return Statistics since begin() (runs = 0 if the stage never ran)
+     */
+    static const MemoryStats& getStats(int stage);
+    
+    /**
+     * @brief Get the bytes painted by begin()
+     * @return Size of the painted stack area (0 before begin())
+     */
+    static size_t getPaintedBytes();
+    
+    /**
+     * @brief Get the bytes in use on the heap now
+     */
+    static size_t heapUsed();
+    
+    /**
+     * @brief Get the bytes free on the heap now
+     */
+    static size_t heapFree();
+
+private:
+    static uintptr_t scanFloor();
+    
+    static uintptr_t top;            // Stack pointer at begin()
+    static uintptr_t bottom;         // Lowest painted address
+    static uintptr_t lowest[STAGE_COUNT]; // Deepest address per stage, 0 = not measured
+    static MemoryStats stats[STAGE_COUNT];
+};
+
+#endif // MEMORY_MONITOR
+
+#endif // MEMORY_MONITOR_H
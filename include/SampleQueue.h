@@ -0,0 +1,94 @@
+#ifndef SAMPLE_QUEUE_H
+#define SAMPLE_QUEUE_H
+
+#include <stdint.h>
+#include "config.h"
+
+#ifndef __AVR__
+#include <atomic>
+#endif
+
+/**
+ * @brief One averaged block of raw ADC samples
+ */
+struct SampleRecord {
+    uint32_t timeMs;         // Time of the last sample in the block (millis())
+    uint16_t raw;            // Average raw ADC value of the block
+    uint16_t sequence;       // +1 per block produced, dropped ones included
+};
+
+/**
+ * @brief Lock-free single-producer/single-consumer ring of SampleRecords
+ *
+ * The producer (sampling task or ADC interrupt) only writes head, the
+ * consumer (analysis) only writes tail, so no lock is needed as long as
+ * there is exactly one of each. Indices run freely and wrap; the slot is
+ * index % SAMPLE_QUEUE_DEPTH.
+ *
+ * Ordering: a record is written before head is published with release
+ * semantics and read after head is loaded with acquire semantics (and the
+ * same for tail in the other direction), so the consumer never sees a
+ * partly written record. On ESP32-C3 (RISC-V without the atomic extension)
+ * these are plain loads and stores with fences; no read-modify-write is
+ * used. On AVR the indices are single bytes, which the CPU reads and writes
+ * in one instruction even when an interrupt fires, and a compiler barrier
+ * keeps the record accesses on the right side of the index update.
+ *
+ * A full queue drops the new record (push() returns false); the consumer
+ * sees the gap in the sequence numbers.
+ */
+class SampleQueue {
+public:
+    /**
+     * @brief Create an empty queue
+     */
+    SampleQueue();
+    
+    /**
+     * @brief Append a record (producer side only)
+     * @param record Record to copy into the queue
+     * @return false if the queue was full and the record was dropped
+     */
+    bool push(const SampleRecord& record);
+    
+    /**
+     * @brief Remove the oldest record (consumer side only)
+     * @param record Receives the record
+     * @return false if the queue is empty
+     */
+    bool pop(SampleRecord* record);
+    
+    /**
+     * @brief Drop every queued record (consumer side only)
+     */
+    void clear();
+    
+    /**
+     * @brief Get the number of queued records
+     * @return Records available to pop() (a snapshot if the producer is running)
+     */
+    int size() const;
+
+private:
+#ifdef __AVR__
+    typedef uint8_t Index;
+    volatile Index head;     // Next slot to write (producer)
+    volatile Index tail;     // Next slot to read (consumer)
+#else
+    typedef uint16_t Index;
+    std::atomic<Index> head;
+    std::atomic<Index> tail;
+#endif
+
+    Index loadHead() const;
+    Index loadTail() const;
+    void storeHead(Index value);
+    void storeTail(Index value);
+    
+    SampleRecord records[SAMPLE_QUEUE_DEPTH];
+    
+    static_assert((SAMPLE_QUEUE_DEPTH & (SAMPLE_QUEUE_DEPTH - 1)) == 0, "SAMPLE_QUEUE_DEPTH must be a power of two");
+    static_assert(SAMPLE_QUEUE_DEPTH <= (Index)~(Index)0 / 2 + 1, "SAMPLE_QUEUE_DEPTH too large for the index type");
+};
+
+#endif // SAMPLE_QUEUE_H
@@ -0,0 +1,53 @@
+#ifndef SAMPLE_SOURCE_H
+#define SAMPLE_SOURCE_H
+
+/**
+ * @brief An ADC backend as the sampling task reads it
+ *
+ * Conversions collect in a batch until startBatch() clears it; poll() never
+ * blocks. What one poll() adds depends on the backend: one analogRead(), the
+ * ADS1115's next conversion once the chip has one, or the newest block of
+ * conversions the free-running interrupt finished.
+ */
+class SampleSource {
+public:
+    virtual ~SampleSource() {}
+    
+    /**
+     * @brief Clear the sample batch
+     */
+    virtual void startBatch() = 0;
+    
+    /**
+     * @brief Add what the ADC finished since the last call to the batch
+     * @return true if samples were added
+     */
+    virtual bool poll() = 0;
+    
+    /**
+     * @brief Get the number of conversions in the batch
+     * @return Conversions added since startBatch()
+     */
+    virtual int getBatchCount() const = 0;
+    
+    /**
+     * @brief Get the batch average
+     * @return Average raw value, 0 if the batch is empty
+     */
+    virtual int getBatchAverage() const = 0;
+    
+    /**
+     * @brief Get the latest single conversion
+     * @return Raw value, 0 before the first conversion
+     */
+    virtual int getLatest() const = 0;
+    
+    /**
+     * @brief Let the ADC make progress before poll()
+     *
+     * Only backends that convert while the CPU sleeps need this.
+     */
+    virtual void idle() {}
+};
+
+#endif // SAMPLE_SOURCE_H
@@ -0,0 +1,142 @@
+#ifndef SESSION_HISTORY_H
+#define SESSION_HISTORY_H
+
+#include <stdint.h>
+#include "config.h"
+
+/**
+ * @brief Readings of the connected pack in a compact ring, with session statistics
+ *
+ * Voltages are quantized to HISTORY_RESOLUTION_MV and stored as deltas from
+ * the previous reading in a fixed byte ring (no heap):
+ *
+ *   -127..127 steps    1 byte (int8)
+ *   larger jumps       0x80 escape + 2 bytes (int16, little endian)
+ *
+ * Only the oldest reading is kept as an absolute value; evicting it decodes
+ * the next delta. A resting or slowly discharging pack costs about one byte
+ * per reading instead of the 20+ bytes of a BatteryInfo.
+ *
+ * Minimum, maximum, mean and standard deviation cover every reading since
+ * reset() (not only the buffered ones) and are updated in O(1) per reading
+ * with Welford's algorithm. Sag events (sudden drops under load) are counted
+ * as readings arrive.
+ */
+class SessionHistory {
+public:
+    /**
+     * @brief Create an empty history
+     */
+    SessionHistory();
+    
+    /**
+     * @brief Start a new session (call on disconnect or pack change)
+     */
+    void reset();
+    
+    /**
+     * @brief Add one battery voltage reading
+     * @param voltage Total battery voltage
+     */
+    void append(float voltage);
+    
+    /**
+     * @brief Get the number of buffered readings
+     * @return Readings available for getReadings() and sparkline()
+     */
+    int getCount() const;
+    
+    /**
+     * @brief Get the number of readings in the session
+     * @return Readings since reset(), including ones evicted from the buffer
+     */
+    unsigned long getSessionCount() const;
+    
+    /**
+     * @brief Get the bytes of the ring currently in use
+     * @return Encoded size of the buffered readings
+     */
+    int getBytesUsed() const;
+    
+    /**
+     * @brief Get the lowest session voltage
+     * @return Minimum voltage (0 if empty)
+     */
+    float getMinimum() const;
+    
+    /**
+     * @brief Get the highest session voltage
+     * @return Maximum voltage (0 if empty)
+     */
+    float getMaximum() const;
+    
+    /**
+     * @brief Get the mean session voltage
+     * @return Mean voltage (0 if empty)
+     */
+    float getMean() const;
+    
+    /**
+     * @brief Get the standard deviation of the session voltage
+     * @return Population standard deviation (0 if fewer than 2 readings)
+     */
+    float getStdDev() const;
+    
+    /**
+     * @brief Get the number of sag events
+     * @return Drops of at least HISTORY_SAG_DROP_V between consecutive readings
+     */
+    int getSagCount() const;
+    
+    /**
+     * @brief Get the deepest sag of the session
+     * @return Largest drop below the pre-sag voltage (V)
+     */
+    float getDeepestSag() const;
+    
+    /**
+     * @brief Decode the newest buffered readings, oldest first
+     * @param voltages Receives the voltages (quantized to HISTORY_RESOLUTION_MV)
+     * @param maxReadings Capacity of voltages
+     * @return Number of readings written
+     */
+    int getReadings(float* voltages, int maxReadings) const;
+    
+    /**
+     * @brief Downsample the buffered readings into bar heights
+     * @param heights Receives one height per column (0-maxHeight), oldest first
+     * @param columns Number of columns available
+     * @param maxHeight Height of the highest buffered voltage
+     * @return Number of columns filled (fewer than columns if few readings)
+     */
+    int sparkline(uint8_t* heights, int columns, int maxHeight) const;
+
+private:
+    void pushRecord(int delta);
+    int popRecord();
+    int recordAt(int* offset) const;
+    
+    // Delta-encoded ring, oldest record at head
+    uint8_t buffer[HISTORY_BUFFER_BYTES];
+    int head;
+    int used;
+    int count;               // Buffered readings (records + the absolute oldest one)
+    int oldestSteps;         // Oldest buffered reading, in HISTORY_RESOLUTION_MV steps
+    int newestSteps;         // Newest reading, in HISTORY_RESOLUTION_MV steps
+    
+    // Session statistics (Welford)
+    unsigned long sessionCount;
+    float mean;
+    float m2;
+    float minimum;
+    float maximum;
+    
+    // Sag detection
+    float lastVoltage;
+    bool inSag;
+    float sagReference;      // Voltage before the current sag
+    int sagCount;
+    float deepestSag;
+};
+
+#endif // SESSION_HISTORY_H
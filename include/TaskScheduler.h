@@ -0,0 +1,142 @@
+#ifndef TASK_SCHEDULER_H
+#define TASK_SCHEDULER_H
+
+#include <stdint.h>
+#include "config.h"
+
+/**
+ * @brief Task entry point (runs to completion; must not block for long)
+ */
+typedef void (*TaskFunction)();
+
+/**
+ * @brief Timing statistics of one task since the last resetStats()
+ *
+ * Lateness is the time from a task's release (the moment it became due) to
+ * the start of its run; the spread between the smallest and largest
+ * lateness is the release jitter.
+ */
+struct TaskStats {
+    unsigned long runs;
+    unsigned long overruns;          // Runs that finished after release + deadline
+    unsigned long skipped;           // Releases dropped because the task fell a whole period behind
+    unsigned long minLatenessUs;
+    unsigned long maxLatenessUs;
+    unsigned long totalLatenessUs;   // Sum over runs (average = total / runs)
+    unsigned long maxDurationUs;     // Longest run
+};
+
+/**
+ * @brief Static, allocation-free cooperative scheduler for periodic tasks
+ *
+ * Each task has a period and a relative deadline. runOnce() runs the due
+ * task with the earliest absolute deadline (release + deadline) and returns;
+ * tasks are never preempted, so a long task delays the others and shows up
+ * in their lateness. Releases advance by whole periods from the first one,
+ * so a late run does not shift the schedule; a task that falls more than a
+ * period behind runs once and skips the missed releases.
+ *
+ * Time comes from a clock function in microseconds: micros() on the targets
+ * and a virtual clock in host tests, so the same code runs everywhere and
+ * the timing can be tested deterministically. Times are kept and differenced
+ * as 32-bit values, the width of micros() on the targets, so the wraparound
+ * (~71 minutes) is handled even where unsigned long is 64 bits wide.
+ */
+class TaskScheduler {
+public:
+    typedef unsigned long (*Clock)();
+    
+    /**
+     * @brief Create an empty scheduler
+     * @param clock Time source in microseconds
+     */
+    explicit TaskScheduler(Clock clock);
+    
+    /**
+     * @brief Add a periodic task, first released now
+     * @param name Task name for statistics (static string)
+     * @param function Task entry point
+     * @param periodUs Time between releases (> 0)
+     * @param deadlineUs Time after a release by which the run must finish
+     * @return Task id, or -1 if the table (TASK_MAX_TASKS) is full
+     */
+    int addTask(const char* name, TaskFunction function, unsigned long periodUs, unsigned long deadlineUs);
+    
+    /**
+     * @brief Enable or disable a task (an enabled task is released immediately)
+     * @param id Task id
+     * @param enabled true to run the task
+     */
+    void setEnabled(int id, bool enabled);
+    
+    /**
+     * @brief Change a task's period (takes effect after its next run)
+     * @param id Task id
+     * @param periodUs New time between releases (> 0)
+     */
+    void setPeriod(int id, unsigned long periodUs);
+    
+    /**
+     * @brief Release a task now instead of at its next period
+     *
+     * Later releases follow one period after this one.
+     * @param id Task id
+     */
+    void trigger(int id);
+    
+    /**
+     * @brief Run the most urgent due task
+     * @return true if a task ran, false if none was due
+     */
+    bool runOnce();
+    
+    /**
+     * @brief Get the time until the next release
+     * @return Microseconds until a task is due (0 if one is due now)
+     */
+    unsigned long timeUntilNext() const;
+    
+    /**
+     * @brief Get the number of tasks
+     * @return Tasks added
+     */
+    int getTaskCount() const;
+    
+    /**
+     * @brief Get a task's name
+     * @param id Task id
+     * @return Name passed to addTask()
+     */
+    const char* getName(int id) const;
+    
+    /**
+     * @brief Get a task's timing statistics
+     * @param id Task id
+     * @return Statistics since the last resetStats()
+     */
+    const TaskStats& getStats(int id) const;
+    
+    /**
+     * @brief Clear the statistics of every task
+     */
+    void resetStats();
+
+private:
+    struct Task {
+        const char* name;
+        TaskFunction function;
+        unsigned long periodUs;
+        unsigned long deadlineUs;
+        uint32_t releaseUs;          // Current (or next) release time
+        bool enabled;
+        TaskStats stats;
+    };
+    
+    static void clearStats(TaskStats* stats);
+    
+    Clock clock;
+    Task tasks[TASK_MAX_TASKS];
+    int taskCount;
+};
+
+#endif // TASK_SCHEDULER_H
@@ -0,0 +1,98 @@
+#ifndef TREND_ESTIMATOR_H
+#define TREND_ESTIMATOR_H
+
+#include <stdint.h>
+#include "config.h"
+
+/**
+ * @brief Result of a discharge trend estimate
+ */
+struct TrendInfo {
+    bool isValid;              // Enough history for a trend (TREND_MIN_SPAN_MS)
+    float millivoltsPerMinute; // Slope of the pack voltage (negative = discharging)
+    long minutesToEmpty;       // Minutes until the floor voltage, -1 if not discharging
+};
+
+/**
+ * @brief Sliding-window linear regression of pack voltage over time
+ *
+ * Readings are averaged into one point per bucketMs, and the last
+ * TREND_WINDOW_SIZE points are kept in a fixed ring (no heap). The least
+ * squares fit uses running sums
+ *
+ *   n, St, Sv, Stt, Stv    (t in ms since the oldest point, v in mV)
+ *
+ * kept as exact 64-bit integers, so adding and evicting a point is O(1) and
+ * the sums never drift however long the pack stays connected. When the oldest
+ * point is evicted the time origin moves to the next point by d ms:
+ *
+ *   St -= n*d,   Stt += n*d*d - 2*d*St,   Stv -= d*Sv
+ *
+ * Time offsets are unsigned differences, so millis() wraparound is harmless.
+ */
+class TrendEstimator {
+public:
+    /**
+     * @brief Create an empty estimator
+     * @param bucketIntervalMs Readings are averaged into one point until this much
+     *        time has passed since the first of them (0 = every reading is a point)
+     */
+    explicit TrendEstimator(unsigned long bucketIntervalMs = TREND_BUCKET_MS);
+    
+    /**
+     * @brief Forget all history (call on disconnect or pack change)
+     */
+    void reset();
+    
+    /**
+     * @brief Add one battery voltage reading
+     * @param timeMs Reading time (millis())
+     * @param voltage Total battery voltage
+     */
+    void update(unsigned long timeMs, float voltage);
+    
+    /**
+     * @brief Estimate discharge rate and time to a floor voltage
+     * @param floorVoltage Pack voltage treated as empty (e.g. 3.3V x cells)
+     * @return TrendInfo (invalid until the window spans TREND_MIN_SPAN_MS)
+     */
+    TrendInfo estimate(float floorVoltage) const;
+    
+    /**
+     * @brief Get the number of points in the regression window
+     * @return Point count (0-TREND_WINDOW_SIZE)
+     */
+    int getCount() const;
+    
+    /**
+     * @brief Get the time covered by the regression window
+     * @return Milliseconds between the oldest and newest point
+     */
+    unsigned long getSpanMs() const;
+
+private:
+    void addPoint(unsigned long timeMs, int32_t millivolts);
+    void removeOldest();
+    
+    unsigned long bucketMs;
+    
+    // Bucket being accumulated
+    unsigned long bucketStart;
+    uint32_t bucketOffsetSum;  // Sum of reading times relative to bucketStart (ms)
+    int32_t bucketMillivoltSum;
+    int bucketReadings;
+    
+    // Ring of averaged points, oldest at head
+    unsigned long times[TREND_WINDOW_SIZE];
+    int32_t millivolts[TREND_WINDOW_SIZE];
+    int head;
+    int count;
+    
+    // Regression sums relative to times[head]
+    int64_t sumT;
+    int64_t sumV;
+    int64_t sumTT;
+    int64_t sumTV;
+};
+
+#endif // TREND_ESTIMATOR_H
@@ -3,44 +3,75 @@
 
 #include <Arduino.h>
 #include "config.h"
+#include "CalibrationTable.h"
+#include "SampleSource.h"
 
 /**
  * @brief Class for reading battery voltage using ADC with voltage divider
+ *
+ * Uses the internal ADC on ADC_PIN, or an ADS1115 on the shared I2C bus when
+ * ADC_EXTERNAL_ADS1115 is defined. On the Pro Mini, ADC_AVR_FREE_RUNNING
+ * samples ADC_PIN from the ADC interrupt instead (FreeRunningAdc). The
+ * sampling task reads whichever backend through getSampleSource(). Raw
+ * values are in VOLTAGE_ADC_MAX_VALUE counts either way. Battery voltages come from the calibration table when
+ * one is set, otherwise from one scale factor (reference voltage x divider ratio).
  */
 class VoltageReader {
 public:
     /**
      * @brief Initialize the voltage reader
+     * @return false if the external ADC (ADC_EXTERNAL_ADS1115) does not respond
      */
-    static void begin();
+    static bool begin();
     
     /**
-     * @brief Read raw ADC value with averaging
-     * @param samples Number of samples to average
-     * @return Average raw ADC value (0-4095)
+     * @brief Get the ADC backend the sampling task reads
+     * @return Backend for ADC_PIN (raw values in VOLTAGE_ADC_MAX_VALUE counts)
      */
-    static int readRawADC(int samples = ADC_SAMPLES);
+    static SampleSource& getSampleSource();
     
     /**
-     * @brief Read voltage at ADC pin (after voltage divider)
+     * @brief Calculate voltage divider ratio
+     * @return Voltage divider multiplication factor
+     */
+    static float getVoltageDividerRatio();
+    
+    /**
+     * @brief Override the divider ratio (runtime calibration, not persisted)
+     * @param ratio Battery voltage per volt at the ADC pin
+     */
+    static void setVoltageDividerRatio(float ratio);
+    
+    /**
+     * @brief Use a calibration table for battery voltages
+     * @param table Valid table (kept by pointer), or nullptr for the divider ratio
+     */
+    static void setCalibration(const CalibrationTable* table);
+    
+    /**
+     * @brief Convert a raw ADC value to the voltage at the ADC pin
+     * @param rawValue Raw (or averaged) ADC value
      * @return Voltage at ADC pin in volts
      */
-    static float readADCVoltage();
+    static float rawToADCVoltage(int rawValue);
     
     /**
-     * @brief Read actual battery voltage (compensated for voltage divider)
+     * @brief Convert a raw ADC value to battery voltage
+     * @param rawValue Raw (or averaged) ADC value
      * @return Battery voltage in volts
      */
-    static float readBatteryVoltage();
+    static float rawToBatteryVoltage(int rawValue);
     
     /**
-     * @brief Calculate voltage divider ratio
-     * @return Voltage divider multiplication factor
+     * @brief Convert a battery voltage to the expected raw ADC value
+     * @param batteryVoltage Battery voltage in volts
+     * @return Raw ADC value (clamped to 0-VOLTAGE_ADC_MAX_VALUE)
      */
-    static float getVoltageDividerRatio();
+    static int batteryVoltageToRaw(float batteryVoltage);
 
 private:
     static float voltageDividerRatio;
+    static const CalibrationTable* calibration;
 };
 
 #endif // VOLTAGE_READER_H
@@ -1,6 +1,16 @@
 #ifndef CONFIG_H
 #define CONFIG_H
 
+// Measurement parameters chosen by the simulator's tuner (simulator/tools/param_tuner.cpp):
+// copy its config_tuned_<board>.h files to include/ and build with -DTUNED_CONFIG
+#ifdef TUNED_CONFIG
+#ifdef ARDUINO_PRO_MINI
+#include "config_tuned_pro_mini.h"
+#else
+#include "config_tuned_esp32c3.h"
+#endif
+#endif
+
 // Include Arduino-specific configuration if building for Arduino Pro Mini
 #ifdef ARDUINO_PRO_MINI
 #include "config_arduino.h"
@@ -24,9 +34,23 @@
 #define I2C_SDA 8                    // GPIO8
 #define I2C_SCL 9                    // GPIO9
 
+// Chemistry select button (to GND, internal pull-up)
+#define CHEMISTRY_BUTTON_PIN 3       // GPIO3
+
+// Balance-lead taps (see AdcChannels.h): tap k carries cells 1..k+1 through its own divider
+#ifndef BALANCE_TAP_COUNT
+#define BALANCE_TAP_COUNT 0          // Taps wired (0 = total voltage only)
+#endif
+#define BALANCE_TAP_PINS { 1, 2, 4 } // GPIO1, GPIO2, GPIO4 (ADC1; GPIO3 is the button)
+#define BALANCE_TAP_RATIOS { 2.0, 3.0, 4.5 } // (R1 + R2) / R2 per tap: 5.9V, 8.9V, 13.3V full scale
+// Define BALANCE_MUX_ADC_PIN to read the taps through an analog mux (e.g. CD74HC4051) instead
+#define BALANCE_MUX_SELECT_PINS { 5, 6, 7 } // Mux address lines S0, S1, S2
+#define BALANCE_MUX_SETTLE_US 10     // Settling time after switching the mux (us)
+
 // Measurement Configuration
-#define ADC_SAMPLES 10               // Number of ADC samples for averaging
+#ifndef MEASUREMENT_DELAY_MS
 #define MEASUREMENT_DELAY_MS 500     // Delay between measurements
+#endif
 
 // Default debug level (can be changed at runtime)
 #ifndef DEBUG_VERBOSITY
@@ -37,6 +61,29 @@
 
 // Common Configuration (shared between ESP32-C3 and Arduino Pro Mini)
 
+// I2C bus shared by the display and external sensors (see I2cBus.h)
+#define I2C_CLOCK_HZ 400000          // Fast mode; kept between display updates
+#define I2C_CHUNK_BYTES 16           // Longest bus transaction of a queued write (bytes after the prefix)
+#define I2C_QUEUE_DEPTH 4            // Queued transactions per priority
+#define I2C_MAX_DEVICES 4            // Devices with latency accounting
+#define I2C_SLICE_US 2000            // Bus time the main loop spends on queued work per pass
+
+// External ADC (see Ads1115.h): define ADC_EXTERNAL_ADS1115 to measure the pack
+// through an ADS1115 on the display's I2C bus instead of the internal ADC
+#define ADS1115_ADDRESS 0x48         // ADDR pin to GND
+#define ADS1115_CHANNEL 0            // AIN0 against GND
+#define ADS1115_FULL_SCALE_V 4.096   // PGA range (the divider output stays below VDD)
+#define ADS1115_DATA_RATE 250        // Conversions per second (8-860)
+
+// ADC used by VoltageReader for the pack voltage
+#ifdef ADC_EXTERNAL_ADS1115
+#define VOLTAGE_ADC_MAX_VALUE 32767  // ADS1115 single-ended (15 bits)
+#define VOLTAGE_ADC_VREF ADS1115_FULL_SCALE_V // Exact PGA range, no calibration factor
+#else
+#define VOLTAGE_ADC_MAX_VALUE ADC_MAX_VALUE
+#define VOLTAGE_ADC_VREF ADC_VREF
+#endif
+
 // Battery Cell Specifications
 #define CELL_VOLTAGE_MIN 2.9         // Minimum safe cell voltage
 #define CELL_VOLTAGE_MAX 4.2         // Maximum cell voltage (fully charged)
@@ -44,6 +91,90 @@
 #define CELL_VOLTAGE_FULL 4.2        // Full cell voltage for percentage calculation
 #define MAX_CELLS 6                  // Maximum number of cells (6S)
 
+// Battery Chemistry Selection (see Chemistry.h / ChemistrySelector.h)
+// 0 = LiPo, 1 = LiHV, 2 = Li-ion, 3 = LiFePO4
+#ifndef DEFAULT_CHEMISTRY
+#define DEFAULT_CHEMISTRY 0          // Chemistry selected at boot
+#endif
+
+// Balance Reader (see BalanceReader.h)
+#define BALANCE_MAX_CELLS MAX_CELLS  // Per-cell voltages kept in BatteryInfo
+#define BALANCE_SAMPLES_PER_ROUND 64 // ADC samples per round, shared by all taps
+#define BALANCE_MIN_SAMPLES 4        // Samples per tap per round at least
+
+// Cell Count Tracker (see CellCountTracker.h)
+#ifndef TRACKER_NOISE_SIGMA
+#define TRACKER_NOISE_SIGMA 0.05     // Std. deviation of one voltage reading (V)
+#endif
+#ifndef TRACKER_MAX_AVERAGED
+#define TRACKER_MAX_AVERAGED 16      // Readings averaged at most (follows discharge drift)
+#endif
+#ifndef TRACKER_LOCK_CONFIDENCE
+#define TRACKER_LOCK_CONFIDENCE 0.80 // Posterior required to lock the cell count
+#endif
+#ifndef TRACKER_LOCK_READINGS
+#define TRACKER_LOCK_READINGS 3      // Consecutive confident readings before locking
+#endif
+#define TRACKER_UNLOCK_CONFIDENCE 0.20 // Locked count is dropped below this posterior
+#define TRACKER_RESET_READINGS 3     // Consecutive readings outside the tracked count's range: a different pack
+
+// Connection Watcher (see ConnectionWatcher.h)
+#define CONNECT_THRESHOLD_V 2.0      // Battery voltage treated as a connected pack (V)
+#define DISCONNECT_THRESHOLD_V 1.0   // Battery voltage treated as no pack (V)
+#ifndef CONNECT_DEBOUNCE_SAMPLES
+#define CONNECT_DEBOUNCE_SAMPLES 3   // Consecutive samples needed to confirm a change
+#endif
+#define CONNECTION_POLL_MS 5         // Single-sample polling interval (ms)
+
+// Task Scheduler (see TaskScheduler.h; periods and deadlines of the loop() tasks)
+#define TASK_MAX_TASKS 6             // Static task table size
+#define ANALYSIS_DEADLINE_MS 100     // Analysis (and its debug output) must finish within this (ms)
+#define DISPLAY_REFRESH_MS 100       // A new analysis is drawn within this (ms)
+#define LOG_DEADLINE_MS 200          // Log task deadline, flash writes included (ms)
+#define INPUT_POLL_MS 20             // Button and serial command polling interval (ms)
+
+// Memory Monitor (see MemoryMonitor.h; stack and heap headroom per task, 'M' reports it)
+#ifndef MEMORY_MONITOR
+#define MEMORY_MONITOR 0             // 1 = paint the stack and measure every task run
+#endif
+#ifndef MEMORY_STACK_GUARD_BYTES
+#define MEMORY_STACK_GUARD_BYTES 256 // Left unpainted below the monitor's own frame
+#endif
+#define MEMORY_HOST_STACK_BYTES 16384 // Stack reserved and painted below setup() on the host
+
+// Sample Queue (see SampleQueue.h; sampling task to analysis task)
+#define SAMPLE_QUEUE_DEPTH 16        // Queued sample blocks (power of two)
+#ifndef SAMPLE_RECORD_SAMPLES
+#define SAMPLE_RECORD_SAMPLES 10     // Sample task runs averaged into one block (50ms at CONNECTION_POLL_MS)
+#endif
+
+// Trend Estimator (see TrendEstimator.h)
+#ifndef TREND_WINDOW_SIZE
+#define TREND_WINDOW_SIZE 32         // Averaged points in the sliding regression window
+#endif
+#define TREND_BUCKET_MS 5000         // Readings are averaged into one point per bucket (ms)
+#define TREND_MIN_SPAN_MS 30000      // Window time span needed for an estimate (ms)
+#define TREND_MIN_DISCHARGE_MV_MIN 1.0 // Slower discharge shows no time-to-empty (mV/min)
+
+// Session History (see SessionHistory.h)
+#ifndef HISTORY_BUFFER_BYTES
+#define HISTORY_BUFFER_BYTES 4096    // Delta-encoded ring (~1 byte per reading)
+#endif
+#define HISTORY_RESOLUTION_MV 10     // Stored voltage resolution (mV)
+#define HISTORY_SAG_DROP_V 0.3       // Drop between readings counted as a sag event (V)
+
+// Measurement Log (see MeasurementLog.h)
+#ifndef LOG_BATCH_BYTES
+#define LOG_BATCH_BYTES 64           // Records programmed to flash per write (multiple of 4)
+#endif
+#ifndef LOG_INTERVAL_MS
+#define LOG_INTERVAL_MS 10000        // Time between logged readings (ms)
+#endif
+
+// Calibration Table (see CalibrationTable.h)
+#define CALIBRATION_SEGMENTS 32      // Table segments over the raw ADC range (power of two)
+#define CALIBRATION_MAX_POINTS 8     // Reference voltages per calibration ("$cal=12.60")
+
 // Display Configuration (I2C OLED 0.91" 128x32)
 #define SCREEN_WIDTH 128
 #define SCREEN_HEIGHT 32
@@ -56,4 +187,15 @@
 #define DEBUG_LEVEL_CALCULATED 2     // Show calculated values
 #define DEBUG_LEVEL_RAW 3            // Show raw ADC values
 
+// Measurement output formats (see DebugLogger::setFormat)
+#define OUTPUT_FORMAT_TEXT 0         // Labeled blocks per debug level
+#define OUTPUT_FORMAT_CSV 1          // One line per measurement
+#define OUTPUT_FORMAT_BINARY 2       // One 22-byte frame per measurement (see MeasurementFrame.h)
+
+// Serial Commands (see CommandParser.h; limits of the runtime settings)
+#define COMMAND_LINE_SIZE 32         // Longest "$..." line + 1
+#define COMMAND_MAX_SAMPLES 64       // "$samples" upper limit
+#define COMMAND_MIN_PERIOD_MS 50     // "$period" lower limit (ms)
+#define COMMAND_MAX_PERIOD_MS 60000  // "$period" upper limit (ms)
+
 #endif // CONFIG_H
@@ -21,6 +21,28 @@
 #define I2C_SDA A4                   // SDA on A4
 #define I2C_SCL A5                   // SCL on A5
 
+// Chemistry select button (to GND, internal pull-up)
+#define CHEMISTRY_BUTTON_PIN 2       // D2
+
+// Balance-lead taps (see AdcChannels.h): tap k carries cells 1..k+1 through its own divider
+#ifndef BALANCE_TAP_COUNT
+#define BALANCE_TAP_COUNT 0          // Taps wired (0 = total voltage only)
+#endif
+#define BALANCE_TAP_PINS { A1, A2, A3, A6, A7 } // A4/A5 are I2C
+#define BALANCE_TAP_RATIOS { 2.0, 2.0, 3.0, 4.0, 5.0 } // (R1 + R2) / R2 per tap
+// Define BALANCE_MUX_ADC_PIN to read the taps through an analog mux (e.g. CD74HC4051) instead
+#define BALANCE_MUX_SELECT_PINS { 4, 5, 6 } // Mux address lines S0, S1, S2 (D4-D6)
+#define BALANCE_MUX_SETTLE_US 10     // Settling time after switching the mux (us)
+
+// Free-running ADC (see FreeRunningAdc.h): define ADC_AVR_FREE_RUNNING to sample ADC_PIN
+// from the ADC interrupt instead of blocking analogRead() calls and delays
+#define AVR_ADC_PRESCALER 64         // 8MHz / 64 = 125kHz ADC clock (50-200kHz for 10 bits), 104us per conversion
+#define AVR_ADC_OVERSAMPLE 64        // Conversions summed per block (1-64): 6.7ms, longer than CONNECTION_POLL_MS
+#define AVR_ADC_NOISE_SLEEP 0        // 1: each conversion in ADC noise-reduction sleep (millis() pauses meanwhile)
+#if defined(ADC_AVR_FREE_RUNNING) && BALANCE_TAP_COUNT > 0
+#error "ADC_AVR_FREE_RUNNING owns the ADC; the balance taps' analogRead() calls would stop it"
+#endif
+
 // Display Configuration (same OLED)
 #define SCREEN_WIDTH 128
 #define SCREEN_HEIGHT 32
@@ -28,8 +50,22 @@
 #define SCREEN_ADDRESS 0x3C          // I2C address for 0.91" OLED
 
 // Measurement Configuration
-#define ADC_SAMPLES 10               // Number of ADC samples for averaging
+#ifndef MEASUREMENT_DELAY_MS
 #define MEASUREMENT_DELAY_MS 1000    // Longer delay for Arduino (slower processing)
+#endif
+#ifndef TRACKER_NOISE_SIGMA
+#define TRACKER_NOISE_SIGMA 0.08     // Coarser 10-bit ADC (~38mV per count at the battery)
+#endif
+#define TREND_WINDOW_SIZE 16         // Smaller trend window for 2KB SRAM
+#define HISTORY_BUFFER_BYTES 256     // ~4 minutes of readings in 2KB SRAM
+#define LOG_BATCH_BYTES 16           // Smaller flash batch for 2KB SRAM
+#define LOG_INTERVAL_MS 30000        // 1KB EEPROM: log less often
+#ifndef SAMPLE_RECORD_SAMPLES
+#define SAMPLE_RECORD_SAMPLES 20     // 100ms blocks: a 1s measurement fits in the sample queue
+#endif
+#define LOG_EEPROM_PAGE_SIZE 64      // EEPROM bytes per log page (14 pages)
+#define CALIBRATION_EEPROM_BYTES 128 // EEPROM end kept for the calibration table, not the log
+#define MEMORY_STACK_GUARD_BYTES 48  // Memory monitor: AVR frames are small, keep the painted area large
 
 // Debug Levels (same as ESP32)
 #define DEBUG_LEVEL_NONE 0           // No debug output
@@ -0,0 +1,19 @@
+#ifndef CONFIG_TUNED_ESP32C3_H
+#define CONFIG_TUNED_ESP32C3_H
+
+// ESP32-C3 measurement parameters from simulator/tools/param_tuner
+// (seed 1, 36 sessions of 60 s; included by config.h with -DTUNED_CONFIG)
+//
+//               answer     update    CPU       I2C    error   flicker wrong missed
+// hand-picked   1063 ms    496 ms  0.92 %  1116 B/s 16.6 mV 19.45/min    0      0
+// tuned          613 ms    496 ms  0.92 %  1114 B/s 16.2 mV 19.17/min    0      0
+
+#define SAMPLE_RECORD_SAMPLES 20
+#define MEASUREMENT_DELAY_MS 500
+#define CONNECT_DEBOUNCE_SAMPLES 3
+#define TRACKER_NOISE_SIGMA 0.03
+#define TRACKER_MAX_AVERAGED 4
+#define TRACKER_LOCK_CONFIDENCE 0.75
+#define TRACKER_LOCK_READINGS 2
+
+#endif // CONFIG_TUNED_ESP32C3_H
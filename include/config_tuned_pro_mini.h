@@ -0,0 +1,19 @@
+#ifndef CONFIG_TUNED_PRO_MINI_H
+#define CONFIG_TUNED_PRO_MINI_H
+
+// Pro Mini measurement parameters from simulator/tools/param_tuner
+// (seed 1, 36 sessions of 60 s; included by config.h with -DTUNED_CONFIG)
+//
+//               answer     update    CPU       I2C    error   flicker wrong missed
+// hand-picked   3612 ms    990 ms  3.47 %   565 B/s 40.8 mV 10.59/min    0      1
+// tuned         1113 ms    990 ms  3.47 %   565 B/s 40.8 mV  9.94/min    0      0
+
+#define SAMPLE_RECORD_SAMPLES 20
+#define MEASUREMENT_DELAY_MS 1000
+#define CONNECT_DEBOUNCE_SAMPLES 3
+#define TRACKER_NOISE_SIGMA 0.05
+#define TRACKER_MAX_AVERAGED 4
+#define TRACKER_LOCK_CONFIDENCE 0.75
+#define TRACKER_LOCK_READINGS 2
+
+#endif // CONFIG_TUNED_PRO_MINI_H
@@ -0,0 +1,313 @@
+#include "IngestLoop.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <ctime>
+#include <fcntl.h>
+#include <sys/epoll.h>
+#include <termios.h>
+#include <unistd.h>
+
+namespace {
+
+const int MAX_EVENTS = 64;
+const int READ_SIZE = 4096;
+const int HEAP_RESERVE = 4096;
+
+// A device clock more than this away from its tracked offset has restarted or wrapped
+const int64_t OFFSET_RESYNC_US = 2000000;
+// Upward tracking rate of the offset (1/256 of the difference per record)
+const int OFFSET_TRACK_SHIFT = 8;
+
+const char* const SOURCE_NAMES[RECORD_SOURCE_COUNT] = { "bin", "csv", "text", "msg" };
+
+int64_t clockUs(clockid_t clock) {
+    struct timespec now;
+    clock_gettime(clock, &now);
+    return (int64_t)now.tv_sec * 1000000 + now.tv_nsec / 1000;
+}
+
+speed_t baudConstant(int baud) {
+    switch (baud) {
+        case 9600: return B9600;
+        case 19200: return B19200;
+        case 38400: return B38400;
+        case 57600: return B57600;
+        case 230400: return B230400;
+        case 460800: return B460800;
+        case 921600: return B921600;
+        default: return B115200;
+    }
+}
+
+// Min-heap on (hostUs, sequence) for std::push_heap / std::pop_heap
+bool later(const QueuedRecord& a, const QueuedRecord& b) {
+    return a.hostUs != b.hostUs ? a.hostUs > b.hostUs : a.sequence > b.sequence;
+}
+
+} // namespace
+
+int64_t ingestMonotonicUs() {
+    return clockUs(CLOCK_MONOTONIC);
+}
+
+struct IngestLoop::Device {
+    int fd;
+    char name[INGEST_NAME_SIZE];
+    StreamParser parser;
+    DeviceStats stats;
+    bool offsetValid;
+    int64_t offsetUs;                 // Host time minus device time
+    
+    explicit Device(RecordSink* sink) : fd(-1), parser(sink), offsetValid(false), offsetUs(0) {
+        memset(&stats, 0, sizeof(stats));
+    }
+};
+
+IngestLoop::IngestLoop(FILE* output, int reorderWindowMs)
+    : epollFd(epoll_create1(EPOLL_CLOEXEC)), output(output), reorderWindowUs((int64_t)reorderWindowMs * 1000),
+      realtimeOffsetUs(clockUs(CLOCK_REALTIME) - clockUs(CLOCK_MONOTONIC)), sequence(0), lastWrittenUs(0),
+      totalBytes(0), totalWritten(0), openCount(0), currentDevice(-1), currentArrivalUs(0) {
+    heap.reserve(HEAP_RESERVE);
+}
+
+IngestLoop::~IngestLoop() {
+    for (size_t i = 0; i < devices.size(); i++) {
+        if (devices[i]->fd >= 0) {
+            close(devices[i]->fd);
+        }
+        delete devices[i];
+    }
+    if (epollFd >= 0) {
+        close(epollFd);
+    }
+}
+
+int IngestLoop::addDevice(const char* path, int baud) {
+    int fd = open(path, O_RDONLY | O_NOCTTY | O_NONBLOCK | O_CLOEXEC);
+    if (fd < 0) {
+        return -1;
+    }
+    
+    // Raw mode: no line editing, echo or CR/LF translation (PTY slaves start canonical)
+    if (isatty(fd)) {
+        struct termios settings;
+        if (tcgetattr(fd, &settings) == 0) {
+            cfmakeraw(&settings);
+            settings.c_cflag |= CLOCAL | CREAD;
+            cfsetispeed(&settings, baudConstant(baud));
+            cfsetospeed(&settings, baudConstant(baud));
+            tcsetattr(fd, TCSANOW, &settings);
+        }
+    }
+    
+    int index = (int)devices.size();
+    struct epoll_event event;
+    memset(&event, 0, sizeof(event));
+    event.events = EPOLLIN;
+    event.data.u32 = (uint32_t)index;
+    if (epoll_ctl(epollFd, EPOLL_CTL_ADD, fd, &event) != 0) {
+        close(fd);
+        return -1;
+    }
+    
+    Device* device = new Device(this);
+    device->fd = fd;
+    // "/dev/ttyUSB0" -> "ttyUSB0", "/dev/pts/3" -> "pts/3"
+    snprintf(device->name, sizeof(device->name), "%s", strncmp(path, "/dev/", 5) == 0 ? path + 5 : path);
+    device->stats.open = true;
+    devices.push_back(device);
+    openCount++;
+    return index;
+}
+
+bool IngestLoop::runOnce(int timeoutMs) {
+    if (openCount > 0) {
+        struct epoll_event events[MAX_EVENTS];
+        int ready = epoll_wait(epollFd, events, MAX_EVENTS, timeoutMs);
+        for (int i = 0; i < ready; i++) {
+            readDevice((int)events[i].data.u32);
+        }
+    }
+    writeDue(ingestMonotonicUs());
+    return openCount > 0;
+}
+
+void IngestLoop::run(volatile sig_atomic_t* stop, int statsIntervalMs) {
+    int64_t nextStatsUs = ingestMonotonicUs() + (int64_t)statsIntervalMs * 1000;
+    // Wake often enough to release records from the reorder window on time
+    int timeoutMs = (int)(reorderWindowUs / 4000) + 1;
+    while (!*stop && runOnce(timeoutMs)) {
+        if (statsIntervalMs > 0 && ingestMonotonicUs() >= nextStatsUs) {
+            fflush(output);
+            printStats(stderr);
+            nextStatsUs += (int64_t)statsIntervalMs * 1000;
+        }
+    }
+    drain();
+}
+
+void IngestLoop::drain() {
+    while (!heap.empty()) {
+        std::pop_heap(heap.begin(), heap.end(), later);
+        write(heap.back());
+        heap.pop_back();
+    }
+    fflush(output);
+}
+
+void IngestLoop::printStats(FILE* out) const {
+    fprintf(out, "%-20s %12s %8s %8s %8s %8s %6s %6s %6s %s\n",
+            "device", "bytes", "bin", "csv", "text", "msg", "crc", "long", "late", "state");
+    for (size_t i = 0; i < devices.size(); i++) {
+        const DeviceStats& stats = devices[i]->stats;
+        fprintf(out, "%-20s %12llu %8lu %8lu %8lu %8lu %6lu %6lu %6lu %s\n",
+                devices[i]->name, stats.bytes, stats.records[RECORD_BINARY], stats.records[RECORD_CSV],
+                stats.records[RECORD_TEXT], stats.records[RECORD_MESSAGE], stats.crcErrors,
+                stats.overlongLines, stats.lateRecords, stats.open ? "open" : "closed");
+    }
+    fprintf(out, "%d/%d devices open, %llu bytes, %llu records written\n",
+            openCount, (int)devices.size(), totalBytes, totalWritten);
+}
+
+int IngestLoop::getDeviceCount() const {
+    return (int)devices.size();
+}
+
+const DeviceStats& IngestLoop::getStats(int device) const {
+    return devices[device]->stats;
+}
+
+const char* IngestLoop::getName(int device) const {
+    return devices[device]->name;
+}
+
+unsigned long long IngestLoop::getTotalBytes() const {
+    return totalBytes;
+}
+
+unsigned long long IngestLoop::getTotalWritten() const {
+    return totalWritten;
+}
+
+void IngestLoop::readDevice(int index) {
+    Device* device = devices[index];
+    if (device->fd < 0) {
+        return;
+    }
+    
+    // One read per wakeup keeps a busy device from starving the others
+    uint8_t buffer[READ_SIZE];
+    ssize_t count = read(device->fd, buffer, sizeof(buffer));
+    if (count > 0) {
+        device->stats.bytes += (unsigned long long)count;
+        totalBytes += (unsigned long long)count;
+        currentDevice = index;
+        currentArrivalUs = ingestMonotonicUs();
+        device->parser.feed(buffer, (size_t)count);
+        currentDevice = -1;
+        
+        const StreamParserStats& parsed = device->parser.getStats();
+        device->stats.crcErrors = parsed.crcErrors;
+        device->stats.overlongLines = parsed.overlongLines;
+        memcpy(device->stats.records, parsed.records, sizeof(parsed.records));
+        return;
+    }
+    if (count < 0 && (errno == EAGAIN || errno == EINTR)) {
+        return;
+    }
+    // EOF, or EIO once the other end of a PTY or a USB adapter is gone
+    closeDevice(index);
+}
+
+void IngestLoop::closeDevice(int index) {
+    Device* device = devices[index];
+    epoll_ctl(epollFd, EPOLL_CTL_DEL, device->fd, nullptr);
+    close(device->fd);
+    device->fd = -1;
+    device->stats.open = false;
+    openCount--;
+}
+
+void IngestLoop::onRecord(const IngestRecord& record) {
+    Device* device = devices[currentDevice];
+    int64_t hostUs = currentArrivalUs;
+    
+    if (record.hasDeviceTime) {
+        int64_t deviceUs = (int64_t)record.frame.timeMs * 1000;
+        int64_t sampleUs = currentArrivalUs - deviceUs;
+        int64_t difference = sampleUs - device->offsetUs;
+        if (!device->offsetValid || difference < 0 || difference > OFFSET_RESYNC_US) {
+            // First record, less delay than before, or a restarted device clock
+            device->offsetUs = sampleUs;
+            device->offsetValid = true;
+        } else {
+            // Follow crystal drift slowly, ignoring single delayed reads
+            device->offsetUs += difference >> OFFSET_TRACK_SHIFT;
+        }
+        hostUs = deviceUs + device->offsetUs;
+    }
+    
+    QueuedRecord queued;
+    queued.hostUs = hostUs;
+    queued.sequence = sequence++;
+    queued.device = currentDevice;
+    queued.record = record;
+    heap.push_back(queued);
+    std::push_heap(heap.begin(), heap.end(), later);
+}
+
+void IngestLoop::writeDue(int64_t nowUs) {
+    int64_t releaseUs = nowUs - reorderWindowUs;
+    while (!heap.empty() && heap.front().hostUs <= releaseUs) {
+        std::pop_heap(heap.begin(), heap.end(), later);
+        write(heap.back());
+        heap.pop_back();
+    }
+}
+
+void IngestLoop::write(const QueuedRecord& queued) {
+    int64_t hostUs = queued.hostUs;
+    if (hostUs < lastWrittenUs) {
+        // Held up longer than the window: keep the output ordered
+        devices[queued.device]->stats.lateRecords++;
+        hostUs = lastWrittenUs;
+    }
+    lastWrittenUs = hostUs;
+    
+    const IngestRecord& record = queued.record;
+    const MeasurementFrame& frame = record.frame;
+    long long hostMs = (long long)((hostUs + realtimeOffsetUs) / 1000);
+    char line[256];
+    int length;
+    if (record.source == RECORD_MESSAGE) {
+        // Keep the CSV columns intact
+        char text[INGEST_TEXT_SIZE];
+        int i = 0;
+        for (; record.text[i] != '\0'; i++) {
+            text[i] = record.text[i] == ',' || record.text[i] == '"' ? ';' : record.text[i];
+        }
+        text[i] = '\0';
+        length = snprintf(line, sizeof(line), "%lld,%s,%s,,,,,,,,,,%s\n",
+                          hostMs, devices[queued.device]->name, SOURCE_NAMES[record.source], text);
+    } else {
+        char deviceMs[16] = "";
+        char trend[32] = ",";
+        if (record.hasDeviceTime) {
+            snprintf(deviceMs, sizeof(deviceMs), "%lu", (unsigned long)frame.timeMs);
+        }
+        if (frame.flags & MEASUREMENT_FRAME_TREND) {
+            if (frame.minutesToEmpty >= 0) {
+                snprintf(trend, sizeof(trend), "%.1f,%d", frame.trendDeciMvPerMin / 10.0, frame.minutesToEmpty);
+            } else {
+                snprintf(trend, sizeof(trend), "%.1f,", frame.trendDeciMvPerMin / 10.0);
+            }
+        }
+        length = snprintf(line, sizeof(line), "%lld,%s,%s,%s,%u,%.3f,%u,%u,%.3f,%u,%s,\n",
+                          hostMs, devices[queued.device]->name, SOURCE_NAMES[record.source], deviceMs,
+                          (unsigned)frame.raw, frame.millivolts / 1000.0, (unsigned)frame.cellCount,
+                          (unsigned)frame.confidence, frame.cellMillivolts / 1000.0, (unsigned)frame.charge, trend);
+    }
+    fwrite(line, 1, (size_t)length, output);
+    totalWritten++;
+}
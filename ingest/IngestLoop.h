@@ -0,0 +1,138 @@
+#ifndef INGEST_LOOP_H
+#define INGEST_LOOP_H
+
+#include <csignal>
+#include <cstdint>
+#include <cstdio>
+#include <vector>
+#include "StreamParser.h"
+
+// Longest device name kept for the output
+#define INGEST_NAME_SIZE 32
+
+/**
+ * @brief Per-device statistics
+ */
+struct DeviceStats {
+    unsigned long long bytes;
+    unsigned long records[RECORD_SOURCE_COUNT];
+    unsigned long crcErrors;
+    unsigned long overlongLines;
+    unsigned long lateRecords;        // Arrived after the reorder window, written out of their time
+    bool open;
+};
+
+/**
+ * @brief Merged stream record waiting in the reorder window
+ */
+struct QueuedRecord {
+    int64_t hostUs;                   // Estimated host time of the measurement
+    uint64_t sequence;                // Arrival order, breaks ties
+    int device;
+    IngestRecord record;
+};
+
+/**
+ * @brief Event loop reading many testers into one time-ordered CSV stream
+ *
+ * All devices are read by one thread through one epoll set; each device has
+ * its own StreamParser. Records are stamped with an estimate of when they
+ * were measured in host time: the device clock plus a per-device offset
+ * tracked from the arrival times (the smallest offset seen is the one with
+ * the least transport delay), or the arrival time for text records that
+ * carry no device clock. A min-heap holds them for a short reorder window
+ * so records from different devices come out in time order.
+ *
+ * Output lines:
+ *
+ *   host_ms,device,source,device_ms,raw,voltage,cells,confidence,cell_v,charge,mv_per_min,min_to_empty,text
+ */
+class IngestLoop : private RecordSink {
+public:
+    /**
+     * @brief Constructor
+     * @param output Merged stream (buffered by the caller or by setvbuf)
+     * @param reorderWindowMs How long records wait for earlier ones from other devices
+     */
+    IngestLoop(FILE* output, int reorderWindowMs);
+    ~IngestLoop();
+    
+    /**
+     * @brief Open a serial port or PTY and add it to the loop
+     * @param path Device path
+     * @param baud Baud rate (ignored by PTYs)
+     * @return Device index, or -1 if it cannot be opened
+     */
+    int addDevice(const char* path, int baud);
+    
+    /**
+     * @brief Wait for input once and process it
+     * @param timeoutMs Longest wait
+     * @return false once no device is open
+     */
+    bool runOnce(int timeoutMs);
+    
+    /**
+     * @brief Run until every device has closed or stop becomes non-zero
+     * @param stop Set by a signal handler
+     * @param statsIntervalMs Print statistics to stderr this often (0 = only at the end)
+     */
+    void run(volatile sig_atomic_t* stop, int statsIntervalMs);
+    
+    /**
+     * @brief Write out every queued record and flush the output
+     */
+    void drain();
+    
+    /**
+     * @brief Print the per-device statistics table
+     * @param out Destination
+     */
+    void printStats(FILE* out) const;
+    
+    int getDeviceCount() const;
+    const DeviceStats& getStats(int device) const;
+    const char* getName(int device) const;
+    
+    /**
+     * @brief Total bytes read from all devices
+     */
+    unsigned long long getTotalBytes() const;
+    
+    /**
+     * @brief Total records written to the output
+     */
+    unsigned long long getTotalWritten() const;
+
+private:
+    struct Device;
+    
+    int epollFd;
+    FILE* output;
+    int64_t reorderWindowUs;
+    int64_t realtimeOffsetUs;         // CLOCK_REALTIME - CLOCK_MONOTONIC at start
+    std::vector<Device*> devices;
+    std::vector<QueuedRecord> heap;
+    uint64_t sequence;
+    int64_t lastWrittenUs;
+    unsigned long long totalBytes;
+    unsigned long long totalWritten;
+    int openCount;
+    
+    // Set while a device's bytes are parsed
+    int currentDevice;
+    int64_t currentArrivalUs;
+    
+    void onRecord(const IngestRecord& record) override;
+    void readDevice(int index);
+    void closeDevice(int index);
+    void writeDue(int64_t nowUs);
+    void write(const QueuedRecord& queued);
+};
+
+/**
+ * @brief Monotonic clock in microseconds
+ */
+int64_t ingestMonotonicUs();
+
+#endif // INGEST_LOOP_H
@@ -0,0 +1,654 @@
+#include "SeriesStore.h"
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+
+// File: header, then DEVN and CHNK blocks in write order, then INDX and the trailer
+const char FILE_MAGIC[4] = { 'L', 'P', 'T', 'S' };
+const char DEVICE_MAGIC[4] = { 'D', 'E', 'V', 'N' };
+const char CHUNK_MAGIC[4] = { 'C', 'H', 'N', 'K' };
+const char INDEX_MAGIC[4] = { 'I', 'N', 'D', 'X' };
+const char TRAILER_MAGIC[4] = { 'L', 'P', 'T', 'E' };
+const uint16_t FILE_VERSION = 1;
+const size_t FILE_HEADER_SIZE = 8;
+const size_t INFO_SIZE = 52;                    // Serialized SeriesChunkInfo without the offset
+const size_t TRAILER_SIZE = 16;                 // Index offset, chunk count, magic
+
+enum Column { COLUMN_TIME, COLUMN_VOLTAGE, COLUMN_CELLS, COLUMN_CHARGE, COLUMN_COUNT };
+
+void putLe(uint8_t* out, uint64_t value, int bytes) {
+    for (int i = 0; i < bytes; i++) {
+        out[i] = (uint8_t)(value >> (8 * i));
+    }
+}
+
+uint64_t getLe(const uint8_t* in, int bytes) {
+    uint64_t value = 0;
+    for (int i = 0; i < bytes; i++) {
+        value |= (uint64_t)in[i] << (8 * i);
+    }
+    return value;
+}
+
+uint32_t crc32(const uint8_t* data, size_t length, uint32_t crc = 0) {
+    static uint32_t table[256];
+    if (table[1] == 0) {
+        for (uint32_t i = 0; i < 256; i++) {
+            uint32_t value = i;
+            for (int bit = 0; bit < 8; bit++) {
+                value = (value & 1) ? (value >> 1) ^ 0xEDB88320u : value >> 1;
+            }
+            table[i] = value;
+        }
+    }
+    crc = ~crc;
+    for (size_t i = 0; i < length; i++) {
+        crc = table[(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
+    }
+    return ~crc;
+}
+
+void encodeInfo(const SeriesChunkInfo& info, uint8_t* out) {
+    putLe(out, info.device, 4);
+    putLe(out + 4, info.count, 4);
+    putLe(out + 8, (uint64_t)info.firstMs, 8);
+    putLe(out + 16, (uint64_t)info.lastMs, 8);
+    putLe(out + 24, info.minMillivolts, 2);
+    putLe(out + 26, info.maxMillivolts, 2);
+    putLe(out + 28, info.minCellMillivolts, 2);
+    putLe(out + 30, info.maxCellMillivolts, 2);
+    for (int i = 0; i < COLUMN_COUNT; i++) {
+        putLe(out + 32 + 4 * i, info.columnBytes[i], 4);
+    }
+    putLe(out + 48, info.crc, 4);
+}
+
+void decodeInfo(const uint8_t* in, SeriesChunkInfo* info) {
+    info->device = (uint32_t)getLe(in, 4);
+    info->count = (uint32_t)getLe(in + 4, 4);
+    info->firstMs = (int64_t)getLe(in + 8, 8);
+    info->lastMs = (int64_t)getLe(in + 16, 8);
+    info->minMillivolts = (uint16_t)getLe(in + 24, 2);
+    info->maxMillivolts = (uint16_t)getLe(in + 26, 2);
+    info->minCellMillivolts = (uint16_t)getLe(in + 28, 2);
+    info->maxCellMillivolts = (uint16_t)getLe(in + 30, 2);
+    for (int i = 0; i < COLUMN_COUNT; i++) {
+        info->columnBytes[i] = (uint32_t)getLe(in + 32 + 4 * i, 4);
+    }
+    info->crc = (uint32_t)getLe(in + 48, 4);
+}
+
+uint64_t zigzag(int64_t value) {
+    return ((uint64_t)value << 1) ^ (uint64_t)(value >> 63);
+}
+
+int64_t unzigzag(uint64_t value) {
+    return (int64_t)(value >> 1) ^ -(int64_t)(value & 1);
+}
+
+/**
+ * @brief MSB-first bit packing into a reused byte vector
+ */
+class BitWriter {
+public:
+    explicit BitWriter(std::vector<uint8_t>* out) : out(out), accumulator(0), count(0) {
+        out->clear();
+    }
+    
+    void write(uint64_t value, int bits) {
+        if (bits > 32) {
+            write(value >> 32, bits - 32);
+            write(value & 0xFFFFFFFFu, 32);
+            return;
+        }
+        accumulator = (accumulator << bits) | (value & ((1ULL << bits) - 1));
+        count += bits;
+        while (count >= 8) {
+            count -= 8;
+            out->push_back((uint8_t)(accumulator >> count));
+        }
+    }
+    
+    void finish() {
+        if (count > 0) {
+            out->push_back((uint8_t)(accumulator << (8 - count)));
+            count = 0;
+        }
+    }
+
+private:
+    std::vector<uint8_t>* out;
+    uint64_t accumulator;
+    int count;
+};
+
+/**
+ * @brief Reads what BitWriter wrote; reads past the end return zeros
+ */
+class BitReader {
+public:
+    BitReader(const uint8_t* data, size_t length) : next(data), end(data + length), buffer(0), count(0) {}
+    
+    uint64_t read(int bits) {
+        if (bits > 32) {
+            uint64_t high = read(bits - 32);
+            return (high << 32) | read(32);
+        }
+        while (count < bits) {
+            buffer = (buffer << 8) | (next < end ? *next++ : 0);
+            count += 8;
+        }
+        count -= bits;
+        return (buffer >> count) & ((1ULL << bits) - 1);
+    }
+    
+    bool bit() {
+        return read(1) != 0;
+    }
+
+private:
+    const uint8_t* next;
+    const uint8_t* end;
+    uint64_t buffer;
+    int count;
+};
+
+uint16_t cellMillivolts(const SeriesReading& reading) {
+    return (uint16_t)(reading.millivolts / reading.cellCount);
+}
+
+} // namespace
+
+SeriesWriter::SeriesWriter() : file(nullptr), failed(false), bytesWritten(0) {
+}
+
+SeriesWriter::~SeriesWriter() {
+    if (file) {
+        close();
+    }
+}
+
+bool SeriesWriter::open(const char* path) {
+    file = fopen(path, "wb");
+    if (!file) {
+        return false;
+    }
+    failed = false;
+    bytesWritten = 0;
+    uint8_t header[FILE_HEADER_SIZE];
+    memcpy(header, FILE_MAGIC, 4);
+    putLe(header + 4, FILE_VERSION, 2);
+    putLe(header + 6, 0, 2);
+    writeBytes(header, sizeof(header));
+    return !failed;
+}
+
+int SeriesWriter::getDevice(const char* name) {
+    std::map<std::string, int>::const_iterator found = deviceNumbers.find(name);
+    if (found != deviceNumbers.end()) {
+        return found->second;
+    }
+    
+    int device = (int)deviceNames.size();
+    deviceNumbers[name] = device;
+    deviceNames.push_back(name);
+    pending.push_back(std::vector<SeriesReading>());
+    pending.back().reserve(SERIES_CHUNK_READINGS);
+    
+    // Named in the stream as well, so a file that was never closed can be recovered
+    size_t length = strlen(name);
+    uint8_t block[10];
+    memcpy(block, DEVICE_MAGIC, 4);
+    putLe(block + 4, (uint32_t)device, 4);
+    putLe(block + 8, length, 2);
+    writeBytes(block, sizeof(block));
+    writeBytes(name, length);
+    return device;
+}
+
+void SeriesWriter::append(int device, const SeriesReading& reading) {
+    std::vector<SeriesReading>& readings = pending[device];
+    readings.push_back(reading);
+    if (readings.size() == SERIES_CHUNK_READINGS) {
+        writeChunk(device);
+    }
+}
+
+bool SeriesWriter::close() {
+    if (!file) {
+        return false;
+    }
+    for (size_t device = 0; device < pending.size(); device++) {
+        if (!pending[device].empty()) {
+            writeChunk((int)device);
+        }
+    }
+    
+    uint64_t indexOffset = bytesWritten;
+    uint8_t block[8];
+    memcpy(block, INDEX_MAGIC, 4);
+    putLe(block + 4, deviceNames.size(), 4);
+    writeBytes(block, 8);
+    for (size_t i = 0; i < deviceNames.size(); i++) {
+        putLe(block, deviceNames[i].size(), 2);
+        writeBytes(block, 2);
+        writeBytes(deviceNames[i].data(), deviceNames[i].size());
+    }
+    for (size_t i = 0; i < chunks.size(); i++) {
+        uint8_t entry[INFO_SIZE + 8];
+        encodeInfo(chunks[i], entry);
+        putLe(entry + INFO_SIZE, chunks[i].offset, 8);
+        writeBytes(entry, sizeof(entry));
+    }
+    
+    uint8_t trailer[TRAILER_SIZE];
+    putLe(trailer, indexOffset, 8);
+    putLe(trailer + 8, chunks.size(), 4);
+    memcpy(trailer + 12, TRAILER_MAGIC, 4);
+    writeBytes(trailer, sizeof(trailer));
+    
+    bool ok = fclose(file) == 0 && !failed;
+    file = nullptr;
+    return ok;
+}
+
+unsigned long long SeriesWriter::getBytesWritten() const {
+    return bytesWritten;
+}
+
+void SeriesWriter::writeChunk(int device) {
+    std::vector<SeriesReading>& readings = pending[device];
+    SeriesChunkInfo info;
+    memset(&info, 0, sizeof(info));
+    info.device = (uint32_t)device;
+    info.count = (uint32_t)readings.size();
+    info.firstMs = INT64_MAX;
+    info.lastMs = INT64_MIN;
+    info.minMillivolts = 65535;
+    info.minCellMillivolts = 65535;
+    
+    BitWriter times(&columns[COLUMN_TIME]);
+    BitWriter voltages(&columns[COLUMN_VOLTAGE]);
+    BitWriter cells(&columns[COLUMN_CELLS]);
+    BitWriter charges(&columns[COLUMN_CHARGE]);
+    int64_t previousTime = 0;
+    int64_t previousDelta = 0;
+    const SeriesReading* previous = nullptr;
+    
+    for (size_t i = 0; i < readings.size(); i++) {
+        const SeriesReading& reading = readings[i];
+        if (reading.timeMs < info.firstMs) info.firstMs = reading.timeMs;
+        if (reading.timeMs > info.lastMs) info.lastMs = reading.timeMs;
+        if (reading.millivolts < info.minMillivolts) info.minMillivolts = reading.millivolts;
+        if (reading.millivolts > info.maxMillivolts) info.maxMillivolts = reading.millivolts;
+        if (reading.cellCount > 0) {
+            uint16_t cell = cellMillivolts(reading);
+            if (cell < info.minCellMillivolts) info.minCellMillivolts = cell;
+            if (cell > info.maxCellMillivolts) info.maxCellMillivolts = cell;
+        }
+        
+        if (!previous) {
+            times.write((uint64_t)reading.timeMs, 64);
+            voltages.write(reading.millivolts, 16);
+            cells.write(reading.cellCount, 8);
+            charges.write(reading.charge, 8);
+            previousTime = reading.timeMs;
+            previous = &reading;
+            continue;
+        }
+        
+        // Time: delta of delta, so a steady period costs one bit
+        int64_t delta = reading.timeMs - previousTime;
+        uint64_t dod = zigzag(delta - previousDelta);
+        if (dod == 0) {
+            times.write(0, 1);
+        } else if (dod < 128) {
+            times.write(0x2, 2);
+            times.write(dod, 7);
+        } else if (dod < 512) {
+            times.write(0x6, 3);
+            times.write(dod, 9);
+        } else if (dod < 4096) {
+            times.write(0xE, 4);
+            times.write(dod, 12);
+        } else {
+            times.write(0xF, 4);
+            times.write(dod, 64);
+        }
+        previousTime = reading.timeMs;
+        previousDelta = delta;
+        
+        // Voltage: small steps around the previous reading
+        uint64_t step = zigzag((int64_t)reading.millivolts - previous->millivolts);
+        if (step == 0) {
+            voltages.write(0, 1);
+        } else if (step < 64) {
+            voltages.write(0x2, 2);
+            voltages.write(step, 6);
+        } else if (step < 1024) {
+            voltages.write(0x6, 3);
+            voltages.write(step, 10);
+        } else {
+            voltages.write(0x7, 3);
+            voltages.write(reading.millivolts, 16);
+        }
+        
+        if (reading.cellCount == previous->cellCount) {
+            cells.write(0, 1);
+        } else {
+            cells.write(1, 1);
+            cells.write(reading.cellCount, 8);
+        }
+        if (reading.charge == previous->charge) {
+            charges.write(0, 1);
+        } else {
+            charges.write(1, 1);
+            charges.write(reading.charge, 8);
+        }
+        previous = &reading;
+    }
+    times.finish();
+    voltages.finish();
+    cells.finish();
+    charges.finish();
+    
+    uint32_t crc = 0;
+    for (int i = 0; i < COLUMN_COUNT; i++) {
+        info.columnBytes[i] = (uint32_t)columns[i].size();
+        crc = crc32(columns[i].data(), columns[i].size(), crc);
+    }
+    info.crc = crc;
+    info.offset = bytesWritten;
+    
+    uint8_t header[4 + INFO_SIZE];
+    memcpy(header, CHUNK_MAGIC, 4);
+    encodeInfo(info, header + 4);
+    writeBytes(header, sizeof(header));
+    for (int i = 0; i < COLUMN_COUNT; i++) {
+        writeBytes(columns[i].data(), columns[i].size());
+    }
+    chunks.push_back(info);
+    readings.clear();
+}
+
+void SeriesWriter::writeBytes(const void* data, size_t length) {
+    if (length > 0 && fwrite(data, 1, length, file) != length) {
+        failed = true;
+    }
+    bytesWritten += length;
+}
+
+SeriesReader::SeriesReader() : data(nullptr), size(0), recovered(false) {
+}
+
+SeriesReader::~SeriesReader() {
+    close();
+}
+
+bool SeriesReader::open(const char* path) {
+    close();
+    int fd = ::open(path, O_RDONLY);
+    if (fd < 0) {
+        return false;
+    }
+    struct stat info;
+    if (fstat(fd, &info) != 0 || (size_t)info.st_size < FILE_HEADER_SIZE) {
+        ::close(fd);
+        return false;
+    }
+    void* mapped = mmap(nullptr, (size_t)info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (mapped == MAP_FAILED) {
+        return false;
+    }
+    data = (const uint8_t*)mapped;
+    size = (size_t)info.st_size;
+    
+    if (memcmp(data, FILE_MAGIC, 4) != 0 || getLe(data + 4, 2) != FILE_VERSION) {
+        close();
+        return false;
+    }
+    recovered = false;
+    if (!loadIndex()) {
+        recovered = true;
+        recoverIndex();
+    }
+    return true;
+}
+
+void SeriesReader::close() {
+    if (data) {
+        munmap((void*)data, size);
+        data = nullptr;
+        size = 0;
+    }
+    chunks.clear();
+    deviceNames.clear();
+}
+
+bool SeriesReader::wasRecovered() const {
+    return recovered;
+}
+
+int SeriesReader::getChunkCount() const {
+    return (int)chunks.size();
+}
+
+const SeriesChunkInfo& SeriesReader::getChunk(int index) const {
+    return chunks[index];
+}
+
+int SeriesReader::getDeviceCount() const {
+    return (int)deviceNames.size();
+}
+
+const char* SeriesReader::getDeviceName(int device) const {
+    return deviceNames[device].c_str();
+}
+
+int SeriesReader::findDevice(const char* name) const {
+    for (size_t i = 0; i < deviceNames.size(); i++) {
+        if (deviceNames[i] == name) {
+            return (int)i;
+        }
+    }
+    return -1;
+}
+
+size_t SeriesReader::getFileSize() const {
+    return size;
+}
+
+int SeriesReader::decodeChunk(int index, SeriesReading* out, bool withCharge) const {
+    const SeriesChunkInfo& info = chunks[index];
+    const uint8_t* column = data + info.offset + 4 + INFO_SIZE;
+    BitReader times(column, info.columnBytes[COLUMN_TIME]);
+    column += info.columnBytes[COLUMN_TIME];
+    BitReader voltages(column, info.columnBytes[COLUMN_VOLTAGE]);
+    column += info.columnBytes[COLUMN_VOLTAGE];
+    BitReader cells(column, info.columnBytes[COLUMN_CELLS]);
+    column += info.columnBytes[COLUMN_CELLS];
+    BitReader charges(column, info.columnBytes[COLUMN_CHARGE]);
+    
+    int count = (int)info.count;
+    if (count == 0) {
+        return 0;
+    }
+    int64_t time = (int64_t)times.read(64);
+    int64_t delta = 0;
+    uint16_t millivolts = (uint16_t)voltages.read(16);
+    uint8_t cellCount = (uint8_t)cells.read(8);
+    uint8_t charge = withCharge ? (uint8_t)charges.read(8) : 0;
+    out[0].timeMs = time;
+    out[0].millivolts = millivolts;
+    out[0].cellCount = cellCount;
+    out[0].charge = charge;
+    
+    for (int i = 1; i < count; i++) {
+        if (times.bit()) {
+            uint64_t dod;
+            if (!times.bit()) {
+                dod = times.read(7);
+            } else if (!times.bit()) {
+                dod = times.read(9);
+            } else if (!times.bit()) {
+                dod = times.read(12);
+            } else {
+                dod = times.read(64);
+            }
+            delta += unzigzag(dod);
+        }
+        time += delta;
+        
+        if (voltages.bit()) {
+            if (!voltages.bit()) {
+                millivolts = (uint16_t)(millivolts + unzigzag(voltages.read(6)));
+            } else if (!voltages.bit()) {
+                millivolts = (uint16_t)(millivolts + unzigzag(voltages.read(10)));
+            } else {
+                millivolts = (uint16_t)voltages.read(16);
+            }
+        }
+        if (cells.bit()) {
+            cellCount = (uint8_t)cells.read(8);
+        }
+        if (withCharge && charges.bit()) {
+            charge = (uint8_t)charges.read(8);
+        }
+        
+        out[i].timeMs = time;
+        out[i].millivolts = millivolts;
+        out[i].cellCount = cellCount;
+        out[i].charge = charge;
+    }
+    return count;
+}
+
+bool SeriesReader::verifyChunk(int index) const {
+    const SeriesChunkInfo& info = chunks[index];
+    size_t length = 0;
+    for (int i = 0; i < COLUMN_COUNT; i++) {
+        length += info.columnBytes[i];
+    }
+    return crc32(data + info.offset + 4 + INFO_SIZE, length) == info.crc;
+}
+
+void SeriesReader::query(const SeriesQuery& query, void (*visit)(void* context, int device, const SeriesReading& reading),
+                         void* context, SeriesQueryStats* stats, bool useIndex) const {
+    SeriesQueryStats counters;
+    memset(&counters, 0, sizeof(counters));
+    std::vector<SeriesReading> readings(SERIES_CHUNK_READINGS);
+    
+    for (size_t i = 0; i < chunks.size(); i++) {
+        const SeriesChunkInfo& info = chunks[i];
+        if (useIndex && ((query.device >= 0 && info.device != (uint32_t)query.device) ||
+                         info.lastMs < query.fromMs || info.firstMs > query.toMs ||
+                         (query.belowCellMillivolts > 0 && info.minCellMillivolts >= query.belowCellMillivolts))) {
+            counters.chunksSkipped++;
+            continue;
+        }
+        
+        counters.chunksScanned++;
+        int count = decodeChunk((int)i, readings.data(), query.withCharge);
+        counters.readingsDecoded += (unsigned long long)count;
+        if (query.device >= 0 && info.device != (uint32_t)query.device) {
+            continue;
+        }
+        for (int j = 0; j < count; j++) {
+            const SeriesReading& reading = readings[j];
+            if (reading.timeMs < query.fromMs || reading.timeMs > query.toMs) {
+                continue;
+            }
+            if (query.belowCellMillivolts > 0 &&
+                (reading.cellCount == 0 || cellMillivolts(reading) >= query.belowCellMillivolts)) {
+                continue;
+            }
+            counters.readingsMatched++;
+            visit(context, (int)info.device, reading);
+        }
+    }
+    if (stats) {
+        *stats = counters;
+    }
+}
+
+bool SeriesReader::loadIndex() {
+    if (size < FILE_HEADER_SIZE + TRAILER_SIZE) {
+        return false;
+    }
+    const uint8_t* trailer = data + size - TRAILER_SIZE;
+    if (memcmp(trailer + 12, TRAILER_MAGIC, 4) != 0) {
+        return false;
+    }
+    uint64_t offset = getLe(trailer, 8);
+    uint32_t chunkCount = (uint32_t)getLe(trailer + 8, 4);
+    if (offset + 8 > size - TRAILER_SIZE || memcmp(data + offset, INDEX_MAGIC, 4) != 0) {
+        return false;
+    }
+    
+    const uint8_t* cursor = data + offset + 8;
+    const uint8_t* end = trailer;
+    uint32_t deviceCount = (uint32_t)getLe(data + offset + 4, 4);
+    for (uint32_t i = 0; i < deviceCount; i++) {
+        if (cursor + 2 > end) {
+            return false;
+        }
+        size_t length = (size_t)getLe(cursor, 2);
+        if (cursor + 2 + length > end) {
+            return false;
+        }
+        deviceNames.push_back(std::string((const char*)cursor + 2, length));
+        cursor += 2 + length;
+    }
+    if ((size_t)(end - cursor) != (size_t)chunkCount * (INFO_SIZE + 8)) {
+        deviceNames.clear();
+        return false;
+    }
+    chunks.resize(chunkCount);
+    for (uint32_t i = 0; i < chunkCount; i++) {
+        decodeInfo(cursor, &chunks[i]);
+        chunks[i].offset = getLe(cursor + INFO_SIZE, 8);
+        cursor += INFO_SIZE + 8;
+    }
+    return true;
+}
+
+bool SeriesReader::recoverIndex() {
+    // Walk the blocks; stop at the first torn or damaged one
+    size_t offset = FILE_HEADER_SIZE;
+    while (offset + 4 <= size) {
+        const uint8_t* block = data + offset;
+        if (memcmp(block, DEVICE_MAGIC, 4) == 0 && offset + 10 <= size) {
+            size_t length = (size_t)getLe(block + 8, 2);
+            if (offset + 10 + length > size || getLe(block + 4, 4) != deviceNames.size()) {
+                break;
+            }
+            deviceNames.push_back(std::string((const char*)block + 10, length));
+            offset += 10 + length;
+        } else if (memcmp(block, CHUNK_MAGIC, 4) == 0 && offset + 4 + INFO_SIZE <= size) {
+            SeriesChunkInfo info;
+            decodeInfo(block + 4, &info);
+            info.offset = offset;
+            size_t length = 4 + INFO_SIZE;
+            for (int i = 0; i < COLUMN_COUNT; i++) {
+                length += info.columnBytes[i];
+            }
+            if (offset + length > size || info.device >= deviceNames.size()) {
+                break;
+            }
+            chunks.push_back(info);
+            if (!verifyChunk((int)chunks.size() - 1)) {
+                chunks.pop_back();
+                break;
+            }
+            offset += length;
+        } else {
+            break;
+        }
+    }
+    return !chunks.empty();
+}
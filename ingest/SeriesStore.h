@@ -0,0 +1,208 @@
+#ifndef SERIES_STORE_H
+#define SERIES_STORE_H
+
+#include <cstdint>
+#include <cstdio>
+#include <map>
+#include <string>
+#include <vector>
+
+// Readings per chunk (per device); a chunk is the unit the index can skip
+#define SERIES_CHUNK_READINGS 4096
+
+/**
+ * @brief One stored reading
+ */
+struct SeriesReading {
+    int64_t timeMs;             // Host time (ms since the epoch)
+    uint16_t millivolts;        // Pack voltage
+    uint8_t cellCount;          // 0 = invalid reading
+    uint8_t charge;             // Charge (%)
+};
+
+/**
+ * @brief Index entry of one chunk: enough to skip it without reading its columns
+ */
+struct SeriesChunkInfo {
+    uint32_t device;            // Device number (see SeriesReader::getDeviceName)
+    uint32_t count;             // Readings
+    int64_t firstMs;            // Earliest reading
+    int64_t lastMs;             // Latest reading
+    uint16_t minMillivolts;
+    uint16_t maxMillivolts;
+    uint16_t minCellMillivolts; // Over valid readings; 65535 if there are none
+    uint16_t maxCellMillivolts;
+    uint32_t columnBytes[4];    // Time, voltage, cell count and charge columns
+    uint32_t crc;               // CRC-32 of the column bytes
+    uint64_t offset;            // File offset of the chunk header
+};
+
+/**
+ * @brief Selection for SeriesReader::query()
+ */
+struct SeriesQuery {
+    int64_t fromMs;             // Inclusive
+    int64_t toMs;               // Inclusive
+    int device;                 // -1 = all devices
+    uint16_t belowCellMillivolts;   // Only valid readings under this per-cell voltage; 0 = any
+    bool withCharge;            // Decode the charge column (0 in the readings otherwise)
+    
+    SeriesQuery() : fromMs(INT64_MIN), toMs(INT64_MAX), device(-1), belowCellMillivolts(0), withCharge(true) {}
+};
+
+/**
+ * @brief Work done by a query
+ */
+struct SeriesQueryStats {
+    unsigned long chunksScanned;
+    unsigned long chunksSkipped;
+    unsigned long long readingsDecoded;
+    unsigned long long readingsMatched;
+};
+
+/**
+ * @brief Writes readings into a columnar, chunked series file
+ *
+ * Readings are buffered per device and written SERIES_CHUNK_READINGS at a
+ * time as a chunk of four compressed columns:
+ *
+ *   time      Gorilla delta-of-delta: 1 bit for a reading on its period
+ *   voltage   delta bit buckets: 1 bit when unchanged, 8 bits for small steps
+ *   cells     1 bit unless the cell count changes
+ *   charge    1 bit unless the charge changes
+ *
+ * A chunk header carries the chunk's time range and voltage bounds; close()
+ * appends the device names and all headers as an index, so a reader finds
+ * matching chunks without touching the others. The file is append-only: if
+ * the writer dies before close(), the reader recovers the complete chunks
+ * from their headers.
+ */
+class SeriesWriter {
+public:
+    SeriesWriter();
+    ~SeriesWriter();
+    
+    /**
+     * @brief Create a series file
+     * @param path File path (replaced)
+     * @return false if it cannot be created
+     */
+    bool open(const char* path);
+    
+    /**
+     * @brief Get the number of a device, adding it on first use
+     * @param name Device name
+     * @return Device number
+     */
+    int getDevice(const char* name);
+    
+    /**
+     * @brief Add a reading
+     * @param device Device number from getDevice()
+     * @param reading Reading; times should rise per device (any order is stored, less compactly)
+     */
+    void append(int device, const SeriesReading& reading);
+    
+    /**
+     * @brief Write the buffered readings and the index, and close the file
+     * @return false on a write error
+     */
+    bool close();
+    
+    /**
+     * @brief Get the bytes written so far
+     */
+    unsigned long long getBytesWritten() const;
+
+private:
+    FILE* file;
+    bool failed;
+    unsigned long long bytesWritten;
+    std::map<std::string, int> deviceNumbers;
+    std::vector<std::string> deviceNames;
+    std::vector<std::vector<SeriesReading> > pending;
+    std::vector<SeriesChunkInfo> chunks;
+    std::vector<uint8_t> columns[4];
+    
+    void writeChunk(int device);
+    void writeBytes(const void* data, size_t length);
+};
+
+/**
+ * @brief Memory-mapped reader of a series file
+ */
+class SeriesReader {
+public:
+    SeriesReader();
+    ~SeriesReader();
+    
+    /**
+     * @brief Map a series file and load its index
+     * @param path File path
+     * @return false if it is not a series file
+     */
+    bool open(const char* path);
+    
+    /**
+     * @brief Unmap the file
+     */
+    void close();
+    
+    /**
+     * @brief Whether the index was rebuilt from the chunk headers (file not closed by its writer)
+     */
+    bool wasRecovered() const;
+    
+    int getChunkCount() const;
+    const SeriesChunkInfo& getChunk(int index) const;
+    int getDeviceCount() const;
+    const char* getDeviceName(int device) const;
+    
+    /**
+     * @brief Find a device by name
+     * @return Device number, or -1
+     */
+    int findDevice(const char* name) const;
+    
+    /**
+     * @brief Decode a chunk
+     * @param index Chunk index
+     * @param out Receives up to SERIES_CHUNK_READINGS readings
+     * @param withCharge Decode the charge column (left 0 otherwise)
+     * @return Number of readings
+     */
+    int decodeChunk(int index, SeriesReading* out, bool withCharge = true) const;
+    
+    /**
+     * @brief Check a chunk's CRC
+     */
+    bool verifyChunk(int index) const;
+    
+    /**
+     * @brief Visit the readings matching a query
+     * @param query Selection
+     * @param visit Called with the device number and each matching reading
+     * @param context Passed to visit
+     * @param stats Receives the work done (may be nullptr)
+     * @param useIndex false decodes every chunk (for comparison)
+     */
+    void query(const SeriesQuery& query, void (*visit)(void* context, int device, const SeriesReading& reading),
+               void* context, SeriesQueryStats* stats, bool useIndex = true) const;
+    
+    /**
+     * @brief Get the mapped file size
+     */
+    size_t getFileSize() const;
+
+private:
+    const uint8_t* data;
+    size_t size;
+    bool recovered;
+    std::vector<SeriesChunkInfo> chunks;
+    std::vector<std::string> deviceNames;
+    
+    bool loadIndex();
+    bool recoverIndex();
+};
+
+#endif // SERIES_STORE_H
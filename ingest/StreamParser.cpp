@@ -0,0 +1,268 @@
+#include "StreamParser.h"
+#include <cstdlib>
+#include <cstring>
+
+namespace {
+
+const char CSV_HEADER[] = "time_ms,";
+const char DISPLAY_BLOCK[] = "--- Display Output ---";
+const char CALCULATED_BLOCK[] = "--- Calculated Values ---";
+
+bool startsWith(const char* text, const char* prefix) {
+    return strncmp(text, prefix, strlen(prefix)) == 0;
+}
+
+uint16_t toMillivolts(double volts) {
+    double millivolts = volts * 1000.0 + 0.5;
+    if (millivolts < 0.0) return 0;
+    if (millivolts > 65535.0) return 65535;
+    return (uint16_t)millivolts;
+}
+
+/**
+ * @brief Parse one CSV field up to the next comma or the end of the line
+ * @param cursor Field start, advanced past the comma
+ * @param value Receives the number
+ * @return -1 on a malformed field, 0 if it is empty, 1 if it holds a number
+ */
+int csvField(const char** cursor, double* value) {
+    const char* start = *cursor;
+    if (*start == ',' || *start == '\0') {
+        *cursor = *start == ',' ? start + 1 : start;
+        return 0;
+    }
+    char* end;
+    *value = strtod(start, &end);
+    if (end == start || (*end != ',' && *end != '\0')) {
+        return -1;
+    }
+    *cursor = *end == ',' ? end + 1 : end;
+    return 1;
+}
+
+} // namespace
+
+StreamParser::StreamParser(RecordSink* sink)
+    : sink(sink), lineLength(0), overlong(false), frameLength(0),
+      block(BLOCK_NONE), calculatedPending(false) {
+    memset(&stats, 0, sizeof(stats));
+    memset(&pending, 0, sizeof(pending));
+}
+
+void StreamParser::feed(const uint8_t* data, size_t length) {
+    for (size_t i = 0; i < length; i++) {
+        feedByte(data[i]);
+    }
+}
+
+const StreamParserStats& StreamParser::getStats() const {
+    return stats;
+}
+
+void StreamParser::feedByte(uint8_t byte) {
+    if (frameLength > 0) {
+        frameByte(byte);
+        return;
+    }
+    
+    // The firmware's text is ASCII, so the first sync byte always starts a frame
+    if (byte == MeasurementFrameCodec::SYNC_0) {
+        frameBytes[0] = byte;
+        frameLength = 1;
+        return;
+    }
+    
+    if (byte == '\n') {
+        endLine();
+    } else if (byte == '\r') {
+        return;
+    } else if (lineLength < INGEST_LINE_SIZE - 1) {
+        line[lineLength++] = (char)byte;
+    } else {
+        overlong = true;
+    }
+}
+
+void StreamParser::frameByte(uint8_t byte) {
+    if (frameLength == 1 && byte != MeasurementFrameCodec::SYNC_1) {
+        // A lone 0xA5 is noise
+        frameLength = 0;
+        feedByte(byte);
+        return;
+    }
+    
+    frameBytes[frameLength++] = byte;
+    if (frameLength < MeasurementFrameCodec::FRAME_SIZE) {
+        return;
+    }
+    
+    frameLength = 0;
+    IngestRecord record;
+    if (MeasurementFrameCodec::decode(frameBytes, &record.frame)) {
+        record.source = RECORD_BINARY;
+        record.hasDeviceTime = true;
+        record.text[0] = '\0';
+        emit(record);
+        return;
+    }
+    
+    // Resynchronize on the next sync pair inside the bad frame. The other bytes
+    // are dropped rather than read as text, where they would make up lines
+    stats.crcErrors++;
+    for (int i = 1; i < MeasurementFrameCodec::FRAME_SIZE; i++) {
+        if (frameBytes[i] == MeasurementFrameCodec::SYNC_0 &&
+            (i == MeasurementFrameCodec::FRAME_SIZE - 1 || frameBytes[i + 1] == MeasurementFrameCodec::SYNC_1)) {
+            frameLength = MeasurementFrameCodec::FRAME_SIZE - i;
+            memmove(frameBytes, frameBytes + i, frameLength);
+            return;
+        }
+    }
+}
+
+void StreamParser::endLine() {
+    if (overlong) {
+        stats.overlongLines++;
+        overlong = false;
+        lineLength = 0;
+        return;
+    }
+    line[lineLength] = '\0';
+    int length = lineLength;
+    lineLength = 0;
+    parseLine(line, length);
+}
+
+void StreamParser::parseLine(char* text, int length) {
+    if (length == 0) {
+        // A blank line ends a text block
+        if (block == BLOCK_DISPLAY) {
+            pending.source = RECORD_TEXT;
+            pending.hasDeviceTime = false;
+            pending.text[0] = '\0';
+            emit(pending);
+            calculatedPending = false;
+        } else if (block == BLOCK_CALCULATED) {
+            calculatedPending = true;
+        }
+        block = BLOCK_NONE;
+        return;
+    }
+    
+    if (block != BLOCK_NONE) {
+        parseBlockLine(text);
+        return;
+    }
+    if (strcmp(text, DISPLAY_BLOCK) == 0) {
+        // Completes the preceding calculated block, if there was one
+        if (!calculatedPending) {
+            memset(&pending, 0, sizeof(pending));
+        }
+        block = BLOCK_DISPLAY;
+        return;
+    }
+    if (strcmp(text, CALCULATED_BLOCK) == 0) {
+        memset(&pending, 0, sizeof(pending));
+        calculatedPending = false;
+        block = BLOCK_CALCULATED;
+        return;
+    }
+    if (startsWith(text, CSV_HEADER)) {
+        return;
+    }
+    if (text[0] >= '0' && text[0] <= '9' && parseCsv(text)) {
+        return;
+    }
+    
+    IngestRecord record;
+    record.source = RECORD_MESSAGE;
+    record.hasDeviceTime = false;
+    memset(&record.frame, 0, sizeof(record.frame));
+    int copied = length < INGEST_TEXT_SIZE - 1 ? length : INGEST_TEXT_SIZE - 1;
+    memcpy(record.text, text, copied);
+    record.text[copied] = '\0';
+    emit(record);
+}
+
+bool StreamParser::parseCsv(const char* text) {
+    // time_ms,raw,voltage,cells,confidence,cell_v,charge,mv_per_min,min_to_empty
+    double fields[9];
+    int present[9];
+    const char* cursor = text;
+    for (int i = 0; i < 9; i++) {
+        present[i] = csvField(&cursor, &fields[i]);
+        if (present[i] < 0 || (i < 7 && present[i] == 0)) {
+            return false;
+        }
+    }
+    if (*cursor != '\0') {
+        return false;
+    }
+    
+    IngestRecord record;
+    record.source = RECORD_CSV;
+    record.hasDeviceTime = true;
+    record.text[0] = '\0';
+    MeasurementFrame& frame = record.frame;
+    frame.timeMs = (uint32_t)fields[0];
+    frame.raw = (uint16_t)fields[1];
+    frame.millivolts = toMillivolts(fields[2]);
+    frame.cellCount = (uint8_t)fields[3];
+    frame.confidence = (uint8_t)fields[4];
+    frame.cellMillivolts = toMillivolts(fields[5]);
+    frame.charge = (uint8_t)fields[6];
+    frame.flags = present[7] ? MEASUREMENT_FRAME_TREND : 0;
+    frame.trendDeciMvPerMin = (int16_t)(present[7] ? fields[7] * 10.0 + (fields[7] < 0 ? -0.5 : 0.5) : 0);
+    frame.minutesToEmpty = (int16_t)(present[8] ? fields[8] : -1);
+    emit(record);
+    return true;
+}
+
+void StreamParser::parseBlockLine(const char* text) {
+    MeasurementFrame& frame = pending.frame;
+    char* end;
+    
+    if (block == BLOCK_CALCULATED) {
+        if (startsWith(text, "Battery Voltage: ")) {
+            frame.millivolts = toMillivolts(strtod(text + 17, nullptr));
+        } else if (startsWith(text, "Detected Cells: ")) {
+            frame.cellCount = (uint8_t)strtol(text + 16, nullptr, 10);
+        } else if (startsWith(text, "Cell Confidence: ")) {
+            frame.confidence = (uint8_t)strtol(text + 17, nullptr, 10);
+        } else if (startsWith(text, "Average Cell Voltage: ")) {
+            frame.cellMillivolts = toMillivolts(strtod(text + 22, nullptr));
+        } else if (startsWith(text, "Charge Percentage: ")) {
+            frame.charge = (uint8_t)strtol(text + 19, nullptr, 10);
+        } else if (startsWith(text, "Invalid")) {
+            frame.cellCount = 0;
+        }
+        return;
+    }
+    
+    // Display block: "3S 12.34V", "Avg: 4.11V/cell", "Charge: 85%" or "Invalid Battery!"
+    // The calculated block has one more digit, so its values are kept
+    if (startsWith(text, "Avg: ")) {
+        if (!calculatedPending) {
+            frame.cellMillivolts = toMillivolts(strtod(text + 5, nullptr));
+        }
+    } else if (startsWith(text, "Charge: ")) {
+        frame.charge = (uint8_t)strtol(text + 8, nullptr, 10);
+    } else if (startsWith(text, "Invalid")) {
+        frame.cellCount = 0;
+    } else {
+        long cells = strtol(text, &end, 10);
+        if (end != text && end[0] == 'S' && end[1] == ' ') {
+            frame.cellCount = (uint8_t)cells;
+            if (!calculatedPending) {
+                frame.millivolts = toMillivolts(strtod(end + 2, nullptr));
+                if (cells == 1) {
+                    frame.cellMillivolts = frame.millivolts;
+                }
+            }
+        }
+    }
+}
+
+void StreamParser::emit(IngestRecord& record) {
+    stats.records[record.source]++;
+    sink->onRecord(record);
+}
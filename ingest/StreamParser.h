@@ -0,0 +1,118 @@
+#ifndef STREAM_PARSER_H
+#define STREAM_PARSER_H
+
+#include <cstddef>
+#include <cstdint>
+#include "MeasurementFrame.h"
+
+// Longest line kept; longer lines are counted and dropped (the firmware's are < 80)
+#define INGEST_LINE_SIZE 160
+
+// Characters of a message line kept in a record
+#define INGEST_TEXT_SIZE 64
+
+/**
+ * @brief Where a record came from in the tester's output
+ */
+enum RecordSource {
+    RECORD_BINARY = 0,     // "$format=binary" frame
+    RECORD_CSV = 1,        // "$format=csv" line
+    RECORD_TEXT = 2,       // "--- Display Output ---" block (with "--- Calculated Values ---" if present)
+    RECORD_MESSAGE = 3,    // Any other line (startup messages, statistics, command replies)
+    RECORD_SOURCE_COUNT = 4
+};
+
+/**
+ * @brief One parsed record
+ *
+ * Fixed size so records can be queued by value. Measurements of all three
+ * formats are converted to the binary frame's fixed-point fields.
+ */
+struct IngestRecord {
+    uint8_t source;                   // RecordSource
+    bool hasDeviceTime;               // frame.timeMs is valid (binary and CSV only)
+    MeasurementFrame frame;           // Measurement (not used by messages)
+    char text[INGEST_TEXT_SIZE];      // Message text, NUL-terminated
+};
+
+/**
+ * @brief Receives parsed records
+ */
+class RecordSink {
+public:
+    virtual ~RecordSink() {}
+    
+    /**
+     * @brief Called for every complete record
+     * @param record Parsed record, only valid during the call
+     */
+    virtual void onRecord(const IngestRecord& record) = 0;
+};
+
+/**
+ * @brief Parser statistics
+ */
+struct StreamParserStats {
+    unsigned long records[RECORD_SOURCE_COUNT];
+    unsigned long crcErrors;          // Frames with a bad CRC or type
+    unsigned long overlongLines;      // Lines over INGEST_LINE_SIZE - 1 characters
+};
+
+/**
+ * @brief Incremental parser of one tester's serial output
+ *
+ * Takes the bytes in whatever chunks read() returns and finds binary frames
+ * (by their sync bytes) and text lines in the same stream, so a device can
+ * switch formats at any time. Lines are split in place in a fixed buffer
+ * and frames are decoded from a 22-byte buffer: feeding allocates nothing.
+ * A frame with a bad CRC is dropped and its bytes are searched for the
+ * next sync pair, so the parser resynchronizes on the next frame or line.
+ */
+class StreamParser {
+public:
+    /**
+     * @brief Constructor
+     * @param sink Receives the records
+     */
+    explicit StreamParser(RecordSink* sink);
+    
+    /**
+     * @brief Parse received bytes
+     * @param data Bytes
+     * @param length Number of bytes
+     */
+    void feed(const uint8_t* data, size_t length);
+    
+    /**
+     * @brief Get the statistics
+     * @return Counters since construction
+     */
+    const StreamParserStats& getStats() const;
+
+private:
+    RecordSink* sink;
+    StreamParserStats stats;
+    
+    char line[INGEST_LINE_SIZE];
+    int lineLength;
+    bool overlong;
+    
+    uint8_t frameBytes[MeasurementFrameCodec::FRAME_SIZE];
+    int frameLength;
+    
+    // Text block in progress
+    enum Block { BLOCK_NONE, BLOCK_CALCULATED, BLOCK_DISPLAY };
+    Block block;
+    IngestRecord pending;
+    bool calculatedPending;
+    
+    void feedByte(uint8_t byte);
+    void frameByte(uint8_t byte);
+    void endLine();
+    void parseLine(char* text, int length);
+    bool parseCsv(const char* text);
+    void parseBlockLine(const char* text);
+    void emit(IngestRecord& record);
+};
+
+#endif // STREAM_PARSER_H
@@ -0,0 +1,205 @@
+/**
+ * @brief Benchmark: SeriesStore ingest and query throughput
+ *
+ *   bench_series_store [--devices 200] [--readings 20000]
+ *
+ * Generates two weeks of readings per device (3S packs cycling between full
+ * and empty, a few millivolts of noise, jittered timestamps, and every tenth
+ * pack sagging below 3.5 V/cell now and then), writes them interleaved as
+ * ingestd would deliver them, then times full decodes and indexed queries
+ * against the same queries decoding every chunk. Every reading is checked
+ * after the round trip; exits non-zero on a mismatch.
+ */
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <vector>
+#include "BenchUtil.h"
+#include "SeriesStore.h"
+
+namespace {
+
+const int64_t DAY_MS = 86400000;
+const char* const PATH = "bench_series_store.lpts";
+
+struct Counter {
+    unsigned long long readings;
+    unsigned long long sum;
+};
+
+void countReading(void* context, int, const SeriesReading& reading) {
+    Counter* counter = (Counter*)context;
+    counter->readings++;
+    counter->sum += reading.millivolts;
+}
+
+uint32_t nextRandom(uint32_t* state) {
+    *state = *state * 1664525u + 1013904223u;
+    return *state >> 8;
+}
+
+/**
+ * @brief One device's readings
+ */
+void generate(int device, int count, int64_t startMs, int64_t periodMs, std::vector<SeriesReading>* out) {
+    uint32_t random = 12345u + (uint32_t)device * 7919u;
+    bool sags = device % 10 == 0;
+    out->resize(count);
+    for (int i = 0; i < count; i++) {
+        // 3S pack: 12.6V down to 10.8V over a cycle of 500 readings, then recharged
+        int phase = (i + device * 37) % 500;
+        int millivolts = 12600 - phase * 1800 / 500 + (int)(nextRandom(&random) % 7) - 3;
+        if (sags && phase > 450 && phase < 460) {
+            millivolts -= 500;       // Load sag to about 3.4 V/cell
+        }
+        SeriesReading& reading = (*out)[i];
+        reading.timeMs = startMs + i * periodMs + (int64_t)(nextRandom(&random) % 41) - 20;
+        reading.millivolts = (uint16_t)millivolts;
+        reading.cellCount = 3;
+        reading.charge = (uint8_t)(100 - phase / 5);
+    }
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    int devices = 200;
+    int readingsPerDevice = 20000;
+    for (int i = 1; i + 1 < argc; i += 2) {
+        if (strcmp(argv[i], "--devices") == 0) {
+            devices = atoi(argv[i + 1]);
+        } else if (strcmp(argv[i], "--readings") == 0) {
+            readingsPerDevice = atoi(argv[i + 1]);
+        }
+    }
+    long long total = (long long)devices * readingsPerDevice;
+    
+    struct timespec now;
+    clock_gettime(CLOCK_REALTIME, &now);
+    int64_t endMs = (int64_t)now.tv_sec * 1000;
+    int64_t periodMs = 14 * DAY_MS / readingsPerDevice;
+    int64_t startMs = endMs - 14 * DAY_MS;
+    
+    std::vector<std::vector<SeriesReading> > series(devices);
+    for (int device = 0; device < devices; device++) {
+        generate(device, readingsPerDevice, startMs, periodMs, &series[device]);
+    }
+    // Size of the same readings as ingestd CSV lines
+    unsigned long long csvBytes = 0;
+    char line[160];
+    for (int i = 0; i < readingsPerDevice; i++) {
+        const SeriesReading& reading = series[0][i];
+        csvBytes += (unsigned long long)snprintf(line, sizeof(line), "%lld,pts/12,bin,%lld,2100,%.3f,3,97,%.3f,%u,-3.2,120,\n",
+                                                 (long long)reading.timeMs, (long long)(reading.timeMs - startMs),
+                                                 reading.millivolts / 1000.0, reading.millivolts / 3000.0,
+                                                 (unsigned)reading.charge);
+    }
+    csvBytes *= (unsigned long long)devices;
+    
+    printf("=== Series store: %d devices x %d readings over 14 days ===\n\n", devices, readingsPerDevice);
+    
+    // Ingest, interleaved across devices
+    bench::Clock::time_point start = bench::Clock::now();
+    SeriesWriter writer;
+    if (!writer.open(PATH)) {
+        fprintf(stderr, "Cannot create %s\n", PATH);
+        return 1;
+    }
+    std::vector<int> numbers(devices);
+    for (int device = 0; device < devices; device++) {
+        char name[16];
+        snprintf(name, sizeof(name), "pts/%d", device);
+        numbers[device] = writer.getDevice(name);
+    }
+    for (int i = 0; i < readingsPerDevice; i++) {
+        for (int device = 0; device < devices; device++) {
+            writer.append(numbers[device], series[device][i]);
+        }
+    }
+    writer.close();
+    bench::report("ingest (append + compress + write)", bench::secondsSince(start), (double)total);
+    printf("file %.1f MB, %.2f bytes/reading (ingestd CSV: %.1f bytes/reading, %.0fx smaller)\n\n",
+           writer.getBytesWritten() / 1e6, (double)writer.getBytesWritten() / total,
+           (double)csvBytes / total, (double)csvBytes / writer.getBytesWritten());
+    
+    SeriesReader reader;
+    if (!reader.open(PATH)) {
+        fprintf(stderr, "Cannot map %s\n", PATH);
+        return 1;
+    }
+    
+    // Round trip check
+    std::vector<SeriesReading> decoded(SERIES_CHUNK_READINGS);
+    std::vector<int> position(devices, 0);
+    unsigned long mismatches = 0;
+    for (int i = 0; i < reader.getChunkCount(); i++) {
+        int device = (int)reader.getChunk(i).device;
+        int count = reader.decodeChunk(i, decoded.data());
+        for (int j = 0; j < count; j++) {
+            const SeriesReading& expected = series[device][position[device]++];
+            if (expected.timeMs != decoded[j].timeMs || expected.millivolts != decoded[j].millivolts ||
+                expected.cellCount != decoded[j].cellCount || expected.charge != decoded[j].charge) {
+                mismatches++;
+            }
+        }
+    }
+    for (int device = 0; device < devices; device++) {
+        if (position[device] != readingsPerDevice) {
+            mismatches++;
+        }
+    }
+    
+    // Full decode
+    SeriesQuery all;
+    Counter counter = { 0, 0 };
+    SeriesQueryStats stats;
+    start = bench::Clock::now();
+    reader.query(all, countReading, &counter, &stats);
+    bench::report("full decode (all columns)", bench::secondsSince(start), (double)total);
+    
+    // Sag query over the last week: indexed vs. decoding everything
+    SeriesQuery sag;
+    sag.fromMs = endMs - 7 * DAY_MS;
+    sag.belowCellMillivolts = 3500;
+    sag.withCharge = false;
+    Counter indexed = { 0, 0 };
+    start = bench::Clock::now();
+    reader.query(sag, countReading, &indexed, &stats);
+    double indexedSeconds = bench::secondsSince(start);
+    Counter scanned = { 0, 0 };
+    SeriesQueryStats scanStats;
+    start = bench::Clock::now();
+    reader.query(sag, countReading, &scanned, &scanStats, false);
+    double scanSeconds = bench::secondsSince(start);
+    printf("\nsag < 3.5 V/cell, last 7 days: %llu readings\n", indexed.readings);
+    printf("  indexed  %8.2f ms  %6lu chunks decoded, %6lu skipped  (%.0f M readings/s effective)\n",
+           indexedSeconds * 1e3, stats.chunksScanned, stats.chunksSkipped, total / indexedSeconds / 1e6);
+    printf("  full     %8.2f ms  %6lu chunks decoded\n", scanSeconds * 1e3, scanStats.chunksScanned);
+    
+    // One device, last day
+    SeriesQuery recent;
+    recent.device = devices / 2;
+    recent.fromMs = endMs - DAY_MS;
+    Counter recentIndexed = { 0, 0 };
+    start = bench::Clock::now();
+    reader.query(recent, countReading, &recentIndexed, &stats);
+    indexedSeconds = bench::secondsSince(start);
+    Counter recentScanned = { 0, 0 };
+    start = bench::Clock::now();
+    reader.query(recent, countReading, &recentScanned, &scanStats, false);
+    scanSeconds = bench::secondsSince(start);
+    printf("\none device, last day: %llu readings\n", recentIndexed.readings);
+    printf("  indexed  %8.3f ms  %6lu chunks decoded\n", indexedSeconds * 1e3, stats.chunksScanned);
+    printf("  full     %8.3f ms  %6lu chunks decoded\n", scanSeconds * 1e3, scanStats.chunksScanned);
+    
+    reader.close();
+    remove(PATH);
+    
+    bool passed = mismatches == 0 && counter.readings == (unsigned long long)total &&
+                  indexed.readings == scanned.readings && indexed.sum == scanned.sum && indexed.readings > 0 &&
+                  recentIndexed.readings == recentScanned.readings && recentIndexed.sum == recentScanned.sum;
+    printf("\nround trip: %lu mismatches; indexed and full queries %s\n", mismatches,
+           passed ? "agree" : "DIFFER");
+    return passed ? 0 : 1;
+}
@@ -0,0 +1,266 @@
+/**
+ * @brief Load test: hundreds of simulated testers on PTYs into one IngestLoop
+ *
+ *   ingest_loadtest [--devices 200] [--records 500] [--corrupt 0]
+ *
+ * Opens a PTY pair per simulated tester and adds the slave side to the loop
+ * by path, as ingestd does with real ports. A writer thread plays the
+ * testers on the master sides as fast as the PTYs accept data, mixing
+ * binary frames (from the firmware's encoder), CSV lines, text display
+ * blocks and messages; --corrupt N breaks the CRC of every Nth frame. The
+ * loop runs on the main thread into a temporary file, which is then read
+ * back to check that every record arrived, in time order.
+ *
+ * Prints records/s and the loop thread's CPU use; exits non-zero if a
+ * record is missing or out of order.
+ */
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <fcntl.h>
+#include <map>
+#include <string>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+#include "IngestLoop.h"
+
+namespace {
+
+struct Tester {
+    int master;
+    uint32_t baseMs;              // Device clock at the start
+    int written;                  // Records generated so far
+    int expected;                 // Records that should come out
+    char pending[160];            // Bytes of the current record not yet accepted
+    int pendingLength;
+    int pendingOffset;
+};
+
+std::atomic<unsigned long long> bytesSent(0);
+std::atomic<bool> writerDone(false);
+
+double threadCpuSeconds() {
+    struct timespec now;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &now);
+    return now.tv_sec + now.tv_nsec * 1e-9;
+}
+
+/**
+ * @brief Generate a tester's next record
+ * @return true if the record should reach the output
+ */
+bool nextRecord(Tester* tester, int64_t startUs, int corruptEvery, unsigned long* frames) {
+    int index = tester->written++;
+    uint32_t timeMs = tester->baseMs + (uint32_t)((ingestMonotonicUs() - startUs) / 1000);
+    int millivolts = 12600 - (index % 2000);
+    
+    switch (index % 8) {
+        case 0: case 1: case 2: case 3: {
+            MeasurementFrame frame;
+            frame.timeMs = timeMs;
+            frame.raw = (uint16_t)(millivolts / 6);
+            frame.millivolts = (uint16_t)millivolts;
+            frame.cellCount = 3;
+            frame.confidence = 95;
+            frame.cellMillivolts = (uint16_t)(millivolts / 3);
+            frame.charge = 80;
+            frame.flags = MEASUREMENT_FRAME_TREND;
+            frame.trendDeciMvPerMin = -125;
+            frame.minutesToEmpty = 42;
+            tester->pendingLength = MeasurementFrameCodec::encode(frame, (uint8_t*)tester->pending);
+            (*frames)++;
+            if (corruptEvery > 0 && *frames % corruptEvery == 0) {
+                tester->pending[MeasurementFrameCodec::FRAME_SIZE - 1] ^= 0x01;
+                return false;
+            }
+            return true;
+        }
+        case 4: case 5:
+            tester->pendingLength = snprintf(tester->pending, sizeof(tester->pending),
+                                             "%lu,%d,%.3f,3,95,%.3f,80,-12.5,42\r\n",
+                                             (unsigned long)timeMs, millivolts / 6, millivolts / 1000.0,
+                                             millivolts / 3000.0);
+            return true;
+        case 6:
+            tester->pendingLength = snprintf(tester->pending, sizeof(tester->pending),
+                                             "--- Display Output ---\r\n3S %.2fV\r\nAvg: %.2fV/cell\r\nCharge: 80%%\r\n\r\n",
+                                             millivolts / 1000.0, millivolts / 3000.0);
+            return true;
+        default:
+            tester->pendingLength = snprintf(tester->pending, sizeof(tester->pending), "Battery connected\r\n\r\n");
+            return true;
+    }
+}
+
+void writeAll(std::vector<Tester>* testers, int records, int corruptEvery) {
+    int64_t startUs = ingestMonotonicUs();
+    unsigned long frames = 0;
+    int remaining = (int)testers->size();
+    
+    while (remaining > 0) {
+        bool progress = false;
+        for (size_t i = 0; i < testers->size(); i++) {
+            Tester& tester = (*testers)[i];
+            if (tester.pendingOffset == tester.pendingLength) {
+                if (tester.written == records) {
+                    continue;
+                }
+                tester.pendingOffset = 0;
+                if (nextRecord(&tester, startUs, corruptEvery, &frames)) {
+                    tester.expected++;
+                }
+            }
+            
+            ssize_t count = write(tester.master, tester.pending + tester.pendingOffset,
+                                  (size_t)(tester.pendingLength - tester.pendingOffset));
+            if (count > 0) {
+                tester.pendingOffset += (int)count;
+                bytesSent += (unsigned long long)count;
+                progress = true;
+                if (tester.pendingOffset == tester.pendingLength && tester.written == records) {
+                    remaining--;
+                }
+            }
+        }
+        if (!progress) {
+            // Every PTY is full: let the loop drain them
+            std::this_thread::yield();
+        }
+    }
+    writerDone = true;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    int deviceCount = 200;
+    int records = 500;
+    int corruptEvery = 0;
+    for (int i = 1; i + 1 < argc; i += 2) {
+        if (strcmp(argv[i], "--devices") == 0) {
+            deviceCount = atoi(argv[i + 1]);
+        } else if (strcmp(argv[i], "--records") == 0) {
+            records = atoi(argv[i + 1]);
+        } else if (strcmp(argv[i], "--corrupt") == 0) {
+            corruptEvery = atoi(argv[i + 1]);
+        }
+    }
+    
+    FILE* output = tmpfile();
+    if (!output) {
+        perror("tmpfile");
+        return 1;
+    }
+    static char outputBuffer[1 << 16];
+    setvbuf(output, outputBuffer, _IOFBF, sizeof(outputBuffer));
+    
+    IngestLoop loop(output, 200);
+    std::vector<Tester> testers;
+    testers.reserve(deviceCount);
+    for (int i = 0; i < deviceCount; i++) {
+        int master = posix_openpt(O_RDWR | O_NOCTTY | O_NONBLOCK);
+        if (master < 0 || grantpt(master) != 0 || unlockpt(master) != 0) {
+            if (master >= 0) {
+                close(master);
+            }
+            fprintf(stderr, "PTY limit reached after %d devices\n", i);
+            break;
+        }
+        if (loop.addDevice(ptsname(master), 115200) < 0) {
+            perror("open slave");
+            close(master);
+            break;
+        }
+        Tester tester;
+        memset(&tester, 0, sizeof(tester));
+        tester.master = master;
+        tester.baseMs = (uint32_t)(i * 7919 % 100000);
+        testers.push_back(tester);
+    }
+    if (testers.empty()) {
+        fprintf(stderr, "No PTYs available\n");
+        return 1;
+    }
+    
+    printf("=== Ingest load test: %d PTYs x %d records", (int)testers.size(), records);
+    if (corruptEvery > 0) {
+        printf(", every %d. frame corrupted", corruptEvery);
+    }
+    printf(" ===\n\n");
+    
+    int64_t startUs = ingestMonotonicUs();
+    double cpuStart = threadCpuSeconds();
+    std::thread writer(writeAll, &testers, records, corruptEvery);
+    
+    // Run until every byte written has been read, bounded in case bytes are lost
+    while (!(writerDone && loop.getTotalBytes() == bytesSent)) {
+        loop.runOnce(5);
+        if (ingestMonotonicUs() - startUs > 120000000) {
+            fprintf(stderr, "Timed out: %llu of %llu bytes read\n", loop.getTotalBytes(),
+                    (unsigned long long)bytesSent);
+            break;
+        }
+    }
+    loop.drain();
+    double seconds = (ingestMonotonicUs() - startUs) * 1e-6;
+    double cpu = threadCpuSeconds() - cpuStart;
+    writer.join();
+    
+    // Read the merged stream back
+    std::map<std::string, int> perDevice;
+    unsigned long lines = 0;
+    unsigned long outOfOrder = 0;
+    long long previousMs = 0;
+    char line[256];
+    rewind(output);
+    while (fgets(line, sizeof(line), output)) {
+        char* comma = strchr(line, ',');
+        char* nameEnd = comma ? strchr(comma + 1, ',') : nullptr;
+        if (!nameEnd) {
+            continue;
+        }
+        long long hostMs = atoll(line);
+        if (hostMs < previousMs) {
+            outOfOrder++;
+        }
+        previousMs = hostMs;
+        perDevice[std::string(comma + 1, nameEnd)]++;
+        lines++;
+    }
+    
+    unsigned long expected = 0;
+    unsigned long missing = 0;
+    unsigned long crcErrors = 0;
+    unsigned long lateRecords = 0;
+    for (size_t i = 0; i < testers.size(); i++) {
+        expected += (unsigned long)testers[i].expected;
+        const DeviceStats& stats = loop.getStats((int)i);
+        crcErrors += stats.crcErrors;
+        lateRecords += stats.lateRecords;
+        if (perDevice[loop.getName((int)i)] != testers[i].expected) {
+            missing++;
+        }
+        close(testers[i].master);
+    }
+    fclose(output);
+    
+    printf("records written          %10lu of %lu expected\n", lines, expected);
+    printf("bytes                    %10llu\n", loop.getTotalBytes());
+    printf("time                     %10.2f s\n", seconds);
+    printf("throughput               %10.0f records/s (%.1f MB/s)\n", lines / seconds,
+           loop.getTotalBytes() / seconds / 1e6);
+    printf("loop thread CPU          %10.1f %% (%.2f us/record)\n", cpu * 100.0 / seconds,
+           lines > 0 ? cpu * 1e6 / lines : 0.0);
+    printf("CRC errors               %10lu\n", crcErrors);
+    printf("late records             %10lu\n", lateRecords);
+    printf("devices with missing     %10lu\n", missing);
+    printf("out of order             %10lu\n", outOfOrder);
+    
+    bool passed = lines == expected && missing == 0 && outOfOrder == 0 &&
+                  (corruptEvery > 0 ? crcErrors > 0 : crcErrors == 0);
+    printf("\n%s\n", passed ? "PASS" : "FAIL");
+    return passed ? 0 : 1;
+}
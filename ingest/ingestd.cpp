@@ -0,0 +1,104 @@
+/**
+ * @brief Merge the serial output of many testers into one CSV stream
+ *
+ *   ingestd /dev/ttyUSB0 /dev/ttyUSB1 ...            merged stream on stdout
+ *   ingestd -o bench.csv -s 10 /dev/ttyACM*          to a file, statistics every 10 s
+ *
+ * Reads every device from one epoll loop until all of them are gone or
+ * SIGINT/SIGTERM, then prints the per-device statistics to stderr. Devices
+ * may use any mix of the text, CSV and binary output formats.
+ */
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include "IngestLoop.h"
+
+namespace {
+
+volatile sig_atomic_t stopRequested = 0;
+
+void onSignal(int) {
+    stopRequested = 1;
+}
+
+void usage() {
+    fprintf(stderr, "Usage: ingestd [-b baud] [-w window_ms] [-s stats_s] [-o out.csv] device...\n");
+}
+
+double cpuSeconds() {
+    struct timespec now;
+    clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &now);
+    return now.tv_sec + now.tv_nsec * 1e-9;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    int baud = 115200;
+    int windowMs = 200;
+    int statsSeconds = 0;
+    const char* outputPath = nullptr;
+    int first = 1;
+    
+    for (; first < argc && argv[first][0] == '-'; first++) {
+        if (first + 1 >= argc) {
+            usage();
+            return 1;
+        }
+        if (strcmp(argv[first], "-b") == 0) {
+            baud = atoi(argv[++first]);
+        } else if (strcmp(argv[first], "-w") == 0) {
+            windowMs = atoi(argv[++first]);
+        } else if (strcmp(argv[first], "-s") == 0) {
+            statsSeconds = atoi(argv[++first]);
+        } else if (strcmp(argv[first], "-o") == 0) {
+            outputPath = argv[++first];
+        } else {
+            usage();
+            return 1;
+        }
+    }
+    if (first >= argc) {
+        usage();
+        return 1;
+    }
+    
+    FILE* output = outputPath ? fopen(outputPath, "w") : stdout;
+    if (!output) {
+        fprintf(stderr, "Cannot open %s\n", outputPath);
+        return 1;
+    }
+    static char outputBuffer[1 << 16];
+    setvbuf(output, outputBuffer, _IOFBF, sizeof(outputBuffer));
+    fputs("host_ms,device,source,device_ms,raw,voltage,cells,confidence,cell_v,charge,mv_per_min,min_to_empty,text\n",
+          output);
+    
+    IngestLoop loop(output, windowMs);
+    for (int i = first; i < argc; i++) {
+        if (loop.addDevice(argv[i], baud) < 0) {
+            fprintf(stderr, "Cannot open %s\n", argv[i]);
+        }
+    }
+    if (loop.getDeviceCount() == 0) {
+        return 1;
+    }
+    
+    signal(SIGINT, onSignal);
+    signal(SIGTERM, onSignal);
+    double wallStart = ingestMonotonicUs() * 1e-6;
+    double cpuStart = cpuSeconds();
+    
+    loop.run(&stopRequested, statsSeconds * 1000);
+    
+    double wall = ingestMonotonicUs() * 1e-6 - wallStart;
+    loop.printStats(stderr);
+    fprintf(stderr, "%.1f s, %.0f records/s, CPU %.1f%%\n", wall,
+            wall > 0.0 ? loop.getTotalWritten() / wall : 0.0,
+            wall > 0.0 ? (cpuSeconds() - cpuStart) * 100.0 / wall : 0.0);
+    if (output != stdout) {
+        fclose(output);
+    }
+    return 0;
+}
@@ -0,0 +1,282 @@
+/**
+ * @brief Store collected readings in a series file and query them
+ *
+ *   series_store import soak.lpts bench.csv ...      ingestd output (stdin if no file)
+ *   series_store info soak.lpts                      devices, chunks, compression
+ *   series_store verify soak.lpts                    check every chunk's CRC
+ *   series_store query soak.lpts --last 7d --below-cell 3.5 --summary
+ *
+ * Query options: --device <name>, --from/--to <ms since epoch>, --last
+ * <N>s|m|h|d (before now), --below-cell <volts per cell>, --summary (one
+ * line per device instead of the readings). Query work (chunks scanned and
+ * skipped by the index) is printed to stderr.
+ */
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <vector>
+#include "SeriesStore.h"
+
+namespace {
+
+void usage() {
+    fprintf(stderr, "Usage: series_store import <file> [capture.csv...]\n"
+                    "       series_store info|verify <file>\n"
+                    "       series_store query <file> [--device name] [--from ms] [--to ms] [--last 7d]\n"
+                    "                                 [--below-cell volts] [--summary]\n");
+}
+
+int64_t nowMs() {
+    struct timespec now;
+    clock_gettime(CLOCK_REALTIME, &now);
+    return (int64_t)now.tv_sec * 1000 + now.tv_nsec / 1000000;
+}
+
+/**
+ * @brief Parse "90s", "30m", "12h" or "7d" into milliseconds
+ */
+int64_t parseDuration(const char* text) {
+    char* end;
+    double value = strtod(text, &end);
+    switch (*end) {
+        case 's': return (int64_t)(value * 1000.0);
+        case 'm': return (int64_t)(value * 60000.0);
+        case 'h': return (int64_t)(value * 3600000.0);
+        case 'd': return (int64_t)(value * 86400000.0);
+        default: return -1;
+    }
+}
+
+/**
+ * @brief Import ingestd lines: host_ms,device,source,device_ms,raw,voltage,cells,confidence,cell_v,charge,...
+ */
+unsigned long importCapture(FILE* in, SeriesWriter* writer) {
+    char line[512];
+    char lastDevice[64] = "";
+    int device = -1;
+    unsigned long imported = 0;
+    
+    while (fgets(line, sizeof(line), in)) {
+        const char* fields[10];
+        int count = 0;
+        char* cursor = line;
+        while (count < 10) {
+            fields[count++] = cursor;
+            char* comma = strchr(cursor, ',');
+            if (!comma) {
+                break;
+            }
+            *comma = '\0';
+            cursor = comma + 1;
+        }
+        if (count < 10 || strcmp(fields[2], "msg") == 0 || fields[0][0] < '0' || fields[0][0] > '9') {
+            continue;    // Header, messages or a damaged line
+        }
+        
+        if (device < 0 || strcmp(fields[1], lastDevice) != 0) {
+            snprintf(lastDevice, sizeof(lastDevice), "%s", fields[1]);
+            device = writer->getDevice(lastDevice);
+        }
+        SeriesReading reading;
+        reading.timeMs = strtoll(fields[0], nullptr, 10);
+        double millivolts = strtod(fields[5], nullptr) * 1000.0 + 0.5;
+        reading.millivolts = (uint16_t)(millivolts < 0.0 ? 0.0 : millivolts > 65535.0 ? 65535.0 : millivolts);
+        reading.cellCount = (uint8_t)atoi(fields[6]);
+        reading.charge = (uint8_t)atoi(fields[9]);
+        writer->append(device, reading);
+        imported++;
+    }
+    return imported;
+}
+
+int runImport(int argc, char* argv[]) {
+    SeriesWriter writer;
+    if (!writer.open(argv[0])) {
+        fprintf(stderr, "Cannot create %s\n", argv[0]);
+        return 1;
+    }
+    unsigned long imported = 0;
+    if (argc == 1) {
+        imported = importCapture(stdin, &writer);
+    }
+    for (int i = 1; i < argc; i++) {
+        FILE* in = fopen(argv[i], "r");
+        if (!in) {
+            fprintf(stderr, "Cannot open %s\n", argv[i]);
+            continue;
+        }
+        imported += importCapture(in, &writer);
+        fclose(in);
+    }
+    if (!writer.close()) {
+        fprintf(stderr, "Write error on %s\n", argv[0]);
+        return 1;
+    }
+    fprintf(stderr, "%lu readings, %llu bytes (%.2f bytes/reading)\n", imported, writer.getBytesWritten(),
+            imported > 0 ? (double)writer.getBytesWritten() / imported : 0.0);
+    return 0;
+}
+
+int runInfo(const SeriesReader& reader) {
+    std::vector<unsigned long long> readings(reader.getDeviceCount(), 0);
+    std::vector<int> chunkCounts(reader.getDeviceCount(), 0);
+    unsigned long long total = 0;
+    unsigned long long columnBytes[4] = { 0, 0, 0, 0 };
+    for (int i = 0; i < reader.getChunkCount(); i++) {
+        const SeriesChunkInfo& chunk = reader.getChunk(i);
+        readings[chunk.device] += chunk.count;
+        chunkCounts[chunk.device]++;
+        total += chunk.count;
+        for (int column = 0; column < 4; column++) {
+            columnBytes[column] += chunk.columnBytes[column];
+        }
+    }
+    
+    printf("%-24s %12s %8s\n", "device", "readings", "chunks");
+    for (int i = 0; i < reader.getDeviceCount(); i++) {
+        printf("%-24s %12llu %8d\n", reader.getDeviceName(i), readings[i], chunkCounts[i]);
+    }
+    printf("\n%llu readings in %d chunks, %zu bytes (%.2f bytes/reading)%s\n", total, reader.getChunkCount(),
+           reader.getFileSize(), total > 0 ? (double)reader.getFileSize() / total : 0.0,
+           reader.wasRecovered() ? ", index recovered from chunk headers" : "");
+    if (total > 0) {
+        printf("bits/reading: time %.2f, voltage %.2f, cells %.2f, charge %.2f\n",
+               columnBytes[0] * 8.0 / total, columnBytes[1] * 8.0 / total,
+               columnBytes[2] * 8.0 / total, columnBytes[3] * 8.0 / total);
+    }
+    return 0;
+}
+
+int runVerify(const SeriesReader& reader) {
+    int damaged = 0;
+    for (int i = 0; i < reader.getChunkCount(); i++) {
+        if (!reader.verifyChunk(i)) {
+            const SeriesChunkInfo& chunk = reader.getChunk(i);
+            printf("chunk %d (%s, offset %llu): CRC mismatch\n", i, reader.getDeviceName(chunk.device),
+                   (unsigned long long)chunk.offset);
+            damaged++;
+        }
+    }
+    printf("%d chunks, %d damaged\n", reader.getChunkCount(), damaged);
+    return damaged > 0 ? 1 : 0;
+}
+
+struct QueryOutput {
+    const SeriesReader* reader;
+    bool summary;
+    std::vector<unsigned long> matches;
+    std::vector<uint16_t> minimum;
+    std::vector<int64_t> first;
+    std::vector<int64_t> last;
+};
+
+void visitReading(void* context, int device, const SeriesReading& reading) {
+    QueryOutput* output = (QueryOutput*)context;
+    if (!output->summary) {
+        printf("%lld,%s,%.3f,%u,%u\n", (long long)reading.timeMs, output->reader->getDeviceName(device),
+               reading.millivolts / 1000.0, (unsigned)reading.cellCount, (unsigned)reading.charge);
+        return;
+    }
+    uint16_t cell = reading.cellCount > 0 ? (uint16_t)(reading.millivolts / reading.cellCount) : 0;
+    if (output->matches[device] == 0 || cell < output->minimum[device]) {
+        output->minimum[device] = cell;
+    }
+    if (output->matches[device] == 0 || reading.timeMs < output->first[device]) {
+        output->first[device] = reading.timeMs;
+    }
+    if (output->matches[device] == 0 || reading.timeMs > output->last[device]) {
+        output->last[device] = reading.timeMs;
+    }
+    output->matches[device]++;
+}
+
+int runQuery(const SeriesReader& reader, int argc, char* argv[]) {
+    SeriesQuery query;
+    QueryOutput output;
+    output.reader = &reader;
+    output.summary = false;
+    
+    for (int i = 0; i < argc; i++) {
+        bool hasValue = i + 1 < argc;
+        if (strcmp(argv[i], "--summary") == 0) {
+            output.summary = true;
+        } else if (strcmp(argv[i], "--device") == 0 && hasValue) {
+            query.device = reader.findDevice(argv[++i]);
+            if (query.device < 0) {
+                fprintf(stderr, "No device %s\n", argv[i]);
+                return 1;
+            }
+        } else if (strcmp(argv[i], "--from") == 0 && hasValue) {
+            query.fromMs = strtoll(argv[++i], nullptr, 10);
+        } else if (strcmp(argv[i], "--to") == 0 && hasValue) {
+            query.toMs = strtoll(argv[++i], nullptr, 10);
+        } else if (strcmp(argv[i], "--last") == 0 && hasValue) {
+            int64_t duration = parseDuration(argv[++i]);
+            if (duration < 0) {
+                usage();
+                return 1;
+            }
+            query.fromMs = nowMs() - duration;
+        } else if (strcmp(argv[i], "--below-cell") == 0 && hasValue) {
+            query.belowCellMillivolts = (uint16_t)(strtod(argv[++i], nullptr) * 1000.0 + 0.5);
+        } else {
+            usage();
+            return 1;
+        }
+    }
+    
+    query.withCharge = !output.summary;
+    output.matches.assign(reader.getDeviceCount(), 0);
+    output.minimum.assign(reader.getDeviceCount(), 0);
+    output.first.assign(reader.getDeviceCount(), 0);
+    output.last.assign(reader.getDeviceCount(), 0);
+    if (!output.summary) {
+        printf("time_ms,device,voltage,cells,charge\n");
+    }
+    
+    SeriesQueryStats stats;
+    reader.query(query, visitReading, &output, &stats);
+    
+    if (output.summary) {
+        printf("device,readings,min_cell_v,first_ms,last_ms\n");
+        for (int i = 0; i < reader.getDeviceCount(); i++) {
+            if (output.matches[i] > 0) {
+                printf("%s,%lu,%.3f,%lld,%lld\n", reader.getDeviceName(i), output.matches[i],
+                       output.minimum[i] / 1000.0, (long long)output.first[i], (long long)output.last[i]);
+            }
+        }
+    }
+    fprintf(stderr, "%llu readings matched; %lu chunks decoded, %lu skipped by the index\n",
+            stats.readingsMatched, stats.chunksScanned, stats.chunksSkipped);
+    return 0;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    if (argc < 3) {
+        usage();
+        return 1;
+    }
+    if (strcmp(argv[1], "import") == 0) {
+        return runImport(argc - 2, argv + 2);
+    }
+    
+    SeriesReader reader;
+    if (!reader.open(argv[2])) {
+        fprintf(stderr, "%s is not a series file\n", argv[2]);
+        return 1;
+    }
+    if (strcmp(argv[1], "info") == 0) {
+        return runInfo(reader);
+    }
+    if (strcmp(argv[1], "verify") == 0) {
+        return runVerify(reader);
+    }
+    if (strcmp(argv[1], "query") == 0) {
+        return runQuery(reader, argc - 3, argv + 3);
+    }
+    usage();
+    return 1;
+}
@@ -0,0 +1,265 @@
+#include "AdcModel.h"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+// Samples converted per pass (the noise and input chunks stay in L1)
+const size_t CHUNK = 1024;
+
+// Sum of the four bytes of a uniform 32-bit value: mean and standard deviation
+const float SUM_MEAN = 4.0f * 255.0f / 2.0f;
+const float SUM_SIGMA = 147.7845f;          // sqrt(4 * (256^2 - 1) / 12)
+
+/**
+ * @brief 32-bit integer hash (lowbias32): the counter-based generator's round
+ */
+inline uint32_t hash32(uint32_t x) {
+    x ^= x >> 16;
+    x *= 0x7feb352du;
+    x ^= x >> 15;
+    x *= 0x846ca68bu;
+    x ^= x >> 16;
+    return x;
+}
+
+/**
+ * @brief Approximately standard normal value from one hash
+ *
+ * Sum of its four bytes (Irwin-Hall): close to a Gaussian out to about 2.5
+ * sigma, bounded at 3.45 sigma, in steps of 1/148 sigma, and only integer
+ * work per sample.
+ */
+inline float gaussian(uint32_t hash) {
+    float sum = (float)((hash & 0xffu) + ((hash >> 8) & 0xffu) + ((hash >> 16) & 0xffu) + (hash >> 24));
+    return (sum - SUM_MEAN) * (1.0f / SUM_SIGMA);
+}
+
+/**
+ * @brief Uniform value in [-1, 1) for a 64-bit index under a key
+ */
+inline float uniformAt(uint64_t index, uint32_t key) {
+    uint32_t a = hash32((uint32_t)index ^ hash32((uint32_t)(index >> 32) ^ key));
+    return (float)(a >> 8) / 8388608.0f - 1.0f;
+}
+
+inline float clampValue(float value, float low, float high) {
+    value = value < low ? low : value;
+    return value > high ? high : value;
+}
+
+} // namespace
+
+AdcModelConfig::AdcModelConfig()
+    : dividerHighOhms(68000.0f),
+      dividerLowOhms(10000.0f),
+      resistorTolerance(0.0f),
+      vrefVolts(3.3f),
+      vrefTolerance(0.0f),
+      bits(12),
+      gainError(0.0f),
+      offsetCounts(0.0f),
+      noiseCounts(1.4f),
+      flickerCounts(0.0f),
+      bowCounts(0.0f),
+      compressionStart(1.0f),
+      compressionCounts(0.0f),
+      dnlCounts(0.0f) {
+}
+
+AdcModelConfig AdcModelConfig::ideal() {
+    AdcModelConfig config;
+    config.noiseCounts = 0.0f;
+    return config;
+}
+
+AdcModelConfig AdcModelConfig::esp32c3() {
+    AdcModelConfig config;
+    config.resistorTolerance = 0.01f;
+    config.vrefTolerance = 0.01f;
+    config.gainError = 0.015f;
+    config.offsetCounts = 25.0f;
+    config.noiseCounts = 3.0f;
+    config.flickerCounts = 1.5f;
+    config.bowCounts = 30.0f;
+    config.compressionStart = 0.9f;
+    config.compressionCounts = 6000.0f;
+    config.dnlCounts = 0.8f;
+    return config;
+}
+
+AdcModel::AdcModel(const AdcModelConfig& config, uint64_t seed)
+    : config(config), counter(0) {
+    uint32_t base = hash32((uint32_t)seed ^ hash32((uint32_t)(seed >> 32) ^ 0x2545f491u));
+    noiseKey = hash32(base + 0x9e3779b9u);
+    for (int row = 0; row < ADC_MODEL_PINK_ROWS; row++) {
+        pinkKeys[row] = hash32(base ^ hash32((uint32_t)row + 0xdaa66d2bu));
+    }
+    
+    // This unit's parts, within tolerance
+    uint32_t partKey = hash32(base ^ 0xb5297a4du);
+    float high = config.dividerHighOhms * (1.0f + config.resistorTolerance * uniformAt(0, partKey));
+    float low = config.dividerLowOhms * (1.0f + config.resistorTolerance * uniformAt(1, partKey));
+    dividerRatio = (high + low) / low;
+    vref = config.vrefVolts * (1.0f + config.vrefTolerance * uniformAt(2, partKey));
+    
+    maxCode = (1 << config.bits) - 1;
+    countsPerVolt = maxCode / vref / dividerRatio * (1.0f + config.gainError);
+    float nominalRatio = (config.dividerHighOhms + config.dividerLowOhms) / config.dividerLowOhms;
+    nominalVoltsPerCount = config.vrefVolts / maxCode * nominalRatio;
+    pinkScale = config.flickerCounts / sqrtf((float)ADC_MODEL_PINK_ROWS);
+    
+    if (config.dnlCounts > 0.0f) {
+        uint32_t dnlKey = hash32(base ^ 0x1b873593u);
+        dnl.resize(maxCode + 1);
+        for (int code = 0; code <= maxCode; code++) {
+            dnl[code] = 0.5f * config.dnlCounts * uniformAt((uint64_t)code, dnlKey);
+        }
+    }
+}
+
+void AdcModel::generateFlicker(uint64_t first, float* noise, size_t count) const {
+    // 1/f (Voss-McCartney): row k holds one value per 2^(k+1) samples, drawn
+    // from the block number. Summed coarse to fine, one level per row: the
+    // draws are a vector loop, and each sample adds one precomputed sum.
+    if (pinkScale == 0.0f) {
+        std::fill(noise, noise + count, 0.0f);
+        return;
+    }
+    float draws[CHUNK / 2 + 2];
+    float levelA[CHUNK / 2 + 2];
+    float levelB[CHUNK / 2 + 2];
+    float* upper = levelA;
+    float* lower = levelB;
+    uint64_t last = first + count - 1;
+    for (int row = ADC_MODEL_PINK_ROWS - 1; row >= 0; row--) {
+        int shift = row + 1;
+        uint64_t base = first >> shift;
+        size_t blocks = (size_t)((last >> shift) - base + 1);
+        uint32_t rowKey = hash32(pinkKeys[row] ^ hash32((uint32_t)(base >> 32)));
+        uint32_t lowBase = (uint32_t)base;
+        for (size_t i = 0; i < blocks; i++) {
+            draws[i] = gaussian(hash32((lowBase + (uint32_t)i) ^ rowKey)) * pinkScale;
+        }
+        if (row == ADC_MODEL_PINK_ROWS - 1) {
+            std::copy(draws, draws + blocks, lower);
+        } else {
+            size_t odd = (size_t)(base & 1);     // Where this level starts in the coarser one's first block
+            for (size_t i = 0; i < blocks; i++) {
+                lower[i] = upper[(odd + i) >> 1] + draws[i];
+            }
+        }
+        std::swap(upper, lower);
+    }
+    size_t odd = (size_t)(first & 1);
+    for (size_t j = 0; j < count; j++) {
+        noise[j] = upper[(odd + j) >> 1];
+    }
+}
+
+void AdcModel::convert(uint64_t first, const float* batteryVolts, float* analog, uint16_t* raw,
+                       size_t count) const {
+    const float top = (float)maxCode;
+    const float perCode = 1.0f / top;
+    const float offset = config.offsetCounts;
+    const float bow = config.bowCounts * 16.0f;
+    const float start = config.compressionStart;
+    const float compression = config.compressionCounts;
+    const float scale = countsPerVolt;
+    const float white = config.noiseCounts;
+    // White noise: one hash per sample; the high counter word only changes the key
+    const uint32_t key = hash32(noiseKey ^ hash32((uint32_t)(first >> 32)));
+    const uint32_t low = (uint32_t)first;
+    
+    // analog arrives holding the 1/f noise. One pass adds white noise and the
+    // transfer curve, and quantizes unless DNL needs the analog value first.
+    bool quantize = dnl.empty();
+    for (size_t j = 0; j < count; j++) {
+        float ideal = batteryVolts[j] * scale;
+        float x = clampValue(ideal * perCode, 0.0f, 1.0f);
+        float s = x * (1.0f - x);
+        float over = clampValue(x - start, 0.0f, 1.0f);
+        // Half-sine bow, sin(pi x) ~ 16 s / (5 - 4 s) (Bhaskara, < 0.2% off)
+        float value = analog[j] + ideal + offset + bow * s / (5.0f - 4.0f * s) - over * over * compression +
+                      gaussian(hash32((low + (uint32_t)j) ^ key)) * white;
+        analog[j] = value;
+        raw[j] = (uint16_t)(int)clampValue(value + 0.5f, 0.0f, top);
+    }
+    if (quantize) {
+        return;
+    }
+    for (size_t j = 0; j < count; j++) {
+        float value = analog[j] + dnl[(int)clampValue(analog[j], 0.0f, top)];
+        raw[j] = (uint16_t)(int)clampValue(value + 0.5f, 0.0f, top);
+    }
+}
+
+uint16_t AdcModel::sample(float batteryVolts) {
+    float analog;
+    uint16_t raw;
+    generateFlicker(counter, &analog, 1);
+    convert(counter, &batteryVolts, &analog, &raw, 1);
+    counter++;
+    return raw;
+}
+
+void AdcModel::sampleBatch(const float* batteryVolts, uint16_t* raw, size_t count) {
+    float analog[CHUNK];
+    while (count > 0) {
+        // Chunks never cross a change of the high counter word
+        size_t length = std::min(count, CHUNK);
+        uint64_t toWrap = 0x100000000ull - (counter & 0xffffffffull);
+        length = (size_t)std::min((uint64_t)length, toWrap);
+        generateFlicker(counter, analog, length);
+        convert(counter, batteryVolts, analog, raw, length);
+        counter += length;
+        batteryVolts += length;
+        raw += length;
+        count -= length;
+    }
+}
+
+void AdcModel::sampleConstant(float batteryVolts, uint16_t* raw, size_t count) {
+    float input[CHUNK];
+    std::fill(input, input + CHUNK, batteryVolts);
+    while (count > 0) {
+        size_t length = std::min(count, CHUNK);
+        sampleBatch(input, raw, length);
+        raw += length;
+        count -= length;
+    }
+}
+
+float AdcModel::toVolts(uint16_t raw) const {
+    return raw * nominalVoltsPerCount;
+}
+
+float AdcModel::transfer(float batteryVolts) const {
+    float ideal = batteryVolts * countsPerVolt;
+    float x = clampValue(ideal / maxCode, 0.0f, 1.0f);
+    float s = x * (1.0f - x);
+    float over = clampValue(x - config.compressionStart, 0.0f, 1.0f);
+    float code = ideal + config.offsetCounts + config.bowCounts * 16.0f * s / (5.0f - 4.0f * s) -
+                 over * over * config.compressionCounts;
+    return clampValue(code, 0.0f, (float)maxCode);
+}
+
+void AdcModel::seek(uint64_t position) {
+    counter = position;
+}
+
+uint64_t AdcModel::tell() const {
+    return counter;
+}
+
+int AdcModel::getMaxCode() const {
+    return maxCode;
+}
+
+float AdcModel::getDividerRatio() const {
+    return dividerRatio;
+}
+
+float AdcModel::getVref() const {
+    return vref;
+}
@@ -0,0 +1,142 @@
+#ifndef ADC_MODEL_H
+#define ADC_MODEL_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Pink noise octaves: 1/f from 2 to 2^ADC_MODEL_PINK_ROWS samples
+#define ADC_MODEL_PINK_ROWS 10
+
+/**
+ * @brief Parameters of a battery voltage front end: divider, reference and ADC
+ *
+ * The tolerances are part-to-part: each AdcModel instance draws its own
+ * resistor and reference values within them from its seed, like one unit off
+ * the production line. All error terms are in ADC counts unless noted.
+ */
+struct AdcModelConfig {
+    float dividerHighOhms;      // R1 (battery side)
+    float dividerLowOhms;       // R2 (ground side)
+    float resistorTolerance;    // Relative, e.g. 0.01 for 1% parts
+    float vrefVolts;            // Nominal reference (full scale)
+    float vrefTolerance;        // Relative
+    int bits;                   // Resolution (max code 2^bits - 1)
+    float gainError;            // Relative
+    float offsetCounts;
+    float noiseCounts;          // White Gaussian noise, standard deviation
+    float flickerCounts;        // 1/f noise, standard deviation
+    float bowCounts;            // INL: half-sine bow over the range, peak
+    float compressionStart;     // INL: fraction of full scale where the top end compresses (1 = none)
+    float compressionCounts;    // INL: compression is over^2 * this, over = fraction above the start
+    float dnlCounts;            // DNL: per-code threshold shift, uniform +/- half of this
+    
+    /**
+     * @brief Simulator defaults: nominal 68k/10k divider and 3.3V 12-bit ADC, 1.4 counts of noise
+     */
+    AdcModelConfig();
+    
+    /**
+     * @brief No errors or noise: the ideal quantizer
+     */
+    static AdcModelConfig ideal();
+    
+    /**
+     * @brief ESP32-C3-like front end: 1% resistors, uncalibrated ADC
+     *
+     * Same gain, offset, bow and top-end compression as the synthetic ADC
+     * in the calibration tests, plus noise and DNL of the order the C3
+     * shows without averaging.
+     */
+    static AdcModelConfig esp32c3();
+};
+
+/**
+ * @brief Battery voltage to ADC code, with the errors of a real front end
+ *
+ * Noise comes from a counter-based generator: sample n's noise is a hash of
+ * (seed, n), not the next value of a shared state. An instance is therefore
+ * reproducible, can seek() to any sample, and copies seeked to disjoint
+ * ranges generate the same stream in parallel. Instances share nothing, so
+ * each thread can own one.
+ *
+ * The batch calls work in chunks that stay in L1 and run as plain loops the
+ * compiler vectorizes; sample() is the same model for one value.
+ */
+class AdcModel {
+public:
+    /**
+     * @brief Build one unit
+     * @param config Front-end parameters
+     * @param seed Unit and noise stream identity
+     */
+    AdcModel(const AdcModelConfig& config, uint64_t seed);
+    
+    /**
+     * @brief Convert one battery voltage (advances the sample counter)
+     * @return ADC code
+     */
+    uint16_t sample(float batteryVolts);
+    
+    /**
+     * @brief Convert a buffer of battery voltages
+     * @param batteryVolts Input voltages
+     * @param raw Receives the ADC codes
+     * @param count Samples
+     */
+    void sampleBatch(const float* batteryVolts, uint16_t* raw, size_t count);
+    
+    /**
+     * @brief Convert a constant battery voltage count times (noise and error studies)
+     */
+    void sampleConstant(float batteryVolts, uint16_t* raw, size_t count);
+    
+    /**
+     * @brief Voltage the firmware computes from a code with the nominal conversion (no calibration)
+     */
+    float toVolts(uint16_t raw) const;
+    
+    /**
+     * @brief Noise-free, rounding-free code for a voltage (the transfer curve of this unit)
+     */
+    float transfer(float batteryVolts) const;
+    
+    /**
+     * @brief Move to a sample number (the next sample() uses it)
+     */
+    void seek(uint64_t position);
+    
+    /**
+     * @brief Get the number of the next sample
+     */
+    uint64_t tell() const;
+    int getMaxCode() const;
+    
+    /**
+     * @brief Divider ratio (R1 + R2) / R2 this unit actually has
+     */
+    float getDividerRatio() const;
+    
+    /**
+     * @brief Reference voltage this unit actually has
+     */
+    float getVref() const;
+
+private:
+    AdcModelConfig config;
+    uint64_t counter;
+    uint32_t noiseKey;
+    uint32_t pinkKeys[ADC_MODEL_PINK_ROWS];
+    int maxCode;
+    float dividerRatio;
+    float vref;
+    float countsPerVolt;        // Including the gain error
+    float nominalVoltsPerCount;
+    float pinkScale;
+    std::vector<float> dnl;     // Per code threshold shift (empty without DNL)
+    
+    void generateFlicker(uint64_t first, float* noise, size_t count) const;
+    void convert(uint64_t first, const float* batteryVolts, float* analog, uint16_t* raw, size_t count) const;
+};
+
+#endif // ADC_MODEL_H
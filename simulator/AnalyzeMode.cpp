@@ -0,0 +1,415 @@
+#include "AnalyzeMode.h"
+#include <cctype>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+#include "ChemistrySelector.h"
+#ifdef _WIN32
+#include <fcntl.h>
+#include <io.h>
+#endif
+
+namespace {
+
+// Bytes per read() of the input and per write of the output
+const size_t IO_BLOCK = 1 << 20;
+
+// Values analyzed per batch
+const size_t BATCH = 4096;
+
+// Longest CSV line: "-99999.999,6,-99999.999,100,1\n" plus margin
+const size_t MAX_LINE = 64;
+
+// Longest text token parsed; anything longer is skipped
+const size_t MAX_TOKEN = 64;
+
+enum InputFormat { INPUT_TEXT, INPUT_F32 };
+enum OutputFormat { OUTPUT_CSV, OUTPUT_BINARY };
+
+struct AnalyzeOptions {
+    InputFormat input;
+    OutputFormat output;
+    ChemistryType chemistry;
+    const char* inputPath;      // nullptr or "-" = stdin
+    const char* outputPath;     // nullptr or "-" = stdout
+};
+
+/**
+ * @brief Byte classes for the text scanner (one load per byte instead of six compares)
+ */
+struct SeparatorTable {
+    bool separator[256];
+    SeparatorTable() {
+        memset(separator, 0, sizeof(separator));
+        const char* list = " \n\r\t,;";
+        for (const char* c = list; *c; c++) {
+            separator[(unsigned char)*c] = true;
+        }
+    }
+};
+
+const SeparatorTable SEPARATORS;
+
+inline bool isSeparator(char c) {
+    return SEPARATORS.separator[(unsigned char)c];
+}
+
+// 10^-k for the fraction digits of a plain decimal
+const double NEGATIVE_POWERS[] = {
+    1e0, 1e-1, 1e-2, 1e-3, 1e-4, 1e-5, 1e-6, 1e-7, 1e-8, 1e-9,
+    1e-10, 1e-11, 1e-12, 1e-13, 1e-14, 1e-15, 1e-16, 1e-17, 1e-18
+};
+
+/**
+ * @brief Parse the token at begin as a float
+ *
+ * Plain decimals ("11.1", "-0.5", "12") are converted inline from integer
+ * digits in the same pass that finds the end of the token, which is most of
+ * the cost saved over strtof. Exponents, long mantissas, inf and nan go
+ * through strtof. A separator must follow the token in the buffer, so the
+ * scan needs no bounds checks.
+ * @param begin First byte of the token (not a separator)
+ * @param stop Receives the separator after the token
+ * @param value Receives the number
+ * @return true if the whole token is a number
+ */
+bool parseToken(const char* begin, const char** stop, float* value) {
+    const char* p = begin;
+    bool negative = *p == '-';
+    p += (*p == '-' || *p == '+') ? 1 : 0;
+    uint64_t mantissa = 0;
+    int digits = 0;
+    int fraction = 0;
+    while ((unsigned)(*p - '0') < 10) {
+        mantissa = mantissa * 10 + (uint64_t)(*p - '0');
+        digits++;
+        p++;
+    }
+    if (*p == '.') {
+        p++;
+        while ((unsigned)(*p - '0') < 10) {
+            mantissa = mantissa * 10 + (uint64_t)(*p - '0');
+            digits++;
+            fraction++;
+            p++;
+        }
+    }
+    if (isSeparator(*p) && digits > 0 && digits <= 18) {
+        double number = (double)mantissa * NEGATIVE_POWERS[fraction];
+        *value = (float)(negative ? -number : number);
+        *stop = p;
+        return true;
+    }
+    
+    // Slow path: strtof needs a terminated copy
+    while (!isSeparator(*p)) {
+        p++;
+    }
+    *stop = p;
+    size_t length = (size_t)(p - begin);
+    if (length >= MAX_TOKEN) {
+        return false;
+    }
+    char token[MAX_TOKEN];
+    memcpy(token, begin, length);
+    token[length] = '\0';
+    char* end = nullptr;
+    *value = strtof(token, &end);
+    return end == token + length;
+}
+
+/**
+ * @brief Append value with three decimals (what the display resolution needs)
+ */
+char* writeFixed3(char* out, float value) {
+    if (!(fabsf(value) < 1e9f)) {
+        return out + snprintf(out, MAX_LINE / 2, "%.3f", value);
+    }
+    if (value < 0.0f) {
+        *out++ = '-';
+        value = -value;
+    }
+    uint64_t scaled = (uint64_t)((double)value * 1000.0 + 0.5);
+    uint64_t whole = scaled / 1000;
+    unsigned millis = (unsigned)(scaled % 1000);
+    char digits[24];
+    int count = 0;
+    do {
+        digits[count++] = (char)('0' + whole % 10);
+        whole /= 10;
+    } while (whole > 0);
+    while (count > 0) {
+        *out++ = digits[--count];
+    }
+    out[0] = '.';
+    out[1] = (char)('0' + millis / 100);
+    out[2] = (char)('0' + millis / 10 % 10);
+    out[3] = (char)('0' + millis % 10);
+    return out + 4;
+}
+
+/**
+ * @brief Append an integer 0-999
+ */
+char* writeSmall(char* out, int value) {
+    if (value >= 100) {
+        *out++ = (char)('0' + value / 100);
+    }
+    if (value >= 10) {
+        *out++ = (char)('0' + value / 10 % 10);
+    }
+    *out++ = (char)('0' + value % 10);
+    return out;
+}
+
+/**
+ * @brief Analyzes batches of voltages and writes the results through one buffer
+ */
+class ResultWriter {
+public:
+    ResultWriter(FILE* file, OutputFormat format, ChemistryType chemistry)
+        : file(file), format(format), chemistry(chemistry), buffer(IO_BLOCK + BATCH * MAX_LINE), used(0),
+          values(0), failed(false) {
+        if (format == OUTPUT_CSV) {
+            const char* header = "voltage,cells,cell_voltage,charge,valid\n";
+            used = strlen(header);
+            memcpy(&buffer[0], header, used);
+        }
+    }
+    
+    void analyze(const float* voltages, size_t count) {
+        for (size_t i = 0; i < count; i++) {
+            BatteryInfo info = ChemistrySelector::analyzeBattery(chemistry, voltages[i]);
+            if (format == OUTPUT_CSV) {
+                char* out = &buffer[used];
+                out = writeFixed3(out, info.totalVoltage);
+                *out++ = ',';
+                out = writeSmall(out, info.cellCount);
+                *out++ = ',';
+                out = writeFixed3(out, info.averageCellVoltage);
+                *out++ = ',';
+                out = writeSmall(out, info.chargePercentage);
+                *out++ = ',';
+                *out++ = info.isValid ? '1' : '0';
+                *out++ = '\n';
+                used = (size_t)(out - &buffer[0]);
+            } else {
+                AnalyzeRecord record;
+                record.voltage = info.totalVoltage;
+                record.averageCellVoltage = info.averageCellVoltage;
+                record.cellCount = (uint8_t)info.cellCount;
+                record.chargePercentage = (uint8_t)info.chargePercentage;
+                record.isValid = info.isValid ? 1 : 0;
+                record.reserved = 0;
+                memcpy(&buffer[used], &record, sizeof(record));
+                used += sizeof(record);
+            }
+        }
+        values += count;
+        if (used >= IO_BLOCK) {
+            flush();
+        }
+    }
+    
+    void flush() {
+        if (used > 0 && fwrite(&buffer[0], 1, used, file) != used) {
+            failed = true;
+        }
+        used = 0;
+    }
+    
+    unsigned long long getValues() const { return values; }
+    bool hasFailed() const { return failed; }
+
+private:
+    FILE* file;
+    OutputFormat format;
+    ChemistryType chemistry;
+    std::vector<char> buffer;   // Room for a full block plus one batch
+    size_t used;
+    unsigned long long values;
+    bool failed;
+};
+
+/**
+ * @brief Stream raw float32 values, carrying a partial value across reads
+ * @return Bytes left over at the end (not a whole value)
+ */
+unsigned long long readFloats(FILE* in, ResultWriter* writer) {
+    std::vector<float> block(IO_BLOCK / sizeof(float));
+    char* bytes = (char*)&block[0];
+    size_t carried = 0;
+    size_t got;
+    while ((got = fread(bytes + carried, 1, IO_BLOCK - carried, in)) > 0) {
+        size_t available = carried + got;
+        size_t count = available / sizeof(float);
+        for (size_t i = 0; i < count; i += BATCH) {
+            writer->analyze(&block[i], count - i < BATCH ? count - i : BATCH);
+        }
+        carried = available - count * sizeof(float);
+        memmove(bytes, bytes + count * sizeof(float), carried);
+    }
+    return carried;
+}
+
+/**
+ * @brief Stream text, carrying a token split by a read to the next one
+ * @return Tokens that were not numbers
+ */
+unsigned long long readText(FILE* in, ResultWriter* writer) {
+    std::vector<char> text(IO_BLOCK + 1);
+    float batch[BATCH];
+    size_t pending = 0;
+    size_t carried = 0;
+    unsigned long long skipped = 0;
+    bool done = false;
+    while (!done) {
+        size_t got = fread(&text[carried], 1, IO_BLOCK - carried, in);
+        size_t available = carried + got;
+        done = got == 0;
+        if (done) {
+            text[available++] = '\n';   // Terminate the last token
+        }
+        const char* p = &text[0];
+        const char* end = p + available;
+        
+        // Only tokens followed by a separator are complete
+        const char* last = end;
+        while (last > p && !isSeparator(last[-1])) {
+            last--;
+        }
+        if (last == p && available == IO_BLOCK) {
+            skipped++;                  // One token fills the block: not a number
+            p = last = end;
+        }
+        while (p < last) {
+            if (isSeparator(*p)) {
+                p++;
+                continue;
+            }
+            if (parseToken(p, &p, &batch[pending])) {
+                if (++pending == BATCH) {
+                    writer->analyze(batch, pending);
+                    pending = 0;
+                }
+            } else {
+                skipped++;
+            }
+        }
+        carried = (size_t)(end - last);
+        memmove(&text[0], last, carried);
+    }
+    writer->analyze(batch, pending);
+    return skipped;
+}
+
+/**
+ * @brief Chemistry by display name, any case ("lipo", "LiFePO4")
+ */
+bool chemistryByName(const char* text, ChemistryType* type) {
+    for (int candidate = 0; candidate < CHEMISTRY_COUNT; candidate++) {
+        const char* name = ChemistrySelector::name((ChemistryType)candidate);
+        size_t i = 0;
+        while (name[i] != '\0' && tolower((unsigned char)name[i]) == tolower((unsigned char)text[i])) {
+            i++;
+        }
+        if (name[i] == '\0' && text[i] == '\0') {
+            *type = (ChemistryType)candidate;
+            return true;
+        }
+    }
+    return false;
+}
+
+bool parseOptions(int argc, char* argv[], AnalyzeOptions* options) {
+    options->input = INPUT_TEXT;
+    options->output = OUTPUT_CSV;
+    options->chemistry = CHEMISTRY_LIPO;
+    options->inputPath = nullptr;
+    options->outputPath = nullptr;
+    for (int i = 0; i < argc; i++) {
+        const char* arg = argv[i];
+        const char* value = i + 1 < argc ? argv[i + 1] : nullptr;
+        if (strcmp(arg, "--input") == 0 && value) {
+            if (strcmp(value, "text") == 0) options->input = INPUT_TEXT;
+            else if (strcmp(value, "f32") == 0) options->input = INPUT_F32;
+            else return false;
+            i++;
+        } else if (strcmp(arg, "--output") == 0 && value) {
+            if (strcmp(value, "csv") == 0) options->output = OUTPUT_CSV;
+            else if (strcmp(value, "bin") == 0) options->output = OUTPUT_BINARY;
+            else return false;
+            i++;
+        } else if (strcmp(arg, "--chemistry") == 0 && value) {
+            if (!chemistryByName(value, &options->chemistry)) {
+                return false;
+            }
+            i++;
+        } else if (strcmp(arg, "--out") == 0 && value) {
+            options->outputPath = value;
+            i++;
+        } else if (arg[0] == '-' && arg[1] != '\0') {
+            return false;
+        } else {
+            options->inputPath = arg;
+        }
+    }
+    return true;
+}
+
+} // namespace
+
+int runAnalyzeMode(int argc, char* argv[]) {
+    AnalyzeOptions options;
+    if (!parseOptions(argc, argv, &options)) {
+        fprintf(stderr, "Usage: lipo_simulator analyze [--input text|f32] [--output csv|bin]\n"
+                        "                              [--chemistry lipo|lihv|liion|lifepo4] [--out file] [file|-]\n");
+        return 1;
+    }
+    
+    bool fromStdin = !options.inputPath || strcmp(options.inputPath, "-") == 0;
+    bool toStdout = !options.outputPath || strcmp(options.outputPath, "-") == 0;
+    FILE* in = fromStdin ? stdin : fopen(options.inputPath, "rb");
+    if (!in) {
+        fprintf(stderr, "Cannot open %s\n", options.inputPath);
+        return 1;
+    }
+    FILE* out = toStdout ? stdout : fopen(options.outputPath, "wb");
+    if (!out) {
+        fprintf(stderr, "Cannot create %s\n", options.outputPath);
+        if (!fromStdin) fclose(in);
+        return 1;
+    }
+#ifdef _WIN32
+    // No newline translation on the standard streams
+    if (fromStdin) _setmode(_fileno(stdin), _O_BINARY);
+    if (toStdout) _setmode(_fileno(stdout), _O_BINARY);
+#endif
+    // Reads and writes are already block-sized
+    setvbuf(in, nullptr, _IONBF, 0);
+    setvbuf(out, nullptr, _IONBF, 0);
+    
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    ResultWriter writer(out, options.output, options.chemistry);
+    unsigned long long skipped = options.input == INPUT_TEXT ? readText(in, &writer) : readFloats(in, &writer);
+    writer.flush();
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    bool failed = writer.hasFailed() || ferror(in);
+    
+    if (!fromStdin) fclose(in);
+    if (!toStdout && fclose(out) != 0) failed = true;
+    
+    unsigned long long values = writer.getValues();
+    fprintf(stderr, "%llu values (%s), %llu %s skipped, %.3f s, %.1f M values/s\n", values,
+            ChemistrySelector::name(options.chemistry), skipped,
+            options.input == INPUT_TEXT ? "tokens" : "trailing bytes", seconds,
+            seconds > 0.0 ? values / seconds / 1e6 : 0.0);
+    if (failed) {
+        fprintf(stderr, "I/O error\n");
+        return 1;
+    }
+    return 0;
+}
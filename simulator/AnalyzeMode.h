@@ -0,0 +1,37 @@
+#ifndef ANALYZE_MODE_H
+#define ANALYZE_MODE_H
+
+#include <cstdint>
+
+/**
+ * @brief One analyzed reading in the binary output (--output bin)
+ *
+ * Little-endian on every host this runs on; 12 bytes, no padding.
+ */
+struct AnalyzeRecord {
+    float voltage;              // Input total voltage
+    float averageCellVoltage;   // 0 when invalid
+    uint8_t cellCount;          // 0 when invalid
+    uint8_t chargePercentage;
+    uint8_t isValid;
+    uint8_t reserved;
+};
+
+/**
+ * @brief Non-interactive analysis of a stream of voltages
+ *
+ *   lipo_simulator analyze [--input text|f32] [--output csv|bin]
+ *                          [--chemistry lipo|lihv|liion|lifepo4] [--out file] [file|-]
+ *
+ * Reads text (numbers separated by whitespace, commas or semicolons) or raw
+ * native float32 from a file or stdin in large blocks, runs every value
+ * through the firmware's analyzer (ChemistrySelector) and writes one CSV line
+ * or AnalyzeRecord per value with buffered output. Counts and values/s go to
+ * stderr so stdout can carry the results.
+ * @param argc Arguments after the mode name
+ * @param argv Arguments after the mode name
+ * @return Process exit code
+ */
+int runAnalyzeMode(int argc, char* argv[]);
+
+#endif // ANALYZE_MODE_H
@@ -0,0 +1,285 @@
+#include "PackModel.h"
+#include <algorithm>
+#include <cmath>
+#include <thread>
+
+namespace {
+
+// Packs stepped together for all steps before moving on (keeps a tile's planes in L2)
+const int PACK_TILE = 128;
+
+// LiPo open-circuit voltage at 0%, 10%, ... 100% SOC
+const int OCV_POINTS = 11;
+const float OCV_TABLE[OCV_POINTS] = {
+    3.00f, 3.60f, 3.69f, 3.73f, 3.77f, 3.80f, 3.84f, 3.90f, 3.98f, 4.08f, 4.20f
+};
+const float OCV_SEGMENT = 1.0f / (OCV_POINTS - 1);
+
+/**
+ * @brief Clamp with plain selects, which the vectorizer turns into SIMD min/max
+ */
+inline float clampValue(float value, float low, float high) {
+    value = value < low ? low : value;
+    return value > high ? high : value;
+}
+
+/**
+ * @brief Rise of the OCV along table segment k at a state of charge
+ */
+inline float ocvRamp(float soc, int k) {
+    float slope = (OCV_TABLE[k + 1] - OCV_TABLE[k]) * (OCV_POINTS - 1);
+    return slope * clampValue(soc - k * OCV_SEGMENT, 0.0f, OCV_SEGMENT);
+}
+
+/**
+ * @brief OCV as a sum of clamped ramps, one per table segment
+ *
+ * Equal to interpolating the table, but with no index or gather, so it
+ * vectorizes inside the step loop. Written out because the vectorizer runs
+ * before loops are unrolled.
+ */
+inline float ocvAt(float soc) {
+    return OCV_TABLE[0] + ocvRamp(soc, 0) + ocvRamp(soc, 1) + ocvRamp(soc, 2) + ocvRamp(soc, 3) +
+           ocvRamp(soc, 4) + ocvRamp(soc, 5) + ocvRamp(soc, 6) + ocvRamp(soc, 7) + ocvRamp(soc, 8) +
+           ocvRamp(soc, 9);
+}
+
+/**
+ * @brief Step one cell position of packs [0, count)
+ *
+ * The planes never overlap; saying so (__restrict) is what lets the compiler
+ * vectorize a loop over this many arrays without runtime overlap checks. It
+ * also needs -fno-trapping-math to turn the selects into SIMD min/max (see
+ * CMakeLists.txt). SOC is only clamped at empty: clamping at full as well
+ * lets GCC split the loop on the constant and give up, and charging past
+ * full already leaves the OCV at its 100% value.
+ */
+void stepPlane(int count, const float* __restrict amps, float* __restrict soc, const float* __restrict socPerAmp,
+               const float* __restrict resistance, float* __restrict polarization,
+               const float* __restrict gain, const float* __restrict decay, const float* __restrict active,
+               float* __restrict cellVoltage, float* __restrict total, float* __restrict lowest,
+               float* __restrict highest) {
+    for (int k = 0; k < count; k++) {
+        float i = amps[k];
+        float charge = std::max(soc[k] - i * socPerAmp[k], 0.0f);
+        soc[k] = charge;
+        float branch = polarization[k] * decay[k] + i * gain[k];
+        polarization[k] = branch;
+        float v = (ocvAt(charge) - i * resistance[k] - branch) * active[k];
+        float low = v + (1.0f - active[k]) * 1e9f;     // Padding cells never set the minimum
+        cellVoltage[k] = v;
+        total[k] += v;
+        lowest[k] = low < lowest[k] ? low : lowest[k];
+        highest[k] = v > highest[k] ? v : highest[k];
+    }
+}
+
+/**
+ * @brief Next value in [-1, 1) from a small LCG (the spread must be reproducible)
+ */
+float nextSpread(uint32_t* state) {
+    *state = *state * 1664525u + 1013904223u;
+    return (float)(*state >> 8) / 8388608.0f - 1.0f;
+}
+
+} // namespace
+
+float packCellOcv(float soc) {
+    return ocvAt(std::min(std::max(soc, 0.0f), 1.0f));
+}
+
+PackModel::PackModel(int maxPacks, float stepSeconds)
+    : maxPacks(maxPacks),
+      stride((maxPacks + PACK_BLOCK - 1) / PACK_BLOCK * PACK_BLOCK),
+      packCount(0),
+      planeCount(0),
+      stepSeconds(stepSeconds),
+      stepIndex(0) {
+    size_t cells = (size_t)stride * PACK_MAX_CELLS;
+    soc.assign(cells, 0.0f);
+    socPerAmp.assign(cells, 0.0f);
+    resistance.assign(cells, 0.0f);
+    polarization.assign(cells, 0.0f);
+    polarizationGain.assign(cells, 0.0f);
+    polarizationDecay.assign(cells, 0.0f);
+    active.assign(cells, 0.0f);
+    cellVoltage.assign(cells, 0.0f);
+    
+    blockCells.assign(stride / PACK_BLOCK, 0);
+    cellCounts.assign(stride, 0);
+    baseAmps.assign(stride, 0.0f);
+    pulseAmps.assign(stride, 0.0f);
+    periodSeconds.assign(stride, 1.0f);
+    pulseSeconds.assign(stride, 0.0f);
+    phaseSeconds.assign(stride, 0.0f);
+    cutoffVolts.assign(stride, 0.0f);
+    connected.assign(stride, 0.0f);
+    current.assign(stride, 0.0f);
+    packVoltage.assign(stride, 0.0f);
+    minCell.assign(stride, 0.0f);
+    maxCell.assign(stride, 0.0f);
+}
+
+int PackModel::addPack(const PackSpec& spec) {
+    if (packCount >= maxPacks || spec.cells < 1 || spec.cells > PACK_MAX_CELLS || spec.capacityAh <= 0.0f) {
+        return -1;
+    }
+    int pack = packCount++;
+    uint32_t random = spec.seed;
+    float decay = spec.polarizationSeconds > 0.0f ? expf(-stepSeconds / spec.polarizationSeconds) : 0.0f;
+    
+    float total = 0.0f;
+    float lowest = 1e9f;
+    float highest = 0.0f;
+    for (int cell = 0; cell < spec.cells; cell++) {
+        size_t i = (size_t)cell * stride + pack;
+        float capacity = spec.capacityAh * (1.0f + spec.imbalance * nextSpread(&random));
+        float initial = spec.initialSoc + spec.imbalance * 0.5f * nextSpread(&random);
+        soc[i] = std::min(std::max(initial, 0.0f), 1.0f);
+        socPerAmp[i] = stepSeconds / 3600.0f / capacity;
+        resistance[i] = spec.resistanceOhms * (1.0f + spec.imbalance * 2.0f * nextSpread(&random));
+        polarization[i] = 0.0f;
+        polarizationGain[i] = spec.polarizationOhms * (1.0f - decay);
+        polarizationDecay[i] = decay;
+        active[i] = 1.0f;
+        cellVoltage[i] = ocvAt(soc[i]);
+        total += cellVoltage[i];
+        lowest = std::min(lowest, cellVoltage[i]);
+        highest = std::max(highest, cellVoltage[i]);
+    }
+    
+    planeCount = std::max(planeCount, spec.cells);
+    blockCells[pack / PACK_BLOCK] = std::max(blockCells[pack / PACK_BLOCK], spec.cells);
+    cellCounts[pack] = spec.cells;
+    baseAmps[pack] = spec.load.baseAmps;
+    bool pulsed = spec.load.periodSeconds > 0.0f;
+    pulseAmps[pack] = pulsed ? spec.load.pulseAmps : 0.0f;
+    periodSeconds[pack] = pulsed ? spec.load.periodSeconds : 1.0f;
+    pulseSeconds[pack] = spec.load.pulseSeconds;
+    phaseSeconds[pack] = spec.load.phaseSeconds;
+    cutoffVolts[pack] = spec.load.cutoffVolts;
+    connected[pack] = 1.0f;
+    current[pack] = 0.0f;
+    packVoltage[pack] = total;
+    minCell[pack] = lowest;
+    maxCell[pack] = highest;
+    return pack;
+}
+
+void PackModel::stepRange(int begin, int end, long index) {
+    float time = (float)((double)index * stepSeconds);
+    for (int p = begin; p < end; p++) {
+        float cycle = time + phaseSeconds[p];
+        cycle -= floorf(cycle / periodSeconds[p]) * periodSeconds[p];
+        float pulse = cycle < pulseSeconds[p] ? pulseAmps[p] : 0.0f;
+        current[p] = (baseAmps[p] + pulse) * connected[p];
+        packVoltage[p] = 0.0f;
+        minCell[p] = 1e9f;
+        maxCell[p] = 0.0f;
+    }
+    
+    float* total = packVoltage.data() + begin;
+    float* lowest = minCell.data() + begin;
+    float* highest = maxCell.data() + begin;
+    for (int cell = 0; cell < planeCount; cell++) {
+        // Step the runs of blocks that have this cell; blocks of smaller packs skip the plane
+        int run = begin;
+        while (run < end) {
+            while (run < end && blockCells[run / PACK_BLOCK] <= cell) {
+                run = (run / PACK_BLOCK + 1) * PACK_BLOCK;
+            }
+            int runEnd = run;
+            while (runEnd < end && blockCells[runEnd / PACK_BLOCK] > cell) {
+                runEnd = (runEnd / PACK_BLOCK + 1) * PACK_BLOCK;
+            }
+            runEnd = std::min(runEnd, end);
+            if (runEnd > run) {
+                size_t plane = (size_t)cell * stride + run;
+                int offset = run - begin;
+                stepPlane(runEnd - run, current.data() + run, soc.data() + plane, socPerAmp.data() + plane,
+                          resistance.data() + plane, polarization.data() + plane, polarizationGain.data() + plane,
+                          polarizationDecay.data() + plane, active.data() + plane, cellVoltage.data() + plane,
+                          total + offset, lowest + offset, highest + offset);
+            }
+            run = runEnd;
+        }
+    }
+    
+    for (int p = begin; p < end; p++) {
+        connected[p] = minCell[p] >= cutoffVolts[p] ? connected[p] : 0.0f;
+    }
+}
+
+void PackModel::runRange(int begin, int end, int steps) {
+    for (int tile = begin; tile < end; tile += PACK_TILE) {
+        int tileEnd = std::min(tile + PACK_TILE, end);
+        for (int n = 0; n < steps; n++) {
+            stepRange(tile, tileEnd, stepIndex + n);
+        }
+    }
+}
+
+void PackModel::step() {
+    stepRange(0, packCount, stepIndex);
+    stepIndex++;
+}
+
+void PackModel::run(int steps, int threads) {
+    int blocks = (packCount + PACK_BLOCK - 1) / PACK_BLOCK;
+    threads = std::max(1, std::min(threads, blocks));
+    if (threads == 1) {
+        runRange(0, packCount, steps);
+    } else {
+        // Ranges on PACK_BLOCK boundaries so threads never share a cache line
+        std::vector<std::thread> workers;
+        for (int t = 0; t < threads; t++) {
+            int begin = std::min(blocks * t / threads * PACK_BLOCK, packCount);
+            int end = std::min(blocks * (t + 1) / threads * PACK_BLOCK, packCount);
+            workers.push_back(std::thread(&PackModel::runRange, this, begin, end, steps));
+        }
+        for (size_t t = 0; t < workers.size(); t++) {
+            workers[t].join();
+        }
+    }
+    stepIndex += steps;
+}
+
+int PackModel::getPackCount() const {
+    return packCount;
+}
+
+int PackModel::getCellCount(int pack) const {
+    return cellCounts[pack];
+}
+
+float PackModel::getTime() const {
+    return (float)((double)stepIndex * stepSeconds);
+}
+
+float PackModel::getPackVoltage(int pack) const {
+    return packVoltage[pack];
+}
+
+float PackModel::getCellVoltage(int pack, int cell) const {
+    return cellVoltage[(size_t)cell * stride + pack];
+}
+
+float PackModel::getCellSoc(int pack, int cell) const {
+    return std::min(soc[(size_t)cell * stride + pack], 1.0f);
+}
+
+float PackModel::getMinCellVoltage(int pack) const {
+    return minCell[pack];
+}
+
+float PackModel::getMaxCellVoltage(int pack) const {
+    return maxCell[pack];
+}
+
+float PackModel::getCurrent(int pack) const {
+    return current[pack];
+}
+
+bool PackModel::isLoadConnected(int pack) const {
+    return connected[pack] != 0.0f;
+}
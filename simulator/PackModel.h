@@ -0,0 +1,163 @@
+#ifndef PACK_MODEL_H
+#define PACK_MODEL_H
+
+#include <cstdint>
+#include <vector>
+
+// Most cells a modelled pack can have (planes are allocated for all of them)
+#define PACK_MAX_CELLS 6
+
+// Packs per alignment block; planes are padded to a multiple of this
+#define PACK_BLOCK 16
+
+/**
+ * @brief Current drawn from a pack over time
+ *
+ * A base current plus an optional pulse: pulseAmps is added for pulseSeconds
+ * at the start of every periodSeconds (shifted by phaseSeconds). Positive is
+ * discharge, negative is charge. The load is disconnected for good once any
+ * cell falls below cutoffVolts under load, like an ESC's low-voltage cutoff.
+ */
+struct LoadProfile {
+    float baseAmps;
+    float pulseAmps;
+    float periodSeconds;        // 0 = no pulses
+    float pulseSeconds;
+    float phaseSeconds;
+    float cutoffVolts;          // Per cell; 0 = never disconnect
+    
+    LoadProfile() : baseAmps(0.0f), pulseAmps(0.0f), periodSeconds(0.0f), pulseSeconds(0.0f),
+                    phaseSeconds(0.0f), cutoffVolts(3.0f) {}
+};
+
+/**
+ * @brief Description of one pack for PackModel::addPack()
+ *
+ * The imbalance spreads each cell's capacity, initial SOC and resistance
+ * around the nominal values (deterministically from the seed), so a pack
+ * with imbalance 0 has identical cells.
+ */
+struct PackSpec {
+    int cells;
+    float capacityAh;           // Per cell
+    float resistanceOhms;       // Ohmic resistance per cell
+    float polarizationOhms;     // RC branch resistance per cell
+    float polarizationSeconds;  // RC branch time constant
+    float initialSoc;           // 0..1
+    float imbalance;            // Relative spread, e.g. 0.05 for +/-5% capacity
+    uint32_t seed;
+    LoadProfile load;
+    
+    PackSpec() : cells(3), capacityAh(2.2f), resistanceOhms(0.008f), polarizationOhms(0.006f),
+                 polarizationSeconds(30.0f), initialSoc(1.0f), imbalance(0.0f), seed(1) {}
+};
+
+/**
+ * @brief Open-circuit voltage of a LiPo cell at a state of charge
+ * @param soc State of charge (clamped to 0..1)
+ * @return Volts, piecewise linear through the table in PackModel.cpp
+ */
+float packCellOcv(float soc);
+
+/**
+ * @brief Equivalent-circuit model of many series packs, stepped together
+ *
+ * Each cell is an OCV source (piecewise linear in SOC) behind an ohmic
+ * resistance and one RC polarization branch, so the pack sags under load
+ * and recovers at rest. All cells of a pack carry the pack current.
+ *
+ * State is stored as structure-of-arrays: one plane per cell position, each
+ * holding that cell of every pack contiguously ([cell][pack]). A step runs
+ * the same branch-free arithmetic down each plane, which the compiler turns
+ * into SIMD loops. Packs with fewer cells mask the unused positions instead
+ * of branching, and a block of PACK_BLOCK packs skips the planes none of
+ * them has, so add packs grouped by cell count. Packs are independent, so
+ * run() splits them into ranges across threads with no synchronisation
+ * between steps.
+ */
+class PackModel {
+public:
+    /**
+     * @brief Allocate storage
+     * @param maxPacks Packs that can be added
+     * @param stepSeconds Time step
+     */
+    PackModel(int maxPacks, float stepSeconds);
+    
+    /**
+     * @brief Add a pack
+     * @return Pack index, or -1 if full or the spec is invalid
+     */
+    int addPack(const PackSpec& spec);
+    
+    /**
+     * @brief Advance every pack by one step on the calling thread
+     */
+    void step();
+    
+    /**
+     * @brief Advance every pack by a number of steps
+     * @param steps Steps
+     * @param threads Worker threads (1 runs on the calling thread)
+     *
+     * Each thread owns a contiguous range of packs and runs all steps over
+     * it in cache-sized tiles, so the threads never wait for each other.
+     */
+    void run(int steps, int threads);
+    
+    int getPackCount() const;
+    int getCellCount(int pack) const;
+    float getTime() const;
+    
+    float getPackVoltage(int pack) const;
+    float getCellVoltage(int pack, int cell) const;
+    float getCellSoc(int pack, int cell) const;
+    float getMinCellVoltage(int pack) const;
+    float getMaxCellVoltage(int pack) const;
+    float getCurrent(int pack) const;
+    
+    /**
+     * @brief Whether the load is still connected (no cell has hit the cutoff)
+     */
+    bool isLoadConnected(int pack) const;
+
+private:
+    int maxPacks;
+    int stride;                 // Plane length (maxPacks rounded up to PACK_BLOCK)
+    int packCount;
+    int planeCount;             // Cell positions in use (most cells of any pack)
+    float stepSeconds;
+    long stepIndex;
+    
+    // Per cell, [cell * stride + pack]
+    std::vector<float> soc;
+    std::vector<float> socPerAmp;       // SOC lost per amp per step (dt / 3600 / Ah)
+    std::vector<float> resistance;
+    std::vector<float> polarization;    // RC branch voltage
+    std::vector<float> polarizationGain;    // R1 * (1 - decay)
+    std::vector<float> polarizationDecay;   // exp(-dt / tau)
+    std::vector<float> active;          // 1 for a real cell, 0 for padding
+    std::vector<float> cellVoltage;
+    
+    // Per PACK_BLOCK packs: most cells of any pack in the block
+    std::vector<int> blockCells;
+    
+    // Per pack
+    std::vector<int> cellCounts;
+    std::vector<float> baseAmps;
+    std::vector<float> pulseAmps;
+    std::vector<float> periodSeconds;
+    std::vector<float> pulseSeconds;
+    std::vector<float> phaseSeconds;
+    std::vector<float> cutoffVolts;
+    std::vector<float> connected;       // 1 while the load is connected
+    std::vector<float> current;
+    std::vector<float> packVoltage;
+    std::vector<float> minCell;
+    std::vector<float> maxCell;
+    
+    void stepRange(int begin, int end, long index);
+    void runRange(int begin, int end, int steps);
+};
+
+#endif // PACK_MODEL_H
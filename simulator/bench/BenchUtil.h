@@ -0,0 +1,39 @@
+#ifndef BENCH_UTIL_H
+#define BENCH_UTIL_H
+
+#include <chrono>
+#include <cstdio>
+
+/**
+ * @brief Minimal timing helpers shared by the host benchmarks
+ */
+namespace bench {
+
+typedef std::chrono::steady_clock Clock;
+
+/**
+ * @brief Keep a value alive so the optimizer cannot drop the work producing it
+ */
+template <class T>
+inline void doNotOptimize(const T& value) {
+    asm volatile("" : : "r,m"(value) : "memory");
+}
+
+/**
+ * @brief Seconds elapsed since a start point
+ */
+inline double secondsSince(Clock::time_point start) {
+    return std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+/**
+ * @brief Print one result row: name, ns/op and ops/s
+ */
+inline void report(const char* name, double seconds, double operations) {
+    double nsPerOp = seconds * 1e9 / operations;
+    std::printf("%-36s %10.2f ns/op %14.0f ops/s\n", name, nsPerOp, operations / seconds);
+}
+
+} // namespace bench
+
+#endif // BENCH_UTIL_H
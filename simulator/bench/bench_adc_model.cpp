@@ -0,0 +1,236 @@
+/**
+ * @brief Benchmark: AdcModel batch generation vs. per-sample rand() noise
+ *
+ *   bench_adc_model [--samples 4000000] [--threads N]
+ *
+ * The baseline is the simulator's original conversion: uniform +/-2 counts
+ * from the global rand(), one value per call. Then AdcModel one value at a
+ * time, the batch call for the default and the ESP32-C3 front end, and the
+ * batch split across threads, next to a plain read + write of the same bytes
+ * as the memory bandwidth ceiling.
+ *
+ * Also checks the model: batch, per-sample, seeked and threaded generation
+ * give identical codes; the ideal front end rounds exactly; the white noise
+ * has the configured deviation and the 1/f noise survives averaging. Exits
+ * non-zero if a check fails.
+ */
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <thread>
+#include <vector>
+#include "AdcModel.h"
+#include "BenchUtil.h"
+
+namespace {
+
+const float DIVIDER_RATIO = 7.8f;
+const float REFERENCE_VOLTAGE = 3.3f;
+const int ADC_RESOLUTION = 4095;
+
+/**
+ * @brief Reference: the simulator's original simulateADCReading() as a code
+ */
+int legacyReading(float actualVoltage) {
+    int adcValue = (int)((actualVoltage / DIVIDER_RATIO / REFERENCE_VOLTAGE) * ADC_RESOLUTION);
+    adcValue += (rand() % 5) - 2;
+    if (adcValue < 0) adcValue = 0;
+    if (adcValue > ADC_RESOLUTION) adcValue = ADC_RESOLUTION;
+    return adcValue;
+}
+
+/**
+ * @brief Pack voltages sweeping 1S empty to 6S full
+ */
+void makeSweep(std::vector<float>* volts) {
+    for (size_t i = 0; i < volts->size(); i++) {
+        (*volts)[i] = 3.0f + 22.2f * (float)(i % 65536) / 65536.0f;
+    }
+}
+
+/**
+ * @brief Mean and standard deviation of codes
+ */
+void moments(const uint16_t* raw, size_t count, double* mean, double* sigma) {
+    double sum = 0.0, squares = 0.0;
+    for (size_t i = 0; i < count; i++) {
+        sum += raw[i];
+        squares += (double)raw[i] * raw[i];
+    }
+    *mean = sum / count;
+    *sigma = std::sqrt(std::max(squares / count - *mean * *mean, 0.0));
+}
+
+/**
+ * @brief Standard deviation of the means of consecutive blocks
+ */
+double blockMeanSigma(const uint16_t* raw, size_t count, size_t block) {
+    double sum = 0.0, squares = 0.0;
+    size_t blocks = 0;
+    for (size_t start = 0; start + block <= count; start += block) {
+        double mean = 0.0;
+        for (size_t i = start; i < start + block; i++) {
+            mean += raw[i];
+        }
+        mean /= block;
+        sum += mean;
+        squares += mean * mean;
+        blocks++;
+    }
+    double mean = sum / blocks;
+    return std::sqrt(std::max(squares / blocks - mean * mean, 0.0));
+}
+
+void fillRange(AdcModel model, const float* volts, uint16_t* raw, size_t first, size_t count) {
+    model.seek(first);
+    model.sampleBatch(volts + first, raw + first, count);
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    size_t samples = 4000000;
+    int maxThreads = (int)std::thread::hardware_concurrency();
+    for (int i = 1; i + 1 < argc; i += 2) {
+        if (strcmp(argv[i], "--samples") == 0) {
+            samples = (size_t)atol(argv[i + 1]);
+        } else if (strcmp(argv[i], "--threads") == 0) {
+            maxThreads = atoi(argv[i + 1]);
+        }
+    }
+    maxThreads = std::max(maxThreads, 1);
+    
+    std::vector<float> volts(samples);
+    makeSweep(&volts);
+    std::vector<uint16_t> raw(samples);
+    std::vector<uint16_t> check(samples);
+    bool passed = true;
+    
+    printf("=== ADC front-end model: %zu samples, 3.0-25.2 V sweep ===\n\n", samples);
+    
+    // Baseline: rand() per value
+    bench::Clock::time_point start = bench::Clock::now();
+    for (size_t i = 0; i < samples; i++) {
+        raw[i] = (uint16_t)legacyReading(volts[i]);
+    }
+    bench::report("rand() +/-2 counts, per value", bench::secondsSince(start), (double)samples);
+    
+    AdcModel model(AdcModelConfig(), 42);
+    start = bench::Clock::now();
+    for (size_t i = 0; i < samples; i++) {
+        raw[i] = model.sample(volts[i]);
+    }
+    bench::report("AdcModel::sample (default)", bench::secondsSince(start), (double)samples);
+    
+    model.seek(0);
+    start = bench::Clock::now();
+    model.sampleBatch(volts.data(), check.data(), samples);
+    double batchSeconds = bench::secondsSince(start);
+    bench::report("AdcModel::sampleBatch (default)", batchSeconds, (double)samples);
+    size_t mismatches = 0;
+    for (size_t i = 0; i < samples; i++) {
+        mismatches += raw[i] != check[i] ? 1 : 0;
+    }
+    
+    AdcModel esp32(AdcModelConfig::esp32c3(), 42);
+    start = bench::Clock::now();
+    esp32.sampleBatch(volts.data(), raw.data(), samples);
+    bench::report("AdcModel::sampleBatch (ESP32-C3)", bench::secondsSince(start), (double)samples);
+    
+    // Bandwidth ceiling: read the floats, write the codes
+    start = bench::Clock::now();
+    for (size_t i = 0; i < samples; i++) {
+        raw[i] = (uint16_t)volts[i];
+    }
+    bench::doNotOptimize(raw[samples / 2]);
+    double copySeconds = bench::secondsSince(start);
+    bench::report("read float + write uint16 (ceiling)", copySeconds, (double)samples);
+    printf("batch at %.1f GB/s, %.0f%% of the ceiling's %.1f GB/s\n\n", samples * 6.0 / batchSeconds / 1e9,
+           copySeconds / batchSeconds * 100.0, samples * 6.0 / copySeconds / 1e9);
+    
+    // Threads: copies of one model seeked to disjoint ranges
+    std::vector<int> threadCounts;
+    for (int t = 1; t < maxThreads; t *= 2) {
+        threadCounts.push_back(t);
+    }
+    threadCounts.push_back(maxThreads);
+    double singleSeconds = 0.0;
+    printf("%-8s %16s %10s\n", "threads", "samples/s", "speedup");
+    for (size_t k = 0; k < threadCounts.size(); k++) {
+        int threads = threadCounts[k];
+        std::fill(raw.begin(), raw.end(), 0);
+        start = bench::Clock::now();
+        std::vector<std::thread> workers;
+        for (int t = 0; t < threads; t++) {
+            size_t first = samples * t / threads;
+            size_t last = samples * (t + 1) / threads;
+            workers.push_back(std::thread(fillRange, model, volts.data(), raw.data(), first, last - first));
+        }
+        for (size_t t = 0; t < workers.size(); t++) {
+            workers[t].join();
+        }
+        double seconds = bench::secondsSince(start);
+        if (k == 0) {
+            singleSeconds = seconds;
+        }
+        printf("%-8d %16.0f %9.2fx\n", threads, samples / seconds, singleSeconds / seconds);
+        for (size_t i = 0; i < samples; i++) {
+            mismatches += raw[i] != check[i] ? 1 : 0;
+        }
+    }
+    printf("(%u hardware threads)\n\n", std::thread::hardware_concurrency());
+    printf("batch, per-sample and threaded codes: %zu mismatches\n", mismatches);
+    passed = passed && mismatches == 0;
+    
+    // Ideal front end: plain rounding of the nominal scale
+    AdcModel ideal(AdcModelConfig::ideal(), 1);
+    ideal.sampleBatch(volts.data(), raw.data(), samples);
+    size_t roundingErrors = 0;
+    for (size_t i = 0; i < samples; i++) {
+        float code = volts[i] / (78.0f / 10.0f) / 3.3f * 4095.0f;
+        roundingErrors += std::fabs(raw[i] - code) > 0.5f + 1e-3f ? 1 : 0;
+    }
+    printf("ideal front end: %zu codes off by more than rounding\n", roundingErrors);
+    passed = passed && roundingErrors == 0;
+    
+    // Noise statistics at a constant 11.1 V
+    size_t noiseSamples = std::min(samples, (size_t)1 << 20);
+    double mean, sigma;
+    AdcModel white(AdcModelConfig(), 7);
+    white.sampleConstant(11.1f, raw.data(), noiseSamples);
+    moments(raw.data(), noiseSamples, &mean, &sigma);
+    double whiteBlocks = blockMeanSigma(raw.data(), noiseSamples, 1024);
+    float expectedMean = white.transfer(11.1f);
+    printf("white (1.4 counts): mean %.2f (expected %.2f), sigma %.3f, sigma of 1024-sample means %.3f\n",
+           mean, expectedMean, sigma, whiteBlocks);
+    // Rounding adds 1/12 count^2
+    double expectedSigma = std::sqrt(1.4 * 1.4 + 1.0 / 12.0);
+    passed = passed && std::fabs(mean - expectedMean) < 0.6 && std::fabs(sigma - expectedSigma) < 0.05 * expectedSigma;
+    
+    AdcModelConfig flickerOnly = AdcModelConfig::ideal();
+    flickerOnly.flickerCounts = 1.4f;
+    AdcModel flicker(flickerOnly, 7);
+    flicker.sampleConstant(11.1f, raw.data(), noiseSamples);
+    moments(raw.data(), noiseSamples, &mean, &sigma);
+    double flickerBlocks = blockMeanSigma(raw.data(), noiseSamples, 1024);
+    printf("1/f   (1.4 counts): sigma %.3f, sigma of 1024-sample means %.3f (%.0fx white)\n", sigma, flickerBlocks,
+           flickerBlocks / whiteBlocks);
+    passed = passed && flickerBlocks > 5.0 * whiteBlocks;
+    
+    // Uncalibrated ESP32-C3 error across the range (the calibration table's job)
+    AdcModel unit(AdcModelConfig::esp32c3(), 3);
+    printf("\nESP32-C3 unit: divider %.3f (nominal 7.800), Vref %.3f V\n", unit.getDividerRatio(), unit.getVref());
+    printf("%8s %10s %10s\n", "battery", "reads", "error");
+    const float checkpoints[] = { 3.7f, 7.4f, 11.1f, 14.8f, 18.5f, 22.2f, 25.2f };
+    for (size_t i = 0; i < sizeof(checkpoints) / sizeof(checkpoints[0]); i++) {
+        unit.sampleConstant(checkpoints[i], raw.data(), 4096);
+        moments(raw.data(), 4096, &mean, &sigma);
+        float reads = unit.toVolts((uint16_t)(mean + 0.5));
+        printf("%7.2fV %9.3fV %+9.0fmV\n", checkpoints[i], reads, (reads - checkpoints[i]) * 1000.0f);
+    }
+    
+    printf("\n%s\n", passed ? "model checks passed" : "MODEL CHECKS FAILED");
+    return passed ? 0 : 1;
+}
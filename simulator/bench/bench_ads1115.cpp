@@ -0,0 +1,141 @@
+/**
+ * @brief Benchmark: ADS1115 sampling rate and I2C bus utilization
+ *
+ * Runs the production Ads1115 driver against the simulated chip and bus from
+ * the unit tests for one simulated second per configuration, and compares
+ * it with a pointer write before each read and with single-shot conversions
+ * (start, poll the ready bit, read). Also times poll() on the host.
+ */
+#include <cstdio>
+#include "BenchUtil.h"
+#include "Ads1115.h"
+#include "../../test/test_ads1115/MockAds1115.h"
+
+namespace {
+
+// Time the main loop spends between polls (us)
+const double POLL_INTERVAL_US = 50.0;
+
+struct Result {
+    long samples;
+    double utilization;
+};
+
+void configure(MockAds1115& bus, int dataRate, bool continuous) {
+    uint16_t config = Ads1115::configValue(ADS1115_CHANNEL, ADS1115_FULL_SCALE_V, dataRate);
+    if (!continuous) config |= 0x0100;
+    uint8_t write[3] = { 0x01, (uint8_t)(config >> 8), (uint8_t)(config & 0xFF) };
+    bus.write(bus.address, write, 3);
+}
+
+/**
+ * @brief Continuous mode, pointer left on the conversion register (the driver)
+ */
+Result runDriver(int dataRate, unsigned long clockHz) {
+    MockAds1115 bus(ADS1115_ADDRESS, clockHz);
+    Ads1115 adc(bus);
+    adc.begin();
+    configure(bus, dataRate, true);   // Rate under test instead of ADS1115_DATA_RATE
+    
+    // The driver paces by ADS1115_DATA_RATE; scale time so its period matches dataRate
+    double scale = (double)dataRate / Ads1115::supportedDataRate(ADS1115_DATA_RATE);
+    long samples = 0;
+    while (bus.nowUs < 1e6) {
+        if (adc.poll((unsigned long)(bus.nowUs * scale))) samples++;
+        bus.nowUs += POLL_INTERVAL_US;
+    }
+    Result result = { samples, bus.busUtilization() };
+    return result;
+}
+
+/**
+ * @brief Continuous mode with a pointer write before every read
+ */
+Result runPointerPerRead(int dataRate, unsigned long clockHz) {
+    MockAds1115 bus(ADS1115_ADDRESS, clockHz);
+    configure(bus, dataRate, true);
+    double period = 1e6 / dataRate * 1.1;
+    uint8_t pointer = 0;
+    uint8_t data[2];
+    long samples = 0;
+    while (bus.nowUs < 1e6) {
+        double next = bus.nowUs + period;
+        bus.write(bus.address, &pointer, 1);
+        bus.read(bus.address, data, 2);
+        samples++;
+        if (bus.nowUs < next) bus.nowUs = next;
+    }
+    Result result = { samples, bus.busUtilization() };
+    return result;
+}
+
+/**
+ * @brief Single-shot: start a conversion, poll the OS bit, read the result
+ */
+Result runSingleShot(int dataRate, unsigned long clockHz) {
+    MockAds1115 bus(ADS1115_ADDRESS, clockHz);
+    uint8_t configPointer = 0x01, conversionPointer = 0x00;
+    uint8_t data[2];
+    long samples = 0;
+    while (bus.nowUs < 1e6) {
+        configure(bus, dataRate, false);
+        uint16_t config = (uint16_t)(Ads1115::configValue(ADS1115_CHANNEL, ADS1115_FULL_SCALE_V, dataRate) | 0x8100);
+        uint8_t start[3] = { 0x01, (uint8_t)(config >> 8), (uint8_t)(config & 0xFF) };
+        bus.write(bus.address, start, 3);
+        bus.write(bus.address, &configPointer, 1);
+        do {
+            bus.nowUs += POLL_INTERVAL_US;
+            bus.read(bus.address, data, 2);
+        } while ((data[0] & 0x80) == 0);
+        bus.write(bus.address, &conversionPointer, 1);
+        bus.read(bus.address, data, 2);
+        samples++;
+    }
+    Result result = { samples, bus.busUtilization() };
+    return result;
+}
+
+} // namespace
+
+int main() {
+    const int RATES[] = { 128, 250, 475, 860 };
+    const unsigned long CLOCKS[] = { 100000, 400000 };
+    
+    std::printf("=== ADS1115 sampling (one simulated second per row) ===\n\n");
+    std::printf("  clock  rate   driver (continuous)   pointer per read     single-shot\n");
+    std::printf("  [kHz]  [SPS]  samples/s   bus %%    samples/s   bus %%    samples/s   bus %%\n");
+    for (int c = 0; c < 2; c++) {
+        for (int r = 0; r < 4; r++) {
+            Result driver = runDriver(RATES[r], CLOCKS[c]);
+            Result pointer = runPointerPerRead(RATES[r], CLOCKS[c]);
+            Result single = runSingleShot(RATES[r], CLOCKS[c]);
+            std::printf("  %5lu  %5d  %9ld  %6.2f    %9ld  %6.2f    %9ld  %6.2f\n", CLOCKS[c] / 1000, RATES[r],
+                        driver.samples, driver.utilization * 100.0, pointer.samples, pointer.utilization * 100.0,
+                        single.samples, single.utilization * 100.0);
+        }
+    }
+    
+    // One SampleRecord block: the sample task polls once per CONNECTION_POLL_MS, one conversion per poll at most
+    double blockMs = SAMPLE_RECORD_SAMPLES * CONNECTION_POLL_MS;
+    std::printf("\nConversions per %.0f ms block: internal ADC %d", blockMs, SAMPLE_RECORD_SAMPLES);
+    for (int r = 0; r < 4; r++) {
+        double paced = blockMs * RATES[r] / 1000.0 / 1.1;
+        std::printf(", %d SPS %.0f", RATES[r], paced < SAMPLE_RECORD_SAMPLES ? paced : SAMPLE_RECORD_SAMPLES);
+    }
+    std::printf("\n\n");
+    
+    // Host cost of poll() (mock bus transaction included when a sample is due)
+    const long POLLS = 20000000;
+    MockAds1115 bus;
+    Ads1115 adc(bus);
+    adc.begin();
+    long read = 0;
+    bench::Clock::time_point start = bench::Clock::now();
+    for (long i = 0; i < POLLS; i++) {
+        read += adc.poll((unsigned long)i) ? 1 : 0;
+    }
+    bench::doNotOptimize(read);
+    bench::report("Ads1115::poll()", bench::secondsSince(start), POLLS);
+    
+    return 0;
+}
@@ -0,0 +1,144 @@
+/**
+ * @brief Benchmark: BalanceReader throughput, round latency and drift error
+ *
+ * Drives the interleaved scheduler with a multi-channel mock ADC and reports
+ * scheduler cost per sample, per-tap refresh latency as taps are added
+ * (against averaging each tap in a blocking loop of analogRead() and
+ * delay(10)), and
+ * the apparent imbalance a load ramp causes with block vs. interleaved order.
+ */
+#include <cmath>
+#include <cstdio>
+#include "BenchUtil.h"
+#include "BalanceReader.h"
+
+namespace {
+
+// analogRead() conversion time used for the latency model
+const double ESP32_SAMPLE_US = 40.0;
+const double PRO_MINI_SAMPLE_US = 112.0;
+// Samples per tap in the blocking comparison (analogRead() and delay(10) each)
+const int BLOCKING_SAMPLES = 10;
+
+/**
+ * @brief Taps of a balanced pack; cells drift by driftPerSample each read
+ */
+class MockAdc : public AdcChannels {
+public:
+    MockAdc(int channels, float cellVoltage, float driftPerSample)
+        : channels(channels), cellVoltage(cellVoltage), driftPerSample(driftPerSample), samples(0) {}
+    
+    void begin() {}
+    int channelCount() const { return channels; }
+    
+    int read(int channel) {
+        float tap = (channel + 1) * (cellVoltage + driftPerSample * samples);
+        samples++;
+        return (int)(tap / voltsPerCount(channel) + 0.5f);
+    }
+    
+    float voltsPerCount(int channel) const {
+        return (float)ADC_VREF / ADC_MAX_VALUE * 1.5f * (channel + 1);
+    }
+    
+    int channels;
+    float cellVoltage;
+    float driftPerSample;
+    long samples;
+};
+
+/**
+ * @brief Mock returning a fixed code, to time the scheduler alone
+ */
+class ConstantAdc : public AdcChannels {
+public:
+    explicit ConstantAdc(int channels) : channels(channels), code(2048) {}
+    void begin() {}
+    int channelCount() const { return channels; }
+    int read(int) { return code++ & 0xFFF; }
+    float voltsPerCount(int) const { return 0.001f; }
+    
+    int channels;
+    int code;
+};
+
+float blockImbalance(int channels, int samplesPerChannel, float driftPerSample) {
+    MockAdc adc(channels, 3.9f, driftPerSample);
+    float below = 0.0f, lowest = 1e9f, highest = -1e9f;
+    for (int channel = 0; channel < channels; channel++) {
+        long sum = 0;
+        for (int i = 0; i < samplesPerChannel; i++) {
+            sum += adc.read(channel);
+        }
+        float tap = (float)sum / samplesPerChannel * adc.voltsPerCount(channel);
+        lowest = std::fmin(lowest, tap - below);
+        highest = std::fmax(highest, tap - below);
+        below = tap;
+    }
+    return highest - lowest;
+}
+
+float interleavedImbalance(int channels, float driftPerSample) {
+    MockAdc adc(channels, 3.9f, driftPerSample);
+    BalanceReader reader(adc);
+    reader.readRound();
+    float cells[BALANCE_MAX_CELLS];
+    BatteryInfo info = BatteryAnalyzer::analyzeWithCellCount(3.9f * channels, channels);
+    BalanceReader::applyCellVoltages(&info, cells, reader.getCellVoltages(channels, 0.0f, cells));
+    return info.imbalance;
+}
+
+} // namespace
+
+int main() {
+    std::printf("=== Balance reader (%d samples per round, min %d per tap) ===\n\n",
+                BALANCE_SAMPLES_PER_ROUND, BALANCE_MIN_SAMPLES);
+    
+    // Scheduler cost per sample (mock ADC, no conversion time)
+    const long SAMPLES = 20000000;
+    for (int channels = 1; channels <= BALANCE_MAX_CELLS; channels++) {
+        ConstantAdc adc(channels);
+        BalanceReader reader(adc);
+        long rounds = 0;
+        bench::Clock::time_point start = bench::Clock::now();
+        for (long i = 0; i < SAMPLES; i++) {
+            rounds += reader.step() ? 1 : 0;
+        }
+        double seconds = bench::secondsSince(start);
+        bench::doNotOptimize(rounds);
+        bench::doNotOptimize(reader.getTapVoltage(0));
+        
+        char name[48];
+        std::snprintf(name, sizeof(name), "step() %d taps", channels);
+        bench::report(name, seconds, SAMPLES);
+    }
+    
+    // Per-tap refresh latency: one shared budget vs. a blocking average per tap
+    std::printf("\nTap refresh latency (ESP32-C3 %.0f us/sample, Pro Mini %.0f us/sample)\n",
+                ESP32_SAMPLE_US, PRO_MINI_SAMPLE_US);
+    std::printf("  taps  samples/tap  round ESP32  round ProMini  blocking per tap\n");
+    for (int channels = 1; channels <= BALANCE_MAX_CELLS; channels++) {
+        ConstantAdc adc(channels);
+        BalanceReader reader(adc);
+        double perTapMs = BLOCKING_SAMPLES * (10.0 + ESP32_SAMPLE_US / 1000.0) * channels;
+        std::printf("  %4d  %11d  %8.2f ms  %10.2f ms  %11.1f ms\n", channels, reader.getSamplesPerChannel(),
+                    reader.getSamplesPerRound() * ESP32_SAMPLE_US / 1000.0,
+                    reader.getSamplesPerRound() * PRO_MINI_SAMPLE_US / 1000.0, perTapMs);
+    }
+    
+    // Apparent imbalance of a balanced pack sagging during the round
+    std::printf("\nApparent imbalance of a balanced pack under a load ramp\n");
+    std::printf("  taps  drift/sample  block order  interleaved\n");
+    const float DRIFTS[] = { -0.0001f, -0.001f };
+    for (int d = 0; d < 2; d++) {
+        for (int channels = 2; channels <= BALANCE_MAX_CELLS; channels += 2) {
+            MockAdc probe(channels, 3.9f, 0.0f);
+            BalanceReader reader(probe);
+            std::printf("  %4d  %9.1f mV  %8.1f mV  %8.1f mV\n", channels, DRIFTS[d] * 1000.0f,
+                        blockImbalance(channels, reader.getSamplesPerChannel(), DRIFTS[d]) * 1000.0f,
+                        interleavedImbalance(channels, DRIFTS[d]) * 1000.0f);
+        }
+    }
+    
+    return 0;
+}
@@ -0,0 +1,136 @@
+/**
+ * @brief Benchmark: CalibrationTable correction cost and accuracy
+ *
+ * Times the per-reading conversion: the nominal float scale, the O(1)
+ * table lookup, and a piecewise-linear curve evaluated by searching the
+ * reference points (what fitting at runtime would need). Also times
+ * boot-time deserialize() against refitting, and reports the error of each
+ * conversion on a synthetic nonlinear ESP32-C3-like ADC.
+ */
+#include <cmath>
+#include <cstdio>
+#include <vector>
+#include "BenchUtil.h"
+#include "CalibrationTable.h"
+
+namespace {
+
+const float NOMINAL_VOLTS_PER_COUNT = (float)ADC_VREF / ADC_MAX_VALUE *
+                                      (float)((VOLTAGE_DIVIDER_R1 + VOLTAGE_DIVIDER_R2) / VOLTAGE_DIVIDER_R2);
+
+// Same shape as the host test's model: gain, offset, bow, top compression
+float modelRaw(float batteryVoltage) {
+    float ideal = batteryVoltage / NOMINAL_VOLTS_PER_COUNT;
+    float x = ideal / ADC_MAX_VALUE;
+    float raw = ideal * 1.015f + 25.0f + 30.0f * std::sin(3.14159265f * x);
+    if (x > 0.9f) {
+        raw -= (x - 0.9f) * (x - 0.9f) * 6000.0f;
+    }
+    return std::fmin(std::fmax(raw, 0.0f), (float)ADC_MAX_VALUE);
+}
+
+/**
+ * @brief Reference: interpolate between sorted reference points found by binary search
+ */
+float searchPoints(const CalibrationPoint* points, int count, int raw) {
+    int low = 0;
+    int high = count - 1;
+    while (high - low > 1) {
+        int middle = (low + high) / 2;
+        if (points[middle].raw <= raw) {
+            low = middle;
+        } else {
+            high = middle;
+        }
+    }
+    const CalibrationPoint& a = points[low];
+    const CalibrationPoint& b = points[low + 1];
+    return a.voltage + (raw - a.raw) * (b.voltage - a.voltage) / (b.raw - a.raw);
+}
+
+} // namespace
+
+int main() {
+    std::printf("=== Calibration table (%d segments of %d codes, %d-byte blob) ===\n\n",
+                CALIBRATION_SEGMENTS, 1 << CalibrationTable::SEGMENT_SHIFT, CalibrationTable::BLOB_SIZE);
+    
+    const float references[] = { 3.0f, 7.0f, 11.0f, 15.0f, 18.5f, 21.0f };
+    const int COUNT = sizeof(references) / sizeof(references[0]);
+    CalibrationPoint points[COUNT];
+    for (int i = 0; i < COUNT; i++) {
+        points[i].raw = modelRaw(references[i]);
+        points[i].voltage = references[i];
+    }
+    CalibrationTable table;
+    table.fit(points, COUNT);
+    
+    // Accuracy over 3-21V
+    double nominalError = 0.0;
+    double tableError = 0.0;
+    double searchError = 0.0;
+    for (float v = 3.0f; v <= 21.0f; v += 0.005f) {
+        int raw = (int)(modelRaw(v) + 0.5f);
+        nominalError = std::fmax(nominalError, std::fabs(raw * NOMINAL_VOLTS_PER_COUNT - v));
+        tableError = std::fmax(tableError, std::fabs(table.toMillivolts(raw) * 0.001f - v));
+        searchError = std::fmax(searchError, std::fabs(searchPoints(points, COUNT, raw) - v));
+    }
+    std::printf("max error 3-21V: nominal %.0f mV, table %.0f mV, point search %.0f mV (%d references)\n\n",
+                nominalError * 1000.0, tableError * 1000.0, searchError * 1000.0, COUNT);
+    
+    // Per-reading cost over a realistic spread of codes
+    const int CODES = 4096;
+    std::vector<int> raws(CODES);
+    for (int i = 0; i < CODES; i++) {
+        raws[i] = (int)((i * 2654435761UL) % (ADC_MAX_VALUE + 1));
+    }
+    const int READINGS = 20000000;
+    
+    float sum = 0.0f;
+    bench::Clock::time_point start = bench::Clock::now();
+    for (int i = 0; i < READINGS; i++) {
+        sum += raws[i & (CODES - 1)] * NOMINAL_VOLTS_PER_COUNT;
+        bench::doNotOptimize(sum);
+    }
+    bench::report("nominal scale (float multiply)", bench::secondsSince(start), READINGS);
+    
+    unsigned long total = 0;
+    start = bench::Clock::now();
+    for (int i = 0; i < READINGS; i++) {
+        total += table.toMillivolts(raws[i & (CODES - 1)]);
+        bench::doNotOptimize(total);
+    }
+    bench::report("CalibrationTable::toMillivolts", bench::secondsSince(start), READINGS);
+    
+    sum = 0.0f;
+    start = bench::Clock::now();
+    for (int i = 0; i < READINGS; i++) {
+        sum += searchPoints(points, COUNT, raws[i & (CODES - 1)]);
+        bench::doNotOptimize(sum);
+    }
+    bench::report("point search + float interpolation", bench::secondsSince(start), READINGS);
+    
+    // Boot: validate a stored blob vs. fitting again
+    uint8_t blob[CalibrationTable::BLOB_SIZE];
+    table.serialize(blob);
+    const int BOOTS = 500000;
+    CalibrationTable loaded;
+    start = bench::Clock::now();
+    for (int i = 0; i < BOOTS; i++) {
+        bench::doNotOptimize(loaded.deserialize(blob));
+    }
+    bench::report("deserialize (CRC + copy)", bench::secondsSince(start), BOOTS);
+    
+    start = bench::Clock::now();
+    for (int i = 0; i < BOOTS; i++) {
+        CalibrationPoint copy[COUNT];
+        for (int j = 0; j < COUNT; j++) {
+            copy[j] = points[COUNT - 1 - j];
+        }
+        bench::doNotOptimize(loaded.fit(copy, COUNT));
+    }
+    bench::report("fit (sort + sample segment edges)", bench::secondsSince(start), BOOTS);
+    std::printf("(host FPU; on the AVR the fit's %d soft-float divisions dominate and the points are not stored anyway)\n",
+                CALIBRATION_SEGMENTS + 1);
+    
+    return 0;
+}
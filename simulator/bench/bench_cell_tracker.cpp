@@ -0,0 +1,141 @@
+/**
+ * @brief Benchmark: CellCountTracker convergence vs. single-shot detection
+ *
+ * Each scenario feeds noisy readings of a pack with a known cell count
+ * (Gaussian noise plus ADC quantization) to both detectors and reports:
+ * - wrong: fraction of readings with a wrong cell count
+ * - flips: cell count changes per 100 readings (display flicker)
+ * - settle: readings until the output stays correct for the rest of the run
+ */
+#include <cmath>
+#include <random>
+#include <vector>
+#include "BenchUtil.h"
+#include "BatteryAnalyzer.h"
+#include "CellCountTracker.h"
+
+namespace {
+
+const int TRIALS = 500;
+const int READINGS = 60;
+const float NOISE_SIGMA = 0.05f;                  // Matches TRACKER_NOISE_SIGMA
+const float ADC_STEP = 2.962f / 4095 * 7.6866f;   // ESP32-C3 volts per ADC count at the battery
+
+struct Scenario {
+    const char* description;
+    float voltage;
+    int cells;
+};
+
+struct Stats {
+    long wrong;
+    long flips;
+    long settle;
+    long neverSettled;
+};
+
+float noisyReading(float voltage, std::mt19937& rng) {
+    std::normal_distribution<float> noise(0.0f, NOISE_SIGMA);
+    float v = voltage + noise(rng);
+    return std::floor(v / ADC_STEP + 0.5f) * ADC_STEP;
+}
+
+void account(Stats& stats, const int* outputs, int truth) {
+    int lastWrong = -1;
+    for (int i = 0; i < READINGS; i++) {
+        if (outputs[i] != truth) {
+            stats.wrong++;
+            lastWrong = i;
+        }
+        if (i > 0 && outputs[i] != outputs[i - 1]) {
+            stats.flips++;
+        }
+    }
+    if (lastWrong == READINGS - 1) {
+        stats.neverSettled++;
+    } else {
+        stats.settle += lastWrong + 2;  // Readings needed, 1-based
+    }
+}
+
+void printStats(const char* name, const Stats& stats) {
+    double total = (double)TRIALS * READINGS;
+    int settled = TRIALS - (int)stats.neverSettled;
+    std::printf("    %-12s wrong %6.2f%%  flips %6.2f/100  settle %5.2f readings",
+                name, 100.0 * stats.wrong / total, 100.0 * stats.flips / total,
+                settled > 0 ? (double)stats.settle / settled : 0.0);
+    if (stats.neverSettled > 0) {
+        std::printf("  (never settled: %ld/%d)", stats.neverSettled, TRIALS);
+    }
+    std::printf("\n");
+}
+
+void runScenario(const Scenario& scenario, std::mt19937& rng) {
+    Stats single = Stats();
+    Stats tracked = Stats();
+    int singleOut[READINGS];
+    int trackedOut[READINGS];
+    
+    for (int trial = 0; trial < TRIALS; trial++) {
+        CellCountTracker tracker;
+        for (int i = 0; i < READINGS; i++) {
+            float v = noisyReading(scenario.voltage, rng);
+            singleOut[i] = BatteryAnalyzer::detectCellCount(v);
+            trackedOut[i] = tracker.update(v);
+        }
+        account(single, singleOut, scenario.cells);
+        account(tracked, trackedOut, scenario.cells);
+    }
+    
+    std::printf("%s (%.2fV, truth %dS)\n", scenario.description, scenario.voltage, scenario.cells);
+    printStats("single-shot", single);
+    printStats("tracker", tracked);
+}
+
+} // namespace
+
+int main() {
+    std::mt19937 rng(12345);
+    
+    const Scenario scenarios[] = {
+        { "3S nominal", 11.1f, 3 },
+        { "3S fully charged (band edge)", 12.6f, 3 },
+        { "4S fully charged (band edge)", 16.8f, 4 },
+        { "6S fully charged (band edge)", 25.2f, 6 },
+        { "3S ambiguous", 11.6f, 3 },
+        { "4S at 3.0V/cell (ambiguous)", 12.0f, 4 },
+        { "4S storage", 15.2f, 4 }
+    };
+    
+    std::printf("=== Cell count: tracker vs single-shot (%d trials x %d readings, sigma %.0fmV) ===\n\n",
+                TRIALS, READINGS, NOISE_SIGMA * 1000);
+    for (size_t i = 0; i < sizeof(scenarios) / sizeof(scenarios[0]); i++) {
+        runScenario(scenarios[i], rng);
+    }
+    
+    // Update cost
+    const int UPDATES = 2000000;
+    std::vector<float> trace(4096);
+    for (size_t i = 0; i < trace.size(); i++) {
+        trace[i] = noisyReading(11.6f, rng);
+    }
+    
+    std::printf("\n");
+    CellCountTracker tracker;
+    long checksum = 0;
+    bench::Clock::time_point start = bench::Clock::now();
+    for (int i = 0; i < UPDATES; i++) {
+        checksum += tracker.update(trace[i & 4095]);
+    }
+    bench::doNotOptimize(checksum);
+    bench::report("CellCountTracker::update", bench::secondsSince(start), UPDATES);
+    
+    start = bench::Clock::now();
+    for (int i = 0; i < UPDATES; i++) {
+        checksum += BatteryAnalyzer::detectCellCount(trace[i & 4095]);
+    }
+    bench::doNotOptimize(checksum);
+    bench::report("BatteryAnalyzer::detectCellCount", bench::secondsSince(start), UPDATES);
+    
+    return 0;
+}
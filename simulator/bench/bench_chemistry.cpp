@@ -0,0 +1,117 @@
+/**
+ * @brief Benchmark: chemistry policy analyzers vs. the original LiPo-only code
+ *
+ * LegacyLiPo below is the pre-template BatteryAnalyzer implementation kept
+ * verbatim as the baseline. The same voltage sweep is run through it, through
+ * each ChemistryAnalyzer<> instantiation and through the runtime dispatcher.
+ * The legacy entry point is kept out of line, like the original BatteryAnalyzer.cpp.
+ */
+#include <vector>
+#include "BenchUtil.h"
+#include "BatteryAnalyzer.h"
+#include "ChemistrySelector.h"
+
+namespace {
+
+struct LegacyLiPo {
+    static int detectCellCount(float voltage) {
+        const float MIN_CELL_V = 2.9f;
+        const float MAX_CELL_V = 4.2f;
+        const int MAX_CELLS_COUNT = 6;
+        if (voltage < MIN_CELL_V * 0.8) return 0;
+        if (voltage > MAX_CELL_V * MAX_CELLS_COUNT * 1.1) return 0;
+        for (int cells = 1; cells <= MAX_CELLS_COUNT; cells++) {
+            float avgCellVoltage = voltage / cells;
+            if (avgCellVoltage >= (MIN_CELL_V - 0.001f) && avgCellVoltage <= (MAX_CELL_V + 0.001f)) {
+                return cells;
+            }
+        }
+        return 0;
+    }
+    
+    static int calculateChargePercentage(float averageCellVoltage) {
+        if (averageCellVoltage < CELL_VOLTAGE_EMPTY) return 0;
+        if (averageCellVoltage >= CELL_VOLTAGE_FULL) return 100;
+        float voltageRange = CELL_VOLTAGE_FULL - CELL_VOLTAGE_EMPTY;
+        float voltageAboveEmpty = averageCellVoltage - CELL_VOLTAGE_EMPTY;
+        int percentage = (int)((voltageAboveEmpty / voltageRange) * 100.0 + 0.5);
+        if (percentage < 0) percentage = 0;
+        if (percentage > 100) percentage = 100;
+        return percentage;
+    }
+    
+    __attribute__((noinline)) static BatteryInfo analyzeBattery(float voltage) {
+        BatteryInfo info;
+        info.totalVoltage = voltage;
+        info.cellCount = detectCellCount(voltage);
+        if (info.cellCount > 0) {
+            info.averageCellVoltage = voltage / info.cellCount;
+            info.chargePercentage = calculateChargePercentage(info.averageCellVoltage);
+            info.isValid = true;
+        } else {
+            info.averageCellVoltage = 0.0;
+            info.chargePercentage = 0;
+            info.isValid = false;
+        }
+        return info;
+    }
+};
+
+const int SWEEP_POINTS = 4096;
+const int ROUNDS = 2000;
+
+template <class Analyzer>
+void run(const char* name, const std::vector<float>& voltages) {
+    long checksum = 0;
+    bench::Clock::time_point start = bench::Clock::now();
+    for (int round = 0; round < ROUNDS; round++) {
+        for (size_t i = 0; i < voltages.size(); i++) {
+            BatteryInfo info = Analyzer::analyzeBattery(voltages[i]);
+            checksum += info.cellCount + info.chargePercentage;
+        }
+        bench::doNotOptimize(checksum);
+    }
+    bench::report(name, bench::secondsSince(start), (double)ROUNDS * voltages.size());
+}
+
+struct Dispatched {
+    static BatteryInfo analyzeBattery(float voltage) {
+        return ChemistrySelector::analyzeBattery(voltage);
+    }
+};
+
+} // namespace
+
+int main() {
+    // Sweep 0-28V so every branch (invalid, each cell count, clamps) is exercised
+    std::vector<float> voltages(SWEEP_POINTS);
+    for (int i = 0; i < SWEEP_POINTS; i++) {
+        voltages[i] = 28.0f * i / SWEEP_POINTS;
+    }
+    
+    // Agreement check: the LiPo policy must reproduce the legacy results
+    int mismatches = 0;
+    for (int i = 0; i < SWEEP_POINTS; i++) {
+        BatteryInfo a = LegacyLiPo::analyzeBattery(voltages[i]);
+        BatteryInfo b = BatteryAnalyzer::analyzeBattery(voltages[i]);
+        if (a.cellCount != b.cellCount || a.chargePercentage != b.chargePercentage) {
+            mismatches++;
+        }
+    }
+    
+    std::printf("=== Chemistry analyzer benchmark (%d voltages x %d rounds) ===\n", SWEEP_POINTS, ROUNDS);
+    std::printf("LiPo policy vs legacy mismatches: %d\n\n", mismatches);
+    
+    run<LegacyLiPo>("legacy LiPo-only analyzeBattery", voltages);
+    run<BatteryAnalyzer>("ChemistryAnalyzer<LiPo>", voltages);
+    run<ChemistryAnalyzer<LiHVChemistry> >("ChemistryAnalyzer<LiHV>", voltages);
+    run<ChemistryAnalyzer<LiIonChemistry> >("ChemistryAnalyzer<LiIon>", voltages);
+    run<ChemistryAnalyzer<LiFePO4Chemistry> >("ChemistryAnalyzer<LiFePO4>", voltages);
+    
+    ChemistrySelector::select(CHEMISTRY_LIPO);
+    run<Dispatched>("ChemistrySelector (LiPo, runtime)", voltages);
+    ChemistrySelector::select(CHEMISTRY_LIFEPO4);
+    run<Dispatched>("ChemistrySelector (LiFePO4, runtime)", voltages);
+    
+    return mismatches == 0 ? 0 : 1;
+}
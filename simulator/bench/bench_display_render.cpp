@@ -0,0 +1,146 @@
+/**
+ * @brief Benchmark: DisplayManager render cost and bus traffic per frame
+ *
+ * Renders thousands of BatteryInfo states (every screen layout: invalid,
+ * 1S, average, uncertain count, balance leads, trend) through the
+ * production DisplayManager on the host Arduino core, with the SSD1306
+ * emulator decoding the traffic on the virtual bus. Reports the host time
+ * to draw a frame into the library buffer and to also push it through the
+ * scheduler and the panel, and per layout the transactions, bytes and
+ * device bus time (at I2C_CLOCK_HZ) one frame costs.
+ */
+#include <cstdio>
+#include <cstring>
+#include "BenchUtil.h"
+#include "DisplayManager.h"
+#include "Ssd1306Panel.h"
+#include "VirtualHardware.h"
+#include "config.h"
+
+namespace {
+
+const int STATES = 4096;
+const int KINDS = 6;
+const char* const KIND_NAMES[KINDS] = { "invalid", "1S", "average", "uncertain count", "balance leads", "trend" };
+
+struct State {
+    int kind;
+    BatteryInfo info;
+    TrendInfo trend;
+};
+
+State states[STATES];
+
+uint32_t seed = 12345;
+
+uint32_t nextRandom() {
+    seed = seed * 1103515245UL + 12345UL;
+    return (seed >> 8) & 0xFFFF;
+}
+
+float uniform(float low, float high) {
+    return low + (high - low) * (nextRandom() / 65535.0f);
+}
+
+void makeStates() {
+    for (int i = 0; i < STATES; i++) {
+        State& state = states[i];
+        memset(&state, 0, sizeof(state));
+        state.kind = i % KINDS;
+        BatteryInfo& info = state.info;
+        info.isValid = state.kind != 0;
+        info.cellCount = state.kind == 1 ? 1 : 2 + (int)(nextRandom() % (MAX_CELLS - 1));
+        info.averageCellVoltage = uniform(3.0f, 4.2f);
+        info.totalVoltage = info.cellCount * info.averageCellVoltage;
+        info.chargePercentage = (int)(nextRandom() % 101);
+        info.cellConfidence = state.kind == 3 ? (int)(nextRandom() % 100) : 100;
+        if (state.kind == 4) {
+            info.balanceCells = info.cellCount < BALANCE_MAX_CELLS ? info.cellCount : BALANCE_MAX_CELLS;
+            for (int c = 0; c < info.balanceCells; c++) {
+                info.cellVoltages[c] = info.averageCellVoltage + uniform(-0.05f, 0.05f);
+            }
+            info.weakestCell = 1 + (int)(nextRandom() % info.balanceCells);
+            info.imbalance = uniform(0.0f, 0.2f);
+        }
+        state.trend.isValid = state.kind == 5;
+        state.trend.millivoltsPerMinute = uniform(-120.0f, 20.0f);
+        state.trend.minutesToEmpty = state.trend.millivoltsPerMinute < 0.0f ? (long)(nextRandom() % 300) : -1;
+    }
+}
+
+void render(const State& state) {
+    DisplayManager::displayBatteryInfo(state.info, state.trend);
+}
+
+} // namespace
+
+int main() {
+    makeStates();
+    
+    Ssd1306Panel panel;
+    VirtualHardware::reset();
+    VirtualHardware::attachI2cDevice(SCREEN_ADDRESS, &panel);
+    if (!DisplayManager::begin()) {
+        std::printf("Display did not initialize\n");
+        return 1;
+    }
+    I2cScheduler& bus = I2cScheduler::shared();
+    bus.drain(micros());
+    
+    std::printf("=== DisplayManager::displayBatteryInfo(), %dx%d SSD1306 at %lu Hz, %d states ===\n\n",
+                SCREEN_WIDTH, SCREEN_HEIGHT, (unsigned long)I2C_CLOCK_HZ, STATES);
+    
+    // Traffic and device time per frame, by screen layout
+    unsigned long frames[KINDS] = { 0 }, transactions[KINDS] = { 0 }, bytes[KINDS] = { 0 };
+    uint64_t busMicros[KINDS] = { 0 };
+    for (int i = 0; i < STATES; i++) {
+        const State& state = states[i];
+        unsigned long before = panel.getFrameCount();
+        uint64_t start = VirtualHardware::nowMicros();
+        render(state);
+        bus.drain(micros());
+        busMicros[state.kind] += VirtualHardware::nowMicros() - start;
+        frames[state.kind] += panel.getFrameCount() - before;
+        transactions[state.kind] += panel.getFrameTransactions();
+        bytes[state.kind] += panel.getFrameBytes();
+    }
+    std::printf("  %-18s %8s %14s %10s %12s\n", "layout", "frames", "transactions", "bytes", "bus [us]");
+    for (int k = 0; k < KINDS; k++) {
+        double n = frames[k] ? (double)frames[k] : 1.0;
+        std::printf("  %-18s %8lu %14.1f %10.1f %12.1f\n", KIND_NAMES[k], frames[k], transactions[k] / n,
+                    bytes[k] / n, busMicros[k] / n);
+    }
+    std::printf("\n  Per frame: window commands plus the %d-byte framebuffer in scheduler chunks;\n",
+                SCREEN_WIDTH * SCREEN_HEIGHT / 8);
+    std::printf("  every layout sends the whole screen.\n\n");
+    
+    // Host cost: drawing into the library buffer (the frame is only queued)
+    const int ROUNDS = 20;
+    bench::Clock::time_point start = bench::Clock::now();
+    for (int r = 0; r < ROUNDS; r++) {
+        for (int i = 0; i < STATES; i++) {
+            render(states[i]);
+        }
+    }
+    bench::report("displayBatteryInfo() (queue only)", bench::secondsSince(start), (double)ROUNDS * STATES);
+    bus.drain(micros());
+    
+    // Plus the scheduler, the host Wire and the panel decoding the frame
+    unsigned long framesBefore = panel.getFrameCount();
+    start = bench::Clock::now();
+    for (int r = 0; r < ROUNDS; r++) {
+        for (int i = 0; i < STATES; i++) {
+            render(states[i]);
+            bus.drain(micros());
+        }
+    }
+    double seconds = bench::secondsSince(start);
+    bench::report("render + drain + panel decode", seconds, (double)ROUNDS * STATES);
+    unsigned long decoded = panel.getFrameCount() - framesBefore;
+    if (decoded != (unsigned long)ROUNDS * STATES) {
+        std::printf("  panel completed %lu frames, expected %d\n", decoded, ROUNDS * STATES);
+        return 1;
+    }
+    
+    return 0;
+}
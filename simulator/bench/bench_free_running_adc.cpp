@@ -0,0 +1,155 @@
+/**
+ * @brief Benchmark: Pro Mini internal ADC, blocking analogRead() vs. the
+ * interrupt-driven free-running backend
+ *
+ * Runs the production FreeRunningAdc against the simulated ATmega328P ADC
+ * from the unit tests at 8 MHz and compares a READING_SAMPLES-conversion
+ * reading with the blocking loop (analogRead() and delay(10) per sample): latency,
+ * CPU time spent waiting, interrupt load and the reading's error with
+ * digital noise while the CPU is awake. Also times the interrupt body and
+ * poll() on the host.
+ */
+#include <cmath>
+#include <cstdio>
+#include "BenchUtil.h"
+#include "FreeRunningAdc.h"
+#include "../../test/test_free_running_adc/MockAdcRegisters.h"
+
+namespace {
+
+const unsigned long CPU_HZ = 8000000UL;
+// Estimated ISR(ADC_vect) cost on AVR: register saves, virtual readResult(), block update
+const unsigned long ISR_CYCLES = 100;
+// Time the main loop spends between polls (us)
+const double POLL_INTERVAL_US = 10.0;
+const double INPUT_COUNTS = 511.3;
+const int READINGS = 200;
+// Conversions averaged into one reading
+const int READING_SAMPLES = 10;
+
+struct Result {
+    double latencyMs;        // Start of the reading to result
+    double waitingMs;        // CPU time the caller spent in it (awake)
+    double interruptLoad;    // Share of all CPU time in the ADC interrupt
+    double errorCounts;      // RMS error of the readings
+};
+
+void configureNoise(MockAdcRegisters& registers) {
+    registers.inputCounts = INPUT_COUNTS;
+    registers.noiseCounts = 1.0;
+    registers.cpuNoiseCounts = 3.0;
+    registers.isrCycles = ISR_CYCLES;
+}
+
+/**
+ * @brief analogRead() (start, wait 13 ADC clocks) and delay(10) per sample
+ */
+Result runBlocking(int prescaler, int samples) {
+    MockAdcRegisters registers(CPU_HZ);
+    configureNoise(registers);
+    registers.isrCycles = 0;
+    uint8_t control = (uint8_t)(FreeRunningAdc::CONTROL_A_ENABLE | FreeRunningAdc::prescalerBits(prescaler));
+    registers.write(AdcRegisters::MULTIPLEXER, FreeRunningAdc::MULTIPLEXER_AVCC);
+    registers.write(AdcRegisters::CONTROL_A, control);
+    
+    double squaredError = 0.0;
+    double start = registers.nowMicros();
+    for (int r = 0; r < READINGS; r++) {
+        long sum = 0;
+        for (int i = 0; i < samples; i++) {
+            registers.write(AdcRegisters::CONTROL_A, (uint8_t)(control | FreeRunningAdc::CONTROL_A_START));
+            while (registers.isConverting()) {
+                registers.run(1.0);
+            }
+            sum += registers.readResult();
+            registers.run(10000.0);
+        }
+        double error = (double)(sum / samples) - INPUT_COUNTS;
+        squaredError += error * error;
+    }
+    double perReadingMs = (registers.nowMicros() - start) / READINGS / 1000.0;
+    Result result = { perReadingMs, perReadingMs, 0.0, std::sqrt(squaredError / READINGS) };
+    return result;
+}
+
+/**
+ * @brief The backend: blocks from the interrupt, the caller polls (or sleeps)
+ */
+Result runBackend(int prescaler, int oversample, bool noiseSleep, int samples) {
+    MockAdcRegisters registers(CPU_HZ);
+    configureNoise(registers);
+    FreeRunningAdc adc(registers, 0, prescaler, oversample, noiseSleep);
+    adc.begin();
+    
+    double latencyUs = 0.0, waitingUs = 0.0, squaredError = 0.0;
+    for (int r = 0; r < READINGS; r++) {
+        // The rest of the loop between readings, at a phase unrelated to the ADC
+        registers.run(5000.0 + 37.0 * r);
+        double start = registers.nowMicros();
+        adc.startBatch();
+        while (adc.getBatchCount() < samples) {
+            if (!adc.poll()) {
+                if (noiseSleep) {
+                    adc.idle();
+                } else {
+                    registers.run(POLL_INTERVAL_US);
+                    waitingUs += POLL_INTERVAL_US;
+                }
+            }
+        }
+        latencyUs += registers.nowMicros() - start;
+        double error = adc.getBatchAverage() - INPUT_COUNTS;
+        squaredError += error * error;
+    }
+    Result result = { latencyUs / READINGS / 1000.0, waitingUs / READINGS / 1000.0, registers.interruptLoad(),
+                      std::sqrt(squaredError / READINGS) };
+    return result;
+}
+
+void printRow(const char* name, const Result& result) {
+    std::printf("  %-34s %9.2f %9.2f %8.2f %9.2f\n", name, result.latencyMs, result.waitingMs,
+                result.interruptLoad * 100.0, result.errorCounts);
+}
+
+} // namespace
+
+int main() {
+    std::printf("=== %d-conversion readings on the Pro Mini (8 MHz, %d readings per row) ===\n\n", READING_SAMPLES,
+                READINGS);
+    std::printf("  %-34s %9s %9s %8s %9s\n", "", "latency", "waiting", "ISR", "RMS err");
+    std::printf("  %-34s %9s %9s %8s %9s\n", "", "[ms]", "[ms]", "[%]", "[counts]");
+    printRow("analogRead + delay(10), /64", runBlocking(64, READING_SAMPLES));
+    printRow("free-running /64 x16", runBackend(64, 16, false, READING_SAMPLES));
+    printRow("free-running /64 x64", runBackend(64, 64, false, READING_SAMPLES));
+    printRow("free-running /128 x16", runBackend(128, 16, false, READING_SAMPLES));
+    printRow("free-running /32 x16", runBackend(32, 16, false, READING_SAMPLES));
+    printRow("noise-reduction sleep /64 x16", runBackend(64, 16, true, READING_SAMPLES));
+    printRow("noise-reduction sleep /64 x4", runBackend(64, 4, true, READING_SAMPLES));
+    std::printf("\n  latency: free-running rows return the newest finished block, at most one block old.\n");
+    std::printf("  waiting: awake CPU time spent on the reading; the sleep rows wait asleep.\n");
+    std::printf("  ISR: interrupt share of all CPU time at an estimated %lu cycles per conversion.\n\n", ISR_CYCLES);
+    
+    // Host cost of the interrupt body and of poll()
+    const long CONVERSIONS = 50000000;
+    MockAdcRegisters registers;
+    FreeRunningAdc adc(registers, 0, 64, 16, false);
+    adc.begin();
+    registers.write(AdcRegisters::CONTROL_A, 0);
+    bench::Clock::time_point start = bench::Clock::now();
+    for (long i = 0; i < CONVERSIONS; i++) {
+        adc.onConversion((uint16_t)(i & 0x3FF));
+    }
+    bench::doNotOptimize(adc.getLatest());
+    bench::report("FreeRunningAdc::onConversion()", bench::secondsSince(start), CONVERSIONS);
+    
+    long taken = 0;
+    start = bench::Clock::now();
+    for (long i = 0; i < CONVERSIONS; i++) {
+        adc.onConversion((uint16_t)(i & 0x3FF));
+        taken += adc.poll() ? 1 : 0;
+    }
+    bench::doNotOptimize(taken);
+    bench::report("onConversion() + poll()", bench::secondsSince(start), CONVERSIONS);
+    
+    return 0;
+}
@@ -0,0 +1,105 @@
+/**
+ * @brief Benchmark: SessionHistory storage density and append/query cost
+ *
+ * Feeds realistic traces (resting, discharging with load steps, noisy ADC)
+ * and reports bytes per buffered reading against storing BatteryInfo
+ * structs, then times append(), the O(1) statistics and the O(N) sparkline.
+ */
+#include <cmath>
+#include <random>
+#include <vector>
+#include "BenchUtil.h"
+#include "BatteryAnalyzer.h"
+#include "SessionHistory.h"
+
+namespace {
+
+const float ADC_STEP = 2.962f / 4095 * 7.6866f;   // ESP32-C3 volts per ADC count at the battery
+
+struct Trace {
+    const char* description;
+    float start;
+    float slopePerReading;
+    float noiseSigma;
+    int loadPeriod;       // Readings between load steps (0 = none)
+    float loadDrop;       // Voltage drop under load
+};
+
+float sample(const Trace& trace, int i, std::mt19937& rng) {
+    std::normal_distribution<float> noise(0.0f, trace.noiseSigma);
+    float v = trace.start + trace.slopePerReading * i + noise(rng);
+    if (trace.loadPeriod > 0 && (i / trace.loadPeriod) % 2 == 1) {
+        v -= trace.loadDrop;
+    }
+    return std::floor(v / ADC_STEP + 0.5f) * ADC_STEP;
+}
+
+void runDensity(const Trace& trace, std::mt19937& rng) {
+    SessionHistory history;
+    for (int i = 0; i < HISTORY_BUFFER_BYTES * 4; i++) {
+        history.append(sample(trace, i, rng));
+    }
+    
+    double bytesPerReading = (double)history.getBytesUsed() / history.getCount();
+    std::printf("  %-34s %5d readings in %5d bytes  %5.2f B/reading  (%4.1fx vs BatteryInfo)\n",
+                trace.description, history.getCount(), history.getBytesUsed(), bytesPerReading,
+                sizeof(BatteryInfo) / bytesPerReading);
+}
+
+} // namespace
+
+int main() {
+    std::mt19937 rng(7);
+    
+    std::printf("=== Session history (%d byte ring, %d mV resolution) ===\n\n",
+                HISTORY_BUFFER_BYTES, HISTORY_RESOLUTION_MV);
+    std::printf("sizeof(BatteryInfo) = %u bytes\n", (unsigned)sizeof(BatteryInfo));
+    
+    const Trace traces[] = {
+        { "3S resting, averaged ADC", 11.8f, 0.0f, 0.006f, 0, 0.0f },
+        { "3S discharging, 0.6V load steps", 12.5f, -0.0005f, 0.006f, 120, 0.6f },
+        { "6S noisy (sigma 50mV)", 24.0f, -0.0002f, 0.05f, 0, 0.0f },
+        { "1S very noisy (sigma 200mV)", 3.9f, 0.0f, 0.2f, 0, 0.0f },
+        { "6S pulsed 2V load every 4 readings", 24.0f, -0.0002f, 0.006f, 4, 2.0f }
+    };
+    for (size_t i = 0; i < sizeof(traces) / sizeof(traces[0]); i++) {
+        runDensity(traces[i], rng);
+    }
+    
+    // Cost
+    const int TRACE = 8192;
+    std::vector<float> readings(TRACE);
+    for (int i = 0; i < TRACE; i++) {
+        readings[i] = sample(traces[1], i, rng);
+    }
+    
+    std::printf("\n");
+    const int APPENDS = 5000000;
+    SessionHistory history;
+    bench::Clock::time_point start = bench::Clock::now();
+    for (int i = 0; i < APPENDS; i++) {
+        history.append(readings[i & (TRACE - 1)]);
+    }
+    bench::doNotOptimize(history.getCount());
+    bench::report("SessionHistory::append", bench::secondsSince(start), APPENDS);
+    
+    const int QUERIES = 5000000;
+    float checksum = 0.0f;
+    start = bench::Clock::now();
+    for (int i = 0; i < QUERIES; i++) {
+        checksum += history.getMean() + history.getStdDev() + history.getMinimum() + history.getMaximum();
+        bench::doNotOptimize(checksum);
+    }
+    bench::report("statistics (mean/stddev/min/max)", bench::secondsSince(start), QUERIES);
+    
+    const int SPARKLINES = 2000;
+    uint8_t heights[128];
+    start = bench::Clock::now();
+    for (int i = 0; i < SPARKLINES; i++) {
+        bench::doNotOptimize(history.sparkline(heights, 128, 21));
+        bench::doNotOptimize(heights[i & 127]);
+    }
+    bench::report("sparkline (128 columns, full ring)", bench::secondsSince(start), SPARKLINES);
+    
+    return 0;
+}
@@ -0,0 +1,158 @@
+/**
+ * @brief Benchmark: sensor latency on a bus shared with the display
+ *
+ * Runs the production I2cScheduler against the simulated bus from the unit
+ * tests for one simulated second per configuration: a 2-byte sensor read is
+ * due every millisecond and a new frame is queued every FRAME_PERIOD_MS.
+ * The baseline sends each frame the way Adafruit_SSD1306::display() does,
+ * back to back in 32-byte Wire transactions, so a sensor read that falls due
+ * meanwhile waits for the whole frame. Also times poll() on the host.
+ */
+#include <cstdio>
+#include "BenchUtil.h"
+#include "I2cScheduler.h"
+#include "../../test/test_i2c_scheduler/SimulatedI2cBus.h"
+
+namespace {
+
+const uint8_t DISPLAY_ADDRESS = SCREEN_ADDRESS;
+const uint8_t SENSOR_ADDRESS = ADS1115_ADDRESS;
+const int FRAME_BYTES = SCREEN_WIDTH * SCREEN_HEIGHT / 8;
+const int FRAME_PERIOD_MS = 100;
+const int WIRE_BUFFER = 32;          // Adafruit writes WIRE_MAX - 1 data bytes per transaction on AVR
+
+uint8_t frame[FRAME_BYTES];
+
+struct Result {
+    double sensorMaxUs;
+    double sensorAvgUs;
+    double frameMaxUs;
+    double utilization;
+};
+
+/**
+ * @brief Bus that only counts, for timing the scheduler itself
+ */
+class NullBus : public I2cBus {
+public:
+    bool write(uint8_t, const uint8_t*, uint8_t) { return true; }
+    bool read(uint8_t, uint8_t*, uint8_t) { return true; }
+};
+
+/**
+ * @brief Frames and sensor reads through the scheduler
+ */
+Result runScheduled(unsigned long clockHz) {
+    SimulatedI2cBus bus(clockHz);
+    bus.addDevice(DISPLAY_ADDRESS);
+    bus.addDevice(SENSOR_ADDRESS);
+    I2cScheduler scheduler(bus, clockHz);
+    I2cTransaction write = { DISPLAY_ADDRESS, I2C_PRIORITY_DISPLAY, false, true, 0x40,
+                             frame, FRAME_BYTES, I2C_STATUS_IDLE, 0, 0 };
+    uint8_t buffer[2];
+    I2cTransaction sensor = { SENSOR_ADDRESS, I2C_PRIORITY_SENSOR, true, false, 0,
+                              buffer, 2, I2C_STATUS_IDLE, 0, 0 };
+    
+    for (int ms = 0; ms < 1000; ms++) {
+        if (ms % FRAME_PERIOD_MS == 0) {
+            scheduler.submit(&write, ms * 1000UL);
+        }
+        if (sensor.status != I2C_STATUS_PENDING) {
+            scheduler.submit(&sensor, ms * 1000UL);
+        }
+        while (bus.nowUs < ms * 1000.0 + 1000.0) {
+            if (!scheduler.poll((unsigned long)bus.nowUs)) {
+                bus.nowUs += 10.0;
+            }
+        }
+    }
+    
+    I2cDeviceStats sensorStats, displayStats;
+    scheduler.getDeviceStats(SENSOR_ADDRESS, &sensorStats);
+    scheduler.getDeviceStats(DISPLAY_ADDRESS, &displayStats);
+    Result result = { (double)sensorStats.maxLatencyUs,
+                      (double)sensorStats.totalLatencyUs / sensorStats.transactions,
+                      (double)displayStats.maxLatencyUs,
+                      scheduler.getBusyMicros() / bus.nowUs };
+    return result;
+}
+
+/**
+ * @brief Each frame sent in one blocking burst, sensor reads in between
+ */
+Result runBlocking(unsigned long clockHz) {
+    SimulatedI2cBus bus(clockHz);
+    bus.addDevice(DISPLAY_ADDRESS);
+    bus.addDevice(SENSOR_ADDRESS);
+    uint8_t chunk[WIRE_BUFFER];
+    uint8_t buffer[2];
+    double busy = 0.0, sensorMax = 0.0, sensorTotal = 0.0, frameMax = 0.0;
+    
+    for (int ms = 0; ms < 1000; ms++) {
+        double due = ms * 1000.0;
+        if (bus.nowUs < due) bus.nowUs = due;
+        
+        if (ms % FRAME_PERIOD_MS == 0) {
+            double start = bus.nowUs;
+            for (int offset = 0; offset < FRAME_BYTES; offset += WIRE_BUFFER - 1) {
+                int length = FRAME_BYTES - offset < WIRE_BUFFER - 1 ? FRAME_BYTES - offset : WIRE_BUFFER - 1;
+                chunk[0] = 0x40;
+                for (int i = 0; i < length; i++) chunk[i + 1] = frame[offset + i];
+                bus.write(DISPLAY_ADDRESS, chunk, (uint8_t)(length + 1));
+            }
+            busy += bus.nowUs - start;
+            if (bus.nowUs - due > frameMax) frameMax = bus.nowUs - due;
+        }
+        
+        double start = bus.nowUs;
+        bus.read(SENSOR_ADDRESS, buffer, 2);
+        busy += bus.nowUs - start;
+        double latency = bus.nowUs - due;
+        sensorTotal += latency;
+        if (latency > sensorMax) sensorMax = latency;
+    }
+    
+    Result result = { sensorMax, sensorTotal / 1000.0, frameMax, busy / bus.nowUs };
+    return result;
+}
+
+} // namespace
+
+int main() {
+    const unsigned long CLOCKS[] = { 100000, 400000 };
+    char scheduledLabel[32];
+    std::snprintf(scheduledLabel, sizeof(scheduledLabel), "scheduler (%d B)", I2C_CHUNK_BYTES);
+    
+    std::printf("=== Shared I2C bus: %d-byte frame every %d ms, 2-byte sensor read every 1 ms ===\n\n",
+                FRAME_BYTES, FRAME_PERIOD_MS);
+    std::printf("  clock  mode                   sensor max   sensor avg   frame max   bus %%\n");
+    std::printf("  [kHz]                               [us]         [us]        [us]\n");
+    for (int c = 0; c < 2; c++) {
+        Result blocking = runBlocking(CLOCKS[c]);
+        Result scheduled = runScheduled(CLOCKS[c]);
+        std::printf("  %5lu  %-20s %11.0f  %11.0f  %10.0f  %6.2f\n", CLOCKS[c] / 1000, "blocking display()",
+                    blocking.sensorMaxUs, blocking.sensorAvgUs, blocking.frameMaxUs, blocking.utilization * 100.0);
+        std::printf("  %5lu  %-20s %11.0f  %11.0f  %10.0f  %6.2f\n", CLOCKS[c] / 1000, scheduledLabel,
+                    scheduled.sensorMaxUs, scheduled.sensorAvgUs, scheduled.frameMaxUs, scheduled.utilization * 100.0);
+    }
+    std::printf("\n");
+    
+    // Host cost of submit() + poll() for one queued frame, bus transfer excluded
+    const long FRAMES = 200000;
+    NullBus bus;
+    I2cScheduler scheduler(bus);
+    I2cTransaction write = { DISPLAY_ADDRESS, I2C_PRIORITY_DISPLAY, false, true, 0x40,
+                             frame, FRAME_BYTES, I2C_STATUS_IDLE, 0, 0 };
+    long polls = 0;
+    bench::Clock::time_point start = bench::Clock::now();
+    for (long i = 0; i < FRAMES; i++) {
+        scheduler.submit(&write, (unsigned long)i);
+        while (scheduler.poll((unsigned long)i)) {
+            polls++;
+        }
+    }
+    bench::doNotOptimize(polls);
+    bench::report("I2cScheduler::poll() per chunk", bench::secondsSince(start), polls);
+    
+    return 0;
+}
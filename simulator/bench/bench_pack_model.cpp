@@ -0,0 +1,244 @@
+/**
+ * @brief Benchmark: PackModel structure-of-arrays stepping and thread scaling
+ *
+ *   bench_pack_model [--packs 16384] [--steps 600] [--threads N]
+ *
+ * Steps a mixed fleet (1S-6S, 1.3-5 Ah, up to 8% imbalance, constant and
+ * pulsed loads), added grouped by cell count, at 1 s per step. The baseline
+ * is the same model written the obvious way: an array of pack structs, a
+ * loop over each pack's cells and branches for the load and cutoff. Then
+ * the SoA model is run with 1, 2, 4 ... threads up to the core count. The baseline and the model must end in the same state,
+ * and a single 3S pack must discharge in a plausible time; exits non-zero
+ * otherwise.
+ */
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <thread>
+#include <vector>
+#include "BenchUtil.h"
+#include "PackModel.h"
+
+namespace {
+
+const float STEP_SECONDS = 1.0f;
+
+/**
+ * @brief Reference: one struct per pack, cells stepped one at a time
+ */
+struct NaivePack {
+    int cells;
+    float soc[PACK_MAX_CELLS];
+    float socPerAmp[PACK_MAX_CELLS];
+    float resistance[PACK_MAX_CELLS];
+    float polarization[PACK_MAX_CELLS];
+    float gain;
+    float decay;
+    float volts[PACK_MAX_CELLS];
+    LoadProfile load;
+    bool connected;
+    float packVoltage;
+};
+
+/**
+ * @brief Same spread as PackModel::addPack() so both models hold the same cells
+ */
+float nextSpread(uint32_t* state) {
+    *state = *state * 1664525u + 1013904223u;
+    return (float)(*state >> 8) / 8388608.0f - 1.0f;
+}
+
+NaivePack makeNaive(const PackSpec& spec) {
+    NaivePack pack;
+    uint32_t random = spec.seed;
+    float decay = expf(-STEP_SECONDS / spec.polarizationSeconds);
+    pack.cells = spec.cells;
+    pack.gain = spec.polarizationOhms * (1.0f - decay);
+    pack.decay = decay;
+    for (int cell = 0; cell < spec.cells; cell++) {
+        float capacity = spec.capacityAh * (1.0f + spec.imbalance * nextSpread(&random));
+        float initial = spec.initialSoc + spec.imbalance * 0.5f * nextSpread(&random);
+        pack.soc[cell] = std::min(std::max(initial, 0.0f), 1.0f);
+        pack.socPerAmp[cell] = STEP_SECONDS / 3600.0f / capacity;
+        pack.resistance[cell] = spec.resistanceOhms * (1.0f + spec.imbalance * 2.0f * nextSpread(&random));
+        pack.polarization[cell] = 0.0f;
+    }
+    pack.load = spec.load;
+    pack.connected = true;
+    pack.packVoltage = 0.0f;
+    return pack;
+}
+
+void stepNaive(NaivePack* pack, long index) {
+    float amps = 0.0f;
+    if (pack->connected) {
+        amps = pack->load.baseAmps;
+        if (pack->load.periodSeconds > 0.0f) {
+            float cycle = fmodf(index * STEP_SECONDS + pack->load.phaseSeconds, pack->load.periodSeconds);
+            if (cycle < pack->load.pulseSeconds) {
+                amps += pack->load.pulseAmps;
+            }
+        }
+    }
+    float total = 0.0f;
+    float lowest = 1e9f;
+    for (int cell = 0; cell < pack->cells; cell++) {
+        pack->soc[cell] -= amps * pack->socPerAmp[cell];
+        if (pack->soc[cell] < 0.0f) {
+            pack->soc[cell] = 0.0f;
+        }
+        pack->polarization[cell] = pack->polarization[cell] * pack->decay + amps * pack->gain;
+        float v = packCellOcv(pack->soc[cell]) - amps * pack->resistance[cell] - pack->polarization[cell];
+        pack->volts[cell] = v;
+        total += v;
+        if (v < lowest) {
+            lowest = v;
+        }
+    }
+    pack->packVoltage = total;
+    if (lowest < pack->load.cutoffVolts) {
+        pack->connected = false;
+    }
+}
+
+/**
+ * @brief Reproducible mixed fleet
+ */
+std::vector<PackSpec> makeFleet(int packs) {
+    static const int CELLS[] = { 1, 2, 3, 3, 4, 4, 6, 6 };     // Share of the fleet per cell count
+    static const float CAPACITY[] = { 1.3f, 1.5f, 2.2f, 3.0f, 5.0f };
+    std::vector<PackSpec> fleet(packs);
+    uint32_t random = 2024u;
+    for (int i = 0; i < packs; i++) {
+        PackSpec& spec = fleet[i];
+        spec.cells = CELLS[(int)((long long)i * 8 / packs)];
+        spec.capacityAh = CAPACITY[(i / 8) % 5];
+        spec.resistanceOhms = 0.004f + 0.006f * (nextSpread(&random) + 1.0f);
+        spec.initialSoc = 0.7f + 0.15f * (nextSpread(&random) + 1.0f);
+        spec.imbalance = 0.04f * (nextSpread(&random) + 1.0f);
+        spec.seed = 1000u + (uint32_t)i;
+        float c = spec.capacityAh;
+        if (i % 3 == 0) {
+            spec.load.baseAmps = 1.0f * c;            // 1C
+        } else {
+            spec.load.baseAmps = 0.5f * c;            // Cruise with 10 s bursts every minute
+            spec.load.pulseAmps = 3.0f * c;
+            spec.load.periodSeconds = 60.0f;
+            spec.load.pulseSeconds = 10.0f;
+            spec.load.phaseSeconds = (float)(i % 60);
+        }
+    }
+    return fleet;
+}
+
+PackModel* buildModel(const std::vector<PackSpec>& fleet) {
+    PackModel* model = new PackModel((int)fleet.size(), STEP_SECONDS);
+    for (size_t i = 0; i < fleet.size(); i++) {
+        model->addPack(fleet[i]);
+    }
+    return model;
+}
+
+/**
+ * @brief Minutes of 1C from full until a 3S pack hits the 3.0 V/cell cutoff
+ */
+float minutesToCutoff(float* restVoltage) {
+    PackSpec spec;
+    spec.load.baseAmps = spec.capacityAh;
+    PackModel model(1, STEP_SECONDS);
+    model.addPack(spec);
+    while (model.isLoadConnected(0) && model.getTime() < 7200.0f) {
+        model.step();
+    }
+    float minutes = model.getTime() / 60.0f;
+    model.run(600, 1);             // Rest 10 minutes
+    *restVoltage = model.getPackVoltage(0);
+    return minutes;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    int packs = 16384;
+    int steps = 600;
+    int maxThreads = (int)std::thread::hardware_concurrency();
+    for (int i = 1; i + 1 < argc; i += 2) {
+        if (strcmp(argv[i], "--packs") == 0) {
+            packs = atoi(argv[i + 1]);
+        } else if (strcmp(argv[i], "--steps") == 0) {
+            steps = atoi(argv[i + 1]);
+        } else if (strcmp(argv[i], "--threads") == 0) {
+            maxThreads = atoi(argv[i + 1]);
+        }
+    }
+    maxThreads = std::max(maxThreads, 1);
+    double packSteps = (double)packs * steps;
+    std::vector<PackSpec> fleet = makeFleet(packs);
+    
+    printf("=== Pack model: %d packs x %d steps of %.0f s ===\n\n", packs, steps, STEP_SECONDS);
+    
+    // Baseline: array of structs
+    std::vector<NaivePack> naive(packs);
+    for (int i = 0; i < packs; i++) {
+        naive[i] = makeNaive(fleet[i]);
+    }
+    bench::Clock::time_point start = bench::Clock::now();
+    for (int n = 0; n < steps; n++) {
+        for (int i = 0; i < packs; i++) {
+            stepNaive(&naive[i], n);
+        }
+    }
+    double naiveSeconds = bench::secondsSince(start);
+    bench::report("array of packs, 1 thread", naiveSeconds, packSteps);
+    
+    // Structure of arrays, 1..maxThreads
+    std::vector<int> threadCounts;
+    for (int t = 1; t < maxThreads; t *= 2) {
+        threadCounts.push_back(t);
+    }
+    threadCounts.push_back(maxThreads);
+    
+    double singleSeconds = 0.0;
+    float worstVolts = 0.0f;
+    int connectedMismatches = 0;
+    printf("\n%-8s %16s %10s %10s\n", "threads", "pack-steps/s", "speedup", "vs naive");
+    for (size_t k = 0; k < threadCounts.size(); k++) {
+        PackModel* model = buildModel(fleet);
+        start = bench::Clock::now();
+        model->run(steps, threadCounts[k]);
+        double seconds = bench::secondsSince(start);
+        if (k == 0) {
+            singleSeconds = seconds;
+        }
+        printf("%-8d %16.0f %9.2fx %9.2fx\n", threadCounts[k], packSteps / seconds, singleSeconds / seconds,
+               naiveSeconds / seconds);
+        
+        for (int i = 0; i < packs; i++) {
+            worstVolts = std::max(worstVolts, fabsf(model->getPackVoltage(i) - naive[i].packVoltage));
+            if (model->isLoadConnected(i) != naive[i].connected) {
+                connectedMismatches++;
+            }
+        }
+        bench::doNotOptimize(model->getPackVoltage(0));
+        delete model;
+    }
+    printf("(%u hardware threads)\n", std::thread::hardware_concurrency());
+    
+    // Model sanity: 1C from full should take just under an hour, and the pack should recover at rest
+    float restVoltage = 0.0f;
+    float minutes = minutesToCutoff(&restVoltage);
+    printf("\n3S 2.2 Ah at 1C: cutoff after %.1f min, %.2f V after 10 min rest\n", minutes, restVoltage);
+    
+    int disconnected = 0;
+    for (int i = 0; i < packs; i++) {
+        disconnected += naive[i].connected ? 0 : 1;
+    }
+    bool passed = worstVolts < 0.002f && connectedMismatches == 0 && minutes > 45.0f && minutes < 62.0f &&
+                  restVoltage > 9.0f;
+    printf("SoA vs array of packs: worst pack difference %.2f mV, %d cutoff mismatches (%d packs cut off)\n",
+           worstVolts * 1000.0f, connectedMismatches, disconnected);
+    printf("%s\n", passed ? "model checks passed" : "MODEL CHECKS FAILED");
+    return passed ? 0 : 1;
+}
@@ -0,0 +1,117 @@
+/**
+ * @brief Benchmark: TrendEstimator O(1) update vs. recomputing the regression
+ *
+ * Both estimators see the same noisy discharge trace. The naive one keeps the
+ * same ring but refits all points on every estimate, like a straightforward
+ * firmware implementation would. Also reports the largest slope difference
+ * over a long run (the running sums are exact, so it stays at float rounding).
+ */
+#include <cmath>
+#include <random>
+#include <vector>
+#include "BenchUtil.h"
+#include "TrendEstimator.h"
+
+namespace {
+
+const unsigned long STEP_MS = 5000;
+
+/**
+ * @brief Reference: ring of points, full least squares refit per estimate
+ */
+class NaiveTrend {
+public:
+    NaiveTrend() : head(0), count(0) {}
+    
+    void update(unsigned long timeMs, float voltage) {
+        int index = (head + count) % TREND_WINDOW_SIZE;
+        if (count == TREND_WINDOW_SIZE) {
+            head = (head + 1) % TREND_WINDOW_SIZE;
+        } else {
+            count++;
+        }
+        times[index] = timeMs;
+        millivolts[index] = (long)(voltage * 1000.0f + 0.5f);
+    }
+    
+    float slope() const {
+        unsigned long origin = times[head];
+        double meanT = 0.0, meanV = 0.0;
+        for (int i = 0; i < count; i++) {
+            int k = (head + i) % TREND_WINDOW_SIZE;
+            meanT += (double)(times[k] - origin);
+            meanV += millivolts[k];
+        }
+        meanT /= count;
+        meanV /= count;
+        double stv = 0.0, stt = 0.0;
+        for (int i = 0; i < count; i++) {
+            int k = (head + i) % TREND_WINDOW_SIZE;
+            double dt = (double)(times[k] - origin) - meanT;
+            stv += dt * (millivolts[k] - meanV);
+            stt += dt * dt;
+        }
+        return (float)(stv / stt * 60000.0);
+    }
+
+private:
+    unsigned long times[TREND_WINDOW_SIZE];
+    long millivolts[TREND_WINDOW_SIZE];
+    int head;
+    int count;
+};
+
+} // namespace
+
+int main() {
+    std::mt19937 rng(2024);
+    std::normal_distribution<float> noise(0.0f, 0.015f);
+    
+    const int TRACE = 8192;
+    std::vector<float> trace(TRACE);
+    for (int i = 0; i < TRACE; i++) {
+        trace[i] = 12.4f - i * 0.0008f + noise(rng);
+    }
+    
+    std::printf("=== Trend estimator (window %d points) ===\n\n", TREND_WINDOW_SIZE);
+    
+    // Accuracy over a long run (sawtooth trace, ~290 days of 5 s readings)
+    const long LONG_RUN = 5000000;
+    TrendEstimator trend(0);
+    NaiveTrend naive;
+    float maxDifference = 0.0f;
+    for (long i = 0; i < LONG_RUN; i++) {
+        unsigned long t = (unsigned long)i * STEP_MS;
+        trend.update(t, trace[i % TRACE]);
+        naive.update(t, trace[i % TRACE]);
+        if (i % 1009 == 0 && trend.getCount() == TREND_WINDOW_SIZE) {
+            float difference = std::fabs(trend.estimate(9.9f).millivoltsPerMinute - naive.slope());
+            if (difference > maxDifference) maxDifference = difference;
+        }
+    }
+    std::printf("Max slope difference over %ld readings: %.6f mV/min\n\n", LONG_RUN, maxDifference);
+    
+    // Update cost: one reading plus one estimate, as in measureAndDisplay()
+    const int UPDATES = 2000000;
+    double checksum = 0.0;
+    
+    TrendEstimator fast(0);
+    bench::Clock::time_point start = bench::Clock::now();
+    for (int i = 0; i < UPDATES; i++) {
+        fast.update((unsigned long)i * STEP_MS, trace[i & (TRACE - 1)]);
+        checksum += fast.estimate(9.9f).millivoltsPerMinute;
+    }
+    bench::doNotOptimize(checksum);
+    bench::report("TrendEstimator update+estimate", bench::secondsSince(start), UPDATES);
+    
+    NaiveTrend slow;
+    start = bench::Clock::now();
+    for (int i = 0; i < UPDATES; i++) {
+        slow.update((unsigned long)i * STEP_MS, trace[i & (TRACE - 1)]);
+        checksum += slow.slope();
+    }
+    bench::doNotOptimize(checksum);
+    bench::report("Naive refit update+estimate", bench::secondsSince(start), UPDATES);
+    
+    return 0;
+}
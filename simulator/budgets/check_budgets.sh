@@ -0,0 +1,50 @@
+#!/bin/sh
+# Measure every budget metric and compare against budgets/baseline.txt
+#
+#   budgets/check_budgets.sh            exit 1 if anything is over budget
+#   budgets/check_budgets.sh --update   record the measurements as the new baseline
+#
+# The loop and native metrics come from the host build. The esp32-c3-devkitm-1
+# and pro-mini sizes need PlatformIO. Without it a target row with a recorded
+# baseline is "not measured", and one without a baseline fails the check.
+set -e
+
+SIM=$(cd "$(dirname "$0")/.." && pwd)
+ROOT=$SIM/..
+BUILD=${BUILD_DIR:-$SIM/_budget_build}
+METRICS=$BUILD/metrics
+UPDATE=
+[ "$1" = "--update" ] && UPDATE=--update
+
+cmake -S "$SIM" -B "$BUILD" >/dev/null
+cmake --build "$BUILD" --target budget_gate firmware_host >/dev/null
+GATE=$BUILD/budget_gate
+HOST_OBJECTS=$BUILD/CMakeFiles/firmware_host.dir
+mkdir -p "$METRICS"
+rm -f "$METRICS"/*.txt
+
+"$GATE" loop --volts --out "$METRICS/loop.txt" "$SIM/traces/plug_discharge.trace"
+"$GATE" loop --volts --cpu-scale 1 --out "$METRICS/cpu.txt" "$SIM/traces/plug_discharge.trace"
+# The memory monitor's stack reservation below setup() exists only on the host
+"$GATE" size --out "$METRICS/native.txt" --exclude reserveHostStack native "$BUILD/libfirmware_host.a" \
+    "$HOST_OBJECTS"
+
+if command -v pio >/dev/null 2>&1; then
+    for env in esp32-c3-devkitm-1 pro-mini; do
+        # Frame sizes from the target compiler, calls from the host build's call graph
+        (cd "$ROOT" && PLATFORMIO_BUILD_SRC_FLAGS=-fstack-usage pio run -s -e "$env")
+        "$GATE" size --out "$METRICS/$env.txt" "$env" "$ROOT/.pio/build/$env/firmware.elf" \
+            "$HOST_OBJECTS" "$ROOT/.pio/build/$env/src"
+    done
+else
+    # A target that was never measured has nothing to fall back on
+    UNRECORDED=$(awk '/^(esp32-c3-devkitm-1|pro-mini)\./ && $2 == "-" { print $1 }' "$SIM/budgets/baseline.txt")
+    if [ -n "$UNRECORDED" ]; then
+        echo "pio not found and no baseline recorded for:" $UNRECORDED >&2
+    else
+        echo "pio not found: esp32-c3-devkitm-1 and pro-mini not measured" >&2
+    fi
+fi
+
+"$GATE" check $UPDATE "$SIM/budgets/baseline.txt" "$METRICS"/*.txt
+[ -z "$UNRECORDED" ] || exit 1
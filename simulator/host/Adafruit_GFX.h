@@ -0,0 +1,50 @@
+#ifndef HOST_ADAFRUIT_GFX_H
+#define HOST_ADAFRUIT_GFX_H
+
+#include "Arduino.h"
+
+/**
+ * @brief Host stand-in for Adafruit_GFX: the primitives and classic-font
+ * text the firmware draws with, following the library's rules (6x8 character
+ * cells scaled by the text size, '\n' returns to column 0, wrap at the edge)
+ *
+ * Glyphs cover printable ASCII; other codes draw nothing.
+ */
+class Adafruit_GFX : public Print {
+public:
+    Adafruit_GFX(int16_t w, int16_t h);
+    
+    virtual void drawPixel(int16_t x, int16_t y, uint16_t color) = 0;
+    virtual void drawFastVLine(int16_t x, int16_t y, int16_t h, uint16_t color);
+    virtual void drawFastHLine(int16_t x, int16_t y, int16_t w, uint16_t color);
+    virtual void fillRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color);
+    void drawRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color);
+    void fillScreen(uint16_t color);
+    void drawChar(int16_t x, int16_t y, unsigned char c, uint16_t color, uint16_t background, uint8_t size);
+    
+    void setCursor(int16_t x, int16_t y);
+    void setTextSize(uint8_t size);
+    void setTextColor(uint16_t color);
+    void setTextColor(uint16_t color, uint16_t background);
+    void setTextWrap(bool wrap);
+    
+    int16_t width() const { return screenWidth; }
+    int16_t height() const { return screenHeight; }
+    int16_t getCursorX() const { return cursorX; }
+    int16_t getCursorY() const { return cursorY; }
+    
+    size_t write(uint8_t c);
+    using Print::write;
+
+protected:
+    int16_t screenWidth;
+    int16_t screenHeight;
+    int16_t cursorX;
+    int16_t cursorY;
+    uint16_t textColor;
+    uint16_t textBackground;     // Same as textColor = transparent
+    uint8_t textSize;
+    bool wrap;
+};
+
+#endif // HOST_ADAFRUIT_GFX_H
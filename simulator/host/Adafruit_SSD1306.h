@@ -0,0 +1,51 @@
+#ifndef HOST_ADAFRUIT_SSD1306_H
+#define HOST_ADAFRUIT_SSD1306_H
+
+#include "Adafruit_GFX.h"
+#include "Wire.h"
+
+#define SSD1306_BLACK 0
+#define SSD1306_WHITE 1
+#define SSD1306_INVERSE 2
+#define BLACK SSD1306_BLACK
+#define WHITE SSD1306_WHITE
+#define INVERSE SSD1306_INVERSE
+
+#define SSD1306_EXTERNALVCC 0x01
+#define SSD1306_SWITCHCAPVCC 0x02
+
+/**
+ * @brief Host stand-in for the Adafruit_SSD1306 driver
+ *
+ * Same framebuffer layout (one byte per 8 rows of a column, page by page),
+ * and begin()/display() send the library's init sequence and frame upload
+ * over Wire, so a panel on the virtual bus sees the same traffic.
+ */
+class Adafruit_SSD1306 : public Adafruit_GFX {
+public:
+    Adafruit_SSD1306(uint8_t w, uint8_t h, TwoWire* wire = &Wire, int8_t resetPin = -1,
+                     uint32_t clockDuring = 400000UL, uint32_t clockAfter = 100000UL);
+    ~Adafruit_SSD1306();
+    
+    bool begin(uint8_t vccState = SSD1306_SWITCHCAPVCC, uint8_t address = 0, bool reset = true,
+               bool periphBegin = true);
+    void display();
+    void clearDisplay();
+    void invertDisplay(bool invert);
+    void dim(bool dim);
+    void drawPixel(int16_t x, int16_t y, uint16_t color);
+    bool getPixel(int16_t x, int16_t y) const;
+    uint8_t* getBuffer();
+
+private:
+    void sendCommands(const uint8_t* commands, size_t count);
+    
+    TwoWire* wire;
+    uint8_t* buffer;
+    uint8_t address;
+    uint8_t vccState;
+    uint32_t clockDuring;
+    uint32_t clockAfter;
+};
+
+#endif // HOST_ADAFRUIT_SSD1306_H
@@ -0,0 +1,119 @@
+#ifndef HOST_ARDUINO_H
+#define HOST_ARDUINO_H
+
+/*
+ * Host stand-in for the Arduino core: just the API the firmware uses, on
+ * top of VirtualHardware (virtual clock, pins, serial). Lets the firmware sources,
+ * including setup() and loop(), build unchanged for the host.
+ */
+
+#include <math.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define HIGH 0x1
+#define LOW 0x0
+
+#define INPUT 0x01
+#define OUTPUT 0x03
+#define INPUT_PULLUP 0x05
+
+#define DEC 10
+#define HEX 16
+#define OCT 8
+#define BIN 2
+
+typedef bool boolean;
+typedef uint8_t byte;
+
+/*
+ * Flash strings. On AVR, F() and PROGMEM text stays in flash instead of
+ * being copied into SRAM. Here it only gets its own section, so
+ * budget_gate can tell it from the literals the Pro Mini would copy.
+ */
+class __FlashStringHelper;
+#if defined(__GNUC__) && defined(__ELF__)
+#define PROGMEM __attribute__((section(".progmem.data")))
+#define PSTR(text) (__extension__({ static const char progmemText[] PROGMEM = (text); &progmemText[0]; }))
+#else
+#define PROGMEM
+#define PSTR(text) (text)
+#endif
+#define F(text) (reinterpret_cast<const __FlashStringHelper*>(PSTR(text)))
+#define pgm_read_byte(address) (*(const uint8_t*)(address))
+
+unsigned long millis();
+unsigned long micros();
+void delay(unsigned long ms);
+void delayMicroseconds(unsigned int us);
+void yield();
+
+void pinMode(uint8_t pin, uint8_t mode);
+int digitalRead(uint8_t pin);
+void digitalWrite(uint8_t pin, uint8_t value);
+uint16_t analogRead(uint8_t pin);
+void analogReadResolution(uint8_t bits);
+
+/**
+ * @brief Text output with the Arduino formatting rules (Print.cpp)
+ */
+class Print {
+public:
+    virtual ~Print() {}
+    virtual size_t write(uint8_t c) = 0;
+    virtual size_t write(const uint8_t* buffer, size_t size);
+    size_t write(const char* text) { return text ? write((const uint8_t*)text, strlen(text)) : 0; }
+    
+    size_t print(const char* text);
+    size_t print(const __FlashStringHelper* text);
+    size_t print(char c);
+    size_t print(unsigned char value, int base = DEC);
+    size_t print(int value, int base = DEC);
+    size_t print(unsigned int value, int base = DEC);
+    size_t print(long value, int base = DEC);
+    size_t print(unsigned long value, int base = DEC);
+    size_t print(long long value, int base = DEC);
+    size_t print(unsigned long long value, int base = DEC);
+    size_t print(double value, int digits = 2);
+    
+    size_t println();
+    size_t println(const char* text);
+    size_t println(const __FlashStringHelper* text);
+    size_t println(char c);
+    size_t println(unsigned char value, int base = DEC);
+    size_t println(int value, int base = DEC);
+    size_t println(unsigned int value, int base = DEC);
+    size_t println(long value, int base = DEC);
+    size_t println(unsigned long value, int base = DEC);
+    size_t println(long long value, int base = DEC);
+    size_t println(unsigned long long value, int base = DEC);
+    size_t println(double value, int digits = 2);
+
+private:
+    size_t printNumber(unsigned long long value, int base);
+    size_t printFloat(double value, int digits);
+};
+
+/**
+ * @brief Serial port: output goes to VirtualHardware's serial sink, input
+ * comes from VirtualHardware::queueSerialInput()
+ */
+class HardwareSerial : public Print {
+public:
+    void begin(unsigned long baud);
+    void end();
+    int available();
+    int read();
+    int peek();
+    void flush();
+    size_t write(uint8_t c);
+    size_t write(const uint8_t* buffer, size_t size);
+    using Print::write;
+    operator bool() const { return true; }
+};
+
+extern HardwareSerial Serial;
+
+#endif // HOST_ARDUINO_H
@@ -0,0 +1,508 @@
+#include "FleetEmulator.h"
+#include <algorithm>
+#include <chrono>
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/resource.h>
+#include <sys/stat.h>
+#include <termios.h>
+#include <thread>
+#include <time.h>
+#include <unistd.h>
+#include "Arduino.h"
+#include "config.h"
+#include "VoltageReader.h"
+#include "ChemistrySelector.h"
+#include "MeasurementTasks.h"
+#include "DebugLogger.h"
+#include "ReplaySource.h"
+#include "../AdcModel.h"
+#include "../PackModel.h"
+
+namespace {
+
+// One step of the fleet: a block of single samples, as the sampling task collects them
+const int BLOCK_SAMPLES = SAMPLE_RECORD_SAMPLES;
+const int BLOCK_MS = SAMPLE_RECORD_SAMPLES * CONNECTION_POLL_MS;
+const float BLOCK_SECONDS = BLOCK_MS / 1000.0f;
+
+// Buffered output per tester is written once it reaches this size (every block in real time)
+const size_t FLUSH_BYTES = 4096;
+
+// Seconds a tester waits with no pack between sessions, and before its first one
+const float GAP_MIN_SECONDS = 2.0f;
+const float GAP_MAX_SECONDS = 20.0f;
+const float BOOT_SPREAD_SECONDS = 5.0f;
+const float CLOCK_PPM = 100.0f;
+
+double threadCpuSeconds() {
+    struct timespec now;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &now);
+    return now.tv_sec + now.tv_nsec * 1e-9;
+}
+
+/**
+ * @brief Small per-tester random stream (xorshift32), so testers are
+ * reproducible from the seed whatever shard or thread runs them
+ */
+class TesterRandom {
+public:
+    explicit TesterRandom(uint32_t seed) : state(seed * 2654435761u ^ 0x9E3779B9u) {
+        if (state == 0) {
+            state = 1;
+        }
+        for (int i = 0; i < 4; i++) {
+            next();
+        }
+    }
+    
+    uint32_t next() {
+        state ^= state << 13;
+        state ^= state >> 17;
+        state ^= state << 5;
+        return state;
+    }
+    
+    float uniform(float low, float high) {
+        return low + (high - low) * (next() >> 8) * (1.0f / 16777216.0f);
+    }
+
+private:
+    uint32_t state;
+};
+
+/**
+ * @brief A tester's serial port: DebugLogger writes into a buffer that the
+ * worker flushes to the tester's file or PTY
+ */
+class TesterPort : public Print {
+public:
+    using Print::write;
+    
+    size_t write(uint8_t c) override {
+        buffer.push_back((char)c);
+        return 1;
+    }
+    
+    size_t write(const uint8_t* data, size_t size) override {
+        buffer.append((const char*)data, size);
+        return size;
+    }
+    
+    std::string buffer;
+};
+
+/**
+ * @brief One tester: the firmware's MeasurementTasks fed by its own ADC
+ * unit and clock, printing into its port
+ */
+class VirtualTester {
+public:
+    VirtualTester(int id, const FleetOptions& options);
+    
+    /**
+     * @brief Describe this tester's pack (from its own random stream)
+     */
+    PackSpec packSpec();
+    
+    /**
+     * @brief Run one block: BLOCK_SAMPLES single samples and any analysis due
+     * @param seconds Fleet time at the start of the block
+     * @param packVoltage Terminal voltage of the tester's pack
+     */
+    void runBlock(double seconds, float packVoltage, FleetStats& stats);
+    
+    TesterPort port;
+    int pack;                   // Index in the shard's PackModel
+
+private:
+    TesterRandom random;
+    AdcModel adc;
+    int format;
+    int verbosity;
+    float bootSeconds;
+    double clockScale;          // Crystal error
+    float sessionSeconds;
+    bool booted;
+    bool plugged;
+    double nextToggle;
+    
+    ReplaySource source;
+    MeasurementTasks tasks;
+    unsigned long nextAnalysisMs;   // The analysis task's next release
+    
+    static AdcModelConfig adcConfig();
+    unsigned long millisAt(double seconds) const;
+    void boot(FleetStats& stats);
+};
+
+AdcModelConfig VirtualTester::adcConfig() {
+    // Nominal front end with 1% parts, as built
+    AdcModelConfig config;
+    config.resistorTolerance = 0.01f;
+    config.vrefTolerance = 0.01f;
+    return config;
+}
+
+VirtualTester::VirtualTester(int id, const FleetOptions& options)
+    : pack(-1),
+      random(options.seed * 1000003u + (uint32_t)id),
+      adc(adcConfig(), ((uint64_t)options.seed << 32) | (uint32_t)id),
+      format(options.format >= 0 ? options.format : id % 3),
+      verbosity(options.verbosity),
+      booted(false),
+      plugged(false),
+      tasks(source, port),
+      nextAnalysisMs(0) {
+    bootSeconds = random.uniform(0.0f, BOOT_SPREAD_SECONDS);
+    clockScale = 1.0 + random.uniform(-CLOCK_PPM, CLOCK_PPM) * 1e-6;
+    sessionSeconds = (float)options.sessionSeconds;
+    nextToggle = bootSeconds + random.uniform(GAP_MIN_SECONDS, GAP_MAX_SECONDS);
+}
+
+PackSpec VirtualTester::packSpec() {
+    // Mostly 3S and 4S, as on a typical bench
+    static const int CELL_WEIGHTS[PACK_MAX_CELLS] = { 10, 15, 30, 25, 5, 15 };
+    int pick = (int)(random.next() % 100);
+    PackSpec spec;
+    spec.cells = 1;
+    for (int i = 0; i < PACK_MAX_CELLS; i++) {
+        if (pick < CELL_WEIGHTS[i]) {
+            spec.cells = i + 1;
+            break;
+        }
+        pick -= CELL_WEIGHTS[i];
+    }
+    spec.capacityAh = random.uniform(0.3f, 5.0f);
+    spec.initialSoc = random.uniform(0.3f, 1.0f);
+    spec.imbalance = random.uniform(0.0f, 0.05f);
+    spec.seed = random.next();
+    
+    // A third rest on the bench; the others discharge at 0.2-1C, half of them with bursts
+    if (random.next() % 3 != 0) {
+        spec.load.baseAmps = spec.capacityAh * random.uniform(0.2f, 1.0f);
+        if (random.next() % 2 == 0) {
+            spec.load.pulseAmps = spec.capacityAh * random.uniform(1.0f, 3.0f);
+            spec.load.periodSeconds = random.uniform(20.0f, 120.0f);
+            spec.load.pulseSeconds = random.uniform(2.0f, 10.0f);
+            spec.load.phaseSeconds = random.uniform(0.0f, spec.load.periodSeconds);
+        }
+    }
+    return spec;
+}
+
+unsigned long VirtualTester::millisAt(double seconds) const {
+    return (unsigned long)((seconds - bootSeconds) * clockScale * 1000.0);
+}
+
+void VirtualTester::boot(FleetStats& stats) {
+    booted = true;
+    tasks.getTracker().configure(ChemistrySelector::limits(ChemistrySelector::current()));
+    tasks.getWatcher().configure(VoltageReader::batteryVoltageToRaw(CONNECT_THRESHOLD_V),
+                                 VoltageReader::batteryVoltageToRaw(DISCONNECT_THRESHOLD_V));
+    
+    // Set up for "$verbosity" and "$format"; "$format=csv" prints the header
+    tasks.setOutput(verbosity, format);
+    if (format == OUTPUT_FORMAT_CSV) {
+        DebugLogger::printCsvHeader(port);
+        stats.messages++;
+    }
+}
+
+void VirtualTester::runBlock(double seconds, float packVoltage, FleetStats& stats) {
+    if (!booted) {
+        if (seconds < bootSeconds) {
+            return;
+        }
+        boot(stats);
+    }
+    if (seconds >= nextToggle) {
+        plugged = !plugged;
+        nextToggle = seconds + (plugged ? random.uniform(0.5f, 1.5f) * sessionSeconds :
+                                          random.uniform(GAP_MIN_SECONDS, GAP_MAX_SECONDS));
+    }
+    
+    uint16_t raw[BLOCK_SAMPLES];
+    adc.sampleConstant(plugged ? packVoltage : 0.0f, raw, BLOCK_SAMPLES);
+    stats.samples += BLOCK_SAMPLES;
+    
+    // The sampling task every CONNECTION_POLL_MS; the analysis on its period
+    // grid (moved by the first block of a new pack) with the display task
+    // right after it, as the firmware's scheduler runs them
+    for (int i = 0; i < BLOCK_SAMPLES; i++) {
+        unsigned long nowMs = millisAt(seconds + i * (CONNECTION_POLL_MS / 1000.0));
+        source.feed(raw[i]);
+        ConnectionEvent event = tasks.sample(nowMs);
+        if (event != CONNECTION_NONE) {
+            stats.messages++;
+            if (event == CONNECTION_CONNECTED) {
+                stats.connects++;
+            }
+        }
+        if (tasks.isAnalysisDue()) {
+            nextAnalysisMs = nowMs;
+        }
+        if ((long)(nowMs - nextAnalysisMs) < 0) {
+            continue;
+        }
+        while ((long)(nowMs - nextAnalysisMs) >= 0) {
+            nextAnalysisMs += MEASUREMENT_DELAY_MS;
+        }
+        if (tasks.analyze(nowMs)) {
+            tasks.display(nowMs);
+            stats.records++;
+        }
+    }
+}
+
+/**
+ * @brief Write a tester's buffered output (or drop it without a destination)
+ */
+void flush(TesterPort& port, int fd, FleetStats& stats) {
+    if (port.buffer.empty()) {
+        return;
+    }
+    stats.bytes += port.buffer.size();
+    size_t done = 0;
+    while (fd >= 0 && done < port.buffer.size()) {
+        ssize_t written = write(fd, port.buffer.data() + done, port.buffer.size() - done);
+        stats.writeCalls++;
+        if (written > 0) {
+            done += (size_t)written;
+        } else if (written < 0 && errno == EINTR) {
+            continue;
+        } else {
+            // A full PTY (nobody reading) or a hung-up reader: the bytes are lost
+            stats.droppedBytes += port.buffer.size() - done;
+            break;
+        }
+    }
+    port.buffer.clear();
+}
+
+/**
+ * @brief Raise the open file limit to the hard limit if count descriptors need it
+ */
+void reserveDescriptors(int count) {
+    struct rlimit limit;
+    if (getrlimit(RLIMIT_NOFILE, &limit) == 0 && limit.rlim_cur < (rlim_t)count + 64) {
+        limit.rlim_cur = limit.rlim_max;
+        setrlimit(RLIMIT_NOFILE, &limit);
+    }
+}
+
+bool makeDirectory(const char* directory) {
+    if (mkdir(directory, 0755) != 0 && errno != EEXIST) {
+        perror(directory);
+        return false;
+    }
+    return true;
+}
+
+} // namespace
+
+/**
+ * @brief The testers one worker thread owns, with their packs
+ */
+struct FleetShard {
+    int first;
+    std::vector<VirtualTester*> testers;
+    PackModel packs;
+    FleetStats stats;
+    
+    FleetShard(int first, int count) : first(first), packs(count, BLOCK_SECONDS) {
+        memset(&stats, 0, sizeof(stats));
+    }
+    
+    ~FleetShard() {
+        for (size_t i = 0; i < testers.size(); i++) {
+            delete testers[i];
+        }
+    }
+};
+
+FleetOptions::FleetOptions()
+    : testers(1000), threads(0), seconds(600.0), realtime(false), format(-1),
+      verbosity(DEBUG_LEVEL_DISPLAY), sessionSeconds(300.0), seed(1) {
+}
+
+FleetEmulator::FleetEmulator(const FleetOptions& options) : options(options) {
+    memset(&stats, 0, sizeof(stats));
+    // The nominal conversion VoltageReader::begin() sets up, shared read-only by all testers
+    VoltageReader::setVoltageDividerRatio((float)((VOLTAGE_DIVIDER_R1 + VOLTAGE_DIVIDER_R2) / VOLTAGE_DIVIDER_R2));
+    if (this->options.threads <= 0) {
+        this->options.threads = (int)std::thread::hardware_concurrency();
+    }
+    this->options.threads = std::max(1, std::min(this->options.threads, this->options.testers));
+    
+    int threads = this->options.threads;
+    for (int s = 0; s < threads; s++) {
+        int first = (int)((long long)this->options.testers * s / threads);
+        int end = (int)((long long)this->options.testers * (s + 1) / threads);
+        FleetShard* shard = new FleetShard(first, end - first);
+        
+        std::vector<PackSpec> specs;
+        for (int id = first; id < end; id++) {
+            shard->testers.push_back(new VirtualTester(id, this->options));
+            specs.push_back(shard->testers.back()->packSpec());
+        }
+        
+        // Packs grouped by cell count step fastest (see PackModel)
+        std::vector<int> order;
+        for (int i = 0; i < end - first; i++) {
+            order.push_back(i);
+        }
+        std::stable_sort(order.begin(), order.end(),
+                         [&specs](int a, int b) { return specs[a].cells < specs[b].cells; });
+        for (size_t i = 0; i < order.size(); i++) {
+            shard->testers[order[i]]->pack = shard->packs.addPack(specs[order[i]]);
+        }
+        shards.push_back(shard);
+    }
+    masters.assign(this->options.testers, -1);
+    paths.assign(this->options.testers, std::string());
+}
+
+FleetEmulator::~FleetEmulator() {
+    for (size_t i = 0; i < shards.size(); i++) {
+        delete shards[i];
+    }
+    for (size_t i = 0; i < masters.size(); i++) {
+        if (masters[i] >= 0) {
+            close(masters[i]);
+        }
+    }
+}
+
+bool FleetEmulator::openFiles(const char* directory) {
+    if (!makeDirectory(directory)) {
+        return false;
+    }
+    reserveDescriptors(options.testers);
+    for (int i = 0; i < options.testers; i++) {
+        char name[32];
+        snprintf(name, sizeof(name), "/tester-%04d.log", i + 1);
+        paths[i] = std::string(directory) + name;
+        masters[i] = open(paths[i].c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+        if (masters[i] < 0) {
+            perror(paths[i].c_str());
+            return false;
+        }
+    }
+    return true;
+}
+
+bool FleetEmulator::openPtys(const char* directory) {
+    if (!makeDirectory(directory)) {
+        return false;
+    }
+    reserveDescriptors(options.testers);
+    for (int i = 0; i < options.testers; i++) {
+        int master = posix_openpt(O_RDWR | O_NOCTTY | O_NONBLOCK | O_CLOEXEC);
+        if (master < 0 || grantpt(master) != 0 || unlockpt(master) != 0) {
+            if (master >= 0) {
+                close(master);
+            }
+            fprintf(stderr, "PTY limit reached after %d testers (see /proc/sys/kernel/pty/max)\n", i);
+            return false;
+        }
+        masters[i] = master;
+        const char* slavePath = ptsname(master);
+        
+        // Raw mode, so binary frames arrive unchanged whatever the reader sets
+        int slave = open(slavePath, O_RDWR | O_NOCTTY | O_CLOEXEC);
+        if (slave < 0) {
+            perror(slavePath);
+            return false;
+        }
+        struct termios settings;
+        if (tcgetattr(slave, &settings) == 0) {
+            cfmakeraw(&settings);
+            cfsetispeed(&settings, B115200);
+            cfsetospeed(&settings, B115200);
+            tcsetattr(slave, TCSANOW, &settings);
+        }
+        close(slave);
+        
+        char name[32];
+        snprintf(name, sizeof(name), "/tester-%04d", i + 1);
+        paths[i] = std::string(directory) + name;
+        unlink(paths[i].c_str());
+        if (symlink(slavePath, paths[i].c_str()) != 0) {
+            perror(paths[i].c_str());
+            return false;
+        }
+    }
+    return true;
+}
+
+const std::string& FleetEmulator::getPath(int tester) const {
+    return paths[tester];
+}
+
+void FleetEmulator::run(const volatile sig_atomic_t* stop) {
+    typedef std::chrono::steady_clock Clock;
+    Clock::time_point start = Clock::now();
+    long blocks = options.seconds > 0.0 ? (long)(options.seconds * 1000.0 / BLOCK_MS) : -1;
+    const std::vector<int>& fds = masters;
+    const FleetOptions& settings = options;
+    
+    std::vector<std::thread> workers;
+    for (size_t s = 0; s < shards.size(); s++) {
+        FleetShard* shard = shards[s];
+        workers.push_back(std::thread([shard, blocks, start, stop, &fds, &settings]() {
+            double cpuStart = threadCpuSeconds();
+            FleetStats& local = shard->stats;
+            long block = 0;
+            for (; (blocks < 0 || block < blocks) && !(stop && *stop); block++) {
+                double seconds = block * (double)BLOCK_SECONDS;
+                for (size_t i = 0; i < shard->testers.size(); i++) {
+                    VirtualTester& tester = *shard->testers[i];
+                    tester.runBlock(seconds, shard->packs.getPackVoltage(tester.pack), local);
+                    if (settings.realtime || tester.port.buffer.size() >= FLUSH_BYTES) {
+                        flush(tester.port, fds[shard->first + i], local);
+                    }
+                }
+                shard->packs.step();
+                
+                if (settings.realtime) {
+                    Clock::time_point due = start + std::chrono::milliseconds((block + 1) * BLOCK_MS);
+                    Clock::time_point now = Clock::now();
+                    if (now > due) {
+                        double lagMs = std::chrono::duration<double, std::milli>(now - due).count();
+                        local.maxLagMs = std::max(local.maxLagMs, lagMs);
+                    } else {
+                        std::this_thread::sleep_until(due);
+                    }
+                }
+            }
+            for (size_t i = 0; i < shard->testers.size(); i++) {
+                flush(shard->testers[i]->port, fds[shard->first + i], local);
+            }
+            local.deviceSeconds = block * (double)BLOCK_SECONDS;
+            local.cpuSeconds = threadCpuSeconds() - cpuStart;
+        }));
+    }
+    for (size_t i = 0; i < workers.size(); i++) {
+        workers[i].join();
+    }
+    
+    memset(&stats, 0, sizeof(stats));
+    stats.wallSeconds = std::chrono::duration<double>(Clock::now() - start).count();
+    for (size_t s = 0; s < shards.size(); s++) {
+        const FleetStats& local = shards[s]->stats;
+        stats.records += local.records;
+        stats.messages += local.messages;
+        stats.samples += local.samples;
+        stats.bytes += local.bytes;
+        stats.droppedBytes += local.droppedBytes;
+        stats.writeCalls += local.writeCalls;
+        stats.connects += local.connects;
+        stats.cpuSeconds += local.cpuSeconds;
+        stats.maxLagMs = std::max(stats.maxLagMs, local.maxLagMs);
+        stats.deviceSeconds = s == 0 ? local.deviceSeconds : std::min(stats.deviceSeconds, local.deviceSeconds);
+    }
+}
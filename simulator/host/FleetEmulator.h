@@ -0,0 +1,115 @@
+#ifndef FLEET_EMULATOR_H
+#define FLEET_EMULATOR_H
+
+#include <stdint.h>
+#include <signal.h>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Settings of a fleet run
+ */
+struct FleetOptions {
+    int testers;                // Virtual testers
+    int threads;                // Worker threads, each owning a contiguous shard of testers
+    double seconds;             // Device time to run
+    bool realtime;              // Pace device time to the wall clock (for live readers such as ingestd)
+    int format;                 // OUTPUT_FORMAT_*, or -1 to rotate text/CSV/binary over the testers
+    int verbosity;              // DEBUG_LEVEL_DISPLAY, or DEBUG_LEVEL_CALCULATED for the text blocks
+    double sessionSeconds;      // Mean time a pack stays plugged in
+    uint32_t seed;              // Packs, ADC units, clocks and plug times all follow from it
+    
+    FleetOptions();
+};
+
+/**
+ * @brief Totals of a fleet run
+ */
+struct FleetStats {
+    unsigned long long records;         // Measurements (CSV line, binary frame or display block)
+    unsigned long long messages;        // Connect/disconnect messages and CSV headers
+    unsigned long long samples;         // Single ADC samples taken
+    unsigned long long bytes;           // Serial bytes generated
+    unsigned long long droppedBytes;    // Bytes a full PTY did not take (nobody reading)
+    unsigned long long writeCalls;      // write() calls to files or PTYs
+    unsigned long connects;             // Plug-ins detected by the testers
+    double deviceSeconds;               // Device time each tester ran
+    double wallSeconds;
+    double cpuSeconds;                  // Worker threads' CPU time
+    double maxLagMs;                    // Realtime: furthest a worker fell behind the wall clock
+};
+
+struct FleetShard;
+
+/**
+ * @brief Thousands of virtual testers in one process, for loading the
+ * ingest daemon and storage with realistic device streams
+ *
+ * The firmware keeps its state in statics, so one process can boot only one
+ * copy of setup()/loop() (see TraceReplay). A virtual tester instead runs
+ * its own MeasurementTasks, the sampling, analysis and display task bodies
+ * main.cpp runs, on the scheduler's timing: a sample every
+ * CONNECTION_POLL_MS, the analysis every MEASUREMENT_DELAY_MS and at once
+ * on a new pack's first block. So the stream is byte for byte what a
+ * tester prints in the chosen format and verbosity, with its millis() clock.
+ *
+ * Each tester has:
+ * - its own pack in a PackModel (1S-6S, capacity, charge, load with
+ *   pulses and cutoff) and its own AdcModel unit (divider and reference
+ *   tolerances, noise), read through the nominal conversion like the firmware
+ * - its own clock: booted at a random time in the first seconds, with a
+ *   crystal error of up to +/-100 ppm
+ * - a plug schedule: the pack is connected for about sessionSeconds, then
+ *   removed for a few seconds, again and again
+ *
+ * Time advances in blocks of SAMPLE_RECORD_SAMPLES * CONNECTION_POLL_MS.
+ * Worker threads own contiguous shards (testers, packs, ports) and share
+ * nothing, so they only meet at the end of the run. Output is buffered per
+ * tester and written in large chunks; PTYs are non-blocking, and bytes a
+ * full PTY does not take are dropped and counted, like a serial adapter
+ * nobody reads.
+ */
+class FleetEmulator {
+public:
+    explicit FleetEmulator(const FleetOptions& options);
+    ~FleetEmulator();
+    
+    /**
+     * @brief Write each tester's serial output to <directory>/tester-NNNN.log
+     * @return false if a file cannot be created (message on stderr)
+     */
+    bool openFiles(const char* directory);
+    
+    /**
+     * @brief Give each tester a PTY in raw mode, linked as <directory>/tester-NNNN
+     *
+     * Readers open the links (ingestd <directory>/tester-*). The PTYs stay
+     * until the emulator is destroyed; closing them hangs up the readers.
+     * @return false if the PTYs or links cannot be created (message on stderr)
+     */
+    bool openPtys(const char* directory);
+    
+    /**
+     * @brief Run every tester for options.seconds of device time (once per emulator)
+     * @param stop Set (e.g. by a signal handler) to end the run early; with
+     *        seconds <= 0 the run only ends this way
+     */
+    void run(const volatile sig_atomic_t* stop = nullptr);
+    
+    const FleetStats& getStats() const { return stats; }
+    const FleetOptions& getOptions() const { return options; }
+    
+    /**
+     * @brief Path of a tester's output (file or PTY link), empty without outputs
+     */
+    const std::string& getPath(int tester) const;
+
+private:
+    FleetOptions options;
+    FleetStats stats;
+    std::vector<FleetShard*> shards;
+    std::vector<std::string> paths;
+    std::vector<int> masters;           // PTY masters and files, one per tester (-1 = discard)
+};
+
+#endif // FLEET_EMULATOR_H
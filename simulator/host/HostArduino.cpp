@@ -0,0 +1,509 @@
+#include "Arduino.h"
+#include <chrono>
+#include <string>
+#include "VirtualHardware.h"
+#include "Wire.h"
+
+namespace {
+
+struct BoardState {
+    uint64_t timeUs;
+    int analog[VIRTUAL_PIN_COUNT];
+    int analogMax;
+    int8_t mode[VIRTUAL_PIN_COUNT];       // -1 = never configured
+    int8_t forced[VIRTUAL_PIN_COUNT];     // Input level set by the harness, -1 = none
+    uint8_t output[VIRTUAL_PIN_COUNT];
+    std::string serialInput;
+    size_t serialRead;
+    FILE* serialOutput;
+    uint64_t serialBytes;
+    VirtualI2cDevice* devices[128];
+    uint64_t i2cTransactions;
+    uint64_t i2cBytes;
+    double cpuScale;
+    bool inFirmware;
+    std::chrono::steady_clock::time_point firmwareStart;
+    
+    BoardState()
+        : timeUs(0), analogMax(4095), serialRead(0), serialOutput(nullptr), serialBytes(0), i2cTransactions(0),
+          i2cBytes(0), cpuScale(0.0), inFirmware(false) {
+        for (int pin = 0; pin < VIRTUAL_PIN_COUNT; pin++) {
+            analog[pin] = 0;
+            mode[pin] = -1;
+            forced[pin] = -1;
+            output[pin] = LOW;
+        }
+        for (int address = 0; address < 128; address++) {
+            devices[address] = nullptr;
+        }
+    }
+};
+
+BoardState board;
+
+bool validPin(int pin) {
+    return pin >= 0 && pin < VIRTUAL_PIN_COUNT;
+}
+
+} // namespace
+
+void VirtualHardware::reset() {
+    board = BoardState();
+}
+
+uint64_t VirtualHardware::nowMicros() {
+    if (board.inFirmware && board.cpuScale > 0.0) {
+        std::chrono::duration<double, std::micro> spent = std::chrono::steady_clock::now() - board.firmwareStart;
+        return board.timeUs + (uint64_t)(spent.count() * board.cpuScale);
+    }
+    return board.timeUs;
+}
+
+void VirtualHardware::advanceMicros(uint64_t us) {
+    board.timeUs += us;
+}
+
+void VirtualHardware::setAnalogValue(int pin, int value) {
+    if (validPin(pin)) {
+        board.analog[pin] = value;
+    }
+}
+
+void VirtualHardware::setPinLevel(int pin, int level) {
+    if (validPin(pin)) {
+        board.forced[pin] = (int8_t)(level ? HIGH : LOW);
+    }
+}
+
+int VirtualHardware::getOutputLevel(int pin) {
+    return validPin(pin) ? board.output[pin] : LOW;
+}
+
+void VirtualHardware::queueSerialInput(const char* data, size_t length) {
+    // Drop what has been read so the buffer does not grow over a long run
+    board.serialInput.erase(0, board.serialRead);
+    board.serialRead = 0;
+    board.serialInput.append(data, length);
+}
+
+void VirtualHardware::setSerialOutput(FILE* file) {
+    board.serialOutput = file;
+}
+
+uint64_t VirtualHardware::getSerialBytes() {
+    return board.serialBytes;
+}
+
+void VirtualHardware::attachI2cDevice(uint8_t address, VirtualI2cDevice* device) {
+    board.devices[address & 0x7F] = device;
+}
+
+VirtualI2cDevice* VirtualHardware::getI2cDevice(uint8_t address) {
+    return board.devices[address & 0x7F];
+}
+
+uint64_t VirtualHardware::getI2cTransactions() {
+    return board.i2cTransactions;
+}
+
+uint64_t VirtualHardware::getI2cBytes() {
+    return board.i2cBytes;
+}
+
+void VirtualHardware::setCpuClockScale(double scale) {
+    board.cpuScale = scale;
+}
+
+void VirtualHardware::enterFirmware() {
+    board.inFirmware = true;
+    if (board.cpuScale > 0.0) {
+        board.firmwareStart = std::chrono::steady_clock::now();
+    }
+}
+
+void VirtualHardware::leaveFirmware() {
+    board.timeUs = nowMicros();
+    board.inFirmware = false;
+}
+
+void VirtualHardware::countI2c(size_t bytes) {
+    board.i2cTransactions++;
+    board.i2cBytes += bytes;
+}
+
+int VirtualHardware::readAnalog(int pin) {
+    if (!validPin(pin)) {
+        return 0;
+    }
+    int value = board.analog[pin];
+    return value < 0 ? 0 : value > board.analogMax ? board.analogMax : value;
+}
+
+void VirtualHardware::setAnalogBits(int bits) {
+    board.analogMax = (1 << bits) - 1;
+}
+
+void VirtualHardware::setPinMode(int pin, int mode) {
+    if (validPin(pin)) {
+        board.mode[pin] = (int8_t)mode;
+    }
+}
+
+int VirtualHardware::readPin(int pin) {
+    if (!validPin(pin)) {
+        return LOW;
+    }
+    if (board.forced[pin] >= 0) {
+        return board.forced[pin];
+    }
+    if (board.mode[pin] == OUTPUT) {
+        return board.output[pin];
+    }
+    return board.mode[pin] == INPUT_PULLUP ? HIGH : LOW;
+}
+
+void VirtualHardware::writePin(int pin, int level) {
+    if (validPin(pin)) {
+        board.output[pin] = (uint8_t)(level ? HIGH : LOW);
+    }
+}
+
+void VirtualHardware::writeSerial(const uint8_t* data, size_t length) {
+    board.serialBytes += length;
+    if (board.serialOutput) {
+        fwrite(data, 1, length, board.serialOutput);
+    }
+}
+
+int VirtualHardware::serialAvailable() {
+    return (int)(board.serialInput.size() - board.serialRead);
+}
+
+int VirtualHardware::readSerial() {
+    return serialAvailable() > 0 ? (uint8_t)board.serialInput[board.serialRead++] : -1;
+}
+
+int VirtualHardware::peekSerial() {
+    return serialAvailable() > 0 ? (uint8_t)board.serialInput[board.serialRead] : -1;
+}
+
+// Arduino core
+
+unsigned long millis() {
+    return (unsigned long)(VirtualHardware::nowMicros() / 1000);
+}
+
+unsigned long micros() {
+    return (unsigned long)VirtualHardware::nowMicros();
+}
+
+void delay(unsigned long ms) {
+    VirtualHardware::advanceMicros((uint64_t)ms * 1000);
+}
+
+void delayMicroseconds(unsigned int us) {
+    VirtualHardware::advanceMicros(us);
+}
+
+void yield() {
+}
+
+void pinMode(uint8_t pin, uint8_t mode) {
+    VirtualHardware::setPinMode(pin, mode);
+}
+
+int digitalRead(uint8_t pin) {
+    return VirtualHardware::readPin(pin);
+}
+
+void digitalWrite(uint8_t pin, uint8_t value) {
+    VirtualHardware::writePin(pin, value);
+}
+
+uint16_t analogRead(uint8_t pin) {
+    return (uint16_t)VirtualHardware::readAnalog(pin);
+}
+
+void analogReadResolution(uint8_t bits) {
+    VirtualHardware::setAnalogBits(bits);
+}
+
+// Print: same output as the Arduino core's Print.cpp
+
+size_t Print::write(const uint8_t* buffer, size_t size) {
+    size_t written = 0;
+    while (size--) {
+        written += write(*buffer++);
+    }
+    return written;
+}
+
+size_t Print::print(const char* text) {
+    return write(text);
+}
+
+size_t Print::print(const __FlashStringHelper* text) {
+    return write(reinterpret_cast<const char*>(text));
+}
+
+size_t Print::print(char c) {
+    return write((uint8_t)c);
+}
+
+size_t Print::print(unsigned char value, int base) {
+    return printNumber(value, base);
+}
+
+size_t Print::print(int value, int base) {
+    return print((long)value, base);
+}
+
+size_t Print::print(unsigned int value, int base) {
+    return printNumber(value, base);
+}
+
+size_t Print::print(long value, int base) {
+    if (base == DEC && value < 0) {
+        return write('-') + printNumber(0UL - (unsigned long)value, DEC);
+    }
+    return printNumber((unsigned long)value, base);
+}
+
+size_t Print::print(unsigned long value, int base) {
+    return printNumber(value, base);
+}
+
+size_t Print::print(long long value, int base) {
+    if (base == DEC && value < 0) {
+        return write('-') + printNumber(0ULL - (unsigned long long)value, DEC);
+    }
+    return printNumber((unsigned long long)value, base);
+}
+
+size_t Print::print(unsigned long long value, int base) {
+    return printNumber(value, base);
+}
+
+size_t Print::print(double value, int digits) {
+    return printFloat(value, digits);
+}
+
+size_t Print::println() {
+    return write("\r\n");
+}
+
+size_t Print::println(const char* text) {
+    return print(text) + println();
+}
+
+size_t Print::println(const __FlashStringHelper* text) {
+    return print(text) + println();
+}
+
+size_t Print::println(char c) {
+    return print(c) + println();
+}
+
+size_t Print::println(unsigned char value, int base) {
+    return print(value, base) + println();
+}
+
+size_t Print::println(int value, int base) {
+    return print(value, base) + println();
+}
+
+size_t Print::println(unsigned int value, int base) {
+    return print(value, base) + println();
+}
+
+size_t Print::println(long value, int base) {
+    return print(value, base) + println();
+}
+
+size_t Print::println(unsigned long value, int base) {
+    return print(value, base) + println();
+}
+
+size_t Print::println(long long value, int base) {
+    return print(value, base) + println();
+}
+
+size_t Print::println(unsigned long long value, int base) {
+    return print(value, base) + println();
+}
+
+size_t Print::println(double value, int digits) {
+    return print(value, digits) + println();
+}
+
+size_t Print::printNumber(unsigned long long value, int base) {
+    char text[8 * sizeof(value) + 1];
+    char* p = &text[sizeof(text) - 1];
+    *p = '\0';
+    if (base < 2) {
+        base = 10;
+    }
+    do {
+        int digit = (int)(value % base);
+        value /= base;
+        *--p = (char)(digit < 10 ? '0' + digit : 'A' + digit - 10);
+    } while (value);
+    return write(p);
+}
+
+size_t Print::printFloat(double value, int digits) {
+    if (isnan(value)) return print("nan");
+    if (isinf(value)) return print("inf");
+    if (value > 4294967040.0) return print("ovf");
+    if (value < -4294967040.0) return print("ovf");
+    
+    size_t n = 0;
+    if (value < 0.0) {
+        n += print('-');
+        value = -value;
+    }
+    
+    // Round at the last printed digit
+    double rounding = 0.5;
+    for (int i = 0; i < digits; i++) {
+        rounding /= 10.0;
+    }
+    value += rounding;
+    
+    unsigned long whole = (unsigned long)value;
+    double remainder = value - (double)whole;
+    n += print(whole);
+    if (digits > 0) {
+        n += print('.');
+    }
+    while (digits-- > 0) {
+        remainder *= 10.0;
+        unsigned int digit = (unsigned int)remainder;
+        n += print(digit);
+        remainder -= digit;
+    }
+    return n;
+}
+
+// Serial
+
+HardwareSerial Serial;
+
+void HardwareSerial::begin(unsigned long baud) {
+    (void)baud;
+}
+
+void HardwareSerial::end() {
+}
+
+int HardwareSerial::available() {
+    return VirtualHardware::serialAvailable();
+}
+
+int HardwareSerial::read() {
+    return VirtualHardware::readSerial();
+}
+
+int HardwareSerial::peek() {
+    return VirtualHardware::peekSerial();
+}
+
+void HardwareSerial::flush() {
+}
+
+size_t HardwareSerial::write(uint8_t c) {
+    VirtualHardware::writeSerial(&c, 1);
+    return 1;
+}
+
+size_t HardwareSerial::write(const uint8_t* buffer, size_t size) {
+    VirtualHardware::writeSerial(buffer, size);
+    return size;
+}
+
+// Wire
+
+TwoWire Wire;
+
+TwoWire::TwoWire() : clockHz(100000), address(0), length(0), readOffset(0), transmitting(false) {
+}
+
+bool TwoWire::begin() {
+    return true;
+}
+
+bool TwoWire::begin(int sda, int scl) {
+    (void)sda;
+    (void)scl;
+    return true;
+}
+
+void TwoWire::setClock(uint32_t hz) {
+    clockHz = hz > 0 ? hz : 100000;
+}
+
+uint32_t TwoWire::getClock() const {
+    return clockHz;
+}
+
+void TwoWire::beginTransmission(uint8_t target) {
+    address = target;
+    length = 0;
+    transmitting = true;
+}
+
+size_t TwoWire::write(uint8_t value) {
+    if (!transmitting || length >= sizeof(buffer)) {
+        return 0;
+    }
+    buffer[length++] = value;
+    return 1;
+}
+
+size_t TwoWire::write(const uint8_t* data, size_t count) {
+    size_t written = 0;
+    while (written < count && write(data[written])) {
+        written++;
+    }
+    return written;
+}
+
+namespace {
+
+/**
+ * @brief Bus time of a transaction: start, address and data bytes with acks, stop
+ */
+uint64_t busMicros(size_t bytes, uint32_t clockHz) {
+    return ((uint64_t)(1 + bytes) * 9 + 2) * 1000000ULL / clockHz;
+}
+
+} // namespace
+
+uint8_t TwoWire::endTransmission(bool sendStop) {
+    (void)sendStop;
+    transmitting = false;
+    VirtualI2cDevice* device = VirtualHardware::getI2cDevice(address);
+    bool acked = device && device->receive(buffer, length);
+    VirtualHardware::countI2c(acked ? length : 0);
+    VirtualHardware::advanceMicros(busMicros(acked ? length : 0, clockHz));
+    return acked ? 0 : 2;
+}
+
+uint8_t TwoWire::requestFrom(uint8_t target, uint8_t count, bool sendStop) {
+    (void)sendStop;
+    VirtualI2cDevice* device = VirtualHardware::getI2cDevice(target);
+    size_t limit = count < sizeof(buffer) ? count : sizeof(buffer);
+    length = device ? device->request(buffer, limit) : 0;
+    readOffset = 0;
+    VirtualHardware::countI2c(length);
+    VirtualHardware::advanceMicros(busMicros(length, clockHz));
+    return (uint8_t)length;
+}
+
+int TwoWire::available() {
+    return (int)(length - readOffset);
+}
+
+int TwoWire::read() {
+    return readOffset < length ? buffer[readOffset++] : -1;
+}
@@ -0,0 +1,273 @@
+#include <stdlib.h>
+#include <string.h>
+#include "Adafruit_SSD1306.h"
+
+namespace {
+
+// Classic 5x7 glyphs for 0x20-0x7E, one byte per column, LSB at the top
+const uint8_t FONT_FIRST = 0x20;
+const uint8_t FONT_LAST = 0x7E;
+const uint8_t FONT[(FONT_LAST - FONT_FIRST + 1) * 5] = {
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x5F, 0x00, 0x00, 0x00, 0x07, 0x00, 0x07, 0x00, // ' ' ! "
+    0x14, 0x7F, 0x14, 0x7F, 0x14, 0x24, 0x2A, 0x7F, 0x2A, 0x12, 0x23, 0x13, 0x08, 0x64, 0x62, // # $ %
+    0x36, 0x49, 0x56, 0x20, 0x50, 0x00, 0x08, 0x07, 0x03, 0x00, 0x00, 0x1C, 0x22, 0x41, 0x00, // & ' (
+    0x00, 0x41, 0x22, 0x1C, 0x00, 0x2A, 0x1C, 0x7F, 0x1C, 0x2A, 0x08, 0x08, 0x3E, 0x08, 0x08, // ) * +
+    0x00, 0x80, 0x70, 0x30, 0x00, 0x08, 0x08, 0x08, 0x08, 0x08, 0x00, 0x00, 0x60, 0x60, 0x00, // , - .
+    0x20, 0x10, 0x08, 0x04, 0x02, 0x3E, 0x51, 0x49, 0x45, 0x3E, 0x00, 0x42, 0x7F, 0x40, 0x00, // / 0 1
+    0x72, 0x49, 0x49, 0x49, 0x46, 0x21, 0x41, 0x49, 0x4D, 0x33, 0x18, 0x14, 0x12, 0x7F, 0x10, // 2 3 4
+    0x27, 0x45, 0x45, 0x45, 0x39, 0x3C, 0x4A, 0x49, 0x49, 0x31, 0x41, 0x21, 0x11, 0x09, 0x07, // 5 6 7
+    0x36, 0x49, 0x49, 0x49, 0x36, 0x46, 0x49, 0x49, 0x29, 0x1E, 0x00, 0x00, 0x14, 0x00, 0x00, // 8 9 :
+    0x00, 0x40, 0x34, 0x00, 0x00, 0x00, 0x08, 0x14, 0x22, 0x41, 0x14, 0x14, 0x14, 0x14, 0x14, // ; < =
+    0x00, 0x41, 0x22, 0x14, 0x08, 0x02, 0x01, 0x59, 0x09, 0x06, 0x3E, 0x41, 0x5D, 0x59, 0x4E, // > ? @
+    0x7C, 0x12, 0x11, 0x12, 0x7C, 0x7F, 0x49, 0x49, 0x49, 0x36, 0x3E, 0x41, 0x41, 0x41, 0x22, // A B C
+    0x7F, 0x41, 0x41, 0x41, 0x3E, 0x7F, 0x49, 0x49, 0x49, 0x41, 0x7F, 0x09, 0x09, 0x09, 0x01, // D E F
+    0x3E, 0x41, 0x41, 0x51, 0x73, 0x7F, 0x08, 0x08, 0x08, 0x7F, 0x00, 0x41, 0x7F, 0x41, 0x00, // G H I
+    0x20, 0x40, 0x41, 0x3F, 0x01, 0x7F, 0x08, 0x14, 0x22, 0x41, 0x7F, 0x40, 0x40, 0x40, 0x40, // J K L
+    0x7F, 0x02, 0x1C, 0x02, 0x7F, 0x7F, 0x04, 0x08, 0x10, 0x7F, 0x3E, 0x41, 0x41, 0x41, 0x3E, // M N O
+    0x7F, 0x09, 0x09, 0x09, 0x06, 0x3E, 0x41, 0x51, 0x21, 0x5E, 0x7F, 0x09, 0x19, 0x29, 0x46, // P Q R
+    0x26, 0x49, 0x49, 0x49, 0x32, 0x03, 0x01, 0x7F, 0x01, 0x03, 0x3F, 0x40, 0x40, 0x40, 0x3F, // S T U
+    0x1F, 0x20, 0x40, 0x20, 0x1F, 0x3F, 0x40, 0x38, 0x40, 0x3F, 0x63, 0x14, 0x08, 0x14, 0x63, // V W X
+    0x03, 0x04, 0x78, 0x04, 0x03, 0x61, 0x59, 0x49, 0x4D, 0x43, 0x00, 0x7F, 0x41, 0x41, 0x41, // Y Z [
+    0x02, 0x04, 0x08, 0x10, 0x20, 0x00, 0x41, 0x41, 0x41, 0x7F, 0x04, 0x02, 0x01, 0x02, 0x04, // \ ] ^
+    0x40, 0x40, 0x40, 0x40, 0x40, 0x00, 0x03, 0x07, 0x08, 0x00, 0x20, 0x54, 0x54, 0x78, 0x40, // _ ` a
+    0x7F, 0x28, 0x44, 0x44, 0x38, 0x38, 0x44, 0x44, 0x44, 0x28, 0x38, 0x44, 0x44, 0x28, 0x7F, // b c d
+    0x38, 0x54, 0x54, 0x54, 0x18, 0x00, 0x08, 0x7E, 0x09, 0x02, 0x18, 0xA4, 0xA4, 0x9C, 0x78, // e f g
+    0x7F, 0x08, 0x04, 0x04, 0x78, 0x00, 0x44, 0x7D, 0x40, 0x00, 0x20, 0x40, 0x40, 0x3D, 0x00, // h i j
+    0x7F, 0x10, 0x28, 0x44, 0x00, 0x00, 0x41, 0x7F, 0x40, 0x00, 0x7C, 0x04, 0x78, 0x04, 0x78, // k l m
+    0x7C, 0x08, 0x04, 0x04, 0x78, 0x38, 0x44, 0x44, 0x44, 0x38, 0xFC, 0x18, 0x24, 0x24, 0x18, // n o p
+    0x18, 0x24, 0x24, 0x18, 0xFC, 0x7C, 0x08, 0x04, 0x04, 0x08, 0x48, 0x54, 0x54, 0x54, 0x24, // q r s
+    0x04, 0x04, 0x3F, 0x44, 0x24, 0x3C, 0x40, 0x40, 0x20, 0x7C, 0x1C, 0x20, 0x40, 0x20, 0x1C, // t u v
+    0x3C, 0x40, 0x30, 0x40, 0x3C, 0x44, 0x28, 0x10, 0x28, 0x44, 0x4C, 0x90, 0x90, 0x90, 0x7C, // w x y
+    0x44, 0x64, 0x54, 0x4C, 0x44, 0x00, 0x08, 0x36, 0x41, 0x00, 0x00, 0x00, 0x77, 0x00, 0x00, // z { |
+    0x00, 0x41, 0x36, 0x08, 0x00, 0x02, 0x01, 0x02, 0x04, 0x02                                // } ~
+};
+
+// Bytes per Wire transaction, as the library sizes them for a 128-byte buffer
+const size_t WIRE_MAX = I2C_BUFFER_LENGTH - 1;
+
+} // namespace
+
+// Adafruit_GFX
+
+Adafruit_GFX::Adafruit_GFX(int16_t w, int16_t h)
+    : screenWidth(w), screenHeight(h), cursorX(0), cursorY(0), textColor(0xFFFF), textBackground(0xFFFF),
+      textSize(1), wrap(true) {
+}
+
+void Adafruit_GFX::drawFastVLine(int16_t x, int16_t y, int16_t h, uint16_t color) {
+    for (int16_t i = 0; i < h; i++) {
+        drawPixel(x, y + i, color);
+    }
+}
+
+void Adafruit_GFX::drawFastHLine(int16_t x, int16_t y, int16_t w, uint16_t color) {
+    for (int16_t i = 0; i < w; i++) {
+        drawPixel(x + i, y, color);
+    }
+}
+
+void Adafruit_GFX::fillRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color) {
+    for (int16_t i = x; i < x + w; i++) {
+        drawFastVLine(i, y, h, color);
+    }
+}
+
+void Adafruit_GFX::drawRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color) {
+    drawFastHLine(x, y, w, color);
+    drawFastHLine(x, y + h - 1, w, color);
+    drawFastVLine(x, y, h, color);
+    drawFastVLine(x + w - 1, y, h, color);
+}
+
+void Adafruit_GFX::fillScreen(uint16_t color) {
+    fillRect(0, 0, screenWidth, screenHeight, color);
+}
+
+void Adafruit_GFX::drawChar(int16_t x, int16_t y, unsigned char c, uint16_t color, uint16_t background,
+                            uint8_t size) {
+    if (x >= screenWidth || y >= screenHeight || x + 6 * size - 1 < 0 || y + 8 * size - 1 < 0) {
+        return;
+    }
+    bool known = c >= FONT_FIRST && c <= FONT_LAST;
+    for (int8_t i = 0; i < 5; i++) {
+        uint8_t line = known ? FONT[(c - FONT_FIRST) * 5 + i] : 0;
+        for (int8_t j = 0; j < 8; j++, line >>= 1) {
+            if (line & 1) {
+                fillRect(x + i * size, y + j * size, size, size, color);
+            } else if (background != color) {
+                fillRect(x + i * size, y + j * size, size, size, background);
+            }
+        }
+    }
+    if (background != color) {
+        fillRect(x + 5 * size, y, size, 8 * size, background);
+    }
+}
+
+void Adafruit_GFX::setCursor(int16_t x, int16_t y) {
+    cursorX = x;
+    cursorY = y;
+}
+
+void Adafruit_GFX::setTextSize(uint8_t size) {
+    textSize = size > 0 ? size : 1;
+}
+
+void Adafruit_GFX::setTextColor(uint16_t color) {
+    textColor = color;
+    textBackground = color;
+}
+
+void Adafruit_GFX::setTextColor(uint16_t color, uint16_t background) {
+    textColor = color;
+    textBackground = background;
+}
+
+void Adafruit_GFX::setTextWrap(bool enabled) {
+    wrap = enabled;
+}
+
+size_t Adafruit_GFX::write(uint8_t c) {
+    if (c == '\n') {
+        cursorX = 0;
+        cursorY += textSize * 8;
+    } else if (c != '\r') {
+        if (wrap && cursorX + textSize * 6 > screenWidth) {
+            cursorX = 0;
+            cursorY += textSize * 8;
+        }
+        drawChar(cursorX, cursorY, c, textColor, textBackground, textSize);
+        cursorX += textSize * 6;
+    }
+    return 1;
+}
+
+// Adafruit_SSD1306
+
+Adafruit_SSD1306::Adafruit_SSD1306(uint8_t w, uint8_t h, TwoWire* bus, int8_t resetPin, uint32_t during,
+                                   uint32_t after)
+    : Adafruit_GFX(w, h), wire(bus), buffer(nullptr), address(0), vccState(SSD1306_SWITCHCAPVCC),
+      clockDuring(during), clockAfter(after) {
+    (void)resetPin;
+}
+
+Adafruit_SSD1306::~Adafruit_SSD1306() {
+    free(buffer);
+}
+
+bool Adafruit_SSD1306::begin(uint8_t vcc, uint8_t i2cAddress, bool reset, bool periphBegin) {
+    (void)reset;
+    if (!buffer) {
+        buffer = (uint8_t*)malloc(screenWidth * ((screenHeight + 7) / 8));
+        if (!buffer) {
+            return false;
+        }
+    }
+    clearDisplay();
+    vccState = vcc;
+    address = i2cAddress ? i2cAddress : (screenHeight == 32 ? 0x3C : 0x3D);
+    if (periphBegin) {
+        wire->begin();
+    }
+    
+    bool external = vccState == SSD1306_EXTERNALVCC;
+    const uint8_t init[] = {
+        0xAE,                                       // Display off
+        0xD5, 0x80,                                 // Clock divide
+        0xA8, (uint8_t)(screenHeight - 1),          // Multiplex
+        0xD3, 0x00,                                 // Display offset
+        0x40,                                       // Start line 0
+        0x8D, (uint8_t)(external ? 0x10 : 0x14),    // Charge pump
+        0x20, 0x00,                                 // Horizontal addressing
+        0xA1,                                       // Segment remap
+        0xC8,                                       // COM scan descending
+        0xDA, (uint8_t)(screenHeight == 32 ? 0x02 : 0x12),
+        0x81, (uint8_t)(screenHeight == 32 ? 0x8F : external ? 0x9F : 0xCF),
+        0xD9, (uint8_t)(external ? 0x22 : 0xF1),    // Pre-charge
+        0xDB, 0x40,                                 // VCOMH deselect
+        0xA4,                                       // Show RAM
+        0xA6,                                       // Normal (not inverted)
+        0x2E,                                       // Scroll off
+        0xAF                                        // Display on
+    };
+    wire->setClock(clockDuring);
+    sendCommands(init, sizeof(init));
+    wire->setClock(clockAfter);
+    return true;
+}
+
+void Adafruit_SSD1306::display() {
+    const uint8_t window[] = {0x22, 0x00, 0xFF, 0x21, 0x00, (uint8_t)(screenWidth - 1)};
+    wire->setClock(clockDuring);
+    sendCommands(window, sizeof(window));
+    
+    size_t count = screenWidth * ((screenHeight + 7) / 8);
+    const uint8_t* data = buffer;
+    while (count > 0) {
+        size_t chunk = count < WIRE_MAX ? count : WIRE_MAX;
+        wire->beginTransmission(address);
+        wire->write((uint8_t)0x40);
+        wire->write(data, chunk);
+        wire->endTransmission();
+        data += chunk;
+        count -= chunk;
+    }
+    wire->setClock(clockAfter);
+}
+
+void Adafruit_SSD1306::clearDisplay() {
+    if (buffer) {
+        memset(buffer, 0, screenWidth * ((screenHeight + 7) / 8));
+    }
+}
+
+void Adafruit_SSD1306::invertDisplay(bool invert) {
+    const uint8_t command = invert ? 0xA7 : 0xA6;
+    wire->setClock(clockDuring);
+    sendCommands(&command, 1);
+    wire->setClock(clockAfter);
+}
+
+void Adafruit_SSD1306::dim(bool dimmed) {
+    const uint8_t commands[] = {0x81, (uint8_t)(dimmed ? 0x00 : vccState == SSD1306_EXTERNALVCC ? 0x9F : 0xCF)};
+    wire->setClock(clockDuring);
+    sendCommands(commands, sizeof(commands));
+    wire->setClock(clockAfter);
+}
+
+void Adafruit_SSD1306::drawPixel(int16_t x, int16_t y, uint16_t color) {
+    if (!buffer || x < 0 || x >= screenWidth || y < 0 || y >= screenHeight) {
+        return;
+    }
+    uint8_t* cell = &buffer[x + (y / 8) * screenWidth];
+    uint8_t bit = (uint8_t)(1 << (y & 7));
+    switch (color) {
+        case SSD1306_WHITE: *cell |= bit; break;
+        case SSD1306_BLACK: *cell &= ~bit; break;
+        case SSD1306_INVERSE: *cell ^= bit; break;
+    }
+}
+
+bool Adafruit_SSD1306::getPixel(int16_t x, int16_t y) const {
+    if (!buffer || x < 0 || x >= screenWidth || y < 0 || y >= screenHeight) {
+        return false;
+    }
+    return (buffer[x + (y / 8) * screenWidth] >> (y & 7)) & 1;
+}
+
+uint8_t* Adafruit_SSD1306::getBuffer() {
+    return buffer;
+}
+
+void Adafruit_SSD1306::sendCommands(const uint8_t* commands, size_t count) {
+    // One command stream (control byte 0x00) per transaction
+    while (count > 0) {
+        size_t chunk = count < WIRE_MAX ? count : WIRE_MAX;
+        wire->beginTransmission(address);
+        wire->write((uint8_t)0x00);
+        wire->write(commands, chunk);
+        wire->endTransmission();
+        commands += chunk;
+        count -= chunk;
+    }
+}
@@ -0,0 +1,137 @@
+#include <map>
+#include <string>
+#include <vector>
+#include <string.h>
+#include "Preferences.h"
+#include "esp_partition.h"
+
+namespace {
+
+typedef std::map<std::string, std::vector<uint8_t> > Namespace;
+
+std::map<std::string, Namespace>& store() {
+    static std::map<std::string, Namespace> namespaces;
+    return namespaces;
+}
+
+const esp_partition_t SPIFFS_PARTITION = {
+    ESP_PARTITION_TYPE_DATA, ESP_PARTITION_SUBTYPE_DATA_SPIFFS, 0x290000, HOST_SPIFFS_PARTITION_SIZE, "spiffs", false
+};
+
+std::vector<uint8_t>& flash() {
+    static std::vector<uint8_t> bytes(HOST_SPIFFS_PARTITION_SIZE, 0xFF);
+    return bytes;
+}
+
+bool inRange(const esp_partition_t* partition, size_t offset, size_t size) {
+    return partition == &SPIFFS_PARTITION && offset <= partition->size && size <= partition->size - offset;
+}
+
+} // namespace
+
+// Preferences
+
+Preferences::Preferences() : space(nullptr), readOnly(false) {
+}
+
+Preferences::~Preferences() {
+    end();
+}
+
+bool Preferences::begin(const char* name, bool openReadOnly) {
+    if (!name || strlen(name) > 15) {
+        return false;
+    }
+    // NVS cannot open a namespace read-only before anything was written to it
+    if (openReadOnly && store().find(name) == store().end()) {
+        return false;
+    }
+    space = store().insert(std::make_pair(std::string(name), Namespace())).first->first.c_str();
+    readOnly = openReadOnly;
+    return true;
+}
+
+void Preferences::end() {
+    space = nullptr;
+}
+
+size_t Preferences::getBytes(const char* key, void* buffer, size_t length) {
+    if (!space) {
+        return 0;
+    }
+    Namespace& values = store()[space];
+    Namespace::const_iterator found = values.find(key);
+    if (found == values.end() || !buffer || found->second.size() > length) {
+        return 0;
+    }
+    memcpy(buffer, found->second.data(), found->second.size());
+    return found->second.size();
+}
+
+size_t Preferences::putBytes(const char* key, const void* value, size_t length) {
+    if (!space || readOnly || !key || strlen(key) > 15) {
+        return 0;
+    }
+    const uint8_t* bytes = (const uint8_t*)value;
+    store()[space][key].assign(bytes, bytes + length);
+    return length;
+}
+
+bool Preferences::remove(const char* key) {
+    return space && !readOnly && store()[space].erase(key) > 0;
+}
+
+bool Preferences::clear() {
+    if (!space || readOnly) {
+        return false;
+    }
+    store()[space].clear();
+    return true;
+}
+
+void Preferences::eraseAll() {
+    store().clear();
+}
+
+// Partition
+
+const esp_partition_t* esp_partition_find_first(esp_partition_type_t type, esp_partition_subtype_t subtype,
+                                                const char* label) {
+    if (type != SPIFFS_PARTITION.type || subtype != SPIFFS_PARTITION.subtype ||
+        (label && strcmp(label, SPIFFS_PARTITION.label) != 0)) {
+        return nullptr;
+    }
+    return &SPIFFS_PARTITION;
+}
+
+esp_err_t esp_partition_read(const esp_partition_t* partition, size_t offset, void* destination, size_t size) {
+    if (!inRange(partition, offset, size)) {
+        return ESP_ERR_INVALID_SIZE;
+    }
+    memcpy(destination, &flash()[offset], size);
+    return ESP_OK;
+}
+
+esp_err_t esp_partition_write(const esp_partition_t* partition, size_t offset, const void* source, size_t size) {
+    if (!inRange(partition, offset, size)) {
+        return ESP_ERR_INVALID_SIZE;
+    }
+    const uint8_t* bytes = (const uint8_t*)source;
+    for (size_t i = 0; i < size; i++) {
+        flash()[offset + i] &= bytes[i];     // Programming only clears bits
+    }
+    return ESP_OK;
+}
+
+esp_err_t esp_partition_erase_range(const esp_partition_t* partition, size_t offset, size_t size) {
+    if (!inRange(partition, offset, size) || offset % ESP_PARTITION_SECTOR_SIZE != 0 ||
+        size % ESP_PARTITION_SECTOR_SIZE != 0) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    memset(&flash()[offset], 0xFF, size);
+    return ESP_OK;
+}
+
+void host_partition_erase_all() {
+    std::fill(flash().begin(), flash().end(), 0xFF);
+}
@@ -0,0 +1,579 @@
+#include "ParamTuner.h"
+#include <algorithm>
+#include <atomic>
+#include <math.h>
+#include <random>
+#include <stdio.h>
+#include <thread>
+#include "Arduino.h"
+#include "config.h"
+#include "MeasurementTasks.h"
+#include "ReplaySource.h"
+#include "../PackModel.h"
+
+namespace {
+
+// Bus bytes of one display frame (display_golden: 33 transactions, 551 bytes)
+const double FRAME_BUS_BYTES = 551.0;
+
+// A pack is plugged in this long after boot, and removed this long before the end
+const float PLUG_MIN_SECONDS = 0.5f;
+const float PLUG_MAX_SECONDS = 1.5f;
+const float UNPLUG_BEFORE_END_SECONDS = 3.0f;
+
+// Contact bounce at plug-in and removal: the contact is open on random samples
+const float BOUNCE_MAX_MS = 20.0f;
+
+/**
+ * @brief Serial port nobody reads: the tasks run with their output off
+ */
+class DiscardPort : public Print {
+public:
+    using Print::write;
+    
+    size_t write(uint8_t) override {
+        return 1;
+    }
+};
+
+/**
+ * @brief The firmware's tasks with the board's nominal conversion, which
+ * differs from the host build's where the board's ADC does
+ */
+class BoardTasks : public MeasurementTasks {
+public:
+    BoardTasks(SampleSource& source, Print& out, float voltsPerCount)
+        : MeasurementTasks(source, out), voltsPerCount(voltsPerCount) {}
+
+protected:
+    float toBatteryVoltage(int rawValue) const override {
+        return rawValue * voltsPerCount;
+    }
+
+private:
+    float voltsPerCount;
+};
+
+/**
+ * @brief VoltageReader's nominal conversion with the board's macros
+ * @return Battery volts per ADC count
+ */
+float batteryVoltsPerCount(const AdcModelConfig& adc) {
+    int maxCode = (1 << adc.bits) - 1;
+    return adc.vrefVolts / maxCode * (adc.dividerHighOhms + adc.dividerLowOhms) / adc.dividerLowOhms;
+}
+
+/**
+ * @brief One candidate's totals over the sessions
+ */
+struct Totals {
+    double answerMs;
+    double ageIntegral;             // Age of the shown reading integrated over time (ms * ms)
+    double shownMs;
+    double errorSquares;
+    long errorFrames;
+    long flickerChanges;
+    double restMinutes;
+    long frames;
+    double connectedSeconds;
+    int wrongSessions;
+    int missedSessions;
+    int spuriousEvents;
+};
+
+} // namespace
+
+/**
+ * @brief One plug-in scenario as the board's ADC sees it
+ */
+struct TunerSession {
+    int cells;
+    bool resting;                   // No load: the display should stand still
+    unsigned long plugMs;           // Contact first closes
+    unsigned long unplugMs;         // Contact first opens
+    std::vector<uint16_t> raw;      // One code per CONNECTION_POLL_MS from boot
+    std::vector<float> settled;     // Noise-free reading of the pack at each sample
+};
+
+TunerLimits::TunerLimits()
+    : maxVoltageErrorV(-1.0), maxFlickerPerMinute(-1.0), maxWrongSessions(0), maxMissedSessions(0) {
+}
+
+TunerOptions::TunerOptions() : sessions(36), sessionSeconds(60.0), threads(0), seed(1) {
+}
+
+TunerBoard TunerBoard::esp32c3() {
+    TunerBoard board;
+    board.name = "esp32c3";
+    board.title = "ESP32-C3";
+    // Calibrated (ADC_VREF or a calibration table): the C3's noise, 1/f noise and DNL remain
+    AdcModelConfig uncalibrated = AdcModelConfig::esp32c3();
+    board.adc = AdcModelConfig();
+    board.adc.dividerHighOhms = (float)VOLTAGE_DIVIDER_R1;
+    board.adc.dividerLowOhms = (float)VOLTAGE_DIVIDER_R2;
+    board.adc.resistorTolerance = 0.002f;
+    board.adc.vrefVolts = (float)ADC_VREF;
+    board.adc.vrefTolerance = 0.002f;
+    board.adc.noiseCounts = uncalibrated.noiseCounts;
+    board.adc.flickerCounts = uncalibrated.flickerCounts;
+    board.adc.dnlCounts = uncalibrated.dnlCounts;
+    // Conversion as in bench_balance; analysis and a frame drawn without an FPU
+    board.sampleUs = 40.0;
+    board.measurementUs = 600.0;
+    board.defaults.samplesPerBlock = 10;
+    board.defaults.periodMs = 500;
+    board.defaults.debounceSamples = 3;
+    board.defaults.tracker.noiseSigma = 0.05f;
+    // The tracker cannot be surer of a reading than the ADC resolves it
+    board.minNoiseSigma = batteryVoltsPerCount(board.adc);
+    board.minLockReadings = 2;
+    return board;
+}
+
+TunerBoard TunerBoard::proMini() {
+    TunerBoard board;
+    board.name = "pro_mini";
+    board.title = "Pro Mini";
+    board.adc = AdcModelConfig();
+    board.adc.dividerHighOhms = (float)VOLTAGE_DIVIDER_R1;
+    board.adc.dividerLowOhms = (float)VOLTAGE_DIVIDER_R2;
+    board.adc.resistorTolerance = 0.01f;
+    board.adc.vrefVolts = 5.0f;
+    board.adc.vrefTolerance = 0.02f;   // The regulator is the reference
+    board.adc.bits = 10;
+    board.adc.offsetCounts = 1.0f;
+    board.adc.noiseCounts = 0.5f;
+    board.adc.flickerCounts = 0.2f;
+    board.adc.dnlCounts = 0.3f;
+    // analogRead() at 8 MHz as in bench_balance; soft-float analysis and drawing
+    board.sampleUs = 112.0;
+    board.measurementUs = 12000.0;
+    board.defaults.samplesPerBlock = 20;
+    board.defaults.periodMs = 1000;
+    board.defaults.debounceSamples = 3;
+    board.defaults.tracker.noiseSigma = 0.08f;
+    // 37.6 mV per count, above the grid's finest noise model
+    board.minNoiseSigma = batteryVoltsPerCount(board.adc);
+    board.minLockReadings = 2;
+    return board;
+}
+
+ParamTuner::ParamTuner(const TunerBoard& board, const TunerOptions& options) : board(board), options(options) {
+    if (this->options.threads <= 0) {
+        this->options.threads = (int)std::thread::hardware_concurrency();
+    }
+    this->options.threads = std::max(1, this->options.threads);
+    
+    voltsPerCount = batteryVoltsPerCount(board.adc);
+    connectRaw = (int)(CONNECT_THRESHOLD_V / voltsPerCount);
+    disconnectRaw = (int)(DISCONNECT_THRESHOLD_V / voltsPerCount);
+    baseline.candidate = board.defaults;
+    buildSessions();
+}
+
+ParamTuner::~ParamTuner() {
+    for (size_t i = 0; i < sessions.size(); i++) {
+        delete sessions[i];
+    }
+}
+
+void ParamTuner::buildSessions() {
+    std::mt19937 rng(options.seed);
+    std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+    int samples = (int)(options.sessionSeconds * 1000.0 / CONNECTION_POLL_MS);
+    PackModel packs(options.sessions, CONNECTION_POLL_MS / 1000.0f);
+    std::vector<int> packIndex;
+    
+    // Every cell count equally often, alternately resting and discharging
+    for (int s = 0; s < options.sessions; s++) {
+        TunerSession* session = new TunerSession();
+        session->cells = 1 + s % MAX_CELLS;
+        session->resting = (s / MAX_CELLS) % 2 == 0;
+        session->plugMs = (unsigned long)(1000.0f * (PLUG_MIN_SECONDS + unit(rng) * (PLUG_MAX_SECONDS - PLUG_MIN_SECONDS)));
+        session->unplugMs = (unsigned long)(1000.0 * (options.sessionSeconds - UNPLUG_BEFORE_END_SECONDS));
+        
+        PackSpec spec;
+        spec.cells = session->cells;
+        spec.capacityAh = 0.5f + 4.5f * unit(rng);
+        spec.initialSoc = 0.1f + 0.9f * unit(rng);
+        spec.imbalance = 0.05f * unit(rng);
+        spec.seed = (uint32_t)rng();
+        if (!session->resting) {
+            spec.load.baseAmps = spec.capacityAh * (0.3f + 1.7f * unit(rng));
+            spec.load.pulseAmps = spec.capacityAh * (1.0f + 2.0f * unit(rng));
+            spec.load.periodSeconds = 10.0f + 20.0f * unit(rng);
+            spec.load.pulseSeconds = 1.0f + 3.0f * unit(rng);
+            spec.load.phaseSeconds = spec.load.periodSeconds * unit(rng);
+        }
+        packIndex.push_back(packs.addPack(spec));
+        session->raw.resize(samples);
+        session->settled.resize(samples);
+        sessions.push_back(session);
+    }
+    
+    // Bounce lengths and contact states come from the same stream, so every
+    // candidate sees the same plug-ins
+    std::vector<AdcModel> units;
+    std::vector<unsigned long> plugBounceMs;
+    std::vector<unsigned long> unplugBounceMs;
+    for (int s = 0; s < options.sessions; s++) {
+        units.push_back(AdcModel(board.adc, ((uint64_t)options.seed << 32) | (uint32_t)s));
+        plugBounceMs.push_back((unsigned long)(BOUNCE_MAX_MS * unit(rng)));
+        unplugBounceMs.push_back((unsigned long)(BOUNCE_MAX_MS * unit(rng)));
+    }
+    for (int k = 0; k < samples; k++) {
+        unsigned long nowMs = (unsigned long)k * CONNECTION_POLL_MS;
+        for (int s = 0; s < options.sessions; s++) {
+            TunerSession& session = *sessions[s];
+            float packVolts = packs.getPackVoltage(packIndex[s]);
+            bool contact = nowMs >= session.plugMs && nowMs < session.unplugMs + unplugBounceMs[s];
+            if ((nowMs < session.plugMs + plugBounceMs[s] || nowMs >= session.unplugMs) && contact) {
+                contact = unit(rng) < 0.5f;
+            }
+            session.raw[k] = units[s].sample(contact ? packVolts : 0.0f);
+            session.settled[k] = units[s].transfer(packVolts) * voltsPerCount;
+        }
+        packs.step();
+    }
+}
+
+std::vector<TunerCandidate> ParamTuner::grid(bool quick) const {
+    static const int BLOCK_SAMPLES[] = { 2, 5, 10, 20, 40 };
+    static const int PERIODS_MS[] = { 100, 200, 250, 400, 500, 750, 1000, 1500 };
+    static const int DEBOUNCE[] = { 1, 2, 3, 5 };
+    static const float SIGMAS[] = { 0.03f, 0.05f, 0.08f, 0.12f };
+    static const int AVERAGED[] = { 4, 8, 16, 32 };
+    static const int LOCK_READINGS[] = { 1, 2, 3 };
+    static const float LOCK_CONFIDENCE[] = { 0.75f, 0.8f, 0.9f };
+    
+    std::vector<TunerCandidate> candidates;
+    for (size_t b = 0; b < sizeof(BLOCK_SAMPLES) / sizeof(BLOCK_SAMPLES[0]); b++)
+    for (size_t p = 0; p < sizeof(PERIODS_MS) / sizeof(PERIODS_MS[0]); p++)
+    for (size_t d = 0; d < sizeof(DEBOUNCE) / sizeof(DEBOUNCE[0]); d++)
+    for (size_t s = 0; s < sizeof(SIGMAS) / sizeof(SIGMAS[0]); s++)
+    for (size_t a = 0; a < sizeof(AVERAGED) / sizeof(AVERAGED[0]); a++)
+    for (size_t r = 0; r < sizeof(LOCK_READINGS) / sizeof(LOCK_READINGS[0]); r++)
+    for (size_t c = 0; c < sizeof(LOCK_CONFIDENCE) / sizeof(LOCK_CONFIDENCE[0]); c++) {
+        // The quick grid takes every other value, and the hand-picked
+        // sampling so the tracker settings are also tried on what ships
+        if (quick && ((b % 2 && BLOCK_SAMPLES[b] != board.defaults.samplesPerBlock) ||
+                      (p % 2 && PERIODS_MS[p] != board.defaults.periodMs) ||
+                      (d % 2 && DEBOUNCE[d] != board.defaults.debounceSamples) || s % 2 || a % 2 || c % 2)) {
+            continue;
+        }
+        TunerCandidate candidate;
+        candidate.samplesPerBlock = BLOCK_SAMPLES[b];
+        candidate.periodMs = PERIODS_MS[p];
+        candidate.debounceSamples = DEBOUNCE[d];
+        candidate.tracker.noiseSigma = SIGMAS[s];
+        candidate.tracker.maxAveraged = AVERAGED[a];
+        candidate.tracker.lockReadings = LOCK_READINGS[r];
+        candidate.tracker.lockConfidence = LOCK_CONFIDENCE[c];
+        
+        // Below the board's floors the tracker would trust one reading, or
+        // a reading finer than a count, and lock on noise
+        if (candidate.tracker.noiseSigma < board.minNoiseSigma ||
+            candidate.tracker.lockReadings < board.minLockReadings) {
+            continue;
+        }
+        
+        // What "$samples" and "$period" accept: at least one block per
+        // analysis, and no more blocks than the sample queue holds
+        int blockMs = candidate.samplesPerBlock * CONNECTION_POLL_MS;
+        if (candidate.samplesPerBlock > COMMAND_MAX_SAMPLES || candidate.periodMs < COMMAND_MIN_PERIOD_MS ||
+            candidate.periodMs < blockMs || candidate.periodMs > blockMs * SAMPLE_QUEUE_DEPTH) {
+            continue;
+        }
+        candidates.push_back(candidate);
+    }
+    return candidates;
+}
+
+TunerScore ParamTuner::evaluate(const TunerCandidate& candidate) const {
+    Totals totals = {};
+    DiscardPort port;
+    
+    for (size_t s = 0; s < sessions.size(); s++) {
+        const TunerSession& session = *sessions[s];
+        ReplaySource source;
+        BoardTasks tasks(source, port, voltsPerCount);
+        tasks.setOutput(DEBUG_LEVEL_NONE, OUTPUT_FORMAT_TEXT);
+        tasks.getWatcher().configure(connectRaw, disconnectRaw, candidate.debounceSamples);
+        tasks.getTracker().tune(candidate.tracker);
+        tasks.getSampler().setSamplesPerBlock(candidate.samplesPerBlock);
+        
+        // The tasks as main.cpp schedules them: a sample every
+        // CONNECTION_POLL_MS, the analysis on its period grid (moved by the
+        // first block of a new pack) with the display right after it
+        unsigned long releaseMs = 0;
+        unsigned long firstBlockMs = 0;
+        unsigned long lastBlockMs = 0;
+        int blocks = 0;
+        unsigned long answerMs = 0;
+        bool answered = false;
+        unsigned long frameMs = 0;
+        unsigned long dataMs = 0;
+        bool framed = false;
+        bool wrongShown = false;
+        int connects = 0;
+        int disconnects = 0;
+        int shownCells = -1;            // Cell count and charge on the screen (-1 = none)
+        int shownCharge = -1;
+        
+        for (size_t k = 0; k < session.raw.size(); k++) {
+            unsigned long nowMs = (unsigned long)k * CONNECTION_POLL_MS;
+            source.feed(session.raw[k]);
+            ConnectionEvent event = tasks.sample(nowMs);
+            if (event == CONNECTION_CONNECTED) {
+                connects++;
+                blocks = 0;
+            } else if (event == CONNECTION_DISCONNECTED) {
+                disconnects++;
+                totals.frames++;        // "No battery" screen
+                shownCells = -1;
+                shownCharge = -1;
+            }
+            
+            // The blocks the next analysis averages (the window behind the shown reading)
+            if (tasks.getSampler().blockCompleted()) {
+                firstBlockMs = blocks == 0 ? nowMs : firstBlockMs;
+                lastBlockMs = nowMs;
+                blocks++;
+            }
+            if (tasks.isAnalysisDue()) {
+                releaseMs = nowMs;
+            }
+            if ((long)(nowMs - releaseMs) < 0) {
+                continue;
+            }
+            while ((long)(nowMs - releaseMs) >= 0) {
+                releaseMs += candidate.periodMs;
+            }
+            if (!tasks.analyze(nowMs)) {
+                continue;
+            }
+            blocks = 0;
+            
+            totals.frames++;
+            tasks.display(nowMs);
+            if (nowMs >= session.unplugMs) {
+                continue;
+            }
+            const BatteryInfo& info = tasks.getInfo();
+            bool locked = info.isValid && tasks.getTracker().isLocked();
+            if (locked && info.cellCount != session.cells) {
+                wrongShown = true;
+            }
+            if (info.isValid) {
+                float error = tasks.getVoltage() - session.settled[k];
+                totals.errorSquares += error * error;
+                totals.errorFrames++;
+                
+                // The previous reading was shown until now, growing older
+                if (framed) {
+                    double shownMs = nowMs - frameMs;
+                    totals.ageIntegral += (frameMs - dataMs) * shownMs + shownMs * shownMs / 2.0;
+                    totals.shownMs += shownMs;
+                }
+                unsigned long windowStartMs = firstBlockMs - (candidate.samplesPerBlock - 1) * CONNECTION_POLL_MS;
+                dataMs = windowStartMs + (lastBlockMs - windowStartMs) / 2;
+                frameMs = nowMs;
+                framed = true;
+            }
+            
+            // Flicker is what a reader sees jump on a resting pack: the cell
+            // count or the charge, not the last digit of the voltage
+            int cells = info.isValid ? info.cellCount : 0;
+            int charge = info.isValid ? info.chargePercentage : -1;
+            if (answered && session.resting && (cells != shownCells || charge != shownCharge)) {
+                totals.flickerChanges++;
+            }
+            if (!answered && locked && info.cellCount == session.cells) {
+                answered = true;
+                answerMs = nowMs;
+            }
+            shownCells = cells;
+            shownCharge = charge;
+        }
+        
+        if (answered) {
+            totals.answerMs += answerMs - session.plugMs;
+            if (session.resting) {
+                totals.restMinutes += (session.unplugMs - answerMs) / 60000.0;
+            }
+        } else {
+            totals.answerMs += session.unplugMs - session.plugMs;
+            totals.missedSessions++;
+        }
+        if (wrongShown) {
+            totals.wrongSessions++;
+        }
+        totals.spuriousEvents += abs(connects - 1) + abs(disconnects - 1);
+        totals.connectedSeconds += (session.unplugMs - session.plugMs) / 1000.0;
+    }
+    
+    TunerScore score;
+    double seconds = totals.connectedSeconds > 0.0 ? totals.connectedSeconds : 1.0;
+    double framesPerSecond = totals.frames / seconds;
+    score.answerMs = sessions.empty() ? 0.0 : totals.answerMs / sessions.size();
+    score.updateMs = totals.shownMs > 0.0 ? totals.ageIntegral / totals.shownMs : 0.0;
+    score.cpuPercent = (1000.0 / CONNECTION_POLL_MS * board.sampleUs + framesPerSecond * board.measurementUs) / 1e4;
+    score.i2cBytesPerSecond = framesPerSecond * FRAME_BUS_BYTES;
+    score.voltageErrorV = totals.errorFrames > 0 ? sqrt(totals.errorSquares / totals.errorFrames) : 0.0;
+    score.flickerPerMinute = totals.restMinutes > 0.0 ? totals.flickerChanges / totals.restMinutes : 0.0;
+    score.wrongSessions = totals.wrongSessions;
+    score.missedSessions = totals.missedSessions;
+    score.spuriousEvents = totals.spuriousEvents;
+    score.feasible = false;
+    return score;
+}
+
+bool ParamTuner::checkLimits(TunerScore& score) const {
+    const TunerLimits& limits = options.limits;
+    score.feasible = score.spuriousEvents == 0 &&
+                     score.voltageErrorV <= limits.maxVoltageErrorV + 1e-9 &&
+                     score.flickerPerMinute <= limits.maxFlickerPerMinute + 1e-9 &&
+                     score.wrongSessions <= limits.maxWrongSessions &&
+                     score.missedSessions <= limits.maxMissedSessions;
+    return score.feasible;
+}
+
+void ParamTuner::search(const std::vector<TunerCandidate>& candidates) {
+    baseline.score = evaluate(baseline.candidate);
+    TunerLimits& limits = options.limits;
+    if (limits.maxVoltageErrorV < 0.0) {
+        limits.maxVoltageErrorV = baseline.score.voltageErrorV;
+    }
+    if (limits.maxFlickerPerMinute < 0.0) {
+        limits.maxFlickerPerMinute = baseline.score.flickerPerMinute;
+    }
+    checkLimits(baseline.score);
+    
+    results.assign(candidates.size(), TunerResult());
+    std::atomic<size_t> next(0);
+    std::vector<std::thread> workers;
+    for (int t = 0; t < options.threads; t++) {
+        workers.push_back(std::thread([this, &candidates, &next]() {
+            for (size_t i = next++; i < candidates.size(); i = next++) {
+                results[i].candidate = candidates[i];
+                results[i].score = evaluate(candidates[i]);
+                checkLimits(results[i].score);
+            }
+        }));
+    }
+    for (size_t t = 0; t < workers.size(); t++) {
+        workers[t].join();
+    }
+    
+    // The hand-picked values compete too (last, so a grid copy wins ties)
+    results.push_back(baseline);
+}
+
+std::vector<int> ParamTuner::paretoFront() const {
+    std::vector<int> front;
+    for (size_t i = 0; i < results.size(); i++) {
+        const TunerScore& a = results[i].score;
+        if (!a.feasible) {
+            continue;
+        }
+        bool dominated = false;
+        for (size_t j = 0; j < results.size() && !dominated; j++) {
+            const TunerScore& b = results[j].score;
+            if (j == i || !b.feasible) {
+                continue;
+            }
+            bool noWorse = b.answerMs <= a.answerMs && b.updateMs <= a.updateMs &&
+                           b.cpuPercent <= a.cpuPercent && b.i2cBytesPerSecond <= a.i2cBytesPerSecond;
+            bool better = b.answerMs < a.answerMs || b.updateMs < a.updateMs ||
+                          b.cpuPercent < a.cpuPercent || b.i2cBytesPerSecond < a.i2cBytesPerSecond;
+            // Ties on all four: keep the first, drop the copies
+            dominated = noWorse && (better || j < i);
+        }
+        if (!dominated) {
+            front.push_back((int)i);
+        }
+    }
+    std::sort(front.begin(), front.end(), [this](int a, int b) {
+        return results[a].score.answerMs < results[b].score.answerMs;
+    });
+    return front;
+}
+
+int ParamTuner::recommended() const {
+    const TunerScore& base = baseline.score;
+    std::vector<int> front = paretoFront();
+    int best = -1;
+    double bestCost = 0.0;
+    for (size_t i = 0; i < front.size(); i++) {
+        const TunerScore& score = results[front[i]].score;
+        double cost = score.answerMs / std::max(base.answerMs, 1.0) +
+                      score.updateMs / std::max(base.updateMs, 1.0) +
+                      score.cpuPercent / std::max(base.cpuPercent, 1e-6) +
+                      score.i2cBytesPerSecond / std::max(base.i2cBytesPerSecond, 1.0);
+        if (best < 0 || cost < bestCost) {
+            best = front[i];
+            bestCost = cost;
+        }
+    }
+    return best;
+}
+
+bool ParamTuner::writeHeader(const std::string& path, const TunerResult& result) const {
+    if (result.score.wrongSessions > 0 || result.score.missedSessions > 0) {
+        fprintf(stderr, "%s: not written, the candidate shows a wrong or no cell count in %d sessions\n",
+                path.c_str(), result.score.wrongSessions + result.score.missedSessions);
+        return false;
+    }
+    FILE* file = fopen(path.c_str(), "w");
+    if (!file) {
+        perror(path.c_str());
+        return false;
+    }
+    const TunerCandidate& c = result.candidate;
+    const TunerScore& tuned = result.score;
+    const TunerScore& base = baseline.score;
+    std::string guard = "CONFIG_TUNED_" + std::string(board.name) + "_H";
+    std::transform(guard.begin(), guard.end(), guard.begin(), ::toupper);
+    
+    fprintf(file, "#ifndef %s\n#define %s\n\n", guard.c_str(), guard.c_str());
+    fprintf(file, "// %s measurement parameters from simulator/tools/param_tuner\n", board.title);
+    fprintf(file, "// (seed %u, %d sessions of %.0f s; included by config.h with -DTUNED_CONFIG)\n",
+            options.seed, options.sessions, options.sessionSeconds);
+    fprintf(file, "//\n//               answer     update    CPU       I2C    error   flicker wrong missed\n");
+    fprintf(file, "// hand-picked %6.0f ms %6.0f ms %5.2f %% %5.0f B/s %4.1f mV %5.2f/min %4d %6d\n",
+            base.answerMs, base.updateMs, base.cpuPercent, base.i2cBytesPerSecond, base.voltageErrorV * 1000.0,
+            base.flickerPerMinute, base.wrongSessions, base.missedSessions);
+    fprintf(file, "// tuned       %6.0f ms %6.0f ms %5.2f %% %5.0f B/s %4.1f mV %5.2f/min %4d %6d\n\n",
+            tuned.answerMs, tuned.updateMs, tuned.cpuPercent, tuned.i2cBytesPerSecond, tuned.voltageErrorV * 1000.0,
+            tuned.flickerPerMinute, tuned.wrongSessions, tuned.missedSessions);
+    fprintf(file, "#define SAMPLE_RECORD_SAMPLES %d\n", c.samplesPerBlock);
+    fprintf(file, "#define MEASUREMENT_DELAY_MS %d\n", c.periodMs);
+    fprintf(file, "#define CONNECT_DEBOUNCE_SAMPLES %d\n", c.debounceSamples);
+    fprintf(file, "#define TRACKER_NOISE_SIGMA %.2f\n", c.tracker.noiseSigma);
+    fprintf(file, "#define TRACKER_MAX_AVERAGED %d\n", c.tracker.maxAveraged);
+    fprintf(file, "#define TRACKER_LOCK_CONFIDENCE %.2f\n", c.tracker.lockConfidence);
+    fprintf(file, "#define TRACKER_LOCK_READINGS %d\n", c.tracker.lockReadings);
+    fprintf(file, "\n#endif // %s\n", guard.c_str());
+    return fclose(file) == 0;
+}
+
+bool ParamTuner::writeFront(const std::string& path) const {
+    FILE* file = fopen(path.c_str(), "w");
+    if (!file) {
+        perror(path.c_str());
+        return false;
+    }
+    fprintf(file, "samples,period_ms,debounce,sigma,max_averaged,lock_confidence,lock_readings,"
+                  "answer_ms,update_ms,cpu_percent,i2c_bytes_s,error_mv,flicker_min,wrong,missed\n");
+    std::vector<int> front = paretoFront();
+    for (size_t i = 0; i < front.size(); i++) {
+        const TunerCandidate& c = results[front[i]].candidate;
+        const TunerScore& s = results[front[i]].score;
+        fprintf(file, "%d,%d,%d,%.2f,%d,%.2f,%d,%.0f,%.0f,%.3f,%.0f,%.2f,%.3f,%d,%d\n",
+                c.samplesPerBlock, c.periodMs, c.debounceSamples, c.tracker.noiseSigma, c.tracker.maxAveraged,
+                c.tracker.lockConfidence, c.tracker.lockReadings, s.answerMs, s.updateMs, s.cpuPercent,
+                s.i2cBytesPerSecond, s.voltageErrorV * 1000.0, s.flickerPerMinute, s.wrongSessions,
+                s.missedSessions);
+    }
+    return fclose(file) == 0;
+}
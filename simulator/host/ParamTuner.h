@@ -0,0 +1,194 @@
+#ifndef PARAM_TUNER_H
+#define PARAM_TUNER_H
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+#include "CellCountTracker.h"
+#include "../AdcModel.h"
+
+/**
+ * @brief One set of measurement parameters, as the config.h macros they become
+ */
+struct TunerCandidate {
+    int samplesPerBlock;        // SAMPLE_RECORD_SAMPLES ("$samples")
+    int periodMs;               // MEASUREMENT_DELAY_MS ("$period")
+    int debounceSamples;        // CONNECT_DEBOUNCE_SAMPLES
+    TrackerTuning tracker;      // TRACKER_NOISE_SIGMA, _MAX_AVERAGED, _LOCK_CONFIDENCE, _LOCK_READINGS
+};
+
+/**
+ * @brief How a candidate did over the scenario set
+ *
+ * The objectives are minimized; the rest are checked against TunerLimits.
+ * CPU and I2C figures are per second with a pack connected.
+ */
+struct TunerScore {
+    double answerMs;            // Objective: plug-in to the right, locked cell count on the display (mean)
+    double updateMs;            // Objective: mean age of the shown reading (block window midpoint to now)
+    double cpuPercent;          // Objective: sampling, analysis and drawing, of one core
+    double i2cBytesPerSecond;   // Objective: display frames on the bus
+    double voltageErrorV;       // RMS of the shown voltage against the settled reading (noise and lag)
+    double flickerPerMinute;    // Shown cell count or charge changes while a pack rests, after the answer
+    int wrongSessions;          // Sessions that showed a wrong locked cell count
+    int missedSessions;         // Sessions that never showed the right count
+    int spuriousEvents;         // Connect/disconnect events beyond one each per session
+    bool feasible;              // Within the limits
+};
+
+/**
+ * @brief Accuracy and flicker constraints
+ *
+ * Negative error and flicker limits take the hand-picked configuration's
+ * own figures (never worse than what ships). Wrong and missed cell counts
+ * default to none: a header is only written for a candidate that shows the
+ * right count in every session.
+ */
+struct TunerLimits {
+    double maxVoltageErrorV;
+    double maxFlickerPerMinute;
+    int maxWrongSessions;
+    int maxMissedSessions;
+    
+    TunerLimits();
+};
+
+/**
+ * @brief A target board: its ADC front end, cost estimates and the
+ * hand-picked parameters of its config header
+ */
+struct TunerBoard {
+    const char* name;           // Header name part: config_tuned_<name>.h
+    const char* title;
+    AdcModelConfig adc;         // Front end the scenarios are sampled through
+    double sampleUs;            // One sampleTask() run, conversion included
+    double measurementUs;       // One analysisTask() and displayTask() run, frame drawing included
+    TunerCandidate defaults;    // config.h / config_arduino.h values
+    float minNoiseSigma;        // TRACKER_NOISE_SIGMA floor: one ADC count at the battery
+    int minLockReadings;        // TRACKER_LOCK_READINGS floor: a lock confirms over more than one reading
+    
+    /**
+     * @brief ESP32-C3 (config.h): calibrated 12-bit ADC with the esp32c3() noise and DNL
+     */
+    static TunerBoard esp32c3();
+    
+    /**
+     * @brief Pro Mini (config_arduino.h): 10-bit AVR ADC against the 5V supply
+     */
+    static TunerBoard proMini();
+};
+
+/**
+ * @brief Settings of a search
+ */
+struct TunerOptions {
+    int sessions;               // Plug-in scenarios per board
+    double sessionSeconds;      // Length of each (the pack is removed 3 s before the end)
+    int threads;                // Worker threads (0 = one per core)
+    uint32_t seed;              // Packs, ADC units and plug timing
+    TunerLimits limits;
+    
+    TunerOptions();
+};
+
+/**
+ * @brief One evaluated candidate
+ */
+struct TunerResult {
+    TunerCandidate candidate;
+    TunerScore score;
+};
+
+struct TunerSession;
+
+/**
+ * @brief Parameter search for one board against simulated plug-ins
+ *
+ * The scenario set is built once: each session plugs a pack (1S-6S, any
+ * charge, resting or discharging with bursts from a PackModel) into the
+ * board's AdcModel unit after a random boot delay, with contact bounce at
+ * plug-in and removal, and records the raw code of every CONNECTION_POLL_MS
+ * sample. Every candidate then runs the same sessions through the
+ * firmware's own MeasurementTasks, one instance per session with the
+ * board's nominal conversion, with the analysis task's period and trigger
+ * on the TaskScheduler grid. Common scenarios make the comparison between
+ * candidates exact rather than statistical.
+ *
+ * Candidates are independent, so search() hands them to worker threads
+ * from a shared counter; each thread owns its firmware objects.
+ *
+ * CPU is estimated from the board's per-run costs and the number of runs;
+ * I2C is the bytes per display frame (see display_golden) times frames.
+ * Both only count while a pack is connected: without one the analysis and
+ * display tasks do nothing.
+ */
+class ParamTuner {
+public:
+    ParamTuner(const TunerBoard& board, const TunerOptions& options);
+    ~ParamTuner();
+    
+    /**
+     * @brief Candidates of the search grid the firmware accepts, above the board's floors
+     * @param quick A small grid (smoke tests)
+     */
+    std::vector<TunerCandidate> grid(bool quick) const;
+    
+    /**
+     * @brief Run one candidate over every session (thread-safe)
+     */
+    TunerScore evaluate(const TunerCandidate& candidate) const;
+    
+    /**
+     * @brief Evaluate the hand-picked configuration and every candidate in parallel
+     *
+     * Limits left negative are taken from the hand-picked configuration,
+     * which is appended to the results as the last entry.
+     */
+    void search(const std::vector<TunerCandidate>& candidates);
+    
+    /**
+     * @brief Feasible results no other feasible result beats on all four objectives
+     * @return Indices into getResults(), by answer time
+     */
+    std::vector<int> paretoFront() const;
+    
+    /**
+     * @brief Front member with the smallest sum of objectives relative to the
+     * hand-picked configuration
+     * @return Index into getResults(), or -1 if nothing is feasible
+     */
+    int recommended() const;
+    
+    /**
+     * @brief Write config_tuned_<board>.h with a result's parameters
+     * @return false if the result shows a wrong or no cell count in any
+     * session, or the file cannot be written
+     */
+    bool writeHeader(const std::string& path, const TunerResult& result) const;
+    
+    /**
+     * @brief Write the Pareto front as CSV, one line per member
+     * @return false if the file cannot be written
+     */
+    bool writeFront(const std::string& path) const;
+    
+    const TunerBoard& getBoard() const { return board; }
+    const TunerOptions& getOptions() const { return options; }
+    const TunerResult& getBaseline() const { return baseline; }
+    const std::vector<TunerResult>& getResults() const { return results; }
+
+private:
+    TunerBoard board;
+    TunerOptions options;
+    std::vector<TunerSession*> sessions;
+    TunerResult baseline;
+    std::vector<TunerResult> results;
+    float voltsPerCount;        // Firmware's nominal conversion at the battery
+    int connectRaw;
+    int disconnectRaw;
+    
+    void buildSessions();
+    bool checkLimits(TunerScore& score) const;
+};
+
+#endif // PARAM_TUNER_H
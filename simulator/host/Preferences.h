@@ -0,0 +1,32 @@
+#ifndef HOST_PREFERENCES_H
+#define HOST_PREFERENCES_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * @brief Host stand-in for the ESP32 NVS Preferences API (byte blobs only),
+ * kept in memory for the life of the process
+ */
+class Preferences {
+public:
+    Preferences();
+    ~Preferences();
+    bool begin(const char* name, bool readOnly = false);
+    void end();
+    size_t getBytes(const char* key, void* buffer, size_t length);
+    size_t putBytes(const char* key, const void* value, size_t length);
+    bool remove(const char* key);
+    bool clear();
+    
+    /**
+     * @brief Erase every namespace (a factory-fresh board)
+     */
+    static void eraseAll();
+
+private:
+    const char* space;       // nullptr when not open
+    bool readOnly;
+};
+
+#endif // HOST_PREFERENCES_H
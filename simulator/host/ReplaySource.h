@@ -0,0 +1,45 @@
+#ifndef REPLAY_SOURCE_H
+#define REPLAY_SOURCE_H
+
+#include "SampleSource.h"
+
+/**
+ * @brief A SampleSource fed one code per poll(), like analogRead() on the
+ * targets, for firmware instances that do not share the host's ADC
+ *
+ * The fleet's virtual testers and the parameter search feed it from their
+ * own AdcModel or recorded session before each MeasurementTasks::sample().
+ */
+class ReplaySource : public SampleSource {
+public:
+    ReplaySource() : next(0), batchSum(0), batchCount(0), latest(0) {}
+    
+    /**
+     * @brief Set the code the next poll() converts
+     */
+    void feed(int raw) { next = raw; }
+    
+    void startBatch() override {
+        batchSum = 0;
+        batchCount = 0;
+    }
+    
+    bool poll() override {
+        latest = next;
+        batchSum += latest;
+        batchCount++;
+        return true;
+    }
+    
+    int getBatchCount() const override { return batchCount; }
+    int getBatchAverage() const override { return batchCount > 0 ? (int)(batchSum / batchCount) : 0; }
+    int getLatest() const override { return latest; }
+
+private:
+    int next;
+    long batchSum;
+    int batchCount;
+    int latest;
+};
+
+#endif // REPLAY_SOURCE_H
@@ -0,0 +1,250 @@
+#include "Ssd1306Panel.h"
+#include <string.h>
+
+namespace {
+
+/**
+ * @brief Argument bytes that follow a command byte
+ */
+uint8_t argumentCount(uint8_t command) {
+    switch (command) {
+        case 0x20: case 0x81: case 0x8D: case 0xA8: case 0xD3:
+        case 0xD5: case 0xD6: case 0xD9: case 0xDA: case 0xDB:
+            return 1;
+        case 0x21: case 0x22: case 0xA3:
+            return 2;
+        case 0x29: case 0x2A:
+            return 5;
+        case 0x26: case 0x27:
+            return 6;
+        default:
+            return 0;
+    }
+}
+
+} // namespace
+
+Ssd1306Panel::Ssd1306Panel()
+    : pendingLength(0), pendingNeeded(0), mode(2), column(0), page(0), columnStart(0),
+      columnEnd(SSD1306_PANEL_COLUMNS - 1), pageStart(0), pageEnd(SSD1306_PANEL_PAGES - 1),
+      rows(SSD1306_PANEL_PAGES * 8), on(false), inverted(false), allOn(false), frameBytes(0), frames(0),
+      frameTransactions(0), frameTraffic(0), lastFrameTransactions(0), lastFrameBytes(0), totalTransactions(0),
+      totalBytes(0), listener(nullptr), listenerContext(nullptr) {
+    memset(ram, 0, sizeof(ram));
+}
+
+void Ssd1306Panel::setFrameListener(FrameListener frameListener, void* context) {
+    listener = frameListener;
+    listenerContext = context;
+}
+
+bool Ssd1306Panel::receive(const uint8_t* bytes, size_t length) {
+    frameTransactions++;
+    frameTraffic += length;
+    totalTransactions++;
+    totalBytes += length;
+    
+    size_t i = 0;
+    while (i < length) {
+        uint8_t control = bytes[i++];
+        bool isData = (control & 0x40) != 0;
+        if (control & 0x80) {
+            // Co set: one byte, then another control byte
+            if (i < length) {
+                isData ? data(bytes[i]) : command(bytes[i]);
+                i++;
+            }
+            continue;
+        }
+        // Co clear: the rest of the transaction is one stream
+        for (; i < length; i++) {
+            isData ? data(bytes[i]) : command(bytes[i]);
+        }
+    }
+    return true;
+}
+
+void Ssd1306Panel::command(uint8_t byte) {
+    if (pendingNeeded == 0) {
+        pending[0] = byte;
+        pendingLength = 1;
+        pendingNeeded = argumentCount(byte);
+    } else {
+        pending[pendingLength++] = byte;
+        pendingNeeded--;
+    }
+    if (pendingNeeded == 0) {
+        execute();
+    }
+}
+
+void Ssd1306Panel::execute() {
+    uint8_t op = pending[0];
+    if (op <= 0x0F) {
+        column = (uint8_t)((column & 0xF0) | op);                    // Page mode lower column
+        frameBytes = 0;
+    } else if (op <= 0x1F) {
+        column = (uint8_t)(((op & 0x07) << 4) | (column & 0x0F));    // Page mode upper column
+        frameBytes = 0;
+    } else if (op >= 0xB0 && op <= 0xB7) {
+        page = op & 0x07;
+        frameBytes = 0;
+    } else {
+        switch (op) {
+            case 0x20: mode = pending[1] & 0x03; break;
+            case 0x21:
+                columnStart = pending[1] & 0x7F;
+                columnEnd = pending[2] & 0x7F;
+                column = columnStart;
+                frameBytes = 0;
+                break;
+            case 0x22:
+                pageStart = pending[1] & 0x07;
+                pageEnd = pending[2] & 0x07;
+                page = pageStart;
+                frameBytes = 0;
+                break;
+            case 0xA8: rows = (pending[1] & 0x3F) + 1; if (rows < 16) rows = 16; break;
+            case 0xA4: allOn = false; break;
+            case 0xA5: allOn = true; break;
+            case 0xA6: inverted = false; break;
+            case 0xA7: inverted = true; break;
+            case 0xAE: on = false; break;
+            case 0xAF: on = true; break;
+            default: break;      // Timing, charge pump, scrolling, contrast: no effect on the image
+        }
+    }
+}
+
+void Ssd1306Panel::data(uint8_t byte) {
+    ram[page * SSD1306_PANEL_COLUMNS + column] = byte;
+    
+    if (mode == 0) {
+        if (column++ >= columnEnd) {
+            column = columnStart;
+            page = page >= pageEnd ? pageStart : (uint8_t)(page + 1);
+        }
+    } else if (mode == 1) {
+        if (page++ >= pageEnd) {
+            page = pageStart;
+            column = column >= columnEnd ? columnStart : (uint8_t)(column + 1);
+        }
+    } else {
+        column = (uint8_t)((column + 1) & 0x7F);
+    }
+    
+    unsigned long visibleBytes = (unsigned long)SSD1306_PANEL_COLUMNS * ((rows + 7) / 8);
+    if (++frameBytes >= visibleBytes) {
+        frameBytes = 0;
+        frames++;
+        lastFrameTransactions = frameTransactions;
+        lastFrameBytes = frameTraffic;
+        frameTransactions = 0;
+        frameTraffic = 0;
+        if (listener) {
+            listener(*this, listenerContext);
+        }
+    }
+}
+
+bool Ssd1306Panel::isLit(int x, int y) const {
+    if (!on || x < 0 || x >= SSD1306_PANEL_COLUMNS || y < 0 || y >= rows) {
+        return false;
+    }
+    bool set = allOn || ((ram[(y / 8) * SSD1306_PANEL_COLUMNS + x] >> (y & 7)) & 1);
+    return set != inverted;
+}
+
+void Ssd1306Panel::writeAscii(FILE* file) const {
+    char line[SSD1306_PANEL_COLUMNS + 2];
+    for (int y = 0; y < rows; y++) {
+        for (int x = 0; x < SSD1306_PANEL_COLUMNS; x++) {
+            line[x] = isLit(x, y) ? '#' : '.';
+        }
+        line[SSD1306_PANEL_COLUMNS] = '\n';
+        line[SSD1306_PANEL_COLUMNS + 1] = '\0';
+        fputs(line, file);
+    }
+}
+
+void Ssd1306Panel::writePbm(FILE* file) const {
+    // Plain PBM lines stay under 70 characters: each row is written as two
+    fprintf(file, "P1\n%d %d\n", SSD1306_PANEL_COLUMNS, rows);
+    char line[SSD1306_PANEL_COLUMNS / 2 + 2];
+    for (int y = 0; y < rows; y++) {
+        for (int half = 0; half < 2; half++) {
+            for (int i = 0; i < SSD1306_PANEL_COLUMNS / 2; i++) {
+                line[i] = isLit(half * SSD1306_PANEL_COLUMNS / 2 + i, y) ? '1' : '0';
+            }
+            line[SSD1306_PANEL_COLUMNS / 2] = '\n';
+            line[SSD1306_PANEL_COLUMNS / 2 + 1] = '\0';
+            fputs(line, file);
+        }
+    }
+}
+
+long Ssd1306Panel::compare(FILE* file) const {
+    long differences = 0;
+    int first = fgetc(file);
+    if (first == 'P') {
+        // Plain PBM: header tokens, then one digit per pixel; whitespace and comments ignored
+        int width = 0, height = 0;
+        if (fgetc(file) != '1') {
+            return -1;
+        }
+        int c = fgetc(file);
+        for (int field = 0; field < 2; field++) {
+            int value = -1;
+            for (;;) {
+                if (c == '#') {
+                    while (c != '\n' && c != EOF) c = fgetc(file);
+                } else if (c >= '0' && c <= '9') {
+                    value = (value < 0 ? 0 : value * 10) + (c - '0');
+                } else if (value >= 0 || c == EOF) {
+                    break;
+                }
+                c = fgetc(file);
+            }
+            (field == 0 ? width : height) = value;
+        }
+        if (width != SSD1306_PANEL_COLUMNS || height != rows) {
+            return -1;
+        }
+        for (long pixel = 0; pixel < (long)width * height; pixel++) {
+            do {
+                c = fgetc(file);
+            } while (c == ' ' || c == '\t' || c == '\r' || c == '\n');
+            if (c != '0' && c != '1') {
+                return -1;
+            }
+            if ((c == '1') != isLit((int)(pixel % width), (int)(pixel / width))) {
+                differences++;
+            }
+        }
+        return differences;
+    }
+    
+    // ASCII art: one line of '#' and '.' per row
+    ungetc(first, file);
+    char line[SSD1306_PANEL_COLUMNS + 8];
+    int y = 0;
+    while (fgets(line, sizeof(line), file)) {
+        size_t length = strcspn(line, "\r\n");
+        if (length == 0) {
+            continue;
+        }
+        if (length != SSD1306_PANEL_COLUMNS || y >= rows) {
+            return -1;
+        }
+        for (int x = 0; x < SSD1306_PANEL_COLUMNS; x++) {
+            if (line[x] != '#' && line[x] != '.') {
+                return -1;
+            }
+            if ((line[x] == '#') != isLit(x, y)) {
+                differences++;
+            }
+        }
+        y++;
+    }
+    return y == rows ? differences : -1;
+}
@@ -0,0 +1,119 @@
+#ifndef SSD1306_PANEL_H
+#define SSD1306_PANEL_H
+
+#include <stdint.h>
+#include <stdio.h>
+#include "VirtualHardware.h"
+
+#define SSD1306_PANEL_COLUMNS 128
+#define SSD1306_PANEL_PAGES 8
+
+/**
+ * @brief An SSD1306 controller on the virtual I2C bus
+ *
+ * Decodes the control byte, command and data streams into its display RAM
+ * (addressing modes, column/page windows, multiplex, on/off, invert) the way
+ * the controller does, so what it shows is what the firmware's bytes would
+ * have shown on a real panel. A frame is counted each time a full visible
+ * screen of data has arrived since the last addressing command.
+ *
+ * Rows are shown in RAM order (the segment remap and COM scan direction the
+ * Adafruit driver sets are taken as upright).
+ */
+class Ssd1306Panel : public VirtualI2cDevice {
+public:
+    typedef void (*FrameListener)(const Ssd1306Panel& panel, void* context);
+    
+    Ssd1306Panel();
+    
+    bool receive(const uint8_t* data, size_t length);
+    
+    /**
+     * @brief Called after each completed frame
+     */
+    void setFrameListener(FrameListener listener, void* context);
+    
+    /**
+     * @brief Pixel as lit on the glass (display off = dark, invert applied)
+     */
+    bool isLit(int x, int y) const;
+    
+    int getWidth() const { return SSD1306_PANEL_COLUMNS; }
+    int getHeight() const { return rows; }
+    bool isOn() const { return on; }
+    unsigned long getFrameCount() const { return frames; }
+    
+    /**
+     * @brief Bus traffic that built the last completed frame
+     *
+     * Transactions and bytes (control bytes included, address byte not)
+     * addressed to the panel after the previous frame completed, up to the
+     * transaction that completed this one, so the window commands count
+     * with the frame they set up. Valid inside the frame listener.
+     */
+    unsigned long getFrameTransactions() const { return lastFrameTransactions; }
+    unsigned long getFrameBytes() const { return lastFrameBytes; }
+    
+    /**
+     * @brief Bus traffic addressed to the panel since it was created
+     */
+    unsigned long getTotalTransactions() const { return totalTransactions; }
+    unsigned long getTotalBytes() const { return totalBytes; }
+    
+    /**
+     * @brief Display RAM, SSD1306_PANEL_PAGES pages of SSD1306_PANEL_COLUMNS bytes
+     */
+    const uint8_t* getRam() const { return ram; }
+    
+    /**
+     * @brief Write the visible screen as rows of '#' (lit) and '.' (dark)
+     */
+    void writeAscii(FILE* file) const;
+    
+    /**
+     * @brief Write the visible screen as a plain (P1) PBM image, 1 = lit
+     */
+    void writePbm(FILE* file) const;
+    
+    /**
+     * @brief Compare the visible screen with an image from writePbm() or writeAscii()
+     * @param file Image to compare with (format detected from its first byte)
+     * @return Number of differing pixels, -1 if the file is not an image of the screen's size
+     */
+    long compare(FILE* file) const;
+
+private:
+    void command(uint8_t byte);
+    void execute();
+    void data(uint8_t byte);
+    
+    uint8_t ram[SSD1306_PANEL_COLUMNS * SSD1306_PANEL_PAGES];
+    uint8_t pending[7];          // Command being assembled with its arguments
+    uint8_t pendingLength;
+    uint8_t pendingNeeded;
+    
+    uint8_t mode;                // 0 horizontal, 1 vertical, 2 page
+    uint8_t column;
+    uint8_t page;
+    uint8_t columnStart;
+    uint8_t columnEnd;
+    uint8_t pageStart;
+    uint8_t pageEnd;
+    int rows;
+    bool on;
+    bool inverted;
+    bool allOn;
+    
+    unsigned long frameBytes;    // Data bytes since the last addressing command
+    unsigned long frames;
+    unsigned long frameTransactions; // Traffic since the last frame completed
+    unsigned long frameTraffic;
+    unsigned long lastFrameTransactions;
+    unsigned long lastFrameBytes;
+    unsigned long totalTransactions;
+    unsigned long totalBytes;
+    FrameListener listener;
+    void* listenerContext;
+};
+
+#endif // SSD1306_PANEL_H
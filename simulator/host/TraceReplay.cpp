@@ -0,0 +1,169 @@
+#include "TraceReplay.h"
+#include <chrono>
+#include <stdlib.h>
+#include <string.h>
+#include "Arduino.h"
+#include "VirtualHardware.h"
+#include "config.h"
+
+// The firmware's entry points (src/main.cpp)
+void setup();
+void loop();
+
+namespace {
+
+/**
+ * @brief Pack volts to raw counts through the nominal divider (no calibration)
+ */
+int voltsToRaw(float volts) {
+    float ratio = (float)(VOLTAGE_DIVIDER_R1 + VOLTAGE_DIVIDER_R2) / VOLTAGE_DIVIDER_R2;
+    float raw = volts / ratio / VOLTAGE_ADC_VREF * VOLTAGE_ADC_MAX_VALUE + 0.5f;
+    return raw < 0.0f ? 0 : raw > VOLTAGE_ADC_MAX_VALUE ? VOLTAGE_ADC_MAX_VALUE : (int)raw;
+}
+
+} // namespace
+
+TraceReplay::TraceReplay() : next(0), loopUs(20), loops(0), setupUs(0), loopNs(0) {
+}
+
+bool TraceReplay::load(const char* path, bool volts) {
+    FILE* in = fopen(path, "r");
+    if (!in) {
+        perror(path);
+        return false;
+    }
+    
+    char line[512];
+    unsigned long lineNumber = 0;
+    unsigned long lastMs = getLastEventMs();
+    bool ok = true;
+    
+    while (ok && fgets(line, sizeof(line), in)) {
+        lineNumber++;
+        line[strcspn(line, "\r\n")] = '\0';
+        const char* p = line + strspn(line, " \t");
+        if (*p == '\0' || *p == '#') {
+            continue;
+        }
+        
+        char* rest;
+        Event event;
+        event.timeMs = strtoul(p, &rest, 10);
+        event.value = 0;
+        if (rest == p || (*rest != ' ' && *rest != '\t')) {
+            fprintf(stderr, "%s:%lu: expected '<ms> <event>'\n", path, lineNumber);
+            ok = false;
+            break;
+        }
+        if (event.timeMs < lastMs) {
+            fprintf(stderr, "%s:%lu: time goes backwards\n", path, lineNumber);
+            ok = false;
+            break;
+        }
+        lastMs = event.timeMs;
+        p = rest + strspn(rest, " \t");
+        
+        if (strncmp(p, "serial", 6) == 0 && (p[6] == ' ' || p[6] == '\t' || p[6] == '\0')) {
+            event.type = EVENT_SERIAL;
+            event.text = p[6] ? p + 7 : "";
+            event.text += '\n';
+        } else if (strncmp(p, "button ", 7) == 0) {
+            const char* state = p + 7 + strspn(p + 7, " \t");
+            if (strcmp(state, "down") != 0 && strcmp(state, "up") != 0) {
+                fprintf(stderr, "%s:%lu: button state must be down or up\n", path, lineNumber);
+                ok = false;
+                break;
+            }
+            event.type = EVENT_BUTTON;
+            event.value = strcmp(state, "down") == 0 ? 1 : 0;
+        } else {
+            char* end;
+            float value = strtof(p, &end);
+            if (end == p || *(end + strspn(end, " \t")) != '\0') {
+                fprintf(stderr, "%s:%lu: unknown event '%s'\n", path, lineNumber, p);
+                ok = false;
+                break;
+            }
+            event.type = EVENT_ADC;
+            event.value = volts ? voltsToRaw(value) : (int)(value + 0.5f);
+        }
+        events.push_back(event);
+    }
+    fclose(in);
+    return ok;
+}
+
+bool TraceReplay::addSerial(unsigned long timeMs, const char* text) {
+    if (timeMs < getLastEventMs()) {
+        return false;
+    }
+    Event event;
+    event.timeMs = timeMs;
+    event.type = EVENT_SERIAL;
+    event.value = 0;
+    event.text = text;
+    event.text += '\n';
+    events.push_back(event);
+    return true;
+}
+
+unsigned long TraceReplay::getLastEventMs() const {
+    return events.empty() ? 0 : events.back().timeMs;
+}
+
+std::vector<unsigned long> TraceReplay::getPlugInTimes() const {
+    std::vector<unsigned long> times;
+    int previous = 0;
+    for (size_t i = 0; i < events.size(); i++) {
+        if (events[i].type != EVENT_ADC) {
+            continue;
+        }
+        if (previous == 0 && events[i].value > 0) {
+            times.push_back(events[i].timeMs);
+        }
+        previous = events[i].value;
+    }
+    return times;
+}
+
+void TraceReplay::apply(const Event& event) {
+    switch (event.type) {
+        case EVENT_ADC:
+            VirtualHardware::setAnalogValue(ADC_PIN, event.value);
+            break;
+        case EVENT_SERIAL:
+            VirtualHardware::queueSerialInput(event.text.data(), event.text.size());
+            break;
+        case EVENT_BUTTON:
+            // The button pulls the pin low
+            VirtualHardware::setPinLevel(CHEMISTRY_BUTTON_PIN, event.value ? LOW : HIGH);
+            break;
+    }
+}
+
+void TraceReplay::powerOn() {
+    while (next < events.size() && events[next].timeMs == 0) {
+        apply(events[next++]);
+    }
+    VirtualHardware::enterFirmware();
+    setup();
+    VirtualHardware::leaveFirmware();
+    setupUs = VirtualHardware::nowMicros();
+}
+
+void TraceReplay::runUntil(unsigned long timeMs) {
+    uint64_t endUs = (uint64_t)timeMs * 1000;
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    while (VirtualHardware::nowMicros() < endUs) {
+        unsigned long now = millis();
+        while (next < events.size() && events[next].timeMs <= now) {
+            apply(events[next++]);
+        }
+        VirtualHardware::enterFirmware();
+        loop();
+        VirtualHardware::leaveFirmware();
+        VirtualHardware::advanceMicros(loopUs);
+        loops++;
+    }
+    loopNs += std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+}
@@ -0,0 +1,100 @@
+#ifndef TRACE_REPLAY_H
+#define TRACE_REPLAY_H
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Runs the firmware's setup() and loop() on VirtualHardware, driven
+ * by a recorded input trace
+ *
+ * Trace lines, times in ms since power-on:
+ *
+ *   # comment
+ *   <ms> <value>              ADC reading held from then on (raw counts,
+ *                             or pack volts when loaded with volts = true)
+ *   <ms> serial <text>        text and a newline typed on the serial port
+ *   <ms> button down|up       chemistry button pressed / released
+ *
+ * The firmware keeps its state in statics, so it can be booted once per
+ * process.
+ */
+class TraceReplay {
+public:
+    TraceReplay();
+    
+    /**
+     * @brief Read a trace file (errors go to stderr with the line number)
+     * @param volts true if ADC values are pack volts, converted through the
+     *        nominal divider without calibration
+     */
+    bool load(const char* path, bool volts);
+    
+    /**
+     * @brief Add an event after the loaded ones (at or after the last one)
+     */
+    bool addSerial(unsigned long timeMs, const char* text);
+    
+    size_t getEventCount() const { return events.size(); }
+    unsigned long getLastEventMs() const;
+    
+    /**
+     * @brief Times of the ADC events that raise the input from 0 (a pack plugged in)
+     */
+    std::vector<unsigned long> getPlugInTimes() const;
+    
+    /**
+     * @brief Device time charged per loop() pass (default 20 us)
+     *
+     * The firmware's own code takes no device time on the host; without a
+     * cost per pass a loop that polls for a deadline less than a millisecond
+     * away would never see it arrive.
+     */
+    void setLoopMicros(unsigned long us) { loopUs = us; }
+    
+    /**
+     * @brief Apply the events at time 0, then run setup()
+     */
+    void powerOn();
+    
+    /**
+     * @brief Call loop() until the device clock reaches timeMs, applying
+     * each event once its time has come
+     */
+    void runUntil(unsigned long timeMs);
+    
+    unsigned long long getLoopCount() const { return loops; }
+    uint64_t getSetupMicros() const { return setupUs; }
+    
+    /**
+     * @brief Host time spent in runUntil(), in nanoseconds
+     */
+    uint64_t getLoopNanos() const { return loopNs; }
+
+private:
+    enum EventType {
+        EVENT_ADC,
+        EVENT_SERIAL,
+        EVENT_BUTTON
+    };
+    
+    struct Event {
+        unsigned long timeMs;
+        EventType type;
+        int value;               // ADC value, or 1 = button down
+        std::string text;
+    };
+    
+    void apply(const Event& event);
+    
+    std::vector<Event> events;
+    size_t next;
+    unsigned long loopUs;
+    unsigned long long loops;
+    uint64_t setupUs;
+    uint64_t loopNs;
+};
+
+#endif // TRACE_REPLAY_H
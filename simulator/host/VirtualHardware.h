@@ -0,0 +1,115 @@
+#ifndef VIRTUAL_HARDWARE_H
+#define VIRTUAL_HARDWARE_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#define VIRTUAL_PIN_COUNT 64
+
+/**
+ * @brief A device on the host I2C bus (see Wire.h)
+ */
+class VirtualI2cDevice {
+public:
+    virtual ~VirtualI2cDevice() {}
+    
+    /**
+     * @brief One write transaction addressed to this device
+     * @return false to not acknowledge
+     */
+    virtual bool receive(const uint8_t* data, size_t length) = 0;
+    
+    /**
+     * @brief One read transaction
+     * @return Bytes supplied
+     */
+    virtual size_t request(uint8_t* data, size_t length) {
+        (void)data;
+        (void)length;
+        return 0;
+    }
+};
+
+/**
+ * @brief The board behind the host Arduino core
+ *
+ * Time only moves when the firmware waits (delay(), delayMicroseconds()) or
+ * uses the bus, so a run is deterministic and as fast as the host allows.
+ * The harness sets the inputs (analog values, pin levels, serial input)
+ * between calls to loop() and collects the serial output.
+ */
+class VirtualHardware {
+public:
+    /**
+     * @brief Back to power-on: time 0, pins floating, no serial data, no devices
+     */
+    static void reset();
+    
+    static uint64_t nowMicros();
+    static void advanceMicros(uint64_t us);
+    
+    /**
+     * @brief Value analogRead() returns for a pin until changed (clamped to the resolution)
+     */
+    static void setAnalogValue(int pin, int value);
+    
+    /**
+     * @brief Level a pin reads as an input (overrides the pull-up)
+     */
+    static void setPinLevel(int pin, int level);
+    
+    /**
+     * @brief Level the firmware last wrote to an output pin
+     */
+    static int getOutputLevel(int pin);
+    
+    /**
+     * @brief Bytes the firmware will read from Serial
+     */
+    static void queueSerialInput(const char* data, size_t length);
+    
+    /**
+     * @brief Where Serial output goes (nullptr discards it)
+     */
+    static void setSerialOutput(FILE* file);
+    static uint64_t getSerialBytes();
+    
+    /**
+     * @brief Put a device on the I2C bus (nullptr removes it)
+     */
+    static void attachI2cDevice(uint8_t address, VirtualI2cDevice* device);
+    static VirtualI2cDevice* getI2cDevice(uint8_t address);
+
+    /**
+     * @brief Bus traffic since reset(): transactions, and bytes after the address byte
+     */
+    static uint64_t getI2cTransactions();
+    static uint64_t getI2cBytes();
+
+    /**
+     * @brief Also charge the host time the firmware's own code takes
+     *
+     * While the harness is inside enterFirmware()/leaveFirmware(), the clock
+     * runs at scale x the host's steady clock on top of the waits and bus
+     * time, so the firmware's timing statistics include its computation (the
+     * run is then no longer deterministic). 0, the default, turns it off.
+     */
+    static void setCpuClockScale(double scale);
+    static void enterFirmware();
+    static void leaveFirmware();
+    
+    // Used by the host Arduino core
+    static int readAnalog(int pin);
+    static void setAnalogBits(int bits);
+    static void setPinMode(int pin, int mode);
+    static int readPin(int pin);
+    static void writePin(int pin, int level);
+    static void countI2c(size_t bytes);
+    static void writeSerial(const uint8_t* data, size_t length);
+    static int serialAvailable();
+    static int readSerial();
+    static int peekSerial();
+};
+
+#endif // VIRTUAL_HARDWARE_H
@@ -0,0 +1,48 @@
+#ifndef HOST_WIRE_H
+#define HOST_WIRE_H
+
+#include "Arduino.h"
+
+#define I2C_BUFFER_LENGTH 128
+
+/**
+ * @brief Host I2C master: transactions go to the devices attached to
+ * VirtualHardware, and each one advances the virtual clock by its time on
+ * the bus (Wire blocks on the real boards too)
+ */
+class TwoWire {
+public:
+    TwoWire();
+    bool begin();
+    bool begin(int sda, int scl);
+    void setClock(uint32_t hz);
+    uint32_t getClock() const;
+    
+    void beginTransmission(uint8_t address);
+    size_t write(uint8_t value);
+    size_t write(const uint8_t* data, size_t length);
+    
+    /**
+     * @return 0 on success, 2 if no device acknowledged the address
+     */
+    uint8_t endTransmission(bool sendStop = true);
+    
+    /**
+     * @return Bytes received (0 if no device acknowledged)
+     */
+    uint8_t requestFrom(uint8_t address, uint8_t length, bool sendStop = true);
+    int available();
+    int read();
+
+private:
+    uint32_t clockHz;
+    uint8_t address;
+    uint8_t buffer[I2C_BUFFER_LENGTH];
+    size_t length;
+    size_t readOffset;
+    bool transmitting;
+};
+
+extern TwoWire Wire;
+
+#endif // HOST_WIRE_H
@@ -0,0 +1,53 @@
+#ifndef HOST_ESP_PARTITION_H
+#define HOST_ESP_PARTITION_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ * Host stand-in for the ESP-IDF partition API: one data partition of the
+ * default table's "spiffs" size, in memory. Like NOR flash, erase sets bytes
+ * to 0xFF and a write can only clear bits.
+ */
+
+typedef int esp_err_t;
+
+#define ESP_OK 0
+#define ESP_FAIL -1
+#define ESP_ERR_INVALID_ARG 0x102
+#define ESP_ERR_INVALID_SIZE 0x104
+
+typedef enum {
+    ESP_PARTITION_TYPE_APP = 0x00,
+    ESP_PARTITION_TYPE_DATA = 0x01
+} esp_partition_type_t;
+
+typedef enum {
+    ESP_PARTITION_SUBTYPE_DATA_NVS = 0x02,
+    ESP_PARTITION_SUBTYPE_DATA_SPIFFS = 0x82
+} esp_partition_subtype_t;
+
+#define ESP_PARTITION_SECTOR_SIZE 4096
+#define HOST_SPIFFS_PARTITION_SIZE 0x160000
+
+typedef struct {
+    esp_partition_type_t type;
+    esp_partition_subtype_t subtype;
+    uint32_t address;
+    uint32_t size;
+    char label[17];
+    bool encrypted;
+} esp_partition_t;
+
+const esp_partition_t* esp_partition_find_first(esp_partition_type_t type, esp_partition_subtype_t subtype,
+                                                const char* label);
+esp_err_t esp_partition_read(const esp_partition_t* partition, size_t offset, void* destination, size_t size);
+esp_err_t esp_partition_write(const esp_partition_t* partition, size_t offset, const void* source, size_t size);
+esp_err_t esp_partition_erase_range(const esp_partition_t* partition, size_t offset, size_t size);
+
+/**
+ * @brief Erase the whole partition (a factory-fresh board)
+ */
+void host_partition_erase_all();
+
+#endif // HOST_ESP_PARTITION_H
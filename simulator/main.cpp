@@ -4,13 +4,14 @@
 #include <cmath>
 #include <thread>
 #include <chrono>
+#include <ctime>
+#include "AdcModel.h"
+#include "AnalyzeMode.h"
+#include "PackModel.h"
 
 // Simulated configuration
-const float VOLTAGE_DIVIDER_RATIO = 7.8f;
 const float CELL_VOLTAGE_MIN = 2.9f;
 const float CELL_VOLTAGE_MAX = 4.2f;
-const float REFERENCE_VOLTAGE = 3.3f;
-const int ADC_RESOLUTION = 4095;
 
 /**
  * @brief Simulated Battery Analyzer
@@ -24,7 +25,7 @@ private:
     int detectedCells;
     float avgVoltagePerCell;
     int chargePercent;
-
+    
     /**
      * @brief Calculate charge percentage based on average cell voltage
      * 
@@ -41,7 +42,7 @@ private:
 
 public:
     SimulatedBatteryAnalyzer() : totalVoltage(0), detectedCells(0), avgVoltagePerCell(0), chargePercent(0) {}
-
+    
     /**
      * @brief Detect number of cells using "First Valid Match" algorithm
      * 
@@ -62,7 +63,7 @@ public:
         
         return 0;  // Invalid voltage
     }
-
+    
     /**
      * @brief Analyze battery with given voltage
      */
@@ -78,7 +79,7 @@ public:
             chargePercent = 0;
         }
     }
-
+    
     /**
      * @brief Display results in console (simulating OLED display)
      */
@@ -113,7 +114,7 @@ public:
         
         std::cout << "╚════════════════════════════════╝\n";
     }
-
+    
     // Getters for testing
     int getCells() const { return detectedCells; }
     float getAvgVoltage() const { return avgVoltagePerCell; }
@@ -124,27 +125,13 @@ public:
  * @brief Simulate ADC reading from actual battery voltage
  * 
  * Converts real voltage to ADC value (as if measured through voltage divider)
- * then back to voltage (simulating the ESP32 measurement process)
+ * with AdcModel, then back to voltage (simulating the ESP32 measurement process)
  */
 float simulateADCReading(float actualVoltage) {
-    // Simulate voltage divider reduction
-    float dividedVoltage = actualVoltage / VOLTAGE_DIVIDER_RATIO;
-    
-    // Simulate ADC quantization
-    int adcValue = (int)((dividedVoltage / REFERENCE_VOLTAGE) * ADC_RESOLUTION);
-    
-    // Add some noise (±2 ADC counts)
-    int noise = (rand() % 5) - 2;
-    adcValue += noise;
-    
-    // Clamp to valid range
-    if (adcValue < 0) adcValue = 0;
-    if (adcValue > ADC_RESOLUTION) adcValue = ADC_RESOLUTION;
-    
-    // Convert back to voltage (with voltage divider compensation)
-    float measuredVoltage = ((float)adcValue / ADC_RESOLUTION) * REFERENCE_VOLTAGE * VOLTAGE_DIVIDER_RATIO;
-    
-    return measuredVoltage;
+    // Nominal parts with ~1.4 counts of Gaussian noise; AdcModelConfig::esp32c3()
+    // adds the divider, reference and INL errors of an uncalibrated unit
+    static AdcModel adc(AdcModelConfig(), (uint64_t)time(nullptr));
+    return adc.toVolts(adc.sample(actualVoltage));
 }
 
 /**
@@ -225,19 +212,32 @@ void runDemoMode() {
 /**
  * @brief Run continuous monitoring simulation
  * 
- * Simulates a battery discharging over time
+ * Simulates a battery discharging over time with PackModel: the pack sags
+ * under the load bursts and recovers between them, and the cells drift apart
  */
 void runMonitoringMode() {
     SimulatedBatteryAnalyzer analyzer;
     
+    // 3S 2.2Ah pack with slightly mismatched cells: 1C cruise with 3C bursts
+    PackSpec spec;
+    spec.imbalance = 0.03f;
+    spec.seed = (uint32_t)time(nullptr);
+    spec.load.baseAmps = 2.2f;
+    spec.load.pulseAmps = 4.4f;
+    spec.load.periodSeconds = 300.0f;
+    spec.load.pulseSeconds = 60.0f;
+    spec.load.cutoffVolts = 3.3f;
+    PackModel pack(1, 1.0f);
+    pack.addPack(spec);
+    const int stepsPerUpdate = 60;  // 1 simulated minute per second
+    
     std::cout << "\n=== Battery Discharge Simulation ===\n";
-    std::cout << "Simulating 3S LiPo discharge from 12.6V to 9.9V\n";
+    std::cout << "Simulating 3S LiPo discharge under load until a cell reaches 3.3V\n";
     std::cout << "Press Ctrl+C to stop...\n\n";
     
-    float voltage = 12.6f;  // Start fully charged (3S @ 4.2V/cell)
-    const float dischargeRate = 0.05f;  // 50mV per iteration
-    
-    while (voltage >= 9.9f) {  // Stop at 3.3V/cell
+    while (pack.isLoadConnected(0)) {
+        pack.run(stepsPerUpdate, 1);
+        float voltage = pack.getPackVoltage(0);
         float measured = simulateADCReading(voltage);
         
         analyzer.analyze(measured);
@@ -251,28 +251,31 @@ void runMonitoringMode() {
         
         std::cout << "=== Real-time Battery Monitor ===\n";
         std::cout << "Simulated voltage: " << std::fixed << std::setprecision(2) 
-                  << voltage << "V\n";
+                  << voltage << "V at " << pack.getCurrent(0) << "A\n";
+        std::cout << "Cells:";
+        for (int cell = 0; cell < pack.getCellCount(0); cell++) {
+            std::cout << " " << std::setprecision(3) << pack.getCellVoltage(0, cell) << "V ("
+                      << std::setprecision(0) << pack.getCellSoc(0, cell) * 100.0f << "%)";
+        }
+        std::cout << "\n";
         
         analyzer.displayResults();
         
-        std::cout << "\nDischarging... (-" << dischargeRate << "V/iteration)\n";
-        
-        // Update for next iteration
-        voltage -= dischargeRate;
+        std::cout << "\nDischarging... (" << std::setprecision(0) << pack.getTime() / 60.0f
+                  << " min elapsed, 1 min/iteration)\n";
         
         // Wait 1 second
         std::this_thread::sleep_for(std::chrono::seconds(1));
     }
     
-    std::cout << "\nBattery discharged! Simulation stopped.\n";
+    std::cout << "\nLow-voltage cutoff after " << std::setprecision(0) << pack.getTime() / 60.0f
+              << " min. Simulation stopped.\n";
 }
 
 /**
  * @brief Main entry point
  */
 int main(int argc, char* argv[]) {
-    srand(time(nullptr));
-    
     if (argc > 1) {
         std::string mode = argv[1];
         
@@ -282,9 +285,11 @@ int main(int argc, char* argv[]) {
             runMonitoringMode();
         } else if (mode == "interactive") {
             runInteractiveMode();
+        } else if (mode == "analyze") {
+            return runAnalyzeMode(argc - 2, argv + 2);
         } else {
             std::cout << "Unknown mode: " << mode << "\n";
-            std::cout << "Available modes: demo, monitor, interactive\n";
+            std::cout << "Available modes: demo, monitor, interactive, analyze\n";
             return 1;
         }
     } else {
@@ -0,0 +1,1043 @@
+/**
+ * @brief Loop latency, flash and SRAM budget gate
+ *
+ * Three steps, each writing or reading "<metric> <value>" lines:
+ *
+ *   budget_gate loop [--volts] [--cpu-scale x] [--out f] trace
+ *       Replays the trace through the firmware on virtual hardware, asks
+ *       for the task report ('T') at the end and writes each stage's
+ *       longest run, worst lateness and overruns (loop.*). Device time only
+ *       counts waits and bus traffic, so these are exact run to run. With
+ *       --cpu-scale the host time of the firmware's own code is charged to
+ *       the clock too (x times), giving the same report as cpu.* metrics.
+ *       The memory report ('M') adds each stage's painted stack depth on
+ *       the host (mem.*), and the display frames the worst time from a
+ *       plug-in in the trace to the first frame after it.
+ *
+ *   budget_gate size [--out f] [--exclude name ...] <env> <image> [file.ci | file.su | dir ...]
+ *       Flash, .data, .bss and RAM of a firmware ELF, object or archive,
+ *       plus a worst-case stack estimate from GCC's -fcallgraph-info=su
+ *       files when given (<env>.*). With -fstack-usage (.su) files as
+ *       well, their frame sizes replace the call graph's, so a host build
+ *       supplies the calls for a target compiler too old to write them.
+ *       --exclude leaves functions whose name contains the text out of the
+ *       estimate (host-only code the targets do not run). Objects also
+ *       report their string literals outside PROGMEM (<env>.literals),
+ *       which the ATmega328P copies into SRAM at startup.
+ *
+ *   budget_gate check [--update] <baseline> <metrics> [metrics ...]
+ *       Compares against the baseline and prints a table; exits 1 if any
+ *       metric is over its allowance or limit. --update rewrites the
+ *       baseline values from the measurements, keeping the allowances.
+ *
+ * Baseline lines are "<metric> <value|-> <allowance> [max <limit>]" with
+ * the allowance as "+N%", "+N" or "-" (limit only).
+ */
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+#ifndef _WIN32
+#include <dirent.h>
+#include <sys/stat.h>
+#endif
+#include "Ssd1306Panel.h"
+#include "TraceReplay.h"
+#include "VirtualHardware.h"
+#include "config.h"
+
+namespace {
+
+typedef std::map<std::string, double> Metrics;
+
+FILE* openOutput(const char* path) {
+    FILE* out = path ? fopen(path, "w") : stdout;
+    if (!out) {
+        perror(path);
+    }
+    return out;
+}
+
+void writeMetrics(FILE* out, const std::vector<std::pair<std::string, double> >& metrics) {
+    for (size_t i = 0; i < metrics.size(); i++) {
+        fprintf(out, "%s %.0f\n", metrics[i].first.c_str(), metrics[i].second);
+    }
+}
+
+// loop
+
+/**
+ * @brief Stage statistics from the last task report in the serial output
+ */
+bool readTaskReport(FILE* serial, std::vector<std::pair<std::string, double> >* metrics, const char* prefix) {
+    char line[256];
+    std::vector<std::pair<std::string, double> > latest;
+    bool found = false;
+    
+    rewind(serial);
+    while (fgets(line, sizeof(line), serial)) {
+        if (strncmp(line, "--- Tasks", 9) == 0) {
+            latest.clear();
+            found = true;
+            continue;
+        }
+        char name[32];
+        unsigned long runs, overruns, skipped, lateAvg, lateMax, jitter, longest;
+        if (sscanf(line, "%31[^:]: %lu runs, %lu overruns, %lu skipped, late avg %lu max %lu jitter %lu, longest run %lu",
+                   name, &runs, &overruns, &skipped, &lateAvg, &lateMax, &jitter, &longest) == 8) {
+            std::string stage = std::string(prefix) + "." + name;
+            latest.push_back(std::make_pair(stage + ".run_max_us", (double)longest));
+            latest.push_back(std::make_pair(stage + ".late_max_us", (double)lateMax));
+            latest.push_back(std::make_pair(stage + ".overruns", (double)overruns));
+        }
+    }
+    metrics->insert(metrics->end(), latest.begin(), latest.end());
+    return found && !latest.empty();
+}
+
+/**
+ * @brief Stack depth per stage from the last memory report in the serial output
+ */
+bool readMemoryReport(FILE* serial, std::vector<std::pair<std::string, double> >* metrics) {
+    char line[256];
+    std::vector<std::pair<std::string, double> > latest;
+    bool found = false;
+    
+    rewind(serial);
+    while (fgets(line, sizeof(line), serial)) {
+        if (strncmp(line, "--- Memory", 10) == 0) {
+            latest.clear();
+            found = true;
+            continue;
+        }
+        char name[32];
+        unsigned long stackUsed, stackFree, heapUsed, heapFree, runs;
+        if (sscanf(line, "%31[^:]: stack %lu used %lu free, heap %lu used %lu free, %lu runs",
+                   name, &stackUsed, &stackFree, &heapUsed, &heapFree, &runs) == 6) {
+            latest.push_back(std::make_pair(std::string("mem.") + name + ".stack_bytes", (double)stackUsed));
+        }
+    }
+    metrics->insert(metrics->end(), latest.begin(), latest.end());
+    return found && !latest.empty();
+}
+
+/**
+ * @brief Frame listener: device time of every frame the panel received
+ */
+void recordFrame(const Ssd1306Panel& panel, void* context) {
+    (void)panel;
+    ((std::vector<uint64_t>*)context)->push_back(VirtualHardware::nowMicros());
+}
+
+/**
+ * @brief Longest time from a plug-in to the next frame (the first showing the pack)
+ * @return Milliseconds, or -1 if a plug-in was never followed by a frame
+ */
+double connectToDisplayMs(const std::vector<unsigned long>& plugInMs, const std::vector<uint64_t>& frameUs) {
+    double worst = 0.0;
+    for (size_t i = 0; i < plugInMs.size(); i++) {
+        uint64_t plugUs = (uint64_t)plugInMs[i] * 1000;
+        std::vector<uint64_t>::const_iterator frame = std::lower_bound(frameUs.begin(), frameUs.end(), plugUs);
+        if (frame == frameUs.end()) {
+            return -1.0;
+        }
+        worst = std::max(worst, (*frame - plugUs) / 1000.0);
+    }
+    return worst;
+}
+
+int runLoop(int argc, char* argv[]) {
+    const char* tracePath = nullptr;
+    const char* outPath = nullptr;
+    bool volts = false;
+    double cpuScale = 0.0;
+    
+    for (int i = 0; i < argc; i++) {
+        if (strcmp(argv[i], "--volts") == 0) {
+            volts = true;
+        } else if (strcmp(argv[i], "--cpu-scale") == 0 && i + 1 < argc) {
+            cpuScale = atof(argv[++i]);
+        } else if (strcmp(argv[i], "--out") == 0 && i + 1 < argc) {
+            outPath = argv[++i];
+        } else if (argv[i][0] != '-' && !tracePath) {
+            tracePath = argv[i];
+        } else {
+            fprintf(stderr, "Usage: budget_gate loop [--volts] [--cpu-scale x] [--out file] trace\n");
+            return 1;
+        }
+    }
+    
+    TraceReplay replay;
+    if (!tracePath || !replay.load(tracePath, volts)) {
+        fprintf(stderr, "Usage: budget_gate loop [--volts] [--cpu-scale x] [--out file] trace\n");
+        return 1;
+    }
+    // Task and memory reports once the trace is over, then time for the input task to answer
+    unsigned long reportMs = replay.getLastEventMs() + 1000;
+    replay.addSerial(reportMs, "TM");
+    
+    FILE* serial = tmpfile();
+    if (!serial) {
+        perror("tmpfile");
+        return 1;
+    }
+    Ssd1306Panel panel;
+    std::vector<uint64_t> frameUs;
+    panel.setFrameListener(recordFrame, &frameUs);
+    VirtualHardware::reset();
+    VirtualHardware::attachI2cDevice(SCREEN_ADDRESS, &panel);
+    VirtualHardware::setSerialOutput(serial);
+    VirtualHardware::setCpuClockScale(cpuScale);
+    
+    replay.powerOn();
+    replay.runUntil(reportMs + 200);
+    fflush(serial);
+    
+    const char* prefix = cpuScale > 0.0 ? "cpu" : "loop";
+    std::vector<std::pair<std::string, double> > metrics;
+    if (!readTaskReport(serial, &metrics, prefix)) {
+        fprintf(stderr, "No task report in the serial output (is DEBUG_VERBOSITY below DEBUG_LEVEL_DISPLAY?)\n");
+        fclose(serial);
+        return 1;
+    }
+    if (cpuScale <= 0.0 && !readMemoryReport(serial, &metrics)) {
+        fprintf(stderr, "No memory report in the serial output (built without MEMORY_MONITOR?)\n");
+        fclose(serial);
+        return 1;
+    }
+    fclose(serial);
+    
+    std::string name(prefix);
+    if (cpuScale > 0.0) {
+        metrics.push_back(std::make_pair(name + ".pass_ns",
+                                         (double)replay.getLoopNanos() / (double)replay.getLoopCount()));
+    } else {
+        metrics.push_back(std::make_pair(name + ".setup_ms", replay.getSetupMicros() / 1000.0));
+        metrics.push_back(std::make_pair(name + ".frames", (double)panel.getFrameCount()));
+        double latencyMs = connectToDisplayMs(replay.getPlugInTimes(), frameUs);
+        if (latencyMs < 0.0) {
+            fprintf(stderr, "No display frame after a plug-in in the trace\n");
+            return 1;
+        }
+        metrics.push_back(std::make_pair(name + ".connect_display_ms", latencyMs));
+        metrics.push_back(std::make_pair(name + ".i2c_bytes", (double)VirtualHardware::getI2cBytes()));
+        metrics.push_back(std::make_pair(name + ".i2c_transactions", (double)VirtualHardware::getI2cTransactions()));
+        metrics.push_back(std::make_pair(name + ".serial_bytes", (double)VirtualHardware::getSerialBytes()));
+    }
+    
+    FILE* out = openOutput(outPath);
+    if (!out) {
+        return 1;
+    }
+    writeMetrics(out, metrics);
+    if (outPath) {
+        fclose(out);
+    }
+    return 0;
+}
+
+// size
+
+struct SectionTotals {
+    double flash;
+    double data;
+    double bss;
+    double literals;             // Mergeable string sections (.rodata.str*)
+};
+
+bool readFile(const char* path, std::vector<uint8_t>* bytes) {
+    FILE* in = fopen(path, "rb");
+    if (!in) {
+        perror(path);
+        return false;
+    }
+    uint8_t chunk[65536];
+    size_t n;
+    while ((n = fread(chunk, 1, sizeof(chunk), in)) > 0) {
+        bytes->insert(bytes->end(), chunk, chunk + n);
+    }
+    fclose(in);
+    return true;
+}
+
+uint64_t readLe(const uint8_t* p, int bytes) {
+    uint64_t value = 0;
+    for (int i = bytes - 1; i >= 0; i--) {
+        value = (value << 8) | p[i];
+    }
+    return value;
+}
+
+/**
+ * @brief Add the allocated sections of one little-endian ELF file
+ *
+ * Everything loaded from the image counts as flash (code, constants and the
+ * initial values of .data); writable loaded sections are .data; allocated
+ * sections without file contents are .bss. Fuse, lock, signature, EEPROM
+ * and address-space placeholder sections are not memory. Unlinked objects
+ * keep their string literals in .rodata.str* sections; F() and PROGMEM
+ * text is elsewhere.
+ */
+bool addElf(const uint8_t* elf, size_t size, SectionTotals* totals) {
+    if (size < 52 || memcmp(elf, "\177ELF", 4) != 0 || elf[5] != 1) {
+        return false;
+    }
+    bool is64 = elf[4] == 2;
+    uint64_t shoff = is64 ? readLe(elf + 0x28, 8) : readLe(elf + 0x20, 4);
+    unsigned shentsize = (unsigned)readLe(elf + (is64 ? 0x3A : 0x2E), 2);
+    unsigned shnum = (unsigned)readLe(elf + (is64 ? 0x3C : 0x30), 2);
+    unsigned shstrndx = (unsigned)readLe(elf + (is64 ? 0x3E : 0x32), 2);
+    if (shoff == 0 || shstrndx >= shnum || shoff + (uint64_t)shnum * shentsize > size) {
+        return false;
+    }
+    
+    const uint8_t* names = elf + shoff + (uint64_t)shstrndx * shentsize;
+    uint64_t namesOffset = is64 ? readLe(names + 0x18, 8) : readLe(names + 0x10, 4);
+    
+    for (unsigned i = 0; i < shnum; i++) {
+        const uint8_t* header = elf + shoff + (uint64_t)i * shentsize;
+        uint32_t nameIndex = (uint32_t)readLe(header, 4);
+        uint32_t type = (uint32_t)readLe(header + 4, 4);
+        uint64_t flags = is64 ? readLe(header + 8, 8) : readLe(header + 8, 4);
+        uint64_t sectionSize = is64 ? readLe(header + 0x20, 8) : readLe(header + 0x14, 4);
+        const char* name = namesOffset + nameIndex < size ? (const char*)elf + namesOffset + nameIndex : "";
+        
+        const uint64_t SHF_WRITE = 0x1;
+        const uint64_t SHF_ALLOC = 0x2;
+        const uint32_t SHT_NOBITS = 8;
+        if (!(flags & SHF_ALLOC) || strstr(name, "dummy") || strcmp(name, ".eeprom") == 0 ||
+            strcmp(name, ".fuse") == 0 || strcmp(name, ".lock") == 0 || strcmp(name, ".signature") == 0 ||
+            strcmp(name, ".user_signatures") == 0) {
+            continue;
+        }
+        if (strncmp(name, ".rodata.str", 11) == 0) {
+            totals->literals += (double)sectionSize;
+        }
+        if (type == SHT_NOBITS) {
+            totals->bss += (double)sectionSize;
+        } else {
+            totals->flash += (double)sectionSize;
+            if (flags & SHF_WRITE) {
+                totals->data += (double)sectionSize;
+            }
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief An ELF file, or every ELF member of an ar archive (a static library)
+ */
+bool addImage(const std::vector<uint8_t>& image, SectionTotals* totals) {
+    if (image.size() < 8 || memcmp(image.data(), "!<arch>\n", 8) != 0) {
+        return addElf(image.data(), image.size(), totals);
+    }
+    size_t at = 8;
+    int members = 0;
+    while (at + 60 <= image.size()) {
+        const char* header = (const char*)image.data() + at;
+        size_t memberSize = strtoul(std::string(header + 48, 10).c_str(), nullptr, 10);
+        at += 60;
+        if (at + memberSize > image.size()) {
+            break;
+        }
+        if (addElf(image.data() + at, memberSize, totals)) {
+            members++;
+        }
+        at += memberSize + (memberSize & 1);
+    }
+    return members > 0;
+}
+
+struct CallNode {
+    std::string name;
+    long bytes;                  // -1 when not compiled with call graph info
+    bool dynamic;
+    bool called;                 // Has a direct caller
+    std::vector<int> callees;
+};
+
+struct CallGraph {
+    std::vector<CallNode> nodes;
+    std::map<std::string, int> index;
+    
+    int node(const std::string& title) {
+        std::map<std::string, int>::iterator found = index.find(title);
+        if (found != index.end()) {
+            return found->second;
+        }
+        CallNode created;
+        created.name = title;
+        created.bytes = -1;
+        created.dynamic = false;
+        created.called = false;
+        nodes.push_back(created);
+        index[title] = (int)nodes.size() - 1;
+        return (int)nodes.size() - 1;
+    }
+};
+
+bool quoted(const std::string& line, const char* key, std::string* value) {
+    size_t start = line.find(key);
+    if (start == std::string::npos) {
+        return false;
+    }
+    start += strlen(key);
+    size_t end = line.find('"', start);
+    if (end == std::string::npos) {
+        return false;
+    }
+    *value = line.substr(start, end - start);
+    return true;
+}
+
+/**
+ * @brief Nodes and edges of one -fcallgraph-info=su file (VCG format)
+ */
+bool readCallGraph(const char* path, CallGraph* graph) {
+    FILE* in = fopen(path, "r");
+    if (!in) {
+        perror(path);
+        return false;
+    }
+    char buffer[4096];
+    while (fgets(buffer, sizeof(buffer), in)) {
+        std::string line(buffer);
+        std::string title, label, source, target;
+        if (line.compare(0, 5, "node:") == 0 && quoted(line, "title: \"", &title) &&
+            quoted(line, "label: \"", &label)) {
+            CallNode& node = graph->nodes[graph->node(title)];
+            size_t end = label.find("\\n");
+            size_t bytesAt = label.rfind("\\n");
+            long bytes;
+            if (bytesAt != std::string::npos && sscanf(label.c_str() + bytesAt + 2, "%ld bytes", &bytes) == 1) {
+                node.bytes = std::max(node.bytes, bytes);
+                // "dynamic,bounded" frames are reported at their bound
+                node.dynamic = node.dynamic || (label.find("dynamic", bytesAt) != std::string::npos &&
+                                                label.find("bounded", bytesAt) == std::string::npos);
+            }
+            if (end != std::string::npos && node.bytes >= 0) {
+                node.name = label.substr(0, end);
+            }
+        } else if (line.compare(0, 5, "edge:") == 0 && quoted(line, "sourcename: \"", &source) &&
+                   quoted(line, "targetname: \"", &target)) {
+            int from = graph->node(source);
+            int to = graph->node(target);
+            graph->nodes[from].callees.push_back(to);
+            graph->nodes[to].called = true;
+        }
+    }
+    fclose(in);
+    return true;
+}
+
+/**
+ * @brief Frame sizes from one -fstack-usage file, keyed by the function
+ * signature GCC prints ("file:line:col:signature<TAB>bytes<TAB>qualifier")
+ */
+bool readStackUsage(const char* path, std::map<std::string, std::pair<long, bool> >* frames) {
+    FILE* in = fopen(path, "r");
+    if (!in) {
+        perror(path);
+        return false;
+    }
+    char buffer[4096];
+    while (fgets(buffer, sizeof(buffer), in)) {
+        std::string line(buffer);
+        size_t tab = line.find('\t');
+        if (tab == std::string::npos) {
+            continue;
+        }
+        // The signature follows ":<line>:<column>:"; the path may contain ':' itself
+        size_t start = std::string::npos;
+        for (size_t i = 0; i < tab && start == std::string::npos; i++) {
+            if (buffer[i] != ':') {
+                continue;
+            }
+            size_t column = i + 1 + strspn(buffer + i + 1, "0123456789");
+            if (column == i + 1 || buffer[column] != ':') {
+                continue;
+            }
+            size_t signature = column + 1 + strspn(buffer + column + 1, "0123456789");
+            if (signature > column + 1 && buffer[signature] == ':') {
+                start = signature + 1;
+            }
+        }
+        long bytes;
+        if (start == std::string::npos || sscanf(buffer + tab + 1, "%ld", &bytes) != 1) {
+            continue;
+        }
+        std::pair<long, bool>& frame = (*frames)[line.substr(start, tab - start)];
+        frame.first = std::max(frame.first, bytes);
+        frame.second = frame.second || (line.find("dynamic", tab) != std::string::npos &&
+                                        line.find("bounded", tab) == std::string::npos);
+    }
+    fclose(in);
+    return true;
+}
+
+void collectFiles(const std::string& path, std::vector<std::string>* callGraphs,
+                  std::vector<std::string>* stackUsage) {
+#ifndef _WIN32
+    struct stat info;
+    if (stat(path.c_str(), &info) == 0 && S_ISDIR(info.st_mode)) {
+        DIR* dir = opendir(path.c_str());
+        if (!dir) {
+            return;
+        }
+        while (struct dirent* entry = readdir(dir)) {
+            if (entry->d_name[0] != '.') {
+                collectFiles(path + "/" + entry->d_name, callGraphs, stackUsage);
+            }
+        }
+        closedir(dir);
+        return;
+    }
+#endif
+    if (path.size() > 3 && path.compare(path.size() - 3, 3, ".ci") == 0) {
+        callGraphs->push_back(path);
+    } else if (path.size() > 3 && path.compare(path.size() - 3, 3, ".su") == 0) {
+        stackUsage->push_back(path);
+    }
+}
+
+/**
+ * @brief Deepest stack below each node, memoized
+ *
+ * An indirect call (function pointer or virtual call) may reach any
+ * function that is never called directly, so it costs the deepest of
+ * those; an indirect call made below one of them is not followed again. A
+ * call back into a function already on the path (recursion) is cut. Both
+ * are reported.
+ */
+class StackEstimator {
+public:
+    explicit StackEstimator(CallGraph& graph)
+        : graph(graph), recursion(false), nestedIndirect(false), dynamic(false), unknown(0) {
+        depth.assign(graph.nodes.size(), -1);
+        next.assign(graph.nodes.size(), -1);
+        onPath.assign(graph.nodes.size(), false);
+        std::map<std::string, int>::iterator placeholder = graph.index.find("__indirect_call");
+        indirect = placeholder == graph.index.end() ? -1 : placeholder->second;
+    }
+    
+    void addIndirectTarget(int node) {
+        indirectTargets.push_back(node);
+    }
+    
+    long deepest(int node) {
+        if (depth[node] >= 0) {
+            return depth[node];
+        }
+        if (onPath[node]) {
+            if (node == indirect) {
+                nestedIndirect = true;
+            } else {
+                recursion = true;
+            }
+            return 0;
+        }
+        onPath[node] = true;
+        const CallNode& current = graph.nodes[node];
+        const std::vector<int>& callees = node == indirect ? indirectTargets : current.callees;
+        long below = 0;
+        int via = -1;
+        for (size_t i = 0; i < callees.size(); i++) {
+            long d = deepest(callees[i]);
+            if (d > below || via < 0) {
+                below = d;
+                via = callees[i];
+            }
+        }
+        onPath[node] = false;
+        
+        long own = node == indirect ? 0 : current.bytes;
+        if (own < 0) {
+            own = 0;
+            unknown++;
+        }
+        dynamic = dynamic || current.dynamic;
+        depth[node] = own + below;
+        next[node] = via;
+        return depth[node];
+    }
+    
+    void printChain(FILE* out, int node) const {
+        for (int count = 0; node >= 0 && count < 64; count++) {
+            const CallNode& current = graph.nodes[node];
+            if (node != indirect) {
+                fprintf(out, "    %6ld  %s\n", current.bytes, current.name.c_str());
+            } else {
+                fprintf(out, "            (indirect call)\n");
+            }
+            node = next[node];
+        }
+    }
+    
+    bool sawRecursion() const { return recursion; }
+    bool sawNestedIndirect() const { return nestedIndirect; }
+    bool sawDynamic() const { return dynamic; }
+    int unknownFrames() const { return unknown; }
+
+private:
+    CallGraph& graph;
+    std::vector<long> depth;
+    std::vector<int> next;
+    std::vector<bool> onPath;
+    std::vector<int> indirectTargets;
+    int indirect;
+    bool recursion;
+    bool nestedIndirect;
+    bool dynamic;
+    int unknown;
+};
+
+/**
+ * @brief Replace the graph's frame sizes with another build's -fstack-usage
+ * figures, matched by signature
+ *
+ * Compilers before GCC 10 cannot write call graphs, but they all write
+ * .su files. The same sources compiled for the host give the calls; the
+ * target's .su files give its frame sizes. Functions the target has no
+ * frame for (inlined there, or host only) count as 0.
+ */
+bool applyStackUsage(const std::vector<std::string>& files, CallGraph* graph, const char* env) {
+    std::map<std::string, std::pair<long, bool> > frames;
+    for (size_t i = 0; i < files.size(); i++) {
+        if (!readStackUsage(files[i].c_str(), &frames)) {
+            return false;
+        }
+    }
+    int defined = 0;
+    int matched = 0;
+    for (size_t i = 0; i < graph->nodes.size(); i++) {
+        CallNode& node = graph->nodes[i];
+        if (node.bytes < 0) {
+            continue;
+        }
+        defined++;
+        std::map<std::string, std::pair<long, bool> >::const_iterator frame = frames.find(node.name);
+        if (frame != frames.end()) {
+            node.bytes = frame->second.first;
+            node.dynamic = frame->second.second;
+            matched++;
+        } else {
+            node.bytes = 0;
+            node.dynamic = false;
+        }
+    }
+    fprintf(stderr, "%s: %d of %d call graph functions have a frame in the %zu .su files\n", env, matched, defined,
+            files.size());
+    return true;
+}
+
+bool isInterrupt(const std::string& title) {
+    return title.compare(0, 9, "__vector_") == 0;
+}
+
+/**
+ * @brief Worst-case stack: deepest path from main() (or setup() and loop()
+ * when main() was not compiled with call graph info), plus the deepest
+ * interrupt handler on top of it
+ */
+long estimateStack(CallGraph& graph, const char* env) {
+    std::vector<int> roots;
+    std::map<std::string, int>::iterator main = graph.index.find("main");
+    if (main != graph.index.end() && graph.nodes[main->second].bytes >= 0) {
+        roots.push_back(main->second);
+    } else {
+        const char* entries[] = {"_Z5setupv", "_Z4loopv"};
+        for (int i = 0; i < 2; i++) {
+            std::map<std::string, int>::iterator found = graph.index.find(entries[i]);
+            if (found != graph.index.end()) {
+                roots.push_back(found->second);
+            }
+        }
+    }
+    if (roots.empty()) {
+        fprintf(stderr, "%s: no main(), setup() or loop() in the call graph\n", env);
+        return -1;
+    }
+    
+    StackEstimator estimator(graph);
+    std::vector<int> interrupts;
+    for (std::map<std::string, int>::iterator it = graph.index.begin(); it != graph.index.end(); ++it) {
+        const CallNode& node = graph.nodes[it->second];
+        if (isInterrupt(it->first)) {
+            interrupts.push_back(it->second);
+        } else if (!node.called && node.bytes >= 0 && std::find(roots.begin(), roots.end(), it->second) == roots.end()) {
+            estimator.addIndirectTarget(it->second);
+        }
+    }
+    
+    int deepestRoot = roots[0];
+    long stack = 0;
+    for (size_t i = 0; i < roots.size(); i++) {
+        long d = estimator.deepest(roots[i]);
+        if (d > stack) {
+            stack = d;
+            deepestRoot = roots[i];
+        }
+    }
+    int deepestInterrupt = -1;
+    long interruptStack = 0;
+    for (size_t i = 0; i < interrupts.size(); i++) {
+        long d = estimator.deepest(interrupts[i]);
+        if (d > interruptStack) {
+            interruptStack = d;
+            deepestInterrupt = interrupts[i];
+        }
+    }
+    
+    fprintf(stderr, "%s: estimated stack %ld bytes, deepest chain (bytes, function):\n", env, stack + interruptStack);
+    estimator.printChain(stderr, deepestRoot);
+    if (deepestInterrupt >= 0) {
+        fprintf(stderr, "  plus interrupt:\n");
+        estimator.printChain(stderr, deepestInterrupt);
+    }
+    if (estimator.unknownFrames() > 0) {
+        fprintf(stderr, "  %d called functions have no stack info (counted as 0)\n", estimator.unknownFrames());
+    }
+    if (estimator.sawRecursion()) {
+        fprintf(stderr, "  recursion cut after one level\n");
+    }
+    if (estimator.sawNestedIndirect()) {
+        fprintf(stderr, "  indirect calls made from indirectly called functions not followed\n");
+    }
+    if (estimator.sawDynamic()) {
+        fprintf(stderr, "  unbounded dynamic frames (alloca / VLAs) counted at their static part\n");
+    }
+    return stack + interruptStack;
+}
+
+/**
+ * @brief Give functions whose name contains one of the texts no frame and
+ * no callees
+ */
+void excludeFunctions(const std::vector<const char*>& excluded, CallGraph* graph, const char* env) {
+    for (size_t i = 0; i < graph->nodes.size(); i++) {
+        CallNode& node = graph->nodes[i];
+        for (size_t e = 0; e < excluded.size(); e++) {
+            if (node.name.find(excluded[e]) != std::string::npos) {
+                fprintf(stderr, "%s: %s excluded (%ld bytes)\n", env, node.name.c_str(), node.bytes);
+                node.bytes = 0;
+                node.dynamic = false;
+                node.callees.clear();
+                break;
+            }
+        }
+    }
+}
+
+int runSize(int argc, char* argv[]) {
+    const char* outPath = nullptr;
+    std::vector<const char*> args;
+    std::vector<const char*> excluded;
+    for (int i = 0; i < argc; i++) {
+        if (strcmp(argv[i], "--out") == 0 && i + 1 < argc) {
+            outPath = argv[++i];
+        } else if (strcmp(argv[i], "--exclude") == 0 && i + 1 < argc) {
+            excluded.push_back(argv[++i]);
+        } else {
+            args.push_back(argv[i]);
+        }
+    }
+    if (args.size() < 2) {
+        fprintf(stderr, "Usage: budget_gate size [--out file] [--exclude name ...] <env> <image> "
+                        "[file.ci | file.su | dir ...]\n");
+        return 1;
+    }
+    std::string env = args[0];
+    
+    std::vector<uint8_t> image;
+    SectionTotals totals = {0.0, 0.0, 0.0, 0.0};
+    if (!readFile(args[1], &image)) {
+        return 1;
+    }
+    if (!addImage(image, &totals)) {
+        fprintf(stderr, "%s: not a little-endian ELF file or archive of them\n", args[1]);
+        return 1;
+    }
+    
+    std::vector<std::pair<std::string, double> > metrics;
+    metrics.push_back(std::make_pair(env + ".flash", totals.flash));
+    metrics.push_back(std::make_pair(env + ".data", totals.data));
+    metrics.push_back(std::make_pair(env + ".bss", totals.bss));
+    metrics.push_back(std::make_pair(env + ".ram", totals.data + totals.bss));
+    if (totals.literals > 0.0) {
+        // Linked images merge them into .data (AVR) or flash constants
+        metrics.push_back(std::make_pair(env + ".literals", totals.literals));
+    }
+    
+    std::vector<std::string> callGraphs;
+    std::vector<std::string> stackUsage;
+    for (size_t i = 2; i < args.size(); i++) {
+        collectFiles(args[i], &callGraphs, &stackUsage);
+    }
+    if (!callGraphs.empty()) {
+        CallGraph graph;
+        for (size_t i = 0; i < callGraphs.size(); i++) {
+            if (!readCallGraph(callGraphs[i].c_str(), &graph)) {
+                return 1;
+            }
+        }
+        if (!stackUsage.empty() && !applyStackUsage(stackUsage, &graph, env.c_str())) {
+            return 1;
+        }
+        excludeFunctions(excluded, &graph, env.c_str());
+        long stack = estimateStack(graph, env.c_str());
+        if (stack >= 0) {
+            metrics.push_back(std::make_pair(env + ".stack", (double)stack));
+            metrics.push_back(std::make_pair(env + ".ram_with_stack", totals.data + totals.bss + stack));
+        }
+    } else if (args.size() > 2) {
+        fprintf(stderr, "%s: no .ci files found; build with -fcallgraph-info=su (GCC 10+) for a stack estimate\n",
+                env.c_str());
+    }
+    
+    FILE* out = openOutput(outPath);
+    if (!out) {
+        return 1;
+    }
+    writeMetrics(out, metrics);
+    if (outPath) {
+        fclose(out);
+    }
+    return 0;
+}
+
+// check
+
+struct Budget {
+    bool hasBaseline;
+    double baseline;
+    bool percent;                // Allowance in % of the baseline, else absolute
+    bool hasAllowance;
+    double allowance;
+    bool hasLimit;
+    double limit;
+};
+
+bool parseBudget(const char* text, std::string* name, Budget* budget) {
+    char metric[128], value[32], allowance[32], keyword[16];
+    double limit;
+    int fields = sscanf(text, "%127s %31s %31s %15s %lf", metric, value, allowance, keyword, &limit);
+    if (fields < 3 || (fields > 3 && (fields != 5 || strcmp(keyword, "max") != 0))) {
+        return false;
+    }
+    *name = metric;
+    budget->hasBaseline = strcmp(value, "-") != 0;
+    budget->baseline = budget->hasBaseline ? atof(value) : 0.0;
+    budget->hasAllowance = strcmp(allowance, "-") != 0;
+    budget->percent = strchr(allowance, '%') != nullptr;
+    budget->allowance = budget->hasAllowance ? atof(allowance[0] == '+' ? allowance + 1 : allowance) : 0.0;
+    budget->hasLimit = fields == 5;
+    budget->limit = budget->hasLimit ? limit : 0.0;
+    return true;
+}
+
+bool readMetrics(const char* path, Metrics* metrics) {
+    FILE* in = strcmp(path, "-") == 0 ? stdin : fopen(path, "r");
+    if (!in) {
+        perror(path);
+        return false;
+    }
+    char line[256], name[128];
+    double value;
+    while (fgets(line, sizeof(line), in)) {
+        if (line[0] != '#' && sscanf(line, "%127s %lf", name, &value) == 2) {
+            (*metrics)[name] = value;
+        }
+    }
+    if (in != stdin) {
+        fclose(in);
+    }
+    return true;
+}
+
+/**
+ * @brief Default allowance for a metric first seen by --update
+ */
+const char* defaultAllowance(const std::string& name) {
+    if (name.compare(0, 4, "cpu.") == 0) return "+200%";
+    if (name.compare(0, 5, "loop.") == 0) return "+10%";
+    if (name.compare(0, 4, "mem.") == 0) return "+25%";
+    return "+2%";
+}
+
+std::string formatNumber(double value) {
+    char text[32];
+    snprintf(text, sizeof(text), "%.0f", value);
+    return text;
+}
+
+int runCheck(int argc, char* argv[]) {
+    bool update = false;
+    std::vector<const char*> args;
+    for (int i = 0; i < argc; i++) {
+        if (strcmp(argv[i], "--update") == 0) {
+            update = true;
+        } else {
+            args.push_back(argv[i]);
+        }
+    }
+    if (args.size() < 2) {
+        fprintf(stderr, "Usage: budget_gate check [--update] <baseline> <metrics> [metrics ...]\n");
+        return 1;
+    }
+    
+    Metrics current;
+    for (size_t i = 1; i < args.size(); i++) {
+        if (!readMetrics(args[i], &current)) {
+            return 1;
+        }
+    }
+    
+    FILE* in = fopen(args[0], "r");
+    if (!in) {
+        perror(args[0]);
+        return 1;
+    }
+    std::vector<std::string> lines;
+    char buffer[256];
+    while (fgets(buffer, sizeof(buffer), in)) {
+        lines.push_back(buffer);
+    }
+    fclose(in);
+    
+    printf("%-34s %10s %10s %9s %10s  %s\n", "metric", "baseline", "current", "change", "allowed", "status");
+    int failures = 0;
+    int improved = 0;
+    std::set<std::string> seen;
+    std::vector<std::string> updated;
+    
+    for (size_t i = 0; i < lines.size(); i++) {
+        std::string name;
+        Budget budget;
+        const char* text = lines[i].c_str() + strspn(lines[i].c_str(), " \t");
+        if (*text == '#' || *text == '\n' || *text == '\0' || !parseBudget(text, &name, &budget)) {
+            updated.push_back(lines[i]);
+            continue;
+        }
+        seen.insert(name);
+        Metrics::const_iterator measured = current.find(name);
+        
+        double allowed = budget.hasLimit ? budget.limit : 0.0;
+        double over = 0.0;
+        if (budget.hasBaseline && budget.hasAllowance) {
+            over = budget.percent ? budget.baseline * budget.allowance / 100.0 : budget.allowance;
+            allowed = budget.hasLimit ? std::min(budget.limit, budget.baseline + over) : budget.baseline + over;
+        }
+        bool bounded = budget.hasLimit || (budget.hasBaseline && budget.hasAllowance);
+        
+        std::string status;
+        std::string change = "";
+        if (measured == current.end()) {
+            status = "not measured";
+        } else {
+            double value = measured->second;
+            if (budget.hasBaseline) {
+                char text[32];
+                double delta = value - budget.baseline;
+                if (budget.baseline != 0.0) {
+                    snprintf(text, sizeof(text), "%+.1f%%", delta * 100.0 / budget.baseline);
+                } else {
+                    snprintf(text, sizeof(text), "%+.0f", delta);
+                }
+                change = text;
+            }
+            if (bounded && value > allowed) {
+                status = budget.hasLimit && value > budget.limit ? "FAIL over limit" : "FAIL";
+                failures++;
+            } else if (budget.hasBaseline && budget.hasAllowance &&
+                       value < budget.baseline - over) {
+                status = "improved";
+                improved++;
+            } else {
+                status = "ok";
+            }
+        }
+        printf("%-34s %10s %10s %9s %10s  %s\n", name.c_str(),
+               budget.hasBaseline ? formatNumber(budget.baseline).c_str() : "-",
+               measured != current.end() ? formatNumber(measured->second).c_str() : "-", change.c_str(),
+               bounded ? formatNumber(allowed).c_str() : "-", status.c_str());
+        
+        if (update && measured != current.end()) {
+            // Same columns with the new baseline value
+            char allowance[32], rest[64] = "";
+            sscanf(text, "%*s %*s %31s %63[^\n]", allowance, rest);
+            char line[256];
+            snprintf(line, sizeof(line), "%-34s %10s %8s%s%s\n", name.c_str(), formatNumber(measured->second).c_str(),
+                     allowance, rest[0] ? " " : "", rest);
+            updated.push_back(line);
+        } else {
+            updated.push_back(lines[i]);
+        }
+    }
+    
+    for (Metrics::const_iterator it = current.begin(); it != current.end(); ++it) {
+        if (seen.count(it->first) == 0) {
+            printf("%-34s %10s %10s %9s %10s  %s\n", it->first.c_str(), "-", formatNumber(it->second).c_str(), "",
+                   "-", "new");
+            if (update) {
+                char line[256];
+                snprintf(line, sizeof(line), "%-34s %10s %8s\n", it->first.c_str(), formatNumber(it->second).c_str(),
+                         defaultAllowance(it->first));
+                updated.push_back(line);
+            }
+        }
+    }
+    
+    if (update) {
+        FILE* out = fopen(args[0], "w");
+        if (!out) {
+            perror(args[0]);
+            return 1;
+        }
+        for (size_t i = 0; i < updated.size(); i++) {
+            fputs(updated[i].c_str(), out);
+        }
+        fclose(out);
+        printf("\nBaseline %s updated\n", args[0]);
+        return 0;
+    }
+    
+    if (failures > 0) {
+        printf("\n%d metric%s over budget\n", failures, failures == 1 ? "" : "s");
+        return 1;
+    }
+    printf("\nAll measured metrics within budget%s\n",
+           improved > 0 ? " (some improved: refresh the baseline with --update)" : "");
+    return 0;
+}
+
+void usage() {
+    fprintf(stderr,
+            "Usage: budget_gate loop [--volts] [--cpu-scale x] [--out file] trace\n"
+            "       budget_gate size [--out file] <env> <image> [file.ci | file.su | dir ...]\n"
+            "       budget_gate check [--update] <baseline> <metrics> [metrics ...]\n");
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    if (argc < 2) {
+        usage();
+        return 1;
+    }
+    if (strcmp(argv[1], "loop") == 0) {
+        return runLoop(argc - 2, argv + 2);
+    }
+    if (strcmp(argv[1], "size") == 0) {
+        return runSize(argc - 2, argv + 2);
+    }
+    if (strcmp(argv[1], "check") == 0) {
+        return runCheck(argc - 2, argv + 2);
+    }
+    usage();
+    return 1;
+}
@@ -0,0 +1,224 @@
+/**
+ * @brief Render fixed screens through DisplayManager and compare them with golden images
+ *
+ * Runs the production DisplayManager on the host Arduino core with the
+ * SSD1306 emulator on the virtual bus, so each screen is what the panel
+ * reconstructs from the firmware's I2C traffic, not the library's buffer.
+ * Every case is compared with <dir>/<case>.pbm; any differing pixel fails.
+ *
+ *   display_golden simulator/golden            compare, exit 1 on a mismatch
+ *   display_golden --update simulator/golden   rewrite the golden images
+ *   display_golden --show simulator/golden     also print each screen
+ *
+ * The bus traffic per frame is listed for each case.
+ */
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include "DisplayManager.h"
+#include "SessionHistory.h"
+#include "Ssd1306Panel.h"
+#include "VirtualHardware.h"
+#include "config.h"
+
+namespace {
+
+BatteryInfo pack(int cells, float cellVoltage, int percent) {
+    BatteryInfo info;
+    memset(&info, 0, sizeof(info));
+    info.cellCount = cells;
+    info.averageCellVoltage = cellVoltage;
+    info.totalVoltage = cells * cellVoltage;
+    info.chargePercentage = percent;
+    info.isValid = true;
+    info.cellConfidence = 100;
+    return info;
+}
+
+const TrendInfo NO_TREND = { false, 0.0f, -1 };
+
+void renderInvalid() {
+    BatteryInfo info = pack(0, 0.0f, 0);
+    info.isValid = false;
+    DisplayManager::displayBatteryInfo(info);
+}
+
+void renderSingleCell() {
+    DisplayManager::displayBatteryInfo(pack(1, 4.2f, 100));
+}
+
+void renderThreeCells() {
+    DisplayManager::displayBatteryInfo(pack(3, 3.81f, 58));
+}
+
+void renderUncertainCount() {
+    BatteryInfo info = pack(4, 3.52f, 12);
+    info.cellConfidence = 67;
+    DisplayManager::displayBatteryInfo(info, NO_TREND);
+}
+
+void renderBalanceLeads() {
+    BatteryInfo info = pack(4, 3.90f, 71);
+    static const float cells[4] = { 3.93f, 3.91f, 3.86f, 3.90f };
+    info.balanceCells = 4;
+    for (int i = 0; i < 4 && i < BALANCE_MAX_CELLS; i++) {
+        info.cellVoltages[i] = cells[i];
+    }
+    info.imbalance = 0.07f;
+    info.weakestCell = 3;
+    DisplayManager::displayBatteryInfo(info);
+}
+
+void renderTrend() {
+    TrendInfo trend = { true, -41.7f, 23 };
+    DisplayManager::displayBatteryInfo(pack(6, 3.74f, 44), trend);
+}
+
+void renderTrendCharging() {
+    TrendInfo trend = { true, 12.0f, -1 };
+    DisplayManager::displayBatteryInfo(pack(2, 3.95f, 80), trend);
+}
+
+void renderError() {
+    DisplayManager::displayError("ADC timeout");
+}
+
+void renderInit() {
+    DisplayManager::displayInitMessage();
+}
+
+void renderChemistry() {
+    DisplayManager::displayChemistry("LiHV");
+}
+
+void renderNoBattery() {
+    DisplayManager::displayNoBattery();
+}
+
+void renderHistory() {
+    static SessionHistory history;
+    history.reset();
+    for (int i = 0; i < 120; i++) {
+        // Slow discharge with two load sags
+        float voltage = 12.6f - i * 0.01f - ((i % 50) < 3 ? 0.35f : 0.0f);
+        history.append(voltage);
+    }
+    DisplayManager::displayHistory(history);
+}
+
+struct GoldenCase {
+    const char* name;
+    void (*render)();
+};
+
+const GoldenCase CASES[] = {
+    { "invalid", renderInvalid },
+    { "single_cell", renderSingleCell },
+    { "three_cells", renderThreeCells },
+    { "uncertain_count", renderUncertainCount },
+    { "balance_leads", renderBalanceLeads },
+    { "trend", renderTrend },
+    { "trend_charging", renderTrendCharging },
+    { "error", renderError },
+    { "init", renderInit },
+    { "chemistry", renderChemistry },
+    { "no_battery", renderNoBattery },
+    { "history", renderHistory },
+};
+
+void usage() {
+    fprintf(stderr,
+            "Usage: display_golden [--update] [--show] dir\n"
+            "  --update  write the rendered screens as the new golden images\n"
+            "  --show    print each rendered screen as ASCII art\n");
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    const char* directory = nullptr;
+    bool update = false;
+    bool show = false;
+    
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--update") == 0) {
+            update = true;
+        } else if (strcmp(argv[i], "--show") == 0) {
+            show = true;
+        } else if (argv[i][0] != '-' && !directory) {
+            directory = argv[i];
+        } else {
+            usage();
+            return 1;
+        }
+    }
+    if (!directory) {
+        usage();
+        return 1;
+    }
+    
+    Ssd1306Panel panel;
+    VirtualHardware::reset();
+    VirtualHardware::attachI2cDevice(SCREEN_ADDRESS, &panel);
+    if (!DisplayManager::begin()) {
+        fprintf(stderr, "Display did not initialize\n");
+        return 1;
+    }
+    I2cScheduler& bus = I2cScheduler::shared();
+    
+    int failures = 0;
+    printf("  %-18s %6s %12s %7s %8s\n", "case", "result", "transactions", "bytes", "bus [us]");
+    for (size_t c = 0; c < sizeof(CASES) / sizeof(CASES[0]); c++) {
+        const GoldenCase& golden = CASES[c];
+        unsigned long frames = panel.getFrameCount();
+        uint64_t start = VirtualHardware::nowMicros();
+        golden.render();
+        bus.drain(micros());
+        uint64_t busMicros = VirtualHardware::nowMicros() - start;
+        
+        std::string path = std::string(directory) + "/" + golden.name + ".pbm";
+        const char* result = "ok";
+        if (panel.getFrameCount() != frames + 1) {
+            result = "FRAMES";
+            failures++;
+        } else if (update) {
+            FILE* file = fopen(path.c_str(), "w");
+            if (!file) {
+                perror(path.c_str());
+                return 1;
+            }
+            panel.writePbm(file);
+            fclose(file);
+            result = "written";
+        } else {
+            FILE* file = fopen(path.c_str(), "r");
+            long differences = file ? panel.compare(file) : -1;
+            if (file) {
+                fclose(file);
+            }
+            if (differences != 0) {
+                if (differences < 0) {
+                    fprintf(stderr, "%s: missing or not a %dx%d image\n", path.c_str(), panel.getWidth(),
+                            panel.getHeight());
+                } else {
+                    fprintf(stderr, "%s: %ld pixels differ; rendered:\n", path.c_str(), differences);
+                    panel.writeAscii(stderr);
+                }
+                result = "FAIL";
+                failures++;
+            }
+        }
+        printf("  %-18s %6s %12lu %7lu %8llu\n", golden.name, result, panel.getFrameTransactions(),
+               panel.getFrameBytes(), (unsigned long long)busMicros);
+        if (show) {
+            panel.writeAscii(stdout);
+        }
+    }
+    
+    if (failures) {
+        fprintf(stderr, "%d of %zu screens differ from the golden images (--update to accept)\n", failures,
+                sizeof(CASES) / sizeof(CASES[0]));
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,158 @@
+/**
+ * @brief Run thousands of virtual testers in one process and report how
+ * many the host can keep up with
+ *
+ * Each tester runs the firmware's measurement path on its own pack, ADC
+ * unit and clock and prints the real serial format (see host/FleetEmulator.h).
+ *
+ *   fleet_emulator --testers 5000 --seconds 600            as fast as possible, output discarded
+ *   fleet_emulator --testers 2000 --files out/             one log file per tester
+ *   fleet_emulator --testers 500 --realtime --pty ttys/    live PTYs: ingestd ttys/tester-*
+ *
+ * Prints records, bytes and samples, records/s overall and per core (per
+ * second of worker CPU time), and the real-time capacity: how many testers
+ * one core can run at device speed. With --realtime it also reports how far
+ * the workers fell behind the wall clock; any lag means the fleet is larger
+ * than the host supports.
+ */
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <signal.h>
+#include "FleetEmulator.h"
+#include "config.h"
+
+namespace {
+
+volatile sig_atomic_t stopRequested = 0;
+
+void onSignal(int) {
+    stopRequested = 1;
+}
+
+void usage() {
+    fprintf(stderr,
+            "Usage: fleet_emulator [--testers n] [--threads n] [--seconds s] [--realtime]\n"
+            "                      [--format text|csv|binary|mix] [--verbosity 1|2] [--session s]\n"
+            "                      [--seed n] [--files dir | --pty dir]\n"
+            "  --testers    virtual testers (default 1000)\n"
+            "  --threads    worker threads (default: one per core)\n"
+            "  --seconds    device time to run (default 600; 0 with --realtime runs until Ctrl-C)\n"
+            "  --realtime   pace device time to the wall clock\n"
+            "  --format     serial output format; mix rotates the three over the testers (default)\n"
+            "  --verbosity  text format: 1 display blocks, 2 also calculated values and trend\n"
+            "  --session    mean seconds a pack stays connected (default 300)\n"
+            "  --seed       fleet identity: packs, ADC units, clocks and plug times (default 1)\n"
+            "  --files      write <dir>/tester-NNNN.log per tester\n"
+            "  --pty        create a raw PTY per tester, linked as <dir>/tester-NNNN\n");
+}
+
+bool parseFormat(const char* text, int* format) {
+    if (strcmp(text, "text") == 0) {
+        *format = OUTPUT_FORMAT_TEXT;
+    } else if (strcmp(text, "csv") == 0) {
+        *format = OUTPUT_FORMAT_CSV;
+    } else if (strcmp(text, "binary") == 0) {
+        *format = OUTPUT_FORMAT_BINARY;
+    } else if (strcmp(text, "mix") == 0) {
+        *format = -1;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    FleetOptions options;
+    const char* filesDirectory = nullptr;
+    const char* ptyDirectory = nullptr;
+    
+    for (int i = 1; i < argc; i++) {
+        const char* value = i + 1 < argc ? argv[i + 1] : nullptr;
+        if (strcmp(argv[i], "--realtime") == 0) {
+            options.realtime = true;
+        } else if (!value) {
+            usage();
+            return 1;
+        } else if (strcmp(argv[i], "--testers") == 0) {
+            options.testers = atoi(value);
+            i++;
+        } else if (strcmp(argv[i], "--threads") == 0) {
+            options.threads = atoi(value);
+            i++;
+        } else if (strcmp(argv[i], "--seconds") == 0) {
+            options.seconds = atof(value);
+            i++;
+        } else if (strcmp(argv[i], "--format") == 0 && parseFormat(value, &options.format)) {
+            i++;
+        } else if (strcmp(argv[i], "--verbosity") == 0) {
+            options.verbosity = atoi(value);
+            i++;
+        } else if (strcmp(argv[i], "--session") == 0) {
+            options.sessionSeconds = atof(value);
+            i++;
+        } else if (strcmp(argv[i], "--seed") == 0) {
+            options.seed = (uint32_t)strtoul(value, nullptr, 10);
+            i++;
+        } else if (strcmp(argv[i], "--files") == 0) {
+            filesDirectory = value;
+            i++;
+        } else if (strcmp(argv[i], "--pty") == 0) {
+            ptyDirectory = value;
+            i++;
+        } else {
+            usage();
+            return 1;
+        }
+    }
+    if (options.testers <= 0 || options.sessionSeconds <= 0.0 || (filesDirectory && ptyDirectory) ||
+        (options.seconds <= 0.0 && !options.realtime) ||
+        options.verbosity < DEBUG_LEVEL_DISPLAY || options.verbosity > DEBUG_LEVEL_CALCULATED) {
+        usage();
+        return 1;
+    }
+    
+    FleetEmulator fleet(options);
+    if ((filesDirectory && !fleet.openFiles(filesDirectory)) || (ptyDirectory && !fleet.openPtys(ptyDirectory))) {
+        return 1;
+    }
+    signal(SIGINT, onSignal);
+    signal(SIGTERM, onSignal);
+    signal(SIGPIPE, SIG_IGN);
+    
+    const FleetOptions& used = fleet.getOptions();
+    printf("=== Fleet: %d testers on %d threads, %s, %s ===\n", used.testers, used.threads,
+           used.realtime ? "real time" : "as fast as possible",
+           filesDirectory ? filesDirectory : ptyDirectory ? ptyDirectory : "output discarded");
+    if (ptyDirectory) {
+        printf("PTYs ready: ingestd %s/tester-*\n", ptyDirectory);
+    }
+    fflush(stdout);
+    
+    fleet.run(&stopRequested);
+    
+    const FleetStats& stats = fleet.getStats();
+    double wall = stats.wallSeconds > 0.0 ? stats.wallSeconds : 1e-9;
+    double cpu = stats.cpuSeconds > 0.0 ? stats.cpuSeconds : 1e-9;
+    double testerSeconds = stats.deviceSeconds * used.testers;
+    
+    printf("device time              %10.1f s per tester\n", stats.deviceSeconds);
+    printf("wall time                %10.2f s (%.0fx real time)\n", stats.wallSeconds,
+           stats.deviceSeconds / wall);
+    printf("worker CPU               %10.2f s\n", stats.cpuSeconds);
+    printf("records                  %10llu (%llu messages, %lu plug-ins)\n", stats.records, stats.messages,
+           stats.connects);
+    printf("samples                  %10llu\n", stats.samples);
+    printf("serial bytes             %10llu (%llu write calls, %llu dropped)\n", stats.bytes, stats.writeCalls,
+           stats.droppedBytes);
+    printf("records/s                %10.0f (%.0f per core)\n", stats.records / wall, stats.records / cpu);
+    printf("samples/s                %10.0f (%.0f per core)\n", stats.samples / wall, stats.samples / cpu);
+    printf("real-time capacity       %10.0f testers per core\n", testerSeconds / cpu);
+    if (used.realtime) {
+        printf("max lag                  %10.1f ms%s\n", stats.maxLagMs,
+               stats.maxLagMs > MEASUREMENT_DELAY_MS ? " (fleet too large for this host)" : "");
+    }
+    return 0;
+}
@@ -0,0 +1,236 @@
+/**
+ * @brief Decode a MeasurementLog dump into CSV
+ *
+ * Input is either the serial dump produced by the tester's 'D' command
+ * (a capture file or stdin) or a raw image of the log storage:
+ *
+ *   log_decoder dump.txt                 readings as CSV
+ *   log_decoder --sessions dump.txt      one line per session
+ *   log_decoder --image flash.bin 4096   raw image with 4096-byte pages
+ *
+ * Pages are decoded oldest first with the firmware's own record decoder, so
+ * the tool always matches the format written by the device.
+ */
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <vector>
+#include "ChemistrySelector.h"
+#include "MeasurementLog.h"
+
+namespace {
+
+typedef std::map<uint32_t, std::vector<uint8_t> > PageMap;
+
+struct SessionSummary {
+    uint16_t id;
+    int chemistry;           // -1 when the session record was overwritten
+    int cellCount;
+    long readings;
+    unsigned long seconds;
+    float firstVoltage;
+    float lastVoltage;
+};
+
+int hexValue(char c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return -1;
+}
+
+/**
+ * @brief Parse "#LOG" / "<sequence> <offset> <hex>" lines into pages
+ */
+bool readDump(FILE* in, PageMap* pages) {
+    char line[256];
+    unsigned long pageSize = 0;
+    bool ended = false;
+    
+    while (fgets(line, sizeof(line), in)) {
+        unsigned version, used;
+        unsigned long size;
+        if (sscanf(line, "#LOG %u %lu %u", &version, &size, &used) == 3) {
+            if (version != 1) {
+                fprintf(stderr, "Unsupported log version %u\n", version);
+                return false;
+            }
+            pageSize = size;
+            continue;
+        }
+        if (strncmp(line, "#END", 4) == 0) {
+            ended = true;
+            break;
+        }
+        
+        unsigned long sequence, offset;
+        int consumed = 0;
+        if (pageSize == 0 || sscanf(line, "%lu %lu %n", &sequence, &offset, &consumed) != 2) {
+            continue;    // Debug output mixed into the capture
+        }
+        
+        std::vector<uint8_t>& page = (*pages)[(uint32_t)sequence];
+        if (page.empty()) {
+            page.assign(pageSize, 0xFF);
+        }
+        const char* hex = line + consumed;
+        for (unsigned long at = offset; at < pageSize; at++, hex += 2) {
+            int high = hexValue(hex[0]);
+            int low = high < 0 ? -1 : hexValue(hex[1]);
+            if (low < 0) break;
+            page[at] = (uint8_t)(high << 4 | low);
+        }
+    }
+    
+    if (!ended) {
+        fprintf(stderr, "Warning: dump has no #END line (truncated capture?)\n");
+    }
+    return pageSize != 0;
+}
+
+/**
+ * @brief Split a raw storage image into pages keyed by sequence
+ */
+bool readImage(const char* path, unsigned long pageSize, PageMap* pages) {
+    FILE* in = fopen(path, "rb");
+    if (!in) {
+        perror(path);
+        return false;
+    }
+    
+    std::vector<uint8_t> page(pageSize);
+    while (fread(&page[0], 1, pageSize, in) == pageSize) {
+        LogPageHeader header;
+        if (MeasurementLog::decodePageHeader(&page[0], &header)) {
+            (*pages)[header.sequence] = page;
+        }
+    }
+    fclose(in);
+    return true;
+}
+
+const char* chemistryName(int chemistry) {
+    if (chemistry < 0 || chemistry >= CHEMISTRY_COUNT) return "?";
+    return ChemistrySelector::name((ChemistryType)chemistry);
+}
+
+/**
+ * @brief Walk the pages oldest first, printing readings or collecting sessions
+ */
+void decode(const PageMap& pages, bool printReadings, std::vector<SessionSummary>* sessions) {
+    SessionSummary* current = nullptr;
+    long invalid = 0;
+    
+    if (printReadings) {
+        printf("session,chemistry,cells,seconds,voltage,charge\n");
+    }
+    
+    for (PageMap::const_iterator it = pages.begin(); it != pages.end(); ++it) {
+        const std::vector<uint8_t>& page = it->second;
+        LogPageHeader header;
+        if (!MeasurementLog::decodePageHeader(&page[0], &header)) continue;
+        
+        // The oldest page may continue a session whose record was overwritten
+        if (!current || current->id != header.firstSession) {
+            SessionSummary orphan = { header.firstSession, -1, 0, 0, 0, 0.0f, 0.0f };
+            sessions->push_back(orphan);
+            current = &sessions->back();
+        }
+        
+        for (size_t offset = MeasurementLog::LOG_HEADER_SIZE;
+             offset + MeasurementLog::LOG_RECORD_SIZE <= page.size();
+             offset += MeasurementLog::LOG_RECORD_SIZE) {
+            LogRecord record;
+            LogRecordType type = MeasurementLog::decodeRecord(&page[offset], &record);
+            if (type == LOG_RECORD_ERASED) break;
+            
+            if (type == LOG_RECORD_SESSION) {
+                if (current->readings == 0 && current->chemistry < 0) {
+                    sessions->pop_back();
+                }
+                SessionSummary session = { record.session, record.chemistry, record.cellCount, 0, 0, 0.0f, 0.0f };
+                sessions->push_back(session);
+                current = &sessions->back();
+            } else if (type == LOG_RECORD_READING) {
+                if (current->readings > 0) {
+                    current->seconds += record.deltaSeconds;
+                } else {
+                    current->firstVoltage = record.voltage;
+                }
+                current->lastVoltage = record.voltage;
+                current->readings++;
+                
+                if (printReadings) {
+                    printf("%u,%s,%d,%lu,%.2f,%u\n", current->id, chemistryName(current->chemistry),
+                           current->cellCount, current->seconds, record.voltage, record.chargePercentage);
+                }
+            } else {
+                invalid++;
+            }
+        }
+    }
+    
+    if (invalid > 0) {
+        fprintf(stderr, "Skipped %ld torn records\n", invalid);
+    }
+}
+
+void usage() {
+    fprintf(stderr, "Usage: log_decoder [--sessions] [dump.txt | --image <file> <pageSize>]\n");
+    fprintf(stderr, "Reads the dump from stdin when no file is given.\n");
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    bool summary = false;
+    const char* dumpPath = nullptr;
+    const char* imagePath = nullptr;
+    unsigned long imagePageSize = 0;
+    
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--sessions") == 0) {
+            summary = true;
+        } else if (strcmp(argv[i], "--image") == 0 && i + 2 < argc) {
+            imagePath = argv[++i];
+            imagePageSize = strtoul(argv[++i], nullptr, 10);
+        } else if (argv[i][0] != '-' && !dumpPath) {
+            dumpPath = argv[i];
+        } else {
+            usage();
+            return 1;
+        }
+    }
+    
+    PageMap pages;
+    bool loaded;
+    if (imagePath) {
+        loaded = imagePageSize > MeasurementLog::LOG_HEADER_SIZE && readImage(imagePath, imagePageSize, &pages);
+    } else {
+        FILE* in = dumpPath ? fopen(dumpPath, "r") : stdin;
+        if (!in) {
+            perror(dumpPath);
+            return 1;
+        }
+        loaded = readDump(in, &pages);
+        if (in != stdin) fclose(in);
+    }
+    if (!loaded) {
+        fprintf(stderr, "No log found\n");
+        return 1;
+    }
+    
+    std::vector<SessionSummary> sessions;
+    decode(pages, !summary, &sessions);
+    
+    if (summary) {
+        printf("session,chemistry,cells,readings,seconds,start_voltage,end_voltage\n");
+        for (size_t i = 0; i < sessions.size(); i++) {
+            const SessionSummary& s = sessions[i];
+            printf("%u,%s,%d,%ld,%lu,%.2f,%.2f\n", s.id, chemistryName(s.chemistry), s.cellCount,
+                   s.readings, s.seconds, s.firstVoltage, s.lastVoltage);
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,163 @@
+/**
+ * @brief Search the measurement parameters per board and emit tuned config headers
+ *
+ * Runs every candidate of a grid over ADC block size, analysis period,
+ * connect debounce and the cell tracker's filter and lock settings through
+ * the firmware's measurement path on simulated plug-ins (see
+ * host/ParamTuner.h), in parallel. Minimizes plug-in-to-answer time, the age
+ * of the shown reading, CPU and I2C work subject to voltage error, display flicker and cell count
+ * accuracy no worse than the hand-picked config.h values (or --max-*).
+ *
+ *   param_tuner                         both boards, print the Pareto fronts
+ *   param_tuner --out tuned/            also write config_tuned_<board>.h and pareto_<board>.csv
+ *   param_tuner --board pro-mini --max-flicker 1
+ *
+ * Exits 1 if a board has no feasible candidate.
+ */
+#include <cerrno>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <sys/stat.h>
+#include "ParamTuner.h"
+
+namespace {
+
+void usage() {
+    fprintf(stderr,
+            "Usage: param_tuner [--board esp32c3|pro-mini|all] [--sessions n] [--seconds s] [--threads n]\n"
+            "                   [--seed n] [--quick] [--max-error mV] [--max-flicker n] [--out dir]\n"
+            "  --board        board to tune (default all)\n"
+            "  --sessions     plug-in scenarios per board (default 36)\n"
+            "  --seconds      length of each scenario (default 60)\n"
+            "  --threads      worker threads (default: one per core)\n"
+            "  --seed         packs, ADC units and plug timing (default 1)\n"
+            "  --quick        small grid (smoke test)\n"
+            "  --max-error    RMS voltage error limit in mV (default: the hand-picked values' own)\n"
+            "  --max-flicker  cell count or charge changes per minute at rest (default: the hand-picked values' own)\n"
+            "  --out          write config_tuned_<board>.h and pareto_<board>.csv there\n");
+}
+
+void printRow(const char* mark, const TunerResult& result) {
+    const TunerCandidate& c = result.candidate;
+    const TunerScore& s = result.score;
+    printf("%-3s %7d %6d %8d %5.2f %3d %4.2f %4d | %6.0f ms %6.0f ms %5.2f %% %5.0f B/s | %5.1f mV %5.2f/min %5d %6d\n",
+           mark, c.samplesPerBlock, c.periodMs, c.debounceSamples, c.tracker.noiseSigma, c.tracker.maxAveraged,
+           c.tracker.lockConfidence, c.tracker.lockReadings, s.answerMs, s.updateMs, s.cpuPercent, s.i2cBytesPerSecond,
+           s.voltageErrorV * 1000.0, s.flickerPerMinute, s.wrongSessions, s.missedSessions);
+}
+
+/**
+ * @brief Search one board, print its front and write its outputs
+ * @return false if nothing is feasible or an output cannot be written
+ */
+bool tune(const TunerBoard& board, const TunerOptions& options, bool quick, const char* outDirectory) {
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    ParamTuner tuner(board, options);
+    std::vector<TunerCandidate> candidates = tuner.grid(quick);
+    tuner.search(candidates);
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    
+    const TunerOptions& used = tuner.getOptions();
+    const TunerLimits& limits = used.limits;
+    std::vector<int> front = tuner.paretoFront();
+    int best = tuner.recommended();
+    int feasible = 0;
+    for (size_t i = 0; i < tuner.getResults().size(); i++) {
+        feasible += tuner.getResults()[i].score.feasible ? 1 : 0;
+    }
+    
+    printf("=== %s: %d candidates, %d sessions of %.0f s, %d threads (%.1f s) ===\n", board.title,
+           (int)candidates.size(), used.sessions, used.sessionSeconds, used.threads, seconds);
+    printf("limits: error <= %.1f mV, flicker <= %.2f/min, wrong <= %d, missed <= %d, no spurious events\n",
+           limits.maxVoltageErrorV * 1000.0, limits.maxFlickerPerMinute, limits.maxWrongSessions,
+           limits.maxMissedSessions);
+    printf("floors: sigma >= %.3f V, lock readings >= %d\n", board.minNoiseSigma, board.minLockReadings);
+    printf("feasible %d, Pareto front %d\n\n", feasible, (int)front.size());
+    printf("    samples period debounce sigma avg conf lock |    answer    update     CPU       I2C |    error  flicker wrong missed\n");
+    printRow("now", tuner.getBaseline());
+    for (size_t i = 0; i < front.size(); i++) {
+        printRow(front[i] == best ? "*" : "", tuner.getResults()[front[i]]);
+    }
+    printf("\n");
+    if (best < 0) {
+        fprintf(stderr, "%s: no candidate meets the limits\n", board.title);
+        return false;
+    }
+    
+    if (outDirectory) {
+        std::string base = std::string(outDirectory) + "/";
+        if (!tuner.writeHeader(base + "config_tuned_" + board.name + ".h", tuner.getResults()[best]) ||
+            !tuner.writeFront(base + "pareto_" + board.name + ".csv")) {
+            return false;
+        }
+    }
+    return true;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    TunerOptions options;
+    const char* boardName = "all";
+    const char* outDirectory = nullptr;
+    bool quick = false;
+    
+    for (int i = 1; i < argc; i++) {
+        const char* value = i + 1 < argc ? argv[i + 1] : nullptr;
+        if (strcmp(argv[i], "--quick") == 0) {
+            quick = true;
+        } else if (!value) {
+            usage();
+            return 1;
+        } else if (strcmp(argv[i], "--board") == 0) {
+            boardName = value;
+            i++;
+        } else if (strcmp(argv[i], "--sessions") == 0) {
+            options.sessions = atoi(value);
+            i++;
+        } else if (strcmp(argv[i], "--seconds") == 0) {
+            options.sessionSeconds = atof(value);
+            i++;
+        } else if (strcmp(argv[i], "--threads") == 0) {
+            options.threads = atoi(value);
+            i++;
+        } else if (strcmp(argv[i], "--seed") == 0) {
+            options.seed = (uint32_t)strtoul(value, nullptr, 10);
+            i++;
+        } else if (strcmp(argv[i], "--max-error") == 0) {
+            options.limits.maxVoltageErrorV = atof(value) / 1000.0;
+            i++;
+        } else if (strcmp(argv[i], "--max-flicker") == 0) {
+            options.limits.maxFlickerPerMinute = atof(value);
+            i++;
+        } else if (strcmp(argv[i], "--out") == 0) {
+            outDirectory = value;
+            i++;
+        } else {
+            usage();
+            return 1;
+        }
+    }
+    bool esp32c3 = strcmp(boardName, "esp32c3") == 0 || strcmp(boardName, "all") == 0;
+    bool proMini = strcmp(boardName, "pro-mini") == 0 || strcmp(boardName, "all") == 0;
+    if ((!esp32c3 && !proMini) || options.sessions <= 0 || options.sessionSeconds < 10.0) {
+        usage();
+        return 1;
+    }
+    if (outDirectory && mkdir(outDirectory, 0755) != 0 && errno != EEXIST) {
+        perror(outDirectory);
+        return 1;
+    }
+    
+    bool ok = true;
+    if (esp32c3) {
+        ok = tune(TunerBoard::esp32c3(), options, quick, outDirectory) && ok;
+    }
+    if (proMini) {
+        ok = tune(TunerBoard::proMini(), options, quick, outDirectory) && ok;
+    }
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,118 @@
+/**
+ * @brief Replay a recorded input trace through the unmodified firmware
+ *
+ * The firmware's setup() and loop() run on the host Arduino core in host/,
+ * whose clock only advances when the firmware waits or uses the bus, so a
+ * replay is deterministic and runs far faster than real time. The trace
+ * drives the ADC pin, the chemistry button and the serial input; the serial
+ * output and the frames the SSD1306 on the virtual bus received come out.
+ *
+ *   trace_replay field.trace                      serial output to stdout
+ *   trace_replay --frames frames.txt field.trace  plus every display frame
+ *   trace_replay --volts pack.trace               trace values are volts
+ *
+ * The trace format is described in host/TraceReplay.h. Times are ms since
+ * power-on; setup() itself takes ~3.4 s of them.
+ */
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include "Ssd1306Panel.h"
+#include "TraceReplay.h"
+#include "VirtualHardware.h"
+#include "config.h"
+
+namespace {
+
+void logFrame(const Ssd1306Panel& panel, void* context) {
+    FILE* file = (FILE*)context;
+    fprintf(file, "# frame %lu at %.3f ms\n", panel.getFrameCount(), VirtualHardware::nowMicros() / 1000.0);
+    panel.writeAscii(file);
+}
+
+void usage() {
+    fprintf(stderr,
+            "Usage: trace_replay [--volts] [--serial out.txt] [--frames frames.txt] [--tail ms] [--loop-us us] trace\n"
+            "  --volts    trace values are pack volts instead of raw ADC counts\n"
+            "  --serial   write the firmware's serial output here (default stdout)\n"
+            "  --frames   write every display frame as ASCII art\n"
+            "  --tail     keep running this long after the last event (default 2000 ms)\n"
+            "  --loop-us  device time charged per loop() pass (default 20 us)\n");
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    const char* tracePath = nullptr;
+    const char* serialPath = nullptr;
+    const char* framesPath = nullptr;
+    unsigned long tailMs = 2000;
+    unsigned long loopUs = 20;
+    bool volts = false;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--volts") == 0) {
+            volts = true;
+        } else if (strcmp(argv[i], "--serial") == 0 && i + 1 < argc) {
+            serialPath = argv[++i];
+        } else if (strcmp(argv[i], "--frames") == 0 && i + 1 < argc) {
+            framesPath = argv[++i];
+        } else if (strcmp(argv[i], "--tail") == 0 && i + 1 < argc) {
+            tailMs = strtoul(argv[++i], nullptr, 10);
+        } else if (strcmp(argv[i], "--loop-us") == 0 && i + 1 < argc) {
+            loopUs = strtoul(argv[++i], nullptr, 10);
+        } else if (argv[i][0] != '-' && !tracePath) {
+            tracePath = argv[i];
+        } else {
+            usage();
+            return 1;
+        }
+    }
+    if (!tracePath) {
+        usage();
+        return 1;
+    }
+
+    TraceReplay replay;
+    if (!replay.load(tracePath, volts)) {
+        return 1;
+    }
+    replay.setLoopMicros(loopUs);
+
+    FILE* serialOut = serialPath ? fopen(serialPath, "w") : stdout;
+    FILE* framesOut = framesPath ? fopen(framesPath, "w") : nullptr;
+    if (!serialOut || (framesPath && !framesOut)) {
+        perror(serialOut ? framesPath : serialPath);
+        return 1;
+    }
+
+    Ssd1306Panel panel;
+    if (framesOut) {
+        panel.setFrameListener(logFrame, framesOut);
+    }
+    VirtualHardware::reset();
+    VirtualHardware::attachI2cDevice(SCREEN_ADDRESS, &panel);
+    VirtualHardware::setSerialOutput(serialOut);
+
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    replay.powerOn();
+    replay.runUntil(replay.getLastEventMs() + tailMs);
+    double wallSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    double virtualSeconds = VirtualHardware::nowMicros() / 1e6;
+
+    fflush(serialOut);
+    if (serialPath) {
+        fclose(serialOut);
+    }
+    if (framesOut) {
+        fclose(framesOut);
+    }
+
+    fprintf(stderr, "Replayed %zu events: %.1f s of device time (setup %.1f s) in %.3f s, %.0fx real time\n",
+            replay.getEventCount(), virtualSeconds, replay.getSetupMicros() / 1e6, wallSeconds,
+            wallSeconds > 0.0 ? virtualSeconds / wallSeconds : 0.0);
+    fprintf(stderr, "  %llu loop() calls, %lu display frames, %llu serial bytes\n", replay.getLoopCount(),
+            panel.getFrameCount(), (unsigned long long)VirtualHardware::getSerialBytes());
+    return 0;
+}
@@ -0,0 +1,91 @@
+#include "AdcChannels.h"
+
+#ifndef UNIT_TEST
+
+#include <Arduino.h>
+
+namespace {
+
+const float TAP_RATIOS[] = BALANCE_TAP_RATIOS;
+
+float tapVoltsPerCount(int channel) {
+    return (float)ADC_VREF / ADC_MAX_VALUE * TAP_RATIOS[channel];
+}
+
+} // namespace
+
+static_assert(BALANCE_TAP_COUNT <= sizeof(TAP_RATIOS) / sizeof(TAP_RATIOS[0]), "BALANCE_TAP_RATIOS needs an entry per tap");
+static_assert(BALANCE_TAP_COUNT <= BALANCE_MAX_CELLS, "More taps than BALANCE_MAX_CELLS");
+
+#ifndef BALANCE_MUX_ADC_PIN
+
+namespace {
+
+const uint8_t TAP_PINS[] = BALANCE_TAP_PINS;
+
+} // namespace
+
+static_assert(BALANCE_TAP_COUNT <= sizeof(TAP_PINS), "BALANCE_TAP_PINS needs an entry per tap");
+
+void PinAdcChannels::begin() {
+    for (int i = 0; i < BALANCE_TAP_COUNT; i++) {
+        pinMode(TAP_PINS[i], INPUT);
+    }
+}
+
+int PinAdcChannels::channelCount() const {
+    return BALANCE_TAP_COUNT;
+}
+
+int PinAdcChannels::read(int channel) {
+    return analogRead(TAP_PINS[channel]);
+}
+
+float PinAdcChannels::voltsPerCount(int channel) const {
+    return tapVoltsPerCount(channel);
+}
+
+#else
+
+namespace {
+
+const uint8_t SELECT_PINS[] = BALANCE_MUX_SELECT_PINS;
+const int SELECT_LINES = sizeof(SELECT_PINS);
+
+} // namespace
+
+static_assert(BALANCE_TAP_COUNT <= (1 << sizeof(SELECT_PINS)), "Too many taps for BALANCE_MUX_SELECT_PINS");
+
+MuxAdcChannels::MuxAdcChannels() : selected(-1) {
+}
+
+void MuxAdcChannels::begin() {
+    pinMode(BALANCE_MUX_ADC_PIN, INPUT);
+    for (int i = 0; i < SELECT_LINES; i++) {
+        pinMode(SELECT_PINS[i], OUTPUT);
+    }
+    selected = -1;
+}
+
+int MuxAdcChannels::channelCount() const {
+    return BALANCE_TAP_COUNT;
+}
+
+int MuxAdcChannels::read(int channel) {
+    if (channel != selected) {
+        for (int i = 0; i < SELECT_LINES; i++) {
+            digitalWrite(SELECT_PINS[i], (channel >> i) & 1 ? HIGH : LOW);
+        }
+        delayMicroseconds(BALANCE_MUX_SETTLE_US);
+        selected = channel;
+    }
+    return analogRead(BALANCE_MUX_ADC_PIN);
+}
+
+float MuxAdcChannels::voltsPerCount(int channel) const {
+    return tapVoltsPerCount(channel);
+}
+
+#endif // BALANCE_MUX_ADC_PIN
+
+#endif // UNIT_TEST
@@ -0,0 +1,119 @@
+#include "Ads1115.h"
+
+namespace {
+
+// Register pointers
+const uint8_t REG_CONVERSION = 0x00;
+const uint8_t REG_CONFIG = 0x01;
+
+// Config register fields
+const uint16_t MUX_SINGLE_ENDED = 0x4000;     // AIN0-GND; +channel << 12
+const uint16_t MODE_CONTINUOUS = 0x0000;
+const uint16_t COMPARATOR_DISABLED = 0x0003;
+
+const float FULL_SCALE[] = { 6.144f, 4.096f, 2.048f, 1.024f, 0.512f, 0.256f };
+const int DATA_RATES[] = { 8, 16, 32, 64, 128, 250, 475, 860 };
+
+// Conversions are read slightly after they are due, so a read never
+// returns the previous result when the chip's oscillator runs slow (+-10%)
+const unsigned long RATE_MARGIN_PERCENT = 10;
+
+int dataRateIndex(int dataRate) {
+    int index = 0;
+    for (int i = 0; i < 8; i++) {
+        if (DATA_RATES[i] <= dataRate) index = i;
+    }
+    return index;
+}
+
+} // namespace
+
+Ads1115::Ads1115(I2cBus& bus, uint8_t address)
+    : bus(bus), address(address), errors(0), batchSum(0), batchCount(0), latest(0), lastReadUs(0), hasRead(false) {
+    int rate = supportedDataRate(ADS1115_DATA_RATE);
+    conversionMicros = (1000000UL + rate - 1) / rate * (100 + RATE_MARGIN_PERCENT) / 100;
+}
+
+bool Ads1115::begin() {
+    errors = 0;
+    hasRead = false;
+    startBatch();
+    
+    uint16_t config = configValue(ADS1115_CHANNEL, ADS1115_FULL_SCALE_V, ADS1115_DATA_RATE);
+    uint8_t configWrite[3] = { REG_CONFIG, (uint8_t)(config >> 8), (uint8_t)(config & 0xFF) };
+    if (!bus.write(address, configWrite, 3)) {
+        return false;
+    }
+    
+    // Leave the pointer on the conversion register for every later read
+    uint8_t pointer = REG_CONVERSION;
+    return bus.write(address, &pointer, 1);
+}
+
+bool Ads1115::readConversion(int16_t* value) {
+    uint8_t bytes[2];
+    if (!bus.read(address, bytes, 2)) {
+        errors++;
+        return false;
+    }
+    *value = (int16_t)(((uint16_t)bytes[0] << 8) | bytes[1]);
+    return true;
+}
+
+void Ads1115::startBatch() {
+    batchSum = 0;
+    batchCount = 0;
+}
+
+bool Ads1115::poll(unsigned long nowUs) {
+    // Wait for a conversion newer than the last one read (also across batches)
+    if (hasRead && nowUs - lastReadUs < conversionMicros) {
+        return false;
+    }
+    
+    int16_t value;
+    if (!readConversion(&value)) {
+        return false;
+    }
+    latest = value > 0 ? value : 0;
+    batchSum += latest;
+    batchCount++;
+    lastReadUs = nowUs;
+    hasRead = true;
+    return true;
+}
+
+int Ads1115::getBatchCount() const {
+    return batchCount;
+}
+
+int Ads1115::getBatchAverage() const {
+    return batchCount > 0 ? (int)(batchSum / batchCount) : 0;
+}
+
+int Ads1115::getLatest() const {
+    return latest;
+}
+
+unsigned long Ads1115::getConversionMicros() const {
+    return conversionMicros;
+}
+
+unsigned long Ads1115::getErrorCount() const {
+    return errors;
+}
+
+uint16_t Ads1115::configValue(int channel, float fullScaleVolts, int dataRate) {
+    // Smallest range that still covers the requested full scale
+    int gain = 0;
+    for (int i = 0; i < 6; i++) {
+        if (FULL_SCALE[i] >= fullScaleVolts - 0.001f) gain = i;
+    }
+    
+    return (uint16_t)(MUX_SINGLE_ENDED | ((channel & 0x03) << 12) | (gain << 9) | MODE_CONTINUOUS |
+                      (dataRateIndex(dataRate) << 5) | COMPARATOR_DISABLED);
+}
+
+int Ads1115::supportedDataRate(int dataRate) {
+    return DATA_RATES[dataRateIndex(dataRate)];
+}
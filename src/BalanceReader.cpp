@@ -0,0 +1,131 @@
+#include "BalanceReader.h"
+
+BalanceReader::BalanceReader(AdcChannels& adc, int samplesPerRound)
+    : adc(adc), channels(0), samplesPerRound(samplesPerRound), samplesPerChannel(0),
+      position(0), pass(0), rounds(0) {
+    reset();
+}
+
+void BalanceReader::begin() {
+    adc.begin();
+    reset();
+}
+
+void BalanceReader::reset() {
+    channels = adc.channelCount();
+    if (channels > BALANCE_MAX_CELLS) {
+        channels = BALANCE_MAX_CELLS;
+    }
+    
+    // Even, so forward and backward passes pair up
+    samplesPerChannel = channels > 0 ? samplesPerRound / channels : 0;
+    if (samplesPerChannel < BALANCE_MIN_SAMPLES) {
+        samplesPerChannel = BALANCE_MIN_SAMPLES;
+    }
+    samplesPerChannel += samplesPerChannel % 2;
+    
+    position = 0;
+    pass = 0;
+    rounds = 0;
+    for (int i = 0; i < BALANCE_MAX_CELLS; i++) {
+        sums[i] = 0;
+        voltages[i] = 0.0f;
+    }
+}
+
+bool BalanceReader::step() {
+    if (channels == 0) {
+        return false;
+    }
+    
+    // Serpentine order: even passes go up, odd passes come back down
+    int channel = (pass % 2 == 0) ? position : channels - 1 - position;
+    sums[channel] += adc.read(channel);
+    
+    if (++position < channels) {
+        return false;
+    }
+    position = 0;
+    if (++pass < samplesPerChannel) {
+        return false;
+    }
+    pass = 0;
+    
+    for (int i = 0; i < channels; i++) {
+        voltages[i] = (float)sums[i] / samplesPerChannel * adc.voltsPerCount(i);
+        sums[i] = 0;
+    }
+    rounds++;
+    return true;
+}
+
+void BalanceReader::readRound() {
+    if (channels == 0) {
+        return;
+    }
+    while (!step()) {
+    }
+}
+
+bool BalanceReader::hasReading() const {
+    return rounds > 0;
+}
+
+int BalanceReader::getChannelCount() const {
+    return channels;
+}
+
+int BalanceReader::getSamplesPerChannel() const {
+    return samplesPerChannel;
+}
+
+int BalanceReader::getSamplesPerRound() const {
+    return samplesPerChannel * channels;
+}
+
+unsigned long BalanceReader::getRounds() const {
+    return rounds;
+}
+
+float BalanceReader::getTapVoltage(int channel) const {
+    if (channel < 0 || channel >= channels) {
+        return 0.0f;
+    }
+    return voltages[channel];
+}
+
+int BalanceReader::getCellVoltages(int cellCount, float totalVoltage, float* cells) const {
+    // Every cell but the top one needs a tap; taps above the pack are ignored
+    if (!hasReading() || cellCount < 1 || cellCount > BALANCE_MAX_CELLS || cellCount > channels + 1) {
+        return 0;
+    }
+    
+    float below = 0.0f;
+    for (int i = 0; i < cellCount; i++) {
+        float top = i < channels ? voltages[i] : totalVoltage;
+        cells[i] = top - below;
+        below = top;
+    }
+    return cellCount;
+}
+
+void BalanceReader::applyCellVoltages(BatteryInfo* info, const float* cells, int count) {
+    info->balanceCells = 0;
+    info->imbalance = 0.0f;
+    info->weakestCell = 0;
+    if (count < 1 || count > BALANCE_MAX_CELLS) {
+        return;
+    }
+    
+    int weakest = 0;
+    float highest = cells[0];
+    for (int i = 0; i < count; i++) {
+        info->cellVoltages[i] = cells[i];
+        if (cells[i] < cells[weakest]) weakest = i;
+        if (cells[i] > highest) highest = cells[i];
+    }
+    
+    info->balanceCells = count;
+    info->imbalance = highest - cells[weakest];
+    info->weakestCell = weakest + 1;
+}
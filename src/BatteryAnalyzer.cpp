@@ -5,39 +5,40 @@
 #include <cmath>   // ESP32 uses cmath
 #endif
 
-int BatteryAnalyzer::detectCellCount(float voltage) {
-    // LiPo cell voltage specifications
-    const float MIN_CELL_V = 2.9f;  // Minimum safe voltage per cell
-    const float MAX_CELL_V = 4.2f;  // Maximum voltage per cell (fully charged)
-    const int MAX_CELLS_COUNT = 6;  // Support up to 6S batteries
+template <class Chemistry>
+int ChemistryAnalyzer<Chemistry>::detectCellCount(float voltage) {
+    // Cell voltage specifications from the chemistry policy (compile-time constants)
+    const float MIN_CELL_V = Chemistry::minCellVoltage();  // Minimum safe voltage per cell
+    const float MAX_CELL_V = Chemistry::maxCellVoltage();  // Maximum voltage per cell (fully charged)
+    const int MAX_CELLS_COUNT = Chemistry::maxCells();     // Largest supported pack
     
     // Check if voltage is too low to be valid (with 20% margin)
-    if (voltage < MIN_CELL_V * 0.8) {
+    if (voltage < MIN_CELL_V * 0.8f) {
         return 0; // Invalid - voltage too low
     }
     
-    // Check if voltage exceeds maximum possible (6S with 10% margin)
-    if (voltage > MAX_CELL_V * MAX_CELLS_COUNT * 1.1) {
+    // Check if voltage exceeds maximum possible (max cells with 10% margin)
+    if (voltage > MAX_CELL_V * MAX_CELLS_COUNT * 1.1f) {
         return 0; // Invalid - voltage too high
     }
     
     /* Cell Detection Strategy:
-     * 
+     *
      * Algorithm: "First Valid Match"
-     * - Iterate from 1S to 6S
+     * - Iterate from 1S to the chemistry's maximum cell count
      * - Return the first configuration where voltage/cells falls in valid range
      * - This naturally prefers fewer cells (higher voltage per cell)
-     * 
+     *
      * Rationale:
      * - Batteries are typically used in the 3.3V-4.2V/cell range
      * - Lower cell count with higher voltage is more common than higher cell count at minimum
      * - Example: 11.6V is more likely 3S@3.87V than 4S@2.9V (critically low)
-     * 
+     *
      * Edge Cases:
      * - At exactly 2.9V/cell, multiple configurations may be valid
      * - Algorithm chooses configuration with higher voltage/cell (fewer cells)
      * - This represents the most probable real-world scenario
-     * 
+     *
      * Floating Point Handling:
      * - Adds 1mV tolerance to handle floating point precision
      * - Prevents edge case failures (e.g., 12.6V/3 = 4.2V might be 4.199999...)
@@ -56,7 +57,8 @@ int BatteryAnalyzer::detectCellCount(float voltage) {
     return 0;  // No valid configuration found
 }
 
-float BatteryAnalyzer::calculateAverageCellVoltage(float totalVoltage, int cellCount) {
+template <class Chemistry>
+float ChemistryAnalyzer<Chemistry>::calculateAverageCellVoltage(float totalVoltage, int cellCount) {
     if (cellCount <= 0) {
         return 0.0;
     }
@@ -64,55 +66,58 @@ float BatteryAnalyzer::calculateAverageCellVoltage(float totalVoltage, int cellC
     return totalVoltage / cellCount;
 }
 
-int BatteryAnalyzer::calculateChargePercentage(float averageCellVoltage) {
-    // Clamp voltage to valid range
-    if (averageCellVoltage < CELL_VOLTAGE_EMPTY) {
-        return 0;
-    }
-    if (averageCellVoltage >= CELL_VOLTAGE_FULL) {  // >= to handle 4.2V exactly
-        return 100;
-    }
-    
-    // Calculate percentage based on voltage range
-    float voltageRange = CELL_VOLTAGE_FULL - CELL_VOLTAGE_EMPTY;
-    float voltageAboveEmpty = averageCellVoltage - CELL_VOLTAGE_EMPTY;
-    
-    // Round instead of truncate for better accuracy
-    int percentage = (int)((voltageAboveEmpty / voltageRange) * 100.0 + 0.5);
-    
-    // Ensure percentage is within 0-100 range
-    if (percentage < 0) percentage = 0;
-    if (percentage > 100) percentage = 100;
-    
-    return percentage;
+template <class Chemistry>
+int ChemistryAnalyzer<Chemistry>::calculateChargePercentage(float averageCellVoltage) {
+    // SOC curve (clamped to 0-100) is provided by the chemistry policy
+    return Chemistry::chargePercentage(averageCellVoltage);
+}
+
+template <class Chemistry>
+BatteryInfo ChemistryAnalyzer<Chemistry>::analyzeBattery(float voltage) {
+    return analyzeWithCellCount(voltage, detectCellCount(voltage));
 }
 
-BatteryInfo BatteryAnalyzer::analyzeBattery(float voltage) {
+template <class Chemistry>
+BatteryInfo ChemistryAnalyzer<Chemistry>::analyzeWithCellCount(float voltage, int cellCount) {
     BatteryInfo info;
     
     info.totalVoltage = voltage;
-    info.cellCount = detectCellCount(voltage);
+    info.balanceCells = 0;
+    info.imbalance = 0.0f;
+    info.weakestCell = 0;
     
-    if (info.cellCount > 0) {
-        info.averageCellVoltage = calculateAverageCellVoltage(voltage, info.cellCount);
+    if (cellCount > 0 && cellCount <= Chemistry::maxCells()) {
+        info.cellCount = cellCount;
+        info.averageCellVoltage = calculateAverageCellVoltage(voltage, cellCount);
         info.chargePercentage = calculateChargePercentage(info.averageCellVoltage);
         info.isValid = true;
+        info.cellConfidence = 100;
     } else {
+        info.cellCount = 0;
         info.averageCellVoltage = 0.0;
         info.chargePercentage = 0;
         info.isValid = false;
+        info.cellConfidence = 0;
     }
     
     return info;
 }
 
-bool BatteryAnalyzer::isVoltageValid(float voltage, int cellCount) {
-    if (cellCount < 1 || cellCount > MAX_CELLS) {
+template <class Chemistry>
+bool ChemistryAnalyzer<Chemistry>::isVoltageValid(float voltage, int cellCount) {
+    if (cellCount < 1 || cellCount > Chemistry::maxCells()) {
         return false;
     }
     
-    float minVoltage = CELL_VOLTAGE_MIN * cellCount;
-    float maxVoltage = CELL_VOLTAGE_MAX * cellCount;
+    float minVoltage = Chemistry::minCellVoltage() * cellCount;
+    float maxVoltage = Chemistry::maxCellVoltage() * cellCount;
     
-    return (voltage >= minVoltage && voltage <= maxVoltage);
+    // Same 1mV tolerance as detectCellCount (4.2f * 3 rounds below 12.6f)
+    return (voltage >= minVoltage - 0.001f && voltage <= maxVoltage + 0.001f);
 }
+
+// Explicit instantiations for every supported chemistry
+template class ChemistryAnalyzer<LiPoChemistry>;
+template class ChemistryAnalyzer<LiHVChemistry>;
+template class ChemistryAnalyzer<LiIonChemistry>;
+template class ChemistryAnalyzer<LiFePO4Chemistry>;
@@ -0,0 +1,51 @@
+#include "BlockSampler.h"
+
+BlockSampler::BlockSampler(SampleSource& source, ConnectionWatcher& watcher, SampleQueue& queue)
+    : source(source),
+      watcher(watcher),
+      queue(queue),
+      samplesPerBlock(SAMPLE_RECORD_SAMPLES),
+      runs(0),
+      sequence(0),
+      completed(false) {
+}
+
+void BlockSampler::setSamplesPerBlock(int runsPerBlock) {
+    samplesPerBlock = runsPerBlock > 0 ? runsPerBlock : 1;
+    source.startBatch();
+    runs = 0;
+}
+
+int BlockSampler::getSamplesPerBlock() const {
+    return samplesPerBlock;
+}
+
+ConnectionEvent BlockSampler::run(unsigned long nowMs) {
+    completed = false;
+    
+    // With noise-reduction sleep, conversions only run while idle() sleeps
+    source.idle();
+    source.poll();
+    ConnectionEvent event = watcher.sample(source.getLatest(), nowMs);
+    
+    if (!watcher.isConnected()) {
+        // Nothing to average; the batch holds at most this run's samples when a pack arrives
+        source.startBatch();
+        runs = 0;
+        return event;
+    }
+    
+    runs++;
+    if (runs >= samplesPerBlock && source.getBatchCount() > 0) {
+        SampleRecord record = { (uint32_t)nowMs, (uint16_t)source.getBatchAverage(), sequence++ };
+        queue.push(record);   // A full queue shows up as a sequence gap
+        source.startBatch();
+        runs = 0;
+        completed = true;
+    }
+    return event;
+}
+
+bool BlockSampler::blockCompleted() const {
+    return completed;
+}
@@ -0,0 +1,209 @@
+#include "CalibrationTable.h"
+
+namespace {
+
+const uint8_t BLOB_MAGIC_0 = 'C';
+const uint8_t BLOB_MAGIC_1 = 'T';
+const uint8_t BLOB_VERSION = 1;
+
+uint16_t crc16(const uint8_t* data, int length) {
+    uint16_t crc = 0xFFFF;
+    for (int i = 0; i < length; i++) {
+        crc ^= (uint16_t)data[i] << 8;
+        for (int bit = 0; bit < 8; bit++) {
+            crc = (crc & 0x8000) ? (uint16_t)((crc << 1) ^ 0x1021) : (uint16_t)(crc << 1);
+        }
+    }
+    return crc;
+}
+
+uint16_t readLe16(const uint8_t* bytes) {
+    return (uint16_t)(bytes[0] | (bytes[1] << 8));
+}
+
+void writeLe16(uint8_t* bytes, uint16_t value) {
+    bytes[0] = (uint8_t)value;
+    bytes[1] = (uint8_t)(value >> 8);
+}
+
+} // namespace
+
+CalibrationTable::CalibrationTable() {
+    clear();
+}
+
+bool CalibrationTable::fit(CalibrationPoint* points, int count) {
+    if (count < 2) {
+        return false;
+    }
+    
+    // Insertion sort by raw value (a handful of points)
+    for (int i = 1; i < count; i++) {
+        CalibrationPoint point = points[i];
+        int j = i - 1;
+        while (j >= 0 && points[j].raw > point.raw) {
+            points[j + 1] = points[j];
+            j--;
+        }
+        points[j + 1] = point;
+    }
+    for (int i = 1; i < count; i++) {
+        if (points[i].raw <= points[i - 1].raw || points[i].voltage <= points[i - 1].voltage) {
+            return false;
+        }
+    }
+    
+    // Sample the curve through the points at every segment edge
+    int segment = 0;
+    for (int i = 0; i <= CALIBRATION_SEGMENTS; i++) {
+        float raw = (float)((long)i << SEGMENT_SHIFT);
+        while (segment < count - 2 && raw > points[segment + 1].raw) {
+            segment++;
+        }
+        const CalibrationPoint& low = points[segment];
+        const CalibrationPoint& high = points[segment + 1];
+        float voltage = low.voltage + (raw - low.raw) * (high.voltage - low.voltage) / (high.raw - low.raw);
+        
+        float millivolts = voltage * 1000.0f + 0.5f;
+        if (millivolts < 0.0f) millivolts = 0.0f;
+        if (millivolts > 65535.0f) millivolts = 65535.0f;
+        knots[i] = (uint16_t)millivolts;
+    }
+    valid = true;
+    return true;
+}
+
+void CalibrationTable::clear() {
+    for (int i = 0; i <= CALIBRATION_SEGMENTS; i++) {
+        knots[i] = 0;
+    }
+    valid = false;
+}
+
+bool CalibrationTable::isValid() const {
+    return valid;
+}
+
+int CalibrationTable::toRaw(uint16_t millivolts) const {
+    // The table never falls, so binary search over the raw range
+    int low = 0;
+    int high = VOLTAGE_ADC_MAX_VALUE;
+    while (low < high) {
+        int middle = low + (high - low) / 2;
+        if (toMillivolts(middle) >= millivolts) {
+            high = middle;
+        } else {
+            low = middle + 1;
+        }
+    }
+    return low;
+}
+
+uint16_t CalibrationTable::getKnot(int index) const {
+    if (index < 0 || index > CALIBRATION_SEGMENTS) {
+        return 0;
+    }
+    return knots[index];
+}
+
+void CalibrationTable::serialize(uint8_t* blob) const {
+    blob[0] = BLOB_MAGIC_0;
+    blob[1] = BLOB_MAGIC_1;
+    blob[2] = BLOB_VERSION;
+    blob[3] = (uint8_t)SEGMENT_SHIFT;
+    writeLe16(blob + 4, CALIBRATION_SEGMENTS);
+    for (int i = 0; i <= CALIBRATION_SEGMENTS; i++) {
+        writeLe16(blob + 6 + 2 * i, knots[i]);
+    }
+    writeLe16(blob + BLOB_SIZE - 2, crc16(blob, BLOB_SIZE - 2));
+}
+
+bool CalibrationTable::deserialize(const uint8_t* blob) {
+    if (blob[0] != BLOB_MAGIC_0 || blob[1] != BLOB_MAGIC_1 || blob[2] != BLOB_VERSION ||
+        blob[3] != SEGMENT_SHIFT || readLe16(blob + 4) != CALIBRATION_SEGMENTS ||
+        readLe16(blob + BLOB_SIZE - 2) != crc16(blob, BLOB_SIZE - 2)) {
+        return false;
+    }
+    
+    for (int i = 0; i <= CALIBRATION_SEGMENTS; i++) {
+        knots[i] = readLe16(blob + 6 + 2 * i);
+    }
+    valid = true;
+    return true;
+}
+
+#ifndef UNIT_TEST
+
+#ifdef ARDUINO_PRO_MINI
+
+#include <EEPROM.h>
+
+static_assert(CalibrationTable::BLOB_SIZE <= CALIBRATION_EEPROM_BYTES, "CALIBRATION_EEPROM_BYTES too small");
+
+static int calibrationAddress() {
+    return EEPROM.length() - CALIBRATION_EEPROM_BYTES;
+}
+
+bool CalibrationStore::load(CalibrationTable* table) {
+    uint8_t blob[CalibrationTable::BLOB_SIZE];
+    for (int i = 0; i < CalibrationTable::BLOB_SIZE; i++) {
+        blob[i] = EEPROM.read(calibrationAddress() + i);
+    }
+    return table->deserialize(blob);
+}
+
+bool CalibrationStore::save(const CalibrationTable& table) {
+    uint8_t blob[CalibrationTable::BLOB_SIZE];
+    table.serialize(blob);
+    for (int i = 0; i < CalibrationTable::BLOB_SIZE; i++) {
+        EEPROM.update(calibrationAddress() + i, blob[i]);
+    }
+    return true;
+}
+
+void CalibrationStore::erase() {
+    // A broken magic is enough; the rest of the bytes are left alone
+    EEPROM.update(calibrationAddress(), 0xFF);
+}
+
+#else
+
+#include <Preferences.h>
+
+static const char* const NVS_NAMESPACE = "calib";
+static const char* const NVS_KEY = "table";
+
+bool CalibrationStore::load(CalibrationTable* table) {
+    Preferences preferences;
+    if (!preferences.begin(NVS_NAMESPACE, true)) {
+        return false;
+    }
+    uint8_t blob[CalibrationTable::BLOB_SIZE];
+    bool loaded = preferences.getBytes(NVS_KEY, blob, sizeof(blob)) == sizeof(blob) && table->deserialize(blob);
+    preferences.end();
+    return loaded;
+}
+
+bool CalibrationStore::save(const CalibrationTable& table) {
+    Preferences preferences;
+    if (!preferences.begin(NVS_NAMESPACE, false)) {
+        return false;
+    }
+    uint8_t blob[CalibrationTable::BLOB_SIZE];
+    table.serialize(blob);
+    bool saved = preferences.putBytes(NVS_KEY, blob, sizeof(blob)) == sizeof(blob);
+    preferences.end();
+    return saved;
+}
+
+void CalibrationStore::erase() {
+    Preferences preferences;
+    if (preferences.begin(NVS_NAMESPACE, false)) {
+        preferences.remove(NVS_KEY);
+        preferences.end();
+    }
+}
+
+#endif // ARDUINO_PRO_MINI
+
+#endif // UNIT_TEST
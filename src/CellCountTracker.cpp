@@ -0,0 +1,196 @@
+#include "CellCountTracker.h"
+#ifdef ARDUINO_PRO_MINI
+#include <math.h>  // Arduino uses math.h instead of cmath
+#else
+#include <cmath>   // ESP32 uses cmath
+#endif
+
+namespace {
+
+/* Cell Voltage Prior
+ *
+ * Piecewise-constant density over the per-cell voltage, given as fractions of
+ * the chemistry's [min, max] range so it applies to every chemistry. For LiPo
+ * (2.9V-4.2V) the segment edges are 2.9, 3.29, 3.62, 4.1 and 4.2V:
+ * - over-discharged (below ~3.3V): rare
+ * - near empty: uncommon
+ * - in use / storage: most readings
+ * - freshly charged (top 8%): common, concentrated near full
+ */
+const int PRIOR_SEGMENTS = 4;
+const float PRIOR_EDGES[PRIOR_SEGMENTS + 1] = { 0.0f, 0.30f, 0.55f, 0.92f, 1.0f };
+const float PRIOR_MASS[PRIOR_SEGMENTS] = { 0.03f, 0.12f, 0.55f, 0.30f };
+
+// Beyond this many sigmas the normal CDF is treated as exactly 0 or 1
+const float CDF_CUTOFF = 6.0f;
+
+/**
+ * @brief Standard normal CDF (logistic approximation, max error ~0.01)
+ */
+float normalCdf(float x) {
+    if (x <= -CDF_CUTOFF) return 0.0f;
+    if (x >= CDF_CUTOFF) return 1.0f;
+    return 1.0f / (1.0f + expf(-1.702f * x));
+}
+
+} // namespace
+
+TrackerTuning::TrackerTuning()
+    : noiseSigma(TRACKER_NOISE_SIGMA),
+      maxAveraged(TRACKER_MAX_AVERAGED),
+      lockConfidence(TRACKER_LOCK_CONFIDENCE),
+      lockReadings(TRACKER_LOCK_READINGS),
+      unlockConfidence(TRACKER_UNLOCK_CONFIDENCE) {
+}
+
+CellCountTracker::CellCountTracker() {
+    limits = chemistryLimits<LiPoChemistry>();
+    reset();
+}
+
+void CellCountTracker::configure(const ChemistryLimits& newLimits) {
+    limits = newLimits;
+    if (limits.maxCells > MAX_CELLS) {
+        limits.maxCells = MAX_CELLS;
+    }
+    reset();
+}
+
+void CellCountTracker::tune(const TrackerTuning& newTuning) {
+    tuning = newTuning;
+    reset();
+}
+
+void CellCountTracker::reset() {
+    meanVoltage = 0.0f;
+    readingCount = 0;
+    bestCells = 0;
+    confidentReadings = 0;
+    lockedCells = 0;
+    outOfRangeReadings = 0;
+    for (int i = 0; i <= MAX_CELLS; i++) {
+        posterior[i] = 0.0f;
+    }
+}
+
+int CellCountTracker::update(float voltage) {
+    // Same "too low" rule as ChemistryAnalyzer: treat as disconnected
+    if (voltage < limits.minCellVoltage * 0.8f) {
+        reset();
+        return 0;
+    }
+    
+    // Readings the tracked count cannot explain: a sag under load, or a different pack if they persist
+    if (readingCount > 0 && !explains(getCellCount(), voltage)) {
+        if (++outOfRangeReadings < TRACKER_RESET_READINGS) {
+            return getCellCount();
+        }
+        reset();
+    } else {
+        outOfRangeReadings = 0;
+    }
+    
+    // Cumulative mean, becoming an exponential mean once the cap is reached
+    if (readingCount < tuning.maxAveraged) {
+        readingCount++;
+    }
+    meanVoltage += (voltage - meanVoltage) / readingCount;
+    
+    computePosterior();
+    
+    if (bestCells > 0 && posterior[bestCells] >= tuning.lockConfidence) {
+        confidentReadings++;
+    } else {
+        confidentReadings = 0;
+    }
+    
+    if (lockedCells > 0) {
+        // Stay locked (no flicker) unless the evidence turns against it
+        if (posterior[lockedCells] < tuning.unlockConfidence) {
+            lockedCells = 0;
+        }
+    } else if (confidentReadings >= tuning.lockReadings) {
+        lockedCells = bestCells;
+    }
+    
+    return getCellCount();
+}
+
+float CellCountTracker::likelihood(int cells, float voltage, float sigma) const {
+    float range = limits.maxCellVoltage - limits.minCellVoltage;
+    float total = 0.0f;
+    
+    for (int s = 0; s < PRIOR_SEGMENTS; s++) {
+        float lo = cells * (limits.minCellVoltage + PRIOR_EDGES[s] * range);
+        float hi = cells * (limits.minCellVoltage + PRIOR_EDGES[s + 1] * range);
+        
+        // Uniform segment of pack voltage [lo, hi] convolved with the noise
+        float inside = normalCdf((voltage - lo) / sigma) - normalCdf((voltage - hi) / sigma);
+        if (inside > 0.0f) {
+            total += PRIOR_MASS[s] * inside / (hi - lo);
+        }
+    }
+    
+    return total;
+}
+
+bool CellCountTracker::explains(int cells, float voltage) const {
+    float margin = 3.0f * tuning.noiseSigma;
+    return cells > 0 && voltage >= cells * limits.minCellVoltage - margin &&
+           voltage <= cells * limits.maxCellVoltage + margin;
+}
+
+void CellCountTracker::computePosterior() {
+    // Noise of the mean shrinks with the number of averaged readings
+    float sigma = tuning.noiseSigma / sqrtf((float)readingCount);
+    float sum = 0.0f;
+    
+    // Uniform prior over cell counts
+    for (int cells = 1; cells <= limits.maxCells; cells++) {
+        posterior[cells] = likelihood(cells, meanVoltage, sigma);
+        sum += posterior[cells];
+    }
+    
+    bestCells = 0;
+    if (sum <= 0.0f) {
+        // No configuration explains the reading (e.g. too high)
+        for (int cells = 1; cells <= limits.maxCells; cells++) {
+            posterior[cells] = 0.0f;
+        }
+        return;
+    }
+    
+    for (int cells = 1; cells <= limits.maxCells; cells++) {
+        posterior[cells] /= sum;
+        if (bestCells == 0 || posterior[cells] > posterior[bestCells]) {
+            bestCells = cells;
+        }
+    }
+}
+
+int CellCountTracker::getCellCount() const {
+    return lockedCells > 0 ? lockedCells : bestCells;
+}
+
+int CellCountTracker::getConfidence() const {
+    int cells = getCellCount();
+    if (cells == 0) {
+        return 0;
+    }
+    return (int)(posterior[cells] * 100.0f + 0.5f);
+}
+
+bool CellCountTracker::isLocked() const {
+    return lockedCells > 0;
+}
+
+float CellCountTracker::getProbability(int cells) const {
+    if (cells < 1 || cells > limits.maxCells) {
+        return 0.0f;
+    }
+    return posterior[cells];
+}
+
+int CellCountTracker::getReadingCount() const {
+    return readingCount;
+}
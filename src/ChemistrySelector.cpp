@@ -0,0 +1,90 @@
+#include "ChemistrySelector.h"
+
+ChemistryType ChemistrySelector::active = (ChemistryType)DEFAULT_CHEMISTRY;
+
+namespace {
+
+typedef BatteryInfo (*AnalyzeFunction)(float voltage);
+typedef BatteryInfo (*AnalyzeWithCellsFunction)(float voltage, int cellCount);
+
+// Indexed by ChemistryType
+const AnalyzeFunction ANALYZERS[CHEMISTRY_COUNT] = {
+    &ChemistryAnalyzer<LiPoChemistry>::analyzeBattery,
+    &ChemistryAnalyzer<LiHVChemistry>::analyzeBattery,
+    &ChemistryAnalyzer<LiIonChemistry>::analyzeBattery,
+    &ChemistryAnalyzer<LiFePO4Chemistry>::analyzeBattery
+};
+
+const AnalyzeWithCellsFunction CELL_COUNT_ANALYZERS[CHEMISTRY_COUNT] = {
+    &ChemistryAnalyzer<LiPoChemistry>::analyzeWithCellCount,
+    &ChemistryAnalyzer<LiHVChemistry>::analyzeWithCellCount,
+    &ChemistryAnalyzer<LiIonChemistry>::analyzeWithCellCount,
+    &ChemistryAnalyzer<LiFePO4Chemistry>::analyzeWithCellCount
+};
+
+bool isValidType(int type) {
+    return type >= 0 && type < CHEMISTRY_COUNT;
+}
+
+} // namespace
+
+void ChemistrySelector::select(ChemistryType type) {
+    if (isValidType(type)) {
+        active = type;
+    }
+}
+
+ChemistryType ChemistrySelector::current() {
+    return active;
+}
+
+ChemistryType ChemistrySelector::next() {
+    active = (ChemistryType)((active + 1) % CHEMISTRY_COUNT);
+    return active;
+}
+
+bool ChemistrySelector::fromCommand(char command, ChemistryType* type) {
+    switch (command) {
+        case 'L': case 'l': *type = CHEMISTRY_LIPO; return true;
+        case 'H': case 'h': *type = CHEMISTRY_LIHV; return true;
+        case 'I': case 'i': *type = CHEMISTRY_LIION; return true;
+        case 'F': case 'f': *type = CHEMISTRY_LIFEPO4; return true;
+        default: return false;
+    }
+}
+
+const char* ChemistrySelector::name(ChemistryType type) {
+    switch (type) {
+        case CHEMISTRY_LIPO: return LiPoChemistry::name();
+        case CHEMISTRY_LIHV: return LiHVChemistry::name();
+        case CHEMISTRY_LIION: return LiIonChemistry::name();
+        case CHEMISTRY_LIFEPO4: return LiFePO4Chemistry::name();
+        default: return "?";
+    }
+}
+
+BatteryInfo ChemistrySelector::analyzeBattery(float voltage) {
+    return ANALYZERS[active](voltage);
+}
+
+BatteryInfo ChemistrySelector::analyzeBattery(ChemistryType type, float voltage) {
+    if (!isValidType(type)) {
+        // Cell count 0 always yields an invalid reading
+        return CELL_COUNT_ANALYZERS[CHEMISTRY_LIPO](voltage, 0);
+    }
+    
+    return ANALYZERS[type](voltage);
+}
+
+BatteryInfo ChemistrySelector::analyzeWithCellCount(float voltage, int cellCount) {
+    return CELL_COUNT_ANALYZERS[active](voltage, cellCount);
+}
+
+ChemistryLimits ChemistrySelector::limits(ChemistryType type) {
+    switch (type) {
+        case CHEMISTRY_LIHV: return chemistryLimits<LiHVChemistry>();
+        case CHEMISTRY_LIION: return chemistryLimits<LiIonChemistry>();
+        case CHEMISTRY_LIFEPO4: return chemistryLimits<LiFePO4Chemistry>();
+        default: return chemistryLimits<LiPoChemistry>();
+    }
+}
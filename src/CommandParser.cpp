@@ -0,0 +1,206 @@
+#include "CommandParser.h"
+#ifdef ARDUINO_PRO_MINI
+#include <math.h>  // Arduino uses math.h instead of cmath
+#else
+#include <cmath>   // ESP32 uses cmath
+#endif
+
+// Names in CommandSetting order
+static const char* const SETTING_NAMES[SETTING_COUNT] = {
+    "samples", "period", "verbosity", "format", "ratio", "cal"
+};
+
+static bool isPrintable(char c) {
+    return c >= 0x20 && c < 0x7F;
+}
+
+static char toLower(char c) {
+    return (c >= 'A' && c <= 'Z') ? (char)(c - 'A' + 'a') : c;
+}
+
+CommandParser::CommandParser() : length(0), inLine(false), overflow(false) {
+    line[0] = '\0';
+}
+
+bool CommandParser::feed(char c, Command* command) {
+    if (!inLine) {
+        if (c == '$') {
+            inLine = true;
+            length = 0;
+            overflow = false;
+            return false;
+        }
+        
+        // Line endings and noise between single-key commands are ignored
+        if (!isPrintable(c) || c == ' ') {
+            return false;
+        }
+        command->type = COMMAND_KEY;
+        command->key = c;
+        command->setting = SETTING_NONE;
+        command->value = nullptr;
+        command->error = COMMAND_ERROR_NONE;
+        return true;
+    }
+    
+    if (c == '\r' || c == '\n') {
+        inLine = false;
+        return finishLine(command);
+    }
+    if (c == '\b' || c == 0x7F) {
+        if (length > 0 && !overflow) {
+            length--;
+        }
+        return false;
+    }
+    if (overflow) {
+        return false;
+    }
+    if (length >= COMMAND_LINE_SIZE - 1) {
+        overflow = true;
+        return false;
+    }
+    line[length++] = c;
+    return false;
+}
+
+bool CommandParser::finishLine(Command* command) {
+    command->type = COMMAND_ERROR;
+    command->key = '$';
+    command->setting = SETTING_NONE;
+    command->value = nullptr;
+    command->error = COMMAND_ERROR_NONE;
+    
+    if (overflow) {
+        command->error = COMMAND_ERROR_TOO_LONG;
+        return true;
+    }
+    line[length] = '\0';
+    for (int i = 0; i < length; i++) {
+        if (!isPrintable(line[i])) {
+            command->error = COMMAND_ERROR_SYNTAX;
+            return true;
+        }
+    }
+    
+    // Trim both ends in place
+    char* start = line;
+    while (*start == ' ') {
+        start++;
+    }
+    char* end = line + length;
+    while (end > start && end[-1] == ' ') {
+        *--end = '\0';
+    }
+    if (*start == '\0') {
+        command->type = COMMAND_LIST;
+        return true;
+    }
+    
+    // Name, then an optional '=' and value with spaces around them
+    char* value = start;
+    while (*value && *value != '=' && *value != ' ') {
+        value++;
+    }
+    bool hasSeparator = false;
+    while (*value == ' ' || *value == '=') {
+        if (*value == '=') {
+            if (hasSeparator) {
+                command->error = COMMAND_ERROR_SYNTAX;
+                return true;
+            }
+            hasSeparator = true;
+        }
+        *value++ = '\0';
+    }
+    for (char* p = value; *p; p++) {
+        if (*p == ' ' || *p == '=') {
+            command->error = COMMAND_ERROR_SYNTAX;
+            return true;
+        }
+    }
+    bool hasValue = *value != '\0';
+    
+    if (matchesName(start, "stats") || matchesName(start, "help")) {
+        if (hasValue || hasSeparator) {
+            command->error = COMMAND_ERROR_SYNTAX;
+            return true;
+        }
+        command->type = matchesName(start, "stats") ? COMMAND_STATS : COMMAND_HELP;
+        return true;
+    }
+    
+    for (int i = 0; i < SETTING_COUNT; i++) {
+        if (matchesName(start, SETTING_NAMES[i])) {
+            command->setting = (CommandSetting)i;
+        }
+    }
+    if (command->setting == SETTING_NONE) {
+        command->error = COMMAND_ERROR_UNKNOWN;
+        return true;
+    }
+    if (hasSeparator && !hasValue) {
+        command->error = COMMAND_ERROR_SYNTAX;
+        return true;
+    }
+    
+    command->type = hasValue ? COMMAND_SET : COMMAND_GET;
+    command->value = hasValue ? value : nullptr;
+    return true;
+}
+
+const char* CommandParser::settingName(CommandSetting setting) {
+    if (setting < 0 || setting >= SETTING_COUNT) {
+        return "";
+    }
+    return SETTING_NAMES[setting];
+}
+
+bool CommandParser::matchesName(const char* text, const char* name) {
+    while (*text && *name) {
+        if (toLower(*text) != *name) {
+            return false;
+        }
+        text++;
+        name++;
+    }
+    return *text == '\0' && *name == '\0';
+}
+
+bool CommandParser::parseNumber(const char* text, float* value) {
+    bool negative = false;
+    if (*text == '-' || *text == '+') {
+        negative = *text == '-';
+        text++;
+    }
+    
+    float result = 0.0f;
+    float scale = 1.0f;
+    int digits = 0;
+    bool fraction = false;
+    for (; *text; text++) {
+        if (*text == '.' && !fraction) {
+            fraction = true;
+        } else if (*text >= '0' && *text <= '9') {
+            if (fraction) {
+                scale *= 0.1f;
+                result += (*text - '0') * scale;
+            } else {
+                result = result * 10.0f + (*text - '0');
+            }
+            digits++;
+        } else {
+            return false;
+        }
+    }
+    if (digits == 0) {
+        return false;
+    }
+    
+    *value = negative ? -result : result;
+    return true;
+}
+
+bool CommandParser::isWholeInRange(float value, long min, long max) {
+    return value >= (float)min && value <= (float)max && floorf(value) == value;
+}
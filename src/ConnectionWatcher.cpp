@@ -0,0 +1,50 @@
+#include "ConnectionWatcher.h"
+
+ConnectionWatcher::ConnectionWatcher()
+    : connectThreshold(0),
+      disconnectThreshold(0),
+      debounceSamples(CONNECT_DEBOUNCE_SAMPLES),
+      connected(false),
+      pendingSamples(0),
+      pendingSince(0),
+      changeTime(0) {
+}
+
+void ConnectionWatcher::configure(int connectRaw, int disconnectRaw, int debounce) {
+    connectThreshold = connectRaw;
+    disconnectThreshold = disconnectRaw;
+    debounceSamples = debounce > 0 ? debounce : 1;
+}
+
+ConnectionEvent ConnectionWatcher::sample(int raw, unsigned long nowMs) {
+    // Does this sample point to the opposite of the current state?
+    bool opposite = connected ? (raw <= disconnectThreshold) : (raw >= connectThreshold);
+    
+    if (!opposite) {
+        pendingSamples = 0;
+        return CONNECTION_NONE;
+    }
+    
+    if (pendingSamples == 0) {
+        pendingSince = nowMs;
+    }
+    pendingSamples++;
+    
+    if (pendingSamples < debounceSamples) {
+        return CONNECTION_NONE;
+    }
+    
+    connected = !connected;
+    pendingSamples = 0;
+    changeTime = pendingSince;
+    
+    return connected ? CONNECTION_CONNECTED : CONNECTION_DISCONNECTED;
+}
+
+bool ConnectionWatcher::isConnected() const {
+    return connected;
+}
+
+unsigned long ConnectionWatcher::getChangeTime() const {
+    return changeTime;
+}
@@ -1,6 +1,7 @@
 #include "DebugLogger.h"
 
 int DebugLogger::debugLevel = DEBUG_VERBOSITY;
+int DebugLogger::outputFormat = OUTPUT_FORMAT_TEXT;
 
 void DebugLogger::begin(int level) {
     debugLevel = level;
@@ -11,13 +12,13 @@ void DebugLogger::begin(int level) {
         
         // Send multiple messages to ensure connection
         for (int i = 0; i < 3; i++) {
-            Serial.println("\n=== LiPo Battery Tester Debug Logger ===");
+            Serial.println(F("\n=== LiPo Battery Tester Debug Logger ==="));
             delay(100);
         }
         
-        Serial.print("Debug Level: ");
+        Serial.print(F("Debug Level: "));
         Serial.println(debugLevel);
-        Serial.println("========================================\n");
+        Serial.println(F("========================================\n"));
         Serial.flush();
     }
 }
@@ -29,7 +30,7 @@ void DebugLogger::setLevel(int level) {
     debugLevel = level;
     
     if (debugLevel > DEBUG_LEVEL_NONE) {
-        Serial.print("Debug level changed to: ");
+        Serial.print(F("Debug level changed to: "));
         Serial.println(debugLevel);
     }
 }
@@ -38,70 +39,323 @@ int DebugLogger::getLevel() {
     return debugLevel;
 }
 
-void DebugLogger::logRawADC(int rawValue, float adcVoltage) {
-    if (debugLevel >= DEBUG_LEVEL_RAW) {
-        Serial.println("--- Raw ADC Reading ---");
-        Serial.print("Raw ADC Value: ");
-        Serial.println(rawValue);
-        Serial.print("ADC Pin Voltage: ");
-        Serial.print(adcVoltage, 4);
-        Serial.println(" V");
+void DebugLogger::setFormat(int format) {
+    outputFormat = (format == OUTPUT_FORMAT_CSV || format == OUTPUT_FORMAT_BINARY) ? format : OUTPUT_FORMAT_TEXT;
+    
+    if (outputFormat == OUTPUT_FORMAT_CSV && debugLevel > DEBUG_LEVEL_NONE) {
+        printCsvHeader(Serial);
+    }
+}
+
+int DebugLogger::getFormat() {
+    return outputFormat;
+}
+
+void DebugLogger::logChemistry(const char* name) {
+    if (debugLevel >= DEBUG_LEVEL_DISPLAY) {
+        Serial.print(F("Chemistry: "));
+        Serial.println(name);
         Serial.println();
     }
 }
 
-void DebugLogger::logCalculatedValues(float batteryVoltage, const BatteryInfo& info) {
-    if (debugLevel >= DEBUG_LEVEL_CALCULATED) {
-        Serial.println("--- Calculated Values ---");
-        Serial.print("Battery Voltage: ");
-        Serial.print(batteryVoltage, 3);
-        Serial.println(" V");
-        Serial.print("Detected Cells: ");
-        Serial.println(info.cellCount);
+void DebugLogger::logSessionStats(const SessionHistory& history) {
+    if (debugLevel >= DEBUG_LEVEL_DISPLAY) {
+        Serial.println(F("--- Session History ---"));
+        Serial.print(F("Readings: "));
+        Serial.print(history.getSessionCount());
+        Serial.print(F(" ("));
+        Serial.print(history.getCount());
+        Serial.print(F(" buffered in "));
+        Serial.print(history.getBytesUsed());
+        Serial.println(F(" bytes)"));
         
-        if (info.isValid) {
-            Serial.print("Average Cell Voltage: ");
-            Serial.print(info.averageCellVoltage, 3);
-            Serial.println(" V");
-            Serial.print("Charge Percentage: ");
-            Serial.print(info.chargePercentage);
-            Serial.println(" %");
-        } else {
-            Serial.println("Invalid battery reading!");
+        if (history.getSessionCount() > 0) {
+            Serial.print(F("Min/Avg/Max: "));
+            Serial.print(history.getMinimum(), 3);
+            Serial.print(F(" / "));
+            Serial.print(history.getMean(), 3);
+            Serial.print(F(" / "));
+            Serial.print(history.getMaximum(), 3);
+            Serial.println(F(" V"));
+            Serial.print(F("Std Dev: "));
+            Serial.print(history.getStdDev() * 1000.0f, 1);
+            Serial.println(F(" mV"));
+            Serial.print(F("Sag Events: "));
+            Serial.print(history.getSagCount());
+            Serial.print(F(" (deepest "));
+            Serial.print(history.getDeepestSag(), 2);
+            Serial.println(F(" V)"));
         }
         Serial.println();
     }
 }
 
-void DebugLogger::logDisplayInfo(const BatteryInfo& info) {
+void DebugLogger::logBusStats(const I2cScheduler& bus) {
     if (debugLevel >= DEBUG_LEVEL_DISPLAY) {
-        Serial.println("--- Display Output ---");
+        static const uint8_t addresses[] = { SCREEN_ADDRESS, ADS1115_ADDRESS };
+        
+        Serial.println(F("--- I2C Bus ---"));
+        Serial.print(F("Busy: "));
+        Serial.print(bus.getBusyMicros() / 1000);
+        Serial.println(F(" ms"));
         
-        if (info.isValid) {
-            Serial.print(info.cellCount);
-            Serial.print("S ");
-            Serial.print(info.totalVoltage, 2);
-            Serial.println("V");
-            
-            if (info.cellCount > 1) {
-                Serial.print("Avg: ");
-                Serial.print(info.averageCellVoltage, 2);
-                Serial.println("V/cell");
+        for (unsigned int i = 0; i < sizeof(addresses); i++) {
+            I2cDeviceStats stats;
+            if (!bus.getDeviceStats(addresses[i], &stats)) {
+                continue;
             }
-            
-            Serial.print("Charge: ");
-            Serial.print(info.chargePercentage);
-            Serial.println("%");
-        } else {
-            Serial.println("Invalid Battery!");
+            Serial.print(F("0x"));
+            Serial.print(stats.address, HEX);
+            Serial.print(F(": "));
+            Serial.print(stats.transactions);
+            Serial.print(F(" transactions, "));
+            Serial.print(stats.bytes);
+            Serial.print(F(" bytes, "));
+            Serial.print(stats.errors);
+            Serial.print(F(" errors, latency avg "));
+            Serial.print(stats.transactions > 0 ? stats.totalLatencyUs / stats.transactions : 0);
+            Serial.print(F(" max "));
+            Serial.print(stats.maxLatencyUs);
+            Serial.println(F(" us"));
+        }
+        Serial.println();
+    }
+}
+
+void DebugLogger::logTaskStats(const TaskScheduler& scheduler) {
+    if (debugLevel >= DEBUG_LEVEL_DISPLAY) {
+        Serial.println(F("--- Tasks (lateness/duration in us) ---"));
+        for (int i = 0; i < scheduler.getTaskCount(); i++) {
+            const TaskStats& stats = scheduler.getStats(i);
+            Serial.print(scheduler.getName(i));
+            Serial.print(F(": "));
+            Serial.print(stats.runs);
+            Serial.print(F(" runs, "));
+            Serial.print(stats.overruns);
+            Serial.print(F(" overruns, "));
+            Serial.print(stats.skipped);
+            Serial.print(F(" skipped, late avg "));
+            Serial.print(stats.runs > 0 ? stats.totalLatenessUs / stats.runs : 0);
+            Serial.print(F(" max "));
+            Serial.print(stats.maxLatenessUs);
+            Serial.print(F(" jitter "));
+            Serial.print(stats.maxLatenessUs - stats.minLatenessUs);
+            Serial.print(F(", longest run "));
+            Serial.println(stats.maxDurationUs);
+        }
+        Serial.println();
+    }
+}
+
+#if MEMORY_MONITOR
+void DebugLogger::logMemoryStats(const TaskScheduler& scheduler) {
+    if (debugLevel >= DEBUG_LEVEL_DISPLAY) {
+        Serial.print(F("--- Memory (bytes, "));
+        Serial.print((unsigned long)MemoryMonitor::getPaintedBytes());
+        Serial.println(F(" stack painted) ---"));
+        for (int i = -1; i < scheduler.getTaskCount(); i++) {
+            int stage = i < 0 ? MemoryMonitor::SETUP_STAGE : i;
+            const MemoryStats& stats = MemoryMonitor::getStats(stage);
+            if (i < 0) {
+                Serial.print(F("setup"));
+            } else {
+                Serial.print(scheduler.getName(i));
+            }
+            Serial.print(F(": stack "));
+            Serial.print((unsigned long)stats.stackUsed);
+            Serial.print(F(" used "));
+            Serial.print((unsigned long)stats.stackFree);
+            Serial.print(F(" free, heap "));
+            Serial.print((unsigned long)stats.heapUsed);
+            Serial.print(F(" used "));
+            Serial.print((unsigned long)stats.heapFree);
+            Serial.print(F(" free, "));
+            Serial.print(stats.runs);
+            Serial.println(F(" runs"));
         }
-        
         Serial.println();
     }
 }
+#endif
+
+void DebugLogger::printCsvHeader(Print& out) {
+    out.println(F("time_ms,raw,voltage,cells,confidence,cell_v,charge,mv_per_min,min_to_empty"));
+}
+
+void DebugLogger::printMeasurement(Print& out, int format, unsigned long timeMs, int rawValue,
+                                   float batteryVoltage, const BatteryInfo& info, const TrendInfo& trend) {
+    if (format == OUTPUT_FORMAT_BINARY) {
+        MeasurementFrame frame;
+        frame.timeMs = (uint32_t)timeMs;
+        frame.raw = (uint16_t)rawValue;
+        frame.millivolts = (uint16_t)(batteryVoltage * 1000.0f + 0.5f);
+        frame.cellCount = (uint8_t)(info.isValid ? info.cellCount : 0);
+        frame.confidence = (uint8_t)info.cellConfidence;
+        frame.cellMillivolts = (uint16_t)(info.isValid ? info.averageCellVoltage * 1000.0f + 0.5f : 0);
+        frame.charge = (uint8_t)(info.isValid ? info.chargePercentage : 0);
+        frame.flags = trend.isValid ? MEASUREMENT_FRAME_TREND : 0;
+        frame.trendDeciMvPerMin = (int16_t)(trend.isValid ? trend.millivoltsPerMinute * 10.0f : 0);
+        frame.minutesToEmpty = (int16_t)(trend.isValid && trend.minutesToEmpty >= 0 && trend.minutesToEmpty < 32767 ?
+                                         trend.minutesToEmpty : -1);
+        
+        uint8_t bytes[MeasurementFrameCodec::FRAME_SIZE];
+        out.write(bytes, MeasurementFrameCodec::encode(frame, bytes));
+    } else if (format == OUTPUT_FORMAT_CSV) {
+        out.print(timeMs);
+        out.print(',');
+        out.print(rawValue);
+        out.print(',');
+        out.print(batteryVoltage, 3);
+        out.print(',');
+        out.print(info.isValid ? info.cellCount : 0);
+        out.print(',');
+        out.print(info.cellConfidence);
+        out.print(',');
+        out.print(info.isValid ? info.averageCellVoltage : 0.0f, 3);
+        out.print(',');
+        out.print(info.isValid ? info.chargePercentage : 0);
+        out.print(',');
+        if (trend.isValid) {
+            out.print(trend.millivoltsPerMinute, 1);
+        }
+        out.print(',');
+        if (trend.isValid && trend.minutesToEmpty >= 0) {
+            out.print(trend.minutesToEmpty);
+        }
+        out.println();
+    }
+}
+
+void DebugLogger::printRawADC(Print& out, int rawValue, float adcVoltage) {
+    out.println(F("--- Raw ADC Reading ---"));
+    out.print(F("Raw ADC Value: "));
+    out.println(rawValue);
+    out.print(F("ADC Pin Voltage: "));
+    out.print(adcVoltage, 4);
+    out.println(F(" V"));
+    out.println();
+}
+
+void DebugLogger::printSampleBlocks(Print& out, int blocks, int lost) {
+    out.print(F("Sample Blocks: "));
+    out.print(blocks);
+    if (lost > 0) {
+        out.print(F(" ("));
+        out.print(lost);
+        out.print(F(" lost)"));
+    }
+    out.println();
+}
+
+void DebugLogger::printCalculatedValues(Print& out, float batteryVoltage, const BatteryInfo& info) {
+    out.println(F("--- Calculated Values ---"));
+    out.print(F("Battery Voltage: "));
+    out.print(batteryVoltage, 3);
+    out.println(F(" V"));
+    out.print(F("Detected Cells: "));
+    out.println(info.cellCount);
+    out.print(F("Cell Confidence: "));
+    out.print(info.cellConfidence);
+    out.println(F(" %"));
+    
+    if (info.isValid) {
+        out.print(F("Average Cell Voltage: "));
+        out.print(info.averageCellVoltage, 3);
+        out.println(F(" V"));
+        out.print(F("Charge Percentage: "));
+        out.print(info.chargePercentage);
+        out.println(F(" %"));
+    } else {
+        out.println(F("Invalid battery reading!"));
+    }
+    out.println();
+}
+
+void DebugLogger::printCellVoltages(Print& out, const BatteryInfo& info) {
+    if (info.balanceCells <= 0) {
+        return;
+    }
+    
+    out.print(F("Cell Voltages:"));
+    for (int i = 0; i < info.balanceCells; i++) {
+        out.print(' ');
+        out.print(info.cellVoltages[i], 3);
+    }
+    out.println(F(" V"));
+    out.print(F("Imbalance: "));
+    out.print((int)(info.imbalance * 1000.0f + 0.5f));
+    out.print(F(" mV (weakest: cell "));
+    out.print(info.weakestCell);
+    out.println(')');
+    out.println();
+}
+
+void DebugLogger::printTrend(Print& out, const TrendInfo& trend) {
+    if (!trend.isValid) {
+        out.println(F("Discharge Rate: collecting..."));
+        out.println();
+        return;
+    }
+    
+    out.print(F("Discharge Rate: "));
+    out.print(trend.millivoltsPerMinute, 1);
+    out.println(F(" mV/min"));
+    out.print(F("Time to Empty: "));
+    if (trend.minutesToEmpty >= 0) {
+        out.print(trend.minutesToEmpty);
+        out.println(F(" min"));
+    } else {
+        out.println('-');
+    }
+    out.println();
+}
+
+void DebugLogger::printDisplayInfo(Print& out, const BatteryInfo& info) {
+    out.println(F("--- Display Output ---"));
+    
+    if (info.isValid) {
+        out.print(info.cellCount);
+        out.print(F("S "));
+        out.print(info.totalVoltage, 2);
+        out.println(F("V"));
+        
+        if (info.cellCount > 1) {
+            out.print(F("Avg: "));
+            out.print(info.averageCellVoltage, 2);
+            out.println(F("V/cell"));
+        }
+        
+        out.print(F("Charge: "));
+        out.print(info.chargePercentage);
+        out.println(F("%"));
+    } else {
+        out.println(F("Invalid Battery!"));
+    }
+    
+    out.println();
+}
+
+void DebugLogger::printConnection(Print& out, bool connected) {
+    out.println(connected ? F("Battery connected") : F("Battery disconnected"));
+    out.println();
+}
+
+void DebugLogger::printConnectLatency(Print& out, unsigned long latencyMs) {
+    out.print(F("Connect-to-display latency: "));
+    out.print(latencyMs);
+    out.println(F(" ms"));
+    out.println();
+}
 
 void DebugLogger::log(const char* message) {
     if (debugLevel > DEBUG_LEVEL_NONE) {
         Serial.println(message);
     }
 }
+
+void DebugLogger::log(const __FlashStringHelper* message) {
+    if (debugLevel > DEBUG_LEVEL_NONE) {
+        Serial.println(message);
+    }
+}
@@ -2,19 +2,31 @@
 
 Adafruit_SSD1306* DisplayManager::display = nullptr;
 
+// Frame upload: set the full-screen window (command stream), then the framebuffer
+// as data chunks. Horizontal addressing is set by the Adafruit init sequence.
+uint8_t DisplayManager::windowCommands[7] = {
+    0x00,                         // Control byte: commands follow
+    0x22, 0x00, 0xFF,             // Page address: 0 to end
+    0x21, 0x00, SCREEN_WIDTH - 1  // Column address: 0 to width - 1
+};
+I2cTransaction DisplayManager::frameWindow = {
+    SCREEN_ADDRESS, I2C_PRIORITY_DISPLAY, false, false, 0,
+    DisplayManager::windowCommands, sizeof(DisplayManager::windowCommands), I2C_STATUS_IDLE, 0, 0
+};
+I2cTransaction DisplayManager::frameData = {
+    SCREEN_ADDRESS, I2C_PRIORITY_DISPLAY, false, true, 0x40,  // Control byte: data follows
+    nullptr, SCREEN_WIDTH * SCREEN_HEIGHT / 8, I2C_STATUS_IDLE, 0, 0
+};
+
 bool DisplayManager::begin() {
-    // Initialize I2C with platform-specific pins
-#ifdef ARDUINO_PRO_MINI
-    Wire.begin();  // Arduino Pro Mini uses default I2C pins (A4=SDA, A5=SCL)
-#else
-    Wire.begin(I2C_SDA, I2C_SCL);  // ESP32-C3 uses custom pins
-#endif
-    
-    // Create display object
-    display = new Adafruit_SSD1306(SCREEN_WIDTH, SCREEN_HEIGHT, &Wire, OLED_RESET);
-    
-    // Initialize display
-    if (!display->begin(SSD1306_SWITCHCAPVCC, SCREEN_ADDRESS)) {
+    // Initialize I2C with platform-specific pins (shared with external sensors)
+    WireBus::begin();
+    
+    // Create display object; the bus stays at I2C_CLOCK_HZ after each update
+    display = new Adafruit_SSD1306(SCREEN_WIDTH, SCREEN_HEIGHT, &Wire, OLED_RESET, I2C_CLOCK_HZ, I2C_CLOCK_HZ);
+    
+    // Initialize display (Wire is already started)
+    if (!display->begin(SSD1306_SWITCHCAPVCC, SCREEN_ADDRESS, true, false)) {
         return false;
     }
     
@@ -25,14 +37,31 @@ bool DisplayManager::begin() {
     return true;
 }
 
+void DisplayManager::flush() {
+    // Queued in chunks so sensor reads never wait for a whole frame; a frame
+    // still being sent is restarted so the panel ends up with the new one
+    I2cScheduler& bus = I2cScheduler::shared();
+    unsigned long now = micros();
+    
+    bus.cancel(&frameData);
+    bus.submit(&frameWindow, now);
+    frameData.data = display->getBuffer();
+    bus.submit(&frameData, now);
+}
+
 void DisplayManager::clear() {
     if (display) {
         display->clearDisplay();
-        display->display();
+        flush();
     }
 }
 
 void DisplayManager::displayBatteryInfo(const BatteryInfo& info) {
+    TrendInfo noTrend = { false, 0.0f, -1 };
+    displayBatteryInfo(info, noTrend);
+}
+
+void DisplayManager::displayBatteryInfo(const BatteryInfo& info, const TrendInfo& trend) {
     if (!display) return;
     
     display->clearDisplay();
@@ -41,40 +70,69 @@ void DisplayManager::displayBatteryInfo(const BatteryInfo& info) {
     display->setCursor(0, 0);
     
     if (!info.isValid) {
-        display->println("Invalid Battery!");
-        display->display();
+        display->println(F("Invalid Battery!"));
+        flush();
         return;
     }
     
     // Line 1: Cell count and total voltage
     display->print(info.cellCount);
-    display->print("S ");
+    display->print(F("S "));
     display->print(info.totalVoltage, 2);
-    display->println("V");
+    display->print(F("V"));
+    
+    // Cell count still uncertain: show tracker confidence
+    if (info.cellConfidence < 100) {
+        display->print(F(" ?"));
+        display->print(info.cellConfidence);
+        display->print(F("%"));
+    }
+    display->println();
     
-    // Line 2: Average cell voltage or single voltage
+    // Line 2: Weakest cell when balance leads are connected, else the average
     // If 1S, show voltage only once (avoid duplicate info)
-    if (info.cellCount > 1) {
-        display->print("Avg: ");
+    if (info.balanceCells > 1) {
+        display->print(F("Min C"));
+        display->print(info.weakestCell);
+        display->print(' ');
+        display->print(info.cellVoltages[info.weakestCell - 1], 2);
+        display->print(F("V d"));
+        display->print((int)(info.imbalance * 1000.0f + 0.5f));
+        display->println(F("mV"));
+    } else if (info.cellCount > 1) {
+        display->print(F("Avg: "));
         display->print(info.averageCellVoltage, 2);
-        display->println("V/cell");
+        display->println(F("V/cell"));
     } else {
         // For 1S, the line above already shows the voltage
         // Show a different info or leave space
-        display->println("");
+        display->println();
     }
     
-    // Line 3: Charge percentage with bar
-    display->print("Charge: ");
-    display->print(info.chargePercentage);
-    display->println("%");
+    // Line 3: Charge percentage, plus discharge rate and time to empty once known
+    if (trend.isValid) {
+        display->print(info.chargePercentage);
+        display->print(F("% "));
+        display->print((int)trend.millivoltsPerMinute);
+        display->print(F("mV/m"));
+        if (trend.minutesToEmpty >= 0) {
+            display->print(' ');
+            display->print(trend.minutesToEmpty);
+            display->print(F("m"));
+        }
+        display->println();
+    } else {
+        display->print(F("Charge: "));
+        display->print(info.chargePercentage);
+        display->println(F("%"));
+    }
     
     // Line 4: Simple bar graph
     int barWidth = (info.chargePercentage * (SCREEN_WIDTH - 4)) / 100;
     display->drawRect(0, 24, SCREEN_WIDTH, 8, SSD1306_WHITE);
     display->fillRect(2, 26, barWidth, 4, SSD1306_WHITE);
     
-    display->display();
+    flush();
 }
 
 void DisplayManager::displayError(const char* message) {
@@ -84,9 +142,9 @@ void DisplayManager::displayError(const char* message) {
     display->setTextSize(1);
     display->setTextColor(SSD1306_WHITE);
     display->setCursor(0, 0);
-    display->println("ERROR:");
+    display->println(F("ERROR:"));
     display->println(message);
-    display->display();
+    flush();
 }
 
 void DisplayManager::displayInitMessage() {
@@ -96,9 +154,70 @@ void DisplayManager::displayInitMessage() {
     display->setTextSize(1);
     display->setTextColor(SSD1306_WHITE);
     display->setCursor(0, 0);
-    display->println("LiPo Battery");
-    display->println("Tester v1.0");
-    display->println("");
-    display->println("Initializing...");
-    display->display();
+    display->println(F("LiPo Battery"));
+    display->println(F("Tester v1.0"));
+    display->println();
+    display->println(F("Initializing..."));
+    flush();
+}
+
+void DisplayManager::displayChemistry(const char* name) {
+    if (!display) return;
+    
+    display->clearDisplay();
+    display->setTextSize(1);
+    display->setTextColor(SSD1306_WHITE);
+    display->setCursor(0, 0);
+    display->println(F("Chemistry:"));
+    display->setTextSize(2);
+    display->println(name);
+    flush();
+}
+
+void DisplayManager::displayNoBattery() {
+    if (!display) return;
+    
+    display->clearDisplay();
+    display->setTextSize(1);
+    display->setTextColor(SSD1306_WHITE);
+    display->setCursor(0, 0);
+    display->println(F("No battery"));
+    display->println();
+    display->println(F("Connect a pack..."));
+    flush();
+}
+
+void DisplayManager::displayHistory(const SessionHistory& history) {
+    if (!display) return;
+    
+    display->clearDisplay();
+    display->setTextSize(1);
+    display->setTextColor(SSD1306_WHITE);
+    display->setCursor(0, 0);
+    
+    if (history.getCount() == 0) {
+        display->println(F("No history yet"));
+        flush();
+        return;
+    }
+    
+    // Line 1: Session voltage range and sag events
+    display->print(history.getMinimum(), 2);
+    display->print('-');
+    display->print(history.getMaximum(), 2);
+    display->print(F("V "));
+    display->print(history.getSagCount());
+    display->print(F(" sag"));
+    
+    // Below: sparkline of the buffered readings, newest on the right
+    const int top = 10;
+    const int height = SCREEN_HEIGHT - top - 1;
+    uint8_t heights[SCREEN_WIDTH];
+    int columns = history.sparkline(heights, SCREEN_WIDTH, height);
+    int left = SCREEN_WIDTH - columns;
+    for (int c = 0; c < columns; c++) {
+        display->drawFastVLine(left + c, SCREEN_HEIGHT - 1 - heights[c], heights[c] + 1, SSD1306_WHITE);
+    }
+    
+    flush();
 }
@@ -0,0 +1,81 @@
+#include "FlashStorage.h"
+
+#ifndef UNIT_TEST
+
+#ifdef ARDUINO_PRO_MINI
+
+#include <EEPROM.h>
+
+bool EepromFlash::begin() {
+    return pageCount() >= 2;
+}
+
+uint32_t EepromFlash::pageSize() const {
+    return LOG_EEPROM_PAGE_SIZE;
+}
+
+uint32_t EepromFlash::pageCount() const {
+    return (EEPROM.length() - CALIBRATION_EEPROM_BYTES) / LOG_EEPROM_PAGE_SIZE;
+}
+
+bool EepromFlash::read(uint32_t address, uint8_t* data, uint32_t length) {
+    for (uint32_t i = 0; i < length; i++) {
+        data[i] = EEPROM.read(address + i);
+    }
+    return true;
+}
+
+bool EepromFlash::write(uint32_t address, const uint8_t* data, uint32_t length) {
+    for (uint32_t i = 0; i < length; i++) {
+        EEPROM.update(address + i, data[i]);
+    }
+    return true;
+}
+
+bool EepromFlash::erasePage(uint32_t page) {
+    uint32_t start = page * LOG_EEPROM_PAGE_SIZE;
+    for (uint32_t i = 0; i < LOG_EEPROM_PAGE_SIZE; i++) {
+        EEPROM.update(start + i, 0xFF);  // Skips bytes that are already erased
+    }
+    return true;
+}
+
+#else
+
+namespace {
+
+const uint32_t SECTOR_SIZE = 4096;
+
+} // namespace
+
+PartitionFlash::PartitionFlash() : partition(nullptr) {
+}
+
+bool PartitionFlash::begin() {
+    partition = esp_partition_find_first(ESP_PARTITION_TYPE_DATA, ESP_PARTITION_SUBTYPE_DATA_SPIFFS, NULL);
+    return partition != nullptr && pageCount() >= 2;
+}
+
+uint32_t PartitionFlash::pageSize() const {
+    return SECTOR_SIZE;
+}
+
+uint32_t PartitionFlash::pageCount() const {
+    return partition ? partition->size / SECTOR_SIZE : 0;
+}
+
+bool PartitionFlash::read(uint32_t address, uint8_t* data, uint32_t length) {
+    return partition && esp_partition_read(partition, address, data, length) == ESP_OK;
+}
+
+bool PartitionFlash::write(uint32_t address, const uint8_t* data, uint32_t length) {
+    return partition && esp_partition_write(partition, address, data, length) == ESP_OK;
+}
+
+bool PartitionFlash::erasePage(uint32_t page) {
+    return partition && esp_partition_erase_range(partition, page * SECTOR_SIZE, SECTOR_SIZE) == ESP_OK;
+}
+
+#endif // ARDUINO_PRO_MINI
+
+#endif // UNIT_TEST
@@ -0,0 +1,203 @@
+#include "FreeRunningAdc.h"
+
+#ifdef __AVR__
+#include <avr/interrupt.h>
+#include <avr/io.h>
+#include <avr/sleep.h>
+#endif
+
+namespace {
+
+// Conversion time in ADC clocks once the ADC is running (the first takes 25)
+const unsigned long CLOCKS_PER_CONVERSION = 13;
+
+} // namespace
+
+FreeRunningAdc* FreeRunningAdc::active = nullptr;
+
+FreeRunningAdc::FreeRunningAdc(AdcRegisters& registers, uint8_t channel, int prescaler, int oversample,
+                               bool noiseSleep)
+    : registers(registers), channel(channel & 0x07), prescaler(prescalerBits(prescaler)),
+      oversample((uint8_t)(oversample < 1 ? 1 : oversample > MAX_OVERSAMPLE ? MAX_OVERSAMPLE : oversample)),
+      noiseSleep(noiseSleep), completed(0), latest(0), taken(0), dropped(0), batchSum(0), batchCount(0) {
+    for (int i = 0; i < 2; i++) {
+        blocks[i].sum = 0;
+        blocks[i].count = 0;
+    }
+}
+
+void FreeRunningAdc::begin() {
+    // Quiet the ADC while it is reconfigured, then start clean
+    registers.write(AdcRegisters::CONTROL_A, 0);
+    for (int i = 0; i < 2; i++) {
+        blocks[i].sum = 0;
+        blocks[i].count = 0;
+    }
+    completed = 0;
+    taken = 0;
+    dropped = 0;
+    latest = 0;
+    startBatch();
+    active = this;
+    
+    registers.write(AdcRegisters::MULTIPLEXER, MULTIPLEXER_AVCC | channel);
+    registers.write(AdcRegisters::CONTROL_B, 0);            // Auto trigger source: free running
+    if (channel < 6) {
+        // No digital input buffer on the analog pin (ADC6/ADC7 have none)
+        registers.write(AdcRegisters::DIGITAL_DISABLE,
+                        (uint8_t)(registers.read(AdcRegisters::DIGITAL_DISABLE) | (1 << channel)));
+    }
+    
+    uint8_t control = CONTROL_A_ENABLE | CONTROL_A_INTERRUPT_FLAG | CONTROL_A_INTERRUPT_ENABLE | prescaler;
+    if (noiseSleep) {
+        // Each conversion starts when idle() enters noise-reduction sleep
+        registers.write(AdcRegisters::CONTROL_A, control);
+    } else {
+        registers.write(AdcRegisters::CONTROL_A, control | CONTROL_A_AUTO_TRIGGER | CONTROL_A_START);
+    }
+}
+
+void FreeRunningAdc::end() {
+    // Enabled with the same clock, no auto trigger and no interrupt: analogRead() works again
+    registers.write(AdcRegisters::CONTROL_A, CONTROL_A_ENABLE | CONTROL_A_INTERRUPT_FLAG | prescaler);
+    if (channel < 6) {
+        registers.write(AdcRegisters::DIGITAL_DISABLE,
+                        (uint8_t)(registers.read(AdcRegisters::DIGITAL_DISABLE) & ~(1 << channel)));
+    }
+    if (active == this) {
+        active = nullptr;
+    }
+}
+
+void FreeRunningAdc::handleInterrupt() {
+    if (active) {
+        active->onConversion(active->registers.readResult());
+    }
+}
+
+void FreeRunningAdc::onConversion(uint16_t sample) {
+    latest = sample;
+    uint8_t index = completed & 1;
+    uint8_t count = blocks[index].count + 1;
+    blocks[index].sum = blocks[index].sum + sample;
+    blocks[index].count = count;
+    if (count >= oversample) {
+        // Publish the block, then start the other one (a reader copying it retries)
+        completed = completed + 1;
+        blocks[index ^ 1].sum = 0;
+        blocks[index ^ 1].count = 0;
+    }
+}
+
+void FreeRunningAdc::idle() {
+    if (noiseSleep) {
+        registers.sleepUntilInterrupt();
+    }
+}
+
+void FreeRunningAdc::startBatch() {
+    batchSum = 0;
+    batchCount = 0;
+}
+
+bool FreeRunningAdc::poll() {
+    uint8_t seen;
+    uint16_t sum;
+    uint8_t count;
+    do {
+        seen = completed;
+        if (seen == taken) {
+            return false;
+        }
+        uint8_t index = (uint8_t)(seen - 1) & 1;
+        sum = blocks[index].sum;
+        count = blocks[index].count;
+    } while (completed != seen);
+    
+    dropped += (uint8_t)(seen - taken - 1);
+    taken = seen;
+    batchSum += sum;
+    batchCount += count;
+    return true;
+}
+
+int FreeRunningAdc::getBatchCount() const {
+    return batchCount;
+}
+
+int FreeRunningAdc::getBatchAverage() const {
+    if (batchCount == 0) {
+        return 0;
+    }
+    return (int)((batchSum + batchCount / 2) / batchCount);
+}
+
+int FreeRunningAdc::getLatest() const {
+    // Two bytes on AVR: read until no conversion landed in between
+    uint16_t value;
+    do {
+        value = latest;
+    } while (value != latest);
+    return value;
+}
+
+unsigned long FreeRunningAdc::getDroppedBlocks() const {
+    return dropped;
+}
+
+unsigned long FreeRunningAdc::getConversionMicros(unsigned long cpuHz) const {
+    unsigned long adcHz = cpuHz / prescalerDivision(prescaler);
+    return (CLOCKS_PER_CONVERSION * 1000000UL + adcHz - 1) / adcHz;
+}
+
+uint8_t FreeRunningAdc::prescalerBits(int prescaler) {
+    // ADPS 0 and 1 both divide by 2
+    uint8_t bits = 1;
+    while (bits < 7 && prescalerDivision(bits) < prescaler) {
+        bits++;
+    }
+    return bits;
+}
+
+int FreeRunningAdc::prescalerDivision(uint8_t bits) {
+    bits &= CONTROL_A_PRESCALER_MASK;
+    return bits == 0 ? 2 : 1 << bits;
+}
+
+#ifdef __AVR__
+
+ISR(ADC_vect) {
+    FreeRunningAdc::handleInterrupt();
+}
+
+uint8_t AvrAdcRegisters::read(Register reg) {
+    switch (reg) {
+        case MULTIPLEXER: return ADMUX;
+        case CONTROL_A: return ADCSRA;
+        case CONTROL_B: return ADCSRB;
+        default: return DIDR0;
+    }
+}
+
+void AvrAdcRegisters::write(Register reg, uint8_t value) {
+    switch (reg) {
+        case MULTIPLEXER: ADMUX = value; break;
+        case CONTROL_A: ADCSRA = value; break;
+        case CONTROL_B: ADCSRB = value; break;
+        default: DIDR0 = value; break;
+    }
+}
+
+uint16_t AvrAdcRegisters::readResult() {
+    return ADC;                  // ADCL first, which latches ADCH
+}
+
+void AvrAdcRegisters::sleepUntilInterrupt() {
+    // Timer0 stops in this mode too, so millis() and micros() fall behind by the sleep time
+    set_sleep_mode(SLEEP_MODE_ADC);
+    sleep_enable();
+    sleep_cpu();
+    sleep_disable();
+}
+
+#endif // __AVR__
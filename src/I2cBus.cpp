@@ -0,0 +1,39 @@
+#include "I2cBus.h"
+
+#ifndef UNIT_TEST
+
+#include <Wire.h>
+
+bool WireBus::started = false;
+
+void WireBus::begin() {
+    if (started) {
+        return;
+    }
+
+#ifdef ARDUINO_PRO_MINI
+    Wire.begin();  // Arduino Pro Mini uses default I2C pins (A4=SDA, A5=SCL)
+#else
+    Wire.begin(I2C_SDA, I2C_SCL);  // ESP32-C3 uses custom pins
+#endif
+    Wire.setClock(I2C_CLOCK_HZ);
+    started = true;
+}
+
+bool WireBus::write(uint8_t address, const uint8_t* data, uint8_t length) {
+    Wire.beginTransmission(address);
+    Wire.write(data, length);
+    return Wire.endTransmission() == 0;
+}
+
+bool WireBus::read(uint8_t address, uint8_t* data, uint8_t length) {
+    if (Wire.requestFrom(address, length) != length) {
+        return false;
+    }
+    for (uint8_t i = 0; i < length; i++) {
+        data[i] = (uint8_t)Wire.read();
+    }
+    return true;
+}
+
+#endif // UNIT_TEST
@@ -0,0 +1,235 @@
+#include "I2cScheduler.h"
+
+I2cScheduler::I2cScheduler(I2cBus& bus, unsigned long clockHz)
+    : bus(bus), clockHz(clockHz), busy(false), busyMicros(0), deviceCount(0) {
+    for (int p = 0; p < I2C_PRIORITY_COUNT; p++) {
+        heads[p] = 0;
+        counts[p] = 0;
+    }
+}
+
+bool I2cScheduler::submit(I2cTransaction* transaction, unsigned long nowUs) {
+    if (transaction->priority >= I2C_PRIORITY_COUNT || transaction->length == 0 ||
+        (transaction->isRead && transaction->length > I2C_CHUNK_BYTES)) {
+        return false;
+    }
+    
+    // Already queued: start over (the caller changed the data), keep its place
+    int index;
+    if (find(transaction, &index) >= 0) {
+        transaction->offset = 0;
+        transaction->queuedUs = nowUs;
+        return true;
+    }
+    
+    int priority = transaction->priority;
+    if (counts[priority] == QUEUE_DEPTH) {
+        return false;
+    }
+    
+    transaction->offset = 0;
+    transaction->queuedUs = nowUs;
+    transaction->status = I2C_STATUS_PENDING;
+    queues[priority][(heads[priority] + counts[priority]) % QUEUE_DEPTH] = transaction;
+    counts[priority]++;
+    return true;
+}
+
+void I2cScheduler::cancel(I2cTransaction* transaction) {
+    int index;
+    int priority = find(transaction, &index);
+    if (priority < 0) {
+        return;
+    }
+    
+    // Close the gap, keeping FIFO order
+    for (int i = index; i < counts[priority] - 1; i++) {
+        queues[priority][(heads[priority] + i) % QUEUE_DEPTH] = queues[priority][(heads[priority] + i + 1) % QUEUE_DEPTH];
+    }
+    counts[priority]--;
+    transaction->status = I2C_STATUS_IDLE;
+}
+
+bool I2cScheduler::poll(unsigned long nowUs) {
+    if (busy) {
+        return false;
+    }
+    
+    int priority = 0;
+    while (priority < I2C_PRIORITY_COUNT && counts[priority] == 0) {
+        priority++;
+    }
+    if (priority == I2C_PRIORITY_COUNT) {
+        return false;
+    }
+    
+    I2cTransaction* transaction = queues[priority][heads[priority]];
+    int remaining = transaction->length - transaction->offset;
+    int length = remaining < I2C_CHUNK_BYTES ? remaining : I2C_CHUNK_BYTES;
+    
+    busy = true;
+    bool ok;
+    int sent = length;
+    if (transaction->isRead) {
+        ok = bus.read(transaction->address, transaction->data + transaction->offset, (uint8_t)length);
+    } else if (transaction->hasPrefix) {
+        chunk[0] = transaction->prefix;
+        for (int i = 0; i < length; i++) {
+            chunk[i + 1] = transaction->data[transaction->offset + i];
+        }
+        sent = length + 1;
+        ok = bus.write(transaction->address, chunk, (uint8_t)sent);
+    } else {
+        ok = bus.write(transaction->address, transaction->data + transaction->offset, (uint8_t)length);
+    }
+    busy = false;
+    
+    unsigned long transfer = transferMicros(sent, clockHz);
+    busyMicros += transfer;
+    I2cDeviceStats* device = statsFor(transaction->address);
+    if (device) {
+        device->bytes += sent;
+    }
+    
+    transaction->offset += length;
+    if (!ok || transaction->offset >= transaction->length) {
+        removeHead(priority);
+        complete(transaction, ok, nowUs + transfer);
+    }
+    return true;
+}
+
+void I2cScheduler::drain(unsigned long nowUs) {
+    while (!isIdle()) {
+        unsigned long before = busyMicros;
+        if (!poll(nowUs)) {
+            return;
+        }
+        nowUs += busyMicros - before;
+    }
+}
+
+bool I2cScheduler::isIdle() const {
+    for (int p = 0; p < I2C_PRIORITY_COUNT; p++) {
+        if (counts[p] > 0) return false;
+    }
+    return true;
+}
+
+bool I2cScheduler::getDeviceStats(uint8_t address, I2cDeviceStats* result) const {
+    for (int i = 0; i < deviceCount; i++) {
+        if (stats[i].address == address) {
+            *result = stats[i];
+            return true;
+        }
+    }
+    return false;
+}
+
+unsigned long I2cScheduler::getBusyMicros() const {
+    return busyMicros;
+}
+
+bool I2cScheduler::write(uint8_t address, const uint8_t* data, uint8_t length) {
+    if (busy) {
+        return false;
+    }
+    busy = true;
+    bool ok = bus.write(address, data, length);
+    busy = false;
+    
+    unsigned long transfer = transferMicros(length, clockHz);
+    busyMicros += transfer;
+    record(address, length, ok, transfer);
+    return ok;
+}
+
+bool I2cScheduler::read(uint8_t address, uint8_t* data, uint8_t length) {
+    if (busy) {
+        return false;
+    }
+    busy = true;
+    bool ok = bus.read(address, data, length);
+    busy = false;
+    
+    unsigned long transfer = transferMicros(length, clockHz);
+    busyMicros += transfer;
+    record(address, length, ok, transfer);
+    return ok;
+}
+
+unsigned long I2cScheduler::transferMicros(int bytes, unsigned long clockHz) {
+    // Start + (address + data bytes) * (8 bits + ack) + stop
+    unsigned long bits = 2 + 9UL * (1 + bytes);
+    return (bits * 1000000UL + clockHz - 1) / clockHz;
+}
+
+I2cDeviceStats* I2cScheduler::statsFor(uint8_t address) {
+    for (int i = 0; i < deviceCount; i++) {
+        if (stats[i].address == address) {
+            return &stats[i];
+        }
+    }
+    if (deviceCount == I2C_MAX_DEVICES) {
+        return nullptr;
+    }
+    
+    I2cDeviceStats* device = &stats[deviceCount++];
+    device->address = address;
+    device->transactions = 0;
+    device->bytes = 0;
+    device->errors = 0;
+    device->maxLatencyUs = 0;
+    device->totalLatencyUs = 0;
+    return device;
+}
+
+void I2cScheduler::record(uint8_t address, int bytes, bool ok, unsigned long latencyUs) {
+    I2cDeviceStats* device = statsFor(address);
+    if (!device) {
+        return;
+    }
+    device->bytes += bytes;
+    if (!ok) {
+        device->errors++;
+        return;
+    }
+    device->transactions++;
+    device->totalLatencyUs += latencyUs;
+    if (latencyUs > device->maxLatencyUs) {
+        device->maxLatencyUs = latencyUs;
+    }
+}
+
+void I2cScheduler::complete(I2cTransaction* transaction, bool ok, unsigned long endUs) {
+    // Bytes were counted per chunk in poll()
+    record(transaction->address, 0, ok, endUs - transaction->queuedUs);
+    transaction->status = ok ? I2C_STATUS_DONE : I2C_STATUS_FAILED;
+}
+
+int I2cScheduler::find(const I2cTransaction* transaction, int* index) const {
+    for (int p = 0; p < I2C_PRIORITY_COUNT; p++) {
+        for (int i = 0; i < counts[p]; i++) {
+            if (queues[p][(heads[p] + i) % QUEUE_DEPTH] == transaction) {
+                *index = i;
+                return p;
+            }
+        }
+    }
+    return -1;
+}
+
+void I2cScheduler::removeHead(int priority) {
+    heads[priority] = (uint8_t)((heads[priority] + 1) % QUEUE_DEPTH);
+    counts[priority]--;
+}
+
+#ifndef UNIT_TEST
+
+I2cScheduler& I2cScheduler::shared() {
+    static WireBus wire;
+    static I2cScheduler scheduler(wire);
+    return scheduler;
+}
+
+#endif // UNIT_TEST
@@ -0,0 +1,67 @@
+#include "MeasurementFrame.h"
+
+namespace {
+
+void writeLe16(uint8_t* bytes, uint16_t value) {
+    bytes[0] = (uint8_t)value;
+    bytes[1] = (uint8_t)(value >> 8);
+}
+
+uint16_t readLe16(const uint8_t* bytes) {
+    return (uint16_t)(bytes[0] | (bytes[1] << 8));
+}
+
+} // namespace
+
+int MeasurementFrameCodec::encode(const MeasurementFrame& frame, uint8_t* out) {
+    out[0] = SYNC_0;
+    out[1] = SYNC_1;
+    out[2] = TYPE_MEASUREMENT;
+    
+    uint8_t* payload = out + 3;
+    writeLe16(payload, (uint16_t)frame.timeMs);
+    writeLe16(payload + 2, (uint16_t)(frame.timeMs >> 16));
+    writeLe16(payload + 4, frame.raw);
+    writeLe16(payload + 6, frame.millivolts);
+    payload[8] = frame.cellCount;
+    payload[9] = frame.confidence;
+    writeLe16(payload + 10, frame.cellMillivolts);
+    payload[12] = frame.charge;
+    payload[13] = frame.flags;
+    writeLe16(payload + 14, (uint16_t)frame.trendDeciMvPerMin);
+    writeLe16(payload + 16, (uint16_t)frame.minutesToEmpty);
+    
+    out[FRAME_SIZE - 1] = crc8(out + 2, 1 + PAYLOAD_SIZE);
+    return FRAME_SIZE;
+}
+
+bool MeasurementFrameCodec::decode(const uint8_t* data, MeasurementFrame* frame) {
+    if (data[0] != SYNC_0 || data[1] != SYNC_1 || data[2] != TYPE_MEASUREMENT ||
+        data[FRAME_SIZE - 1] != crc8(data + 2, 1 + PAYLOAD_SIZE)) {
+        return false;
+    }
+    
+    const uint8_t* payload = data + 3;
+    frame->timeMs = readLe16(payload) | ((uint32_t)readLe16(payload + 2) << 16);
+    frame->raw = readLe16(payload + 4);
+    frame->millivolts = readLe16(payload + 6);
+    frame->cellCount = payload[8];
+    frame->confidence = payload[9];
+    frame->cellMillivolts = readLe16(payload + 10);
+    frame->charge = payload[12];
+    frame->flags = payload[13];
+    frame->trendDeciMvPerMin = (int16_t)readLe16(payload + 14);
+    frame->minutesToEmpty = (int16_t)readLe16(payload + 16);
+    return true;
+}
+
+uint8_t MeasurementFrameCodec::crc8(const uint8_t* data, int length) {
+    uint8_t crc = 0;
+    for (int i = 0; i < length; i++) {
+        crc ^= data[i];
+        for (int bit = 0; bit < 8; bit++) {
+            crc = (crc & 0x80) ? (uint8_t)((crc << 1) ^ 0x07) : (uint8_t)(crc << 1);
+        }
+    }
+    return crc;
+}
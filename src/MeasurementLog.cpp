@@ -0,0 +1,446 @@
+#include "MeasurementLog.h"
+#include <stdio.h>
+#include <string.h>
+#ifdef ARDUINO_PRO_MINI
+#include <avr/pgmspace.h>  // Dump line formats stay in flash instead of SRAM
+#define DUMP_FORMAT(text) PSTR(text)
+#define formatDumpLine snprintf_P
+#else
+#define DUMP_FORMAT(text) (text)
+#define formatDumpLine snprintf
+#endif
+
+namespace {
+
+const uint8_t MAGIC_0 = 'M';
+const uint8_t MAGIC_1 = 'L';
+const uint8_t FORMAT_VERSION = 1;
+
+// Record tags
+const uint8_t ERASED = 0xFF;
+const uint8_t SESSION_TAG = 0x80;
+const uint8_t MAX_DELTA_SECONDS = 127;
+const uint16_t MAX_CENTIVOLTS = 0xFFFE;  // 0xFFFF marks a torn record
+
+// Written bytes per dump line
+const uint32_t DUMP_BYTES_PER_LINE = 32;
+
+uint16_t readLe16(const uint8_t* bytes) {
+    return (uint16_t)(bytes[0] | ((uint16_t)bytes[1] << 8));
+}
+
+uint32_t readLe32(const uint8_t* bytes) {
+    return (uint32_t)bytes[0] | ((uint32_t)bytes[1] << 8) |
+           ((uint32_t)bytes[2] << 16) | ((uint32_t)bytes[3] << 24);
+}
+
+bool isSessionRecord(const uint8_t* record) {
+    return record[0] != ERASED && (record[0] & SESSION_TAG);
+}
+
+char hexDigit(uint8_t value) {
+    return value < 10 ? (char)('0' + value) : (char)('a' + value - 10);
+}
+
+} // namespace
+
+static_assert(LOG_BATCH_BYTES % 4 == 0, "LOG_BATCH_BYTES must be a multiple of the record size");
+
+MeasurementLog::MeasurementLog(FlashStorage& storage)
+    : storage(storage), mounted(false), pageSize(0), pageCount(0),
+      pageOpen(false), currentPage(0), currentSequence(0), writeOffset(0),
+      currentSession(0), batchSession(0), batchUsed(0), hasReading(false), lastReadingMs(0),
+      cacheAddress(0), cacheValid(false) {
+}
+
+bool MeasurementLog::begin() {
+    mounted = false;
+    cacheValid = false;
+    batchUsed = 0;
+    hasReading = false;
+
+    if (!storage.begin()) {
+        return false;
+    }
+
+    pageSize = storage.pageSize();
+    pageCount = storage.pageCount();
+    if (pageCount < 2 || pageSize < LOG_HEADER_SIZE + LOG_RECORD_SIZE || pageSize % LOG_RECORD_SIZE != 0) {
+        return false;
+    }
+
+    // Newest page = highest sequence (wrap-safe comparison)
+    bool found = false;
+    LogPageHeader newest = { 0, 0 };
+    for (uint32_t page = 0; page < pageCount; page++) {
+        LogPageHeader header;
+        if (readHeader(page, &header) && (!found || (int32_t)(header.sequence - newest.sequence) > 0)) {
+            newest = header;
+            currentPage = page;
+            found = true;
+        }
+    }
+
+    if (!found) {
+        // Blank storage: the first page opened will be page 0
+        pageOpen = false;
+        currentPage = pageCount - 1;
+        currentSequence = 0;
+        writeOffset = pageSize;
+        currentSession = 0;
+    } else {
+        pageOpen = true;
+        currentSequence = newest.sequence;
+        currentSession = newest.firstSession;
+
+        // Find the end of the newest page and the last session started in it
+        uint32_t offset = LOG_HEADER_SIZE;
+        while (offset < pageSize) {
+            const uint8_t* bytes = readRecord(currentPage, offset);
+            LogRecord record;
+            LogRecordType type = bytes ? decodeRecord(bytes, &record) : LOG_RECORD_ERASED;
+            if (type == LOG_RECORD_ERASED) {
+                break;
+            }
+            if (type == LOG_RECORD_SESSION) {
+                currentSession = record.session;
+            }
+            offset += LOG_RECORD_SIZE;
+        }
+        writeOffset = offset;
+    }
+
+    batchSession = currentSession;
+    mounted = true;
+    return true;
+}
+
+uint16_t MeasurementLog::startSession(uint8_t chemistry, uint8_t cellCount) {
+    currentSession++;
+    if (currentSession == 0) {
+        currentSession = 1;
+    }
+    hasReading = false;
+
+    uint8_t record[LOG_RECORD_SIZE] = {
+        (uint8_t)(SESSION_TAG | (chemistry & 0x0F)),
+        (uint8_t)(currentSession & 0xFF),
+        (uint8_t)(currentSession >> 8),
+        cellCount
+    };
+    appendRecord(record);
+
+    return currentSession;
+}
+
+void MeasurementLog::logReading(unsigned long timeMs, float voltage, int chargePercentage) {
+    if (currentSession == 0) {
+        return;
+    }
+
+    // Whole seconds since the previous reading; the remainder carries over
+    uint8_t deltaSeconds = 0;
+    if (!hasReading) {
+        lastReadingMs = timeMs;
+        hasReading = true;
+    } else {
+        unsigned long elapsed = timeMs - lastReadingMs;
+        unsigned long seconds = (elapsed + 500) / 1000;
+        if (seconds > MAX_DELTA_SECONDS) {
+            deltaSeconds = MAX_DELTA_SECONDS;
+            lastReadingMs = timeMs;
+        } else {
+            deltaSeconds = (uint8_t)seconds;
+            lastReadingMs += seconds * 1000;
+        }
+    }
+
+    float centivolts = voltage * 100.0f + 0.5f;
+    uint16_t value = centivolts <= 0.0f ? 0 : (centivolts >= MAX_CENTIVOLTS ? MAX_CENTIVOLTS : (uint16_t)centivolts);
+    if (chargePercentage < 0) chargePercentage = 0;
+    if (chargePercentage > 100) chargePercentage = 100;
+
+    uint8_t record[LOG_RECORD_SIZE] = {
+        deltaSeconds,
+        (uint8_t)(value & 0xFF),
+        (uint8_t)(value >> 8),
+        (uint8_t)chargePercentage
+    };
+    appendRecord(record);
+}
+
+void MeasurementLog::appendRecord(const uint8_t* record) {
+    if (!mounted) {
+        return;
+    }
+    if (batchUsed + (int)LOG_RECORD_SIZE > LOG_BATCH_BYTES) {
+        flush();
+    }
+    memcpy(batch + batchUsed, record, LOG_RECORD_SIZE);
+    batchUsed += LOG_RECORD_SIZE;
+}
+
+void MeasurementLog::flush() {
+    if (!mounted || batchUsed == 0) {
+        return;
+    }
+
+    uint16_t session = batchSession;
+    int i = 0;
+    while (i < batchUsed) {
+        // Page full (or none yet): rotate to the next, oldest page
+        if (!pageOpen || writeOffset + LOG_RECORD_SIZE > pageSize) {
+            uint16_t first = isSessionRecord(batch + i) ? readLe16(batch + i + 1) : session;
+            if (!openNextPage(first)) {
+                break;
+            }
+        }
+
+        uint32_t room = pageSize - writeOffset;
+        uint32_t chunk = (uint32_t)(batchUsed - i) < room ? (uint32_t)(batchUsed - i) : room;
+        if (!storage.write(currentPage * pageSize + writeOffset, batch + i, chunk)) {
+            break;
+        }
+
+        for (uint32_t k = 0; k < chunk; k += LOG_RECORD_SIZE) {
+            if (isSessionRecord(batch + i + k)) {
+                session = readLe16(batch + i + k + 1);
+            }
+        }
+        writeOffset += chunk;
+        i += chunk;
+    }
+
+    batchUsed = 0;
+    batchSession = currentSession;
+    cacheValid = false;
+}
+
+bool MeasurementLog::openNextPage(uint16_t firstSession) {
+    uint32_t page = (currentPage + 1) % pageCount;
+    if (!storage.erasePage(page)) {
+        return false;
+    }
+
+    uint32_t sequence = currentSequence + 1;
+    uint8_t header[LOG_HEADER_SIZE] = {
+        MAGIC_0, MAGIC_1, FORMAT_VERSION, 0,
+        (uint8_t)(sequence & 0xFF), (uint8_t)((sequence >> 8) & 0xFF),
+        (uint8_t)((sequence >> 16) & 0xFF), (uint8_t)(sequence >> 24),
+        (uint8_t)(firstSession & 0xFF), (uint8_t)(firstSession >> 8),
+        0xFF, 0xFF
+    };
+    if (!storage.write(page * pageSize, header, LOG_HEADER_SIZE)) {
+        return false;
+    }
+
+    currentPage = page;
+    currentSequence = sequence;
+    writeOffset = LOG_HEADER_SIZE;
+    pageOpen = true;
+    cacheValid = false;
+    return true;
+}
+
+bool MeasurementLog::readHeader(uint32_t page, LogPageHeader* header) {
+    uint8_t bytes[LOG_HEADER_SIZE];
+    return storage.read(page * pageSize, bytes, LOG_HEADER_SIZE) && decodePageHeader(bytes, header);
+}
+
+const uint8_t* MeasurementLog::readRecord(uint32_t page, uint32_t offset) {
+    uint32_t address = page * pageSize + offset;
+    uint32_t chunkStart = address - address % LOG_BATCH_BYTES;
+
+    if (!cacheValid || cacheAddress != chunkStart) {
+        uint32_t end = pageSize * pageCount;
+        uint32_t length = end - chunkStart < (uint32_t)LOG_BATCH_BYTES ? end - chunkStart : LOG_BATCH_BYTES;
+        if (!storage.read(chunkStart, cache, length)) {
+            cacheValid = false;
+            return nullptr;
+        }
+        cacheAddress = chunkStart;
+        cacheValid = true;
+    }
+
+    return cache + (address - chunkStart);
+}
+
+uint32_t MeasurementLog::pageForAge(uint32_t age) const {
+    return (currentPage + pageCount - age % pageCount) % pageCount;
+}
+
+int MeasurementLog::findSessions(LogSession* sessions, int maxSessions) {
+    if (!mounted || !pageOpen || maxSessions <= 0) {
+        return 0;
+    }
+
+    int found = 0;
+    uint32_t used = getUsedPages();
+    bool haveNewer = false;
+    uint16_t newerFirstSession = 0;
+
+    for (uint32_t age = 0; age < used && found < maxSessions; age++) {
+        uint32_t page = pageForAge(age);
+        uint32_t sequence = currentSequence - age;
+        // Header and first record in one read
+        uint8_t head[LOG_HEADER_SIZE + LOG_RECORD_SIZE];
+        LogPageHeader header;
+        if (!storage.read(page * pageSize, head, sizeof(head)) ||
+            !decodePageHeader(head, &header) || header.sequence != sequence) {
+            break;
+        }
+
+        // Headers alone show a page holds no session start when the newer
+        // page begins in the same session, unless this page opens with one
+        bool scan = !haveNewer || newerFirstSession != header.firstSession ||
+                    isSessionRecord(head + LOG_HEADER_SIZE);
+        haveNewer = true;
+        newerFirstSession = header.firstSession;
+        if (!scan) {
+            continue;
+        }
+
+        // Pass 1: count session records; pass 2: keep the newest ones
+        int starts = 0;
+        for (uint32_t offset = LOG_HEADER_SIZE; offset < pageSize; offset += LOG_RECORD_SIZE) {
+            const uint8_t* bytes = readRecord(page, offset);
+            if (!bytes || bytes[0] == ERASED) break;
+            if (isSessionRecord(bytes)) starts++;
+        }
+
+        int keep = starts < maxSessions - found ? starts : maxSessions - found;
+        int index = 0;
+        for (uint32_t offset = LOG_HEADER_SIZE; offset < pageSize && index < starts; offset += LOG_RECORD_SIZE) {
+            const uint8_t* bytes = readRecord(page, offset);
+            if (!bytes || bytes[0] == ERASED) break;
+            if (!isSessionRecord(bytes)) continue;
+
+            if (index >= starts - keep) {
+                LogRecord record;
+                decodeRecord(bytes, &record);
+                LogSession& session = sessions[found + (starts - 1 - index)];
+                session.id = record.session;
+                session.chemistry = record.chemistry;
+                session.cellCount = record.cellCount;
+                session.pageSequence = sequence;
+                session.offset = offset;
+            }
+            index++;
+        }
+        found += keep;
+    }
+
+    return found;
+}
+
+void MeasurementLog::startDump(LogDumpCursor* cursor) const {
+    cursor->page = 0;
+    cursor->offset = 0;
+    cursor->started = false;
+    cursor->done = false;
+}
+
+bool MeasurementLog::nextDumpLine(LogDumpCursor* cursor, char* line) {
+    if (cursor->done) {
+        return false;
+    }
+
+    uint32_t used = getUsedPages();
+    if (!cursor->started) {
+        formatDumpLine(line, LOG_DUMP_LINE_SIZE, DUMP_FORMAT("#LOG %u %lu %lu"), FORMAT_VERSION,
+                       (unsigned long)pageSize, (unsigned long)used);
+        cursor->started = true;
+        return true;
+    }
+
+    while (cursor->page < used) {
+        uint32_t age = used - 1 - cursor->page;
+        uint32_t page = pageForAge(age);
+        uint32_t sequence = currentSequence - age;
+
+        if (cursor->offset == 0) {
+            LogPageHeader header;
+            if (!readHeader(page, &header) || header.sequence != sequence) {
+                cursor->page++;
+                continue;
+            }
+        }
+
+        uint8_t bytes[DUMP_BYTES_PER_LINE];
+        uint32_t length = pageSize - cursor->offset < DUMP_BYTES_PER_LINE ? pageSize - cursor->offset : DUMP_BYTES_PER_LINE;
+        bool erased = true;
+        if (length > 0 && storage.read(page * pageSize + cursor->offset, bytes, length)) {
+            for (uint32_t i = 0; i < length; i++) {
+                if (bytes[i] != ERASED) {
+                    erased = false;
+                    break;
+                }
+            }
+        }
+
+        // Append-only: the rest of the page is erased as well
+        if (erased) {
+            cursor->page++;
+            cursor->offset = 0;
+            continue;
+        }
+
+        int n = formatDumpLine(line, LOG_DUMP_LINE_SIZE, DUMP_FORMAT("%lu %lu "), (unsigned long)sequence,
+                               (unsigned long)cursor->offset);
+        for (uint32_t i = 0; i < length; i++) {
+            line[n++] = hexDigit(bytes[i] >> 4);
+            line[n++] = hexDigit(bytes[i] & 0x0F);
+        }
+        line[n] = '\0';
+
+        cursor->offset += length;
+        return true;
+    }
+
+    formatDumpLine(line, LOG_DUMP_LINE_SIZE, DUMP_FORMAT("#END"));
+    cursor->done = true;
+    return true;
+}
+
+uint16_t MeasurementLog::getCurrentSession() const {
+    return currentSession;
+}
+
+uint32_t MeasurementLog::getUsedPages() const {
+    if (!pageOpen) {
+        return 0;
+    }
+    return currentSequence < pageCount ? currentSequence : pageCount;
+}
+
+bool MeasurementLog::decodePageHeader(const uint8_t* bytes, LogPageHeader* header) {
+    if (bytes[0] != MAGIC_0 || bytes[1] != MAGIC_1 || bytes[2] != FORMAT_VERSION) {
+        return false;
+    }
+    header->sequence = readLe32(bytes + 4);
+    header->firstSession = readLe16(bytes + 8);
+    return true;
+}
+
+LogRecordType MeasurementLog::decodeRecord(const uint8_t* bytes, LogRecord* record) {
+    memset(record, 0, sizeof(LogRecord));
+
+    if (bytes[0] == ERASED) {
+        record->type = LOG_RECORD_ERASED;
+    } else if (bytes[0] & SESSION_TAG) {
+        record->session = readLe16(bytes + 1);
+        record->chemistry = bytes[0] & 0x0F;
+        record->cellCount = bytes[3];
+        bool torn = (bytes[0] & 0x70) != 0 || record->session == 0xFFFF || bytes[3] == ERASED;
+        record->type = torn ? LOG_RECORD_INVALID : LOG_RECORD_SESSION;
+    } else {
+        uint16_t centivolts = readLe16(bytes + 1);
+        record->deltaSeconds = bytes[0];
+        record->voltage = centivolts / 100.0f;
+        record->chargePercentage = bytes[3];
+        bool torn = centivolts == 0xFFFF || bytes[3] == ERASED;
+        record->type = torn ? LOG_RECORD_INVALID : LOG_RECORD_READING;
+    }
+
+    return record->type;
+}
@@ -0,0 +1,170 @@
+#include "MeasurementTasks.h"
+#include "VoltageReader.h"
+#include "ChemistrySelector.h"
+#include "DebugLogger.h"
+
+MeasurementTasks::MeasurementTasks(SampleSource& source, Print& out)
+    : out(out),
+      debugLevel(DEBUG_VERBOSITY),
+      outputFormat(OUTPUT_FORMAT_TEXT),
+      sampler(source, watcher, queue),
+#if BALANCE_TAP_COUNT > 0
+      balanceReader(nullptr),
+#endif
+      expectedSequence(0),
+      lostBlocks(0),
+      latencyPending(false),
+      latestInfo(),
+      latestVoltage(0.0f),
+      latestRawAverage(0.0f),
+      displayPending(false) {
+    latestTrend.isValid = false;
+    latestTrend.millivoltsPerMinute = 0.0f;
+    latestTrend.minutesToEmpty = -1;
+}
+
+void MeasurementTasks::setOutput(int level, int format) {
+    debugLevel = level;
+    outputFormat = format;
+}
+
+#if BALANCE_TAP_COUNT > 0
+void MeasurementTasks::setBalanceReader(BalanceReader* reader) {
+    balanceReader = reader;
+}
+#endif
+
+bool MeasurementTasks::textEnabled(int level) const {
+    return debugLevel >= level && outputFormat == OUTPUT_FORMAT_TEXT;
+}
+
+float MeasurementTasks::toBatteryVoltage(int rawValue) const {
+    return VoltageReader::rawToBatteryVoltage(rawValue);
+}
+
+ConnectionEvent MeasurementTasks::sample(unsigned long nowMs) {
+    ConnectionEvent event = sampler.run(nowMs);
+    
+    if (event == CONNECTION_CONNECTED) {
+        latencyPending = true;
+    } else if (event == CONNECTION_DISCONNECTED) {
+        tracker.reset();
+        trend.reset();
+        history.reset();
+        latestInfo.isValid = false;
+        latestRawAverage = 0.0f;
+        displayPending = false;
+    }
+    if (event != CONNECTION_NONE && debugLevel >= DEBUG_LEVEL_DISPLAY) {
+        DebugLogger::printConnection(out, event == CONNECTION_CONNECTED);
+    }
+    return event;
+}
+
+bool MeasurementTasks::isAnalysisDue() const {
+    return sampler.blockCompleted() && latencyPending;
+}
+
+bool MeasurementTasks::analyze(unsigned long nowMs) {
+    if (!watcher.isConnected()) {
+        queue.clear();
+        return false;
+    }
+    
+    // Average of the blocks queued since the last analysis
+    unsigned long pluggedInMs = watcher.getChangeTime();
+    long sum = 0;
+    int blocks = 0;
+    int lost = 0;
+    SampleRecord record;
+    while (queue.pop(&record)) {
+        if ((long)(record.timeMs - pluggedInMs) < 0) {
+            continue;
+        }
+        if (blocks > 0 || !latencyPending) {
+            lost += (uint16_t)(record.sequence - expectedSequence);
+        }
+        expectedSequence = (uint16_t)(record.sequence + 1);
+        sum += record.raw;
+        blocks++;
+    }
+    if (blocks == 0) {
+        return false;
+    }
+    lostBlocks += lost;
+    
+    int rawADC = (int)(sum / blocks);
+    latestRawAverage = (float)sum / blocks;
+    if (textEnabled(DEBUG_LEVEL_RAW)) {
+        DebugLogger::printSampleBlocks(out, blocks, lost);
+        DebugLogger::printRawADC(out, rawADC, VoltageReader::rawToADCVoltage(rawADC));
+    }
+    
+    // Battery voltage (compensated for the voltage divider)
+    float batteryVoltage = toBatteryVoltage(rawADC);
+    
+    // Track the cell count over successive readings (resets on disconnect)
+    int cellCount = tracker.update(batteryVoltage);
+    
+    // Analyze battery with the selected chemistry and tracked cell count
+    BatteryInfo info = ChemistrySelector::analyzeWithCellCount(batteryVoltage, cellCount);
+    TrendInfo trendInfo = { false, 0.0f, -1 };
+    if (info.isValid) {
+        info.cellConfidence = tracker.getConfidence();
+
+#if BALANCE_TAP_COUNT > 0
+        // One interleaved round over the taps (a few ms, see BalanceReader.h)
+        if (balanceReader) {
+            float cellVoltages[BALANCE_MAX_CELLS];
+            balanceReader->readRound();
+            BalanceReader::applyCellVoltages(&info, cellVoltages,
+                                             balanceReader->getCellVoltages(info.cellCount, batteryVoltage, cellVoltages));
+        }
+#endif
+
+        history.append(batteryVoltage);
+        
+        // Discharge trend down to the chemistry's empty voltage
+        trend.update(nowMs, batteryVoltage);
+        float floorVoltage = ChemistrySelector::limits(ChemistrySelector::current()).emptyCellVoltage * info.cellCount;
+        trendInfo = trend.estimate(floorVoltage);
+    }
+    
+    if (textEnabled(DEBUG_LEVEL_CALCULATED)) {
+        DebugLogger::printCalculatedValues(out, batteryVoltage, info);
+        if (info.isValid) {
+            DebugLogger::printCellVoltages(out, info);
+            DebugLogger::printTrend(out, trendInfo);
+        }
+    }
+    if (debugLevel >= DEBUG_LEVEL_DISPLAY) {
+        DebugLogger::printMeasurement(out, outputFormat, nowMs, rawADC, batteryVoltage, info, trendInfo);
+    }
+    
+    latestInfo = info;
+    latestTrend = trendInfo;
+    latestVoltage = batteryVoltage;
+    displayPending = true;
+    return true;
+}
+
+bool MeasurementTasks::display(unsigned long nowMs) {
+    if (!displayPending) {
+        return false;
+    }
+    displayPending = false;
+    
+    // First display after plug-in: report latency from the actual plug-in
+    if (latencyPending) {
+        if (debugLevel >= DEBUG_LEVEL_CALCULATED) {
+            DebugLogger::printConnectLatency(out, nowMs - watcher.getChangeTime());
+        }
+        latencyPending = false;
+    }
+    
+    // Log what's shown on display
+    if (textEnabled(DEBUG_LEVEL_DISPLAY)) {
+        DebugLogger::printDisplayInfo(out, latestInfo);
+    }
+    return true;
+}
@@ -0,0 +1,188 @@
+#include "MemoryMonitor.h"
+
+#if MEMORY_MONITOR
+
+#if defined(__AVR__)
+extern char __heap_start;
+extern char* __brkval;
+#elif defined(ESP32)
+#include <Arduino.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#else
+#include <stdlib.h>
+#if defined(__GLIBC__) && (__GLIBC__ > 2 || (__GLIBC__ == 2 && __GLIBC_MINOR__ >= 33))
+#include <malloc.h>
+#define MEMORY_HOST_MALLINFO2
+#endif
+#endif
+
+namespace {
+
+const uint8_t PAINT = 0xA5;
+
+#if defined(__AVR__)
+
+uintptr_t heapTop() {
+    return (uintptr_t)(__brkval ? __brkval : &__heap_start);
+}
+
+#elif !defined(ESP32)
+
+/**
+ * @brief Map MEMORY_HOST_STACK_BYTES of stack below the caller
+ * @param bottom Receives the lowest address (a returned local address would be dangling)
+ */
+#if defined(__GNUC__)
+__attribute__((noinline))
+#endif
+void reserveHostStack(uintptr_t* bottom) {
+    volatile uint8_t area[MEMORY_HOST_STACK_BYTES];
+    for (size_t i = 0; i < sizeof(area); i += 64) {
+        area[i] = 0;
+    }
+    *bottom = (uintptr_t)&area[0];
+}
+
+#endif
+
+/**
+ * @brief First byte at or above from that is not the paint pattern, or to
+ */
+uintptr_t firstTouched(uintptr_t from, uintptr_t to) {
+    // Whole words while aligned, then bytes to find the exact one
+    const uintptr_t WORD = sizeof(uintptr_t);
+    uintptr_t pattern = 0;
+    for (size_t i = 0; i < sizeof(pattern); i++) {
+        pattern = (pattern << 8) | PAINT;
+    }
+    uintptr_t address = from;
+    while (address < to && (address % WORD) != 0 && *(volatile uint8_t*)address == PAINT) {
+        address++;
+    }
+    if (address < to && (address % WORD) == 0) {
+        while (address + WORD <= to && *(volatile uintptr_t*)address == pattern) {
+            address += WORD;
+        }
+    }
+    while (address < to && *(volatile uint8_t*)address == PAINT) {
+        address++;
+    }
+    return address;
+}
+
+void paint(uintptr_t from, uintptr_t to) {
+    for (volatile uint8_t* p = (volatile uint8_t*)from; (uintptr_t)p < to; p++) {
+        *p = PAINT;
+    }
+}
+
+} // namespace
+
+uintptr_t MemoryMonitor::top = 0;
+uintptr_t MemoryMonitor::bottom = 0;
+uintptr_t MemoryMonitor::lowest[MemoryMonitor::STAGE_COUNT];
+MemoryStats MemoryMonitor::stats[MemoryMonitor::STAGE_COUNT];
+
+void MemoryMonitor::begin() {
+    // A local marks the stack pointer (through a volatile: the optimizer may
+    // assume loops from a local's address never leave that local)
+    volatile uint8_t marker = 0;
+    volatile uintptr_t here = (uintptr_t)&marker;
+    top = here;
+#if defined(__AVR__)
+    bottom = heapTop() + MEMORY_STACK_GUARD_BYTES;
+#elif defined(ESP32)
+    bottom = (uintptr_t)pxTaskGetStackStart(nullptr) + MEMORY_STACK_GUARD_BYTES;
+#else
+    reserveHostStack(&bottom);
+#endif
+    for (int i = 0; i < STAGE_COUNT; i++) {
+        lowest[i] = 0;
+        stats[i].runs = 0;
+        stats[i].stackUsed = 0;
+        stats[i].stackFree = 0;
+        stats[i].heapUsed = 0;
+        stats[i].heapFree = 0;
+    }
+    paint(bottom, top - MEMORY_STACK_GUARD_BYTES);
+}
+
+void MemoryMonitor::leaveStage(int stage) {
+    if (bottom == 0 || stage < 0 || stage >= STAGE_COUNT) {
+        return;
+    }
+    // The repaint stays a guard below this frame
+    volatile uint8_t marker = 0;
+    volatile uintptr_t here = (uintptr_t)&marker;
+    uintptr_t limit = here - MEMORY_STACK_GUARD_BYTES;
+    uintptr_t floor = scanFloor();
+    
+    // Everything below the stage's record is still painted unless this run went deeper
+    uintptr_t record = lowest[stage] != 0 && lowest[stage] < limit ? lowest[stage] : limit;
+    uintptr_t touched = firstTouched(floor, record);
+    if (lowest[stage] == 0 || touched < lowest[stage]) {
+        lowest[stage] = touched;
+    }
+    paint(touched, limit);
+    
+    MemoryStats& s = stats[stage];
+    size_t used = heapUsed();
+    size_t available = heapFree();
+    if (s.runs == 0 || used > s.heapUsed) {
+        s.heapUsed = used;
+    }
+    if (s.runs == 0 || available < s.heapFree) {
+        s.heapFree = available;
+    }
+    s.runs++;
+    s.stackUsed = top > lowest[stage] ? (size_t)(top - lowest[stage]) : 0;
+    s.stackFree = lowest[stage] > floor ? (size_t)(lowest[stage] - floor) : 0;
+}
+
+const MemoryStats& MemoryMonitor::getStats(int stage) {
+    return stats[stage];
+}
+
+size_t MemoryMonitor::getPaintedBytes() {
+    return bottom != 0 ? (size_t)(top - MEMORY_STACK_GUARD_BYTES - bottom) : 0;
+}
+
+uintptr_t MemoryMonitor::scanFloor() {
+#if defined(__AVR__)
+    // The heap may have grown into the painted area since begin()
+    uintptr_t heap = heapTop();
+    return heap > bottom ? heap : bottom;
+#else
+    return bottom;
+#endif
+}
+
+size_t MemoryMonitor::heapUsed() {
+#if defined(__AVR__)
+    return (size_t)(heapTop() - (uintptr_t)&__heap_start);
+#elif defined(ESP32)
+    return ESP.getHeapSize() - ESP.getFreeHeap();
+#elif defined(MEMORY_HOST_MALLINFO2)
+    return mallinfo2().uordblks;
+#else
+    return 0;
+#endif
+}
+
+size_t MemoryMonitor::heapFree() {
+#if defined(__AVR__)
+    volatile uint8_t marker = 0;
+    uintptr_t here = (uintptr_t)&marker;
+    uintptr_t heap = heapTop();
+    return here > heap ? (size_t)(here - heap) : 0;
+#elif defined(ESP32)
+    return ESP.getFreeHeap();
+#elif defined(MEMORY_HOST_MALLINFO2)
+    return mallinfo2().fordblks;
+#else
+    return 0;
+#endif
+}
+
+#endif // MEMORY_MONITOR
@@ -0,0 +1,83 @@
+#include "SampleQueue.h"
+
+#ifdef __AVR__
+// Keeps the compiler from moving record accesses across an index access
+#define SAMPLE_QUEUE_BARRIER() __asm__ __volatile__("" ::: "memory")
+#endif
+
+SampleQueue::SampleQueue() : head(0), tail(0) {
+}
+
+bool SampleQueue::push(const SampleRecord& record) {
+    Index writeIndex = loadHead();
+    if ((Index)(writeIndex - loadTail()) == SAMPLE_QUEUE_DEPTH) {
+        return false;
+    }
+    
+    records[writeIndex % SAMPLE_QUEUE_DEPTH] = record;
+    storeHead((Index)(writeIndex + 1));
+    return true;
+}
+
+bool SampleQueue::pop(SampleRecord* record) {
+    Index readIndex = loadTail();
+    if (readIndex == loadHead()) {
+        return false;
+    }
+    
+    *record = records[readIndex % SAMPLE_QUEUE_DEPTH];
+    storeTail((Index)(readIndex + 1));
+    return true;
+}
+
+void SampleQueue::clear() {
+    storeTail(loadHead());
+}
+
+int SampleQueue::size() const {
+    return (Index)(loadHead() - loadTail());
+}
+
+#ifdef __AVR__
+
+SampleQueue::Index SampleQueue::loadHead() const {
+    Index value = head;
+    SAMPLE_QUEUE_BARRIER();
+    return value;
+}
+
+SampleQueue::Index SampleQueue::loadTail() const {
+    Index value = tail;
+    SAMPLE_QUEUE_BARRIER();
+    return value;
+}
+
+void SampleQueue::storeHead(Index value) {
+    SAMPLE_QUEUE_BARRIER();
+    head = value;
+}
+
+void SampleQueue::storeTail(Index value) {
+    SAMPLE_QUEUE_BARRIER();
+    tail = value;
+}
+
+#else
+
+SampleQueue::Index SampleQueue::loadHead() const {
+    return head.load(std::memory_order_acquire);
+}
+
+SampleQueue::Index SampleQueue::loadTail() const {
+    return tail.load(std::memory_order_acquire);
+}
+
+void SampleQueue::storeHead(Index value) {
+    head.store(value, std::memory_order_release);
+}
+
+void SampleQueue::storeTail(Index value) {
+    tail.store(value, std::memory_order_release);
+}
+
+#endif // __AVR__
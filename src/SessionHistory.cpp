@@ -0,0 +1,253 @@
+#include "SessionHistory.h"
+#ifdef ARDUINO_PRO_MINI
+#include <math.h>  // Arduino uses math.h instead of cmath
+#else
+#include <cmath>   // ESP32 uses cmath
+#endif
+
+namespace {
+
+// Escape byte introducing a 16-bit delta
+const uint8_t ESCAPE = 0x80;
+const int SHORT_DELTA_LIMIT = 127;
+const int LONG_DELTA_LIMIT = 32767;
+
+const float VOLTS_PER_STEP = HISTORY_RESOLUTION_MV / 1000.0f;
+
+int toSteps(float voltage) {
+    float steps = voltage / VOLTS_PER_STEP;
+    return (int)(steps >= 0.0f ? steps + 0.5f : steps - 0.5f);
+}
+
+int recordSize(int delta) {
+    return (delta >= -SHORT_DELTA_LIMIT && delta <= SHORT_DELTA_LIMIT) ? 1 : 3;
+}
+
+/**
+ * @brief Scale a value in [lowest, lowest + range] to a bar height (flat history: mid height)
+ */
+uint8_t scaleHeight(long steps, int lowest, long range, int maxHeight) {
+    if (range <= 0) {
+        return (uint8_t)(maxHeight / 2);
+    }
+    return (uint8_t)((steps - lowest) * maxHeight / range);
+}
+
+} // namespace
+
+SessionHistory::SessionHistory() {
+    reset();
+}
+
+void SessionHistory::reset() {
+    head = 0;
+    used = 0;
+    count = 0;
+    oldestSteps = 0;
+    newestSteps = 0;
+    
+    sessionCount = 0;
+    mean = 0.0f;
+    m2 = 0.0f;
+    minimum = 0.0f;
+    maximum = 0.0f;
+    
+    lastVoltage = 0.0f;
+    inSag = false;
+    sagReference = 0.0f;
+    sagCount = 0;
+    deepestSag = 0.0f;
+}
+
+void SessionHistory::append(float voltage) {
+    // Sag events: a sudden drop, over once the voltage recovers half of it
+    if (sessionCount > 0 && !inSag && lastVoltage - voltage >= (float)HISTORY_SAG_DROP_V) {
+        inSag = true;
+        sagReference = lastVoltage;
+        sagCount++;
+    }
+    if (inSag) {
+        float depth = sagReference - voltage;
+        if (depth > deepestSag) {
+            deepestSag = depth;
+        }
+        if (depth <= (float)HISTORY_SAG_DROP_V / 2) {
+            inSag = false;
+        }
+    }
+    lastVoltage = voltage;
+    
+    // Welford update of the session statistics
+    sessionCount++;
+    float delta = voltage - mean;
+    mean += delta / sessionCount;
+    m2 += delta * (voltage - mean);
+    if (sessionCount == 1 || voltage < minimum) minimum = voltage;
+    if (sessionCount == 1 || voltage > maximum) maximum = voltage;
+    
+    // Delta-encoded ring
+    int steps = toSteps(voltage);
+    if (count == 0) {
+        oldestSteps = steps;
+        newestSteps = steps;
+        count = 1;
+        return;
+    }
+    
+    int stepDelta = steps - newestSteps;
+    if (stepDelta > LONG_DELTA_LIMIT) stepDelta = LONG_DELTA_LIMIT;
+    if (stepDelta < -LONG_DELTA_LIMIT) stepDelta = -LONG_DELTA_LIMIT;
+    
+    pushRecord(stepDelta);
+    newestSteps += stepDelta;
+    count++;
+}
+
+void SessionHistory::pushRecord(int delta) {
+    int size = recordSize(delta);
+    
+    // Evict the oldest readings until the record fits
+    while (HISTORY_BUFFER_BYTES - used < size) {
+        popRecord();
+    }
+    
+    int tail = (head + used) % HISTORY_BUFFER_BYTES;
+    if (size == 1) {
+        buffer[tail] = (uint8_t)(int8_t)delta;
+    } else {
+        uint16_t value = (uint16_t)(int16_t)delta;
+        buffer[tail] = ESCAPE;
+        buffer[(tail + 1) % HISTORY_BUFFER_BYTES] = (uint8_t)(value & 0xFF);
+        buffer[(tail + 2) % HISTORY_BUFFER_BYTES] = (uint8_t)(value >> 8);
+    }
+    used += size;
+}
+
+int SessionHistory::popRecord() {
+    int offset = 0;
+    int delta = recordAt(&offset);
+    
+    head = (head + offset) % HISTORY_BUFFER_BYTES;
+    used -= offset;
+    oldestSteps += delta;
+    count--;
+    
+    return delta;
+}
+
+int SessionHistory::recordAt(int* offset) const {
+    int index = (head + *offset) % HISTORY_BUFFER_BYTES;
+    
+    if (buffer[index] != ESCAPE) {
+        *offset += 1;
+        return (int8_t)buffer[index];
+    }
+    
+    uint16_t value = buffer[(index + 1) % HISTORY_BUFFER_BYTES] |
+                     ((uint16_t)buffer[(index + 2) % HISTORY_BUFFER_BYTES] << 8);
+    *offset += 3;
+    return (int16_t)value;
+}
+
+int SessionHistory::getCount() const {
+    return count;
+}
+
+unsigned long SessionHistory::getSessionCount() const {
+    return sessionCount;
+}
+
+int SessionHistory::getBytesUsed() const {
+    return used;
+}
+
+float SessionHistory::getMinimum() const {
+    return minimum;
+}
+
+float SessionHistory::getMaximum() const {
+    return maximum;
+}
+
+float SessionHistory::getMean() const {
+    return mean;
+}
+
+float SessionHistory::getStdDev() const {
+    if (sessionCount < 2) {
+        return 0.0f;
+    }
+    return sqrtf(m2 / sessionCount);
+}
+
+int SessionHistory::getSagCount() const {
+    return sagCount;
+}
+
+float SessionHistory::getDeepestSag() const {
+    return deepestSag;
+}
+
+int SessionHistory::getReadings(float* voltages, int maxReadings) const {
+    int skip = count > maxReadings ? count - maxReadings : 0;
+    int offset = 0;
+    int steps = oldestSteps;
+    int written = 0;
+    
+    for (int i = 0; i < count; i++) {
+        if (i > 0) {
+            steps += recordAt(&offset);
+        }
+        if (i >= skip) {
+            voltages[written++] = steps * VOLTS_PER_STEP;
+        }
+    }
+    
+    return written;
+}
+
+int SessionHistory::sparkline(uint8_t* heights, int columns, int maxHeight) const {
+    if (count == 0 || columns <= 0) {
+        return 0;
+    }
+    if (columns > count) {
+        columns = count;
+    }
+    
+    // Pass 1: range of the buffered readings
+    int offset = 0;
+    int steps = oldestSteps;
+    int lowest = steps;
+    int highest = steps;
+    for (int i = 1; i < count; i++) {
+        steps += recordAt(&offset);
+        if (steps < lowest) lowest = steps;
+        if (steps > highest) highest = steps;
+    }
+    long range = highest - lowest;
+    
+    // Pass 2: average of the readings falling into each column
+    offset = 0;
+    steps = oldestSteps;
+    int column = 0;
+    long sum = 0;
+    int readings = 0;
+    for (int i = 0; i < count; i++) {
+        if (i > 0) {
+            steps += recordAt(&offset);
+        }
+        
+        int target = (int)((long)i * columns / count);
+        if (target != column) {
+            heights[column] = scaleHeight(sum / readings, lowest, range, maxHeight);
+            column = target;
+            sum = 0;
+            readings = 0;
+        }
+        sum += steps;
+        readings++;
+    }
+    heights[column] = scaleHeight(sum / readings, lowest, range, maxHeight);
+    
+    return columns;
+}
@@ -0,0 +1,152 @@
+#include "TaskScheduler.h"
+#include "MemoryMonitor.h"
+
+TaskScheduler::TaskScheduler(Clock clock) : clock(clock), taskCount(0) {
+}
+
+int TaskScheduler::addTask(const char* name, TaskFunction function, unsigned long periodUs, unsigned long deadlineUs) {
+    if (taskCount >= TASK_MAX_TASKS || function == nullptr || periodUs == 0) {
+        return -1;
+    }
+    
+    Task& task = tasks[taskCount];
+    task.name = name;
+    task.function = function;
+    task.periodUs = periodUs;
+    task.deadlineUs = deadlineUs;
+    task.releaseUs = (uint32_t)clock();
+    task.enabled = true;
+    clearStats(&task.stats);
+    return taskCount++;
+}
+
+void TaskScheduler::setEnabled(int id, bool enabled) {
+    if (id < 0 || id >= taskCount) {
+        return;
+    }
+    if (enabled && !tasks[id].enabled) {
+        tasks[id].releaseUs = (uint32_t)clock();
+    }
+    tasks[id].enabled = enabled;
+}
+
+void TaskScheduler::setPeriod(int id, unsigned long periodUs) {
+    if (id < 0 || id >= taskCount || periodUs == 0) {
+        return;
+    }
+    tasks[id].periodUs = periodUs;
+}
+
+void TaskScheduler::trigger(int id) {
+    if (id < 0 || id >= taskCount) {
+        return;
+    }
+    
+    // Already due: keep the earlier release so its lateness stays visible
+    uint32_t now = (uint32_t)clock();
+    if ((int32_t)(now - tasks[id].releaseUs) < 0) {
+        tasks[id].releaseUs = now;
+    }
+}
+
+bool TaskScheduler::runOnce() {
+    uint32_t start = (uint32_t)clock();
+    
+    // Earliest deadline first among the due tasks (lowest id on ties)
+    int next = -1;
+    int32_t nextSlack = 0;
+    for (int i = 0; i < taskCount; i++) {
+        const Task& task = tasks[i];
+        if (!task.enabled || (int32_t)(start - task.releaseUs) < 0) {
+            continue;
+        }
+        int32_t slack = (int32_t)(task.releaseUs + (uint32_t)task.deadlineUs - start);
+        if (next < 0 || slack < nextSlack) {
+            next = i;
+            nextSlack = slack;
+        }
+    }
+    if (next < 0) {
+        return false;
+    }
+    
+    Task& task = tasks[next];
+    task.function();
+    uint32_t end = (uint32_t)clock();
+#if MEMORY_MONITOR
+    MemoryMonitor::leaveStage(next);
+#endif
+
+    TaskStats& stats = task.stats;
+    uint32_t lateness = start - task.releaseUs;
+    uint32_t duration = end - start;
+    if (stats.runs == 0 || lateness < stats.minLatenessUs) {
+        stats.minLatenessUs = lateness;
+    }
+    if (lateness > stats.maxLatenessUs) {
+        stats.maxLatenessUs = lateness;
+    }
+    if (duration > stats.maxDurationUs) {
+        stats.maxDurationUs = duration;
+    }
+    stats.totalLatenessUs += lateness;
+    stats.runs++;
+    if ((uint32_t)(end - task.releaseUs) > task.deadlineUs) {
+        stats.overruns++;
+    }
+    
+    // Next release on the original grid; whole periods already past are dropped
+    task.releaseUs += (uint32_t)task.periodUs;
+    if ((int32_t)(end - task.releaseUs) >= (int32_t)task.periodUs) {
+        uint32_t missed = (end - task.releaseUs) / (uint32_t)task.periodUs;
+        task.releaseUs += missed * (uint32_t)task.periodUs;
+        stats.skipped += missed;
+    }
+    return true;
+}
+
+unsigned long TaskScheduler::timeUntilNext() const {
+    uint32_t now = (uint32_t)clock();
+    unsigned long wait = 0xFFFFFFFFUL;
+    for (int i = 0; i < taskCount; i++) {
+        if (!tasks[i].enabled) {
+            continue;
+        }
+        int32_t remaining = (int32_t)(tasks[i].releaseUs - now);
+        if (remaining <= 0) {
+            return 0;
+        }
+        if ((unsigned long)remaining < wait) {
+            wait = (unsigned long)remaining;
+        }
+    }
+    return wait;
+}
+
+int TaskScheduler::getTaskCount() const {
+    return taskCount;
+}
+
+const char* TaskScheduler::getName(int id) const {
+    return tasks[id].name;
+}
+
+const TaskStats& TaskScheduler::getStats(int id) const {
+    return tasks[id].stats;
+}
+
+void TaskScheduler::resetStats() {
+    for (int i = 0; i < taskCount; i++) {
+        clearStats(&tasks[i].stats);
+    }
+}
+
+void TaskScheduler::clearStats(TaskStats* stats) {
+    stats->runs = 0;
+    stats->overruns = 0;
+    stats->skipped = 0;
+    stats->minLatenessUs = 0;
+    stats->maxLatenessUs = 0;
+    stats->totalLatenessUs = 0;
+    stats->maxDurationUs = 0;
+}
@@ -0,0 +1,140 @@
+#include "TrendEstimator.h"
+
+namespace {
+
+const float MS_PER_MINUTE = 60000.0f;
+
+// Points needed for a meaningful slope
+const int MIN_POINTS = 3;
+
+} // namespace
+
+TrendEstimator::TrendEstimator(unsigned long bucketIntervalMs) : bucketMs(bucketIntervalMs) {
+    reset();
+}
+
+void TrendEstimator::reset() {
+    bucketStart = 0;
+    bucketOffsetSum = 0;
+    bucketMillivoltSum = 0;
+    bucketReadings = 0;
+    head = 0;
+    count = 0;
+    sumT = 0;
+    sumV = 0;
+    sumTT = 0;
+    sumTV = 0;
+}
+
+void TrendEstimator::update(unsigned long timeMs, float voltage) {
+    int32_t mv = (int32_t)(voltage * 1000.0f + (voltage >= 0.0f ? 0.5f : -0.5f));
+    
+    if (bucketReadings == 0) {
+        bucketStart = timeMs;
+    }
+    
+    unsigned long elapsed = timeMs - bucketStart;
+    bucketOffsetSum += elapsed;
+    bucketMillivoltSum += mv;
+    bucketReadings++;
+    
+    // Close the bucket as one point at its mean time and voltage
+    if (elapsed >= bucketMs) {
+        unsigned long meanTime = bucketStart + bucketOffsetSum / bucketReadings;
+        int32_t half = bucketReadings / 2;
+        int32_t meanMv = (bucketMillivoltSum >= 0 ? bucketMillivoltSum + half
+                                                  : bucketMillivoltSum - half) / bucketReadings;
+        addPoint(meanTime, meanMv);
+        
+        bucketOffsetSum = 0;
+        bucketMillivoltSum = 0;
+        bucketReadings = 0;
+    }
+}
+
+void TrendEstimator::addPoint(unsigned long timeMs, int32_t mv) {
+    if (count == TREND_WINDOW_SIZE) {
+        removeOldest();
+    }
+    
+    int index = (head + count) % TREND_WINDOW_SIZE;
+    times[index] = timeMs;
+    millivolts[index] = mv;
+    count++;
+    
+    int64_t t = (int64_t)(unsigned long)(timeMs - times[head]);
+    sumT += t;
+    sumV += mv;
+    sumTT += t * t;
+    sumTV += t * mv;
+}
+
+void TrendEstimator::removeOldest() {
+    // The oldest point sits at t = 0, so only sumV changes on removal
+    sumV -= millivolts[head];
+    unsigned long oldOrigin = times[head];
+    head = (head + 1) % TREND_WINDOW_SIZE;
+    count--;
+    
+    if (count == 0) {
+        sumT = 0;
+        sumTT = 0;
+        sumTV = 0;
+        return;
+    }
+    
+    // Move the time origin forward to the new oldest point
+    int64_t d = (int64_t)(unsigned long)(times[head] - oldOrigin);
+    int64_t n = count;
+    sumTT += n * d * d - 2 * d * sumT;
+    sumTV -= d * sumV;
+    sumT -= n * d;
+}
+
+TrendInfo TrendEstimator::estimate(float floorVoltage) const {
+    TrendInfo info;
+    info.isValid = false;
+    info.millivoltsPerMinute = 0.0f;
+    info.minutesToEmpty = -1;
+    
+    if (count < MIN_POINTS || getSpanMs() < TREND_MIN_SPAN_MS) {
+        return info;
+    }
+    
+    // Exact integer numerator and denominator; only the ratio is rounded
+    int64_t n = count;
+    int64_t numerator = n * sumTV - sumT * sumV;
+    int64_t denominator = n * sumTT - sumT * sumT;
+    if (denominator <= 0) {
+        return info;
+    }
+    
+    float slope = (float)numerator / (float)denominator;  // mV per ms
+    
+    info.isValid = true;
+    info.millivoltsPerMinute = slope * MS_PER_MINUTE;
+    
+    if (info.millivoltsPerMinute > -(float)TREND_MIN_DISCHARGE_MV_MIN) {
+        return info;
+    }
+    
+    // Fitted voltage at the newest point (less noisy than the last reading)
+    float newestT = (float)getSpanMs();
+    float fittedMv = ((float)sumV + slope * (newestT * (float)n - (float)sumT)) / (float)n;
+    float marginMv = fittedMv - floorVoltage * 1000.0f;
+    
+    info.minutesToEmpty = marginMv > 0.0f ? (long)(marginMv / -info.millivoltsPerMinute + 0.5f) : 0;
+    
+    return info;
+}
+
+int TrendEstimator::getCount() const {
+    return count;
+}
+
+unsigned long TrendEstimator::getSpanMs() const {
+    if (count == 0) {
+        return 0;
+    }
+    return times[(head + count - 1) % TREND_WINDOW_SIZE] - times[head];
+}
@@ -1,50 +1,145 @@
 #include "VoltageReader.h"
 
+#ifdef ADC_EXTERNAL_ADS1115
+#include "I2cScheduler.h"
+#include "Ads1115.h"
+
+// Immediate transfers on the shared scheduler, accounted with the display's
+static Ads1115 externalAdc(I2cScheduler::shared());
+
+namespace {
+
+/**
+ * @brief The ADS1115 as a SampleSource: one conversion per poll() once the chip has it
+ */
+class Ads1115Source : public SampleSource {
+public:
+    void startBatch() { externalAdc.startBatch(); }
+    bool poll() { return externalAdc.poll(micros()); }
+    int getBatchCount() const { return externalAdc.getBatchCount(); }
+    int getBatchAverage() const { return externalAdc.getBatchAverage(); }
+    int getLatest() const { return externalAdc.getLatest(); }
+};
+
+Ads1115Source sampleSource;
+
+} // namespace
+#elif defined(ADC_AVR_FREE_RUNNING)
+#include "FreeRunningAdc.h"
+
+// Converting continuously from the ADC interrupt after begin()
+static AvrAdcRegisters adcRegisters;
+static FreeRunningAdc freeRunningAdc(adcRegisters, ADC_PIN - A0, AVR_ADC_PRESCALER, AVR_ADC_OVERSAMPLE,
+                                     AVR_ADC_NOISE_SLEEP);
+#else
+
+namespace {
+
+/**
+ * @brief analogRead() as a SampleSource: one conversion per poll()
+ */
+class AnalogReadSource : public SampleSource {
+public:
+    AnalogReadSource() : batchSum(0), batchCount(0), latest(0) {}
+    
+    void startBatch() {
+        batchSum = 0;
+        batchCount = 0;
+    }
+    
+    bool poll() {
+        latest = analogRead(ADC_PIN);
+        batchSum += latest;
+        batchCount++;
+        return true;
+    }
+    
+    int getBatchCount() const { return batchCount; }
+    int getBatchAverage() const { return batchCount > 0 ? (int)(batchSum / batchCount) : 0; }
+    int getLatest() const { return latest; }
+
+private:
+    long batchSum;
+    int batchCount;
+    int latest;
+};
+
+AnalogReadSource sampleSource;
+
+} // namespace
+#endif
+
 float VoltageReader::voltageDividerRatio = 0.0;
+const CalibrationTable* VoltageReader::calibration = nullptr;
+
+bool VoltageReader::begin() {
+    // Calculate voltage divider ratio: (R1 + R2) / R2
+    voltageDividerRatio = (VOLTAGE_DIVIDER_R1 + VOLTAGE_DIVIDER_R2) / VOLTAGE_DIVIDER_R2;
 
-void VoltageReader::begin() {
+#ifdef ADC_EXTERNAL_ADS1115
+    // ADS1115 on the display's bus, converting continuously from now on
+    WireBus::begin();
+    return externalAdc.begin();
+#elif defined(ADC_AVR_FREE_RUNNING)
+    pinMode(ADC_PIN, INPUT);
+    freeRunningAdc.begin();
+    return true;
+#else
     // Configure ADC
     pinMode(ADC_PIN, INPUT);
-    
+
 #ifndef ARDUINO_PRO_MINI
     // ESP32 supports configurable ADC resolution
     analogReadResolution(ADC_RESOLUTION);
 #endif
     // Arduino Pro Mini uses fixed 10-bit ADC resolution
-    
-    // Calculate voltage divider ratio: (R1 + R2) / R2
-    voltageDividerRatio = (VOLTAGE_DIVIDER_R1 + VOLTAGE_DIVIDER_R2) / VOLTAGE_DIVIDER_R2;
+    return true;
+#endif
 }
 
-int VoltageReader::readRawADC(int samples) {
-    long sum = 0;
-    
-    for (int i = 0; i < samples; i++) {
-        sum += analogRead(ADC_PIN);
-        delay(10); // Small delay between samples
-    }
-    
-    return sum / samples;
+SampleSource& VoltageReader::getSampleSource() {
+#ifdef ADC_AVR_FREE_RUNNING
+    return freeRunningAdc;
+#else
+    return sampleSource;
+#endif
 }
 
-float VoltageReader::readADCVoltage() {
-    int rawValue = readRawADC();
-    
+float VoltageReader::getVoltageDividerRatio() {
+    return voltageDividerRatio;
+}
+
+void VoltageReader::setVoltageDividerRatio(float ratio) {
+    voltageDividerRatio = ratio;
+}
+
+void VoltageReader::setCalibration(const CalibrationTable* table) {
+    calibration = table;
+}
+
+float VoltageReader::rawToADCVoltage(int rawValue) {
     // Convert ADC value to voltage
-    float voltage = (rawValue * ADC_VREF) / ADC_MAX_VALUE;
-    
-    return voltage;
+    return (rawValue * VOLTAGE_ADC_VREF) / VOLTAGE_ADC_MAX_VALUE;
 }
 
-float VoltageReader::readBatteryVoltage() {
-    float adcVoltage = readADCVoltage();
+float VoltageReader::rawToBatteryVoltage(int rawValue) {
+    if (calibration) {
+        return calibration->toMillivolts(rawValue) * 0.001f;
+    }
     
     // Compensate for voltage divider
-    float batteryVoltage = adcVoltage * voltageDividerRatio;
-    
-    return batteryVoltage;
+    return rawToADCVoltage(rawValue) * voltageDividerRatio;
 }
 
-float VoltageReader::getVoltageDividerRatio() {
-    return voltageDividerRatio;
+int VoltageReader::batteryVoltageToRaw(float batteryVoltage) {
+    if (calibration) {
+        float millivolts = batteryVoltage * 1000.0f;
+        return calibration->toRaw(millivolts <= 0.0f ? 0 : millivolts >= 65535.0f ? 65535 : (uint16_t)(millivolts + 0.5f));
+    }
+    
+    float raw = batteryVoltage / voltageDividerRatio * VOLTAGE_ADC_MAX_VALUE / VOLTAGE_ADC_VREF;
+    
+    if (raw < 0) return 0;
+    if (raw > VOLTAGE_ADC_MAX_VALUE) return VOLTAGE_ADC_MAX_VALUE;
+    return (int)(raw + 0.5);
 }
@@ -2,60 +2,464 @@
 #include "config.h"
 #include "VoltageReader.h"
 #include "BatteryAnalyzer.h"
+#include "ChemistrySelector.h"
+#include "MeasurementTasks.h"
+#include "MeasurementLog.h"
+#include "BalanceReader.h"
 #include "DisplayManager.h"
+#include "I2cScheduler.h"
+#include "TaskScheduler.h"
+#include "CommandParser.h"
+#include "CalibrationTable.h"
 #include "DebugLogger.h"
+#include "MemoryMonitor.h"
+
+// Last sampled level of the chemistry button (HIGH = released)
+static int lastButtonState = HIGH;
+
+// Connection detection, sample blocks, cell count, trend and session
+// history of the connected pack, and the latest analysis (see MeasurementTasks)
+static MeasurementTasks measurement(VoltageReader::getSampleSource(), Serial);
+
+// Persistent log of every session (dumped with serial 'D')
+static PlatformFlash logFlash;
+static MeasurementLog measurementLog(logFlash);
+static bool logReady = false;
+static bool sessionLogged = false;
+
+#if BALANCE_TAP_COUNT > 0
+// Per-cell voltages from the balance-lead taps
+static PlatformAdcChannels balanceChannels;
+static BalanceReader balanceReader(balanceChannels);
+#endif
+
+// Sampling, analysis, display, logging, input and bus service (see loop())
+static TaskScheduler tasks(micros);
+static int analysisTaskId = -1;
+static int displayTaskId = -1;
+static int logTaskId = -1;
+
+// Serial input and the settings it can change at runtime (see runCommand())
+static CommandParser commandParser;
+static unsigned long measurementPeriodMs = MEASUREMENT_DELAY_MS;
+
+// Multi-point calibration: "$cal=<volts>" per reference, then "$cal=save"
+static CalibrationTable calibration;
+static CalibrationPoint calibrationPoints[CALIBRATION_MAX_POINTS];
+static int calibrationPointCount = 0;
+
+/**
+ * @brief Set the connection thresholds (raw counts) for the current voltage conversion
+ */
+static void configureConnectionThresholds() {
+    measurement.getWatcher().configure(VoltageReader::batteryVoltageToRaw(CONNECT_THRESHOLD_V),
+                                       VoltageReader::batteryVoltageToRaw(DISCONNECT_THRESHOLD_V));
+}
+
+/**
+ * @brief Add a calibration reference point, or fit and store / drop the table
+ * @return false if the command cannot be applied (nothing changed)
+ */
+static bool applyCalibration(const char* text) {
+    if (CommandParser::matchesName(text, "save")) {
+        if (!calibration.fit(calibrationPoints, calibrationPointCount)) {
+            return false;
+        }
+        if (!CalibrationStore::save(calibration)) {
+            Serial.println(F("WARN calibration not stored"));
+        }
+        calibrationPointCount = 0;
+        VoltageReader::setCalibration(&calibration);
+    } else if (CommandParser::matchesName(text, "clear")) {
+        calibration.clear();
+        CalibrationStore::erase();
+        calibrationPointCount = 0;
+        VoltageReader::setCalibration(nullptr);
+    } else {
+        // Reference voltage of the connected pack, paired with its latest reading
+        float voltage;
+        if (!CommandParser::parseNumber(text, &voltage) || voltage <= 0.0f ||
+            calibrationPointCount >= CALIBRATION_MAX_POINTS ||
+            !measurement.getWatcher().isConnected() || measurement.getRawAverage() <= 0.0f) {
+            return false;
+        }
+        calibrationPoints[calibrationPointCount].raw = measurement.getRawAverage();
+        calibrationPoints[calibrationPointCount].voltage = voltage;
+        calibrationPointCount++;
+        return true;
+    }
+    
+    configureConnectionThresholds();
+    return true;
+}
+
+/**
+ * @brief Print one setting as "name=value"
+ */
+static void printSetting(CommandSetting setting) {
+    Serial.print(CommandParser::settingName(setting));
+    Serial.print('=');
+    switch (setting) {
+        case SETTING_SAMPLES:
+            Serial.println(measurement.getSampler().getSamplesPerBlock());
+            break;
+        case SETTING_PERIOD:
+            Serial.println(measurementPeriodMs);
+            break;
+        case SETTING_VERBOSITY:
+            Serial.println(DebugLogger::getLevel());
+            break;
+        case SETTING_FORMAT:
+            Serial.println(DebugLogger::getFormat() == OUTPUT_FORMAT_CSV ? F("csv") :
+                           DebugLogger::getFormat() == OUTPUT_FORMAT_BINARY ? F("binary") : F("text"));
+            break;
+        case SETTING_CALIBRATION:
+            Serial.print(calibration.isValid() ? F("on ") : F("off "));
+            Serial.print(calibrationPointCount);
+            Serial.println(F(" points"));
+            break;
+        default:
+            Serial.println(VoltageReader::getVoltageDividerRatio(), 4);
+            break;
+    }
+}
+
+/**
+ * @brief Validate and apply a new setting value
+ * @return false if the value is malformed or out of range (nothing changed)
+ */
+static bool applySetting(CommandSetting setting, const char* text) {
+    if (setting == SETTING_FORMAT) {
+        if (CommandParser::matchesName(text, "text")) {
+            DebugLogger::setFormat(OUTPUT_FORMAT_TEXT);
+        } else if (CommandParser::matchesName(text, "csv")) {
+            DebugLogger::setFormat(OUTPUT_FORMAT_CSV);
+        } else if (CommandParser::matchesName(text, "binary")) {
+            DebugLogger::setFormat(OUTPUT_FORMAT_BINARY);
+        } else {
+            return false;
+        }
+        measurement.setOutput(DebugLogger::getLevel(), DebugLogger::getFormat());
+        return true;
+    }
+    if (setting == SETTING_CALIBRATION) {
+        return applyCalibration(text);
+    }
+    
+    float value;
+    if (!CommandParser::parseNumber(text, &value)) {
+        return false;
+    }
+    switch (setting) {
+        case SETTING_SAMPLES:
+            if (!CommandParser::isWholeInRange(value, 1, COMMAND_MAX_SAMPLES)) {
+                return false;
+            }
+            measurement.getSampler().setSamplesPerBlock((int)value);
+            break;
+        case SETTING_PERIOD:
+            if (!CommandParser::isWholeInRange(value, COMMAND_MIN_PERIOD_MS, COMMAND_MAX_PERIOD_MS)) {
+                return false;
+            }
+            measurementPeriodMs = (unsigned long)value;
+            tasks.setPeriod(analysisTaskId, measurementPeriodMs * 1000UL);
+            break;
+        case SETTING_VERBOSITY:
+            if (!CommandParser::isWholeInRange(value, DEBUG_LEVEL_NONE, DEBUG_LEVEL_RAW)) {
+                return false;
+            }
+            DebugLogger::setLevel((int)value);
+            measurement.setOutput(DebugLogger::getLevel(), DebugLogger::getFormat());
+            break;
+        default:
+            // Calibration: the connection thresholds are in raw counts
+            if (value < 1.0f || value > 100.0f) {
+                return false;
+            }
+            VoltageReader::setVoltageDividerRatio(value);
+            configureConnectionThresholds();
+            break;
+    }
+    
+    // More blocks per analysis than the queue holds are lost
+    if ((setting == SETTING_SAMPLES || setting == SETTING_PERIOD) &&
+        measurementPeriodMs > (unsigned long)measurement.getSampler().getSamplesPerBlock() * CONNECTION_POLL_MS * SAMPLE_QUEUE_DEPTH) {
+        Serial.println(F("WARN sample queue overflows between analyses"));
+    }
+    return true;
+}
+
+/**
+ * @brief Answer a completed "$..." line
+ */
+static void runCommand(const Command& command) {
+    switch (command.type) {
+        case COMMAND_GET:
+            printSetting(command.setting);
+            break;
+        case COMMAND_SET:
+            if (applySetting(command.setting, command.value)) {
+                printSetting(command.setting);
+            } else {
+                Serial.print(F("ERR bad value for "));
+                Serial.println(CommandParser::settingName(command.setting));
+            }
+            break;
+        case COMMAND_LIST:
+            for (int i = 0; i < SETTING_COUNT; i++) {
+                printSetting((CommandSetting)i);
+            }
+            break;
+        case COMMAND_STATS:
+            Serial.print(F("lost_blocks="));
+            Serial.println(measurement.getLostBlocks());
+            DebugLogger::logTaskStats(tasks);
+            DebugLogger::logBusStats(I2cScheduler::shared());
+#if MEMORY_MONITOR
+            DebugLogger::logMemoryStats(tasks);
+#endif
+            break;
+        case COMMAND_HELP:
+            Serial.println(F("Keys: L H I F chemistry, S session, B bus, T tasks, D log dump"));
+            Serial.println(F("$ list, $name get, $name=value set, $stats, $help"));
+            Serial.println(F("Settings: samples period verbosity format(text|csv|binary) ratio"));
+            Serial.println(F("$cal=<volts> per reference voltage, then $cal=save; $cal=clear"));
+            break;
+        default:
+            if (command.error == COMMAND_ERROR_TOO_LONG) {
+                Serial.println(F("ERR line too long"));
+            } else if (command.error == COMMAND_ERROR_UNKNOWN) {
+                Serial.println(F("ERR unknown setting"));
+            } else {
+                Serial.println(F("ERR syntax"));
+            }
+            break;
+    }
+}
+
+/**
+ * @brief Handle the button and serial commands
+ *
+ * Button press cycles LiPo -> LiHV -> Li-ion -> LiFePO4. Serial characters
+ * L, H, I and F select a chemistry directly; S shows the session history,
+ * B and T log bus and task timing, M the stack and heap headroom (with
+ * MEMORY_MONITOR), and D dumps the measurement log (decode
+ * with the simulator's log_decoder). Lines starting with '$' read and change
+ * settings at runtime (see CommandParser.h and runCommand()).
+ */
+static void handleUserInput() {
+    bool changed = false;
+    
+    int buttonState = digitalRead(CHEMISTRY_BUTTON_PIN);
+    if (buttonState == LOW && lastButtonState == HIGH) {
+        ChemistrySelector::next();
+        changed = true;
+    }
+    lastButtonState = buttonState;
+    
+    while (Serial.available() > 0) {
+        Command parsed;
+        if (!commandParser.feed((char)Serial.read(), &parsed)) {
+            continue;
+        }
+        if (parsed.type != COMMAND_KEY) {
+            runCommand(parsed);
+            continue;
+        }
+        
+        char command = parsed.key;
+        ChemistryType type;
+        if (ChemistrySelector::fromCommand(command, &type)) {
+            ChemistrySelector::select(type);
+            changed = true;
+        } else if (command == 'S' || command == 's') {
+            DebugLogger::logSessionStats(measurement.getHistory());
+            DisplayManager::displayHistory(measurement.getHistory());
+        } else if (command == 'B' || command == 'b') {
+            DebugLogger::logBusStats(I2cScheduler::shared());
+        } else if (command == 'T' || command == 't') {
+            DebugLogger::logTaskStats(tasks);
+            tasks.resetStats();
+#if MEMORY_MONITOR
+        } else if (command == 'M' || command == 'm') {
+            DebugLogger::logMemoryStats(tasks);
+#endif
+        } else if ((command == 'D' || command == 'd') && logReady) {
+            measurementLog.flush();
+            LogDumpCursor cursor;
+            char line[MeasurementLog::LOG_DUMP_LINE_SIZE];
+            measurementLog.startDump(&cursor);
+            while (measurementLog.nextDumpLine(&cursor, line)) {
+                Serial.println(line);
+            }
+        }
+    }
+    
+    if (changed) {
+        measurement.getTracker().configure(ChemistrySelector::limits(ChemistrySelector::current()));
+        
+        const char* name = ChemistrySelector::name(ChemistrySelector::current());
+        DebugLogger::logChemistry(name);
+        DisplayManager::displayChemistry(name);
+    }
+}
+
+/**
+ * @brief Sampling task: poll the ADC backend for connection detection and averaging
+ *
+ * Runs every CONNECTION_POLL_MS. While a pack is connected, everything the
+ * backend converted over "$samples" runs (default SAMPLE_RECORD_SAMPLES) is
+ * averaged into a SampleRecord for the analysis (see BlockSampler); the
+ * first block of a new pack releases the analysis at once.
+ * A removal clears the display right away instead of showing stale data.
+ * Only this task writes to the sample queue, so it could run from a timer
+ * interrupt as well.
+ */
+static void sampleTask() {
+    if (measurement.sample(millis()) == CONNECTION_DISCONNECTED) {
+        if (sessionLogged) {
+            measurementLog.flush();
+            sessionLogged = false;
+        }
+        DisplayManager::displayNoBattery();
+    }
+    
+    if (measurement.isAnalysisDue()) {
+        tasks.trigger(analysisTaskId);
+    }
+}
+
+/**
+ * @brief Analysis task: drain the sample queue and analyze the connected pack
+ *
+ * Runs every measurementPeriodMs ("$period") and hands the result to the display and
+ * log tasks.
+ */
+static void analysisTask() {
+    if (!measurement.analyze(millis())) {
+        return;
+    }
+    tasks.trigger(displayTaskId);
+    
+    // Open the log session as soon as the cell count is settled
+    if (logReady && measurement.getInfo().isValid && measurement.getTracker().isLocked() && !sessionLogged) {
+        tasks.trigger(logTaskId);
+    }
+}
+
+/**
+ * @brief Display task: draw the latest analysis once
+ */
+static void displayTask() {
+    if (measurement.display(millis())) {
+        DisplayManager::displayBatteryInfo(measurement.getInfo(), measurement.getTrend());
+    }
+}
+
+/**
+ * @brief Log task: record the latest reading every LOG_INTERVAL_MS
+ *
+ * The session record is written on the first run after the cell count locks.
+ */
+static void logTask() {
+    const BatteryInfo& info = measurement.getInfo();
+    if (!logReady || !measurement.getWatcher().isConnected() || !info.isValid || !measurement.getTracker().isLocked()) {
+        return;
+    }
+    
+    if (!sessionLogged) {
+        measurementLog.startSession((uint8_t)ChemistrySelector::current(), (uint8_t)info.cellCount);
+        sessionLogged = true;
+    }
+    measurementLog.logReading(millis(), measurement.getVoltage(), info.chargePercentage);
+}
+
+/**
+ * @brief Bus task: send queued I2C chunks for at most I2C_SLICE_US
+ */
+static void serviceI2cBus() {
+    I2cScheduler& bus = I2cScheduler::shared();
+    unsigned long start = micros();
+    while (micros() - start < I2C_SLICE_US && bus.poll(micros())) {
+    }
+}
 
 void setup() {
+#if MEMORY_MONITOR
+    // Before anything else uses the stack below setup()
+    MemoryMonitor::begin();
+#endif
+
     // Initialize debug logger first
     DebugLogger::begin(DEBUG_VERBOSITY);
     delay(100);
-    DebugLogger::log("Starting LiPo Battery Tester...");
-    DebugLogger::log("ESP32-C3 LiPo Battery Tester v1.0");
-    DebugLogger::log("========================================");
+    DebugLogger::log(F("Starting LiPo Battery Tester..."));
+    DebugLogger::log(F("ESP32-C3 LiPo Battery Tester v1.0"));
+    DebugLogger::log(F("========================================"));
     
     // Initialize voltage reader
-    VoltageReader::begin();
-    DebugLogger::log("Voltage reader initialized");
+    if (!VoltageReader::begin()) {
+        DebugLogger::log(F("WARNING: External ADC not responding!"));
+    }
+    if (CalibrationStore::load(&calibration)) {
+        VoltageReader::setCalibration(&calibration);
+        DebugLogger::log(F("Calibration table loaded"));
+    }
+    configureConnectionThresholds();
+    DebugLogger::log(F("Voltage reader initialized"));
+#if BALANCE_TAP_COUNT > 0
+    balanceReader.begin();
+    measurement.setBalanceReader(&balanceReader);
+    DebugLogger::log(F("Balance leads initialized"));
+#endif
+
+    // Chemistry select button (active low)
+    pinMode(CHEMISTRY_BUTTON_PIN, INPUT_PULLUP);
+    DebugLogger::logChemistry(ChemistrySelector::name(ChemistrySelector::current()));
+    measurement.getTracker().configure(ChemistrySelector::limits(ChemistrySelector::current()));
+    
+    // Mount the measurement log (non-fatal: measuring works without it)
+    logReady = measurementLog.begin();
+    if (logReady) {
+        DebugLogger::log(F("Measurement log mounted"));
+    } else {
+        DebugLogger::log(F("WARNING: Measurement log unavailable"));
+    }
     
     // Initialize display (non-blocking)
-    DebugLogger::log("Attempting to initialize display...");
+    DebugLogger::log(F("Attempting to initialize display..."));
     if (!DisplayManager::begin()) {
-        DebugLogger::log("WARNING: Display initialization failed!");
-        DebugLogger::log("Continuing without display (debug mode only)");
+        DebugLogger::log(F("WARNING: Display initialization failed!"));
+        DebugLogger::log(F("Continuing without display (debug mode only)"));
         // Don't halt - continue for debugging
     } else {
-        DebugLogger::log("Display initialized successfully");
+        DebugLogger::log(F("Display initialized successfully"));
         // Show initialization message
         DisplayManager::displayInitMessage();
+        I2cScheduler::shared().drain(micros());
         delay(2000);
     }
     
-    DebugLogger::log("System ready!\n");
+    // Shown until the connection watcher sees a pack
+    DisplayManager::displayNoBattery();
+    
+    // Every stage runs at its own rate; deadlines are reported as overruns ('T')
+    tasks.addTask("sample", sampleTask, CONNECTION_POLL_MS * 1000UL, CONNECTION_POLL_MS * 1000UL);
+    analysisTaskId = tasks.addTask("analysis", analysisTask, MEASUREMENT_DELAY_MS * 1000UL, ANALYSIS_DEADLINE_MS * 1000UL);
+    displayTaskId = tasks.addTask("display", displayTask, DISPLAY_REFRESH_MS * 1000UL, DISPLAY_REFRESH_MS * 1000UL);
+    logTaskId = tasks.addTask("log", logTask, LOG_INTERVAL_MS * 1000UL, LOG_DEADLINE_MS * 1000UL);
+    tasks.addTask("input", handleUserInput, INPUT_POLL_MS * 1000UL, INPUT_POLL_MS * 1000UL);
+    tasks.addTask("i2c", serviceI2cBus, CONNECTION_POLL_MS * 1000UL, CONNECTION_POLL_MS * 1000UL);
+
+#if MEMORY_MONITOR
+    MemoryMonitor::leaveStage(MemoryMonitor::SETUP_STAGE);
+#endif
+    DebugLogger::log(F("System ready!\n"));
 }
 
 void loop() {
-    // Read raw ADC value for debugging
-    int rawADC = VoltageReader::readRawADC();
-    float adcVoltage = VoltageReader::readADCVoltage();
-    
-    // Log raw values if debug level is high enough
-    DebugLogger::logRawADC(rawADC, adcVoltage);
-    
-    // Read battery voltage
-    float batteryVoltage = VoltageReader::readBatteryVoltage();
-    
-    // Analyze battery
-    BatteryInfo info = BatteryAnalyzer::analyzeBattery(batteryVoltage);
-    
-    // Log calculated values
-    DebugLogger::logCalculatedValues(batteryVoltage, info);
-    
-    // Display battery information on OLED
-    DisplayManager::displayBatteryInfo(info);
-    
-    // Log what's shown on display
-    DebugLogger::logDisplayInfo(info);
-    
-    // Wait before next measurement
-    delay(MEASUREMENT_DELAY_MS);
+    // Most urgent due task; sleep briefly while nothing is due for a while
+    if (!tasks.runOnce() && tasks.timeUntilNext() >= 1000UL) {
+        delay(1);
+    }
 }
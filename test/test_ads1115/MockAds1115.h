@@ -0,0 +1,139 @@
+#ifndef MOCK_ADS1115_H
+#define MOCK_ADS1115_H
+
+#include <math.h>
+#include "../../include/I2cBus.h"
+
+/**
+ * @brief Simulated ADS1115 on a simulated I2C bus
+ *
+ * Models the pointer, config and conversion registers, continuous and
+ * single-shot conversions at the configured data rate (optionally with an
+ * oscillator error), and bus time: each transaction occupies the bus for
+ * its bits at clockHz and advances nowUs by that time. The test advances
+ * nowUs for time spent outside the bus.
+ */
+class MockAds1115 : public I2cBus {
+public:
+    explicit MockAds1115(uint8_t address = 0x48, unsigned long clockHz = 400000)
+        : address(address), clockHz(clockHz), present(true), nowUs(0.0),
+          inputVolts(0.0f), rampVoltsPerSecond(0.0f), rateErrorPercent(0.0),
+          config(0x8583), pointer(0), conversionStartUs(0.0), singleShotDoneUs(-1.0),
+          writes(0), reads(0), bytes(0), busMicros(0.0),
+          lastConversion(-1), duplicateReads(0), skippedConversions(0) {}
+    
+    bool write(uint8_t device, const uint8_t* data, uint8_t length) {
+        transaction(length);
+        writes++;
+        if (device != address || !present || length == 0) return false;
+        
+        pointer = data[0] & 0x03;
+        if (length == 3 && pointer == 1) {
+            config = (uint16_t)((data[1] << 8) | data[2]);
+            if (continuous()) {
+                conversionStartUs = nowUs;
+            } else if (config & 0x8000) {
+                singleShotDoneUs = nowUs + periodUs();
+            }
+            lastConversion = -1;
+        }
+        return true;
+    }
+    
+    bool read(uint8_t device, uint8_t* data, uint8_t length) {
+        transaction(length);
+        reads++;
+        if (device != address || !present) return false;
+        
+        uint16_t value;
+        if (pointer == 1) {
+            // OS bit reads 1 when no single-shot conversion is running
+            bool busy = singleShotDoneUs >= 0.0 && nowUs < singleShotDoneUs;
+            value = (uint16_t)((config & 0x7FFF) | (busy ? 0 : 0x8000));
+        } else {
+            value = (uint16_t)conversionCode();
+        }
+        if (length > 0) data[0] = (uint8_t)(value >> 8);
+        if (length > 1) data[1] = (uint8_t)(value & 0xFF);
+        return true;
+    }
+    
+    /**
+     * @brief Configured data rate in conversions per second
+     */
+    int dataRate() const {
+        static const int RATES[] = { 8, 16, 32, 64, 128, 250, 475, 860 };
+        return RATES[(config >> 5) & 0x07];
+    }
+    
+    /**
+     * @brief Configured full-scale range in volts
+     */
+    float fullScale() const {
+        static const float RANGES[] = { 6.144f, 4.096f, 2.048f, 1.024f, 0.512f, 0.256f, 0.256f, 0.256f };
+        return RANGES[(config >> 9) & 0x07];
+    }
+    
+    bool continuous() const { return (config & 0x0100) == 0; }
+    
+    /**
+     * @brief Share of the elapsed time the bus was busy
+     */
+    double busUtilization() const { return nowUs > 0.0 ? busMicros / nowUs : 0.0; }
+    
+    uint8_t address;
+    unsigned long clockHz;
+    bool present;                // false: the device does not acknowledge
+    double nowUs;                // Simulated time
+    float inputVolts;            // Input at time 0
+    float rampVoltsPerSecond;    // Input change over time
+    double rateErrorPercent;     // Oscillator error (+ = faster conversions)
+    uint16_t config;
+    uint8_t pointer;
+    double conversionStartUs;
+    double singleShotDoneUs;
+    
+    long writes;
+    long reads;
+    long bytes;                  // Data bytes on the bus (excluding address)
+    double busMicros;            // Time the bus was busy
+    long lastConversion;         // Index of the conversion last read
+    long duplicateReads;         // Reads returning the conversion read before
+    long skippedConversions;     // Conversions never read
+
+private:
+    double periodUs() const {
+        return 1e6 / (dataRate() * (1.0 + rateErrorPercent / 100.0));
+    }
+    
+    void transaction(uint8_t length) {
+        // Start, address + ack, length data bytes + ack each, stop
+        double bits = 1 + 9 * (1 + length) + 1;
+        double micros = bits * 1e6 / clockHz;
+        busMicros += micros;
+        bytes += length;
+        nowUs += micros;
+    }
+    
+    int conversionCode() {
+        double completeUs;
+        if (continuous()) {
+            long index = (long)floor((nowUs - conversionStartUs) / periodUs()) - 1;
+            if (index < 0) return 0;  // First conversion not finished yet
+            if (index == lastConversion) duplicateReads++;
+            if (lastConversion >= 0 && index > lastConversion + 1) skippedConversions += index - lastConversion - 1;
+            lastConversion = index;
+            completeUs = conversionStartUs + (index + 1) * periodUs();
+        } else {
+            completeUs = singleShotDoneUs;
+        }
+        
+        double volts = inputVolts + rampVoltsPerSecond * completeUs / 1e6;
+        double code = floor(volts / fullScale() * 32768.0 + 0.5);
+        if (code > 32767) code = 32767;
+        if (code < -32768) code = -32768;
+        return (int)code;
+    }
+};
+
+#endif // MOCK_ADS1115_H
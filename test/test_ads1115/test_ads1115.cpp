@@ -0,0 +1,184 @@
+#include <unity.h>
+#include <stdio.h>
+
+// Define UNIT_TEST before including anything
+#define UNIT_TEST
+
+// Include config first to ensure constants are defined
+#include "../../include/config.h"
+
+#include "../../include/Ads1115.h"
+#include "../../src/Ads1115.cpp"
+#include "MockAds1115.h"
+
+// Time the main loop spends between polls (us)
+const double POLL_INTERVAL_US = 50.0;
+
+/**
+ * @brief Poll until a batch of samples is read or the time limit passes
+ */
+static void readBatch(Ads1115& adc, MockAds1115& bus, int samples, double limitUs) {
+    double end = bus.nowUs + limitUs;
+    adc.startBatch();
+    while (adc.getBatchCount() < samples && bus.nowUs < end) {
+        adc.poll((unsigned long)bus.nowUs);
+        bus.nowUs += POLL_INTERVAL_US;
+    }
+}
+
+void setUp(void) {
+}
+
+void tearDown(void) {
+}
+
+void test_config_value_fields(void) {
+    // AIN0, +-4.096V, 250 SPS, continuous, comparator disabled
+    TEST_ASSERT_EQUAL_HEX16(0x42A3, Ads1115::configValue(0, 4.096f, 250));
+    // AIN2, +-2.048V, 860 SPS
+    TEST_ASSERT_EQUAL_HEX16(0x64E3, Ads1115::configValue(2, 2.048f, 860));
+    
+    TEST_ASSERT_EQUAL(250, Ads1115::supportedDataRate(300));
+    TEST_ASSERT_EQUAL(8, Ads1115::supportedDataRate(5));
+    TEST_ASSERT_EQUAL(860, Ads1115::supportedDataRate(2000));
+}
+
+void test_begin_configures_continuous_mode(void) {
+    MockAds1115 bus;
+    Ads1115 adc(bus);
+    
+    TEST_ASSERT_TRUE(adc.begin());
+    TEST_ASSERT_EQUAL(2, bus.writes);
+    TEST_ASSERT_EQUAL(0, bus.reads);
+    TEST_ASSERT_TRUE(bus.continuous());
+    TEST_ASSERT_EQUAL(ADS1115_DATA_RATE, bus.dataRate());
+    TEST_ASSERT_EQUAL_FLOAT(ADS1115_FULL_SCALE_V, bus.fullScale());
+    TEST_ASSERT_EQUAL(0, bus.pointer);   // Left on the conversion register
+}
+
+void test_missing_device(void) {
+    MockAds1115 bus;
+    bus.present = false;
+    Ads1115 adc(bus);
+    
+    TEST_ASSERT_FALSE(adc.begin());
+    
+    int16_t value;
+    TEST_ASSERT_FALSE(adc.readConversion(&value));
+    adc.startBatch();
+    TEST_ASSERT_FALSE(adc.poll(0));
+    TEST_ASSERT_EQUAL(0, adc.getBatchCount());
+    TEST_ASSERT_EQUAL(0, adc.getBatchAverage());
+    TEST_ASSERT_EQUAL(2, adc.getErrorCount());
+}
+
+void test_one_transaction_per_sample(void) {
+    MockAds1115 bus;
+    bus.inputVolts = 1.5f;
+    Ads1115 adc(bus);
+    adc.begin();
+    bus.nowUs += 10000;
+    
+    long writes = bus.writes;
+    readBatch(adc, bus, 100, 1e6);
+    
+    TEST_ASSERT_EQUAL(100, adc.getBatchCount());
+    TEST_ASSERT_EQUAL(writes, bus.writes);   // No pointer writes while sampling
+    TEST_ASSERT_EQUAL(100, bus.reads);
+    TEST_ASSERT_EQUAL(200, bus.bytes - 4);   // 2 bytes per sample after the 4 setup bytes
+    TEST_ASSERT_EQUAL(0, bus.duplicateReads);
+    TEST_ASSERT_INT_WITHIN(1, 12000, adc.getBatchAverage());   // 1.5V of 4.096V
+}
+
+void test_distinct_conversions_with_oscillator_error(void) {
+    const double ERRORS[] = { -8.0, 0.0, 8.0 };
+    
+    for (int i = 0; i < 3; i++) {
+        MockAds1115 bus;
+        bus.rateErrorPercent = ERRORS[i];
+        bus.rampVoltsPerSecond = 0.5f;
+        Ads1115 adc(bus);
+        adc.begin();
+        
+        readBatch(adc, bus, 50, 1e6);
+        TEST_ASSERT_EQUAL(50, adc.getBatchCount());
+        TEST_ASSERT_EQUAL(0, bus.duplicateReads);
+        
+        // At most the rate margin is lost to waiting
+        double rate = 50 / (bus.nowUs / 1e6);
+        TEST_ASSERT_GREATER_THAN(bus.dataRate() * 0.85, rate);
+    }
+}
+
+void test_negative_readings_clamp_to_zero(void) {
+    MockAds1115 bus;
+    bus.inputVolts = -0.05f;   // Offset below ground with no pack connected
+    Ads1115 adc(bus);
+    adc.begin();
+    bus.nowUs += 10000;
+    
+    int16_t value;
+    TEST_ASSERT_TRUE(adc.readConversion(&value));
+    TEST_ASSERT_LESS_THAN(0, value);
+    
+    readBatch(adc, bus, 4, 1e5);
+    TEST_ASSERT_EQUAL(0, adc.getBatchAverage());
+    
+    // Full scale saturates at the top code
+    bus.inputVolts = 5.0f;
+    readBatch(adc, bus, 4, 1e5);
+    TEST_ASSERT_EQUAL(Ads1115::MAX_VALUE, adc.getBatchAverage());
+}
+
+void test_bus_utilization(void) {
+    // One second of continuous sampling, batches back to back
+    MockAds1115 bus;
+    bus.inputVolts = 1.4f;
+    Ads1115 adc(bus);
+    adc.begin();
+    
+    long samples = 0;
+    while (bus.nowUs < 1e6) {
+        readBatch(adc, bus, SAMPLE_RECORD_SAMPLES, 1e6);
+        samples += adc.getBatchCount();
+    }
+    double utilization = bus.busUtilization();
+    
+    // Same rate with a pointer write before every read
+    MockAds1115 naive;
+    naive.inputVolts = 1.4f;
+    Ads1115 setup(naive);
+    setup.begin();
+    uint8_t pointer = 0;
+    uint8_t data[2];
+    for (long i = 0; i < samples; i++) {
+        naive.write(naive.address, &pointer, 1);
+        naive.read(naive.address, data, 2);
+        naive.nowUs = 1e6 * (i + 1) / samples;
+    }
+    
+    char message[128];
+    snprintf(message, sizeof(message), "%ld samples/s at %d SPS, bus busy %.2f%% (%.2f%% with a pointer write per read)",
+             samples, bus.dataRate(), utilization * 100.0, naive.busUtilization() * 100.0);
+    TEST_MESSAGE(message);
+    
+    TEST_ASSERT_GREATER_THAN(bus.dataRate() * 0.85, samples);
+    TEST_ASSERT_EQUAL(0, bus.duplicateReads);
+    TEST_ASSERT_LESS_THAN(0.03, utilization);
+    TEST_ASSERT_LESS_THAN(naive.busUtilization(), utilization);
+}
+
+// Main test runner
+int main(int argc, char **argv) {
+    UNITY_BEGIN();
+    
+    RUN_TEST(test_config_value_fields);
+    RUN_TEST(test_begin_configures_continuous_mode);
+    RUN_TEST(test_missing_device);
+    RUN_TEST(test_one_transaction_per_sample);
+    RUN_TEST(test_distinct_conversions_with_oscillator_error);
+    RUN_TEST(test_negative_readings_clamp_to_zero);
+    RUN_TEST(test_bus_utilization);
+    
+    return UNITY_END();
+}
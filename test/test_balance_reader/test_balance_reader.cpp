@@ -0,0 +1,221 @@
+#include <unity.h>
+#include <math.h>
+#include <stdio.h>
+
+// Define UNIT_TEST before including anything
+#define UNIT_TEST
+
+// Include config first to ensure constants are defined
+#include "../../include/config.h"
+
+#include "../../include/BalanceReader.h"
+#include "../../src/BatteryAnalyzer.cpp"
+#include "../../src/BalanceReader.cpp"
+
+/**
+ * @brief Multi-channel mock ADC: balance taps of a pack whose cells may drift
+ *
+ * Every read() advances time by one sample. Tap k reads the sum of cells
+ * 0..k through a divider of TAP_RATIOS[k] at the ESP32-C3 reference.
+ */
+class MockAdc : public AdcChannels {
+public:
+    MockAdc(int channels, const float* cells, int cellCount)
+        : channels(channels), cellCount(cellCount), driftPerSample(0.0f), samples(0), begun(false) {
+        for (int i = 0; i < cellCount; i++) {
+            this->cells[i] = cells[i];
+        }
+    }
+    
+    void begin() { begun = true; }
+    int channelCount() const { return channels; }
+    
+    int read(int channel) {
+        float tap = 0.0f;
+        for (int i = 0; i <= channel && i < cellCount; i++) {
+            tap += cells[i] + driftPerSample * samples;
+        }
+        samples++;
+        
+        int raw = (int)(tap / voltsPerCount(channel) + 0.5f);
+        return raw > ADC_MAX_VALUE ? ADC_MAX_VALUE : raw;
+    }
+    
+    float voltsPerCount(int channel) const {
+        static const float TAP_RATIOS[] = { 2.0f, 3.0f, 4.5f, 6.0f, 7.5f, 9.0f };
+        return (float)ADC_VREF / ADC_MAX_VALUE * TAP_RATIOS[channel];
+    }
+    
+    int channels;
+    float cells[BALANCE_MAX_CELLS];
+    int cellCount;
+    float driftPerSample;    // Change of every cell voltage per sample (load ramp)
+    long samples;
+    bool begun;
+};
+
+// Largest quantization error of a tap difference (two taps, highest ratio used)
+static const float CELL_TOLERANCE = 2 * ADC_VREF / ADC_MAX_VALUE * 7.5f;
+
+void setUp(void) {
+}
+
+void tearDown(void) {
+}
+
+void test_cell_voltages_from_taps(void) {
+    const float cells[] = { 3.80f, 3.78f, 3.62f, 3.79f };
+    MockAdc adc(3, cells, 4);
+    BalanceReader reader(adc);
+    reader.begin();
+    TEST_ASSERT_TRUE(adc.begun);
+    TEST_ASSERT_FALSE(reader.hasReading());
+    
+    reader.readRound();
+    TEST_ASSERT_TRUE(reader.hasReading());
+    
+    // Three taps cover 4S: the top cell comes from the pack voltage
+    float total = cells[0] + cells[1] + cells[2] + cells[3];
+    float measured[BALANCE_MAX_CELLS];
+    TEST_ASSERT_EQUAL(4, reader.getCellVoltages(4, total, measured));
+    for (int i = 0; i < 4; i++) {
+        TEST_ASSERT_FLOAT_WITHIN(CELL_TOLERANCE, cells[i], measured[i]);
+    }
+    
+    BatteryInfo info = BatteryAnalyzer::analyzeWithCellCount(total, 4);
+    BalanceReader::applyCellVoltages(&info, measured, 4);
+    TEST_ASSERT_EQUAL(4, info.balanceCells);
+    TEST_ASSERT_EQUAL(3, info.weakestCell);
+    TEST_ASSERT_FLOAT_WITHIN(CELL_TOLERANCE, 0.18f, info.imbalance);
+    TEST_ASSERT_FLOAT_WITHIN(CELL_TOLERANCE, 3.62f, info.cellVoltages[2]);
+}
+
+void test_taps_must_cover_pack(void) {
+    const float cells[] = { 3.70f, 3.70f, 3.70f };
+    float measured[BALANCE_MAX_CELLS];
+    
+    // Four taps wired, 3S pack: the floating top tap is ignored
+    MockAdc wide(4, cells, 3);
+    BalanceReader reader(wide);
+    reader.readRound();
+    TEST_ASSERT_EQUAL(3, reader.getCellVoltages(3, 11.1f, measured));
+    TEST_ASSERT_FLOAT_WITHIN(CELL_TOLERANCE, 3.70f, measured[2]);
+    
+    // Two taps resolve 3S (top cell from the pack voltage) but not 4S
+    MockAdc narrow(2, cells, 3);
+    BalanceReader shortReader(narrow);
+    shortReader.readRound();
+    TEST_ASSERT_EQUAL(3, shortReader.getCellVoltages(3, 11.1f, measured));
+    TEST_ASSERT_EQUAL(0, shortReader.getCellVoltages(4, 14.8f, measured));
+    TEST_ASSERT_EQUAL(0, shortReader.getCellVoltages(0, 0.0f, measured));
+}
+
+void test_round_length_bounded(void) {
+    const float cells[] = { 3.7f, 3.7f, 3.7f, 3.7f, 3.7f, 3.7f };
+    
+    // Adding taps shares the same sample budget instead of lengthening the round
+    for (int channels = 1; channels <= BALANCE_MAX_CELLS; channels++) {
+        MockAdc adc(channels, cells, 6);
+        BalanceReader reader(adc, 64);
+        
+        reader.readRound();
+        TEST_ASSERT_EQUAL(reader.getSamplesPerRound(), adc.samples);
+        TEST_ASSERT_LESS_OR_EQUAL(64 + 2 * channels, adc.samples);
+        TEST_ASSERT_GREATER_OR_EQUAL(BALANCE_MIN_SAMPLES, reader.getSamplesPerChannel());
+        TEST_ASSERT_EQUAL(0, reader.getSamplesPerChannel() % 2);
+    }
+    
+    // Past the budget every tap keeps BALANCE_MIN_SAMPLES
+    MockAdc adc(6, cells, 6);
+    BalanceReader reader(adc, 8);
+    TEST_ASSERT_EQUAL(BALANCE_MIN_SAMPLES, reader.getSamplesPerChannel());
+}
+
+void test_step_takes_one_sample(void) {
+    const float cells[] = { 4.1f, 4.1f, 4.1f };
+    MockAdc adc(3, cells, 3);
+    BalanceReader reader(adc);
+    
+    int completed = 0;
+    for (int i = 1; i <= reader.getSamplesPerRound() * 3; i++) {
+        bool done = reader.step();
+        TEST_ASSERT_EQUAL(i, adc.samples);
+        TEST_ASSERT_EQUAL(i % reader.getSamplesPerRound() == 0, done);
+        completed += done ? 1 : 0;
+    }
+    TEST_ASSERT_EQUAL(3, completed);
+    TEST_ASSERT_EQUAL(3, reader.getRounds());
+    
+    reader.reset();
+    TEST_ASSERT_FALSE(reader.hasReading());
+}
+
+void test_load_drift_cancels(void) {
+    // Balanced 4S pack sagging 1mV per cell per sample while being measured
+    const float cells[] = { 3.90f, 3.90f, 3.90f, 3.90f };
+    MockAdc adc(4, cells, 4);
+    adc.driftPerSample = -0.001f;
+    BalanceReader reader(adc, 64);
+    reader.readRound();
+    
+    float measured[BALANCE_MAX_CELLS];
+    BatteryInfo info = BatteryAnalyzer::analyzeWithCellCount(15.6f, 4);
+    BalanceReader::applyCellVoltages(&info, measured, reader.getCellVoltages(4, 15.6f, measured));
+    
+    // The same samples read tap by tap (all samples of tap 0, then tap 1, ...)
+    MockAdc blockAdc(4, cells, 4);
+    blockAdc.driftPerSample = -0.001f;
+    float taps[4];
+    for (int channel = 0; channel < 4; channel++) {
+        long sum = 0;
+        for (int i = 0; i < reader.getSamplesPerChannel(); i++) {
+            sum += blockAdc.read(channel);
+        }
+        taps[channel] = (float)sum / reader.getSamplesPerChannel() * blockAdc.voltsPerCount(channel);
+    }
+    float blockCells[4] = { taps[0], taps[1] - taps[0], taps[2] - taps[1], taps[3] - taps[2] };
+    BatteryInfo block = BatteryAnalyzer::analyzeWithCellCount(15.6f, 4);
+    BalanceReader::applyCellVoltages(&block, blockCells, 4);
+    
+    char message[96];
+    snprintf(message, sizeof(message), "Apparent imbalance under load: %.1f mV (block) -> %.1f mV (interleaved)",
+             block.imbalance * 1000.0f, info.imbalance * 1000.0f);
+    TEST_MESSAGE(message);
+    
+    TEST_ASSERT_FLOAT_WITHIN(CELL_TOLERANCE, 0.0f, info.imbalance);
+    TEST_ASSERT_GREATER_THAN(0.030f, block.imbalance);
+}
+
+void test_balance_fields_default_empty(void) {
+    BatteryInfo info = BatteryAnalyzer::analyzeWithCellCount(11.1f, 3);
+    TEST_ASSERT_EQUAL(0, info.balanceCells);
+    TEST_ASSERT_EQUAL(0, info.weakestCell);
+    TEST_ASSERT_EQUAL_FLOAT(0.0f, info.imbalance);
+    
+    // No taps wired: nothing is sampled and no cells are reported
+    MockAdc adc(0, nullptr, 0);
+    BalanceReader reader(adc);
+    TEST_ASSERT_FALSE(reader.step());
+    reader.readRound();
+    TEST_ASSERT_EQUAL(0, adc.samples);
+    
+    float measured[BALANCE_MAX_CELLS];
+    int count = reader.getCellVoltages(1, 3.7f, measured);
+    TEST_ASSERT_EQUAL(0, count);
+    BalanceReader::applyCellVoltages(&info, measured, count);
+    TEST_ASSERT_EQUAL(0, info.balanceCells);
+}
+
+// Main test runner
+int main(int argc, char **argv) {
+    UNITY_BEGIN();
+    
+    RUN_TEST(test_cell_voltages_from_taps);
+    RUN_TEST(test_taps_must_cover_pack);
+    RUN_TEST(test_round_length_bounded);
+    RUN_TEST(test_step_takes_one_sample);
+    RUN_TEST(test_load_drift_cancels);
+    RUN_TEST(test_balance_fields_default_empty);
+    
+    return UNITY_END();
+}
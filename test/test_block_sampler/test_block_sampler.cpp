@@ -0,0 +1,178 @@
+#include <unity.h>
+#include <stdio.h>
+#include <math.h>
+
+// Define UNIT_TEST before including anything
+#define UNIT_TEST
+
+// Pro Mini configuration: the free-running backend's prescaler and oversampling
+#define ARDUINO_PRO_MINI 1
+#include "../../include/config.h"
+
+#include "../../include/FreeRunningAdc.h"
+#include "../../include/ConnectionWatcher.h"
+#include "../../include/SampleQueue.h"
+#include "../../include/BlockSampler.h"
+#include "../../src/FreeRunningAdc.cpp"
+#include "../../src/ConnectionWatcher.cpp"
+#include "../../src/SampleQueue.cpp"
+#include "../../src/BlockSampler.cpp"
+#include "../test_free_running_adc/MockAdcRegisters.h"
+
+// Raw thresholds well below the pack reading
+const int CONNECT_RAW = 100;
+const int DISCONNECT_RAW = 50;
+const double PACK_COUNTS = 611.3;
+
+/**
+ * @brief The sample task on the simulated ATmega328P ADC, one run per CONNECTION_POLL_MS
+ */
+struct SampleTaskRig {
+    MockAdcRegisters registers;
+    FreeRunningAdc adc;
+    ConnectionWatcher watcher;
+    SampleQueue queue;
+    BlockSampler sampler;
+    unsigned long nowMs;
+    int completedBlocks;
+    
+    explicit SampleTaskRig(int oversample)
+        : adc(registers, 0, AVR_ADC_PRESCALER, oversample, AVR_ADC_NOISE_SLEEP), sampler(adc, watcher, queue),
+          nowMs(0), completedBlocks(0) {
+        watcher.configure(CONNECT_RAW, DISCONNECT_RAW);
+        adc.begin();
+    }
+    
+    void runTask(int runs) {
+        for (int i = 0; i < runs; i++) {
+            registers.run(CONNECTION_POLL_MS * 1000.0);
+            nowMs += CONNECTION_POLL_MS;
+            sampler.run(nowMs);
+            if (sampler.blockCompleted()) {
+                completedBlocks++;
+            }
+        }
+    }
+};
+
+void setUp(void) {
+}
+
+void tearDown(void) {
+}
+
+void test_interrupt_blocks_outlast_poll(void) {
+    // A block per run at most, so the sample task takes every block the interrupt finishes
+    MockAdcRegisters registers;
+    FreeRunningAdc adc(registers, 0, AVR_ADC_PRESCALER, AVR_ADC_OVERSAMPLE, AVR_ADC_NOISE_SLEEP);
+    TEST_ASSERT_GREATER_THAN(CONNECTION_POLL_MS * 1000UL, AVR_ADC_OVERSAMPLE * adc.getConversionMicros(8000000UL));
+}
+
+void test_block_averages_reach_queue(void) {
+    SampleTaskRig rig(AVR_ADC_OVERSAMPLE);
+    rig.registers.inputCounts = PACK_COUNTS;
+    rig.registers.noiseCounts = 20.0;
+    
+    // Plug-in, then five records' worth of runs
+    rig.runTask(CONNECT_DEBOUNCE_SAMPLES);
+    TEST_ASSERT_TRUE(rig.watcher.isConnected());
+    rig.runTask(5 * SAMPLE_RECORD_SAMPLES);
+    TEST_ASSERT_EQUAL(5, rig.completedBlocks);
+    TEST_ASSERT_EQUAL(5, rig.queue.size());
+    
+    // Every interrupt block went into a record
+    TEST_ASSERT_EQUAL(0, rig.adc.getDroppedBlocks());
+    
+    SampleRecord record;
+    uint16_t sequence = 0;
+    while (rig.queue.pop(&record)) {
+        TEST_ASSERT_EQUAL(sequence++, record.sequence);
+        // Hundreds of conversions per record: far inside the +-20 count noise
+        TEST_ASSERT_INT_WITHIN(1, (int)(PACK_COUNTS + 0.5), record.raw);
+    }
+    
+    char message[96];
+    snprintf(message, sizeof(message), "%lu conversions, %lu blocks dropped, %d records",
+             rig.registers.conversions, rig.adc.getDroppedBlocks(), rig.completedBlocks);
+    TEST_MESSAGE(message);
+}
+
+void test_record_averages_whole_blocks(void) {
+    SampleTaskRig rig(AVR_ADC_OVERSAMPLE);
+    rig.registers.inputCounts = 400.0;
+    rig.runTask(CONNECT_DEBOUNCE_SAMPLES);
+    TEST_ASSERT_TRUE(rig.watcher.isConnected());
+    rig.runTask(SAMPLE_RECORD_SAMPLES);
+    
+    // The input steps halfway through the next record: it averages both halves
+    rig.registers.inputCounts = 800.0;
+    rig.runTask(SAMPLE_RECORD_SAMPLES / 2);
+    rig.registers.inputCounts = 400.0;
+    rig.runTask(SAMPLE_RECORD_SAMPLES - SAMPLE_RECORD_SAMPLES / 2);
+    
+    SampleRecord first, second;
+    TEST_ASSERT_TRUE(rig.queue.pop(&first));
+    TEST_ASSERT_TRUE(rig.queue.pop(&second));
+    TEST_ASSERT_EQUAL(400, first.raw);
+    // Blocks straddling the record boundaries shift the split by up to one block
+    TEST_ASSERT_INT_WITHIN(80, 600, second.raw);
+    TEST_ASSERT_GREATER_THAN(400, second.raw);
+    TEST_ASSERT_LESS_THAN(800, second.raw);
+}
+
+void test_short_blocks_are_dropped(void) {
+    // Blocks shorter than the poll period: the newest wins, the rest are lost
+    SampleTaskRig rig(16);
+    rig.registers.inputCounts = PACK_COUNTS;
+    rig.runTask(CONNECT_DEBOUNCE_SAMPLES + 2 * SAMPLE_RECORD_SAMPLES);
+    TEST_ASSERT_EQUAL(2, rig.completedBlocks);
+    TEST_ASSERT_GREATER_THAN(0, rig.adc.getDroppedBlocks());
+}
+
+void test_no_records_without_pack(void) {
+    SampleTaskRig rig(AVR_ADC_OVERSAMPLE);
+    rig.registers.inputCounts = 2.0;
+    rig.runTask(4 * SAMPLE_RECORD_SAMPLES);
+    TEST_ASSERT_FALSE(rig.watcher.isConnected());
+    TEST_ASSERT_EQUAL(0, rig.queue.size());
+    
+    // Removal ends the block in progress; nothing is queued afterwards
+    rig.registers.inputCounts = PACK_COUNTS;
+    rig.runTask(CONNECT_DEBOUNCE_SAMPLES + SAMPLE_RECORD_SAMPLES + SAMPLE_RECORD_SAMPLES / 2);
+    TEST_ASSERT_EQUAL(1, rig.queue.size());
+    rig.registers.inputCounts = 2.0;
+    rig.runTask(4 * SAMPLE_RECORD_SAMPLES);
+    TEST_ASSERT_FALSE(rig.watcher.isConnected());
+    TEST_ASSERT_EQUAL(1, rig.queue.size());
+}
+
+void test_samples_per_block_setting(void) {
+    SampleTaskRig rig(AVR_ADC_OVERSAMPLE);
+    rig.registers.inputCounts = PACK_COUNTS;
+    rig.runTask(CONNECT_DEBOUNCE_SAMPLES);
+    
+    // "$samples 4": a record every four runs, the block in progress restarts
+    rig.runTask(3);
+    rig.sampler.setSamplesPerBlock(4);
+    TEST_ASSERT_EQUAL(4, rig.sampler.getSamplesPerBlock());
+    rig.runTask(3);
+    TEST_ASSERT_EQUAL(0, rig.completedBlocks);
+    rig.runTask(1);
+    TEST_ASSERT_EQUAL(1, rig.completedBlocks);
+    rig.runTask(8);
+    TEST_ASSERT_EQUAL(3, rig.completedBlocks);
+}
+
+// Main test runner
+int main(int argc, char **argv) {
+    UNITY_BEGIN();
+    
+    RUN_TEST(test_interrupt_blocks_outlast_poll);
+    RUN_TEST(test_block_averages_reach_queue);
+    RUN_TEST(test_record_averages_whole_blocks);
+    RUN_TEST(test_short_blocks_are_dropped);
+    RUN_TEST(test_no_records_without_pack);
+    RUN_TEST(test_samples_per_block_setting);
+    
+    return UNITY_END();
+}
@@ -0,0 +1,197 @@
+#include <unity.h>
+#include <math.h>
+#include <stdio.h>
+
+// Define UNIT_TEST before including anything
+#define UNIT_TEST
+
+// Include config first to ensure constants are defined
+#include "../../include/config.h"
+
+#include "../../include/CalibrationTable.h"
+#include "../../src/CalibrationTable.cpp"
+
+// Nominal conversion used without a table (reference voltage x divider ratio)
+static const float DIVIDER_RATIO = (float)((VOLTAGE_DIVIDER_R1 + VOLTAGE_DIVIDER_R2) / VOLTAGE_DIVIDER_R2);
+static const float NOMINAL_VOLTS_PER_COUNT = (float)ADC_VREF / ADC_MAX_VALUE * DIVIDER_RATIO;
+
+/**
+ * @brief Synthetic nonlinear ADC: fractional raw code for a battery voltage
+ *
+ * ESP32-C3-like errors on top of the nominal scale: 1.5% gain error, a
+ * 25-count offset, a 30-count bow over the range and compression in the
+ * top 10% of the range (the curve stays monotonic).
+ */
+static float modelRaw(float batteryVoltage) {
+    float ideal = batteryVoltage / NOMINAL_VOLTS_PER_COUNT;
+    float x = ideal / ADC_MAX_VALUE;
+    float raw = ideal * 1.015f + 25.0f + 30.0f * sinf(3.14159265f * x);
+    if (x > 0.9f) {
+        raw -= (x - 0.9f) * (x - 0.9f) * 6000.0f;
+    }
+    if (raw < 0.0f) raw = 0.0f;
+    if (raw > ADC_MAX_VALUE) raw = ADC_MAX_VALUE;
+    return raw;
+}
+
+static int modelReading(float batteryVoltage) {
+    return (int)(modelRaw(batteryVoltage) + 0.5f);
+}
+
+/**
+ * @brief Calibrate against the model at the given reference voltages
+ */
+static bool calibrate(CalibrationTable* table, const float* voltages, int count) {
+    CalibrationPoint points[CALIBRATION_MAX_POINTS];
+    for (int i = 0; i < count; i++) {
+        points[i].raw = modelRaw(voltages[i]);
+        points[i].voltage = voltages[i];
+    }
+    return table->fit(points, count);
+}
+
+void setUp(void) {
+}
+
+void tearDown(void) {
+}
+
+// Test six reference voltages bring the nonlinear ADC to within a few tens of mV
+void test_nonlinear_adc_corrected() {
+    CalibrationTable table;
+    const float references[] = { 3.0f, 7.0f, 11.0f, 15.0f, 18.5f, 21.0f };
+    TEST_ASSERT_TRUE(calibrate(&table, references, 6));
+    TEST_ASSERT_TRUE(table.isValid());
+    
+    float maxNominalError = 0.0f;
+    float maxTableError = 0.0f;
+    for (float v = 3.0f; v <= 21.0f; v += 0.01f) {
+        int raw = modelReading(v);
+        float nominal = raw * NOMINAL_VOLTS_PER_COUNT;
+        float corrected = table.toMillivolts(raw) * 0.001f;
+        maxNominalError = fmaxf(maxNominalError, fabsf(nominal - v));
+        maxTableError = fmaxf(maxTableError, fabsf(corrected - v));
+    }
+    
+    char message[96];
+    snprintf(message, sizeof(message), "3-21V max error: nominal %.0f mV, calibrated %.0f mV",
+             maxNominalError * 1000.0f, maxTableError * 1000.0f);
+    TEST_MESSAGE(message);
+    TEST_ASSERT_TRUE(maxNominalError > 0.25f);
+    TEST_ASSERT_TRUE(maxTableError < 0.06f);
+}
+
+// Test two points on a linear ADC give an exact gain/offset correction everywhere
+void test_two_points_linear() {
+    CalibrationTable table;
+    CalibrationPoint points[2] = {
+        { 3000.5f, 3000.5f * 0.006f + 0.1f },
+        { 500.25f, 500.25f * 0.006f + 0.1f }        // Out of order on purpose
+    };
+    TEST_ASSERT_TRUE(table.fit(points, 2));
+    
+    for (int raw = 0; raw <= VOLTAGE_ADC_MAX_VALUE; raw++) {
+        float expected = raw * 0.006f + 0.1f;
+        TEST_ASSERT_FLOAT_WITHIN(0.002f, expected, table.toMillivolts(raw) * 0.001f);
+    }
+}
+
+// Test unusable point sets are rejected and leave the table alone
+void test_fit_rejects_bad_points() {
+    CalibrationTable table;
+    CalibrationPoint one[1] = { { 1000.0f, 5.0f } };
+    TEST_ASSERT_FALSE(table.fit(one, 1));
+    TEST_ASSERT_FALSE(table.isValid());
+    
+    CalibrationPoint duplicate[2] = { { 1000.0f, 5.0f }, { 1000.0f, 6.0f } };
+    TEST_ASSERT_FALSE(table.fit(duplicate, 2));
+    CalibrationPoint falling[3] = { { 1000.0f, 5.0f }, { 2000.0f, 4.0f }, { 3000.0f, 12.0f } };
+    TEST_ASSERT_FALSE(table.fit(falling, 3));
+    TEST_ASSERT_FALSE(table.isValid());
+    
+    CalibrationPoint good[2] = { { 1000.0f, 5.0f }, { 2000.0f, 10.0f } };
+    TEST_ASSERT_TRUE(table.fit(good, 2));
+    uint16_t knot = table.getKnot(8);
+    TEST_ASSERT_FALSE(table.fit(falling, 3));
+    TEST_ASSERT_TRUE(table.isValid());
+    TEST_ASSERT_EQUAL(knot, table.getKnot(8));
+    
+    table.clear();
+    TEST_ASSERT_FALSE(table.isValid());
+}
+
+// Test the stored blob round trip and that any damage is detected
+void test_blob_round_trip_and_corruption() {
+    CalibrationTable table;
+    const float references[] = { 3.0f, 9.0f, 15.0f, 21.0f };
+    TEST_ASSERT_TRUE(calibrate(&table, references, 4));
+    
+    uint8_t blob[CalibrationTable::BLOB_SIZE];
+    table.serialize(blob);
+    
+    CalibrationTable loaded;
+    TEST_ASSERT_TRUE(loaded.deserialize(blob));
+    TEST_ASSERT_TRUE(loaded.isValid());
+    for (int i = 0; i <= CALIBRATION_SEGMENTS; i++) {
+        TEST_ASSERT_EQUAL(table.getKnot(i), loaded.getKnot(i));
+    }
+    for (int raw = 0; raw <= VOLTAGE_ADC_MAX_VALUE; raw += 7) {
+        TEST_ASSERT_EQUAL(table.toMillivolts(raw), loaded.toMillivolts(raw));
+    }
+    
+    // Every single-bit flip is rejected
+    for (int i = 0; i < CalibrationTable::BLOB_SIZE; i++) {
+        for (int bit = 0; bit < 8; bit++) {
+            blob[i] ^= (uint8_t)(1 << bit);
+            CalibrationTable damaged;
+            TEST_ASSERT_FALSE(damaged.deserialize(blob));
+            TEST_ASSERT_FALSE(damaged.isValid());
+            blob[i] ^= (uint8_t)(1 << bit);
+        }
+    }
+    
+    // Erased storage
+    uint8_t erased[CalibrationTable::BLOB_SIZE];
+    for (int i = 0; i < CalibrationTable::BLOB_SIZE; i++) {
+        erased[i] = 0xFF;
+    }
+    TEST_ASSERT_FALSE(loaded.deserialize(erased));
+    TEST_ASSERT_TRUE(loaded.isValid());                    // Unchanged by a failed load
+}
+
+// Test the lookup clamps out-of-range input, never falls, and toRaw() inverts it
+void test_lookup_edges_and_inverse() {
+    CalibrationTable table;
+    const float references[] = { 3.0f, 7.0f, 11.0f, 15.0f, 18.5f, 21.0f };
+    TEST_ASSERT_TRUE(calibrate(&table, references, 6));
+    
+    TEST_ASSERT_EQUAL(table.toMillivolts(0), table.toMillivolts(-50));
+    TEST_ASSERT_EQUAL(table.toMillivolts(VOLTAGE_ADC_MAX_VALUE), table.toMillivolts(VOLTAGE_ADC_MAX_VALUE + 100));
+    
+    uint16_t previous = 0;
+    for (int raw = 0; raw <= VOLTAGE_ADC_MAX_VALUE; raw++) {
+        uint16_t millivolts = table.toMillivolts(raw);
+        TEST_ASSERT_TRUE(millivolts >= previous);
+        previous = millivolts;
+    }
+    
+    for (uint16_t millivolts = 1000; millivolts <= 20000; millivolts += 137) {
+        int raw = table.toRaw(millivolts);
+        TEST_ASSERT_TRUE(table.toMillivolts(raw) >= millivolts);
+        TEST_ASSERT_TRUE(raw == 0 || table.toMillivolts(raw - 1) < millivolts);
+    }
+    TEST_ASSERT_EQUAL(VOLTAGE_ADC_MAX_VALUE, table.toRaw(65535));
+}
+
+// Main test runner
+int main(int argc, char **argv) {
+    UNITY_BEGIN();
+    
+    RUN_TEST(test_nonlinear_adc_corrected);
+    RUN_TEST(test_two_points_linear);
+    RUN_TEST(test_fit_rejects_bad_points);
+    RUN_TEST(test_blob_round_trip_and_corruption);
+    RUN_TEST(test_lookup_edges_and_inverse);
+    
+    return UNITY_END();
+}
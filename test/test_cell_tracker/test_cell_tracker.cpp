@@ -0,0 +1,234 @@
+#include <unity.h>
+
+// Define UNIT_TEST before including anything
+#define UNIT_TEST
+
+// Include config first to ensure constants are defined
+#include "../../include/config.h"
+
+#include "../../include/CellCountTracker.h"
+#include "../../include/SessionHistory.h"
+#include "../../src/BatteryAnalyzer.cpp"
+#include "../../src/CellCountTracker.cpp"
+#include "../../src/SessionHistory.cpp"
+
+// Feed the same voltage several times and return the final cell count
+static int feed(CellCountTracker& tracker, float voltage, int readings) {
+    int cells = 0;
+    for (int i = 0; i < readings; i++) {
+        cells = tracker.update(voltage);
+    }
+    return cells;
+}
+
+// Test nominal packs lock after TRACKER_LOCK_READINGS readings
+void test_nominal_packs_lock() {
+    const float voltages[] = { 3.7f, 7.4f, 11.1f, 14.8f, 18.5f, 22.2f };
+    
+    for (int i = 0; i < 6; i++) {
+        CellCountTracker tracker;
+        for (int r = 1; r < TRACKER_LOCK_READINGS; r++) {
+            tracker.update(voltages[i]);
+            TEST_ASSERT_FALSE(tracker.isLocked());
+        }
+        TEST_ASSERT_EQUAL(i + 1, tracker.update(voltages[i]));
+        TEST_ASSERT_TRUE(tracker.isLocked());
+        TEST_ASSERT_GREATER_OR_EQUAL(95, tracker.getConfidence());
+    }
+}
+
+// Test the documented ambiguous voltage settles on 3S with honest confidence
+void test_ambiguous_11_6V() {
+    CellCountTracker tracker;
+    TEST_ASSERT_EQUAL(3, feed(tracker, 11.6f, 10));
+    
+    // 4S at 2.9V/cell stays possible
+    TEST_ASSERT_GREATER_THAN(0.0f, tracker.getProbability(4));
+    TEST_ASSERT_LESS_THAN(100, tracker.getConfidence());
+    TEST_ASSERT_GREATER_OR_EQUAL((int)(TRACKER_LOCK_CONFIDENCE * 100), tracker.getConfidence());
+}
+
+// Test noise around a band edge does not flicker (full 3S at 12.6V)
+void test_band_edge_noise_is_stable() {
+    // Readings cross 4.2V/cell: single-shot alternates between 3S and 4S
+    const float noisy[] = { 12.58f, 12.64f, 12.61f, 12.66f, 12.57f, 12.63f, 12.60f, 12.65f };
+    CellCountTracker tracker;
+    int singleShotChanges = 0;
+    int previous = BatteryAnalyzer::detectCellCount(noisy[0]);
+    
+    for (int round = 0; round < 4; round++) {
+        for (int i = 0; i < 8; i++) {
+            int single = BatteryAnalyzer::detectCellCount(noisy[i]);
+            if (single != previous) singleShotChanges++;
+            previous = single;
+            
+            TEST_ASSERT_EQUAL(3, tracker.update(noisy[i]));
+        }
+    }
+    
+    TEST_ASSERT_GREATER_THAN(0, singleShotChanges);
+    TEST_ASSERT_TRUE(tracker.isLocked());
+}
+
+// Test a locked count holds through a full discharge
+void test_lock_holds_during_discharge() {
+    CellCountTracker tracker;
+    feed(tracker, 16.8f, 5);
+    TEST_ASSERT_TRUE(tracker.isLocked());
+    
+    for (float v = 16.8f; v >= 13.2f; v -= 0.02f) {
+        TEST_ASSERT_EQUAL(4, tracker.update(v));
+    }
+}
+
+// Test disconnect resets the tracker
+void test_disconnect_resets() {
+    CellCountTracker tracker;
+    feed(tracker, 11.1f, 5);
+    TEST_ASSERT_TRUE(tracker.isLocked());
+    
+    TEST_ASSERT_EQUAL(0, tracker.update(0.1f));
+    TEST_ASSERT_FALSE(tracker.isLocked());
+    TEST_ASSERT_EQUAL(0, tracker.getReadingCount());
+    TEST_ASSERT_EQUAL(0, tracker.getConfidence());
+    
+    // Next pack is detected from scratch
+    TEST_ASSERT_EQUAL(2, feed(tracker, 7.4f, 3));
+}
+
+// Test swapping packs without a gap restarts averaging once the new voltage persists
+void test_pack_swap_jump_resets() {
+    CellCountTracker tracker;
+    feed(tracker, 22.2f, 10);
+    TEST_ASSERT_EQUAL(6, tracker.getCellCount());
+    
+    for (int i = 1; i < TRACKER_RESET_READINGS; i++) {
+        TEST_ASSERT_EQUAL(6, tracker.update(11.1f));
+    }
+    TEST_ASSERT_EQUAL(3, tracker.update(11.1f));
+    TEST_ASSERT_EQUAL(1, tracker.getReadingCount());
+}
+
+// Test readings outside the count's range are left out until they persist
+void test_short_out_of_range_run_ignored() {
+    CellCountTracker tracker;
+    feed(tracker, 22.2f, 10);
+    int averaged = tracker.getReadingCount();
+    
+    // Below 6 x 2.9V: no 6S pack, but too short to be another one
+    for (int i = 1; i < TRACKER_RESET_READINGS; i++) {
+        TEST_ASSERT_EQUAL(6, tracker.update(16.5f));
+    }
+    TEST_ASSERT_EQUAL(6, tracker.update(22.2f));
+    TEST_ASSERT_TRUE(tracker.isLocked());
+    TEST_ASSERT_EQUAL(averaged + 1, tracker.getReadingCount());
+    TEST_ASSERT_GREATER_OR_EQUAL(95, tracker.getConfidence());
+}
+
+// Test a 2V sag under load keeps the count, the average and the session history
+void test_load_sag_keeps_session() {
+    // 4S-6S packs at 3.6V per cell, a two-reading 2V sag halfway through
+    for (int cells = 4; cells <= 6; cells++) {
+        CellCountTracker tracker;
+        SessionHistory history;
+        float rest = cells * 3.6f;
+        int readings = 0;
+        
+        for (int i = 0; i < 40; i++) {
+            float voltage = (i == 20 || i == 21) ? rest - 2.0f : rest;
+            int counted = tracker.update(voltage);
+            history.append(voltage);
+            readings++;
+            if (i >= TRACKER_LOCK_READINGS) {
+                TEST_ASSERT_EQUAL(cells, counted);
+                TEST_ASSERT_TRUE(tracker.isLocked());
+                TEST_ASSERT_GREATER_THAN(1, tracker.getReadingCount());
+            }
+        }
+        
+        TEST_ASSERT_EQUAL(readings, (int)history.getSessionCount());
+        TEST_ASSERT_EQUAL(1, history.getSagCount());
+        TEST_ASSERT_FLOAT_WITHIN(0.05f, 2.0f, history.getDeepestSag());
+    }
+}
+
+// Test averaging is capped so the mean follows the discharge
+void test_reading_count_capped() {
+    CellCountTracker tracker;
+    feed(tracker, 11.1f, TRACKER_MAX_AVERAGED * 3);
+    TEST_ASSERT_EQUAL(TRACKER_MAX_AVERAGED, tracker.getReadingCount());
+}
+
+// Test invalid voltages give no cell count
+void test_invalid_voltages() {
+    CellCountTracker tracker;
+    TEST_ASSERT_EQUAL(0, feed(tracker, 30.0f, 5));
+    TEST_ASSERT_EQUAL(0, tracker.getConfidence());
+    TEST_ASSERT_EQUAL(0, tracker.update(1.0f));
+}
+
+// Test posterior is normalized
+void test_posterior_normalized() {
+    CellCountTracker tracker;
+    feed(tracker, 14.5f, 4);
+    
+    float sum = 0.0f;
+    for (int cells = 1; cells <= MAX_CELLS; cells++) {
+        sum += tracker.getProbability(cells);
+    }
+    TEST_ASSERT_FLOAT_WITHIN(0.001, 1.0, sum);
+    TEST_ASSERT_EQUAL(0.0f, tracker.getProbability(0));
+    TEST_ASSERT_EQUAL(0.0f, tracker.getProbability(MAX_CELLS + 1));
+}
+
+// Test chemistry limits are applied (2S LiHV at 8.7V)
+void test_configure_chemistry() {
+    CellCountTracker tracker;
+    TEST_ASSERT_EQUAL(3, feed(tracker, 8.7f, 5));  // LiPo: 3S at 2.9V/cell
+    
+    tracker.configure(chemistryLimits<LiHVChemistry>());
+    TEST_ASSERT_EQUAL(0, tracker.getReadingCount());
+    TEST_ASSERT_EQUAL(2, feed(tracker, 8.7f, 5));
+    
+    tracker.configure(chemistryLimits<LiFePO4Chemistry>());
+    TEST_ASSERT_EQUAL(4, feed(tracker, 13.2f, 5));
+}
+
+// Test tune() replaces the lock and averaging settings and starts over
+void test_tune() {
+    CellCountTracker tracker;
+    feed(tracker, 11.1f, 3);
+    
+    TrackerTuning tuning;
+    tuning.maxAveraged = 4;
+    tuning.lockReadings = 5;
+    tracker.tune(tuning);
+    TEST_ASSERT_EQUAL(0, tracker.getReadingCount());
+    
+    TEST_ASSERT_EQUAL(3, feed(tracker, 11.1f, 4));
+    TEST_ASSERT_FALSE(tracker.isLocked());
+    feed(tracker, 11.1f, 1);
+    TEST_ASSERT_TRUE(tracker.isLocked());
+    TEST_ASSERT_EQUAL(4, tracker.getReadingCount());
+}
+
+// Main test runner
+int main(int argc, char **argv) {
+    UNITY_BEGIN();
+    
+    RUN_TEST(test_nominal_packs_lock);
+    RUN_TEST(test_ambiguous_11_6V);
+    RUN_TEST(test_band_edge_noise_is_stable);
+    RUN_TEST(test_lock_holds_during_discharge);
+    RUN_TEST(test_disconnect_resets);
+    RUN_TEST(test_pack_swap_jump_resets);
+    RUN_TEST(test_short_out_of_range_run_ignored);
+    RUN_TEST(test_load_sag_keeps_session);
+    RUN_TEST(test_reading_count_capped);
+    RUN_TEST(test_invalid_voltages);
+    RUN_TEST(test_posterior_normalized);
+    RUN_TEST(test_configure_chemistry);
+    RUN_TEST(test_tune);
+    
+    return UNITY_END();
+}
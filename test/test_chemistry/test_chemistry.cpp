@@ -0,0 +1,179 @@
+#include <unity.h>
+
+// Define UNIT_TEST before including anything
+#define UNIT_TEST
+
+// Include config first to ensure constants are defined
+#include "../../include/config.h"
+
+// Analyzer templates and the runtime chemistry dispatcher
+#include "../../include/ChemistrySelector.h"
+#include "../../src/BatteryAnalyzer.cpp"
+#include "../../src/ChemistrySelector.cpp"
+
+typedef ChemistryAnalyzer<LiHVChemistry> LiHVAnalyzer;
+typedef ChemistryAnalyzer<LiIonChemistry> LiIonAnalyzer;
+typedef ChemistryAnalyzer<LiFePO4Chemistry> LiFePO4Analyzer;
+
+// Test that the LiPo policy keeps the original config.h thresholds
+void test_lipo_policy_matches_config() {
+    TEST_ASSERT_FLOAT_WITHIN(0.0001, CELL_VOLTAGE_MIN, LiPoChemistry::minCellVoltage());
+    TEST_ASSERT_FLOAT_WITHIN(0.0001, CELL_VOLTAGE_MAX, LiPoChemistry::maxCellVoltage());
+    TEST_ASSERT_EQUAL(MAX_CELLS, LiPoChemistry::maxCells());
+    
+    // Linear SOC between CELL_VOLTAGE_EMPTY and CELL_VOLTAGE_FULL
+    TEST_ASSERT_EQUAL(0, BatteryAnalyzer::calculateChargePercentage(3.3));
+    TEST_ASSERT_EQUAL(50, BatteryAnalyzer::calculateChargePercentage(3.75));
+    TEST_ASSERT_EQUAL(100, BatteryAnalyzer::calculateChargePercentage(4.2));
+}
+
+// Test LiHV cell detection up to 4.35V/cell
+void test_lihv_detection() {
+    // 1S fully charged LiHV is invalid for LiPo but valid for LiHV
+    TEST_ASSERT_EQUAL(0, BatteryAnalyzer::detectCellCount(4.35));
+    TEST_ASSERT_EQUAL(1, LiHVAnalyzer::detectCellCount(4.35));
+    
+    // 2S LiHV at 8.7V: LiPo would reject 4.35V/cell for 2S and pick 3S
+    TEST_ASSERT_EQUAL(3, BatteryAnalyzer::detectCellCount(8.7));
+    TEST_ASSERT_EQUAL(2, LiHVAnalyzer::detectCellCount(8.7));
+    
+    // 4S LiHV fully charged (17.4V)
+    TEST_ASSERT_EQUAL(4, LiHVAnalyzer::detectCellCount(17.4));
+    
+    // 6S LiHV fully charged (26.1V) is above the LiPo range
+    TEST_ASSERT_EQUAL(0, BatteryAnalyzer::detectCellCount(26.1));
+    TEST_ASSERT_EQUAL(6, LiHVAnalyzer::detectCellCount(26.1));
+}
+
+// Test LiHV charge percentage
+void test_lihv_charge_percentage() {
+    TEST_ASSERT_EQUAL(100, LiHVAnalyzer::calculateChargePercentage(4.35));
+    TEST_ASSERT_EQUAL(0, LiHVAnalyzer::calculateChargePercentage(3.2));
+    TEST_ASSERT_EQUAL(50, LiHVAnalyzer::calculateChargePercentage(3.85));
+    
+    // A 4.2V cell is not full for LiHV
+    TEST_ASSERT_LESS_THAN(100, LiHVAnalyzer::calculateChargePercentage(4.2));
+}
+
+// Test Li-ion detection down to 2.5V/cell
+void test_liion_detection() {
+    TEST_ASSERT_EQUAL(1, LiIonAnalyzer::detectCellCount(2.6));
+    TEST_ASSERT_EQUAL(0, BatteryAnalyzer::detectCellCount(2.6));
+    TEST_ASSERT_EQUAL(3, LiIonAnalyzer::detectCellCount(10.8));
+    TEST_ASSERT_EQUAL(4, LiIonAnalyzer::detectCellCount(16.8));
+    TEST_ASSERT_EQUAL(0, LiIonAnalyzer::detectCellCount(1.5));
+}
+
+// Test Li-ion SOC curve is monotonic and clamped
+void test_liion_charge_percentage() {
+    TEST_ASSERT_EQUAL(0, LiIonAnalyzer::calculateChargePercentage(2.8));
+    TEST_ASSERT_EQUAL(50, LiIonAnalyzer::calculateChargePercentage(3.7));
+    TEST_ASSERT_EQUAL(100, LiIonAnalyzer::calculateChargePercentage(4.2));
+    
+    int previous = 0;
+    for (float v = 2.8f; v <= 4.3f; v += 0.01f) {
+        int percentage = LiIonAnalyzer::calculateChargePercentage(v);
+        TEST_ASSERT_GREATER_OR_EQUAL(previous, percentage);
+        TEST_ASSERT_LESS_OR_EQUAL(100, percentage);
+        previous = percentage;
+    }
+}
+
+// Test LiFePO4 detection (2.5V - 3.65V per cell)
+void test_lifepo4_detection() {
+    TEST_ASSERT_EQUAL(1, LiFePO4Analyzer::detectCellCount(3.3));
+    TEST_ASSERT_EQUAL(2, LiFePO4Analyzer::detectCellCount(6.6));
+    TEST_ASSERT_EQUAL(4, LiFePO4Analyzer::detectCellCount(13.2));   // "12V" LiFePO4 pack
+    TEST_ASSERT_EQUAL(4, LiFePO4Analyzer::detectCellCount(14.6));   // 4S fully charged
+    
+    // LiPo also reads 13.2V as 4S (3.3V/cell)
+    TEST_ASSERT_EQUAL(4, BatteryAnalyzer::detectCellCount(13.2));
+    
+    // 2S LiFePO4 at 7.3V looks like a 2S LiPo at 3.65V/cell
+    BatteryInfo lipo = BatteryAnalyzer::analyzeBattery(7.3);
+    BatteryInfo lfp = LiFePO4Analyzer::analyzeBattery(7.3);
+    TEST_ASSERT_EQUAL(2, lipo.cellCount);
+    TEST_ASSERT_EQUAL(2, lfp.cellCount);
+    TEST_ASSERT_EQUAL(100, lfp.chargePercentage);
+    TEST_ASSERT_LESS_THAN(50, lipo.chargePercentage);
+    
+    // Above 6S maximum with margin
+    TEST_ASSERT_EQUAL(0, LiFePO4Analyzer::detectCellCount(25.0));
+}
+
+// Test LiFePO4 plateau SOC curve
+void test_lifepo4_charge_percentage() {
+    TEST_ASSERT_EQUAL(0, LiFePO4Analyzer::calculateChargePercentage(2.7));
+    TEST_ASSERT_EQUAL(40, LiFePO4Analyzer::calculateChargePercentage(3.30));
+    TEST_ASSERT_EQUAL(100, LiFePO4Analyzer::calculateChargePercentage(3.6));
+    TEST_ASSERT_INT_WITHIN(2, 15, LiFePO4Analyzer::calculateChargePercentage(3.225));
+}
+
+// Test voltage validation uses chemistry limits
+void test_chemistry_voltage_validation() {
+    TEST_ASSERT_TRUE(LiHVAnalyzer::isVoltageValid(8.7, 2));
+    TEST_ASSERT_FALSE(BatteryAnalyzer::isVoltageValid(8.7, 2));
+    TEST_ASSERT_TRUE(LiFePO4Analyzer::isVoltageValid(13.2, 4));
+    TEST_ASSERT_FALSE(LiFePO4Analyzer::isVoltageValid(16.8, 4));
+    TEST_ASSERT_FALSE(LiIonAnalyzer::isVoltageValid(10.0, 7));
+}
+
+// Test runtime dispatcher selects the matching instantiation
+void test_selector_dispatch() {
+    ChemistrySelector::select(CHEMISTRY_LIPO);
+    TEST_ASSERT_EQUAL(CHEMISTRY_LIPO, ChemistrySelector::current());
+    TEST_ASSERT_EQUAL(3, ChemistrySelector::analyzeBattery(8.7).cellCount);
+    
+    ChemistrySelector::select(CHEMISTRY_LIHV);
+    TEST_ASSERT_EQUAL(2, ChemistrySelector::analyzeBattery(8.7).cellCount);
+    
+    // Explicit chemistry does not change the active one
+    TEST_ASSERT_EQUAL(4, ChemistrySelector::analyzeBattery(CHEMISTRY_LIFEPO4, 13.2).cellCount);
+    TEST_ASSERT_EQUAL(CHEMISTRY_LIHV, ChemistrySelector::current());
+    
+    // Out of range is rejected
+    ChemistrySelector::select((ChemistryType)42);
+    TEST_ASSERT_EQUAL(CHEMISTRY_LIHV, ChemistrySelector::current());
+    TEST_ASSERT_FALSE(ChemistrySelector::analyzeBattery((ChemistryType)42, 11.1).isValid);
+}
+
+// Test button cycling and serial command mapping
+void test_selector_cycle_and_commands() {
+    ChemistrySelector::select(CHEMISTRY_LIPO);
+    TEST_ASSERT_EQUAL(CHEMISTRY_LIHV, ChemistrySelector::next());
+    TEST_ASSERT_EQUAL(CHEMISTRY_LIION, ChemistrySelector::next());
+    TEST_ASSERT_EQUAL(CHEMISTRY_LIFEPO4, ChemistrySelector::next());
+    TEST_ASSERT_EQUAL(CHEMISTRY_LIPO, ChemistrySelector::next());
+    
+    ChemistryType type;
+    TEST_ASSERT_TRUE(ChemistrySelector::fromCommand('h', &type));
+    TEST_ASSERT_EQUAL(CHEMISTRY_LIHV, type);
+    TEST_ASSERT_TRUE(ChemistrySelector::fromCommand('F', &type));
+    TEST_ASSERT_EQUAL(CHEMISTRY_LIFEPO4, type);
+    TEST_ASSERT_FALSE(ChemistrySelector::fromCommand('x', &type));
+    
+    TEST_ASSERT_EQUAL_STRING("LiPo", ChemistrySelector::name(CHEMISTRY_LIPO));
+    TEST_ASSERT_EQUAL_STRING("LiFePO4", ChemistrySelector::name(CHEMISTRY_LIFEPO4));
+    TEST_ASSERT_EQUAL_STRING("?", ChemistrySelector::name(CHEMISTRY_COUNT));
+}
+
+// Main test runner
+int main(int argc, char **argv) {
+    UNITY_BEGIN();
+    
+    // Policy tests
+    RUN_TEST(test_lipo_policy_matches_config);
+    RUN_TEST(test_lihv_detection);
+    RUN_TEST(test_lihv_charge_percentage);
+    RUN_TEST(test_liion_detection);
+    RUN_TEST(test_liion_charge_percentage);
+    RUN_TEST(test_lifepo4_detection);
+    RUN_TEST(test_lifepo4_charge_percentage);
+    RUN_TEST(test_chemistry_voltage_validation);
+    
+    // Dispatcher tests
+    RUN_TEST(test_selector_dispatch);
+    RUN_TEST(test_selector_cycle_and_commands);
+    
+    return UNITY_END();
+}
@@ -0,0 +1,271 @@
+#include <unity.h>
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+
+// Define UNIT_TEST before including anything
+#define UNIT_TEST
+
+// Include config first to ensure constants are defined
+#include "../../include/config.h"
+
+#include "../../include/CommandParser.h"
+#include "../../src/CommandParser.cpp"
+
+/**
+ * @brief Feed a string; returns how many commands completed, the last one in *command
+ */
+static int feedString(CommandParser& parser, const char* text, Command* command) {
+    int completed = 0;
+    for (; *text; text++) {
+        if (parser.feed(*text, command)) {
+            completed++;
+        }
+    }
+    return completed;
+}
+
+// Deterministic pseudo-random bytes for the fuzz tests
+static uint32_t lcgState = 1;
+
+static uint8_t nextByte() {
+    lcgState = lcgState * 1664525UL + 1013904223UL;
+    return (uint8_t)(lcgState >> 24);
+}
+
+void setUp(void) {
+    lcgState = 1;
+}
+
+void tearDown(void) {
+}
+
+// Test single keys outside a line still come through one by one
+void test_single_keys() {
+    CommandParser parser;
+    Command command;
+    
+    TEST_ASSERT_TRUE(parser.feed('L', &command));
+    TEST_ASSERT_EQUAL(COMMAND_KEY, command.type);
+    TEST_ASSERT_EQUAL('L', command.key);
+    TEST_ASSERT_FALSE(parser.feed('\r', &command));
+    TEST_ASSERT_FALSE(parser.feed('\n', &command));
+    TEST_ASSERT_FALSE(parser.feed(' ', &command));
+    TEST_ASSERT_TRUE(parser.feed('t', &command));
+    TEST_ASSERT_EQUAL('t', command.key);
+}
+
+// Test get, set (both separators), list, stats and help lines
+void test_line_commands() {
+    CommandParser parser;
+    Command command;
+    
+    TEST_ASSERT_EQUAL(1, feedString(parser, "$samples\n", &command));
+    TEST_ASSERT_EQUAL(COMMAND_GET, command.type);
+    TEST_ASSERT_EQUAL(SETTING_SAMPLES, command.setting);
+    TEST_ASSERT_NULL(command.value);
+    
+    TEST_ASSERT_EQUAL(1, feedString(parser, "$period=250\r", &command));
+    TEST_ASSERT_EQUAL(COMMAND_SET, command.type);
+    TEST_ASSERT_EQUAL(SETTING_PERIOD, command.setting);
+    TEST_ASSERT_EQUAL_STRING("250", command.value);
+    
+    TEST_ASSERT_EQUAL(1, feedString(parser, "$  Format   csv  \r\n", &command));
+    TEST_ASSERT_EQUAL(COMMAND_SET, command.type);
+    TEST_ASSERT_EQUAL(SETTING_FORMAT, command.setting);
+    TEST_ASSERT_EQUAL_STRING("csv", command.value);
+    
+    TEST_ASSERT_EQUAL(1, feedString(parser, "$RATIO = 7.85\n", &command));
+    TEST_ASSERT_EQUAL(COMMAND_SET, command.type);
+    TEST_ASSERT_EQUAL(SETTING_RATIO, command.setting);
+    TEST_ASSERT_EQUAL_STRING("7.85", command.value);
+    
+    TEST_ASSERT_EQUAL(1, feedString(parser, "$\n", &command));
+    TEST_ASSERT_EQUAL(COMMAND_LIST, command.type);
+    TEST_ASSERT_EQUAL(1, feedString(parser, "$stats\n", &command));
+    TEST_ASSERT_EQUAL(COMMAND_STATS, command.type);
+    TEST_ASSERT_EQUAL(1, feedString(parser, "$Help\n", &command));
+    TEST_ASSERT_EQUAL(COMMAND_HELP, command.type);
+    
+    // Keys and lines mixed in one burst
+    TEST_ASSERT_EQUAL(3, feedString(parser, "S$verbosity=3\nB", &command));
+    TEST_ASSERT_EQUAL(COMMAND_KEY, command.type);
+    TEST_ASSERT_EQUAL('B', command.key);
+}
+
+// Test malformed lines are rejected with the right reason
+void test_errors() {
+    CommandParser parser;
+    Command command;
+    
+    const char* syntax[] = { "$samples=\n", "$samples==3\n", "$samples=3 4\n", "$stats=1\n", "$help me\n", "$=5\n" };
+    for (unsigned i = 0; i < sizeof(syntax) / sizeof(syntax[0]); i++) {
+        TEST_ASSERT_EQUAL(1, feedString(parser, syntax[i], &command));
+        TEST_ASSERT_EQUAL_MESSAGE(COMMAND_ERROR, command.type, syntax[i]);
+        TEST_ASSERT_EQUAL_MESSAGE(i == 5 ? COMMAND_ERROR_UNKNOWN : COMMAND_ERROR_SYNTAX, command.error, syntax[i]);
+    }
+    
+    TEST_ASSERT_EQUAL(1, feedString(parser, "$speed=3\n", &command));
+    TEST_ASSERT_EQUAL(COMMAND_ERROR_UNKNOWN, command.error);
+    TEST_ASSERT_EQUAL(1, feedString(parser, "$sample\n", &command));
+    TEST_ASSERT_EQUAL(COMMAND_ERROR_UNKNOWN, command.error);
+    
+    // Control characters inside a line
+    TEST_ASSERT_EQUAL(1, feedString(parser, "$samples=\t3\n", &command));
+    TEST_ASSERT_EQUAL(COMMAND_ERROR_SYNTAX, command.error);
+}
+
+// Test a line longer than the buffer is dropped whole and the next one works
+void test_overflow_and_backspace() {
+    CommandParser parser;
+    Command command;
+    
+    char longLine[COMMAND_LINE_SIZE * 3];
+    longLine[0] = '$';
+    memset(longLine + 1, 'x', sizeof(longLine) - 3);
+    longLine[sizeof(longLine) - 2] = '\n';
+    longLine[sizeof(longLine) - 1] = '\0';
+    TEST_ASSERT_EQUAL(1, feedString(parser, longLine, &command));
+    TEST_ASSERT_EQUAL(COMMAND_ERROR, command.type);
+    TEST_ASSERT_EQUAL(COMMAND_ERROR_TOO_LONG, command.error);
+    
+    // Exactly COMMAND_LINE_SIZE - 1 characters still fit
+    char fullLine[COMMAND_LINE_SIZE + 2];
+    snprintf(fullLine, sizeof(fullLine), "$samples=%0*d\n", COMMAND_LINE_SIZE - 1 - 8, 7);
+    TEST_ASSERT_EQUAL(1, feedString(parser, fullLine, &command));
+    TEST_ASSERT_EQUAL(COMMAND_SET, command.type);
+    TEST_ASSERT_EQUAL(COMMAND_LINE_SIZE - 1 - 8, (int)strlen(command.value));
+    
+    // Backspace and DEL edit the line; extra ones at the start are harmless
+    TEST_ASSERT_EQUAL(1, feedString(parser, "$\b\bsamplx\bes=12\x7F" "5\n", &command));
+    TEST_ASSERT_EQUAL(COMMAND_SET, command.type);
+    TEST_ASSERT_EQUAL(SETTING_SAMPLES, command.setting);
+    TEST_ASSERT_EQUAL_STRING("15", command.value);
+}
+
+// Test number parsing accepts plain decimals only
+void test_parse_number() {
+    float value = 0.0f;
+    TEST_ASSERT_TRUE(CommandParser::parseNumber("20", &value));
+    TEST_ASSERT_EQUAL_FLOAT(20.0f, value);
+    TEST_ASSERT_TRUE(CommandParser::parseNumber("-3", &value));
+    TEST_ASSERT_EQUAL_FLOAT(-3.0f, value);
+    TEST_ASSERT_TRUE(CommandParser::parseNumber("7.85", &value));
+    TEST_ASSERT_FLOAT_WITHIN(0.0001f, 7.85f, value);
+    TEST_ASSERT_TRUE(CommandParser::parseNumber(".5", &value));
+    TEST_ASSERT_EQUAL_FLOAT(0.5f, value);
+    TEST_ASSERT_TRUE(CommandParser::parseNumber("+8.", &value));
+    TEST_ASSERT_EQUAL_FLOAT(8.0f, value);
+    
+    value = 42.0f;
+    const char* bad[] = { "", "-", ".", "1.2.3", "12a", "0x10", "1e3", "--1" };
+    for (unsigned i = 0; i < sizeof(bad) / sizeof(bad[0]); i++) {
+        TEST_ASSERT_TRUE_MESSAGE(!CommandParser::parseNumber(bad[i], &value), bad[i]);
+    }
+    TEST_ASSERT_EQUAL_FLOAT(42.0f, value);                  // Untouched on failure
+    
+    TEST_ASSERT_TRUE(CommandParser::matchesName("CSV", "csv"));
+    TEST_ASSERT_FALSE(CommandParser::matchesName("csvx", "csv"));
+    TEST_ASSERT_FALSE(CommandParser::matchesName("cs", "csv"));
+    TEST_ASSERT_EQUAL_STRING("samples", CommandParser::settingName(SETTING_SAMPLES));
+    TEST_ASSERT_EQUAL_STRING("", CommandParser::settingName(SETTING_NONE));
+}
+
+// Test integer settings reject huge, fractional and out-of-range values before converting them
+void test_whole_in_range() {
+    CommandParser parser;
+    Command command;
+    float value = 0.0f;
+    
+    TEST_ASSERT_EQUAL(1, feedString(parser, "$period 99999999999\n", &command));
+    TEST_ASSERT_EQUAL(COMMAND_SET, command.type);
+    TEST_ASSERT_EQUAL(SETTING_PERIOD, command.setting);
+    TEST_ASSERT_TRUE(CommandParser::parseNumber(command.value, &value));
+    TEST_ASSERT_FALSE(CommandParser::isWholeInRange(value, COMMAND_MIN_PERIOD_MS, COMMAND_MAX_PERIOD_MS));
+    
+    const char* rejected[] = { "-99999999999", "99999999999999999999999999", "60001", "49", "500.5", "-500" };
+    for (unsigned i = 0; i < sizeof(rejected) / sizeof(rejected[0]); i++) {
+        TEST_ASSERT_TRUE(CommandParser::parseNumber(rejected[i], &value));
+        TEST_ASSERT_TRUE_MESSAGE(!CommandParser::isWholeInRange(value, COMMAND_MIN_PERIOD_MS, COMMAND_MAX_PERIOD_MS),
+                                 rejected[i]);
+    }
+    
+    const char* accepted[] = { "50", "500", "500.0", "60000" };
+    for (unsigned i = 0; i < sizeof(accepted) / sizeof(accepted[0]); i++) {
+        TEST_ASSERT_TRUE(CommandParser::parseNumber(accepted[i], &value));
+        TEST_ASSERT_TRUE_MESSAGE(CommandParser::isWholeInRange(value, COMMAND_MIN_PERIOD_MS, COMMAND_MAX_PERIOD_MS),
+                                 accepted[i]);
+    }
+    TEST_ASSERT_TRUE(CommandParser::isWholeInRange(0.0f, 0, 0));
+    TEST_ASSERT_FALSE(CommandParser::isWholeInRange(0.5f, 0, 1));
+}
+
+// Fuzz: random bytes never produce an out-of-range command and never stick the parser
+void test_fuzz_random_bytes() {
+    CommandParser parser;
+    Command command;
+    unsigned long completed = 0;
+    
+    for (int round = 0; round < 2000; round++) {
+        int length = nextByte() % 200;
+        for (int i = 0; i < length; i++) {
+            // Bias towards the characters the grammar cares about
+            uint8_t byte = nextByte();
+            char c = (byte & 0x80) ? "$=\n\r \b\x7F" "samplesperiod0123.-"[byte % 26] : (char)nextByte();
+            if (!parser.feed(c, &command)) {
+                continue;
+            }
+            completed++;
+            TEST_ASSERT_TRUE(command.type >= COMMAND_KEY && command.type <= COMMAND_ERROR);
+            if (command.type == COMMAND_KEY) {
+                TEST_ASSERT_TRUE(command.key > ' ' && command.key < 0x7F && command.key != '$');
+            }
+            if (command.type == COMMAND_GET || command.type == COMMAND_SET) {
+                TEST_ASSERT_TRUE(command.setting >= 0 && command.setting < SETTING_COUNT);
+            }
+            if (command.type == COMMAND_SET) {
+                TEST_ASSERT_NOT_NULL(command.value);
+                TEST_ASSERT_TRUE(strlen(command.value) > 0 && strlen(command.value) < COMMAND_LINE_SIZE);
+                TEST_ASSERT_NULL(strchr(command.value, ' '));
+                TEST_ASSERT_NULL(strchr(command.value, '='));
+                
+                // Any number, however long, is range-checked as applySetting() does
+                float number;
+                if (CommandParser::parseNumber(command.value, &number) &&
+                    CommandParser::isWholeInRange(number, COMMAND_MIN_PERIOD_MS, COMMAND_MAX_PERIOD_MS)) {
+                    TEST_ASSERT_TRUE(number >= COMMAND_MIN_PERIOD_MS && number <= COMMAND_MAX_PERIOD_MS);
+                    TEST_ASSERT_EQUAL_FLOAT(floorf(number), number);
+                }
+            }
+            if (command.type == COMMAND_ERROR) {
+                TEST_ASSERT_TRUE(command.error != COMMAND_ERROR_NONE);
+            }
+        }
+        
+        // Whatever came before, a line ending resynchronizes: the next command parses
+        TEST_ASSERT_TRUE(feedString(parser, "\n$samples=12\n", &command) >= 1);
+        TEST_ASSERT_EQUAL(COMMAND_SET, command.type);
+        TEST_ASSERT_EQUAL(SETTING_SAMPLES, command.setting);
+        TEST_ASSERT_EQUAL_STRING("12", command.value);
+    }
+    
+    char message[64];
+    snprintf(message, sizeof(message), "%lu commands from random input", completed);
+    TEST_MESSAGE(message);
+    TEST_ASSERT_TRUE(completed > 0);
+}
+
+// Main test runner
+int main(int argc, char **argv) {
+    UNITY_BEGIN();
+    
+    RUN_TEST(test_single_keys);
+    RUN_TEST(test_line_commands);
+    RUN_TEST(test_errors);
+    RUN_TEST(test_overflow_and_backspace);
+    RUN_TEST(test_parse_number);
+    RUN_TEST(test_whole_in_range);
+    RUN_TEST(test_fuzz_random_bytes);
+    
+    return UNITY_END();
+}
@@ -0,0 +1,154 @@
+#include <unity.h>
+#include <stdio.h>
+
+// Define UNIT_TEST before including anything
+#define UNIT_TEST
+
+// Include config first to ensure constants are defined
+#include "../../include/config.h"
+
+#include "../../include/ConnectionWatcher.h"
+#include "../../src/ConnectionWatcher.cpp"
+
+// ESP32-C3 raw thresholds for CONNECT_THRESHOLD_V / DISCONNECT_THRESHOLD_V
+// (2.0V and 1.0V through the 7.69:1 divider, 2.962V reference, 12 bits)
+const int CONNECT_RAW = 360;
+const int DISCONNECT_RAW = 180;
+
+// Raw value of a 3S pack at 11.1V
+const int PACK_RAW = 1996;
+
+const unsigned long PLUG_TIME_MS = 1000;
+const unsigned long BOUNCE_MS = 8;
+const unsigned long UNPLUG_TIME_MS = 3000;
+
+/**
+ * @brief Simulated plug-in trace: floating input, bouncing contact, pack, removal
+ */
+static int traceSample(unsigned long t) {
+    if (t < PLUG_TIME_MS) {
+        return (int)(t % 4);                              // Divider holds input near 0
+    }
+    if (t < PLUG_TIME_MS + BOUNCE_MS) {
+        return ((t - PLUG_TIME_MS) / 2) % 2 ? 0 : PACK_RAW; // Contact bounce
+    }
+    if (t < UNPLUG_TIME_MS) {
+        return PACK_RAW + (int)(t % 7) - 3;               // Connected with noise
+    }
+    return (int)(t % 3);
+}
+
+// Test a bouncing plug-in produces exactly one connect and one disconnect
+void test_plug_in_trace_events() {
+    ConnectionWatcher watcher;
+    watcher.configure(CONNECT_RAW, DISCONNECT_RAW);
+    
+    int connects = 0;
+    int disconnects = 0;
+    unsigned long connectedAt = 0;
+    unsigned long disconnectedAt = 0;
+    
+    for (unsigned long t = 0; t < 4000; t += CONNECTION_POLL_MS) {
+        ConnectionEvent event = watcher.sample(traceSample(t), t);
+        if (event == CONNECTION_CONNECTED) {
+            connects++;
+            connectedAt = t;
+        } else if (event == CONNECTION_DISCONNECTED) {
+            disconnects++;
+            disconnectedAt = t;
+        }
+    }
+    
+    TEST_ASSERT_EQUAL(1, connects);
+    TEST_ASSERT_EQUAL(1, disconnects);
+    TEST_ASSERT_FALSE(watcher.isConnected());
+    
+    // Confirmed within the bounce plus the debounce window
+    unsigned long detectWindow = BOUNCE_MS + (CONNECT_DEBOUNCE_SAMPLES + 1) * CONNECTION_POLL_MS;
+    TEST_ASSERT_GREATER_OR_EQUAL(PLUG_TIME_MS, connectedAt);
+    TEST_ASSERT_LESS_OR_EQUAL(PLUG_TIME_MS + detectWindow, connectedAt);
+    TEST_ASSERT_LESS_OR_EQUAL(UNPLUG_TIME_MS + (CONNECT_DEBOUNCE_SAMPLES + 1) * CONNECTION_POLL_MS, disconnectedAt);
+}
+
+// Test the change time points at the start of the confirmed run
+void test_change_time_is_onset() {
+    ConnectionWatcher watcher;
+    watcher.configure(CONNECT_RAW, DISCONNECT_RAW);
+    
+    TEST_ASSERT_EQUAL(CONNECTION_NONE, watcher.sample(0, 0));
+    for (int i = 0; i < CONNECT_DEBOUNCE_SAMPLES - 1; i++) {
+        TEST_ASSERT_EQUAL(CONNECTION_NONE, watcher.sample(PACK_RAW, 100 + i * 5));
+    }
+    TEST_ASSERT_EQUAL(CONNECTION_CONNECTED, watcher.sample(PACK_RAW, 100 + (CONNECT_DEBOUNCE_SAMPLES - 1) * 5));
+    TEST_ASSERT_EQUAL(100, watcher.getChangeTime());
+}
+
+// Test isolated spikes and dropouts do not produce events
+void test_spikes_are_ignored() {
+    ConnectionWatcher watcher;
+    watcher.configure(CONNECT_RAW, DISCONNECT_RAW);
+    
+    unsigned long t = 0;
+    for (int i = 0; i < 100; i++, t += 5) {
+        int raw = (i % 10 == 0) ? PACK_RAW : 2;  // One-sample spike every 10 samples
+        TEST_ASSERT_EQUAL(CONNECTION_NONE, watcher.sample(raw, t));
+    }
+    
+    for (int i = 0; i < CONNECT_DEBOUNCE_SAMPLES; i++, t += 5) {
+        watcher.sample(PACK_RAW, t);
+    }
+    TEST_ASSERT_TRUE(watcher.isConnected());
+    
+    for (int i = 0; i < 100; i++, t += 5) {
+        int raw = (i % 10 == 0) ? 0 : PACK_RAW;  // One-sample dropout every 10 samples
+        TEST_ASSERT_EQUAL(CONNECTION_NONE, watcher.sample(raw, t));
+    }
+}
+
+// Test the debounce length is configurable and at least one sample
+void test_configured_debounce() {
+    ConnectionWatcher watcher;
+    watcher.configure(CONNECT_RAW, DISCONNECT_RAW, 6);
+    
+    unsigned long t = 0;
+    for (int i = 0; i < 5; i++, t += 5) {
+        TEST_ASSERT_EQUAL(CONNECTION_NONE, watcher.sample(PACK_RAW, t));
+    }
+    TEST_ASSERT_EQUAL(CONNECTION_CONNECTED, watcher.sample(PACK_RAW, t));
+    
+    watcher.configure(CONNECT_RAW, DISCONNECT_RAW, 0);
+    TEST_ASSERT_EQUAL(CONNECTION_DISCONNECTED, watcher.sample(0, t + 5));
+}
+
+// Test hysteresis: readings between the thresholds keep the current state
+void test_hysteresis_band() {
+    ConnectionWatcher watcher;
+    watcher.configure(CONNECT_RAW, DISCONNECT_RAW);
+    
+    const int BETWEEN = (CONNECT_RAW + DISCONNECT_RAW) / 2;
+    for (int i = 0; i < 20; i++) {
+        TEST_ASSERT_EQUAL(CONNECTION_NONE, watcher.sample(BETWEEN, i));
+    }
+    TEST_ASSERT_FALSE(watcher.isConnected());
+    
+    for (int i = 0; i < CONNECT_DEBOUNCE_SAMPLES; i++) {
+        watcher.sample(PACK_RAW, 100 + i);
+    }
+    for (int i = 0; i < 20; i++) {
+        TEST_ASSERT_EQUAL(CONNECTION_NONE, watcher.sample(BETWEEN, 200 + i));
+    }
+    TEST_ASSERT_TRUE(watcher.isConnected());
+}
+
+// Main test runner
+int main(int argc, char **argv) {
+    UNITY_BEGIN();
+    
+    RUN_TEST(test_plug_in_trace_events);
+    RUN_TEST(test_change_time_is_onset);
+    RUN_TEST(test_spikes_are_ignored);
+    RUN_TEST(test_hysteresis_band);
+    RUN_TEST(test_configured_debounce);
+    
+    return UNITY_END();
+}
@@ -0,0 +1,183 @@
+#ifndef MOCK_ADC_REGISTERS_H
+#define MOCK_ADC_REGISTERS_H
+
+#include <stdint.h>
+#include "../../include/FreeRunningAdc.h"
+
+/**
+ * @brief Simulated ATmega328P ADC behind the AdcRegisters interface
+ *
+ * Models ADEN, ADSC, ADATE (free-running trigger only), ADIF, ADIE and the
+ * prescaler: a conversion takes 13 ADC clocks (25 for the first after
+ * enabling) and, with ADATE, the next one starts as it ends. Completed
+ * conversions run FreeRunningAdc::handleInterrupt() when ADIE is set and
+ * charge isrCycles of CPU time. Time is kept in CPU cycles at cpuHz; the
+ * test advances it with run(). sleepUntilInterrupt() starts a conversion
+ * if none is running and sleeps until it completes.
+ *
+ * The input is inputCounts (as the converter would see it) plus uniform
+ * noise of +-noiseCounts, and +-cpuNoiseCounts more while the CPU is awake
+ * during the conversion (digital switching noise).
+ */
+class MockAdcRegisters : public AdcRegisters {
+public:
+    explicit MockAdcRegisters(unsigned long cpuHz = 8000000UL)
+        : cpuHz(cpuHz), isrCycles(0), inputCounts(0.0), noiseCounts(0.0), cpuNoiseCounts(0.0),
+          multiplexer(0), controlA(0), controlB(0), digitalDisable(0), result(0),
+          cycles(0), conversionEnd(0), converting(false), awakeDuringConversion(false),
+          wasEnabled(false), conversions(0), interrupts(0), sleeps(0), busyCycles(0), random(12345) {}
+    
+    void write(Register reg, uint8_t value) {
+        switch (reg) {
+            case MULTIPLEXER: multiplexer = value; break;
+            case CONTROL_B: controlB = value; break;
+            case DIGITAL_DISABLE: digitalDisable = value; break;
+            case CONTROL_A: {
+                // Writing 1 to ADIF clears it; ADSC cannot be cleared by software
+                bool clearFlag = (value & FreeRunningAdc::CONTROL_A_INTERRUPT_FLAG) != 0;
+                uint8_t flag = clearFlag ? 0 : (controlA & FreeRunningAdc::CONTROL_A_INTERRUPT_FLAG);
+                controlA = (uint8_t)((value & ~FreeRunningAdc::CONTROL_A_INTERRUPT_FLAG & ~FreeRunningAdc::CONTROL_A_START) | flag);
+                if (!enabled()) {
+                    converting = false;
+                    wasEnabled = false;
+                } else if ((value & FreeRunningAdc::CONTROL_A_START) && !converting) {
+                    startConversion();
+                }
+                break;
+            }
+        }
+    }
+    
+    uint8_t read(Register reg) {
+        switch (reg) {
+            case MULTIPLEXER: return multiplexer;
+            case CONTROL_B: return controlB;
+            case DIGITAL_DISABLE: return digitalDisable;
+            default: return (uint8_t)(controlA | (converting ? FreeRunningAdc::CONTROL_A_START : 0));
+        }
+    }
+    
+    uint16_t readResult() {
+        return result;
+    }
+    
+    void sleepUntilInterrupt() {
+        sleeps++;
+        if (!enabled()) {
+            return;
+        }
+        if (!converting) {
+            startConversion();
+        }
+        awakeDuringConversion = false;
+        // Wakes when the conversion completes (no other interrupt sources here)
+        advanceTo(conversionEnd);
+    }
+    
+    /**
+     * @brief Let CPU time pass (the CPU is awake)
+     * @param micros Time to run
+     */
+    void run(double micros) {
+        if (converting) {
+            awakeDuringConversion = true;
+        }
+        advanceTo(cycles + (unsigned long long)(micros * cpuHz / 1e6 + 0.5));
+    }
+    
+    double nowMicros() const { return cycles * 1e6 / cpuHz; }
+    bool enabled() const { return (controlA & FreeRunningAdc::CONTROL_A_ENABLE) != 0; }
+    bool isConverting() const { return converting; }
+    bool interruptEnabled() const { return (controlA & FreeRunningAdc::CONTROL_A_INTERRUPT_ENABLE) != 0; }
+    bool autoTrigger() const { return (controlA & FreeRunningAdc::CONTROL_A_AUTO_TRIGGER) != 0; }
+    bool flagSet() const { return (controlA & FreeRunningAdc::CONTROL_A_INTERRUPT_FLAG) != 0; }
+    
+    /**
+     * @brief Share of the elapsed CPU time spent in the interrupt
+     */
+    double interruptLoad() const { return cycles ? (double)busyCycles / cycles : 0.0; }
+    
+    unsigned long cpuHz;
+    unsigned long isrCycles;         // CPU cycles charged per interrupt
+    double inputCounts;
+    double noiseCounts;
+    double cpuNoiseCounts;
+    
+    uint8_t multiplexer;
+    uint8_t controlA;                // ADSC is tracked by converting
+    uint8_t controlB;
+    uint8_t digitalDisable;
+    uint16_t result;
+    
+    unsigned long long cycles;
+    unsigned long long conversionEnd;
+    bool converting;
+    bool awakeDuringConversion;
+    bool wasEnabled;                 // A conversion ran since ADEN was set
+    
+    unsigned long conversions;
+    unsigned long interrupts;
+    unsigned long sleeps;
+    unsigned long long busyCycles;
+
+private:
+    unsigned long long conversionCycles(bool first) const {
+        int division = FreeRunningAdc::prescalerDivision(controlA);
+        return (unsigned long long)(first ? 25 : 13) * division;
+    }
+    
+    void startConversion() {
+        conversionEnd = cycles + conversionCycles(!wasEnabled);
+        wasEnabled = true;
+        converting = true;
+        awakeDuringConversion = false;
+    }
+    
+    double uniform() {
+        random = random * 1103515245UL + 12345UL;
+        return ((random >> 8) & 0xFFFF) / 32767.5 - 1.0;
+    }
+    
+    uint16_t sample() {
+        double value = inputCounts + uniform() * noiseCounts;
+        if (awakeDuringConversion) {
+            value += uniform() * cpuNoiseCounts;
+        }
+        value += 0.5;
+        return (uint16_t)(value < 0.0 ? 0 : value > 1023.0 ? 1023 : value);
+    }
+    
+    void advanceTo(unsigned long long target) {
+        while (converting && conversionEnd <= target) {
+            cycles = conversionEnd;
+            result = sample();
+            conversions++;
+            controlA |= FreeRunningAdc::CONTROL_A_INTERRUPT_FLAG;
+            if (autoTrigger()) {
+                // Free running: the next conversion starts as this one ends
+                conversionEnd = cycles + conversionCycles(false);
+            } else {
+                converting = false;
+            }
+            if (interruptEnabled()) {
+                // The flag clears when the interrupt vector runs
+                controlA &= ~FreeRunningAdc::CONTROL_A_INTERRUPT_FLAG;
+                interrupts++;
+                FreeRunningAdc::handleInterrupt();
+                cycles += isrCycles;
+                busyCycles += isrCycles;
+                if (target < cycles) {
+                    target = cycles;
+                }
+            }
+            awakeDuringConversion = true;
+        }
+        if (cycles < target) {
+            cycles = target;
+        }
+    }
+    
+    uint32_t random;
+};
+
+#endif // MOCK_ADC_REGISTERS_H
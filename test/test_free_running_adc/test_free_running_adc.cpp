@@ -0,0 +1,255 @@
+#include <unity.h>
+#include <stdio.h>
+#include <math.h>
+
+// Define UNIT_TEST before including anything
+#define UNIT_TEST
+
+// Include config first to ensure constants are defined
+#include "../../include/config.h"
+
+#include "../../include/FreeRunningAdc.h"
+#include "../../src/FreeRunningAdc.cpp"
+#include "MockAdcRegisters.h"
+
+// 8 MHz / 64: 13 ADC clocks = 104 us per conversion
+const int PRESCALER = 64;
+const double CONVERSION_US = 104.0;
+
+void setUp(void) {
+}
+
+void tearDown(void) {
+}
+
+void test_prescaler_bits(void) {
+    TEST_ASSERT_EQUAL(1, FreeRunningAdc::prescalerBits(2));
+    TEST_ASSERT_EQUAL(6, FreeRunningAdc::prescalerBits(64));
+    TEST_ASSERT_EQUAL(7, FreeRunningAdc::prescalerBits(128));
+    // Unsupported divisions round up to the next slower clock
+    TEST_ASSERT_EQUAL(6, FreeRunningAdc::prescalerBits(50));
+    TEST_ASSERT_EQUAL(7, FreeRunningAdc::prescalerBits(1000));
+    
+    TEST_ASSERT_EQUAL(2, FreeRunningAdc::prescalerDivision(0));
+    TEST_ASSERT_EQUAL(2, FreeRunningAdc::prescalerDivision(1));
+    TEST_ASSERT_EQUAL(128, FreeRunningAdc::prescalerDivision(7));
+    
+    MockAdcRegisters registers;
+    FreeRunningAdc adc(registers, 0, PRESCALER, 16, false);
+    TEST_ASSERT_EQUAL(104, adc.getConversionMicros(8000000UL));
+    TEST_ASSERT_EQUAL(52, adc.getConversionMicros(16000000UL));
+}
+
+void test_begin_configures_free_running(void) {
+    MockAdcRegisters registers;
+    registers.digitalDisable = 0x01;
+    FreeRunningAdc adc(registers, 2, PRESCALER, 16, false);
+    adc.begin();
+    
+    TEST_ASSERT_EQUAL_HEX8(0x42, registers.multiplexer);       // AVcc reference, ADC2
+    TEST_ASSERT_EQUAL_HEX8(0x00, registers.controlB);          // Free-running trigger
+    TEST_ASSERT_EQUAL_HEX8(0x05, registers.digitalDisable);    // ADC2 buffer off, others kept
+    TEST_ASSERT_TRUE(registers.enabled());
+    TEST_ASSERT_TRUE(registers.autoTrigger());
+    TEST_ASSERT_TRUE(registers.interruptEnabled());
+    TEST_ASSERT_TRUE(registers.isConverting());
+    TEST_ASSERT_EQUAL(6, registers.controlA & FreeRunningAdc::CONTROL_A_PRESCALER_MASK);
+}
+
+void test_blocks_average_the_input(void) {
+    MockAdcRegisters registers;
+    registers.inputCounts = 512.0;
+    FreeRunningAdc adc(registers, 0, PRESCALER, 16, false);
+    adc.begin();
+    
+    adc.startBatch();
+    TEST_ASSERT_FALSE(adc.poll());
+    
+    // 25 clocks for the first conversion, 13 for each of the other 15
+    registers.run(16 * CONVERSION_US + 12 * 8.0 + 1.0);
+    TEST_ASSERT_EQUAL(16, registers.interrupts);
+    TEST_ASSERT_TRUE(adc.poll());
+    TEST_ASSERT_FALSE(adc.poll());
+    TEST_ASSERT_EQUAL(16, adc.getBatchCount());
+    TEST_ASSERT_EQUAL(512, adc.getBatchAverage());
+    TEST_ASSERT_EQUAL(512, adc.getLatest());
+    TEST_ASSERT_EQUAL(0, adc.getDroppedBlocks());
+}
+
+void test_batch_spans_blocks(void) {
+    MockAdcRegisters registers;
+    registers.inputCounts = 100.0;
+    FreeRunningAdc adc(registers, 0, PRESCALER, 4, false);
+    adc.begin();
+    adc.startBatch();
+    
+    while (adc.getBatchCount() < 10) {
+        if (!adc.poll()) {
+            registers.run(20.0);
+        }
+    }
+    // Whole blocks only
+    TEST_ASSERT_EQUAL(12, adc.getBatchCount());
+    TEST_ASSERT_EQUAL(100, adc.getBatchAverage());
+    TEST_ASSERT_EQUAL(0, adc.getDroppedBlocks());
+}
+
+void test_late_reader_gets_newest_block(void) {
+    MockAdcRegisters registers;
+    FreeRunningAdc adc(registers, 0, PRESCALER, 4, false);
+    adc.begin();
+    
+    registers.inputCounts = 100.0;
+    registers.run(4 * CONVERSION_US + 100.0);
+    registers.inputCounts = 200.0;
+    registers.run(4 * CONVERSION_US);
+    registers.inputCounts = 300.0;
+    registers.run(4 * CONVERSION_US);
+    TEST_ASSERT_EQUAL(12, registers.conversions);
+    
+    adc.startBatch();
+    TEST_ASSERT_TRUE(adc.poll());
+    TEST_ASSERT_EQUAL(4, adc.getBatchCount());
+    TEST_ASSERT_EQUAL(300, adc.getBatchAverage());
+    TEST_ASSERT_EQUAL(2, adc.getDroppedBlocks());
+    TEST_ASSERT_FALSE(adc.poll());
+}
+
+void test_block_being_filled_is_not_read(void) {
+    MockAdcRegisters registers;
+    FreeRunningAdc adc(registers, 0, PRESCALER, 4, false);
+    adc.begin();
+    registers.write(AdcRegisters::CONTROL_A, 0);    // Feed conversions by hand
+    
+    for (int i = 0; i < 4; i++) adc.onConversion(10);
+    for (int i = 0; i < 3; i++) adc.onConversion(1000);
+    adc.startBatch();
+    TEST_ASSERT_TRUE(adc.poll());
+    TEST_ASSERT_EQUAL(10, adc.getBatchAverage());
+    
+    adc.onConversion(1000);
+    TEST_ASSERT_TRUE(adc.poll());
+    TEST_ASSERT_EQUAL(8, adc.getBatchCount());
+    TEST_ASSERT_EQUAL(505, adc.getBatchAverage());
+}
+
+void test_counter_wraps(void) {
+    MockAdcRegisters registers;
+    FreeRunningAdc adc(registers, 0, PRESCALER, 1, false);
+    adc.begin();
+    registers.write(AdcRegisters::CONTROL_A, 0);
+    
+    // 1000 blocks, taken one by one across the 8-bit counter's wrap
+    for (int i = 0; i < 1000; i++) {
+        adc.onConversion((uint16_t)(i & 0x3FF));
+        adc.startBatch();
+        TEST_ASSERT_TRUE(adc.poll());
+        TEST_ASSERT_EQUAL(i & 0x3FF, adc.getBatchAverage());
+    }
+    TEST_ASSERT_EQUAL(0, adc.getDroppedBlocks());
+}
+
+void test_oversample_limits(void) {
+    MockAdcRegisters registers;
+    FreeRunningAdc adc(registers, 0, PRESCALER, 1000, false);
+    adc.begin();
+    registers.write(AdcRegisters::CONTROL_A, 0);
+    
+    // Full-scale conversions do not overflow the 16-bit block sum
+    for (int i = 0; i < FreeRunningAdc::MAX_OVERSAMPLE; i++) adc.onConversion(1023);
+    adc.startBatch();
+    TEST_ASSERT_TRUE(adc.poll());
+    TEST_ASSERT_EQUAL(FreeRunningAdc::MAX_OVERSAMPLE, adc.getBatchCount());
+    TEST_ASSERT_EQUAL(1023, adc.getBatchAverage());
+    
+    FreeRunningAdc single(registers, 0, PRESCALER, 0, false);
+    single.begin();
+    registers.write(AdcRegisters::CONTROL_A, 0);
+    single.onConversion(7);
+    TEST_ASSERT_TRUE(single.poll());
+    TEST_ASSERT_EQUAL(1, single.getBatchCount());
+}
+
+void test_noise_sleep_converts_per_idle(void) {
+    MockAdcRegisters registers;
+    registers.inputCounts = 700.0;
+    FreeRunningAdc adc(registers, 0, PRESCALER, 4, true);
+    adc.begin();
+    
+    TEST_ASSERT_FALSE(registers.autoTrigger());
+    TEST_ASSERT_TRUE(registers.interruptEnabled());
+    TEST_ASSERT_FALSE(registers.isConverting());
+    
+    registers.run(10000.0);
+    TEST_ASSERT_EQUAL(0, registers.conversions);
+    
+    adc.startBatch();
+    while (adc.getBatchCount() < 4) {
+        if (!adc.poll()) {
+            adc.idle();
+        }
+    }
+    TEST_ASSERT_EQUAL(4, registers.sleeps);
+    TEST_ASSERT_EQUAL(4, registers.conversions);
+    TEST_ASSERT_EQUAL(700, adc.getBatchAverage());
+}
+
+void test_noise_sleep_keeps_cpu_noise_out(void) {
+    MockAdcRegisters awake;
+    MockAdcRegisters asleep;
+    awake.inputCounts = asleep.inputCounts = 400.0;
+    awake.cpuNoiseCounts = asleep.cpuNoiseCounts = 8.0;
+    FreeRunningAdc freeRunning(awake, 0, PRESCALER, 1, false);
+    FreeRunningAdc sleeping(asleep, 0, PRESCALER, 1, true);
+    
+    double awakeError = 0.0, asleepError = 0.0;
+    freeRunning.begin();
+    for (int i = 0; i < 200; i++) {
+        awake.run(CONVERSION_US);
+        awakeError += fabs(freeRunning.getLatest() - 400.0);
+    }
+    sleeping.begin();
+    for (int i = 0; i < 200; i++) {
+        sleeping.idle();
+        asleepError += fabs(sleeping.getLatest() - 400.0);
+    }
+    TEST_ASSERT_TRUE(awakeError > 200.0);
+    TEST_ASSERT_EQUAL_FLOAT(0.0, asleepError);
+}
+
+void test_end_restores_analog_read(void) {
+    MockAdcRegisters registers;
+    FreeRunningAdc adc(registers, 1, PRESCALER, 4, false);
+    adc.begin();
+    registers.run(1000.0);
+    adc.end();
+    
+    TEST_ASSERT_TRUE(registers.enabled());
+    TEST_ASSERT_FALSE(registers.autoTrigger());
+    TEST_ASSERT_FALSE(registers.interruptEnabled());
+    TEST_ASSERT_EQUAL(6, registers.controlA & FreeRunningAdc::CONTROL_A_PRESCALER_MASK);
+    TEST_ASSERT_EQUAL_HEX8(0x00, registers.digitalDisable);
+    
+    // A conversion still in flight no longer reaches the backend
+    unsigned long interrupts = registers.interrupts;
+    registers.run(1000.0);
+    TEST_ASSERT_EQUAL(interrupts, registers.interrupts);
+}
+
+int main(int argc, char **argv) {
+    UNITY_BEGIN();
+    
+    RUN_TEST(test_prescaler_bits);
+    RUN_TEST(test_begin_configures_free_running);
+    RUN_TEST(test_blocks_average_the_input);
+    RUN_TEST(test_batch_spans_blocks);
+    RUN_TEST(test_late_reader_gets_newest_block);
+    RUN_TEST(test_block_being_filled_is_not_read);
+    RUN_TEST(test_counter_wraps);
+    RUN_TEST(test_oversample_limits);
+    RUN_TEST(test_noise_sleep_converts_per_idle);
+    RUN_TEST(test_noise_sleep_keeps_cpu_noise_out);
+    RUN_TEST(test_end_restores_analog_read);
+    
+    return UNITY_END();
+}
@@ -0,0 +1,86 @@
+#ifndef SIMULATED_I2C_BUS_H
+#define SIMULATED_I2C_BUS_H
+
+#include <vector>
+#include "../../include/I2cBus.h"
+#include "../../include/I2cScheduler.h"
+
+/**
+ * @brief Simulated I2C bus with timing
+ *
+ * Every transaction takes its bit time at clockHz (I2cScheduler's model)
+ * and advances nowUs. Transactions are logged with their bytes and times;
+ * reads return a per-device counter. Addresses not in the device list do
+ * not acknowledge.
+ */
+class SimulatedI2cBus : public I2cBus {
+public:
+    struct Transfer {
+        uint8_t address;
+        bool isRead;
+        std::vector<uint8_t> bytes;
+        double startUs;
+        double endUs;
+    };
+    
+    explicit SimulatedI2cBus(unsigned long clockHz = 400000) : clockHz(clockHz), nowUs(0.0), counter(0) {}
+    
+    void addDevice(uint8_t address) { devices.push_back(address); }
+    
+    bool write(uint8_t address, const uint8_t* data, uint8_t length) {
+        Transfer transfer = begin(address, false, length);
+        transfer.bytes.assign(data, data + length);
+        log.push_back(transfer);
+        return present(address);
+    }
+    
+    bool read(uint8_t address, uint8_t* data, uint8_t length) {
+        Transfer transfer = begin(address, true, length);
+        for (int i = 0; i < length; i++) {
+            data[i] = counter++;
+            transfer.bytes.push_back(data[i]);
+        }
+        log.push_back(transfer);
+        return present(address);
+    }
+    
+    bool present(uint8_t address) const {
+        for (size_t i = 0; i < devices.size(); i++) {
+            if (devices[i] == address) return true;
+        }
+        return false;
+    }
+    
+    /**
+     * @brief Concatenate the bytes written to a device, dropping the first byte of each write
+     */
+    std::vector<uint8_t> payload(uint8_t address, uint8_t prefix) const {
+        std::vector<uint8_t> bytes;
+        for (size_t i = 0; i < log.size(); i++) {
+            if (log[i].address == address && !log[i].isRead && !log[i].bytes.empty() && log[i].bytes[0] == prefix) {
+                bytes.insert(bytes.end(), log[i].bytes.begin() + 1, log[i].bytes.end());
+            }
+        }
+        return bytes;
+    }
+    
+    unsigned long clockHz;
+    double nowUs;
+    std::vector<uint8_t> devices;
+    std::vector<Transfer> log;
+
+private:
+    Transfer begin(uint8_t address, bool isRead, uint8_t length) {
+        Transfer transfer;
+        transfer.address = address;
+        transfer.isRead = isRead;
+        transfer.startUs = nowUs;
+        nowUs += I2cScheduler::transferMicros(length, clockHz);
+        transfer.endUs = nowUs;
+        return transfer;
+    }
+    
+    uint8_t counter;
+};
+
+#endif // SIMULATED_I2C_BUS_H
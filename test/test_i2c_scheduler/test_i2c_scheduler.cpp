@@ -0,0 +1,250 @@
+#include <unity.h>
+#include <stdio.h>
+
+// Define UNIT_TEST before including anything
+#define UNIT_TEST
+
+// Include config first to ensure constants are defined
+#include "../../include/config.h"
+
+#include "../../include/I2cScheduler.h"
+#include "../../src/I2cScheduler.cpp"
+#include "SimulatedI2cBus.h"
+
+const uint8_t DISPLAY_ADDRESS = 0x3C;
+const uint8_t SENSOR_ADDRESS = 0x48;
+const uint8_t DATA_PREFIX = 0x40;     // SSD1306 data control byte
+const int FRAME_BYTES = 512;          // 128x32 framebuffer
+
+static uint8_t frame[FRAME_BYTES];
+
+static I2cTransaction makeFrame() {
+    I2cTransaction transaction = { DISPLAY_ADDRESS, I2C_PRIORITY_DISPLAY, false, true, DATA_PREFIX,
+                                   frame, FRAME_BYTES, I2C_STATUS_IDLE, 0, 0 };
+    return transaction;
+}
+
+static I2cTransaction makeSensorRead(uint8_t* buffer) {
+    I2cTransaction transaction = { SENSOR_ADDRESS, I2C_PRIORITY_SENSOR, true, false, 0,
+                                   buffer, 2, I2C_STATUS_IDLE, 0, 0 };
+    return transaction;
+}
+
+/**
+ * @brief Main loop stand-in: poll, or let time pass while the bus is idle
+ */
+static void runUntil(I2cScheduler& scheduler, SimulatedI2cBus& bus, double endUs) {
+    while (bus.nowUs < endUs) {
+        if (!scheduler.poll((unsigned long)bus.nowUs)) {
+            bus.nowUs += 10.0;
+        }
+    }
+}
+
+void setUp(void) {
+    for (int i = 0; i < FRAME_BYTES; i++) {
+        frame[i] = (uint8_t)(i * 7);
+    }
+}
+
+void tearDown(void) {
+}
+
+void test_transfer_time_model(void) {
+    // 2 data bytes: start + 3 * 9 bits + stop = 29 bits
+    TEST_ASSERT_EQUAL(73, I2cScheduler::transferMicros(2, 400000));
+    TEST_ASSERT_EQUAL(290, I2cScheduler::transferMicros(2, 100000));
+    
+    // Unchunked 128x32 frame: ~11.6ms of bus time at 400kHz
+    TEST_ASSERT_INT_WITHIN(100, 11600, I2cScheduler::transferMicros(FRAME_BYTES + 1, 400000));
+}
+
+void test_display_write_is_chunked(void) {
+    SimulatedI2cBus bus;
+    bus.addDevice(DISPLAY_ADDRESS);
+    I2cScheduler scheduler(bus);
+    I2cTransaction write = makeFrame();
+    
+    TEST_ASSERT_TRUE(scheduler.submit(&write, 0));
+    TEST_ASSERT_EQUAL(I2C_STATUS_PENDING, write.status);
+    scheduler.drain(0);
+    
+    TEST_ASSERT_EQUAL(I2C_STATUS_DONE, write.status);
+    TEST_ASSERT_TRUE(scheduler.isIdle());
+    TEST_ASSERT_EQUAL(FRAME_BYTES / I2C_CHUNK_BYTES, bus.log.size());
+    for (size_t i = 0; i < bus.log.size(); i++) {
+        TEST_ASSERT_LESS_OR_EQUAL(I2C_CHUNK_BYTES + 1, bus.log[i].bytes.size());
+    }
+    
+    std::vector<uint8_t> payload = bus.payload(DISPLAY_ADDRESS, DATA_PREFIX);
+    TEST_ASSERT_EQUAL(FRAME_BYTES, payload.size());
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(frame, &payload[0], FRAME_BYTES);
+    
+    I2cDeviceStats stats;
+    TEST_ASSERT_TRUE(scheduler.getDeviceStats(DISPLAY_ADDRESS, &stats));
+    TEST_ASSERT_EQUAL(1, stats.transactions);
+    TEST_ASSERT_EQUAL(FRAME_BYTES + FRAME_BYTES / I2C_CHUNK_BYTES, stats.bytes);
+    TEST_ASSERT_EQUAL(scheduler.getBusyMicros(), stats.maxLatencyUs);
+}
+
+void test_sensor_runs_between_chunks(void) {
+    SimulatedI2cBus bus;
+    bus.addDevice(DISPLAY_ADDRESS);
+    bus.addDevice(SENSOR_ADDRESS);
+    I2cScheduler scheduler(bus);
+    I2cTransaction write = makeFrame();
+    uint8_t buffer[2];
+    I2cTransaction sensor = makeSensorRead(buffer);
+    
+    scheduler.submit(&write, 0);
+    TEST_ASSERT_TRUE(scheduler.poll((unsigned long)bus.nowUs));   // First display chunk
+    scheduler.submit(&sensor, (unsigned long)bus.nowUs);
+    TEST_ASSERT_TRUE(scheduler.poll((unsigned long)bus.nowUs));   // Sensor goes next
+    
+    TEST_ASSERT_EQUAL(I2C_STATUS_DONE, sensor.status);
+    TEST_ASSERT_EQUAL(SENSOR_ADDRESS, bus.log[1].address);
+    TEST_ASSERT_TRUE(bus.log[1].isRead);
+    TEST_ASSERT_EQUAL(I2C_STATUS_PENDING, write.status);
+    
+    scheduler.drain((unsigned long)bus.nowUs);
+    TEST_ASSERT_EQUAL(FRAME_BYTES, bus.payload(DISPLAY_ADDRESS, DATA_PREFIX).size());
+}
+
+void test_sensor_latency_bounded_under_display_load(void) {
+    SimulatedI2cBus bus;
+    bus.addDevice(DISPLAY_ADDRESS);
+    bus.addDevice(SENSOR_ADDRESS);
+    I2cScheduler scheduler(bus);
+    I2cTransaction write = makeFrame();
+    uint8_t buffer[2];
+    I2cTransaction sensor = makeSensorRead(buffer);
+    
+    // 200ms: a sensor read due every 1ms, a new frame every 20ms (display always busy).
+    // A read falling due while a chunk is on the bus is submitted after it, but
+    // its latency counts from when it fell due.
+    for (int ms = 0; ms < 200; ms++) {
+        if (ms % 20 == 0) {
+            scheduler.submit(&write, (unsigned long)bus.nowUs);
+        }
+        if (sensor.status != I2C_STATUS_PENDING) {
+            scheduler.submit(&sensor, ms * 1000UL);
+        }
+        runUntil(scheduler, bus, ms * 1000.0 + 1000.0);
+    }
+    
+    I2cDeviceStats sensorStats, displayStats;
+    TEST_ASSERT_TRUE(scheduler.getDeviceStats(SENSOR_ADDRESS, &sensorStats));
+    TEST_ASSERT_TRUE(scheduler.getDeviceStats(DISPLAY_ADDRESS, &displayStats));
+    
+    unsigned long chunkUs = I2cScheduler::transferMicros(I2C_CHUNK_BYTES + 1, bus.clockHz);
+    unsigned long readUs = I2cScheduler::transferMicros(2, bus.clockHz);
+    unsigned long unchunkedUs = I2cScheduler::transferMicros(FRAME_BYTES + 1, bus.clockHz);
+    
+    char message[160];
+    snprintf(message, sizeof(message),
+             "Sensor latency max %lu us avg %lu us (unchunked frame would block %lu us); display frames %lu, max %lu us",
+             sensorStats.maxLatencyUs, sensorStats.totalLatencyUs / sensorStats.transactions, unchunkedUs,
+             displayStats.transactions, displayStats.maxLatencyUs);
+    TEST_MESSAGE(message);
+    
+    TEST_ASSERT_EQUAL(200, sensorStats.transactions);
+    TEST_ASSERT_EQUAL(10, displayStats.transactions);
+    TEST_ASSERT_LESS_OR_EQUAL(chunkUs + readUs + 1, sensorStats.maxLatencyUs);
+    TEST_ASSERT_LESS_THAN(unchunkedUs / 10, sensorStats.maxLatencyUs);
+}
+
+void test_resubmit_restarts_transaction(void) {
+    SimulatedI2cBus bus;
+    bus.addDevice(DISPLAY_ADDRESS);
+    I2cScheduler scheduler(bus);
+    I2cTransaction write = makeFrame();
+    
+    scheduler.submit(&write, 0);
+    for (int i = 0; i < 3; i++) {
+        scheduler.poll((unsigned long)bus.nowUs);
+    }
+    TEST_ASSERT_EQUAL(3 * I2C_CHUNK_BYTES, write.offset);
+    
+    // The frame changed while being sent: start over
+    frame[0] = 0xAA;
+    TEST_ASSERT_TRUE(scheduler.submit(&write, (unsigned long)bus.nowUs));
+    TEST_ASSERT_EQUAL(0, write.offset);
+    scheduler.drain((unsigned long)bus.nowUs);
+    
+    std::vector<uint8_t> payload = bus.payload(DISPLAY_ADDRESS, DATA_PREFIX);
+    TEST_ASSERT_EQUAL(3 * I2C_CHUNK_BYTES + FRAME_BYTES, payload.size());
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(frame, &payload[3 * I2C_CHUNK_BYTES], FRAME_BYTES);
+}
+
+void test_queue_full_and_cancel(void) {
+    SimulatedI2cBus bus;
+    bus.addDevice(SENSOR_ADDRESS);
+    I2cScheduler scheduler(bus);
+    uint8_t buffers[I2C_QUEUE_DEPTH + 1][2];
+    I2cTransaction reads[I2C_QUEUE_DEPTH + 1];
+    
+    for (int i = 0; i < I2C_QUEUE_DEPTH; i++) {
+        reads[i] = makeSensorRead(buffers[i]);
+        reads[i].address = (uint8_t)(SENSOR_ADDRESS + i);
+        TEST_ASSERT_TRUE(scheduler.submit(&reads[i], 0));
+    }
+    reads[I2C_QUEUE_DEPTH] = makeSensorRead(buffers[I2C_QUEUE_DEPTH]);
+    TEST_ASSERT_FALSE(scheduler.submit(&reads[I2C_QUEUE_DEPTH], 0));
+    
+    // Reads longer than a chunk are rejected
+    I2cTransaction longRead = makeSensorRead(frame);
+    longRead.length = I2C_CHUNK_BYTES + 1;
+    longRead.priority = I2C_PRIORITY_DISPLAY;
+    TEST_ASSERT_FALSE(scheduler.submit(&longRead, 0));
+    
+    scheduler.cancel(&reads[1]);
+    TEST_ASSERT_EQUAL(I2C_STATUS_IDLE, reads[1].status);
+    scheduler.drain(0);
+    
+    TEST_ASSERT_EQUAL(I2C_QUEUE_DEPTH - 1, bus.log.size());
+    TEST_ASSERT_EQUAL(SENSOR_ADDRESS, bus.log[0].address);
+    TEST_ASSERT_EQUAL(SENSOR_ADDRESS + 2, bus.log[1].address);
+    TEST_ASSERT_EQUAL(SENSOR_ADDRESS + 3, bus.log[2].address);
+}
+
+void test_immediate_calls_and_failures(void) {
+    SimulatedI2cBus bus;
+    bus.addDevice(SENSOR_ADDRESS);
+    I2cScheduler scheduler(bus);
+    
+    // Immediate calls act as a plain bus and are accounted
+    uint8_t data[2];
+    TEST_ASSERT_TRUE(scheduler.read(SENSOR_ADDRESS, data, 2));
+    TEST_ASSERT_TRUE(scheduler.write(SENSOR_ADDRESS, data, 1));
+    I2cDeviceStats stats;
+    TEST_ASSERT_TRUE(scheduler.getDeviceStats(SENSOR_ADDRESS, &stats));
+    TEST_ASSERT_EQUAL(2, stats.transactions);
+    TEST_ASSERT_EQUAL(3, stats.bytes);
+    
+    // Missing display: the first chunk fails and the rest is dropped
+    I2cTransaction write = makeFrame();
+    scheduler.submit(&write, (unsigned long)bus.nowUs);
+    scheduler.drain((unsigned long)bus.nowUs);
+    TEST_ASSERT_EQUAL(I2C_STATUS_FAILED, write.status);
+    TEST_ASSERT_TRUE(scheduler.getDeviceStats(DISPLAY_ADDRESS, &stats));
+    TEST_ASSERT_EQUAL(1, stats.errors);
+    TEST_ASSERT_EQUAL(0, stats.transactions);
+    TEST_ASSERT_EQUAL(3, bus.log.size());
+    
+    TEST_ASSERT_FALSE(scheduler.getDeviceStats(0x11, &stats));
+}
+
+// Main test runner
+int main(int argc, char **argv) {
+    UNITY_BEGIN();
+    
+    RUN_TEST(test_transfer_time_model);
+    RUN_TEST(test_display_write_is_chunked);
+    RUN_TEST(test_sensor_runs_between_chunks);
+    RUN_TEST(test_sensor_latency_bounded_under_display_load);
+    RUN_TEST(test_resubmit_restarts_transaction);
+    RUN_TEST(test_queue_full_and_cancel);
+    RUN_TEST(test_immediate_calls_and_failures);
+    
+    return UNITY_END();
+}
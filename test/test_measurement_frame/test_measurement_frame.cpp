@@ -0,0 +1,122 @@
+#include <unity.h>
+#include <string.h>
+
+// Define UNIT_TEST before including anything
+#define UNIT_TEST
+
+// Include config first to ensure constants are defined
+#include "../../include/config.h"
+
+#include "../../include/MeasurementFrame.h"
+#include "../../src/MeasurementFrame.cpp"
+
+static MeasurementFrame sampleFrame() {
+    MeasurementFrame frame;
+    frame.timeMs = 4000000123UL;          // Past 2^31, close to the millis() wrap
+    frame.raw = 2101;
+    frame.millivolts = 12345;
+    frame.cellCount = 3;
+    frame.confidence = 97;
+    frame.cellMillivolts = 4115;
+    frame.charge = 85;
+    frame.flags = MEASUREMENT_FRAME_TREND;
+    frame.trendDeciMvPerMin = -325;
+    frame.minutesToEmpty = -1;
+    return frame;
+}
+
+static void assertFramesEqual(const MeasurementFrame& expected, const MeasurementFrame& actual) {
+    TEST_ASSERT_EQUAL_UINT32(expected.timeMs, actual.timeMs);
+    TEST_ASSERT_EQUAL_UINT16(expected.raw, actual.raw);
+    TEST_ASSERT_EQUAL_UINT16(expected.millivolts, actual.millivolts);
+    TEST_ASSERT_EQUAL_UINT8(expected.cellCount, actual.cellCount);
+    TEST_ASSERT_EQUAL_UINT8(expected.confidence, actual.confidence);
+    TEST_ASSERT_EQUAL_UINT16(expected.cellMillivolts, actual.cellMillivolts);
+    TEST_ASSERT_EQUAL_UINT8(expected.charge, actual.charge);
+    TEST_ASSERT_EQUAL_UINT8(expected.flags, actual.flags);
+    TEST_ASSERT_EQUAL_INT16(expected.trendDeciMvPerMin, actual.trendDeciMvPerMin);
+    TEST_ASSERT_EQUAL_INT16(expected.minutesToEmpty, actual.minutesToEmpty);
+}
+
+void setUp(void) {
+}
+
+void tearDown(void) {
+}
+
+// Test a frame survives encoding, including negative and 32-bit fields
+void test_round_trip() {
+    MeasurementFrame frame = sampleFrame();
+    uint8_t bytes[MeasurementFrameCodec::FRAME_SIZE];
+    TEST_ASSERT_EQUAL(22, MeasurementFrameCodec::encode(frame, bytes));
+    TEST_ASSERT_EQUAL_HEX8(0xA5, bytes[0]);
+    TEST_ASSERT_EQUAL_HEX8(0x5A, bytes[1]);
+    
+    MeasurementFrame decoded;
+    TEST_ASSERT_TRUE(MeasurementFrameCodec::decode(bytes, &decoded));
+    assertFramesEqual(frame, decoded);
+    
+    frame.timeMs = 0;
+    frame.millivolts = 65535;
+    frame.trendDeciMvPerMin = 32767;
+    frame.minutesToEmpty = 32767;
+    MeasurementFrameCodec::encode(frame, bytes);
+    TEST_ASSERT_TRUE(MeasurementFrameCodec::decode(bytes, &decoded));
+    assertFramesEqual(frame, decoded);
+}
+
+// Test the byte layout is little endian at fixed offsets (the host tools depend on it)
+void test_layout() {
+    MeasurementFrame frame = sampleFrame();
+    uint8_t bytes[MeasurementFrameCodec::FRAME_SIZE];
+    MeasurementFrameCodec::encode(frame, bytes);
+    
+    TEST_ASSERT_EQUAL_HEX8(MeasurementFrameCodec::TYPE_MEASUREMENT, bytes[2]);
+    TEST_ASSERT_EQUAL_HEX8(4000000123UL & 0xFF, bytes[3]);
+    TEST_ASSERT_EQUAL_HEX8(4000000123UL >> 24, bytes[6]);
+    TEST_ASSERT_EQUAL_HEX8(2101 & 0xFF, bytes[7]);
+    TEST_ASSERT_EQUAL_HEX8(2101 >> 8, bytes[8]);
+    TEST_ASSERT_EQUAL_HEX8(3, bytes[11]);
+    TEST_ASSERT_EQUAL_HEX8(0xFF, bytes[19]);          // minutesToEmpty = -1
+    TEST_ASSERT_EQUAL_HEX8(0xFF, bytes[20]);
+    TEST_ASSERT_EQUAL_HEX8(MeasurementFrameCodec::crc8(bytes + 2, 19), bytes[21]);
+}
+
+// Test every single-bit error is detected
+void test_bit_flips_rejected() {
+    MeasurementFrame frame = sampleFrame();
+    uint8_t bytes[MeasurementFrameCodec::FRAME_SIZE];
+    MeasurementFrameCodec::encode(frame, bytes);
+    
+    for (int i = 0; i < MeasurementFrameCodec::FRAME_SIZE; i++) {
+        for (int bit = 0; bit < 8; bit++) {
+            bytes[i] ^= (uint8_t)(1 << bit);
+            MeasurementFrame decoded;
+            TEST_ASSERT_TRUE_MESSAGE(!MeasurementFrameCodec::decode(bytes, &decoded), "bit flip accepted");
+            bytes[i] ^= (uint8_t)(1 << bit);
+        }
+    }
+}
+
+// Test the sync bytes cannot appear in the text output
+void test_sync_not_ascii() {
+    TEST_ASSERT_TRUE(MeasurementFrameCodec::SYNC_0 > 0x7F);
+    
+    // A text line made of the same bytes is not a frame
+    uint8_t text[MeasurementFrameCodec::FRAME_SIZE];
+    memcpy(text, "1000,2101,12.345,3,97,", sizeof(text));
+    MeasurementFrame decoded;
+    TEST_ASSERT_TRUE(!MeasurementFrameCodec::decode(text, &decoded));
+}
+
+// Main test runner
+int main(int argc, char **argv) {
+    UNITY_BEGIN();
+    
+    RUN_TEST(test_round_trip);
+    RUN_TEST(test_layout);
+    RUN_TEST(test_bit_flips_rejected);
+    RUN_TEST(test_sync_not_ascii);
+    
+    return UNITY_END();
+}
@@ -0,0 +1,104 @@
+#ifndef FILE_FLASH_H
+#define FILE_FLASH_H
+
+#include <stdio.h>
+#include <vector>
+#include "../../include/FlashStorage.h"
+
+/**
+ * @brief File-backed NOR flash mock for host tests
+ *
+ * The image survives destroying the object (reopen the file to simulate a
+ * power cycle). Enforces NOR rules and counts every operation:
+ * - erasePage() sets the page to 0xFF and counts an erase for that page
+ * - write() may only clear bits; setting a programmed bit is a violation
+ * - powerFailAfter(n) stops programming after n more bytes (torn write)
+ */
+class FileFlash : public FlashStorage {
+public:
+    FileFlash(const char* path, uint32_t pageBytes, uint32_t pages)
+        : pageBytes(pageBytes), pages(pages), erases(pages, 0),
+          writeCalls(0), bytesWritten(0), readCalls(0), violations(0), byteBudget(-1) {
+        file = fopen(path, "r+b");
+        if (!file) {
+            file = fopen(path, "w+b");
+            std::vector<uint8_t> blank(pageBytes * pages, 0xFF);
+            fwrite(&blank[0], 1, blank.size(), file);
+            fflush(file);
+        }
+    }
+
+    ~FileFlash() {
+        if (file) fclose(file);
+    }
+
+    bool begin() { return file != nullptr; }
+    uint32_t pageSize() const { return pageBytes; }
+    uint32_t pageCount() const { return pages; }
+
+    bool read(uint32_t address, uint8_t* data, uint32_t length) {
+        readCalls++;
+        if (address + length > pageBytes * pages) return false;
+        fseek(file, address, SEEK_SET);
+        return fread(data, 1, length, file) == length;
+    }
+
+    bool write(uint32_t address, const uint8_t* data, uint32_t length) {
+        writeCalls++;
+        if (address + length > pageBytes * pages) return false;
+        if (address / pageBytes != (address + length - 1) / pageBytes) violations++;
+
+        std::vector<uint8_t> current(length);
+        fseek(file, address, SEEK_SET);
+        if (fread(&current[0], 1, length, file) != length) return false;
+
+        bool complete = true;
+        for (uint32_t i = 0; i < length; i++) {
+            if (byteBudget == 0) {
+                complete = false;
+                break;
+            }
+            if (byteBudget > 0) byteBudget--;
+            if ((current[i] & data[i]) != data[i]) violations++;
+            current[i] &= data[i];
+            bytesWritten++;
+        }
+
+        fseek(file, address, SEEK_SET);
+        fwrite(&current[0], 1, length, file);
+        fflush(file);
+        return complete;
+    }
+
+    bool erasePage(uint32_t page) {
+        if (page >= pages) return false;
+        erases[page]++;
+        std::vector<uint8_t> blank(pageBytes, 0xFF);
+        fseek(file, page * pageBytes, SEEK_SET);
+        fwrite(&blank[0], 1, pageBytes, file);
+        fflush(file);
+        return true;
+    }
+
+    void powerFailAfter(long bytes) { byteBudget = bytes; }
+
+    long totalErases() const {
+        long total = 0;
+        for (size_t i = 0; i < erases.size(); i++) total += erases[i];
+        return total;
+    }
+
+    uint32_t pageBytes;
+    uint32_t pages;
+    std::vector<long> erases;    // Erase count per page
+    long writeCalls;
+    long bytesWritten;
+    long readCalls;
+    long violations;             // Bits set by a write or writes crossing a page
+
+private:
+    FILE* file;
+    long byteBudget;             // Bytes left before a simulated power failure (-1 = unlimited)
+};
+
+#endif // FILE_FLASH_H
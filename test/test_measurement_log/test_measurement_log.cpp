@@ -0,0 +1,303 @@
+#include <unity.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Define UNIT_TEST before including anything
+#define UNIT_TEST
+
+// Include config first to ensure constants are defined
+#include "../../include/config.h"
+
+#include "../../include/MeasurementLog.h"
+#include "../../src/MeasurementLog.cpp"
+#include "FileFlash.h"
+
+const char* IMAGE = "test_measurement_log.bin";
+
+// Small geometry so tests rotate through every page
+const uint32_t PAGE = 256;
+const uint32_t PAGES = 8;
+const int RECORDS_PER_PAGE = (PAGE - MeasurementLog::LOG_HEADER_SIZE) / MeasurementLog::LOG_RECORD_SIZE;
+
+void setUp() {
+    remove(IMAGE);
+}
+
+void tearDown() {
+    remove(IMAGE);
+}
+
+/**
+ * @brief Log one session of readings 10 s apart
+ */
+static uint16_t logSession(MeasurementLog& log, int readings, float startVoltage) {
+    uint16_t id = log.startSession(0, 3);
+    for (int i = 0; i < readings; i++) {
+        log.logReading(i * 10000UL, startVoltage - i * 0.01f, 80 - i % 80);
+    }
+    return id;
+}
+
+// Test records survive a power cycle and the session is found again
+void test_round_trip_after_power_cycle() {
+    {
+        FileFlash flash(IMAGE, PAGE, PAGES);
+        MeasurementLog log(flash);
+        TEST_ASSERT_TRUE(log.begin());
+        TEST_ASSERT_EQUAL(0, log.getCurrentSession());
+        TEST_ASSERT_EQUAL(0, log.getUsedPages());
+
+        TEST_ASSERT_EQUAL(1, logSession(log, 20, 12.6f));
+        log.flush();
+    }
+
+    FileFlash flash(IMAGE, PAGE, PAGES);
+    MeasurementLog log(flash);
+    TEST_ASSERT_TRUE(log.begin());
+    TEST_ASSERT_EQUAL(1, log.getCurrentSession());
+
+    LogSession sessions[4];
+    TEST_ASSERT_EQUAL(1, log.findSessions(sessions, 4));
+    TEST_ASSERT_EQUAL(1, sessions[0].id);
+    TEST_ASSERT_EQUAL(3, sessions[0].cellCount);
+
+    // Next session continues the id sequence and the page
+    TEST_ASSERT_EQUAL(2, logSession(log, 5, 11.1f));
+    log.flush();
+    TEST_ASSERT_EQUAL(2, log.findSessions(sessions, 4));
+    TEST_ASSERT_EQUAL(2, sessions[0].id);
+    TEST_ASSERT_EQUAL(1, sessions[1].id);
+    TEST_ASSERT_EQUAL(1, log.getUsedPages());
+}
+
+// Test records are decoded exactly
+void test_record_encoding() {
+    FileFlash flash(IMAGE, PAGE, PAGES);
+    MeasurementLog log(flash);
+    log.begin();
+
+    log.startSession(3, 4);
+    log.logReading(1000, 13.21f, 42);
+    log.logReading(11400, 13.20f, 41);    // 10.4 s -> 10
+    log.logReading(21000, 13.19f, 40);    // 9.6 s since 11000 -> 10
+    log.logReading(400000, 13.18f, 39);   // > 127 s saturates
+    log.flush();
+
+    uint8_t bytes[PAGE];
+    flash.read(0, bytes, PAGE);
+
+    LogPageHeader header;
+    TEST_ASSERT_TRUE(MeasurementLog::decodePageHeader(bytes, &header));
+    TEST_ASSERT_EQUAL(1, header.sequence);
+    TEST_ASSERT_EQUAL(1, header.firstSession);
+
+    LogRecord record;
+    const uint8_t* r = bytes + MeasurementLog::LOG_HEADER_SIZE;
+    TEST_ASSERT_EQUAL(LOG_RECORD_SESSION, MeasurementLog::decodeRecord(r, &record));
+    TEST_ASSERT_EQUAL(1, record.session);
+    TEST_ASSERT_EQUAL(3, record.chemistry);
+    TEST_ASSERT_EQUAL(4, record.cellCount);
+
+    const uint8_t expectedDelta[] = { 0, 10, 10, 127 };
+    for (int i = 0; i < 4; i++) {
+        r += MeasurementLog::LOG_RECORD_SIZE;
+        TEST_ASSERT_EQUAL(LOG_RECORD_READING, MeasurementLog::decodeRecord(r, &record));
+        TEST_ASSERT_EQUAL(expectedDelta[i], record.deltaSeconds);
+        TEST_ASSERT_FLOAT_WITHIN(0.001, 13.21f - i * 0.01f, record.voltage);
+        TEST_ASSERT_EQUAL(42 - i, record.chargePercentage);
+    }
+
+    r += MeasurementLog::LOG_RECORD_SIZE;
+    TEST_ASSERT_EQUAL(LOG_RECORD_ERASED, MeasurementLog::decodeRecord(r, &record));
+}
+
+// Test batching: one flash write per LOG_BATCH_BYTES, never per reading
+void test_batched_writes() {
+    FileFlash flash(IMAGE, 4096, 16);
+    MeasurementLog log(flash);
+    log.begin();
+
+    const int readings = 800;
+    logSession(log, readings, 16.8f);
+    log.flush();
+
+    long records = readings + 1;
+    long expectedBatches = (records * 4 + LOG_BATCH_BYTES - 1) / LOG_BATCH_BYTES;
+
+    // Batches plus one header per page opened
+    TEST_ASSERT_LESS_OR_EQUAL(expectedBatches + 2 * (long)log.getUsedPages(), flash.writeCalls);
+    TEST_ASSERT_EQUAL(records * 4 + 12L * log.getUsedPages(), flash.bytesWritten);
+    TEST_ASSERT_EQUAL(0, flash.violations);
+}
+
+// Test rotation erases every page equally and keeps the newest data
+void test_wear_leveling_rotation() {
+    FileFlash flash(IMAGE, PAGE, PAGES);
+    MeasurementLog log(flash);
+    log.begin();
+
+    // ~25 passes over the whole ring
+    const int sessions = 100;
+    for (int s = 0; s < sessions; s++) {
+        logSession(log, 2 * RECORDS_PER_PAGE - 1, 12.0f);  // Two pages per session
+    }
+    log.flush();
+
+    long minimum = flash.erases[0];
+    long maximum = flash.erases[0];
+    for (uint32_t p = 1; p < PAGES; p++) {
+        if (flash.erases[p] < minimum) minimum = flash.erases[p];
+        if (flash.erases[p] > maximum) maximum = flash.erases[p];
+    }
+    TEST_ASSERT_GREATER_OR_EQUAL(24, minimum);
+    TEST_ASSERT_LESS_OR_EQUAL(1, maximum - minimum);
+    TEST_ASSERT_EQUAL(200, flash.totalErases());
+    TEST_ASSERT_EQUAL(0, flash.violations);
+
+    // The ring holds the last four sessions
+    LogSession found[8];
+    TEST_ASSERT_EQUAL(4, log.findSessions(found, 8));
+    for (int i = 0; i < 4; i++) {
+        TEST_ASSERT_EQUAL(sessions - i, found[i].id);
+    }
+    TEST_ASSERT_EQUAL(PAGES, log.getUsedPages());
+
+    // Mount after many rotations finds the same state
+    FileFlash again(IMAGE, PAGE, PAGES);
+    MeasurementLog remounted(again);
+    remounted.begin();
+    TEST_ASSERT_EQUAL(sessions, remounted.getCurrentSession());
+    TEST_ASSERT_EQUAL(4, remounted.findSessions(found, 8));
+    TEST_ASSERT_EQUAL(sessions, found[0].id);
+}
+
+// Test the header index skips pages of long sessions
+void test_find_sessions_reads_headers() {
+    FileFlash flash(IMAGE, PAGE, 64);
+    MeasurementLog log(flash);
+    log.begin();
+
+    // Two short sessions, then one session spanning ~60 pages
+    logSession(log, 10, 8.4f);
+    logSession(log, 10, 8.3f);
+    logSession(log, 60 * RECORDS_PER_PAGE, 8.2f);
+    log.flush();
+
+    long before = flash.readCalls;
+    LogSession found[3];
+    TEST_ASSERT_EQUAL(3, log.findSessions(found, 3));
+    long reads = flash.readCalls - before;
+    TEST_ASSERT_EQUAL(3, found[0].id);
+    TEST_ASSERT_EQUAL(2, found[1].id);
+    TEST_ASSERT_EQUAL(1, found[2].id);
+
+    // One read per page of the long session; full scans of two pages only
+    long fullScan = 62L * (PAGE / LOG_BATCH_BYTES);
+    TEST_ASSERT_LESS_THAN(fullScan / 2, reads);
+
+    // Newest only: still walks back to the page holding its session record
+    TEST_ASSERT_EQUAL(1, log.findSessions(found, 1));
+    TEST_ASSERT_EQUAL(3, found[0].id);
+
+    // A short session after the long one is found in the newest page alone
+    logSession(log, 5, 8.1f);
+    log.flush();
+    before = flash.readCalls;
+    TEST_ASSERT_EQUAL(1, log.findSessions(found, 1));
+    TEST_ASSERT_EQUAL(4, found[0].id);
+    TEST_ASSERT_LESS_OR_EQUAL(1 + 2 * (PAGE / LOG_BATCH_BYTES), flash.readCalls - before);
+}
+
+// Test a torn write at power loss is skipped and logging resumes after it
+void test_power_loss_torn_record() {
+    {
+        FileFlash flash(IMAGE, PAGE, PAGES);
+        MeasurementLog log(flash);
+        log.begin();
+        logSession(log, 10, 12.0f);
+        log.flush();
+
+        // Power fails 2 bytes into the next batch
+        log.logReading(200000, 11.5f, 50);
+        flash.powerFailAfter(2);
+        log.flush();
+    }
+
+    FileFlash flash(IMAGE, PAGE, PAGES);
+    MeasurementLog log(flash);
+    TEST_ASSERT_TRUE(log.begin());
+    TEST_ASSERT_EQUAL(1, log.getCurrentSession());
+
+    uint8_t torn[4];
+    flash.read(MeasurementLog::LOG_HEADER_SIZE + 11 * 4, torn, 4);
+    LogRecord record;
+    TEST_ASSERT_EQUAL(LOG_RECORD_INVALID, MeasurementLog::decodeRecord(torn, &record));
+
+    // New records go after the torn one without reprogramming it
+    logSession(log, 3, 12.0f);
+    log.flush();
+    TEST_ASSERT_EQUAL(0, flash.violations);
+
+    LogSession found[2];
+    TEST_ASSERT_EQUAL(2, log.findSessions(found, 2));
+    TEST_ASSERT_EQUAL(2, found[0].id);
+    TEST_ASSERT_EQUAL(MeasurementLog::LOG_HEADER_SIZE + 12 * 4, found[0].offset);
+}
+
+// Test the streaming dump covers the written data only, oldest page first
+void test_dump_lines() {
+    FileFlash flash(IMAGE, PAGE, PAGES);
+    MeasurementLog log(flash);
+    log.begin();
+    logSession(log, RECORDS_PER_PAGE + 5, 12.0f);
+    log.flush();
+
+    LogDumpCursor cursor;
+    char line[MeasurementLog::LOG_DUMP_LINE_SIZE];
+    log.startDump(&cursor);
+
+    TEST_ASSERT_TRUE(log.nextDumpLine(&cursor, line));
+    TEST_ASSERT_EQUAL_STRING("#LOG 1 256 2", line);
+
+    int lines = 0;
+    unsigned long lastSequence = 0;
+    long bytes = 0;
+    while (log.nextDumpLine(&cursor, line)) {
+        if (line[0] == '#') {
+            TEST_ASSERT_EQUAL_STRING("#END", line);
+            break;
+        }
+        unsigned long sequence = strtoul(line, NULL, 10);
+        TEST_ASSERT_GREATER_OR_EQUAL(lastSequence, sequence);
+        lastSequence = sequence;
+        const char* hex = strchr(strchr(line, ' ') + 1, ' ') + 1;
+        TEST_ASSERT_LESS_THAN(MeasurementLog::LOG_DUMP_LINE_SIZE, (int)strlen(line) + 1);
+        bytes += strlen(hex) / 2;
+        lines++;
+    }
+    TEST_ASSERT_FALSE(log.nextDumpLine(&cursor, line));
+
+    // Page 1 is full (8 lines); page 2 holds a header and 6 records (36 bytes, 2 lines)
+    TEST_ASSERT_EQUAL(2, lastSequence);
+    TEST_ASSERT_EQUAL(10, lines);
+    TEST_ASSERT_EQUAL(PAGE + 64, bytes);
+}
+
+// Main test runner
+int main(int argc, char **argv) {
+    UNITY_BEGIN();
+
+    // Format tests
+    RUN_TEST(test_round_trip_after_power_cycle);
+    RUN_TEST(test_record_encoding);
+    RUN_TEST(test_dump_lines);
+
+    // Flash behaviour tests
+    RUN_TEST(test_batched_writes);
+    RUN_TEST(test_wear_leveling_rotation);
+    RUN_TEST(test_find_sessions_reads_headers);
+    RUN_TEST(test_power_loss_torn_record);
+
+    return UNITY_END();
+}
@@ -0,0 +1,110 @@
+#include <unity.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+// Define UNIT_TEST before including anything
+#define UNIT_TEST
+#define MEMORY_MONITOR 1
+
+// Include config first to ensure constants are defined
+#include "../../include/config.h"
+
+#include "../../include/MemoryMonitor.h"
+#include "../../src/MemoryMonitor.cpp"
+
+/**
+ * @brief Stage body using about `bytes` of stack (every byte written)
+ */
+__attribute__((noinline)) static int useStack(int bytes) {
+    volatile char frame[8192];
+    for (int i = 0; i < bytes && i < (int)sizeof(frame); i++) {
+        frame[i] = (char)i;
+    }
+    return frame[0];
+}
+
+void setUp(void) {
+    MemoryMonitor::begin();
+}
+
+void tearDown(void) {
+}
+
+void test_begin_paints_the_host_stack(void) {
+    // From below the reserve up to a guard under setUp()'s frame
+    TEST_ASSERT_UINT_WITHIN(1024, MEMORY_HOST_STACK_BYTES, MemoryMonitor::getPaintedBytes());
+    TEST_ASSERT_EQUAL(0, MemoryMonitor::getStats(0).runs);
+}
+
+void test_stage_keeps_its_deepest_run(void) {
+    // The array's first bytes are the deepest; frames above it are a few hundred bytes
+    useStack(8192);
+    MemoryMonitor::leaveStage(0);
+    size_t deep = MemoryMonitor::getStats(0).stackUsed;
+    TEST_ASSERT_UINT_WITHIN(1024, 8192, deep);
+    
+    useStack(16);
+    MemoryMonitor::leaveStage(0);
+    TEST_ASSERT_EQUAL(deep, MemoryMonitor::getStats(0).stackUsed);
+    TEST_ASSERT_EQUAL(2, MemoryMonitor::getStats(0).runs);
+}
+
+void test_stages_are_measured_separately(void) {
+    useStack(8192);
+    MemoryMonitor::leaveStage(1);
+    
+    // The deep stage's bytes were painted again: a stage without the array stays shallow
+    MemoryMonitor::leaveStage(2);
+    TEST_ASSERT_UINT_WITHIN(1024, 8192, MemoryMonitor::getStats(1).stackUsed);
+    TEST_ASSERT_TRUE(MemoryMonitor::getStats(2).stackUsed < 1024);
+}
+
+void test_used_and_free_cover_the_painted_stack(void) {
+    useStack(4096);
+    MemoryMonitor::leaveStage(0);
+    MemoryMonitor::leaveStage(MemoryMonitor::SETUP_STAGE);
+    for (int stage = 0; stage < MemoryMonitor::STAGE_COUNT; stage += MemoryMonitor::SETUP_STAGE) {
+        const MemoryStats& stats = MemoryMonitor::getStats(stage);
+        TEST_ASSERT_EQUAL(MemoryMonitor::getPaintedBytes() + MEMORY_STACK_GUARD_BYTES,
+                          stats.stackUsed + stats.stackFree);
+    }
+    TEST_ASSERT_TRUE(MemoryMonitor::getStats(0).stackFree < MemoryMonitor::getStats(MemoryMonitor::SETUP_STAGE).stackFree);
+}
+
+void test_invalid_stage_is_ignored(void) {
+    MemoryMonitor::leaveStage(-1);
+    MemoryMonitor::leaveStage(MemoryMonitor::STAGE_COUNT);
+    for (int stage = 0; stage < MemoryMonitor::STAGE_COUNT; stage++) {
+        TEST_ASSERT_EQUAL(0, MemoryMonitor::getStats(stage).runs);
+    }
+}
+
+void test_heap_high_water(void) {
+#ifdef MEMORY_HOST_MALLINFO2
+    MemoryMonitor::leaveStage(3);
+    size_t before = MemoryMonitor::getStats(3).heapUsed;
+    
+    volatile char* block = (volatile char*)malloc(100000);
+    block[0] = 1;
+    MemoryMonitor::leaveStage(3);
+    free((void*)block);
+    MemoryMonitor::leaveStage(3);
+    TEST_ASSERT_TRUE(MemoryMonitor::getStats(3).heapUsed >= before + 100000);
+    TEST_ASSERT_EQUAL(3, MemoryMonitor::getStats(3).runs);
+#else
+    TEST_IGNORE_MESSAGE("no mallinfo2() on this host");
+#endif
+}
+
+int main(int argc, char **argv) {
+    UNITY_BEGIN();
+    
+    RUN_TEST(test_begin_paints_the_host_stack);
+    RUN_TEST(test_stage_keeps_its_deepest_run);
+    RUN_TEST(test_stages_are_measured_separately);
+    RUN_TEST(test_used_and_free_cover_the_painted_stack);
+    RUN_TEST(test_invalid_stage_is_ignored);
+    RUN_TEST(test_heap_high_water);
+    
+    return UNITY_END();
+}
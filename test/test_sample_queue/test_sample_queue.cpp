@@ -0,0 +1,203 @@
+#include <unity.h>
+#include <stdio.h>
+#include <chrono>
+#include <thread>
+
+// Define UNIT_TEST before including anything
+#define UNIT_TEST
+
+// Include config first to ensure constants are defined
+#include "../../include/config.h"
+
+#include "../../include/SampleQueue.h"
+#include "../../src/SampleQueue.cpp"
+
+/**
+ * @brief Record whose fields all derive from one counter, so a torn copy is detectable
+ */
+static SampleRecord makeRecord(uint32_t counter) {
+    SampleRecord record;
+    record.timeMs = counter;
+    record.raw = (uint16_t)((counter * 2654435761UL) >> 16);
+    record.sequence = (uint16_t)counter;
+    return record;
+}
+
+static bool isConsistent(const SampleRecord& record) {
+    SampleRecord expected = makeRecord(record.timeMs);
+    return record.raw == expected.raw && record.sequence == expected.sequence;
+}
+
+void setUp(void) {
+}
+
+void tearDown(void) {
+}
+
+// Test FIFO order, the full queue and the empty queue
+void test_fifo_order_and_full() {
+    SampleQueue queue;
+    SampleRecord record;
+    TEST_ASSERT_FALSE(queue.pop(&record));
+    
+    for (int i = 0; i < SAMPLE_QUEUE_DEPTH; i++) {
+        TEST_ASSERT_TRUE(queue.push(makeRecord(i)));
+    }
+    TEST_ASSERT_EQUAL(SAMPLE_QUEUE_DEPTH, queue.size());
+    TEST_ASSERT_FALSE(queue.push(makeRecord(99)));     // Dropped
+    
+    for (int i = 0; i < SAMPLE_QUEUE_DEPTH; i++) {
+        TEST_ASSERT_TRUE(queue.pop(&record));
+        TEST_ASSERT_EQUAL(i, record.timeMs);
+        TEST_ASSERT_TRUE(isConsistent(record));
+    }
+    TEST_ASSERT_FALSE(queue.pop(&record));
+    TEST_ASSERT_EQUAL(0, queue.size());
+}
+
+// Test the free-running indices across their wraparound
+void test_index_wraparound() {
+    SampleQueue queue;
+    SampleRecord record;
+    
+    for (uint32_t i = 0; i < 200000; i++) {
+        TEST_ASSERT_TRUE(queue.push(makeRecord(i)));
+        if (i % 3 == 0) {
+            TEST_ASSERT_TRUE(queue.push(makeRecord(i + 1000000)));
+        }
+        TEST_ASSERT_TRUE(queue.pop(&record));
+        TEST_ASSERT_TRUE(isConsistent(record));
+        if (i % 3 == 2) {
+            TEST_ASSERT_TRUE(queue.pop(&record));
+        }
+        TEST_ASSERT_TRUE(queue.size() <= 2);
+    }
+}
+
+// Test clear() drops everything queued and the queue keeps working
+void test_clear() {
+    SampleQueue queue;
+    SampleRecord record;
+    for (int i = 0; i < 5; i++) {
+        queue.push(makeRecord(i));
+    }
+    queue.clear();
+    TEST_ASSERT_EQUAL(0, queue.size());
+    TEST_ASSERT_FALSE(queue.pop(&record));
+    
+    TEST_ASSERT_TRUE(queue.push(makeRecord(7)));
+    TEST_ASSERT_TRUE(queue.pop(&record));
+    TEST_ASSERT_EQUAL(7, record.timeMs);
+}
+
+// Test a producer and a consumer thread: every record arrives once, in order and intact
+void test_threaded_stress_no_lost_or_torn() {
+    const uint32_t RECORDS = 2000000;
+    SampleQueue queue;
+    unsigned long fullSpins = 0;
+    unsigned long torn = 0;
+    unsigned long outOfOrder = 0;
+    uint32_t received = 0;
+    
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    std::thread producer([&]() {
+        for (uint32_t i = 0; i < RECORDS; i++) {
+            while (!queue.push(makeRecord(i))) {
+                fullSpins++;
+                std::this_thread::yield();
+            }
+        }
+    });
+    std::thread consumer([&]() {
+        SampleRecord record;
+        while (received < RECORDS) {
+            if (!queue.pop(&record)) {
+                std::this_thread::yield();
+                continue;
+            }
+            if (!isConsistent(record)) torn++;
+            if (record.timeMs != received) outOfOrder++;
+            received++;
+        }
+    });
+    producer.join();
+    consumer.join();
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    
+    char message[160];
+    snprintf(message, sizeof(message), "%lu records in %.3f s: %.1f M records/s (%lu full-queue retries)",
+             (unsigned long)RECORDS, seconds, RECORDS / seconds / 1e6, fullSpins);
+    TEST_MESSAGE(message);
+    
+    TEST_ASSERT_EQUAL(RECORDS, received);
+    TEST_ASSERT_EQUAL(0, torn);
+    TEST_ASSERT_EQUAL(0, outOfOrder);
+    TEST_ASSERT_EQUAL(0, queue.size());
+}
+
+// Test records dropped by a full queue are exactly the gaps the consumer sees
+void test_threaded_drops_show_as_sequence_gaps() {
+    const uint32_t RECORDS = 1000000;
+    SampleQueue queue;
+    unsigned long dropped = 0;
+    unsigned long gaps = 0;
+    unsigned long torn = 0;
+    bool done = false;
+    
+    std::thread producer([&]() {
+        for (uint32_t i = 0; i < RECORDS; i++) {
+            if (!queue.push(makeRecord(i))) {
+                dropped++;
+                std::this_thread::yield();
+            }
+        }
+        // Last record always delivered so a trailing gap is seen
+        while (!queue.push(makeRecord(RECORDS))) {
+            std::this_thread::yield();
+        }
+    });
+    std::thread consumer([&]() {
+        SampleRecord record;
+        uint16_t expected = 0;
+        while (!done) {
+            if (!queue.pop(&record)) {
+                std::this_thread::yield();
+                continue;
+            }
+            if (!isConsistent(record)) torn++;
+            gaps += (uint16_t)(record.sequence - expected);
+            expected = (uint16_t)(record.sequence + 1);
+            if (record.timeMs == RECORDS) {
+                done = true;
+            }
+            // Slow consumer: forces drops
+            for (volatile int spin = 0; spin < 50; spin++) {
+            }
+        }
+    });
+    producer.join();
+    consumer.join();
+    
+    char message[96];
+    snprintf(message, sizeof(message), "%lu of %lu records dropped by the full queue",
+             dropped, (unsigned long)RECORDS);
+    TEST_MESSAGE(message);
+    
+    TEST_ASSERT_TRUE(dropped > 0);
+    TEST_ASSERT_EQUAL(0, torn);
+    // The producer yields after a drop, so no gap reaches the 16-bit sequence range
+    TEST_ASSERT_EQUAL(dropped, gaps);
+}
+
+// Main test runner
+int main(int argc, char **argv) {
+    UNITY_BEGIN();
+    
+    RUN_TEST(test_fifo_order_and_full);
+    RUN_TEST(test_index_wraparound);
+    RUN_TEST(test_clear);
+    RUN_TEST(test_threaded_stress_no_lost_or_torn);
+    RUN_TEST(test_threaded_drops_show_as_sequence_gaps);
+    
+    return UNITY_END();
+}
@@ -0,0 +1,192 @@
+#include <unity.h>
+#include <math.h>
+
+// Define UNIT_TEST before including anything
+#define UNIT_TEST
+
+// Include config first to ensure constants are defined
+#include "../../include/config.h"
+
+#include "../../include/SessionHistory.h"
+#include "../../src/SessionHistory.cpp"
+
+const float STEP_V = HISTORY_RESOLUTION_MV / 1000.0f;
+
+// Test readings decode in order, quantized to HISTORY_RESOLUTION_MV
+void test_round_trip() {
+    SessionHistory history;
+    const float input[] = { 11.10f, 11.12f, 11.09f, 11.094f, 12.60f, 3.70f, 3.71f };
+    const int n = sizeof(input) / sizeof(input[0]);
+    
+    for (int i = 0; i < n; i++) {
+        history.append(input[i]);
+    }
+    
+    float output[n];
+    TEST_ASSERT_EQUAL(n, history.getCount());
+    TEST_ASSERT_EQUAL(n, history.getReadings(output, n));
+    for (int i = 0; i < n; i++) {
+        TEST_ASSERT_FLOAT_WITHIN(STEP_V / 2 + 0.0001f, input[i], output[i]);
+    }
+    
+    // Small steps take 1 byte; the 11.09V -> 12.60V -> 3.70V jumps take 3
+    TEST_ASSERT_EQUAL(4 * 1 + 2 * 3, history.getBytesUsed());
+    
+    // Newest readings only
+    float newest[2];
+    TEST_ASSERT_EQUAL(2, history.getReadings(newest, 2));
+    TEST_ASSERT_FLOAT_WITHIN(0.001, 3.70, newest[0]);
+    TEST_ASSERT_FLOAT_WITHIN(0.001, 3.71, newest[1]);
+}
+
+// Test the ring keeps the newest readings once full
+void test_eviction() {
+    SessionHistory history;
+    
+    // Slow discharge: every reading is a 1-byte delta
+    const int total = HISTORY_BUFFER_BYTES * 3;
+    for (int i = 0; i < total; i++) {
+        history.append(12.6f - (i % 50) * STEP_V);
+    }
+    
+    TEST_ASSERT_EQUAL(HISTORY_BUFFER_BYTES + 1, history.getCount());
+    TEST_ASSERT_EQUAL(HISTORY_BUFFER_BYTES, history.getBytesUsed());
+    TEST_ASSERT_EQUAL(total, history.getSessionCount());
+    
+    float last;
+    history.getReadings(&last, 1);
+    TEST_ASSERT_FLOAT_WITHIN(0.001, 12.6f - ((total - 1) % 50) * STEP_V, last);
+    
+    // Oldest buffered reading is total - count readings into the session
+    static float all[HISTORY_BUFFER_BYTES + 1];
+    history.getReadings(all, HISTORY_BUFFER_BYTES + 1);
+    int first = total - (HISTORY_BUFFER_BYTES + 1);
+    TEST_ASSERT_FLOAT_WITHIN(0.001, 12.6f - (first % 50) * STEP_V, all[0]);
+}
+
+// Test eviction across 3-byte records keeps the absolute values right
+void test_eviction_with_jumps() {
+    SessionHistory history;
+    
+    for (int i = 0; i < HISTORY_BUFFER_BYTES * 2; i++) {
+        history.append((i % 3 == 0) ? 8.0f : 12.0f + (i % 7) * STEP_V);
+    }
+    
+    TEST_ASSERT_LESS_OR_EQUAL(HISTORY_BUFFER_BYTES, history.getBytesUsed());
+    
+    static float all[HISTORY_BUFFER_BYTES + 1];
+    int n = history.getReadings(all, HISTORY_BUFFER_BYTES + 1);
+    int first = HISTORY_BUFFER_BYTES * 2 - n;
+    for (int k = 0; k < n; k++) {
+        int i = first + k;
+        float expected = (i % 3 == 0) ? 8.0f : 12.0f + (i % 7) * STEP_V;
+        TEST_ASSERT_FLOAT_WITHIN(0.001, expected, all[k]);
+    }
+}
+
+// Test Welford statistics against a direct two-pass computation
+void test_session_statistics() {
+    SessionHistory history;
+    const int n = 10000;
+    double sum = 0.0;
+    double sumSquares = 0.0;
+    
+    for (int i = 0; i < n; i++) {
+        float v = 11.1f + 0.3f * sinf(i * 0.01f) + ((i * 37) % 11 - 5) * 0.004f;
+        history.append(v);
+        sum += v;
+    }
+    double mean = sum / n;
+    for (int i = 0; i < n; i++) {
+        float v = 11.1f + 0.3f * sinf(i * 0.01f) + ((i * 37) % 11 - 5) * 0.004f;
+        sumSquares += (v - mean) * (v - mean);
+    }
+    
+    TEST_ASSERT_FLOAT_WITHIN(0.0005, (float)mean, history.getMean());
+    TEST_ASSERT_FLOAT_WITHIN(0.0005, (float)sqrt(sumSquares / n), history.getStdDev());
+    TEST_ASSERT_FLOAT_WITHIN(0.03, 10.8, history.getMinimum());
+    TEST_ASSERT_FLOAT_WITHIN(0.03, 11.4, history.getMaximum());
+}
+
+// Test sag events are counted once per drop
+void test_sag_events() {
+    SessionHistory history;
+    
+    // Resting, load step (-0.5V), recovery, second deeper sag held for 3 readings
+    const float trace[] = { 12.5f, 12.5f, 12.0f, 12.05f, 12.45f, 12.45f, 11.7f, 11.6f, 11.65f, 12.4f };
+    for (unsigned i = 0; i < sizeof(trace) / sizeof(trace[0]); i++) {
+        history.append(trace[i]);
+    }
+    
+    TEST_ASSERT_EQUAL(2, history.getSagCount());
+    TEST_ASSERT_FLOAT_WITHIN(0.001, 0.85, history.getDeepestSag());
+    
+    // Gradual discharge is not a sag
+    SessionHistory discharge;
+    for (int i = 0; i < 1000; i++) {
+        discharge.append(12.6f - i * 0.002f);
+    }
+    TEST_ASSERT_EQUAL(0, discharge.getSagCount());
+}
+
+// Test sparkline downsampling and scaling
+void test_sparkline() {
+    SessionHistory history;
+    uint8_t heights[128];
+    
+    TEST_ASSERT_EQUAL(0, history.sparkline(heights, 128, 20));
+    
+    // Linear ramp 11.0V -> 12.0V over 256 readings: 2 readings per column
+    for (int i = 0; i < 256; i++) {
+        history.append(11.0f + i * (1.0f / 255));
+    }
+    TEST_ASSERT_EQUAL(128, history.sparkline(heights, 128, 20));
+    TEST_ASSERT_EQUAL(0, heights[0]);
+    TEST_ASSERT_INT_WITHIN(1, 20, heights[127]);
+    for (int c = 1; c < 128; c++) {
+        TEST_ASSERT_GREATER_OR_EQUAL(heights[c - 1], heights[c]);
+    }
+    
+    // Fewer readings than columns: one column per reading; flat history sits mid-height
+    SessionHistory flat;
+    for (int i = 0; i < 5; i++) {
+        flat.append(7.4f);
+    }
+    TEST_ASSERT_EQUAL(5, flat.sparkline(heights, 128, 20));
+    TEST_ASSERT_EQUAL(10, heights[4]);
+}
+
+// Test reset starts a new session
+void test_reset() {
+    SessionHistory history;
+    history.append(12.0f);
+    history.append(11.0f);
+    history.reset();
+    
+    TEST_ASSERT_EQUAL(0, history.getCount());
+    TEST_ASSERT_EQUAL(0, history.getSessionCount());
+    TEST_ASSERT_EQUAL(0, history.getBytesUsed());
+    TEST_ASSERT_EQUAL(0, history.getSagCount());
+    
+    history.append(7.4f);
+    TEST_ASSERT_FLOAT_WITHIN(0.001, 7.4, history.getMinimum());
+    TEST_ASSERT_FLOAT_WITHIN(0.001, 7.4, history.getMaximum());
+}
+
+// Main test runner
+int main(int argc, char **argv) {
+    UNITY_BEGIN();
+    
+    // Encoding tests
+    RUN_TEST(test_round_trip);
+    RUN_TEST(test_eviction);
+    RUN_TEST(test_eviction_with_jumps);
+    
+    // Statistics tests
+    RUN_TEST(test_session_statistics);
+    RUN_TEST(test_sag_events);
+    RUN_TEST(test_sparkline);
+    RUN_TEST(test_reset);
+    
+    return UNITY_END();
+}
@@ -0,0 +1,223 @@
+#include <unity.h>
+#include <stdio.h>
+
+// Define UNIT_TEST before including anything
+#define UNIT_TEST
+
+// Include config first to ensure constants are defined
+#include "../../include/config.h"
+
+#include "../../include/TaskScheduler.h"
+#include "../../src/TaskScheduler.cpp"
+
+// Virtual clock: only tasks (their cost) and runFor() (idle time) advance it.
+// 32 bits wide like micros() on the targets, so it wraps on 64-bit hosts too
+static uint32_t virtualUs = 0;
+
+static unsigned long virtualClock() {
+    return virtualUs;
+}
+
+// Task bodies record their order and burn their cost on the virtual clock
+static unsigned long fastCostUs = 0;
+static unsigned long slowCostUs = 0;
+static char order[16];
+static int orderLength = 0;
+
+static void fastTask() {
+    if (orderLength < 15) order[orderLength++] = 'F';
+    virtualUs += fastCostUs;
+}
+
+static void slowTask() {
+    if (orderLength < 15) order[orderLength++] = 'S';
+    virtualUs += slowCostUs;
+}
+
+/**
+ * @brief Main loop stand-in: run due tasks, jump the clock to the next release when idle
+ */
+static void runFor(TaskScheduler& scheduler, unsigned long durationUs) {
+    uint32_t end = virtualUs + durationUs;
+    while ((int32_t)(end - virtualUs) > 0) {
+        if (!scheduler.runOnce()) {
+            unsigned long wait = scheduler.timeUntilNext();
+            virtualUs += wait < end - virtualUs ? wait : end - virtualUs;
+        }
+    }
+}
+
+void setUp(void) {
+    virtualUs = 0;
+    fastCostUs = 100;
+    slowCostUs = 0;
+    orderLength = 0;
+    order[0] = '\0';
+}
+
+void tearDown(void) {
+}
+
+// Test releases stay on the period grid: no drift from the task's own cost
+void test_periodic_runs_without_drift() {
+    TaskScheduler scheduler(virtualClock);
+    int fast = scheduler.addTask("fast", fastTask, 1000, 1000);
+    
+    runFor(scheduler, 1000000);
+    
+    const TaskStats& stats = scheduler.getStats(fast);
+    TEST_ASSERT_EQUAL(1000, stats.runs);
+    TEST_ASSERT_EQUAL(0, stats.overruns);
+    TEST_ASSERT_EQUAL(0, stats.skipped);
+    TEST_ASSERT_EQUAL(0, stats.maxLatenessUs);
+    TEST_ASSERT_EQUAL(100, stats.maxDurationUs);
+}
+
+// Test the due task with the earliest absolute deadline runs first
+void test_earliest_deadline_first() {
+    TaskScheduler scheduler(virtualClock);
+    fastCostUs = 10;
+    slowCostUs = 10;
+    scheduler.addTask("slow", slowTask, 10000, 8000);
+    scheduler.addTask("fast", fastTask, 1000, 1000);
+    
+    // Both released at 0: fast (deadline 1000) before slow (deadline 8000)
+    TEST_ASSERT_TRUE(scheduler.runOnce());
+    TEST_ASSERT_TRUE(scheduler.runOnce());
+    TEST_ASSERT_FALSE(scheduler.runOnce());
+    order[orderLength] = '\0';
+    TEST_ASSERT_EQUAL_STRING("FS", order);
+    
+    // At 7500: slow (absolute deadline 8000) is more urgent than a fresh fast release (8500)
+    virtualUs = 7500;
+    TEST_ASSERT_TRUE(scheduler.runOnce());
+    order[orderLength] = '\0';
+    TEST_ASSERT_EQUAL_STRING("FSF", order);
+}
+
+// Test a long task shows up as lateness, overruns and skipped releases of a short one
+void test_long_task_reports_overruns_and_jitter() {
+    TaskScheduler scheduler(virtualClock);
+    slowCostUs = 17000;                                     // e.g. a blocking frame upload
+    int fast = scheduler.addTask("fast", fastTask, 5000, 5000);
+    int slow = scheduler.addTask("slow", slowTask, 100000, 100000);
+    
+    runFor(scheduler, 1000000);
+    
+    const TaskStats& slowStats = scheduler.getStats(slow);
+    const TaskStats& fastStats = scheduler.getStats(fast);
+    char message[128];
+    snprintf(message, sizeof(message), "fast: %lu runs, %lu overruns, %lu skipped, lateness max %lu us avg %lu us",
+             fastStats.runs, fastStats.overruns, fastStats.skipped, fastStats.maxLatenessUs,
+             fastStats.totalLatenessUs / fastStats.runs);
+    TEST_MESSAGE(message);
+    
+    // Each slow run: fast runs first (earlier deadline), then waits 17ms for slow to finish.
+    // The release at +5ms runs at +17.1ms (late by 12.1ms, past its deadline); the one
+    // at +10ms is a whole period behind by then and is skipped
+    TEST_ASSERT_EQUAL(10, slowStats.runs);
+    TEST_ASSERT_EQUAL(0, slowStats.overruns);
+    TEST_ASSERT_EQUAL(10, fastStats.overruns);
+    TEST_ASSERT_EQUAL(10, fastStats.skipped);
+    TEST_ASSERT_EQUAL(200 - 10, fastStats.runs);
+    TEST_ASSERT_EQUAL(slowCostUs + fastCostUs - 5000, fastStats.maxLatenessUs);
+    TEST_ASSERT_EQUAL(0, fastStats.minLatenessUs);
+    
+    scheduler.resetStats();
+    TEST_ASSERT_EQUAL(0, scheduler.getStats(fast).runs);
+    TEST_ASSERT_EQUAL(0, scheduler.getStats(fast).maxLatenessUs);
+}
+
+// Test trigger() releases a task at once and restarts its period from there
+void test_trigger_runs_immediately() {
+    TaskScheduler scheduler(virtualClock);
+    int fast = scheduler.addTask("fast", fastTask, 500000, 10000);
+    TEST_ASSERT_TRUE(scheduler.runOnce());
+    
+    virtualUs = 123000;
+    TEST_ASSERT_FALSE(scheduler.runOnce());
+    scheduler.trigger(fast);
+    TEST_ASSERT_EQUAL(0, scheduler.timeUntilNext());
+    TEST_ASSERT_TRUE(scheduler.runOnce());
+    TEST_ASSERT_EQUAL(0, scheduler.getStats(fast).maxLatenessUs);
+    
+    // Next regular release one period after the trigger
+    TEST_ASSERT_EQUAL(500000 - 100, scheduler.timeUntilNext());
+    runFor(scheduler, 500000);
+    TEST_ASSERT_EQUAL(3, scheduler.getStats(fast).runs);
+}
+
+// Test setPeriod() keeps the pending release and uses the new period after it
+void test_set_period_after_next_run() {
+    TaskScheduler scheduler(virtualClock);
+    int fast = scheduler.addTask("fast", fastTask, 1000, 1000);
+    TEST_ASSERT_TRUE(scheduler.runOnce());
+    
+    scheduler.setPeriod(fast, 5000);
+    scheduler.setPeriod(fast, 0);                           // Ignored
+    scheduler.setPeriod(7, 1);                              // Ignored
+    TEST_ASSERT_EQUAL(1000 - 100, scheduler.timeUntilNext());
+    
+    // Runs at 1, 6, 11 and 16 ms
+    runFor(scheduler, 20000);
+    TEST_ASSERT_EQUAL(5, scheduler.getStats(fast).runs);
+    TEST_ASSERT_EQUAL(0, scheduler.getStats(fast).skipped);
+    TEST_ASSERT_EQUAL(0, scheduler.getStats(fast).maxLatenessUs);
+}
+
+// Test the micros() wraparound does not disturb the schedule
+void test_clock_wraparound() {
+    virtualUs = 0xFFFFFFFFUL - 2500;
+    TaskScheduler scheduler(virtualClock);
+    int fast = scheduler.addTask("fast", fastTask, 1000, 1000);
+    
+    runFor(scheduler, 10000);
+    TEST_ASSERT_EQUAL_UINT32(7499, virtualUs);    // The clock wrapped during the run
+    
+    const TaskStats& stats = scheduler.getStats(fast);
+    TEST_ASSERT_EQUAL(10, stats.runs);
+    TEST_ASSERT_EQUAL(0, stats.overruns);
+    TEST_ASSERT_EQUAL(0, stats.skipped);
+    TEST_ASSERT_EQUAL(0, stats.maxLatenessUs);
+}
+
+// Test disabled tasks, idle time and the static task table limit
+void test_disable_and_table_limit() {
+    TaskScheduler scheduler(virtualClock);
+    int slow = scheduler.addTask("slow", slowTask, 2000, 2000);
+    int fast = scheduler.addTask("fast", fastTask, 3000, 3000);
+    scheduler.setEnabled(slow, false);
+    
+    runFor(scheduler, 10000);
+    TEST_ASSERT_EQUAL(0, scheduler.getStats(slow).runs);
+    TEST_ASSERT_EQUAL(4, scheduler.getStats(fast).runs);    // 0, 3, 6, 9 ms
+    TEST_ASSERT_EQUAL(2000, scheduler.timeUntilNext());      // Next fast release at 12ms
+    
+    // Enabling releases the task immediately
+    scheduler.setEnabled(slow, true);
+    TEST_ASSERT_EQUAL(0, scheduler.timeUntilNext());
+    TEST_ASSERT_TRUE(scheduler.runOnce());
+    TEST_ASSERT_EQUAL(1, scheduler.getStats(slow).runs);
+    
+    while (scheduler.getTaskCount() < TASK_MAX_TASKS) {
+        TEST_ASSERT_TRUE(scheduler.addTask("more", fastTask, 1000, 1000) >= 0);
+    }
+    TEST_ASSERT_EQUAL(-1, scheduler.addTask("full", fastTask, 1000, 1000));
+    TEST_ASSERT_EQUAL(-1, TaskScheduler(virtualClock).addTask("zero", fastTask, 0, 1000));
+    TEST_ASSERT_EQUAL_STRING("fast", scheduler.getName(fast));
+}
+
+// Main test runner
+int main(int argc, char **argv) {
+    UNITY_BEGIN();
+    
+    RUN_TEST(test_periodic_runs_without_drift);
+    RUN_TEST(test_earliest_deadline_first);
+    RUN_TEST(test_long_task_reports_overruns_and_jitter);
+    RUN_TEST(test_trigger_runs_immediately);
+    RUN_TEST(test_set_period_after_next_run);
+    RUN_TEST(test_clock_wraparound);
+    RUN_TEST(test_disable_and_table_limit);
+    
+    return UNITY_END();
+}
@@ -0,0 +1,238 @@
+#include <unity.h>
+#include <math.h>
+#include <limits.h>
+
+// Define UNIT_TEST before including anything
+#define UNIT_TEST
+
+// Include config first to ensure constants are defined
+#include "../../include/config.h"
+
+#include "../../include/TrendEstimator.h"
+#include "../../src/TrendEstimator.cpp"
+
+// One reading per 5 s and no bucket averaging: every reading is a window point
+const unsigned long STEP_MS = 5000;
+
+// 3S floor at 3.3V/cell
+const float FLOOR_3S = 9.9f;
+
+/**
+ * @brief Deterministic +-amplitude mV noise (linear congruential generator)
+ */
+static float noiseVolts(unsigned long* state, int amplitudeMv) {
+    *state = *state * 1103515245UL + 12345UL;
+    int mv = (int)((*state >> 16) % (2 * amplitudeMv + 1)) - amplitudeMv;
+    return mv / 1000.0f;
+}
+
+/**
+ * @brief Reference least squares slope (mV/min) over the last points, in double
+ */
+static double referenceSlope(const double* t, const double* v, int n) {
+    double mt = 0.0, mv = 0.0;
+    for (int i = 0; i < n; i++) { mt += t[i]; mv += v[i]; }
+    mt /= n; mv /= n;
+    double stv = 0.0, stt = 0.0;
+    for (int i = 0; i < n; i++) {
+        stv += (t[i] - mt) * (v[i] - mv);
+        stt += (t[i] - mt) * (t[i] - mt);
+    }
+    return stv / stt * 60000.0;
+}
+
+// Test an exact linear discharge is recovered with its time to empty
+void test_linear_discharge() {
+    TrendEstimator trend(0);
+    
+    // -12 mV/min = -1 mV per 5 s reading, starting at 12.000V
+    for (int i = 0; i < 40; i++) {
+        trend.update(i * STEP_MS, 12.0f - i * 0.001f);
+    }
+    
+    TrendInfo info = trend.estimate(FLOOR_3S);
+    TEST_ASSERT_TRUE(info.isValid);
+    TEST_ASSERT_FLOAT_WITHIN(0.001, -12.0, info.millivoltsPerMinute);
+    
+    // Newest point is 11.961V: (11961 - 9900) / 12 = 171.75 min
+    TEST_ASSERT_EQUAL(172, info.minutesToEmpty);
+    TEST_ASSERT_EQUAL(TREND_WINDOW_SIZE, trend.getCount());
+}
+
+// Test the estimate is withheld until the window spans TREND_MIN_SPAN_MS
+void test_min_span() {
+    TrendEstimator trend(0);
+    
+    int needed = TREND_MIN_SPAN_MS / STEP_MS;
+    for (int i = 0; i < needed; i++) {
+        trend.update(i * STEP_MS, 12.0f - i * 0.001f);
+        TEST_ASSERT_FALSE(trend.estimate(FLOOR_3S).isValid);
+    }
+    
+    trend.update(needed * STEP_MS, 12.0f - needed * 0.001f);
+    TEST_ASSERT_TRUE(trend.estimate(FLOOR_3S).isValid);
+}
+
+// Test resting and charging packs have no time to empty
+void test_not_discharging() {
+    TrendEstimator resting(0);
+    TrendEstimator charging(0);
+    
+    for (int i = 0; i < 20; i++) {
+        resting.update(i * STEP_MS, 11.1f);
+        charging.update(i * STEP_MS, 11.1f + i * 0.005f);
+    }
+    
+    TrendInfo info = resting.estimate(FLOOR_3S);
+    TEST_ASSERT_TRUE(info.isValid);
+    TEST_ASSERT_FLOAT_WITHIN(0.001, 0.0, info.millivoltsPerMinute);
+    TEST_ASSERT_EQUAL(-1, info.minutesToEmpty);
+    
+    info = charging.estimate(FLOOR_3S);
+    TEST_ASSERT_FLOAT_WITHIN(0.001, 60.0, info.millivoltsPerMinute);
+    TEST_ASSERT_EQUAL(-1, info.minutesToEmpty);
+    
+    // Already below the floor
+    TrendEstimator empty(0);
+    for (int i = 0; i < 20; i++) {
+        empty.update(i * STEP_MS, 9.8f - i * 0.001f);
+    }
+    TEST_ASSERT_EQUAL(0, empty.estimate(FLOOR_3S).minutesToEmpty);
+}
+
+// Test old points leave the window (slope follows a load change)
+void test_window_eviction() {
+    TrendEstimator trend(0);
+    float v = 12.0f;
+    unsigned long t = 0;
+    
+    // Light load: -12 mV/min
+    for (int i = 0; i < 100; i++, t += STEP_MS) {
+        trend.update(t, v);
+        v -= 0.001f;
+    }
+    
+    // Heavy load: -60 mV/min, the window holds only the new slope afterwards
+    for (int i = 0; i < TREND_WINDOW_SIZE; i++, t += STEP_MS) {
+        trend.update(t, v);
+        v -= 0.005f;
+    }
+    
+    TEST_ASSERT_EQUAL(TREND_WINDOW_SIZE, trend.getCount());
+    TEST_ASSERT_EQUAL((TREND_WINDOW_SIZE - 1) * STEP_MS, trend.getSpanMs());
+    TEST_ASSERT_FLOAT_WITHIN(0.01, -60.0, trend.estimate(FLOOR_3S).millivoltsPerMinute);
+}
+
+// Test millis() wraparound inside the window does not disturb the fit
+void test_millis_wraparound() {
+    TrendEstimator trend(0);
+    unsigned long t = ULONG_MAX - 10 * STEP_MS;
+    
+    for (int i = 0; i < 25; i++, t += STEP_MS) {
+        trend.update(t, 12.0f - i * 0.001f);
+    }
+    
+    TrendInfo info = trend.estimate(FLOOR_3S);
+    TEST_ASSERT_TRUE(info.isValid);
+    TEST_ASSERT_FLOAT_WITHIN(0.001, -12.0, info.millivoltsPerMinute);
+    TEST_ASSERT_EQUAL(24 * STEP_MS, trend.getSpanMs());
+}
+
+// Test a million noisy readings match a full recomputation (no drift in the sums)
+void test_long_run_stability() {
+    TrendEstimator trend(0);
+    unsigned long seed = 42;
+    
+    // Shadow copy of the window for the reference fit
+    double times[TREND_WINDOW_SIZE];
+    double volts[TREND_WINDOW_SIZE];
+    int stored = 0;
+    
+    const long READINGS = 1000000;
+    float maxError = 0.0f;
+    
+    for (long i = 0; i < READINGS; i++) {
+        unsigned long t = (unsigned long)i * STEP_MS + (unsigned long)(i % 7) * 13;
+        
+        // Sawtooth discharge (recharged every 2000 readings) with +-15 mV noise
+        float v = 12.6f - (i % 2000) * 0.0008f + noiseVolts(&seed, 15);
+        trend.update(t, v);
+        
+        if (stored == TREND_WINDOW_SIZE) {
+            for (int k = 1; k < TREND_WINDOW_SIZE; k++) {
+                times[k - 1] = times[k];
+                volts[k - 1] = volts[k];
+            }
+            stored--;
+        }
+        times[stored] = (double)t;
+        volts[stored] = (double)(int32_t)(v * 1000.0f + 0.5f);
+        stored++;
+        
+        if (i % 997 == 0 && stored == TREND_WINDOW_SIZE) {
+            double reference = referenceSlope(times, volts, stored);
+            float error = fabsf(trend.estimate(FLOOR_3S).millivoltsPerMinute - (float)reference);
+            if (error > maxError) maxError = error;
+        }
+    }
+    
+    // Float rounding of the final ratio only (slopes are up to ~10 mV/min)
+    TEST_ASSERT_FLOAT_WITHIN(0.01, 0.0, maxError);
+    TEST_ASSERT_EQUAL(TREND_WINDOW_SIZE, trend.getCount());
+}
+
+// Test readings within a bucket are averaged into one point
+void test_bucket_averaging() {
+    TrendEstimator trend(5000);
+    
+    // 500 ms readings alternating +-20 mV around a -12 mV/min ramp
+    for (unsigned long t = 0; t <= 120000; t += 500) {
+        float ramp = 12.0f - t * (0.012f / 60000.0f);
+        float noise = ((t / 500) % 2) ? 0.020f : -0.020f;
+        trend.update(t, ramp + noise);
+    }
+    
+    // A bucket closes on the first reading at least 5 s after its start,
+    // so with 500 ms readings each point covers 5.5 s: 121 readings -> 21 points
+    TEST_ASSERT_EQUAL(21, trend.getCount());
+    TEST_ASSERT_FLOAT_WITHIN(0.5, -12.0, trend.estimate(FLOOR_3S).millivoltsPerMinute);
+}
+
+// Test reset forgets the previous pack
+void test_reset() {
+    TrendEstimator trend(0);
+    for (int i = 0; i < 20; i++) {
+        trend.update(i * STEP_MS, 12.0f - i * 0.001f);
+    }
+    TEST_ASSERT_TRUE(trend.estimate(FLOOR_3S).isValid);
+    
+    trend.reset();
+    TEST_ASSERT_EQUAL(0, trend.getCount());
+    TEST_ASSERT_EQUAL(0, trend.getSpanMs());
+    TEST_ASSERT_FALSE(trend.estimate(FLOOR_3S).isValid);
+    
+    // New pack after reset: only its own readings count
+    for (int i = 0; i < 20; i++) {
+        trend.update(200000 + i * STEP_MS, 8.0f - i * 0.002f);
+    }
+    TEST_ASSERT_FLOAT_WITHIN(0.001, -24.0, trend.estimate(6.6f).millivoltsPerMinute);
+}
+
+// Main test runner
+int main(int argc, char **argv) {
+    UNITY_BEGIN();
+    
+    // Regression tests
+    RUN_TEST(test_linear_discharge);
+    RUN_TEST(test_min_span);
+    RUN_TEST(test_not_discharging);
+    RUN_TEST(test_window_eviction);
+    RUN_TEST(test_millis_wraparound);
+    
+    // Long-run and bucketing tests
+    RUN_TEST(test_long_run_stability);
+    RUN_TEST(test_bucket_averaging);
+    RUN_TEST(test_reset);
+    
+    return UNITY_END();
+}